@@ -194,6 +194,10 @@ usage(char* progname)
 	printf("  --txpkts=X[,Y]*: set TX segment sizes.\n");
 	printf("  --disable-link-check: disable check on link status when "
 	       "starting/stopping ports.\n");
+#ifdef RTE_LIBRTE_LATENCY_STATS
+	printf("  --latencystats: enable sampling of RX to TX latency and "
+	       "jitter.\n");
+#endif
 }
 
 #ifdef RTE_LIBRTE_CMDLINE
@@ -557,6 +561,9 @@ launch_args_parse(int argc, char** argv)
 		{ "no-flush-rx",	0, 0, 0 },
 		{ "txpkts",			1, 0, 0 },
 		{ "disable-link-check",		0, 0, 0 },
+#ifdef RTE_LIBRTE_LATENCY_STATS
+		{ "latencystats",		0, 0, 0 },
+#endif
 		{ 0, 0, 0, 0 },
 	};
 
@@ -961,6 +968,10 @@ launch_args_parse(int argc, char** argv)
 				no_flush_rx = 1;
 			if (!strcmp(lgopts[opt_idx].name, "disable-link-check"))
 				no_link_check = 1;
+#ifdef RTE_LIBRTE_LATENCY_STATS
+			if (!strcmp(lgopts[opt_idx].name, "latencystats"))
+				latencystats_enabled = 1;
+#endif
 
 			break;
 		case 'h':
@@ -75,6 +75,9 @@
 #ifdef RTE_LIBRTE_PMD_XENVIRT
 #include <rte_eth_xenvirt.h>
 #endif
+#ifdef RTE_LIBRTE_LATENCY_STATS
+#include <rte_latencystats.h>
+#endif
 
 #include "testpmd.h"
 #include "mempool_osdep.h"
@@ -257,6 +260,13 @@ uint8_t no_flush_rx = 0; /* flush by default */
  */
 uint8_t no_link_check = 0; /* check by default */
 
+#ifdef RTE_LIBRTE_LATENCY_STATS
+/*
+ * Set when latency stats is enabled in the commandline
+ */
+uint8_t latencystats_enabled = 0; /* disabled by default */
+#endif
+
 /*
  * NIC bypass mode configuration options.
  */
@@ -850,6 +860,24 @@ fwd_stream_stats_display(streamid_t stream_id)
 #endif
 }
 
+#ifdef RTE_LIBRTE_LATENCY_STATS
+static void
+latencystats_display(void)
+{
+	struct rte_eth_xstats xstats[16];
+	int i, n;
+
+	n = rte_latencystats_get(xstats, RTE_DIM(xstats));
+	rte_latencystats_uninit();
+	if (n < 0 || n > (int)RTE_DIM(xstats))
+		return;
+	printf("\n  Latency statistics (RX to TX, ns):\n");
+	for (i = 0; i < n; i++)
+		printf("  %-20s %-14"PRIu64"\n", xstats[i].name,
+		       xstats[i].value);
+}
+#endif
+
 static void
 flush_fwd_rx_queues(void)
 {
@@ -990,6 +1018,12 @@ start_packet_forwarding(int with_tx_first)
 	if(!no_flush_rx)
 		flush_fwd_rx_queues();
 
+#ifdef RTE_LIBRTE_LATENCY_STATS
+	if (latencystats_enabled &&
+	    rte_latencystats_init(RTE_LATENCYSTATS_DEFAULT_SAMP_INTVL_NS) < 0)
+		printf("Warning: latency stats cannot be enabled\n");
+#endif
+
 	fwd_config_setup();
 	rxtx_config_display();
 
@@ -1174,6 +1208,10 @@ stop_packet_forwarding(void)
 		       "%"PRIu64" / total RX packets=%"PRIu64")\n",
 		       (unsigned int)(fwd_cycles / total_recv),
 		       fwd_cycles, total_recv);
+#endif
+#ifdef RTE_LIBRTE_LATENCY_STATS
+	if (latencystats_enabled)
+		latencystats_display();
 #endif
 	printf("\nDone.\n");
 	test_done = 1;
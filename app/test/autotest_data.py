@@ -124,6 +124,12 @@ parallel_test_group_list = [
 		 "Func" :	rwlock_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Service cores autotest",
+		 "Command" : 	"service_cores_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"Logs autotest",
 		 "Command" : 	"logs_autotest",
@@ -246,6 +252,12 @@ parallel_test_group_list = [
 		 "Func" :	default_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Stack autotest",
+		 "Command" : 	"stack_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 	]
 },
 {
@@ -320,6 +332,18 @@ parallel_test_group_list = [
 		 "Func" :default_autotest,
 		 "Report" :None,
 		 },
+		{
+		 "Name" :	"PIE autotest",
+		 "Command" : 	"pie_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"IP reassembly autotest",
+		 "Command" : 	"ipfrag_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 	]
 },
 {
@@ -333,6 +357,12 @@ parallel_test_group_list = [
 		 "Func" :	default_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Telemetry autotest",
+		 "Command" :	"telemetry_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"Access list control autotest",
 		 "Command" : 	"acl_autotest",
@@ -384,6 +414,32 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix":	"stack_perf",
+	"Memory" :	per_sockets(256),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Stack performance autotest",
+		 "Command" : 	"stack_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
+{
+	"Prefix":	"vhost_perf",
+	"Memory" :	per_sockets(256),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Vhost performance autotest",
+		 "Command" : 	"vhost_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"memcpy_perf",
 	"Memory" :	per_sockets(512),
@@ -397,6 +453,19 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix":	"sched_perf",
+	"Memory" :	per_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Sched performance autotest",
+		 "Command" : 	"sched_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"hash_perf",
 	"Memory" :	per_sockets(512),
@@ -436,6 +505,71 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix" :      "power_pmd_mgmt",
+	"Memory" :      "512",
+	"Tests" :
+	[
+		{
+		 "Name" :       "Power PMD management autotest",
+		 "Command" :    "power_pmd_mgmt_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
+{
+	"Prefix" :      "latencystats",
+	"Memory" :      "512",
+	"Tests" :
+	[
+		{
+		 "Name" :       "Latency stats autotest",
+		 "Command" :    "latencystats_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
+{
+	"Prefix" :      "vhost_zcopy",
+	"Memory" :      "512",
+	"Tests" :
+	[
+		{
+		 "Name" :       "Vhost zero copy autotest",
+		 "Command" :    "vhost_zcopy_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
+{
+	"Prefix" :      "vhost_offload",
+	"Memory" :      "512",
+	"Tests" :
+	[
+		{
+		 "Name" :       "Vhost offload autotest",
+		 "Command" :    "vhost_offload_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
+{
+	"Prefix" :      "af_packet",
+	"Memory" :      "512",
+	"Tests" :
+	[
+		{
+		 "Name" :       "AF_PACKET autotest",
+		 "Command" :    "af_packet_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
 {
 	"Prefix" :      "power_kvm_vm",
 	"Memory" :      "512",
@@ -462,6 +596,19 @@ non_parallel_test_group_list = [
                 },
 	]
 },
+{
+	"Prefix":	"ipfrag_perf",
+	"Memory" :	per_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"IP reassembly performance autotest",
+		 "Command" : 	"ipfrag_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"timer_perf",
 	"Memory" :	per_sockets(512),
@@ -0,0 +1,338 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+
+#include <rte_cycles.h>
+#include <rte_dev.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "test.h"
+
+/*
+ * AF_PACKET zero-copy receive
+ * ===========================
+ *
+ * Sends packets through an AF_PACKET port on the loopback interface,
+ * with a receive ring of 4 small blocks in zero-copy mode, and checks
+ * that:
+ *  * received packets point into the ring, and hold the sent data
+ *  * freed mbufs go back to the pool at the next receive burst, in
+ *    reception order: nothing is released while the oldest is held
+ *  * blocks of which the application holds packets are not given back to
+ *    the kernel, which then drops, and receiving resumes once they are
+ *    freed
+ *
+ * Opening the port needs CAP_NET_RAW, the test is skipped without it.
+ */
+
+#define DEV_NAME "eth_af_packet_test"
+#define DEV_ARGS "iface=lo,blocksz=4096,framesz=2048,framecnt=8," \
+	"blocktmo=1,zerocopy=1"
+
+#define NB_MBUF 255
+#define MAX_PKT_BURST 32
+#define NB_HELD 64
+#define PAYLOAD_LEN 1000
+#define ETHER_TYPE_TEST 0x88b5 /* local experimental */
+#define RX_WAIT_MS 200
+
+static struct rte_mempool *pool;
+static int port_ready;
+static uint8_t port_id;
+static uint32_t next_seq;
+
+static int
+open_port(void)
+{
+	struct rte_eth_conf conf;
+
+	/* the port stays up, it cannot be restarted once stopped */
+	if (port_ready)
+		return 0;
+
+	/* the new port takes the next free id */
+	port_id = rte_eth_dev_count();
+	if (rte_eal_vdev_init(DEV_NAME, DEV_ARGS) < 0 ||
+			rte_eth_dev_count() != port_id + 1)
+		return -1;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(port_id, 1, 1, &conf) < 0 ||
+			rte_eth_rx_queue_setup(port_id, 0, 128, SOCKET_ID_ANY,
+				NULL, pool) < 0 ||
+			rte_eth_tx_queue_setup(port_id, 0, 128, SOCKET_ID_ANY,
+				NULL) < 0 ||
+			rte_eth_dev_start(port_id) < 0) {
+		printf("cannot start port %u\n", port_id);
+		return -1;
+	}
+	port_ready = 1;
+	return 0;
+}
+
+static void
+free_pkts(struct rte_mbuf **pkts, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+send_pkts(unsigned n)
+{
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	struct ether_hdr *eth_hdr;
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		pkts[i] = rte_pktmbuf_alloc(pool);
+		if (pkts[i] == NULL) {
+			free_pkts(pkts, i);
+			return -1;
+		}
+		eth_hdr = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+		memset(eth_hdr, 0, sizeof(*eth_hdr));
+		eth_hdr->ether_type = rte_cpu_to_be_16(ETHER_TYPE_TEST);
+		memset(eth_hdr + 1, (uint8_t)next_seq, PAYLOAD_LEN);
+		memcpy(eth_hdr + 1, &next_seq, sizeof(next_seq));
+		next_seq++;
+		pkts[i]->data_len = sizeof(*eth_hdr) + PAYLOAD_LEN;
+		pkts[i]->pkt_len = pkts[i]->data_len;
+	}
+	if (rte_eth_tx_burst(port_id, 0, pkts, n) != n) {
+		printf("cannot send %u packets\n", n);
+		return -1;
+	}
+	return 0;
+}
+
+/* Whether m is one of ours, and which one */
+static int
+pkt_seq(struct rte_mbuf *m, uint32_t *seq)
+{
+	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
+
+	if (m->data_len != sizeof(*eth_hdr) + PAYLOAD_LEN ||
+			eth_hdr->ether_type != rte_cpu_to_be_16(ETHER_TYPE_TEST))
+		return -1;
+	memcpy(seq, eth_hdr + 1, sizeof(*seq));
+	return 0;
+}
+
+/*
+ * Receive until n of our packets are in held[] or nothing came for
+ * RX_WAIT_MS, other traffic of the interface is dropped. Returns the
+ * number of packets received.
+ */
+static unsigned
+recv_pkts(struct rte_mbuf **held, unsigned n)
+{
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	unsigned nb_held = 0, nb_rx, i, idle = 0;
+	uint32_t seq;
+
+	while (nb_held < n && idle < RX_WAIT_MS) {
+		nb_rx = rte_eth_rx_burst(port_id, 0, pkts,
+			RTE_MIN(n - nb_held, (unsigned)MAX_PKT_BURST));
+		if (nb_rx == 0) {
+			rte_delay_ms(1);
+			idle++;
+			continue;
+		}
+		idle = 0;
+		for (i = 0; i < nb_rx; i++) {
+			if (pkt_seq(pkts[i], &seq) == 0)
+				held[nb_held++] = pkts[i];
+			else
+				rte_pktmbuf_free(pkts[i]);
+		}
+	}
+	return nb_held;
+}
+
+/* Run a receive burst for the PMD to reclaim freed mbufs */
+static unsigned
+mbufs_in_use(void)
+{
+	struct rte_mbuf *held[MAX_PKT_BURST];
+	unsigned n, in_use;
+
+	n = rte_eth_rx_burst(port_id, 0, held, MAX_PKT_BURST);
+	in_use = NB_MBUF - rte_mempool_count(pool) - n;
+	free_pkts(held, n);
+	return in_use;
+}
+
+static int
+test_zero_copy_rx(void)
+{
+	struct rte_mbuf *held[3];
+	uint32_t seq, first_seq = next_seq;
+	unsigned i;
+
+	if (send_pkts(3) < 0 || recv_pkts(held, 3) != 3) {
+		printf("packets not received\n");
+		return -1;
+	}
+
+	for (i = 0; i < 3; i++) {
+		if (pkt_seq(held[i], &seq) < 0 || seq != first_seq + i ||
+				rte_pktmbuf_mtod(held[i], uint8_t *)
+				[sizeof(struct ether_hdr) + PAYLOAD_LEN - 1] !=
+				(uint8_t)seq) {
+			printf("wrong packet %u received\n", i);
+			return -1;
+		}
+		if (held[i]->buf_physaddr != 0 ||
+				held[i]->buf_addr == (char *)held[i] +
+				sizeof(struct rte_mbuf)) {
+			printf("packet %u copied\n", i);
+			return -1;
+		}
+	}
+
+	/* the oldest packet holds back the release of the others */
+	rte_pktmbuf_free(held[1]);
+	rte_pktmbuf_free(held[2]);
+	if (mbufs_in_use() != 3) {
+		printf("mbufs released ahead of the oldest one\n");
+		return -1;
+	}
+	rte_pktmbuf_free(held[0]);
+	if (mbufs_in_use() != 0) {
+		printf("freed mbufs not back in the pool\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_held_blocks(void)
+{
+	struct rte_mbuf *held[NB_HELD], *more[3];
+	struct rte_eth_stats stats;
+	uint64_t missed;
+	unsigned nb_held = 0, i;
+
+	rte_eth_stats_get(port_id, &stats);
+	missed = stats.imissed;
+
+	/*
+	 * Hold everything: 4 blocks of 4KB hold 3 packets each, the
+	 * kernel has to drop once they are all waiting for us.
+	 */
+	for (i = 0; i < 8; i++) {
+		if (send_pkts(4) < 0)
+			goto error;
+		nb_held += recv_pkts(&held[nb_held], NB_HELD - nb_held);
+	}
+	rte_eth_stats_get(port_id, &stats);
+	if (nb_held > 12 || stats.imissed == missed) {
+		printf("%u packets received and %" PRIu64 " dropped while "
+			"holding the ring\n", nb_held, stats.imissed - missed);
+		goto error;
+	}
+
+	/* giving them back lets the kernel fill the ring again */
+	free_pkts(held, nb_held);
+	nb_held = 0;
+	if (mbufs_in_use() != 0) {
+		printf("freed mbufs not back in the pool\n");
+		return -1;
+	}
+	if (send_pkts(3) < 0 || recv_pkts(more, 3) != 3) {
+		printf("no packet received after freeing the ring\n");
+		return -1;
+	}
+	free_pkts(more, 3);
+	if (mbufs_in_use() != 0) {
+		printf("freed mbufs not back in the pool\n");
+		return -1;
+	}
+	return 0;
+
+error:
+	free_pkts(held, nb_held);
+	return -1;
+}
+
+static int
+test_af_packet(void)
+{
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	int sockfd;
+
+	sockfd = socket(AF_PACKET, SOCK_RAW, 0);
+	if (sockfd < 0) {
+		printf("cannot open an AF_PACKET socket (%s), test skipped\n",
+			strerror(errno));
+		return 0;
+	}
+	close(sockfd);
+
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create("af_packet_pool", NB_MBUF, 0,
+			0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (pool == NULL || open_port() < 0) {
+		printf("cannot allocate test resources\n");
+		return -1;
+	}
+
+	/* start from an empty ring */
+	free_pkts(pkts, recv_pkts(pkts, MAX_PKT_BURST));
+	if (mbufs_in_use() != 0) {
+		printf("mbufs left from a previous run\n");
+		return -1;
+	}
+
+	if (test_zero_copy_rx() < 0 || test_held_blocks() < 0)
+		return -1;
+	return 0;
+}
+
+static struct test_command af_packet_cmd = {
+	.command = "af_packet_autotest",
+	.callback = test_af_packet,
+};
+REGISTER_TEST_COMMAND(af_packet_cmd);
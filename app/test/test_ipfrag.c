@@ -0,0 +1,589 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+
+#include "test.h"
+
+#define NB_MBUF 1023
+#define MBUF_CACHE_SIZE 32
+#define PAYLOAD_LEN 1400
+#define FRAG_IPV4_MTU 220 /* 200 bytes of payload per fragment */
+#define FRAG_IPV6_MTU 248 /* 200 bytes of payload per fragment */
+#define MAX_FRAGS 16
+#define BURST_SIZE (MAX_FRAGS + 1)
+
+#define TBL_BUCKETS 64
+#define TBL_BUCKET_ENTRIES 4
+#define TBL_MAX_ENTRIES (TBL_BUCKETS * TBL_BUCKET_ENTRIES)
+
+static struct rte_mempool *pool;
+static struct rte_ip_frag_death_row death_row;
+
+static struct rte_ip_frag_tbl *
+create_table(uint32_t max_frags, uint32_t flags)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = TBL_BUCKETS,
+		.bucket_entries = TBL_BUCKET_ENTRIES,
+		.max_entries = TBL_MAX_ENTRIES,
+		.max_frags = max_frags,
+		.max_cycles = rte_get_tsc_hz(),
+		.socket_id = rte_socket_id(),
+		.flags = flags,
+	};
+
+	return rte_ip_frag_table_create_ext(&params);
+}
+
+/* build an IPv4 (or IPv6) packet with no L2 header and a known payload */
+static struct rte_mbuf *
+build_packet(int ipv6, uint32_t id)
+{
+	struct rte_mbuf *m;
+	uint8_t *payload;
+	uint32_t hdr_len, i;
+
+	m = rte_pktmbuf_alloc(pool);
+	if (m == NULL)
+		return NULL;
+
+	hdr_len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	payload = (uint8_t *)rte_pktmbuf_append(m, hdr_len + PAYLOAD_LEN);
+	if (payload == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(payload, 0, hdr_len);
+
+	if (ipv6) {
+		struct ipv6_hdr *ip6 = (struct ipv6_hdr *)payload;
+
+		ip6->vtc_flow = rte_cpu_to_be_32(0x60000000);
+		ip6->payload_len = rte_cpu_to_be_16(PAYLOAD_LEN);
+		ip6->proto = IPPROTO_UDP;
+		ip6->hop_limits = 64;
+		memset(ip6->src_addr, 0x11, sizeof(ip6->src_addr));
+		memset(ip6->dst_addr, 0x22, sizeof(ip6->dst_addr));
+		memcpy(ip6->src_addr, &id, sizeof(id));
+	} else {
+		struct ipv4_hdr *ip4 = (struct ipv4_hdr *)payload;
+
+		ip4->version_ihl = 0x45;
+		ip4->total_length = rte_cpu_to_be_16(hdr_len + PAYLOAD_LEN);
+		ip4->packet_id = rte_cpu_to_be_16((uint16_t)id);
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = IPPROTO_UDP;
+		ip4->src_addr = rte_cpu_to_be_32(0x0a000001 + (id >> 16));
+		ip4->dst_addr = rte_cpu_to_be_32(0x0a000002);
+	}
+
+	payload += hdr_len;
+	for (i = 0; i != PAYLOAD_LEN; i++)
+		payload[i] = (uint8_t)(i + id);
+
+	m->l2_len = 0;
+	m->l3_len = hdr_len;
+	return m;
+}
+
+/*
+ * build the IPv6 fragments of the packet built by build_packet,
+ * each fragment in a single segment.
+ */
+static int
+fragment_ipv6_packet(struct rte_mbuf *m, struct rte_mbuf **frags)
+{
+	struct ipv6_extension_fragment *fh;
+	struct ipv6_hdr *ip6, *in;
+	uint32_t ofs, len, frag_len, hdr_len;
+	int n;
+
+	in = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+	hdr_len = sizeof(*ip6) + sizeof(*fh);
+	frag_len = FRAG_IPV6_MTU - hdr_len;
+
+	n = 0;
+	for (ofs = 0; ofs < PAYLOAD_LEN; ofs += len, n++) {
+		len = RTE_MIN(frag_len, PAYLOAD_LEN - ofs);
+
+		frags[n] = rte_pktmbuf_alloc(pool);
+		if (frags[n] == NULL)
+			break;
+
+		ip6 = (struct ipv6_hdr *)rte_pktmbuf_append(frags[n],
+			hdr_len + len);
+		rte_memcpy(ip6, in, sizeof(*ip6));
+		ip6->payload_len = rte_cpu_to_be_16(sizeof(*fh) + len);
+		ip6->proto = IPPROTO_FRAGMENT;
+
+		fh = (struct ipv6_extension_fragment *)(ip6 + 1);
+		fh->next_header = in->proto;
+		fh->reserved1 = 0;
+		fh->frag_data = rte_cpu_to_be_16(ofs |
+			(ofs + len < PAYLOAD_LEN));
+		fh->id = rte_cpu_to_be_32(1);
+
+		rte_memcpy(fh + 1, (uint8_t *)(in + 1) + ofs, len);
+	}
+
+	if (ofs < PAYLOAD_LEN) {
+		while (n-- != 0)
+			rte_pktmbuf_free(frags[n]);
+		return -1;
+	}
+
+	return n;
+}
+
+/* fragment a packet and return the fragments in reverse order */
+static int
+fragment_packet(int ipv6, uint32_t id, struct rte_mbuf **frags)
+{
+	struct rte_mbuf *m, *tmp[MAX_FRAGS];
+	int32_t n, i;
+
+	m = build_packet(ipv6, id);
+	if (m == NULL)
+		return -1;
+
+	if (ipv6)
+		n = fragment_ipv6_packet(m, tmp);
+	else
+		n = rte_ipv4_fragment_packet(m, tmp, MAX_FRAGS, FRAG_IPV4_MTU,
+			pool, pool);
+	rte_pktmbuf_free(m);
+	if (n <= 0)
+		return -1;
+
+	for (i = 0; i != n; i++) {
+		frags[n - 1 - i] = tmp[i];
+		tmp[i]->l2_len = 0;
+		tmp[i]->l3_len = ipv6 ? sizeof(struct ipv6_hdr) +
+			sizeof(struct ipv6_extension_fragment) :
+			sizeof(struct ipv4_hdr);
+	}
+
+	return n;
+}
+
+/* check that a reassembled packet matches the one built by build_packet */
+static int
+check_packet(int ipv6, uint32_t id, struct rte_mbuf *m)
+{
+	const struct rte_mbuf *seg;
+	const uint8_t *data;
+	uint32_t hdr_len, ofs, i;
+
+	hdr_len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	if (m->pkt_len != hdr_len + PAYLOAD_LEN)
+		return -1;
+
+	if (ipv6) {
+		struct ipv6_hdr *ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+
+		if (rte_be_to_cpu_16(ip6->payload_len) != PAYLOAD_LEN ||
+				ip6->proto != IPPROTO_UDP)
+			return -1;
+	} else {
+		struct ipv4_hdr *ip4 = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+
+		if (rte_be_to_cpu_16(ip4->total_length) !=
+				hdr_len + PAYLOAD_LEN ||
+				rte_ipv4_frag_pkt_is_fragmented(ip4))
+			return -1;
+	}
+
+	ofs = 0;
+	for (seg = m; seg != NULL; seg = seg->next) {
+		data = rte_pktmbuf_mtod(seg, const uint8_t *);
+		for (i = 0; i != seg->data_len; i++, ofs++) {
+			if (ofs >= hdr_len &&
+					data[i] != (uint8_t)(ofs - hdr_len + id))
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_ipfrag_table_create(void)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = TBL_BUCKETS,
+		.bucket_entries = TBL_BUCKET_ENTRIES,
+		.max_entries = TBL_MAX_ENTRIES,
+		.max_frags = 0,
+		.max_cycles = rte_get_tsc_hz(),
+		.socket_id = rte_socket_id(),
+		.flags = 0,
+	};
+	struct rte_ip_frag_tbl *tbl;
+
+	tbl = rte_ip_frag_table_create_ext(NULL);
+	TEST_ASSERT_NULL(tbl, "Table created with NULL params");
+
+	params.max_frags = IP_FRAG_TBL_MAX_FRAGS + 1;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NULL(tbl, "Table created with too many fragments");
+
+	params.max_frags = 0;
+	params.flags = ~RTE_IP_FRAG_TBL_F_SHARED;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NULL(tbl, "Table created with invalid flags");
+
+	params.flags = 0;
+	tbl = rte_ip_frag_table_create_ext(&params);
+	TEST_ASSERT_NOT_NULL(tbl, "Table creation failed");
+	TEST_ASSERT_EQUAL(tbl->max_frags, (uint32_t)IP_MAX_FRAG_NUM,
+		"Unexpected default number of fragments");
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Reassemble one datagram with more than the default number of fragments,
+ * received in reverse order with a non fragmented packet in the middle.
+ */
+static int
+test_ipfrag_burst(int ipv6)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *pkts[BURST_SIZE];
+	int n, i;
+	uint16_t nb;
+
+	tbl = create_table(MAX_FRAGS, 0);
+	TEST_ASSERT_NOT_NULL(tbl, "Table creation failed");
+
+	n = fragment_packet(ipv6, 1, pkts);
+	TEST_ASSERT(n > IP_MAX_FRAG_NUM, "Fragmentation failed: %d", n);
+
+	/* insert a non fragmented packet after the first fragment. */
+	for (i = n; i != 1; i--)
+		pkts[i] = pkts[i - 1];
+	pkts[1] = build_packet(ipv6, 2);
+	TEST_ASSERT_NOT_NULL(pkts[1], "Packet allocation failed");
+
+	if (ipv6)
+		nb = rte_ipv6_frag_reassemble_burst(tbl, &death_row, pkts,
+			n + 1, rte_rdtsc());
+	else
+		nb = rte_ipv4_frag_reassemble_burst(tbl, &death_row, pkts,
+			n + 1, rte_rdtsc());
+
+	TEST_ASSERT_EQUAL(nb, 2, "Unexpected number of output packets: %u",
+		nb);
+	TEST_ASSERT_SUCCESS(check_packet(ipv6, 2, pkts[0]),
+		"Non fragmented packet modified");
+	TEST_ASSERT_SUCCESS(check_packet(ipv6, 1, pkts[1]),
+		"Invalid reassembled packet");
+	TEST_ASSERT_EQUAL(tbl->use_entries, 0, "Table entry not released");
+
+	rte_pktmbuf_free(pkts[0]);
+	rte_pktmbuf_free(pkts[1]);
+	rte_ip_frag_free_death_row(&death_row, 0);
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_ipv4_burst(void)
+{
+	return test_ipfrag_burst(0);
+}
+
+static int
+test_ipfrag_ipv6_burst(void)
+{
+	return test_ipfrag_burst(1);
+}
+
+/*
+ * A datagram with more fragments than the table allows is dropped
+ * and its fragments are put on the death row.
+ */
+static int
+test_ipfrag_too_many_frags(void)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *pkts[BURST_SIZE];
+	int n;
+	uint16_t nb;
+
+	tbl = create_table(IP_MIN_FRAG_NUM + 2, 0);
+	TEST_ASSERT_NOT_NULL(tbl, "Table creation failed");
+
+	n = fragment_packet(0, 3, pkts);
+	TEST_ASSERT(n > IP_MIN_FRAG_NUM + 2, "Fragmentation failed: %d", n);
+
+	nb = rte_ipv4_frag_reassemble_burst(tbl, &death_row, pkts, n,
+		rte_rdtsc());
+	TEST_ASSERT_EQUAL(nb, 0, "Unexpected number of output packets: %u",
+		nb);
+	TEST_ASSERT(death_row.cnt != 0, "No fragments on the death row");
+
+	rte_ip_frag_free_death_row(&death_row, 0);
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+/* interleave the fragments of several datagrams in a shared table */
+static int
+test_ipfrag_shared(void)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *frags[2][MAX_FRAGS], *m;
+	struct ipv4_hdr *ip_hdr;
+	int n[2], i, j, nb;
+
+	tbl = create_table(MAX_FRAGS, RTE_IP_FRAG_TBL_F_SHARED);
+	TEST_ASSERT_NOT_NULL(tbl, "Table creation failed");
+
+	for (j = 0; j != 2; j++) {
+		n[j] = fragment_packet(0, 4 + j, frags[j]);
+		TEST_ASSERT(n[j] > 0, "Fragmentation failed: %d", n[j]);
+	}
+
+	nb = 0;
+	for (i = 0; i != RTE_MAX(n[0], n[1]); i++) {
+		for (j = 0; j != 2; j++) {
+			if (i >= n[j])
+				continue;
+
+			m = frags[j][i];
+			ip_hdr = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+			m = rte_ipv4_frag_reassemble_packet(tbl, &death_row, m,
+				rte_rdtsc(), ip_hdr);
+			if (m == NULL)
+				continue;
+
+			TEST_ASSERT_SUCCESS(check_packet(0, 4 + j, m),
+				"Invalid reassembled packet");
+			rte_pktmbuf_free(m);
+			nb++;
+		}
+	}
+
+	TEST_ASSERT_EQUAL(nb, 2, "Unexpected number of output packets: %d",
+		nb);
+	TEST_ASSERT_EQUAL(death_row.cnt, 0, "Unexpected death row packets");
+
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * check that an IPv4 fragment requests the header checksum from the NIC,
+ * whether it was fragmented in place or by rte_ipv4_fragment_packet().
+ */
+static int
+check_ipv4_fragment(const struct rte_mbuf *m)
+{
+	const struct ipv4_hdr *ip4;
+
+	ip4 = rte_pktmbuf_mtod(m, const struct ipv4_hdr *);
+	if (m->ol_flags != PKT_TX_IP_CKSUM || ip4->hdr_checksum != 0 ||
+			m->l3_len != sizeof(struct ipv4_hdr))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Fragment a burst made of a small packet, a packet fragmented in place
+ * and a shared packet (fragmented by the per packet function), then
+ * reassemble all the fragments.
+ */
+static int
+test_ipfrag_fragment_burst(int ipv6)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *in[3], *out[2 * MAX_FRAGS + 1], *big;
+	uint16_t mtu, nb_in, nb_out, nb, i;
+	uint8_t hdr[sizeof(struct ipv6_hdr)];
+	uint32_t hdr_len;
+
+	hdr_len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	mtu = ipv6 ? FRAG_IPV6_MTU : FRAG_IPV4_MTU;
+
+	tbl = create_table(MAX_FRAGS, 0);
+	TEST_ASSERT_NOT_NULL(tbl, "Table creation failed");
+
+	for (i = 0; i != RTE_DIM(in); i++) {
+		in[i] = build_packet(ipv6, 10 + i);
+		TEST_ASSERT_NOT_NULL(in[i], "Packet allocation failed");
+	}
+
+	/* small enough to go through unchanged. */
+	rte_pktmbuf_trim(in[0], PAYLOAD_LEN - (mtu - hdr_len));
+
+	/* keep a reference to the last packet, it must not be modified. */
+	big = in[2];
+	rte_pktmbuf_refcnt_update(big, 1);
+	memcpy(hdr, rte_pktmbuf_mtod(big, void *), hdr_len);
+
+	/* flags left by RX must not leak into the fragments. */
+	in[1]->ol_flags = PKT_RX_IP_CKSUM_BAD;
+	big->ol_flags = PKT_RX_IP_CKSUM_BAD;
+
+	/* not enough room for the fragments of the second packet. */
+	nb_out = 3;
+	if (ipv6)
+		nb_in = rte_ipv6_fragment_burst(in, RTE_DIM(in), out, &nb_out,
+			mtu, pool, pool);
+	else
+		nb_in = rte_ipv4_fragment_burst(in, RTE_DIM(in), out, &nb_out,
+			mtu, pool, pool);
+	TEST_ASSERT_EQUAL(nb_in, 1, "Unexpected number of input packets: %u",
+		nb_in);
+	TEST_ASSERT_EQUAL(nb_out, 1, "Unexpected number of output packets: %u",
+		nb_out);
+	TEST_ASSERT(out[0] == in[0], "Small packet not passed through");
+
+	nb_out = RTE_DIM(out) - 1;
+	if (ipv6)
+		nb_in = rte_ipv6_fragment_burst(&in[1], 2, &out[1], &nb_out,
+			mtu, pool, pool);
+	else
+		nb_in = rte_ipv4_fragment_burst(&in[1], 2, &out[1], &nb_out,
+			mtu, pool, pool);
+	TEST_ASSERT_EQUAL(nb_in, 2, "Unexpected number of input packets: %u",
+		nb_in);
+	TEST_ASSERT(nb_out > 2 * IP_MAX_FRAG_NUM,
+		"Unexpected number of output packets: %u", nb_out);
+	TEST_ASSERT(out[1] == in[1], "Packet not reused as first fragment");
+	TEST_ASSERT_EQUAL(memcmp(hdr, rte_pktmbuf_mtod(big, void *), hdr_len),
+		0, "Shared packet modified");
+	rte_pktmbuf_free(big);
+
+	/* both the in place and the per packet paths ran. */
+	for (i = 1; !ipv6 && i != nb_out + 1; i++)
+		TEST_ASSERT_SUCCESS(check_ipv4_fragment(out[i]),
+			"Unexpected flags or checksum in fragment %u", i);
+
+	for (i = 0; i != nb_out + 1; i++)
+		out[i]->l2_len = 0;
+
+	if (ipv6)
+		nb = rte_ipv6_frag_reassemble_burst(tbl, &death_row, out,
+			nb_out + 1, rte_rdtsc());
+	else
+		nb = rte_ipv4_frag_reassemble_burst(tbl, &death_row, out,
+			nb_out + 1, rte_rdtsc());
+	TEST_ASSERT_EQUAL(nb, 3, "Unexpected number of reassembled packets: %u",
+		nb);
+	TEST_ASSERT_EQUAL(out[0]->pkt_len, mtu, "Small packet modified");
+
+	for (i = 1; i != nb; i++) {
+		TEST_ASSERT_SUCCESS(check_packet(ipv6, 10 + i, out[i]),
+			"Invalid reassembled packet");
+		rte_pktmbuf_free(out[i]);
+	}
+	rte_pktmbuf_free(out[0]);
+	TEST_ASSERT_EQUAL(death_row.cnt, 0, "Unexpected death row packets");
+
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipfrag_ipv4_fragment_burst(void)
+{
+	return test_ipfrag_fragment_burst(0);
+}
+
+static int
+test_ipfrag_ipv6_fragment_burst(void)
+{
+	return test_ipfrag_fragment_burst(1);
+}
+
+static int
+test_ipfrag_setup(void)
+{
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("ipfrag_test_pool", NB_MBUF,
+			MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+		if (pool == NULL) {
+			printf("Cannot create mbuf pool\n");
+			return -1;
+		}
+	}
+
+	death_row.cnt = 0;
+	return 0;
+}
+
+static struct unit_test_suite ipfrag_test_suite  = {
+	.suite_name = "IP Reassembly Unit Test Suite",
+	.setup = test_ipfrag_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_ipfrag_table_create),
+		TEST_CASE(test_ipfrag_ipv4_burst),
+		TEST_CASE(test_ipfrag_ipv6_burst),
+		TEST_CASE(test_ipfrag_too_many_frags),
+		TEST_CASE(test_ipfrag_shared),
+		TEST_CASE(test_ipfrag_ipv4_fragment_burst),
+		TEST_CASE(test_ipfrag_ipv6_fragment_burst),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_ipfrag(void)
+{
+	return unit_test_suite_runner(&ipfrag_test_suite);
+}
+
+static struct test_command ipfrag_cmd = {
+	.command = "ipfrag_autotest",
+	.callback = test_ipfrag,
+};
+REGISTER_TEST_COMMAND(ipfrag_cmd);
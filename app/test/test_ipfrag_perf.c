@@ -0,0 +1,414 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_per_lcore.h>
+
+#include "test.h"
+
+/*
+ * IP fragmentation and reassembly throughput test.
+ *
+ * Fragmentation: bursts of BURST_SIZE datagrams are fragmented by the per
+ * packet and by the burst functions. Only the fragmentation is measured.
+ *
+ * Reassembly: for each iteration, NB_FLOWS datagrams are fragmented and
+ * their fragments are fed to the reassembly table interleaved (fragment i
+ * of every flow, then fragment i + 1 ...), so NB_FLOWS entries are in use
+ * at the same time. Only the reassembly is measured.
+ */
+
+#define NB_MBUF 16383
+#define MBUF_CACHE_SIZE 128
+#define NB_FLOWS 128
+#define MAX_FRAGS 8
+#define MTU 276
+#define FRAG_SIZE (MTU - 20) /* payload bytes per fragment */
+#define BURST_SIZE 32
+#define NB_ITER 64
+#define NB_FRAG_ITER 1024
+#define MAX_LCORES 4
+
+static const uint32_t payload_len[] = {
+	512,  /* 2 fragments */
+	1024, /* 4 fragments */
+	1792, /* 7 fragments */
+};
+
+struct perf_lcore_params {
+	struct rte_ip_frag_tbl *tbl;
+	uint32_t payload_len;
+	uint64_t cycles;
+	uint64_t nb_frags;
+	int ret;
+};
+
+static struct rte_mempool *pool;
+static struct perf_lcore_params lcore_params[RTE_MAX_LCORE];
+
+static struct rte_ip_frag_tbl *
+create_table(uint32_t flags)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = NB_FLOWS * MAX_LCORES,
+		.bucket_entries = 4,
+		.max_entries = NB_FLOWS * MAX_LCORES,
+		.max_frags = MAX_FRAGS,
+		.max_cycles = rte_get_tsc_hz(),
+		.socket_id = rte_socket_id(),
+		.flags = flags,
+	};
+
+	return rte_ip_frag_table_create_ext(&params);
+}
+
+static struct rte_mbuf *
+build_packet(uint32_t id, uint32_t len)
+{
+	struct ipv4_hdr *ip_hdr;
+	struct rte_mbuf *m;
+
+	m = rte_pktmbuf_alloc(pool);
+	if (m == NULL)
+		return NULL;
+
+	ip_hdr = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(*ip_hdr) + len);
+	if (ip_hdr == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	memset(ip_hdr, 0, sizeof(*ip_hdr));
+	ip_hdr->version_ihl = 0x45;
+	ip_hdr->total_length = rte_cpu_to_be_16(sizeof(*ip_hdr) + len);
+	ip_hdr->packet_id = rte_cpu_to_be_16((uint16_t)id);
+	ip_hdr->time_to_live = 64;
+	ip_hdr->next_proto_id = IPPROTO_UDP;
+	ip_hdr->src_addr = rte_cpu_to_be_32(0x0a000000 + (id >> 16));
+	ip_hdr->dst_addr = rte_cpu_to_be_32(0x0b000000);
+
+	return m;
+}
+
+/* fragment NB_FLOWS datagrams, fragment i of flow f at frags[i * NB_FLOWS + f] */
+static int
+gen_fragments(uint32_t base_id, uint32_t len, struct rte_mbuf **frags)
+{
+	struct rte_mbuf *m, *tmp[MAX_FRAGS];
+	int32_t i, n;
+	uint32_t f;
+
+	n = 0;
+	for (f = 0; f != NB_FLOWS; f++) {
+		m = build_packet(base_id + f, len);
+		if (m == NULL)
+			return -1;
+
+		n = rte_ipv4_fragment_packet(m, tmp, MAX_FRAGS, MTU,
+			pool, pool);
+		rte_pktmbuf_free(m);
+		if (n <= 0)
+			return -1;
+
+		for (i = 0; i != n; i++) {
+			tmp[i]->l2_len = 0;
+			tmp[i]->l3_len = sizeof(struct ipv4_hdr);
+			frags[i * NB_FLOWS + f] = tmp[i];
+		}
+	}
+
+	return n * NB_FLOWS;
+}
+
+/* reassemble the fragments, return the number of reassembled packets */
+static int
+reassemble(struct rte_ip_frag_tbl *tbl, struct rte_mbuf **frags,
+	uint32_t nb_frags, int burst, uint64_t *cycles)
+{
+	struct rte_ip_frag_death_row dr;
+	struct rte_mbuf *out[NB_FLOWS], *m;
+	uint64_t start, tms;
+	uint32_t i, j, k, n, nb_out;
+
+	dr.cnt = 0;
+	nb_out = 0;
+
+	start = rte_rdtsc();
+
+	for (i = 0; i < nb_frags; i += k) {
+		k = RTE_MIN(nb_frags - i, (uint32_t)BURST_SIZE);
+		tms = rte_rdtsc();
+
+		if (burst) {
+			n = rte_ipv4_frag_reassemble_burst(tbl, &dr, &frags[i],
+				k, tms);
+			for (j = 0; j != n && nb_out != NB_FLOWS; j++)
+				out[nb_out++] = frags[i + j];
+		} else {
+			for (j = 0; j != k; j++) {
+				m = rte_ipv4_frag_reassemble_packet(tbl, &dr,
+					frags[i + j], tms, rte_pktmbuf_mtod(
+					frags[i + j], struct ipv4_hdr *));
+				if (m != NULL && nb_out != NB_FLOWS)
+					out[nb_out++] = m;
+			}
+		}
+
+		rte_ip_frag_free_death_row(&dr, 0);
+	}
+
+	*cycles += rte_rdtsc() - start;
+
+	for (i = 0; i != nb_out; i++)
+		rte_pktmbuf_free(out[i]);
+
+	return nb_out;
+}
+
+static int
+run_iterations(struct rte_ip_frag_tbl *tbl, uint32_t base_id, uint32_t len,
+	int burst, uint64_t *cycles, uint64_t *nb_frags)
+{
+	struct rte_mbuf *frags[NB_FLOWS * MAX_FRAGS];
+	uint32_t iter;
+	int n;
+
+	for (iter = 0; iter != NB_ITER; iter++) {
+		n = gen_fragments(base_id, len, frags);
+		if (n < 0) {
+			printf("Cannot generate fragments\n");
+			return -1;
+		}
+
+		if (reassemble(tbl, frags, n, burst, cycles) != NB_FLOWS) {
+			printf("Reassembly failed\n");
+			return -1;
+		}
+
+		*nb_frags += n;
+		/* different packet ids on every iteration */
+		base_id = (base_id & 0xffff0000) |
+			((base_id + NB_FLOWS) & 0xffff);
+	}
+
+	return 0;
+}
+
+/* fragment bursts of datagrams, return cycles per datagram */
+static int
+fragment_perf(uint32_t len, int burst, double *cycles_per_pkt)
+{
+	struct rte_mbuf *pkts[BURST_SIZE], *out[BURST_SIZE * MAX_FRAGS];
+	uint64_t start, cycles;
+	uint32_t iter, i, nb_out;
+	uint16_t n;
+	int32_t ret;
+
+	cycles = 0;
+	for (iter = 0; iter != NB_FRAG_ITER; iter++) {
+		for (i = 0; i != BURST_SIZE; i++) {
+			pkts[i] = build_packet(iter * BURST_SIZE + i, len);
+			if (pkts[i] == NULL) {
+				while (i-- != 0)
+					rte_pktmbuf_free(pkts[i]);
+				return -1;
+			}
+		}
+
+		start = rte_rdtsc();
+
+		if (burst) {
+			n = RTE_DIM(out);
+			ret = rte_ipv4_fragment_burst(pkts, BURST_SIZE, out,
+				&n, MTU, pool, pool);
+			nb_out = n;
+			ret = (ret == BURST_SIZE) ? 0 : -1;
+		} else {
+			nb_out = 0;
+			for (i = 0; i != BURST_SIZE; i++) {
+				ret = rte_ipv4_fragment_packet(pkts[i],
+					&out[nb_out], RTE_DIM(out) - nb_out,
+					MTU, pool, pool);
+				if (ret < 0)
+					break;
+				rte_pktmbuf_free(pkts[i]);
+				nb_out += ret;
+			}
+			ret = (i == BURST_SIZE) ? 0 : -1;
+		}
+
+		cycles += rte_rdtsc() - start;
+
+		for (i = 0; i != nb_out; i++)
+			rte_pktmbuf_free(out[i]);
+
+		if (ret != 0) {
+			printf("Fragmentation failed\n");
+			return -1;
+		}
+	}
+
+	*cycles_per_pkt = (double)cycles / (NB_FRAG_ITER * BURST_SIZE);
+	return 0;
+}
+
+static int
+perf_lcore_main(__attribute__((unused)) void *arg)
+{
+	struct perf_lcore_params *p = &lcore_params[rte_lcore_id()];
+
+	p->ret = run_iterations(p->tbl, rte_lcore_id() << 16, p->payload_len,
+		1, &p->cycles, &p->nb_frags);
+	return p->ret;
+}
+
+/* several lcores feeding their own flows into one shared table */
+static int
+test_ipfrag_perf_mlcore(uint32_t len)
+{
+	struct rte_ip_frag_tbl *tbl;
+	unsigned lcore_id, nb_lcores;
+	uint64_t cycles, nb_frags;
+	int ret;
+
+	tbl = create_table(RTE_IP_FRAG_TBL_F_SHARED);
+	if (tbl == NULL)
+		return -1;
+
+	memset(lcore_params, 0, sizeof(lcore_params));
+	nb_lcores = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (nb_lcores == MAX_LCORES)
+			break;
+		lcore_params[lcore_id].tbl = tbl;
+		lcore_params[lcore_id].payload_len = len;
+		rte_eal_remote_launch(perf_lcore_main, NULL, lcore_id);
+		nb_lcores++;
+	}
+
+	ret = 0;
+	cycles = 0;
+	nb_frags = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+		cycles += lcore_params[lcore_id].cycles;
+		nb_frags += lcore_params[lcore_id].nb_frags;
+	}
+
+	if (ret == 0 && nb_frags != 0)
+		printf("  shared table, burst, %u lcores:\t%.1f cycles/fragment\n",
+			nb_lcores, (double)cycles / nb_frags);
+
+	rte_ip_frag_table_destroy(tbl);
+	return ret;
+}
+
+static int
+test_ipfrag_perf(void)
+{
+	static const char * const mode_name[] = {"packet", "burst"};
+	struct rte_ip_frag_tbl *tbl;
+	uint64_t cycles, nb_frags;
+	uint32_t i, shared;
+	double cpp;
+	int burst;
+
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("ipfrag_perf_pool", NB_MBUF,
+			MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+		if (pool == NULL) {
+			printf("Cannot create mbuf pool\n");
+			return -1;
+		}
+	}
+
+	for (i = 0; i != RTE_DIM(payload_len); i++) {
+		printf("\n%u bytes datagrams, %u fragments\n", payload_len[i],
+			(payload_len[i] + FRAG_SIZE - 1) / FRAG_SIZE);
+
+		for (burst = 0; burst != 2; burst++) {
+			if (fragment_perf(payload_len[i], burst, &cpp) < 0)
+				return -1;
+			printf("  fragmentation, %s:\t%.1f cycles/packet\n",
+				mode_name[burst], cpp);
+		}
+
+		for (shared = 0; shared != 2; shared++) {
+			for (burst = 0; burst != 2; burst++) {
+				tbl = create_table(shared ?
+					RTE_IP_FRAG_TBL_F_SHARED : 0);
+				if (tbl == NULL)
+					return -1;
+
+				cycles = 0;
+				nb_frags = 0;
+				if (run_iterations(tbl, 0, payload_len[i],
+						burst, &cycles, &nb_frags) < 0) {
+					rte_ip_frag_table_destroy(tbl);
+					return -1;
+				}
+
+				printf("  %s table, %s:\t%.1f cycles/fragment\n",
+					shared ? "shared" : "private",
+					mode_name[burst],
+					(double)cycles / nb_frags);
+
+				rte_ip_frag_table_destroy(tbl);
+			}
+		}
+
+		if (rte_lcore_count() > 1 &&
+				test_ipfrag_perf_mlcore(payload_len[i]) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static struct test_command ipfrag_perf_cmd = {
+	.command = "ipfrag_perf_autotest",
+	.callback = test_ipfrag_perf,
+};
+REGISTER_TEST_COMMAND(ipfrag_perf_cmd);
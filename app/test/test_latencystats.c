@@ -0,0 +1,232 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_latencystats.h>
+
+#include "test.h"
+
+#define RING_SIZE 64
+#define NB_MBUF 63
+#define BURST_SIZE 32
+#define NB_SAMPLES 16
+#define DELAY_US 10
+
+static struct rte_mempool *pool;
+static struct rte_ring *ring;
+static int port_id = -1;
+
+static int
+test_latencystats_setup(void)
+{
+	struct rte_eth_conf port_conf;
+
+	if (port_id >= 0)
+		return 0;
+
+	pool = rte_pktmbuf_pool_create("latencystats_pool", NB_MBUF, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	TEST_ASSERT_NOT_NULL(pool, "cannot create mbuf pool");
+
+	ring = rte_ring_create("latencystats_ring", RING_SIZE, rte_socket_id(),
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(ring, "cannot create ring");
+
+	port_id = rte_eth_from_rings("latencystats", &ring, 1, &ring, 1,
+		rte_socket_id());
+	TEST_ASSERT(port_id >= 0, "cannot create ring port");
+
+	memset(&port_conf, 0, sizeof(port_conf));
+	TEST_ASSERT_SUCCESS(rte_eth_dev_configure(port_id, 1, 1, &port_conf),
+			"cannot configure port");
+	TEST_ASSERT_SUCCESS(rte_eth_rx_queue_setup(port_id, 0, RING_SIZE,
+			rte_socket_id(), NULL, pool),
+			"cannot set up RX queue");
+	TEST_ASSERT_SUCCESS(rte_eth_tx_queue_setup(port_id, 0, RING_SIZE,
+			rte_socket_id(), NULL),
+			"cannot set up TX queue");
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(port_id), "cannot start port");
+	return 0;
+}
+
+/* receive every packet waiting on the port and free it */
+static void
+drain_port(void)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint16_t k, nb;
+
+	do {
+		nb = rte_eth_rx_burst(port_id, 0, pkts, BURST_SIZE);
+		for (k = 0; k < nb; k++)
+			rte_pktmbuf_free(pkts[k]);
+	} while (nb != 0);
+}
+
+/* receive one packet, hold it for DELAY_US and send it back */
+static int
+forward_packet(void)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+
+	if (m == NULL)
+		return -1;
+	if (rte_ring_enqueue(ring, m) != 0) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+	if (rte_eth_rx_burst(port_id, 0, &m, 1) != 1)
+		return -1;
+	rte_delay_us(DELAY_US);
+	if (rte_eth_tx_burst(port_id, 0, &m, 1) != 1) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+	drain_port();
+	return 0;
+}
+
+/* look up a statistic by name, UINT64_MAX if missing */
+static uint64_t
+stat_value(const struct rte_eth_xstats *xstats, int n, const char *name)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		if (strcmp(xstats[i].name, name) == 0)
+			return xstats[i].value;
+	return UINT64_MAX;
+}
+
+static int
+test_latencystats_params(void)
+{
+	TEST_ASSERT_EQUAL(rte_latencystats_uninit(), -ENODEV,
+			"uninit without init");
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(0),
+			"cannot init latency stats");
+	TEST_ASSERT_EQUAL(rte_latencystats_init(0), -EALREADY,
+			"latency stats initialised twice");
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(),
+			"cannot uninit latency stats");
+	TEST_ASSERT_EQUAL(rte_latencystats_uninit(), -ENODEV,
+			"latency stats uninitialised twice");
+	return 0;
+}
+
+static int
+test_latencystats_sampling(void)
+{
+	struct rte_eth_xstats xstats[16];
+	uint64_t min, avg, max, p50, p99;
+	int i, n;
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(0),
+			"cannot init latency stats");
+	rte_latencystats_reset();
+
+	for (i = 0; i < NB_SAMPLES; i++)
+		TEST_ASSERT_SUCCESS(forward_packet(),
+				"cannot forward packet");
+
+	n = rte_latencystats_get(NULL, 0);
+	TEST_ASSERT(n > 0 && n <= (int)RTE_DIM(xstats),
+			"wrong number of statistics %d", n);
+	TEST_ASSERT_EQUAL(rte_latencystats_get(xstats, n - 1), n,
+			"short table accepted");
+	TEST_ASSERT_EQUAL(rte_latencystats_get(xstats, RTE_DIM(xstats)), n,
+			"cannot get statistics");
+
+	TEST_ASSERT_EQUAL(stat_value(xstats, n, "samples"), NB_SAMPLES,
+			"wrong number of samples");
+	min = stat_value(xstats, n, "min_latency_ns");
+	avg = stat_value(xstats, n, "avg_latency_ns");
+	max = stat_value(xstats, n, "max_latency_ns");
+	p50 = stat_value(xstats, n, "p50_latency_ns");
+	p99 = stat_value(xstats, n, "p99_latency_ns");
+	TEST_ASSERT(min >= DELAY_US * 1000 * 9 / 10,
+			"latency %"PRIu64" ns below the delay", min);
+	TEST_ASSERT(min <= avg && avg <= max,
+			"inconsistent latencies %"PRIu64"/%"PRIu64"/%"PRIu64,
+			min, avg, max);
+	TEST_ASSERT(min <= p50 && p50 <= p99 && p99 <= max,
+			"inconsistent percentiles %"PRIu64"/%"PRIu64,
+			p50, p99);
+	TEST_ASSERT(stat_value(xstats, n, "jitter_ns") <= max - min,
+			"jitter larger than the latency range");
+
+	rte_latencystats_reset();
+	rte_latencystats_get(xstats, RTE_DIM(xstats));
+	TEST_ASSERT_EQUAL(stat_value(xstats, n, "samples"), 0,
+			"statistics not reset");
+
+	/* no more samples once the callbacks are removed */
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(),
+			"cannot uninit latency stats");
+	TEST_ASSERT_SUCCESS(forward_packet(), "cannot forward packet");
+	rte_latencystats_get(xstats, RTE_DIM(xstats));
+	TEST_ASSERT_EQUAL(stat_value(xstats, n, "samples"), 0,
+			"packet sampled after uninit");
+	return 0;
+}
+
+static struct unit_test_suite latencystats_test_suite = {
+	.suite_name = "Latency Statistics Unit Test Suite",
+	.setup = test_latencystats_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_latencystats_params),
+		TEST_CASE(test_latencystats_sampling),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_latencystats(void)
+{
+	return unit_test_suite_runner(&latencystats_test_suite);
+}
+
+static struct test_command latencystats_cmd = {
+	.command = "latencystats_autotest",
+	.callback = test_latencystats,
+};
+REGISTER_TEST_COMMAND(latencystats_cmd);
@@ -2930,6 +2930,158 @@ test_balance_l34_tx_burst_ipv6_toggle_udp_port(void)
 	return balance_l34_tx_burst(0, 0, 0, 0, 1);
 }
 
+#define TEST_BALANCE_RSS_HASH_SLAVE_COUNT (3)
+#define TEST_BALANCE_RSS_HASH_BURST_SIZE (20)
+
+static int
+test_balance_l34_tx_burst_rss_hash(void)
+{
+	struct rte_mbuf *pkts_burst[TEST_BALANCE_RSS_HASH_BURST_SIZE];
+	uint64_t expected[TEST_BALANCE_RSS_HASH_SLAVE_COUNT] = { 0 };
+	struct rte_eth_stats port_stats;
+	int i;
+
+	TEST_ASSERT_SUCCESS(initialize_bonded_device_with_slaves(
+			BONDING_MODE_BALANCE, 0, TEST_BALANCE_RSS_HASH_SLAVE_COUNT, 1),
+			"Failed to initialize_bonded_device_with_slaves.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_set(
+			test_params->bonded_port_id, BALANCE_XMIT_POLICY_LAYER34),
+			"Failed to set balance xmit policy.");
+
+	/* Packets of a single flow, which would all go to the same slave */
+	TEST_ASSERT_EQUAL(generate_test_burst(pkts_burst,
+			TEST_BALANCE_RSS_HASH_BURST_SIZE, 0, 1, 0, 0, 0),
+			TEST_BALANCE_RSS_HASH_BURST_SIZE, "failed to generate burst");
+
+	/*
+	 * With an RSS hash, it is used instead of the headers: small hash values
+	 * are not changed by the folding of the hash, and select slave
+	 * hash % slave count.
+	 */
+	for (i = 0; i < TEST_BALANCE_RSS_HASH_BURST_SIZE; i++) {
+		pkts_burst[i]->ol_flags |= PKT_RX_RSS_HASH;
+		pkts_burst[i]->hash.rss = i;
+		expected[i % TEST_BALANCE_RSS_HASH_SLAVE_COUNT]++;
+	}
+
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(test_params->bonded_port_id, 0,
+			pkts_burst, TEST_BALANCE_RSS_HASH_BURST_SIZE),
+			TEST_BALANCE_RSS_HASH_BURST_SIZE, "tx burst failed");
+
+	for (i = 0; i < TEST_BALANCE_RSS_HASH_SLAVE_COUNT; i++) {
+		rte_eth_stats_get(test_params->slave_port_ids[i], &port_stats);
+		TEST_ASSERT_EQUAL(port_stats.opackets, expected[i],
+				"Slave Port (%d) opackets value (%u) not as expected (%u)",
+				test_params->slave_port_ids[i],
+				(unsigned int)port_stats.opackets,
+				(unsigned int)expected[i]);
+	}
+
+	/* Clean up and remove slaves from bonded device */
+	return remove_slaves_and_stop_bonded_device();
+}
+
+/* Transmit policy hook sending everything to the last slave */
+static void
+xmit_hash_last_slave(struct rte_mbuf **pkts __rte_unused, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		slaves[i] = slave_count - 1;
+}
+
+/* Transmit policy hook returning an invalid slave for every other packet */
+static void
+xmit_hash_out_of_range(struct rte_mbuf **pkts __rte_unused, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		slaves[i] = i & 1 ? slave_count : 0;
+}
+
+#define TEST_BALANCE_XMIT_HOOK_SLAVE_COUNT (3)
+
+static int
+test_balance_xmit_policy_hook(void)
+{
+	struct rte_mbuf *pkts_burst[MAX_PKT_BURST];
+	struct rte_eth_stats port_stats;
+	int i, burst_size = 20;
+
+	TEST_ASSERT_SUCCESS(initialize_bonded_device_with_slaves(
+			BONDING_MODE_BALANCE, 0, TEST_BALANCE_XMIT_HOOK_SLAVE_COUNT, 1),
+			"Failed to initialize_bonded_device_with_slaves.");
+
+	/* Invalid port id, invalid hook */
+	TEST_ASSERT_FAIL(rte_eth_bond_xmit_policy_hook_set(INVALID_PORT_ID,
+			xmit_hash_last_slave),
+			"Expected call to failed as invalid port specified.");
+	TEST_ASSERT_FAIL(rte_eth_bond_xmit_policy_hook_set(
+			test_params->bonded_port_id, NULL),
+			"Expected call to failed as no hook specified.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_hook_set(
+			test_params->bonded_port_id, xmit_hash_last_slave),
+			"Failed to set balance xmit policy hook.");
+	TEST_ASSERT_EQUAL(rte_eth_bond_xmit_policy_get(test_params->bonded_port_id),
+			BALANCE_XMIT_POLICY_USER, "balance xmit policy not as expected.");
+
+	/* Packets of different flows all go to the last slave */
+	TEST_ASSERT_EQUAL(generate_test_burst(pkts_burst, burst_size, 0, 1, 1, 1,
+			1), burst_size, "failed to generate burst");
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(test_params->bonded_port_id, 0,
+			pkts_burst, burst_size), burst_size, "tx burst failed");
+
+	for (i = 0; i < TEST_BALANCE_XMIT_HOOK_SLAVE_COUNT; i++) {
+		uint64_t expected = i == TEST_BALANCE_XMIT_HOOK_SLAVE_COUNT - 1 ?
+				(uint64_t)burst_size : 0;
+
+		rte_eth_stats_get(test_params->slave_port_ids[i], &port_stats);
+		TEST_ASSERT_EQUAL(port_stats.opackets, expected,
+				"Slave Port (%d) opackets value (%u) not as expected (%u)",
+				test_params->slave_port_ids[i],
+				(unsigned int)port_stats.opackets, (unsigned int)expected);
+	}
+
+	/* Packets given an invalid slave are dropped and counted as errors */
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_hook_set(
+			test_params->bonded_port_id, xmit_hash_out_of_range),
+			"Failed to set balance xmit policy hook.");
+	rte_eth_stats_reset(test_params->bonded_port_id);
+
+	TEST_ASSERT_EQUAL(generate_test_burst(pkts_burst, burst_size, 0, 1, 1, 1,
+			1), burst_size, "failed to generate burst");
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(test_params->bonded_port_id, 0,
+			pkts_burst, burst_size), burst_size, "tx burst failed");
+
+	rte_eth_stats_get(test_params->slave_port_ids[0], &port_stats);
+	TEST_ASSERT_EQUAL(port_stats.opackets, (uint64_t)burst_size / 2,
+			"Slave Port (%d) opackets value (%u) not as expected (%u)",
+			test_params->slave_port_ids[0],
+			(unsigned int)port_stats.opackets, burst_size / 2);
+
+	rte_eth_stats_get(test_params->bonded_port_id, &port_stats);
+	TEST_ASSERT_EQUAL(port_stats.oerrors, (uint64_t)burst_size / 2,
+			"Bonded Port (%d) oerrors value (%u) not as expected (%u)",
+			test_params->bonded_port_id,
+			(unsigned int)port_stats.oerrors, burst_size / 2);
+
+	/* A built-in policy replaces the hook */
+	TEST_ASSERT_SUCCESS(rte_eth_bond_xmit_policy_set(
+			test_params->bonded_port_id, BALANCE_XMIT_POLICY_LAYER2),
+			"Failed to set balance xmit policy.");
+	TEST_ASSERT_EQUAL(rte_eth_bond_xmit_policy_get(test_params->bonded_port_id),
+			BALANCE_XMIT_POLICY_LAYER2, "balance xmit policy not as expected.");
+
+	/* Clean up and remove slaves from bonded device */
+	return remove_slaves_and_stop_bonded_device();
+}
+
 #define TEST_BAL_SLAVE_TX_FAIL_SLAVE_COUNT			(2)
 #define TEST_BAL_SLAVE_TX_FAIL_BURST_SIZE_1			(40)
 #define TEST_BAL_SLAVE_TX_FAIL_BURST_SIZE_2			(20)
@@ -4970,6 +5122,8 @@ static struct unit_test_suite link_bonding_test_suite  = {
 		TEST_CASE(test_balance_l34_tx_burst_ipv6_toggle_ip_addr),
 		TEST_CASE(test_balance_l34_tx_burst_vlan_ipv6_toggle_ip_addr),
 		TEST_CASE(test_balance_l34_tx_burst_ipv6_toggle_udp_port),
+		TEST_CASE(test_balance_l34_tx_burst_rss_hash),
+		TEST_CASE(test_balance_xmit_policy_hook),
 		TEST_CASE(test_balance_tx_burst_slave_tx_fail),
 		TEST_CASE(test_balance_rx_burst),
 		TEST_CASE(test_balance_verify_promiscuous_enable_disable),
@@ -78,6 +78,8 @@
 #define SLAVE_DEV_NAME_FMT      ("unit_test_mode4_slave_%d")
 #define SLAVE_RX_QUEUE_FMT      ("unit_test_mode4_slave_%d_rx")
 #define SLAVE_TX_QUEUE_FMT      ("unit_test_mode4_slave_%d_tx")
+#define SLAVE_CTRL_RX_QUEUE_FMT ("unit_test_mode4_slave_%d_crx")
+#define SLAVE_CTRL_TX_QUEUE_FMT ("unit_test_mode4_slave_%d_ctx")
 
 #define INVALID_SOCKET_ID       (-1)
 #define INVALID_PORT_ID         (0xFF)
@@ -102,8 +104,17 @@ static const struct ether_addr slow_protocol_mac_addr = {
 struct slave_conf {
 	struct rte_ring *rx_queue;
 	struct rte_ring *tx_queue;
+	/* Second queue pair, used as control queues when bonding reserves them */
+	struct rte_ring *ctrl_rx_queue;
+	struct rte_ring *ctrl_tx_queue;
+	/* Ring PMD ops extended with emulated ethertype filter */
+	struct eth_dev_ops dev_ops;
 	uint8_t port_id;
 	uint8_t bonded : 1;
+	/* Emulate hardware able to steer slow frames to the control queue */
+	uint8_t slow_filter_supported : 1;
+	/* Slow frames are currently steered to the control queue */
+	uint8_t slow_filter_set : 1;
 
 	uint8_t lacp_parnter_state;
 };
@@ -191,7 +202,11 @@ static struct rte_eth_conf default_pmd_conf = {
 static int
 slave_get_pkts(struct slave_conf *slave, struct rte_mbuf **buf, uint16_t size)
 {
-	return rte_ring_dequeue_burst(slave->tx_queue, (void **)buf, size);
+	unsigned nb_pkts;
+
+	nb_pkts = rte_ring_dequeue_burst(slave->ctrl_tx_queue, (void **)buf, size);
+	return nb_pkts + rte_ring_dequeue_burst(slave->tx_queue,
+			(void **)&buf[nb_pkts], size - nb_pkts);
 }
 
 /*
@@ -204,7 +219,64 @@ slave_get_pkts(struct slave_conf *slave, struct rte_mbuf **buf, uint16_t size)
 static int
 slave_put_pkts(struct slave_conf *slave, struct rte_mbuf **buf, uint16_t size)
 {
-	return rte_ring_enqueue_burst(slave->rx_queue, (void **)buf, size);
+	struct ether_hdr *hdr;
+	struct rte_ring *ring;
+	uint16_t i;
+
+	if (!slave->slow_filter_set)
+		return rte_ring_enqueue_burst(slave->rx_queue, (void **)buf, size);
+
+	/* Do what ethertype filter of the NIC would do */
+	for (i = 0; i < size; i++) {
+		hdr = rte_pktmbuf_mtod(buf[i], struct ether_hdr *);
+		if (hdr->ether_type == rte_cpu_to_be_16(ETHER_TYPE_SLOW))
+			ring = slave->ctrl_rx_queue;
+		else
+			ring = slave->rx_queue;
+
+		if (rte_ring_enqueue(ring, buf[i]) != 0)
+			break;
+	}
+
+	return i;
+}
+
+/*
+ * Ethertype filter emulation for ring slaves. Accepts only a filter steering
+ * slow protocol frames to the second RX queue.
+ */
+static int
+slave_filter_ctrl(struct rte_eth_dev *dev, enum rte_filter_type filter_type,
+		enum rte_filter_op filter_op, void *arg)
+{
+	struct rte_eth_ethertype_filter *filter = arg;
+	struct slave_conf *slave;
+	uint8_t i;
+
+	FOR_EACH_PORT(i, slave) {
+		if (slave->port_id == dev->data->port_id)
+			break;
+	}
+
+	if (i == RTE_DIM(test_params.slave_ports) ||
+			!slave->slow_filter_supported ||
+			filter_type != RTE_ETH_FILTER_ETHERTYPE)
+		return -ENOTSUP;
+
+	if (filter_op == RTE_ETH_FILTER_NOP)
+		return 0;
+
+	if (filter->ether_type != ETHER_TYPE_SLOW || filter->queue != 1)
+		return -EINVAL;
+
+	if (filter_op == RTE_ETH_FILTER_ADD)
+		slave->slow_filter_set = 1;
+	else if (filter_op == RTE_ETH_FILTER_DELETE)
+		slave->slow_filter_set = 0;
+	else
+		return -ENOTSUP;
+
+	return 0;
 }
 
 static uint16_t
@@ -416,15 +488,46 @@ test_setup(void)
 				rte_strerror(rte_errno));
 		}
 
+		if (port->ctrl_rx_queue == NULL) {
+			retval = snprintf(name, RTE_DIM(name), SLAVE_CTRL_RX_QUEUE_FMT, i);
+			TEST_ASSERT(retval <= (int)RTE_DIM(name) - 1, "Name too long");
+			port->ctrl_rx_queue = rte_ring_create(name, RX_RING_SIZE,
+					socket_id, 0);
+			TEST_ASSERT_NOT_NULL(port->ctrl_rx_queue,
+				"Failed to allocate rx ring '%s': %s", name,
+				rte_strerror(rte_errno));
+		}
+
+		if (port->ctrl_tx_queue == NULL) {
+			retval = snprintf(name, RTE_DIM(name), SLAVE_CTRL_TX_QUEUE_FMT, i);
+			TEST_ASSERT(retval <= (int)RTE_DIM(name) - 1, "Name too long");
+			port->ctrl_tx_queue = rte_ring_create(name, TX_RING_SIZE,
+					socket_id, 0);
+			TEST_ASSERT_NOT_NULL(port->ctrl_tx_queue,
+				"Failed to allocate tx ring '%s': %s", name,
+				rte_strerror(rte_errno));
+		}
+
 		if (port->port_id == INVALID_PORT_ID) {
+			struct rte_ring *rx_rings[] = { port->rx_queue,
+					port->ctrl_rx_queue };
+			struct rte_ring *tx_rings[] = { port->tx_queue,
+					port->ctrl_tx_queue };
+			struct rte_eth_dev *eth_dev;
+
 			retval = snprintf(name, RTE_DIM(name), SLAVE_DEV_NAME_FMT, i);
 			TEST_ASSERT(retval < (int)RTE_DIM(name) - 1, "Name too long");
-			retval = rte_eth_from_rings(name, &port->rx_queue, 1,
-					&port->tx_queue, 1, socket_id);
+			retval = rte_eth_from_rings(name, rx_rings, RTE_DIM(rx_rings),
+					tx_rings, RTE_DIM(tx_rings), socket_id);
 			TEST_ASSERT(retval >= 0,
 				"Failed to create ring ethdev '%s'\n", name);
 
 			port->port_id = rte_eth_dev_count() - 1;
+
+			eth_dev = &rte_eth_devices[port->port_id];
+			port->dev_ops = *eth_dev->dev_ops;
+			port->dev_ops.filter_ctrl = slave_filter_ctrl;
+			eth_dev->dev_ops = &port->dev_ops;
 		}
 
 		retval = configure_ethdev(port->port_id, 1);
@@ -1264,6 +1367,296 @@ test_mode4_expired(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * Sets up bonded device with dedicated control queues. Only every other slave
+ * emulates ethertype filter, the remaining ones need software filtering.
+ */
+static int
+initialize_bonded_device_with_dedicated_queues(uint8_t slave_count,
+		uint8_t all_filtered)
+{
+	struct slave_conf *slave;
+	uint8_t i;
+	int retval;
+
+	FOR_EACH_PORT(i, slave)
+		slave->slow_filter_supported = all_filtered || (i % 2) == 0;
+
+	retval = initialize_bonded_device_with_slaves(slave_count, 0);
+	TEST_ASSERT_SUCCESS(retval, "Failed to initialize bonded device");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_8023ad_dedicated_queues_enable(
+			test_params.bonded_port_id),
+			"Failed to enable dedicated queues");
+
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(test_params.bonded_port_id),
+		"Failed to start bonded device");
+
+	TEST_ASSERT_FAIL(rte_eth_bond_8023ad_dedicated_queues_disable(
+			test_params.bonded_port_id),
+			"Dedicated queues disabled while bonded device is started");
+
+	FOR_EACH_SLAVE(i, slave) {
+		TEST_ASSERT_EQUAL(slave->slow_filter_set,
+			slave->slow_filter_supported,
+			"Unexpected slow filter state on slave %u", slave->port_id);
+	}
+
+	return bond_handshake();
+}
+
+static int
+cleanup_bonded_device_with_dedicated_queues(void)
+{
+	struct slave_conf *slave;
+	uint8_t i;
+	int retval;
+
+	retval = remove_slaves_and_stop_bonded_device();
+	TEST_ASSERT_SUCCESS(retval, "Test cleanup failed.");
+
+	TEST_ASSERT_SUCCESS(rte_eth_bond_8023ad_dedicated_queues_disable(
+			test_params.bonded_port_id),
+			"Failed to disable dedicated queues");
+
+	FOR_EACH_PORT(i, slave)
+		slave->slow_filter_supported = 0;
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_mode4_dedicated_queues(void)
+{
+	struct slave_conf *slave;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	struct rte_mbuf *marker_pkt;
+	struct marker_header *marker_hdr;
+	struct ether_hdr *hdr;
+	struct ether_addr bonded_mac, slave_mac;
+
+	unsigned delay;
+	int retval;
+	uint16_t expected_pkts_cnt, nb_pkts, k;
+	uint8_t i, j;
+	const uint16_t ethtype_slow_be = rte_be_to_cpu_16(ETHER_TYPE_SLOW);
+
+	retval = initialize_bonded_device_with_dedicated_queues(
+			TEST_MARKER_SLAVE_COUT, 0);
+	TEST_ASSERT_SUCCESS(retval, "Initial handshake failed");
+
+	/* Marker responses must leave through control queue whether the marker
+	 * came through control queue or was filtered in software. */
+	delay = bond_get_update_timeout_ms();
+	FOR_EACH_SLAVE(i, slave) {
+		marker_pkt = rte_pktmbuf_alloc(test_params.mbuf_pool);
+		TEST_ASSERT_NOT_NULL(marker_pkt, "Failed to allocate marker packet");
+		init_marker(marker_pkt, slave);
+
+		retval = slave_put_pkts(slave, &marker_pkt, 1);
+		if (retval != 1)
+			rte_pktmbuf_free(marker_pkt);
+
+		TEST_ASSERT_EQUAL(retval, 1,
+			"Failed to send marker packet to slave %u", slave->port_id);
+
+		for (j = 0; j < 20; ++j) {
+			rte_delay_ms(delay);
+			retval = bond_rx(pkts, RTE_DIM(pkts));
+			if (retval > 0)
+				free_pkts(pkts, retval);
+
+			TEST_ASSERT_EQUAL(retval, 0, "Received packets unexpectedly");
+
+			TEST_ASSERT_EQUAL(rte_ring_count(slave->tx_queue), 0,
+				"Slow packet sent through data queue of slave %u",
+				slave->port_id);
+
+			retval = rte_ring_dequeue_burst(slave->ctrl_tx_queue,
+					(void **)pkts, RTE_DIM(pkts));
+			if (retval == 0)
+				continue;
+
+			/* Periodic LACPDUs might be sent along with the response */
+			nb_pkts = retval;
+			retval = 0;
+			for (k = 0; k < nb_pkts && retval >= 0; k++) {
+				marker_hdr = rte_pktmbuf_mtod(pkts[k],
+						struct marker_header *);
+				if (marker_hdr->eth_hdr.ether_type != ethtype_slow_be)
+					retval = -1;
+				else if (marker_hdr->marker.subtype != SLOW_SUBTYPE_MARKER)
+					continue;
+				else if (marker_hdr->marker.tlv_type_marker !=
+						MARKER_TLV_TYPE_RESP)
+					retval = -3;
+				else
+					retval = 1;
+			}
+
+			free_pkts(pkts, nb_pkts);
+
+			TEST_ASSERT_NOT_EQUAL(retval, -1, "Unexpected protocol type");
+			TEST_ASSERT_NOT_EQUAL(retval, -3, "Unexpected marker type");
+			if (retval == 1)
+				break;
+		}
+
+		TEST_ASSERT(j < 20, "Marker response not found");
+	}
+
+	/* Data packets still pass through data queues */
+	rte_eth_macaddr_get(test_params.bonded_port_id, &bonded_mac);
+	ether_addr_copy(&slave_mac_default, &slave_mac);
+	expected_pkts_cnt = 0;
+	FOR_EACH_SLAVE(i, slave) {
+		retval = generate_and_put_packets(slave, &slave_mac, &bonded_mac, 1);
+		TEST_ASSERT_SUCCESS(retval, "Failed to enqueue packets to slave %u",
+			slave->port_id);
+		expected_pkts_cnt++;
+	}
+
+	retval = bond_rx(pkts, RTE_DIM(pkts));
+	free_pkts(pkts, retval);
+	TEST_ASSERT_EQUAL(retval, expected_pkts_cnt,
+		"Expected %u packets but received %d", expected_pkts_cnt, retval);
+
+	retval = generate_packets(&bonded_mac, &slave_mac, MAX_PKT_BURST, pkts);
+	TEST_ASSERT_EQUAL(retval, MAX_PKT_BURST, "Failed to generate packets");
+
+	retval = bond_tx(pkts, MAX_PKT_BURST);
+	if (retval < MAX_PKT_BURST)
+		free_pkts(&pkts[retval], MAX_PKT_BURST - retval);
+	TEST_ASSERT_EQUAL(retval, MAX_PKT_BURST,
+		"Expected to transmit %u packets but transmitted %d", MAX_PKT_BURST,
+		retval);
+
+	nb_pkts = 0;
+	FOR_EACH_SLAVE(i, slave) {
+		retval = rte_ring_dequeue_burst(slave->tx_queue, (void **)pkts,
+				RTE_DIM(pkts));
+		for (j = 0; j < retval; j++) {
+			hdr = rte_pktmbuf_mtod(pkts[j], struct ether_hdr *);
+			if (hdr->ether_type == ethtype_slow_be)
+				break;
+		}
+		free_pkts(pkts, retval);
+
+		TEST_ASSERT_EQUAL(j, retval,
+			"Slow packet sent through data queue of slave %u",
+			slave->port_id);
+		nb_pkts += retval;
+
+		/* Drop LACPDUs sent in the meantime */
+		retval = slave_get_pkts(slave, pkts, RTE_DIM(pkts));
+		free_pkts(pkts, retval);
+	}
+
+	TEST_ASSERT_EQUAL(nb_pkts, MAX_PKT_BURST,
+		"Expected %u packets on slaves but got %u", MAX_PKT_BURST, nb_pkts);
+
+	return cleanup_bonded_device_with_dedicated_queues();
+}
+
+#define TEST_RX_PERF_ITERATIONS 20000
+
+/*
+ * Measures cycles spent in bonded RX burst per packet, with slow frames
+ * filtered in RX burst or steered to control queues by the slaves.
+ */
+static int
+measure_mode4_rx_cycles(uint8_t dedicated_queues, double *cycles_per_pkt)
+{
+	struct slave_conf *slave;
+	struct rte_mbuf *pkts[TEST_DEFAULT_SLAVE_COUNT][MAX_PKT_BURST];
+	struct rte_mbuf *rx_pkts[TEST_DEFAULT_SLAVE_COUNT * MAX_PKT_BURST];
+	struct ether_addr bonded_mac, slave_mac;
+	uint64_t cycles = 0, start;
+	uint32_t iter;
+	uint16_t nb_rx, total;
+	uint8_t i;
+	int retval;
+
+	if (dedicated_queues)
+		retval = initialize_bonded_device_with_dedicated_queues(
+				TEST_DEFAULT_SLAVE_COUNT, 1);
+	else {
+		retval = initialize_bonded_device_with_slaves(
+				TEST_DEFAULT_SLAVE_COUNT, 1);
+		if (retval == TEST_SUCCESS)
+			retval = bond_handshake();
+	}
+	TEST_ASSERT_SUCCESS(retval, "Initial handshake failed");
+
+	rte_eth_promiscuous_enable(test_params.bonded_port_id);
+	rte_eth_macaddr_get(test_params.bonded_port_id, &bonded_mac);
+	ether_addr_copy(&slave_mac_default, &slave_mac);
+
+	FOR_EACH_SLAVE(i, slave) {
+		retval = generate_packets(&slave_mac, &bonded_mac,
+				MAX_PKT_BURST, pkts[i]);
+		TEST_ASSERT_EQUAL(retval, MAX_PKT_BURST, "Failed to generate packets");
+	}
+
+	for (iter = 0; iter < TEST_RX_PERF_ITERATIONS; iter++) {
+		FOR_EACH_SLAVE(i, slave) {
+			retval = slave_put_pkts(slave, pkts[i], MAX_PKT_BURST);
+			TEST_ASSERT_EQUAL(retval, MAX_PKT_BURST,
+				"Failed to enqueue packets to slave %u", slave->port_id);
+		}
+
+		total = 0;
+		start = rte_rdtsc();
+		do {
+			nb_rx = bond_rx(&rx_pkts[total], RTE_DIM(rx_pkts) - total);
+			total += nb_rx;
+		} while (nb_rx != 0 && total < RTE_DIM(rx_pkts));
+		cycles += rte_rdtsc() - start;
+
+		TEST_ASSERT_EQUAL(total, RTE_DIM(rx_pkts),
+			"Expected %u packets but received %u",
+			(unsigned)RTE_DIM(rx_pkts), total);
+	}
+
+	FOR_EACH_SLAVE(i, slave)
+		free_pkts(pkts[i], MAX_PKT_BURST);
+
+	*cycles_per_pkt = (double)cycles /
+			((double)TEST_RX_PERF_ITERATIONS * RTE_DIM(rx_pkts));
+
+	/* Drop LACPDUs sent while measuring */
+	FOR_EACH_SLAVE(i, slave) {
+		retval = slave_get_pkts(slave, rx_pkts, RTE_DIM(rx_pkts));
+		free_pkts(rx_pkts, retval);
+	}
+
+	if (dedicated_queues)
+		return cleanup_bonded_device_with_dedicated_queues();
+
+	return remove_slaves_and_stop_bonded_device();
+}
+
+static int
+test_mode4_rx_dedicated_queues_perf(void)
+{
+	double cycles_inline, cycles_dedicated;
+
+	TEST_ASSERT_SUCCESS(measure_mode4_rx_cycles(0, &cycles_inline),
+		"RX measurement with slow frames filtered in RX burst failed");
+
+	TEST_ASSERT_SUCCESS(measure_mode4_rx_cycles(1, &cycles_dedicated),
+		"RX measurement with dedicated queues failed");
+
+	printf("Mode 4 RX burst, %u slaves, %u packets per slave burst:\n",
+		(unsigned)TEST_DEFAULT_SLAVE_COUNT, MAX_PKT_BURST);
+	printf("  slow frames filtered in RX burst: %.1f cycles/packet\n",
+		cycles_inline);
+	printf("  dedicated control queues:         %.1f cycles/packet\n",
+		cycles_dedicated);
+
+	return TEST_SUCCESS;
+}
+
 static int
 check_environment(void)
 {
@@ -1280,6 +1673,15 @@ check_environment(void)
 		if (rte_ring_count(port->tx_queue) != 0)
 			env_state |= 0x02;
 
+		if (rte_ring_count(port->ctrl_rx_queue) != 0)
+			env_state |= 0x01;
+
+		if (rte_ring_count(port->ctrl_tx_queue) != 0)
+			env_state |= 0x02;
+
+		if (port->slow_filter_set != 0)
+			env_state |= 0x20;
+
 		if (port->bonded != 0)
 			env_state |= 0x04;
 
@@ -1297,13 +1699,14 @@ check_environment(void)
 		env_state |= 0x10;
 
 	TEST_ASSERT_EQUAL(env_state, 0,
-		"Environment not clean (port %u):%s%s%s%s%s",
+		"Environment not clean (port %u):%s%s%s%s%s%s",
 		port->port_id,
 		env_state & 0x01 ? " slave rx queue not clean" : "",
 		env_state & 0x02 ? " slave tx queue not clean" : "",
 		env_state & 0x04 ? " port marked as enslaved" : "",
 		env_state & 0x80 ? " slave state is not reset" : "",
-		env_state & 0x10 ? " slave count not equal 0" : ".");
+		env_state & 0x10 ? " slave count not equal 0" : "",
+		env_state & 0x20 ? " slow filter left on slave" : ".");
 
 
 	return TEST_SUCCESS;
@@ -1334,6 +1737,9 @@ test_mode4_executor(int (*test_func)(void))
 		TEST_ASSERT_SUCCESS(remove_slaves_and_stop_bonded_device(),
 			"Failed to stop bonded device");
 
+		rte_eth_bond_8023ad_dedicated_queues_disable(
+				test_params.bonded_port_id);
+
 		FOR_EACH_PORT(i, port) {
 			while (rte_ring_count(port->rx_queue) != 0) {
 				if (rte_ring_dequeue(port->rx_queue, &pkt) == 0)
@@ -1344,6 +1750,19 @@ test_mode4_executor(int (*test_func)(void))
 				if (rte_ring_dequeue(port->tx_queue, &pkt) == 0)
 					rte_pktmbuf_free(pkt);
 			}
+
+			while (rte_ring_count(port->ctrl_rx_queue) != 0) {
+				if (rte_ring_dequeue(port->ctrl_rx_queue, &pkt) == 0)
+					rte_pktmbuf_free(pkt);
+			}
+
+			while (rte_ring_count(port->ctrl_tx_queue) != 0) {
+				if (rte_ring_dequeue(port->ctrl_tx_queue, &pkt) == 0)
+					rte_pktmbuf_free(pkt);
+			}
+
+			port->slow_filter_supported = 0;
+			port->slow_filter_set = 0;
 		}
 	}
 
@@ -1380,6 +1799,18 @@ test_mode4_expired_wrapper(void)
 	return test_mode4_executor(&test_mode4_expired);
 }
 
+static int
+test_mode4_dedicated_queues_wrapper(void)
+{
+	return test_mode4_executor(&test_mode4_dedicated_queues);
+}
+
+static int
+test_mode4_rx_dedicated_queues_perf_wrapper(void)
+{
+	return test_mode4_executor(&test_mode4_rx_dedicated_queues_perf);
+}
+
 static struct unit_test_suite link_bonding_mode4_test_suite  = {
 	.suite_name = "Link Bonding mode 4 Unit Test Suite",
 	.setup = test_setup,
@@ -1390,6 +1821,20 @@ static struct unit_test_suite link_bonding_mode4_test_suite  = {
 		TEST_CASE_NAMED("test_mode4_tx_burst", test_mode4_tx_burst_wrapper),
 		TEST_CASE_NAMED("test_mode4_marker", test_mode4_marker_wrapper),
 		TEST_CASE_NAMED("test_mode4_expired", test_mode4_expired_wrapper),
+		TEST_CASE_NAMED("test_mode4_dedicated_queues",
+				test_mode4_dedicated_queues_wrapper),
+		{ NULL, NULL, NULL, NULL, NULL } /**< NULL terminate unit test array */
+	}
+};
+
+/* Timing only, kept out of the functional suite */
+static struct unit_test_suite link_bonding_mode4_perf_test_suite  = {
+	.suite_name = "Link Bonding mode 4 Performance Test Suite",
+	.setup = test_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_NAMED("test_mode4_rx_dedicated_queues_perf",
+				test_mode4_rx_dedicated_queues_perf_wrapper),
 		{ NULL, NULL, NULL, NULL, NULL } /**< NULL terminate unit test array */
 	}
 };
@@ -1406,3 +1851,16 @@ static struct test_command link_bonding_cmd = {
 };
 
 REGISTER_TEST_COMMAND(link_bonding_cmd);
+
+static int
+test_link_bonding_mode4_perf(void)
+{
+	return unit_test_suite_runner(&link_bonding_mode4_perf_test_suite);
+}
+
+static struct test_command link_bonding_perf_cmd = {
+	.command = "link_bonding_mode4_perf_autotest",
+	.callback = test_link_bonding_mode4_perf,
+};
+
+REGISTER_TEST_COMMAND(link_bonding_perf_cmd);
@@ -0,0 +1,188 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "test.h"
+
+#include <rte_pie.h>
+
+/*
+ * PIE functional test
+ * ===================
+ *
+ * A single queue is simulated with a constant departure rate, using a
+ * 1 MHz time base. The queue is first loaded above its departure rate:
+ * PIE must start dropping packets and, once the initial burst has been
+ * absorbed, keep the queueing delay close to the reference delay without
+ * reaching the tail drop threshold.
+ * The queue is then loaded below its departure rate: the drop probability
+ * must decay to zero.
+ */
+
+#define TEST_TIME_HZ            1000000   /**< Simulation time base: 1 us */
+#define TEST_DEPARTURE_PERIOD   10        /**< One departure every 10 us */
+#define TEST_QDELAY_REF         15        /**< Reference delay (ms) */
+#define TEST_DP_UPDATE_INTERVAL 15        /**< Drop probability update interval (ms) */
+#define TEST_MAX_BURST          150       /**< Burst allowance (ms) */
+#define TEST_TAILQ_TH           8192      /**< Tail drop threshold (packets) */
+#define TEST_DURATION           (10 * TEST_TIME_HZ) /**< Simulated time per phase */
+
+struct test_queue_sim {
+	uint64_t time;
+	uint32_t q;
+	uint64_t n_enqueued;
+	uint64_t n_dropped;
+	uint64_t n_tail_dropped;  /**< Tail drops in the last second */
+	uint64_t qdelay_sum;      /**< Sum of the queue delays seen in the last second */
+	uint64_t qdelay_samples;
+};
+
+static void
+test_pie_run(const struct rte_pie_config *cfg, struct rte_pie *pie,
+	struct test_queue_sim *sim, uint32_t arrival_period)
+{
+	uint64_t end = sim->time + TEST_DURATION;
+	uint64_t next_arrival = sim->time;
+	uint64_t next_departure = sim->time;
+
+	sim->n_enqueued = 0;
+	sim->n_dropped = 0;
+	sim->n_tail_dropped = 0;
+	sim->qdelay_sum = 0;
+	sim->qdelay_samples = 0;
+
+	while (sim->time < end) {
+		if (next_arrival <= next_departure) {
+			int ret;
+
+			sim->time = next_arrival;
+			next_arrival += arrival_period;
+
+			ret = rte_pie_enqueue(cfg, pie, sim->q, sim->time);
+			if (ret == 0) {
+				sim->q++;
+				sim->n_enqueued++;
+			} else {
+				sim->n_dropped++;
+				if (end - sim->time < TEST_TIME_HZ)
+					sim->n_tail_dropped += (ret == 1);
+			}
+		} else {
+			sim->time = next_departure;
+			next_departure += TEST_DEPARTURE_PERIOD;
+
+			if (sim->q == 0)
+				continue;
+
+			rte_pie_dequeue(pie, sim->q, sim->time);
+			sim->q--;
+		}
+
+		if (end - sim->time < TEST_TIME_HZ) {
+			sim->qdelay_sum += (uint64_t) sim->q * TEST_DEPARTURE_PERIOD;
+			sim->qdelay_samples++;
+		}
+	}
+}
+
+static int
+test_pie(void)
+{
+	struct rte_pie_config cfg;
+	struct rte_pie pie;
+	struct test_queue_sim sim;
+	uint64_t qdelay_avg, qdelay_ref;
+
+	/* Invalid parameters */
+	TEST_ASSERT_FAIL(rte_pie_config_init(NULL, TEST_QDELAY_REF,
+		TEST_DP_UPDATE_INTERVAL, TEST_MAX_BURST, TEST_TAILQ_TH, TEST_TIME_HZ),
+		"Config init with NULL config did not fail\n");
+	TEST_ASSERT_FAIL(rte_pie_config_init(&cfg, 0,
+		TEST_DP_UPDATE_INTERVAL, TEST_MAX_BURST, TEST_TAILQ_TH, TEST_TIME_HZ),
+		"Config init with zero qdelay_ref did not fail\n");
+	TEST_ASSERT_FAIL(rte_pie_config_init(&cfg, TEST_QDELAY_REF,
+		0, TEST_MAX_BURST, TEST_TAILQ_TH, TEST_TIME_HZ),
+		"Config init with zero update interval did not fail\n");
+	TEST_ASSERT_FAIL(rte_pie_config_init(&cfg, TEST_QDELAY_REF,
+		TEST_DP_UPDATE_INTERVAL, TEST_MAX_BURST, 0, TEST_TIME_HZ),
+		"Config init with zero tail drop threshold did not fail\n");
+	TEST_ASSERT_FAIL(rte_pie_rt_data_init(NULL, &pie),
+		"Run-time data init with NULL config did not fail\n");
+
+	TEST_ASSERT_SUCCESS(rte_pie_config_init(&cfg, TEST_QDELAY_REF,
+		TEST_DP_UPDATE_INTERVAL, TEST_MAX_BURST, TEST_TAILQ_TH, TEST_TIME_HZ),
+		"Config init failed\n");
+	TEST_ASSERT_SUCCESS(rte_pie_rt_data_init(&cfg, &pie),
+		"Run-time data init failed\n");
+
+	memset(&sim, 0, sizeof(sim));
+	qdelay_ref = (uint64_t) TEST_QDELAY_REF * TEST_TIME_HZ / 1000;
+
+	/* Overload: arrival rate is twice the departure rate */
+	test_pie_run(&cfg, &pie, &sim, TEST_DEPARTURE_PERIOD / 2);
+	qdelay_avg = sim.qdelay_sum / sim.qdelay_samples;
+	printf("Overload: %"PRIu64" enqueued, %"PRIu64" dropped, "
+		"drop probability %.4f, average delay %"PRIu64" us\n",
+		sim.n_enqueued, sim.n_dropped,
+		(double) pie.drop_prob / RTE_PIE_PROB_ONE, qdelay_avg);
+
+	TEST_ASSERT(sim.n_dropped != 0, "No packet dropped under overload\n");
+	TEST_ASSERT_EQUAL(sim.n_tail_dropped, 0,
+		"Tail drop threshold reached under overload\n");
+	TEST_ASSERT((qdelay_avg > qdelay_ref / 2) && (qdelay_avg < qdelay_ref * 2),
+		"Average delay %"PRIu64" us too far from reference %"PRIu64" us\n",
+		qdelay_avg, qdelay_ref);
+
+	/* Underload: arrival rate is half the departure rate */
+	test_pie_run(&cfg, &pie, &sim, TEST_DEPARTURE_PERIOD * 2);
+	printf("Underload: %"PRIu64" enqueued, %"PRIu64" dropped, "
+		"drop probability %.4f\n",
+		sim.n_enqueued, sim.n_dropped,
+		(double) pie.drop_prob / RTE_PIE_PROB_ONE);
+
+	TEST_ASSERT_EQUAL(pie.drop_prob, 0,
+		"Drop probability did not decay under underload\n");
+	TEST_ASSERT(sim.q < 4, "Queue did not drain under underload\n");
+
+	return 0;
+}
+
+static struct test_command pie_cmd = {
+	.command = "pie_autotest",
+	.callback = test_pie,
+};
+REGISTER_TEST_COMMAND(pie_cmd);
@@ -33,9 +33,13 @@
 #include "test.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 
 #include <rte_eth_ring.h>
 #include <rte_ethdev.h>
+#include <rte_malloc.h>
 
 static struct rte_mempool *mp;
 
@@ -241,6 +245,137 @@ test_stats_reset(void)
 	return 0;
 }
 
+#ifdef RTE_ETHDEV_BURST_STATS
+static int
+get_xstat(uint8_t port, const char *name, uint64_t *value)
+{
+	struct rte_eth_xstats *xstats;
+	int i, n;
+
+	n = rte_eth_xstats_get(port, NULL, 0);
+	if (n <= 0)
+		return -1;
+	xstats = malloc(sizeof(*xstats) * n);
+	if (xstats == NULL)
+		return -1;
+	if (rte_eth_xstats_get(port, xstats, n) != n) {
+		free(xstats);
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (strcmp(xstats[i].name, name) == 0) {
+			*value = xstats[i].value;
+			free(xstats);
+			return 0;
+		}
+	}
+	free(xstats);
+	return -1;
+}
+
+static int
+test_burst_stats(void)
+{
+	static const struct {
+		const char *name;
+		uint64_t value;
+	} expected[] = {
+		{ "rx_queue_0_polls", 3 },
+		{ "rx_queue_0_empty_polls", 1 },
+		{ "rx_queue_0_burst_packets", 6 },
+		{ "rx_queue_0_burst_size_1_1", 1 },
+		{ "rx_queue_0_burst_size_4_7", 1 },
+		{ "rx_queue_0_burst_size_8_15", 0 },
+		{ "tx_queue_0_polls", 2 },
+		{ "tx_queue_0_empty_polls", 0 },
+		{ "tx_queue_0_burst_packets", 6 },
+		{ "tx_queue_0_burst_size_1_1", 1 },
+		{ "tx_queue_0_burst_size_4_7", 1 },
+		{ "tx_queue_0_burst_size_128_plus", 0 },
+	};
+	struct rte_mbuf bufs[5];
+	struct rte_mbuf *pbufs[5];
+	uint64_t value;
+	unsigned i;
+
+	printf("Testing ethdev burst stats\n");
+
+	for (i = 0; i < RTE_DIM(pbufs); i++)
+		pbufs[i] = &bufs[i];
+
+	rte_eth_xstats_reset(RXTX_PORT);
+
+	/* one empty poll, then bursts of 1 and 5 packets */
+	if (rte_eth_rx_burst(RXTX_PORT, 0, pbufs, 5) != 0 ||
+			rte_eth_tx_burst(RXTX_PORT, 0, pbufs, 1) != 1 ||
+			rte_eth_rx_burst(RXTX_PORT, 0, pbufs, 5) != 1 ||
+			rte_eth_tx_burst(RXTX_PORT, 0, pbufs, 5) != 5 ||
+			rte_eth_rx_burst(RXTX_PORT, 0, pbufs, 5) != 5) {
+		printf("Error: unexpected burst size on RXTX port\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(expected); i++) {
+		if (get_xstat(RXTX_PORT, expected[i].name, &value) < 0) {
+			printf("Error: no xstat %s\n", expected[i].name);
+			return -1;
+		}
+		if (value != expected[i].value) {
+			printf("Error: xstat %s is %"PRIu64", expected %"PRIu64"\n",
+				expected[i].name, value, expected[i].value);
+			return -1;
+		}
+	}
+
+	rte_eth_xstats_reset(RXTX_PORT);
+	if (get_xstat(RXTX_PORT, "rx_queue_0_polls", &value) < 0 ||
+			value != 0) {
+		printf("Error: burst stats are not reset\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * A port has no burst statistics before its queues are configured, and
+ * reconfiguring it does not leak them.
+ */
+static int
+test_burst_stats_alloc(void)
+{
+	struct rte_malloc_socket_stats before, after;
+	struct rte_eth_conf null_conf;
+	uint64_t value;
+	unsigned i;
+
+	printf("Testing ethdev burst stats allocation\n");
+
+	if (get_xstat(RXTX_PORT2, "rx_queue_0_polls", &value) == 0) {
+		printf("Error: burst stats on an unconfigured port\n");
+		return -1;
+	}
+
+	memset(&null_conf, 0, sizeof(null_conf));
+	rte_malloc_get_socket_stats(SOCKET0, &before);
+	for (i = 0; i < 10; i++) {
+		if (rte_eth_dev_configure(RXTX_PORT, 1, 2, &null_conf) < 0 ||
+				rte_eth_dev_configure(RXTX_PORT, 1, 1,
+					&null_conf) < 0) {
+			printf("Configure failed for RXTX port\n");
+			return -1;
+		}
+	}
+	rte_malloc_get_socket_stats(SOCKET0, &after);
+	if (after.alloc_count != before.alloc_count) {
+		printf("Error: %u allocations left by reconfiguring\n",
+			after.alloc_count - before.alloc_count);
+		return -1;
+	}
+	return 0;
+}
+#endif
+
 static int
 test_pmd_ring_pair_create_attach(void)
 {
@@ -428,10 +563,20 @@ test_pmd_ring(void)
 	if (test_stats_reset() < 0)
 		return -1;
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	if (test_burst_stats() < 0)
+		return -1;
+#endif
+
 	rte_eth_dev_stop(RX_PORT);
 	rte_eth_dev_stop(TX_PORT);
 	rte_eth_dev_stop(RXTX_PORT);
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	if (test_burst_stats_alloc() < 0)
+		return -1;
+#endif
+
 	if (test_pmd_ring_pair_create_attach() < 0)
 		return -1;
 
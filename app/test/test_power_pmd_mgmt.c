@@ -0,0 +1,375 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_power.h>
+#include <rte_power_pmd_mgmt.h>
+
+#include "test.h"
+
+#define NB_QUEUES 2
+#define RING_SIZE 64
+#define NB_MBUF 63
+#define BURST_SIZE 32
+#define THRESHOLD 8
+#define MAX_SLEEP_US 20
+#define NB_CYCLES 100
+
+static struct rte_mempool *pool;
+static struct rte_ring *rings[NB_QUEUES];
+static int port_id = -1;
+
+static int
+test_power_pmd_mgmt_setup(void)
+{
+	struct rte_eth_conf port_conf;
+	char name[RTE_RING_NAMESIZE];
+	unsigned q;
+
+	if (port_id >= 0)
+		return 0;
+
+	pool = rte_pktmbuf_pool_create("pmd_mgmt_pool", NB_MBUF, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	TEST_ASSERT_NOT_NULL(pool, "cannot create mbuf pool");
+
+	for (q = 0; q < NB_QUEUES; q++) {
+		snprintf(name, sizeof(name), "pmd_mgmt_ring%u", q);
+		rings[q] = rte_ring_create(name, RING_SIZE, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+		TEST_ASSERT_NOT_NULL(rings[q], "cannot create ring");
+	}
+
+	port_id = rte_eth_from_rings("pmd_mgmt", rings, NB_QUEUES, rings,
+		NB_QUEUES, rte_socket_id());
+	TEST_ASSERT(port_id >= 0, "cannot create ring port");
+
+	memset(&port_conf, 0, sizeof(port_conf));
+	TEST_ASSERT_SUCCESS(rte_eth_dev_configure(port_id, NB_QUEUES,
+			NB_QUEUES, &port_conf), "cannot configure port");
+	for (q = 0; q < NB_QUEUES; q++) {
+		TEST_ASSERT_SUCCESS(rte_eth_rx_queue_setup(port_id, q,
+				RING_SIZE, rte_socket_id(), NULL, pool),
+				"cannot set up RX queue");
+		TEST_ASSERT_SUCCESS(rte_eth_tx_queue_setup(port_id, q,
+				RING_SIZE, rte_socket_id(), NULL),
+				"cannot set up TX queue");
+	}
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(port_id), "cannot start port");
+	return 0;
+}
+
+/* poll a queue n times, return the number of packets received */
+static unsigned
+poll_queue(uint16_t queue_id, unsigned n)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	unsigned i, nb_rx = 0;
+	uint16_t k, nb;
+
+	for (i = 0; i < n; i++) {
+		nb = rte_eth_rx_burst(port_id, queue_id, pkts, BURST_SIZE);
+		for (k = 0; k < nb; k++)
+			rte_pktmbuf_free(pkts[k]);
+		nb_rx += nb;
+	}
+	return nb_rx;
+}
+
+/* put one packet on the ring behind an RX queue */
+static int
+inject_packet(uint16_t queue_id)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+
+	if (m == NULL)
+		return -1;
+	if (rte_ring_enqueue(rings[queue_id], m) != 0) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_power_pmd_mgmt_params(void)
+{
+	struct rte_power_pmd_mgmt_conf conf = {
+		.type = RTE_POWER_MGMT_TYPE_PAUSE,
+		.empty_poll_threshold = THRESHOLD,
+		.max_sleep_us = MAX_SLEEP_US,
+	};
+	struct rte_power_pmd_mgmt_conf conf2 = conf;
+	unsigned lcore_id = rte_lcore_id();
+
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, NULL), -EINVAL, "NULL configuration accepted");
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			NB_QUEUES, &conf), -EINVAL, "invalid queue accepted");
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(RTE_MAX_LCORE,
+			port_id, 0, &conf), -EINVAL, "invalid lcore accepted");
+	conf2.type = 0;
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf2), -EINVAL, "invalid mode accepted");
+
+	/* the ring PMD has no RX interrupt */
+	conf2.type = RTE_POWER_MGMT_TYPE_INTR;
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf2), -ENOTSUP, "interrupt mode accepted");
+	/* frequency scaling needs rte_power to be initialised */
+	rte_power_unset_env();
+	conf2.type = RTE_POWER_MGMT_TYPE_SCALE;
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf2), -ENOTSUP, "scale mode accepted");
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf), "cannot enable power management");
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf), -EEXIST, "queue enabled twice");
+	conf2 = conf;
+	conf2.empty_poll_threshold = THRESHOLD * 2;
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			1, &conf2), -EINVAL,
+			"different configurations on the same lcore");
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 0), "cannot disable power management");
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 0), -ENOENT, "queue disabled twice");
+	return 0;
+}
+
+static int
+test_power_pmd_mgmt_pause(void)
+{
+	struct rte_power_pmd_mgmt_conf conf = {
+		.type = RTE_POWER_MGMT_TYPE_PAUSE,
+		.empty_poll_threshold = THRESHOLD,
+		.max_sleep_us = MAX_SLEEP_US,
+	};
+	struct rte_power_pmd_mgmt_stats before, after;
+	unsigned lcore_id = rte_lcore_id();
+	uint64_t bound;
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf), "cannot enable power management");
+	rte_power_pmd_mgmt_stats_get(lcore_id, &before);
+
+	/* no sleep before the threshold */
+	poll_queue(0, THRESHOLD - 1);
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps,
+			"sleep before the threshold");
+
+	/* then one sleep per empty poll */
+	poll_queue(0, 1 + 100);
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.idle_entries, before.idle_entries + 1,
+			"queue not idle");
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps + 101,
+			"wrong number of sleeps");
+
+	/* the backoff is bounded, allowing some slack for the last pause */
+	bound = (after.sleeps - before.sleeps) *
+		(rte_get_tsc_hz() / 1000000) * (MAX_SLEEP_US * 2);
+	TEST_ASSERT(after.sleep_cycles - before.sleep_cycles <= bound,
+			"sleeps longer than %u us", MAX_SLEEP_US);
+	TEST_ASSERT(after.sleep_cycles - before.sleep_cycles >=
+			(after.sleeps - before.sleeps) *
+			(rte_get_tsc_hz() / 1000000) * MAX_SLEEP_US / 2,
+			"backoff not increased");
+
+	/* traffic wakes the queue up, polls do not sleep anymore */
+	TEST_ASSERT_SUCCESS(inject_packet(0), "cannot inject packet");
+	TEST_ASSERT_EQUAL(poll_queue(0, 1), 1, "packet not received");
+	rte_power_pmd_mgmt_stats_get(lcore_id, &before);
+	poll_queue(0, THRESHOLD - 1);
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps, "busy queue slept");
+	poll_queue(0, 1);
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps + 1,
+			"idle queue did not sleep");
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 0), "cannot disable power management");
+	rte_power_pmd_mgmt_stats_get(lcore_id, &before);
+	poll_queue(0, THRESHOLD * 2);
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps,
+			"sleep after disabling");
+	return 0;
+}
+
+/* an lcore only sleeps once all its queues are idle */
+static int
+test_power_pmd_mgmt_multi_queue(void)
+{
+	struct rte_power_pmd_mgmt_conf conf = {
+		.type = RTE_POWER_MGMT_TYPE_PAUSE,
+		.empty_poll_threshold = THRESHOLD,
+		.max_sleep_us = MAX_SLEEP_US,
+	};
+	struct rte_power_pmd_mgmt_stats before, after;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned i;
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf), "cannot enable power management");
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			1, &conf), "cannot enable power management");
+	rte_power_pmd_mgmt_stats_get(lcore_id, &before);
+
+	/* queue 1 keeps receiving */
+	for (i = 0; i < THRESHOLD * 2; i++) {
+		TEST_ASSERT_SUCCESS(inject_packet(1), "cannot inject packet");
+		poll_queue(0, 1);
+		TEST_ASSERT_EQUAL(poll_queue(1, 1), 1, "packet not received");
+	}
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps,
+			"sleep while a queue is busy");
+
+	/* both idle: one sleep per round over the queues */
+	for (i = 0; i < THRESHOLD * 2; i++) {
+		poll_queue(0, 1);
+		poll_queue(1, 1);
+	}
+	rte_power_pmd_mgmt_stats_get(lcore_id, &after);
+	TEST_ASSERT_EQUAL(after.idle_entries, before.idle_entries + 1,
+			"lcore not idle");
+	TEST_ASSERT_EQUAL(after.sleeps, before.sleeps + THRESHOLD,
+			"wrong number of sleeps");
+
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 0), "cannot disable power management");
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 1), "cannot disable power management");
+	return 0;
+}
+
+static volatile int slave_stop;
+
+static int
+slave_spin(__rte_unused void *arg)
+{
+	while (!slave_stop)
+		rte_pause();
+	return 0;
+}
+
+/* enabling and disabling does not leak the RX callbacks */
+static int
+test_power_pmd_mgmt_cycles(void)
+{
+	struct rte_power_pmd_mgmt_conf conf = {
+		.type = RTE_POWER_MGMT_TYPE_PAUSE,
+		.empty_poll_threshold = THRESHOLD,
+		.max_sleep_us = MAX_SLEEP_US,
+	};
+	struct rte_malloc_socket_stats before, after;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned i, slave_id;
+
+	/* a first cycle, for anything allocated on first use */
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id, port_id,
+			0, &conf), "cannot enable power management");
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+			port_id, 0), "cannot disable power management");
+
+	rte_malloc_get_socket_stats(rte_socket_id(), &before);
+	for (i = 0; i < NB_CYCLES; i++) {
+		TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(lcore_id,
+				port_id, 0, &conf),
+				"cannot enable power management");
+		poll_queue(0, 1);
+		TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(lcore_id,
+				port_id, 0), "cannot disable power management");
+	}
+	rte_malloc_get_socket_stats(rte_socket_id(), &after);
+	TEST_ASSERT_EQUAL(after.alloc_count, before.alloc_count,
+			"%u allocations left after %u cycles",
+			after.alloc_count - before.alloc_count, NB_CYCLES);
+
+	/* the callback of a queue an lcore may be polling is not freed */
+	slave_id = rte_get_next_lcore(-1, 1, 0);
+	if (slave_id >= RTE_MAX_LCORE)
+		return 0;
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_enable(slave_id,
+			port_id, 0, &conf), "cannot enable power management");
+	slave_stop = 0;
+	rte_eal_remote_launch(slave_spin, NULL, slave_id);
+	TEST_ASSERT_EQUAL(rte_power_pmd_mgmt_queue_disable(slave_id,
+			port_id, 0), -EBUSY, "queue of a running lcore disabled");
+	slave_stop = 1;
+	rte_eal_wait_lcore(slave_id);
+	TEST_ASSERT_SUCCESS(rte_power_pmd_mgmt_queue_disable(slave_id,
+			port_id, 0), "cannot disable power management");
+	return 0;
+}
+
+static struct unit_test_suite power_pmd_mgmt_test_suite = {
+	.suite_name = "PMD Power Management Unit Test Suite",
+	.setup = test_power_pmd_mgmt_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_power_pmd_mgmt_params),
+		TEST_CASE(test_power_pmd_mgmt_pause),
+		TEST_CASE(test_power_pmd_mgmt_multi_queue),
+		TEST_CASE(test_power_pmd_mgmt_cycles),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_power_pmd_mgmt(void)
+{
+	return unit_test_suite_runner(&power_pmd_mgmt_test_suite);
+}
+
+static struct test_command power_pmd_mgmt_cmd = {
+	.command = "power_pmd_mgmt_autotest",
+	.callback = test_power_pmd_mgmt,
+};
+REGISTER_TEST_COMMAND(power_pmd_mgmt_cmd);
@@ -73,6 +73,24 @@ static struct rte_sched_pipe_params pipe_profile[] = {
 	},
 };
 
+static struct rte_sched_subport_params subport_param_update = {
+	.tb_rate = 625000000,
+	.tb_size = 500000,
+
+	.tc_rate = {625000000, 625000000, 625000000, 625000000},
+	.tc_period = 20,
+};
+
+static struct rte_sched_pipe_params pipe_profile_update = {
+	.tb_rate = 610350,
+	.tb_size = 500000,
+
+	.tc_rate = {610350, 610350, 610350, 610350},
+	.tc_period = 20,
+
+	.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
+};
+
 static struct rte_sched_port_params port_param = {
 	.socket = 0, /* computed */
 	.rate = 0, /* computed */
@@ -195,6 +213,31 @@ test_sched(void)
 	}
 
 
+	/* Run-time update must keep the packets queued by the pipe */
+	uint32_t profile_id;
+
+	err = rte_sched_port_pipe_profile_add(port, &pipe_profile_update, &profile_id);
+	TEST_ASSERT_SUCCESS(err, "Error adding pipe profile, err=%d\n", err);
+	TEST_ASSERT_EQUAL(profile_id, 1, "Wrong pipe profile id %u\n", profile_id);
+
+	for (i = 0; i < 10; i++)
+		prepare_pkt(out_mbufs[i]);
+
+	err = rte_sched_port_enqueue(port, out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_subport_update(port, SUBPORT, &subport_param_update);
+	TEST_ASSERT_SUCCESS(err, "Error updating subport, err=%d\n", err);
+
+	err = rte_sched_pipe_update(port, SUBPORT, PIPE, profile_id);
+	TEST_ASSERT_SUCCESS(err, "Error updating pipe, err=%d\n", err);
+
+	err = rte_sched_pipe_update(port, SUBPORT, PIPE, profile_id + 1);
+	TEST_ASSERT_FAIL(err, "Pipe update with invalid profile did not fail\n");
+
+	err = rte_sched_port_dequeue(port, in_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong dequeue after update, err=%d\n", err);
+
 	struct rte_sched_subport_stats subport_stats;
 	uint32_t tc_ov;
 	rte_sched_subport_read_stats(port, SUBPORT, &subport_stats, &tc_ov);
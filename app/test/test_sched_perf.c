@@ -0,0 +1,285 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_random.h>
+#include <rte_sched.h>
+
+#include "test.h"
+
+/*
+ * Scheduler performance test with run-time reconfiguration
+ * ========================================================
+ *
+ * Measures the enqueue/dequeue throughput of a port scheduler instance
+ * first with a static configuration, then while pipes are moved between
+ * two pipe profiles and the subport rates are changed at a fixed rate,
+ * using rte_sched_pipe_update() and rte_sched_subport_update().
+ */
+
+#define N_PIPES            4096
+#define N_MBUF             8191
+#define MBUF_DATA_SZ       (2048 + RTE_PKTMBUF_HEADROOM)
+#define MEMPOOL_CACHE_SZ   256
+#define BURST_SIZE         64
+#define TEST_DURATION_MS   500
+#define UPDATES_PER_SEC    10000
+#define SUBPORT_UPDATE_MASK 0x3FF /* one subport update every 1024 updates */
+
+static struct rte_sched_subport_params subport_params[] = {
+	{
+		.tb_rate = 4000000000U,
+		.tb_size = 1000000,
+
+		.tc_rate = {4000000000U, 4000000000U, 4000000000U, 4000000000U},
+		.tc_period = 10,
+	},
+	{
+		.tb_rate = 2000000000,
+		.tb_size = 500000,
+
+		.tc_rate = {2000000000, 2000000000, 2000000000, 2000000000},
+		.tc_period = 20,
+	},
+};
+
+static struct rte_sched_pipe_params pipe_profiles[] = {
+	{ /* Profile #0 */
+		.tb_rate = 4000000000U,
+		.tb_size = 1000000,
+
+		.tc_rate = {4000000000U, 4000000000U, 4000000000U, 4000000000U},
+		.tc_period = 40,
+
+		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
+	},
+	{ /* Profile #1 */
+		.tb_rate = 2000000000,
+		.tb_size = 500000,
+
+		.tc_rate = {2000000000, 1000000000, 1000000000, 500000000},
+		.tc_period = 10,
+
+		.wrr_weights = {1, 2, 4, 8,  1, 2, 4, 8,  1, 1, 1, 1,  8, 4, 2, 1},
+	},
+};
+
+static struct rte_sched_port_params port_params = {
+	.name = "sched_perf",
+	.socket = 0,
+	.rate = 4000000000U,
+	.mtu = 1522,
+	.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
+	.n_subports_per_port = 1,
+	.n_pipes_per_subport = N_PIPES,
+	.qsize = {64, 64, 64, 64},
+	.pipe_profiles = pipe_profiles,
+	.n_pipe_profiles = RTE_DIM(pipe_profiles),
+};
+
+static struct rte_sched_port *
+sched_perf_port_create(void)
+{
+	struct rte_sched_port *port;
+	uint32_t pipe;
+
+	port = rte_sched_port_config(&port_params);
+	if (port == NULL)
+		return NULL;
+
+	if (rte_sched_subport_config(port, 0, &subport_params[0]) != 0)
+		goto error;
+
+	for (pipe = 0; pipe < N_PIPES; pipe++)
+		if (rte_sched_pipe_config(port, 0, pipe, 0) != 0)
+			goto error;
+
+	return port;
+
+error:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+/* Dequeue and free the packets left in the port, waiting for credits */
+static uint64_t
+sched_perf_port_drain(struct rte_sched_port *port, uint64_t n_pkts)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t end, n_deq = 0;
+	uint32_t i, n;
+
+	end = rte_rdtsc() + rte_get_tsc_hz() / 10;
+	while (n_deq < n_pkts && rte_rdtsc() < end) {
+		n = rte_sched_port_dequeue(port, pkts, BURST_SIZE);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(pkts[i]);
+		n_deq += n;
+	}
+
+	return n_deq;
+}
+
+static int
+sched_perf_run(struct rte_mempool *mp, uint32_t updates_per_sec)
+{
+	struct rte_sched_port *port;
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t update_period, next_update, start, end, now;
+	uint64_t n_enq = 0, n_deq = 0, n_updates = 0;
+	uint32_t i, n;
+
+	port = sched_perf_port_create();
+	if (port == NULL) {
+		printf("Error configuring sched port\n");
+		return -1;
+	}
+
+	start = rte_rdtsc();
+	end = start + hz * TEST_DURATION_MS / 1000;
+	if (updates_per_sec != 0) {
+		update_period = hz / updates_per_sec;
+		next_update = start + update_period;
+	} else {
+		update_period = 0;
+		next_update = UINT64_MAX;
+	}
+
+	for (now = start; now < end; now = rte_rdtsc()) {
+		for (i = 0; i < BURST_SIZE; i++) {
+			uint32_t r = (uint32_t) rte_rand();
+
+			pkts[i] = rte_pktmbuf_alloc(mp);
+			if (pkts[i] == NULL)
+				break;
+
+			pkts[i]->pkt_len = 60;
+			pkts[i]->data_len = 60;
+			rte_sched_port_pkt_write(pkts[i], 0, r % N_PIPES,
+				(r >> 16) & 3, (r >> 18) & 3, e_RTE_METER_GREEN);
+		}
+		n_enq += rte_sched_port_enqueue(port, pkts, i);
+
+		n = rte_sched_port_dequeue(port, pkts, BURST_SIZE);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(pkts[i]);
+		n_deq += n;
+
+		/* Control plane updates, interleaved with the data path */
+		while (now >= next_update) {
+			uint32_t pipe = (uint32_t) rte_rand() % N_PIPES;
+
+			if (rte_sched_pipe_update(port, 0, pipe,
+					(int32_t) (n_updates & 1)) != 0) {
+				printf("Error updating pipe %u\n", pipe);
+				goto error;
+			}
+
+			if ((n_updates & SUBPORT_UPDATE_MASK) == 0 &&
+				rte_sched_subport_update(port, 0,
+					&subport_params[(n_updates >> 10) & 1]) != 0) {
+				printf("Error updating subport\n");
+				goto error;
+			}
+
+			n_updates++;
+			next_update += update_period;
+		}
+	}
+
+	n_deq += sched_perf_port_drain(port, n_enq - n_deq);
+
+	now = rte_rdtsc();
+	printf("%6u updates/s requested: %"PRIu64" updates, "
+		"%"PRIu64" pkts enqueued, %"PRIu64" pkts dequeued, "
+		"%.2f Mpps, %.1f cycles/pkt\n",
+		updates_per_sec, n_updates, n_enq, n_deq,
+		(double) n_deq * hz / (now - start) / 1000000,
+		(double) (now - start) / (n_deq ? n_deq : 1));
+
+	rte_sched_port_free(port);
+
+	if (n_deq != n_enq) {
+		printf("Packets lost: %"PRIu64" enqueued, %"PRIu64" dequeued\n",
+			n_enq, n_deq);
+		return -1;
+	}
+
+	return 0;
+
+error:
+	sched_perf_port_drain(port, n_enq - n_deq);
+	rte_sched_port_free(port);
+	return -1;
+}
+
+static int
+test_sched_perf(void)
+{
+	struct rte_mempool *mp;
+
+	mp = rte_mempool_lookup("sched_perf");
+	if (mp == NULL)
+		mp = rte_pktmbuf_pool_create("sched_perf", N_MBUF,
+			MEMPOOL_CACHE_SZ, 0, MBUF_DATA_SZ, SOCKET_ID_ANY);
+	if (mp == NULL) {
+		printf("Error creating mempool\n");
+		return -1;
+	}
+
+	if (sched_perf_run(mp, 0) != 0)
+		return -1;
+
+	if (sched_perf_run(mp, UPDATES_PER_SEC) != 0)
+		return -1;
+
+	if (rte_mempool_count(mp) != N_MBUF) {
+		printf("Mbufs leaked: %u of %u in the pool\n",
+			rte_mempool_count(mp), N_MBUF);
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct test_command sched_perf_cmd = {
+	.command = "sched_perf_autotest",
+	.callback = test_sched_perf,
+};
+REGISTER_TEST_COMMAND(sched_perf_cmd);
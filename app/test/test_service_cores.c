@@ -0,0 +1,416 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_service.h>
+
+#include "test.h"
+
+#define WAIT_MS 1000 /* maximum time to wait for a service lcore */
+
+/* state shared with the test services */
+struct test_service {
+	rte_atomic32_t calls;
+	rte_atomic32_t active;  /* lcores currently in the callback */
+	rte_atomic32_t overlap; /* set if two lcores entered at once */
+};
+
+static struct test_service svc_a, svc_b;
+
+static int32_t
+test_service_func(void *arg)
+{
+	struct test_service *ts = arg;
+
+	if (rte_atomic32_add_return(&ts->active, 1) > 1)
+		rte_atomic32_set(&ts->overlap, 1);
+	rte_delay_us(1);
+	rte_atomic32_inc(&ts->calls);
+	rte_atomic32_dec(&ts->active);
+	return 0;
+}
+
+static int32_t
+test_service_idle_func(__attribute__((unused)) void *arg)
+{
+	return -EAGAIN;
+}
+
+static int
+register_service(const char *name, rte_service_func func,
+		struct test_service *ts, uint32_t caps, uint32_t *id)
+{
+	struct rte_service_spec spec;
+
+	memset(&spec, 0, sizeof(spec));
+	snprintf(spec.name, sizeof(spec.name), "%s", name);
+	spec.callback = func;
+	spec.callback_userdata = ts;
+	spec.capabilities = caps;
+	spec.socket_id = SOCKET_ID_ANY;
+	if (ts != NULL)
+		memset(ts, 0, sizeof(*ts));
+	return rte_service_register(&spec, id);
+}
+
+/* wait until a service was called at least n more times than before */
+static int
+wait_calls(struct test_service *ts, int32_t n)
+{
+	int32_t target = rte_atomic32_read(&ts->calls) + n;
+	unsigned ms;
+
+	for (ms = 0; ms < WAIT_MS; ms++) {
+		if (rte_atomic32_read(&ts->calls) >= target)
+			return 0;
+		rte_delay_ms(1);
+	}
+	return -1;
+}
+
+static int
+test_service_teardown(void)
+{
+	uint32_t id;
+
+	rte_service_lcore_reset_all();
+	for (id = 0; id < RTE_SERVICE_NUM_MAX; id++)
+		rte_service_unregister(id);
+	return 0;
+}
+
+static int
+test_service_register(void)
+{
+	struct rte_service_spec spec;
+	uint32_t id, id2;
+
+	memset(&spec, 0, sizeof(spec));
+	TEST_ASSERT_EQUAL(rte_service_register(NULL, &id), -EINVAL,
+			"NULL spec accepted");
+	TEST_ASSERT_EQUAL(rte_service_register(&spec, &id), -EINVAL,
+			"spec without name nor callback accepted");
+	snprintf(spec.name, sizeof(spec.name), "no_callback");
+	TEST_ASSERT_EQUAL(rte_service_register(&spec, &id), -EINVAL,
+			"spec without callback accepted");
+
+	TEST_ASSERT_SUCCESS(register_service("svc_a", test_service_func,
+			&svc_a, 0, &id), "cannot register service");
+	TEST_ASSERT_EQUAL(register_service("svc_a", test_service_func,
+			&svc_b, 0, &id2), -EEXIST, "duplicate name accepted");
+	TEST_ASSERT_EQUAL(rte_service_count(), 1, "wrong service count");
+
+	TEST_ASSERT_SUCCESS(rte_service_get_by_name("svc_a", &id2),
+			"cannot find service by name");
+	TEST_ASSERT_EQUAL(id, id2, "wrong service id");
+	TEST_ASSERT_EQUAL(rte_service_get_by_name("svc_b", &id2), -ENOENT,
+			"unknown service found");
+	TEST_ASSERT(strcmp(rte_service_get_name(id), "svc_a") == 0,
+			"wrong service name");
+	TEST_ASSERT_EQUAL(rte_service_runstate_get(id), 0,
+			"service not created stopped");
+
+	TEST_ASSERT_SUCCESS(rte_service_unregister(id),
+			"cannot unregister service");
+	TEST_ASSERT_EQUAL(rte_service_unregister(id), -EINVAL,
+			"service unregistered twice");
+	TEST_ASSERT_NULL(rte_service_get_name(id),
+			"unregistered service has a name");
+	TEST_ASSERT_EQUAL(rte_service_count(), 0, "wrong service count");
+	return 0;
+}
+
+static int
+test_service_lcore_add_del(void)
+{
+	unsigned slave = rte_get_next_lcore(-1, 1, 0);
+	unsigned lcore_count = rte_lcore_count();
+	unsigned list[RTE_MAX_LCORE];
+
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(rte_get_master_lcore()),
+			-EINVAL, "master lcore turned into a service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(RTE_MAX_LCORE), -EINVAL,
+			"invalid lcore turned into a service lcore");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(slave),
+			"cannot add service lcore %u", slave);
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(slave), -EALREADY,
+			"service lcore added twice");
+	TEST_ASSERT_EQUAL(rte_service_lcore_count(), 1,
+			"wrong service lcore count");
+	TEST_ASSERT_EQUAL(rte_service_lcore_list(list, RTE_DIM(list)), 1,
+			"wrong service lcore list size");
+	TEST_ASSERT_EQUAL(list[0], slave, "wrong service lcore list");
+	TEST_ASSERT_EQUAL(rte_lcore_count(), lcore_count - 1,
+			"service lcore still counted");
+	TEST_ASSERT(!rte_lcore_is_enabled(slave),
+			"service lcore still enabled");
+	TEST_ASSERT_EQUAL(rte_eal_lcore_role(slave), ROLE_SERVICE,
+			"wrong service lcore role");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(slave),
+			"cannot start service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_start(slave), -EALREADY,
+			"service lcore started twice");
+	TEST_ASSERT_EQUAL(rte_service_lcore_del(slave), -EBUSY,
+			"running service lcore deleted");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(slave),
+			"cannot stop service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_stop(slave), -EALREADY,
+			"service lcore stopped twice");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_del(slave),
+			"cannot delete service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_count(), 0,
+			"wrong service lcore count");
+	TEST_ASSERT_EQUAL(rte_lcore_count(), lcore_count,
+			"lcore not counted back");
+	TEST_ASSERT(rte_lcore_is_enabled(slave), "lcore not enabled back");
+	return 0;
+}
+
+/* two services sharing one service lcore, mapped and unmapped at runtime */
+static int
+test_service_run(void)
+{
+	unsigned slave = rte_get_next_lcore(-1, 1, 0);
+	struct rte_service_stats stats;
+	uint32_t id_a, id_b, id_idle;
+	int32_t calls;
+
+	TEST_ASSERT_SUCCESS(register_service("svc_a", test_service_func,
+			&svc_a, 0, &id_a), "cannot register service a");
+	TEST_ASSERT_SUCCESS(register_service("svc_b", test_service_func,
+			&svc_b, 0, &id_b), "cannot register service b");
+	TEST_ASSERT_SUCCESS(register_service("svc_idle",
+			test_service_idle_func, NULL, 0, &id_idle),
+			"cannot register idle service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(slave),
+			"cannot add service lcore");
+
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_set(id_a,
+			rte_get_master_lcore(), 1), -EINVAL,
+			"service mapped to a non-service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_a, slave, 1),
+			"cannot map service a");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_idle, slave, 1),
+			"cannot map idle service");
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_get(id_a, slave), 1,
+			"service a not mapped");
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_get(id_b, slave), 0,
+			"service b mapped");
+	TEST_ASSERT_SUCCESS(rte_service_set_stats_enable(id_a, 1),
+			"cannot enable stats");
+
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_a, 1),
+			"cannot start service a");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_b, 1),
+			"cannot start service b");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_idle, 1),
+			"cannot start idle service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(slave),
+			"cannot start service lcore");
+
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 10), "service a not run");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_b.calls), 0,
+			"unmapped service b run");
+
+	/* map b at runtime: both services share the lcore */
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_b, slave, 1),
+			"cannot map service b");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_b, 10), "service b not run");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 10),
+			"service a not run along with b");
+
+	/* a stopped service is skipped */
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_b, 0),
+			"cannot stop service b");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 10), "service a not run");
+	calls = rte_atomic32_read(&svc_b.calls);
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 10), "service a not run");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_b.calls), calls,
+			"stopped service b run");
+
+	/* unmap a at runtime */
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_a, slave, 0),
+			"cannot unmap service a");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_b, 1),
+			"cannot start service b");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_b, 10), "service b not run");
+	calls = rte_atomic32_read(&svc_a.calls);
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_b, 10), "service b not run");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_a.calls), calls,
+			"unmapped service a run");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(slave),
+			"cannot stop service lcore");
+
+	TEST_ASSERT_SUCCESS(rte_service_stats_get(id_a, &stats),
+			"cannot get stats");
+	TEST_ASSERT_EQUAL(stats.calls, (uint64_t)rte_atomic32_read(&svc_a.calls),
+			"wrong call count");
+	TEST_ASSERT_EQUAL(stats.idle_calls, 0, "wrong idle call count");
+	TEST_ASSERT(stats.cycles >= stats.calls * (rte_get_tsc_hz() / 1000000),
+			"cycles not accounted");
+	TEST_ASSERT_SUCCESS(rte_service_stats_get(id_idle, &stats),
+			"cannot get stats");
+	TEST_ASSERT(stats.calls != 0 && stats.idle_calls == stats.calls,
+			"wrong idle call count");
+	TEST_ASSERT_EQUAL(stats.cycles, 0, "cycles accounted while disabled");
+
+	rte_service_dump(stdout);
+	return 0;
+}
+
+/* an MT-unsafe service mapped to two service lcores is never run twice
+ * at once, an MT-safe one is run by both */
+static int
+test_service_mt_unsafe(void)
+{
+	unsigned slave1 = rte_get_next_lcore(-1, 1, 0);
+	unsigned slave2 = rte_get_next_lcore(slave1, 1, 0);
+	uint32_t id_a, id_b;
+
+	if (slave2 >= RTE_MAX_LCORE) {
+		printf("not enough lcores, skipping %s\n", __func__);
+		return 0;
+	}
+
+	TEST_ASSERT_SUCCESS(register_service("svc_unsafe", test_service_func,
+			&svc_a, 0, &id_a), "cannot register service a");
+	TEST_ASSERT_SUCCESS(register_service("svc_safe", test_service_func,
+			&svc_b, RTE_SERVICE_CAP_MT_SAFE, &id_b),
+			"cannot register service b");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(slave1),
+			"cannot add service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(slave2),
+			"cannot add service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_a, slave1, 1),
+			"cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_a, slave2, 1),
+			"cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_b, slave1, 1),
+			"cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id_b, slave2, 1),
+			"cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_a, 1),
+			"cannot start service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id_b, 1),
+			"cannot start service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(slave1),
+			"cannot start service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(slave2),
+			"cannot start service lcore");
+
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 100), "service a not run");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_b, 100), "service b not run");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_a.overlap), 0,
+			"MT-unsafe service run concurrently");
+	return 0;
+}
+
+/* unregistering a running service waits for its last call to end */
+static int
+test_service_unregister_running(void)
+{
+	unsigned slave = rte_get_next_lcore(-1, 1, 0);
+	int32_t calls;
+	uint32_t id;
+
+	TEST_ASSERT_SUCCESS(register_service("svc_a", test_service_func,
+			&svc_a, 0, &id), "cannot register service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(slave),
+			"cannot add service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, slave, 1),
+			"cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id, 1),
+			"cannot start service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(slave),
+			"cannot start service lcore");
+	TEST_ASSERT_SUCCESS(wait_calls(&svc_a, 10), "service not run");
+
+	TEST_ASSERT_SUCCESS(rte_service_unregister(id),
+			"cannot unregister running service");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_a.active), 0,
+			"service still running after unregister");
+	calls = rte_atomic32_read(&svc_a.calls);
+	rte_delay_ms(10);
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&svc_a.calls), calls,
+			"service run after unregister");
+	return 0;
+}
+
+static struct unit_test_suite service_cores_test_suite = {
+	.suite_name = "Service Cores Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(NULL, test_service_teardown,
+				test_service_register),
+		TEST_CASE_ST(NULL, test_service_teardown,
+				test_service_lcore_add_del),
+		TEST_CASE_ST(NULL, test_service_teardown,
+				test_service_run),
+		TEST_CASE_ST(NULL, test_service_teardown,
+				test_service_mt_unsafe),
+		TEST_CASE_ST(NULL, test_service_teardown,
+				test_service_unregister_running),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_service_cores(void)
+{
+	if (rte_lcore_count() + rte_service_lcore_count() < 2) {
+		printf("not enough lcores for this test\n");
+		return 0;
+	}
+	/* give back the service lcores set up with -s, if any */
+	rte_service_lcore_reset_all();
+	return unit_test_suite_runner(&service_cores_test_suite);
+}
+
+static struct test_command service_cores_cmd = {
+	.command = "service_cores_autotest",
+	.callback = test_service_cores,
+};
+REGISTER_TEST_COMMAND(service_cores_cmd);
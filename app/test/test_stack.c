@@ -0,0 +1,372 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_mempool.h>
+#include <rte_stack.h>
+
+#include "test.h"
+
+/*
+ * Stack
+ * =====
+ *
+ * - Basic tests, done on one core, for both the spinlock and the lock-free
+ *   variants:
+ *
+ *   - Create a stack, check the lookup, the bad arguments and the free.
+ *   - Push and pop objects one by one and in bulk, check the LIFO order
+ *     and the all-or-nothing behaviour on a full or an empty stack.
+ *
+ * - Concurrent test: all the enabled lcores pop objects from a shared
+ *   stack and push them back; at the end, each object must be in the
+ *   stack exactly once.
+ *
+ * - Mempool test: create mempools with MEMPOOL_F_STACK and
+ *   MEMPOOL_F_STACK_LF, get and put all their objects.
+ */
+
+#define STACK_SIZE 4096
+#define MAX_BULK 32
+#define N_ITER 10000
+
+static struct rte_stack *shared_stack;
+static rte_atomic32_t synchro;
+
+static int
+test_stack_basic(uint32_t flags)
+{
+	struct rte_stack *s;
+	void *obj_table[STACK_SIZE];
+	void *popped[STACK_SIZE];
+	unsigned i, j;
+	int ret = -1;
+
+	s = rte_stack_create("test_stack", STACK_SIZE, SOCKET_ID_ANY, flags);
+	if (s == NULL) {
+		printf("cannot create stack (flags %#x)\n", flags);
+		return -1;
+	}
+
+	if (rte_stack_lookup("test_stack") != s) {
+		printf("cannot lookup stack\n");
+		goto fail;
+	}
+	if (rte_stack_create("test_stack", STACK_SIZE, SOCKET_ID_ANY,
+			flags) != NULL) {
+		printf("stack with a duplicated name was created\n");
+		goto fail;
+	}
+
+	if (rte_stack_count(s) != 0 ||
+			rte_stack_free_count(s) != STACK_SIZE) {
+		printf("new stack is not empty\n");
+		goto fail;
+	}
+
+	for (i = 0; i < STACK_SIZE; i++)
+		obj_table[i] = (void *)(uintptr_t)(i + 1);
+
+	/* popping from an empty stack must fail */
+	if (rte_stack_pop(s, popped, 1) != 0) {
+		printf("pop from an empty stack succeeded\n");
+		goto fail;
+	}
+
+	/* one by one: objects come back in reverse order */
+	for (i = 0; i < MAX_BULK; i++) {
+		if (rte_stack_push(s, &obj_table[i], 1) != 1) {
+			printf("cannot push object %u\n", i);
+			goto fail;
+		}
+	}
+	for (i = 0; i < MAX_BULK; i++) {
+		if (rte_stack_pop(s, &popped[i], 1) != 1 ||
+				popped[i] != obj_table[MAX_BULK - 1 - i]) {
+			printf("bad object popped at %u\n", i);
+			goto fail;
+		}
+	}
+
+	/* in bulk, fill the stack entirely */
+	for (i = 0; i < STACK_SIZE; i += MAX_BULK) {
+		if (rte_stack_push(s, &obj_table[i], MAX_BULK) != MAX_BULK) {
+			printf("cannot push bulk at %u\n", i);
+			goto fail;
+		}
+	}
+	if (rte_stack_count(s) != STACK_SIZE ||
+			rte_stack_free_count(s) != 0) {
+		printf("bad count on a full stack: %u\n", rte_stack_count(s));
+		goto fail;
+	}
+
+	/* pushing on a full stack must fail and leave the stack unchanged */
+	if (rte_stack_push(s, obj_table, 1) != 0 ||
+			rte_stack_count(s) != STACK_SIZE) {
+		printf("push on a full stack succeeded\n");
+		goto fail;
+	}
+
+	for (i = 0; i < STACK_SIZE; i += MAX_BULK) {
+		if (rte_stack_pop(s, &popped[i], MAX_BULK) != MAX_BULK) {
+			printf("cannot pop bulk at %u\n", i);
+			goto fail;
+		}
+	}
+	for (i = 0; i < STACK_SIZE; i++) {
+		j = STACK_SIZE - 1 - i;
+		if (popped[i] != obj_table[j]) {
+			printf("bad object popped at %u\n", i);
+			goto fail;
+		}
+	}
+
+	/* a bulk bigger than the content must not pop anything */
+	if (rte_stack_push(s, obj_table, 4) != 4 ||
+			rte_stack_pop(s, popped, 5) != 0 ||
+			rte_stack_count(s) != 4 ||
+			rte_stack_pop(s, popped, 4) != 4) {
+		printf("partial pop was not refused\n");
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	rte_stack_free(s);
+	if (ret == 0 && rte_stack_lookup("test_stack") != NULL) {
+		printf("stack can still be looked up after free\n");
+		ret = -1;
+	}
+	return ret;
+}
+
+static int
+test_stack_bad_args(void)
+{
+	if (rte_stack_create(NULL, STACK_SIZE, SOCKET_ID_ANY, 0) != NULL ||
+			rte_errno != EINVAL) {
+		printf("stack created without a name\n");
+		return -1;
+	}
+	if (rte_stack_create("test_stack", 0, SOCKET_ID_ANY, 0) != NULL ||
+			rte_errno != EINVAL) {
+		printf("stack created with a null size\n");
+		return -1;
+	}
+	if (rte_stack_create("test_stack", STACK_SIZE, SOCKET_ID_ANY,
+			0x8000) != NULL || rte_errno != EINVAL) {
+		printf("stack created with bad flags\n");
+		return -1;
+	}
+	if (rte_stack_lookup("test_stack_none") != NULL ||
+			rte_errno != ENOENT) {
+		printf("lookup of an unknown stack succeeded\n");
+		return -1;
+	}
+	rte_stack_free(NULL);
+	return 0;
+}
+
+static int
+concurrent_worker(__attribute__((unused)) void *arg)
+{
+	void *objs[MAX_BULK];
+	unsigned lcore_id = rte_lcore_id();
+	unsigned i, n;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		;
+
+	for (i = 0; i < N_ITER; i++) {
+		n = (i + lcore_id) % MAX_BULK + 1;
+		if (rte_stack_pop(shared_stack, objs, n) != n)
+			continue;
+		if (rte_stack_push(shared_stack, objs, n) != n) {
+			printf("lcore %u: cannot push back objects\n",
+				lcore_id);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_stack_concurrent(uint32_t flags)
+{
+	static uint8_t seen[STACK_SIZE];
+	void *objs[STACK_SIZE];
+	unsigned lcore_id, i, idx;
+	int ret = 0;
+
+	shared_stack = rte_stack_create("test_stack_mt", STACK_SIZE,
+		SOCKET_ID_ANY, flags);
+	if (shared_stack == NULL) {
+		printf("cannot create stack (flags %#x)\n", flags);
+		return -1;
+	}
+
+	/* only a part of the objects, so that pops can fail too */
+	for (i = 0; i < STACK_SIZE / 8; i++)
+		objs[i] = (void *)(uintptr_t)(i + 1);
+	rte_stack_push(shared_stack, objs, STACK_SIZE / 8);
+
+	rte_atomic32_init(&synchro);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(concurrent_worker, NULL, lcore_id);
+	rte_atomic32_set(&synchro, 1);
+	if (concurrent_worker(NULL) < 0)
+		ret = -1;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+
+	if (ret == 0 && rte_stack_count(shared_stack) != STACK_SIZE / 8) {
+		printf("bad count after concurrent test: %u\n",
+			rte_stack_count(shared_stack));
+		ret = -1;
+	}
+
+	memset(seen, 0, sizeof(seen));
+	if (ret == 0 &&
+			rte_stack_pop(shared_stack, objs, STACK_SIZE / 8) == 0) {
+		printf("cannot pop objects after concurrent test\n");
+		ret = -1;
+	}
+	for (i = 0; ret == 0 && i < STACK_SIZE / 8; i++) {
+		idx = (uintptr_t)objs[i];
+		if (idx == 0 || idx > STACK_SIZE / 8 || seen[idx - 1]) {
+			printf("object %u lost or duplicated\n", idx);
+			ret = -1;
+		} else
+			seen[idx - 1] = 1;
+	}
+
+	rte_stack_free(shared_stack);
+	return ret;
+}
+
+static int
+test_stack_mempool(unsigned flags)
+{
+	struct rte_mempool *mp;
+	void *objs[STACK_SIZE / 4];
+	unsigned i;
+	char name[RTE_MEMPOOL_NAMESIZE];
+
+	snprintf(name, sizeof(name), "test_stack_mp_%x", flags);
+	mp = rte_mempool_create(name, STACK_SIZE / 4, 64, 32, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY, flags);
+	if (mp == NULL) {
+		printf("cannot create mempool (flags %#x)\n", flags);
+		return -1;
+	}
+	if (rte_mempool_count(mp) != STACK_SIZE / 4) {
+		printf("bad mempool count: %u\n", rte_mempool_count(mp));
+		return -1;
+	}
+
+	for (i = 0; i < STACK_SIZE / 4; i++) {
+		if (rte_mempool_get(mp, &objs[i]) < 0) {
+			printf("cannot get object %u\n", i);
+			return -1;
+		}
+	}
+	if (rte_mempool_get(mp, &objs[0]) == 0) {
+		printf("get from an empty mempool succeeded\n");
+		return -1;
+	}
+	rte_mempool_put_bulk(mp, objs, STACK_SIZE / 4);
+	if (rte_mempool_count(mp) != STACK_SIZE / 4) {
+		printf("bad mempool count after put: %u\n",
+			rte_mempool_count(mp));
+		return -1;
+	}
+	if (rte_mempool_get_bulk(mp, objs, MAX_BULK) < 0) {
+		printf("cannot get a bulk of objects\n");
+		return -1;
+	}
+	rte_mempool_put_bulk(mp, objs, MAX_BULK);
+
+	rte_mempool_dump(stdout, mp);
+	return 0;
+}
+
+static int
+test_stack(void)
+{
+	if (test_stack_bad_args() < 0)
+		return -1;
+
+	printf("Spinlock stack\n");
+	if (test_stack_basic(0) < 0)
+		return -1;
+	if (test_stack_concurrent(0) < 0)
+		return -1;
+	if (test_stack_mempool(MEMPOOL_F_STACK) < 0)
+		return -1;
+
+#ifdef RTE_ARCH_X86_64
+	printf("Lock-free stack\n");
+	if (test_stack_basic(RTE_STACK_F_LF) < 0)
+		return -1;
+	if (test_stack_concurrent(RTE_STACK_F_LF) < 0)
+		return -1;
+	if (test_stack_mempool(MEMPOOL_F_STACK_LF) < 0)
+		return -1;
+#else
+	if (rte_stack_create("test_stack", STACK_SIZE, SOCKET_ID_ANY,
+			RTE_STACK_F_LF) != NULL || rte_errno != ENOTSUP) {
+		printf("lock-free stack should not be supported\n");
+		return -1;
+	}
+#endif
+
+	return 0;
+}
+
+static struct test_command stack_cmd = {
+	.command = "stack_autotest",
+	.callback = test_stack,
+};
+REGISTER_TEST_COMMAND(stack_cmd);
@@ -0,0 +1,207 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_ring.h>
+#include <rte_stack.h>
+
+#include "test.h"
+
+/*
+ * Stack
+ * =====
+ *
+ * Measures the cost of a bulk push followed by a bulk pop, in cycles per
+ * object, for the spinlock and the lock-free stacks, with a ring as
+ * reference:
+ *  * on the master lcore only
+ *  * on all the enabled lcores at the same time, reported per lcore
+ */
+
+#define STACK_SIZE 4096
+#define MAX_BURST 32
+#define N_ITER (1 << 16)
+
+/*
+ * the sizes to push and pop in testing
+ * (marked volatile so they won't be seen as compile-time constants)
+ */
+static const volatile unsigned bulk_sizes[] = { 1, 8, 32 };
+
+enum perf_obj_type {
+	PERF_RING,
+	PERF_STACK,
+	PERF_STACK_LF,
+};
+
+static const char * const perf_obj_names[] = {
+	[PERF_RING] = "ring",
+	[PERF_STACK] = "spinlock stack",
+	[PERF_STACK_LF] = "lock-free stack",
+};
+
+struct perf_args {
+	enum perf_obj_type type;
+	void *obj;
+	unsigned bulk;
+	uint64_t cycles;
+} __rte_cache_aligned;
+
+static struct perf_args lcore_args[RTE_MAX_LCORE];
+static rte_atomic32_t synchro;
+
+static int
+perf_loop(void *arg)
+{
+	struct perf_args *args = arg;
+	void *objs[MAX_BURST];
+	const unsigned n = args->bulk;
+	uint64_t start;
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		objs[i] = (void *)(uintptr_t)(i + 1);
+
+	while (rte_atomic32_read(&synchro) == 0)
+		;
+
+	start = rte_rdtsc();
+	if (args->type == PERF_RING) {
+		struct rte_ring *r = args->obj;
+
+		for (i = 0; i < N_ITER; i++) {
+			rte_ring_mp_enqueue_bulk(r, objs, n);
+			rte_ring_mc_dequeue_bulk(r, objs, n);
+		}
+	} else {
+		struct rte_stack *s = args->obj;
+
+		for (i = 0; i < N_ITER; i++) {
+			rte_stack_push(s, objs, n);
+			rte_stack_pop(s, objs, n);
+		}
+	}
+	args->cycles = rte_rdtsc() - start;
+	return 0;
+}
+
+static void
+run_on_lcores(enum perf_obj_type type, void *obj, unsigned bulk,
+		int all_lcores)
+{
+	uint64_t total = 0;
+	unsigned lcore_id, n_lcores = 0;
+
+	rte_atomic32_init(&synchro);
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (!all_lcores && lcore_id != rte_get_master_lcore())
+			continue;
+		lcore_args[lcore_id].type = type;
+		lcore_args[lcore_id].obj = obj;
+		lcore_args[lcore_id].bulk = bulk;
+		lcore_args[lcore_id].cycles = 0;
+		if (lcore_id != rte_get_master_lcore())
+			rte_eal_remote_launch(perf_loop,
+				&lcore_args[lcore_id], lcore_id);
+	}
+	rte_atomic32_set(&synchro, 1);
+	perf_loop(&lcore_args[rte_get_master_lcore()]);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (!all_lcores && lcore_id != rte_get_master_lcore())
+			continue;
+		total += lcore_args[lcore_id].cycles;
+		n_lcores++;
+	}
+
+	printf("%s, %u lcore(s), bulk %2u: %.2F cycles/object\n",
+		perf_obj_names[type], n_lcores, bulk,
+		(double)total / ((double)n_lcores * N_ITER * bulk * 2));
+}
+
+static void
+run_perf(enum perf_obj_type type, void *obj)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_DIM(bulk_sizes); i++)
+		run_on_lcores(type, obj, bulk_sizes[i], 0);
+	if (rte_lcore_count() > 1)
+		for (i = 0; i < RTE_DIM(bulk_sizes); i++)
+			run_on_lcores(type, obj, bulk_sizes[i], 1);
+}
+
+static int
+test_stack_perf(void)
+{
+	struct rte_ring *r;
+	struct rte_stack *s;
+
+	r = rte_ring_create("STACK_PERF_RING", STACK_SIZE, SOCKET_ID_ANY, 0);
+	if (r == NULL)
+		r = rte_ring_lookup("STACK_PERF_RING");
+	if (r == NULL)
+		return -1;
+	run_perf(PERF_RING, r);
+
+	s = rte_stack_create("STACK_PERF", STACK_SIZE, SOCKET_ID_ANY, 0);
+	if (s == NULL)
+		return -1;
+	run_perf(PERF_STACK, s);
+	rte_stack_free(s);
+
+#ifdef RTE_ARCH_X86_64
+	s = rte_stack_create("STACK_PERF_LF", STACK_SIZE, SOCKET_ID_ANY,
+		RTE_STACK_F_LF);
+	if (s == NULL)
+		return -1;
+	run_perf(PERF_STACK_LF, s);
+	rte_stack_free(s);
+#endif
+
+	return 0;
+}
+
+static struct test_command stack_perf_cmd = {
+	.command = "stack_perf_autotest",
+	.callback = test_stack_perf,
+};
+REGISTER_TEST_COMMAND(stack_perf_cmd);
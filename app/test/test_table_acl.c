@@ -483,6 +483,45 @@ setup_acl_pipeline(void)
 		}
 	}
 
+	/* Bulk add of duplicates: all rules are already in the tables */
+	for (i = 0; i < N_PORTS; i++) {
+		struct rte_pipeline_table_entry table_entry = {
+			.action = RTE_PIPELINE_ACTION_PORT,
+			{.port_id = port_out_id[i^1]},
+		};
+		struct rte_table_acl_rule_add_params bulk_rules[5];
+		void *keys[5];
+		struct rte_pipeline_table_entry *entries[5];
+		struct rte_pipeline_table_entry *entries_ptr[5];
+		int key_found[5];
+
+		for (n = 0; n < 5; n++) {
+			memset(&bulk_rules[n], 0, sizeof(bulk_rules[n]));
+			snprintf(line, sizeof(line), "%s", lines[n]);
+			ret = parse_cb_ipv4_rule(line, &bulk_rules[n]);
+			if (ret != 0)
+				return ret;
+
+			bulk_rules[n].priority = RTE_ACL_MAX_PRIORITY - n - 1;
+			keys[n] = &bulk_rules[n];
+			entries[n] = &table_entry;
+		}
+
+		ret = rte_pipeline_table_entry_add_bulk(p, table_id[i], keys,
+			entries, 5, key_found, entries_ptr);
+		if (ret < 0) {
+			rte_panic("Bulk add to table %u failed (%d)\n",
+				table_id[i], ret);
+			goto fail;
+		}
+
+		for (n = 0; n < 5; n++)
+			if (key_found[n] == 0) {
+				rte_panic("Bulk add: rule %u not found\n", n);
+				goto fail;
+			}
+	}
+
 	/* Enable input ports */
 	for (i = 0; i < N_PORTS ; i++)
 		if (rte_pipeline_port_in_enable(p, port_in_id[i]))
@@ -578,6 +617,168 @@ fail:
 
 }
 
+/*
+ * Bulk operations on a standalone ACL table with room for 7 rules (position 0
+ * of the rule list is never used), rules differ by their source port.
+ */
+#define ACL_BULK_N_RULES					8
+
+static void
+acl_bulk_rule(struct rte_table_acl_rule_add_params *rule, uint16_t port)
+{
+	memset(rule, 0, sizeof(*rule));
+	snprintf(line, sizeof(line), "%s", lines[3]);
+	parse_cb_ipv4_rule(line, rule);
+	rule->field_value[SRCP_FIELD_IPV4].value.u16 = port;
+	rule->field_value[SRCP_FIELD_IPV4].mask_range.u16 = port;
+	rule->priority = port;
+}
+
+static int
+acl_bulk_add(void *table, uint16_t port, uint32_t n, int *key_found)
+{
+	struct rte_table_acl_rule_add_params rules[n];
+	void *keys[n], *entries[n], *entries_ptr[n];
+	uint64_t data[n];
+	uint32_t i;
+	int status;
+
+	for (i = 0; i < n; i++) {
+		acl_bulk_rule(&rules[i], port + i);
+		data[i] = port + i;
+		keys[i] = &rules[i];
+		entries[i] = &data[i];
+	}
+
+	status = rte_table_acl_ops.f_add_bulk(table, keys, entries, n,
+		key_found, entries_ptr);
+	if (status != 0)
+		return status;
+
+	for (i = 0; i < n; i++)
+		if (*((uint64_t *) entries_ptr[i]) != (uint64_t) (port + i))
+			return -1;
+
+	return 0;
+}
+
+static int
+acl_bulk_delete(void *table, uint16_t port, uint32_t n, int *key_found)
+{
+	struct rte_table_acl_rule_add_params rules[n];
+	void *keys[n], *entries[n];
+	uint64_t data[n];
+	uint32_t i;
+	int status;
+
+	for (i = 0; i < n; i++) {
+		acl_bulk_rule(&rules[i], port + i);
+		data[i] = 0;
+		keys[i] = &rules[i].field_value[0];
+		entries[i] = &data[i];
+	}
+
+	status = rte_table_acl_ops.f_delete_bulk(table, keys, n, key_found,
+		entries);
+	if (status != 0)
+		return status;
+
+	for (i = 0; i < n; i++)
+		if (key_found[i] && (data[i] != (uint64_t) (port + i)))
+			return -1;
+
+	return 0;
+}
+
+static int
+test_table_acl_bulk(void)
+{
+	struct rte_table_acl_params acl_params;
+	void *table;
+	int key_found[ACL_BULK_N_RULES];
+	uint32_t i;
+
+	acl_params.name = "ACL_BULK";
+	acl_params.n_rules = ACL_BULK_N_RULES;
+	acl_params.n_rule_fields = DIM(ipv4_defs);
+	memcpy(acl_params.field_format, ipv4_defs, sizeof(ipv4_defs));
+
+	table = rte_table_acl_ops.f_create(&acl_params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -1;
+
+	/* New rules */
+	if (acl_bulk_add(table, 100, 5, key_found) != 0)
+		return -2;
+	for (i = 0; i < 5; i++)
+		if (key_found[i] != 0)
+			return -3;
+
+	/* Same rules again */
+	if (acl_bulk_add(table, 100, 5, key_found) != 0)
+		return -4;
+	for (i = 0; i < 5; i++)
+		if (key_found[i] == 0)
+			return -5;
+
+	/* Partial overlap: ports 102 .. 104 exist, 105 .. 106 are new */
+	if (acl_bulk_add(table, 102, 5, key_found) != 0)
+		return -6;
+	for (i = 0; i < 5; i++)
+		if ((key_found[i] != 0) != (i < 3))
+			return -7;
+
+	/* Table full: the operation fails and no rule is added */
+	if (acl_bulk_add(table, 107, 2, key_found) != -ENOSPC)
+		return -8;
+	if (acl_bulk_delete(table, 107, 2, key_found) != 0)
+		return -9;
+	for (i = 0; i < 2; i++)
+		if (key_found[i] != 0)
+			return -10;
+
+	/* Delete all the rules, then check none of them is left */
+	if (acl_bulk_delete(table, 100, 7, key_found) != 0)
+		return -11;
+	for (i = 0; i < 7; i++)
+		if (key_found[i] == 0)
+			return -12;
+
+	if (acl_bulk_delete(table, 100, 7, key_found) != 0)
+		return -13;
+	for (i = 0; i < 7; i++)
+		if (key_found[i] != 0)
+			return -14;
+
+	/* A new key repeated within the batch is not reported as found */
+	{
+		struct rte_table_acl_rule_add_params rule;
+		void *keys[2], *entries[2], *entries_ptr[2];
+		uint64_t data[2] = {110, 110};
+
+		acl_bulk_rule(&rule, 110);
+		keys[0] = keys[1] = &rule;
+		entries[0] = &data[0];
+		entries[1] = &data[1];
+
+		if (rte_table_acl_ops.f_add_bulk(table, keys, entries, 2,
+			key_found, entries_ptr) != 0)
+			return -15;
+		if ((key_found[0] != 0) || (key_found[1] != 0) ||
+			(entries_ptr[0] != entries_ptr[1]) ||
+			(*((uint64_t *) entries_ptr[0]) != 110))
+			return -16;
+	}
+	if (acl_bulk_delete(table, 110, 1, key_found) != 0)
+		return -17;
+	if (key_found[0] == 0)
+		return -18;
+
+	rte_table_acl_ops.f_free(table);
+
+	return 0;
+}
+
 int
 test_table_ACL(void)
 {
@@ -589,5 +790,8 @@ test_table_ACL(void)
 	if (test_pipeline_single_filter(10) < 0)
 		return -1;
 
+	if (test_table_acl_bulk() < 0)
+		return -1;
+
 	return 0;
 }
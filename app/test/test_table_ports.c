@@ -31,12 +31,17 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <string.h>
+#include <unistd.h>
+
 #include "test_table_ports.h"
 #include "test_table.h"
 
 port_test port_tests[] = {
 	test_port_ring_reader,
 	test_port_ring_writer,
+	test_port_ring_multi,
+	test_port_source_sink,
 };
 
 unsigned n_port_tests = RTE_DIM(port_tests);
@@ -218,3 +223,250 @@ test_port_ring_writer(void)
 
 	return 0;
 }
+
+#define RING_MULTI_SIZE 256
+
+int
+test_port_ring_multi(void)
+{
+	struct rte_port_ring_multi_reader_params reader_params;
+	struct rte_port_ring_multi_writer_params writer_params;
+	struct rte_port_ring_multi_writer_nodrop_params nodrop_params;
+	struct rte_mbuf *mbuf[RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_ring *ring;
+	void *reader, *writer[2];
+	int i, n_pkts;
+
+	ring = rte_ring_lookup("app_ring_multi");
+	if (ring == NULL)
+		ring = rte_ring_create("app_ring_multi", RING_MULTI_SIZE, 0, 0);
+	if (ring == NULL)
+		return -1;
+
+	/* Single producer/consumer rings cannot be shared */
+	reader_params.ring = RING_RX;
+	if (rte_port_ring_multi_reader_ops.f_create(&reader_params, 0) != NULL)
+		return -2;
+
+	writer_params.ring = RING_TX;
+	writer_params.tx_burst_sz = RTE_PORT_IN_BURST_SIZE_MAX;
+	if (rte_port_ring_multi_writer_ops.f_create(&writer_params, 0) != NULL)
+		return -3;
+
+	nodrop_params.ring = RING_TX;
+	nodrop_params.tx_burst_sz = RTE_PORT_IN_BURST_SIZE_MAX;
+	nodrop_params.n_retries = 0;
+	if (rte_port_ring_multi_writer_nodrop_ops.f_create(&nodrop_params, 0)
+		!= NULL)
+		return -4;
+
+	/* Two writers feeding one ring */
+	reader_params.ring = ring;
+	writer_params.ring = ring;
+	nodrop_params.ring = ring;
+
+	reader = rte_port_ring_multi_reader_ops.f_create(&reader_params, 0);
+	writer[0] = rte_port_ring_multi_writer_ops.f_create(&writer_params, 0);
+	writer[1] = rte_port_ring_multi_writer_nodrop_ops.f_create(
+		&nodrop_params, 0);
+	if ((reader == NULL) || (writer[0] == NULL) || (writer[1] == NULL))
+		return -5;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		mbuf[i] = rte_pktmbuf_alloc(pool);
+		if (mbuf[i] == NULL) {
+			while (i-- > 0)
+				rte_pktmbuf_free(mbuf[i]);
+			return -11;
+		}
+	}
+	rte_port_ring_multi_writer_ops.f_tx_bulk(writer[0], mbuf,
+		(uint64_t)-1);
+
+	/* Several full bursts through the nodrop writer, one at a time */
+	for (n_pkts = 0; n_pkts < 2 * RTE_PORT_IN_BURST_SIZE_MAX; n_pkts++) {
+		struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+
+		if (m == NULL)
+			return -12;
+		rte_port_ring_multi_writer_nodrop_ops.f_tx(writer[1], m);
+	}
+	rte_port_ring_multi_writer_nodrop_ops.f_flush(writer[1]);
+
+	if (rte_ring_count(ring) != 3 * RTE_PORT_IN_BURST_SIZE_MAX)
+		return -6;
+
+	/* Drain the ring */
+	for (n_pkts = 0; n_pkts < 3 * RTE_PORT_IN_BURST_SIZE_MAX; ) {
+		int n = rte_port_ring_multi_reader_ops.f_rx(reader, mbuf,
+			RTE_PORT_IN_BURST_SIZE_MAX);
+
+		if (n <= 0)
+			return -7;
+
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(mbuf[i]);
+		n_pkts += n;
+	}
+
+	if (rte_port_ring_multi_reader_ops.f_free(reader) != 0)
+		return -8;
+	if (rte_port_ring_multi_writer_ops.f_free(writer[0]) != 0)
+		return -9;
+	if (rte_port_ring_multi_writer_nodrop_ops.f_free(writer[1]) != 0)
+		return -10;
+
+	return 0;
+}
+
+#define PORT_PCAP_TEST_FILE "/tmp/test_port_source_sink.pcap"
+#define PORT_PCAP_TEST_PKT_LEN 64
+
+int
+test_port_source_sink(void)
+{
+	struct rte_port_source_params port_source_params;
+	struct rte_port_sink_params port_sink_params;
+	struct rte_mbuf *mbuf[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *port;
+	int status, n_pkts;
+
+	/* Invalid params */
+	port = rte_port_source_ops.f_create(NULL, 0);
+	if (port != NULL)
+		return -1;
+
+	memset(&port_source_params, 0, sizeof(port_source_params));
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port != NULL)
+		return -2;
+
+	/* Source: generate empty packets */
+	port_source_params.mempool = pool;
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port == NULL)
+		return -3;
+
+	n_pkts = rte_port_source_ops.f_rx(port, mbuf,
+		RTE_PORT_IN_BURST_SIZE_MAX);
+	if (n_pkts != RTE_PORT_IN_BURST_SIZE_MAX)
+		return -4;
+
+	status = rte_port_source_ops.f_free(port);
+	if (status != 0)
+		return -5;
+
+	/* Sink: drop packets, no parameters */
+	port = rte_port_sink_ops.f_create(NULL, 0);
+	if (port == NULL)
+		return -6;
+
+	rte_port_sink_ops.f_tx(port, mbuf[0]);
+	rte_port_sink_ops.f_tx_bulk(port, mbuf, (uint64_t)-2);
+	rte_port_sink_ops.f_flush(port);
+
+	status = rte_port_sink_ops.f_free(port);
+	if (status != 0)
+		return -7;
+
+	/* Sink and source backed by a pcap file */
+	memset(&port_sink_params, 0, sizeof(port_sink_params));
+	port_sink_params.file_name = PORT_PCAP_TEST_FILE;
+	port_sink_params.max_n_pkts = 2 * RTE_PORT_IN_BURST_SIZE_MAX;
+
+	port_source_params.file_name = PORT_PCAP_TEST_FILE;
+	port_source_params.n_bytes_per_pkt = 0;
+
+#ifdef RTE_PORT_PCAP
+	int i;
+
+	port = rte_port_sink_ops.f_create(&port_sink_params, 0);
+	if (port == NULL)
+		return -8;
+
+	/* Write 3 bursts, only the first 2 must make it into the file */
+	for (n_pkts = 0; n_pkts < 3 * RTE_PORT_IN_BURST_SIZE_MAX; ) {
+		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++, n_pkts++) {
+			mbuf[i] = rte_pktmbuf_alloc(pool);
+			if (mbuf[i] == NULL)
+				return -9;
+			memset(rte_pktmbuf_append(mbuf[i],
+				PORT_PCAP_TEST_PKT_LEN), n_pkts & 0xFF,
+				PORT_PCAP_TEST_PKT_LEN);
+		}
+
+		rte_port_sink_ops.f_tx_bulk(port, mbuf, (uint64_t)-1);
+	}
+
+	status = rte_port_sink_ops.f_free(port);
+	if (status != 0)
+		return -10;
+
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port == NULL)
+		return -11;
+
+	/* Read the file twice to check the replay loop */
+	for (n_pkts = 0; n_pkts < 4 * RTE_PORT_IN_BURST_SIZE_MAX; ) {
+		if (rte_port_source_ops.f_rx(port, mbuf,
+			RTE_PORT_IN_BURST_SIZE_MAX) !=
+			RTE_PORT_IN_BURST_SIZE_MAX)
+			return -12;
+
+		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++, n_pkts++) {
+			uint8_t *data = rte_pktmbuf_mtod(mbuf[i], uint8_t *);
+			uint8_t expected = (n_pkts %
+				(2 * RTE_PORT_IN_BURST_SIZE_MAX)) & 0xFF;
+
+			if ((rte_pktmbuf_pkt_len(mbuf[i]) !=
+				PORT_PCAP_TEST_PKT_LEN) ||
+				(data[0] != expected) ||
+				(data[PORT_PCAP_TEST_PKT_LEN - 1] != expected))
+				return -13;
+
+			rte_pktmbuf_free(mbuf[i]);
+		}
+	}
+
+	status = rte_port_source_ops.f_free(port);
+	if (status != 0)
+		return -14;
+
+	/* Truncated read */
+	port_source_params.n_bytes_per_pkt = PORT_PCAP_TEST_PKT_LEN / 2;
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port == NULL)
+		return -15;
+
+	if (rte_port_source_ops.f_rx(port, mbuf, 1) != 1)
+		return -16;
+
+	if (rte_pktmbuf_pkt_len(mbuf[0]) != PORT_PCAP_TEST_PKT_LEN / 2)
+		return -17;
+
+	rte_pktmbuf_free(mbuf[0]);
+	rte_port_source_ops.f_free(port);
+	unlink(PORT_PCAP_TEST_FILE);
+
+	/* Missing or unwritable file */
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port != NULL)
+		return -18;
+
+	port_sink_params.file_name = "/nonexistent/" PORT_PCAP_TEST_FILE;
+	port = rte_port_sink_ops.f_create(&port_sink_params, 0);
+	if (port != NULL)
+		return -19;
+#else
+	/* pcap support not compiled in */
+	port = rte_port_sink_ops.f_create(&port_sink_params, 0);
+	if (port != NULL)
+		return -8;
+
+	port = rte_port_source_ops.f_create(&port_source_params, 0);
+	if (port != NULL)
+		return -9;
+#endif
+
+	return 0;
+}
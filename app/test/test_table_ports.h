@@ -34,6 +34,8 @@
 /* Test prototypes */
 int test_port_ring_reader(void);
 int test_port_ring_writer(void);
+int test_port_ring_multi(void);
+int test_port_source_sink(void);
 
 /* Extern variables */
 typedef int (*port_test)(void);
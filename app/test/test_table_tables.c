@@ -36,6 +36,8 @@
 #include <rte_table_lpm_ipv6.h>
 #include <rte_lru.h>
 #include <rte_cycles.h>
+#include <rte_jhash.h>
+#include <rte_random.h>
 #include "test_table_tables.h"
 #include "test_table.h"
 
@@ -46,6 +48,8 @@ table_test table_tests[] = {
 	test_table_lpm_ipv6,
 	test_table_hash_lru,
 	test_table_hash_ext,
+	test_table_hash_cuckoo,
+	test_table_hash_perf,
 };
 
 #define PREPARE_PACKET(mbuf, value) do {				\
@@ -633,6 +637,73 @@ test_table_lpm_ipv6(void)
 	return 0;
 }
 
+#define TEST_HASH_BULK_N_KEYS					64
+
+static int
+test_table_hash_bulk_generic(struct rte_table_ops *ops, void *table)
+{
+	uint8_t keys[TEST_HASH_BULK_N_KEYS][32];
+	void *key_ptrs[TEST_HASH_BULK_N_KEYS];
+	char entries[TEST_HASH_BULK_N_KEYS];
+	char entries_deleted[TEST_HASH_BULK_N_KEYS];
+	void *entry_ptrs[TEST_HASH_BULK_N_KEYS];
+	void *entries_ptr[TEST_HASH_BULK_N_KEYS];
+	void *deleted_ptrs[TEST_HASH_BULK_N_KEYS];
+	int key_found[TEST_HASH_BULK_N_KEYS];
+	uint32_t i;
+
+	if ((ops->f_add_bulk == NULL) || (ops->f_delete_bulk == NULL))
+		return -1;
+
+	/*
+	 * pipeline_test_hash() returns the first key word as the signature, so
+	 * these keys land in distinct buckets as long as the table has more
+	 * than TEST_HASH_BULK_N_KEYS buckets (true for the 1K-entry tables
+	 * used by the callers), and LRU tables do not evict any of them.
+	 */
+	for (i = 0; i < TEST_HASH_BULK_N_KEYS; i++) {
+		uint32_t *k32 = (uint32_t *) keys[i];
+
+		memset(keys[i], 0, 32);
+		k32[0] = rte_cpu_to_be_32(i + 1);
+		key_ptrs[i] = keys[i];
+		entries[i] = 'A' + (i % 26);
+		entry_ptrs[i] = &entries[i];
+		deleted_ptrs[i] = &entries_deleted[i];
+	}
+
+	if (ops->f_add_bulk(table, key_ptrs, entry_ptrs,
+		TEST_HASH_BULK_N_KEYS, key_found, entries_ptr) != 0)
+		return -2;
+	for (i = 0; i < TEST_HASH_BULK_N_KEYS; i++)
+		if ((key_found[i] != 0) ||
+			(*((char *) entries_ptr[i]) != entries[i]))
+			return -3;
+
+	if (ops->f_add_bulk(table, key_ptrs, entry_ptrs,
+		TEST_HASH_BULK_N_KEYS, key_found, entries_ptr) != 0)
+		return -4;
+	for (i = 0; i < TEST_HASH_BULK_N_KEYS; i++)
+		if (key_found[i] == 0)
+			return -5;
+
+	if (ops->f_delete_bulk(table, key_ptrs, TEST_HASH_BULK_N_KEYS,
+		key_found, deleted_ptrs) != 0)
+		return -6;
+	for (i = 0; i < TEST_HASH_BULK_N_KEYS; i++)
+		if ((key_found[i] == 0) || (entries_deleted[i] != entries[i]))
+			return -7;
+
+	if (ops->f_delete_bulk(table, key_ptrs, TEST_HASH_BULK_N_KEYS,
+		key_found, NULL) != 0)
+		return -8;
+	for (i = 0; i < TEST_HASH_BULK_N_KEYS; i++)
+		if (key_found[i] != 0)
+			return -9;
+
+	return 0;
+}
+
 static int
 test_table_hash_lru_generic(struct rte_table_ops *ops)
 {
@@ -742,6 +813,10 @@ test_table_hash_lru_generic(struct rte_table_ops *ops)
 	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
 		rte_pktmbuf_free(mbufs[i]);
 
+	/* Bulk add/delete */
+	if (test_table_hash_bulk_generic(ops, table) < 0)
+		return -14;
+
 	status = ops->f_free(table);
 
 	return 0;
@@ -862,6 +937,10 @@ test_table_hash_ext_generic(struct rte_table_ops *ops)
 	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
 		rte_pktmbuf_free(mbufs[i]);
 
+	/* Bulk add/delete */
+	if (test_table_hash_bulk_generic(ops, table) < 0)
+		return -14;
+
 	status = ops->f_free(table);
 
 	return 0;
@@ -920,3 +999,332 @@ test_table_hash_ext(void)
 
 	return 0;
 }
+
+int
+test_table_hash_cuckoo(void)
+{
+	int status, i;
+	uint64_t expected_mask = 0, result_mask;
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *table;
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	char entry;
+	void *entry_ptr;
+	int key_found;
+
+	/* Initialize params and create tables */
+	struct rte_table_hash_cuckoo_params cuckoo_params = {
+		.name = "TABLE_CUCKOO",
+		.key_size = 32,
+		.n_keys = 1 << 16,
+		.f_hash = rte_jhash,
+		.seed = 0,
+		.key_offset = 32,
+	};
+
+	table = rte_table_hash_cuckoo_ops.f_create(NULL, 0, 1);
+	if (table != NULL)
+		return -1;
+
+	cuckoo_params.key_size = 0;
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table != NULL)
+		return -2;
+
+	cuckoo_params.key_size = RTE_HASH_KEY_LENGTH_MAX + 1;
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table != NULL)
+		return -3;
+
+	cuckoo_params.key_size = 32;
+	cuckoo_params.n_keys = 0;
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table != NULL)
+		return -4;
+
+	cuckoo_params.n_keys = 1 << 16;
+	cuckoo_params.f_hash = NULL;
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table != NULL)
+		return -5;
+
+	cuckoo_params.f_hash = rte_jhash;
+	cuckoo_params.name = NULL;
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table != NULL)
+		return -6;
+
+	cuckoo_params.name = "TABLE_CUCKOO";
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table == NULL)
+		return -7;
+
+	/* Free */
+	status = rte_table_hash_cuckoo_ops.f_free(table);
+	if (status < 0)
+		return -8;
+
+	status = rte_table_hash_cuckoo_ops.f_free(NULL);
+	if (status == 0)
+		return -9;
+
+	/* Add */
+	uint8_t key_cuckoo[32];
+	uint32_t *kcuckoo = (uint32_t *) &key_cuckoo;
+
+	memset(key_cuckoo, 0, 32);
+	kcuckoo[0] = rte_be_to_cpu_32(0xadadadad);
+
+	table = rte_table_hash_cuckoo_ops.f_create(&cuckoo_params, 0, 1);
+	if (table == NULL)
+		return -10;
+
+	memset(mbufs, 0, sizeof(mbufs));
+
+	entry = 'A';
+	status = rte_table_hash_cuckoo_ops.f_add(table, &key_cuckoo, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 0)) {
+		status = -11;
+		goto cleanup;
+	}
+
+	entry = 'B';
+	status = rte_table_hash_cuckoo_ops.f_add(table, &key_cuckoo, &entry,
+		&key_found, &entry_ptr);
+	if ((status != 0) || (key_found == 0) ||
+		(*((char *) entry_ptr) != 'B')) {
+		status = -12;
+		goto cleanup;
+	}
+
+	/* Delete */
+	status = rte_table_hash_cuckoo_ops.f_delete(table, &key_cuckoo,
+		&key_found, &entry);
+	if ((status != 0) || (key_found == 0) || (entry != 'B')) {
+		status = -13;
+		goto cleanup;
+	}
+
+	status = rte_table_hash_cuckoo_ops.f_delete(table, &key_cuckoo,
+		&key_found, NULL);
+	if ((status != 0) || (key_found != 0)) {
+		status = -14;
+		goto cleanup;
+	}
+
+	/* Traffic flow */
+	entry = 'A';
+	status = rte_table_hash_cuckoo_ops.f_add(table, &key_cuckoo, &entry,
+		&key_found, &entry_ptr);
+	if (status < 0) {
+		status = -15;
+		goto cleanup;
+	}
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (i % 2 == 0) {
+			expected_mask |= (uint64_t)1 << i;
+			PREPARE_PACKET(mbufs[i], 0xadadadad);
+		} else
+			PREPARE_PACKET(mbufs[i], 0xadadadab);
+
+	rte_table_hash_cuckoo_ops.f_lookup(table, mbufs, -1,
+		&result_mask, (void **) entries);
+	if (result_mask != expected_mask) {
+		status = -16;
+		goto cleanup;
+	}
+
+	/* Sparse burst */
+	rte_table_hash_cuckoo_ops.f_lookup(table, mbufs, 0xF0F0F0F0F0F0F0F0LLU,
+		&result_mask, (void **) entries);
+	if (result_mask != (expected_mask & 0xF0F0F0F0F0F0F0F0LLU)) {
+		status = -17;
+		goto cleanup;
+	}
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if ((result_mask & (1LLU << i)) && (*entries[i] != 'A')) {
+			status = -18;
+			goto cleanup;
+		}
+
+	/* Bulk add/delete */
+	if (test_table_hash_bulk_generic(&rte_table_hash_cuckoo_ops, table) < 0)
+		status = -19;
+	else
+		status = 0;
+
+cleanup:
+	/* Free resources */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	rte_table_hash_cuckoo_ops.f_free(table);
+
+	return status;
+}
+
+/*
+ * Lookup benchmark: each table is populated with TEST_HASH_PERF_N_KEYS keys,
+ * then looked up with bursts of 64 packets picked at random among these keys.
+ */
+#define TEST_HASH_PERF_N_KEYS					(1 << 16)
+#define TEST_HASH_PERF_N_BURSTS					16
+#define TEST_HASH_PERF_N_ITER					(1 << 14)
+#define TEST_HASH_PERF_KEY_OFFSET				32
+
+static uint64_t
+test_hash_perf_jhash(void *key, uint32_t key_size, uint64_t seed)
+{
+	return rte_jhash(key, key_size, (uint32_t) seed);
+}
+
+static void
+test_hash_perf_key(uint8_t *key, uint32_t key_size, uint32_t key_id)
+{
+	uint32_t *k32 = (uint32_t *) key;
+
+	memset(key, 0, key_size);
+	k32[0] = key_id;
+	k32[(key_size / sizeof(uint32_t)) - 1] = ~key_id;
+}
+
+static int
+test_table_hash_perf_run(const char *name, struct rte_table_ops *ops,
+	void *params, uint32_t key_size)
+{
+	struct rte_mbuf *mbufs[TEST_HASH_PERF_N_BURSTS]
+		[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint8_t key[RTE_HASH_KEY_LENGTH_MAX];
+	uint64_t n_hits = 0, start, cycles;
+	void *table;
+	uint32_t i, j;
+	int status = 0;
+
+	table = ops->f_create(params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -1;
+
+	memset(mbufs, 0, sizeof(mbufs));
+
+	for (i = 0; i < TEST_HASH_PERF_N_KEYS; i++) {
+		uint64_t entry = i;
+		void *entry_ptr;
+		int key_found;
+
+		test_hash_perf_key(key, key_size, i);
+		if (ops->f_add(table, key, &entry, &key_found,
+			&entry_ptr) != 0) {
+			status = -2;
+			goto cleanup;
+		}
+	}
+
+	for (i = 0; i < TEST_HASH_PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++) {
+			struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+			uint8_t *k;
+
+			if (m == NULL) {
+				status = -3;
+				goto cleanup;
+			}
+
+			k = RTE_MBUF_METADATA_UINT8_PTR(m,
+				TEST_HASH_PERF_KEY_OFFSET);
+			test_hash_perf_key(k, key_size,
+				rte_rand() % TEST_HASH_PERF_N_KEYS);
+			*RTE_MBUF_METADATA_UINT32_PTR(m, 0) =
+				test_hash_perf_jhash(k, key_size, 0);
+			mbufs[i][j] = m;
+		}
+
+	start = rte_rdtsc();
+	for (i = 0; i < TEST_HASH_PERF_N_ITER; i++) {
+		uint64_t hit_mask;
+
+		ops->f_lookup(table, mbufs[i % TEST_HASH_PERF_N_BURSTS],
+			UINT64_MAX, &hit_mask, entries);
+		n_hits += __builtin_popcountll(hit_mask);
+	}
+	cycles = rte_rdtsc() - start;
+
+	printf("%s: %.1f cycles/pkt\n", name, (double) cycles /
+		((double) TEST_HASH_PERF_N_ITER * RTE_PORT_IN_BURST_SIZE_MAX));
+
+	/* All the keys were added, so every lookup has to hit */
+	if (n_hits != (uint64_t) TEST_HASH_PERF_N_ITER *
+		RTE_PORT_IN_BURST_SIZE_MAX)
+		status = -4;
+
+cleanup:
+	for (i = 0; i < TEST_HASH_PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++)
+			rte_pktmbuf_free(mbufs[i][j]);
+	ops->f_free(table);
+
+	return status;
+}
+
+int
+test_table_hash_perf(void)
+{
+	int status;
+
+	struct rte_table_hash_key32_ext_params key32_params = {
+		.n_entries = TEST_HASH_PERF_N_KEYS,
+		.n_entries_ext = TEST_HASH_PERF_N_KEYS,
+		.f_hash = test_hash_perf_jhash,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = TEST_HASH_PERF_KEY_OFFSET,
+	};
+
+	struct rte_table_hash_ext_params ext_params = {
+		.key_size = 64,
+		.n_keys = TEST_HASH_PERF_N_KEYS,
+		.n_buckets = TEST_HASH_PERF_N_KEYS / 4,
+		.n_buckets_ext = TEST_HASH_PERF_N_KEYS / 4,
+		.f_hash = test_hash_perf_jhash,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = TEST_HASH_PERF_KEY_OFFSET,
+	};
+
+	struct rte_table_hash_cuckoo_params cuckoo_params = {
+		.name = "TABLE_CUCKOO_PERF",
+		.key_size = 32,
+		.n_keys = 2 * TEST_HASH_PERF_N_KEYS,
+		.f_hash = rte_jhash,
+		.seed = 0,
+		.key_offset = TEST_HASH_PERF_KEY_OFFSET,
+	};
+
+	printf("Hash table lookup, %u keys:\n", TEST_HASH_PERF_N_KEYS);
+
+	status = test_table_hash_perf_run("key32 ext (pre-computed sig)",
+		&rte_table_hash_key32_ext_ops, &key32_params, 32);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_perf_run("cuckoo, 32-byte key",
+		&rte_table_hash_cuckoo_ops, &cuckoo_params, 32);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_perf_run("ext, 64-byte key (pre-computed sig)",
+		&rte_table_hash_ext_ops, &ext_params, 64);
+	if (status < 0)
+		return status;
+
+	cuckoo_params.key_size = 64;
+	status = test_table_hash_perf_run("cuckoo, 64-byte key",
+		&rte_table_hash_cuckoo_ops, &cuckoo_params, 64);
+	if (status < 0)
+		return status;
+
+	return 0;
+}
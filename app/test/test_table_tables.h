@@ -41,6 +41,8 @@ int test_table_acl(void);
 int test_table_hash_unoptimized(void);
 int test_table_hash_lru(void);
 int test_table_hash_ext(void);
+int test_table_hash_cuckoo(void);
+int test_table_hash_perf(void);
 int test_table_stub(void);
 
 /* Extern variables */
@@ -0,0 +1,281 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mempool.h>
+#ifdef RTE_LIBRTE_JOBSTATS
+#include <rte_jobstats.h>
+#endif
+#include <rte_telemetry.h>
+
+#include "test.h"
+
+#define TELEMETRY_PATH "/tmp/.rte_telemetry_test"
+#define TELEMETRY_PERIOD_MS 1
+#define JSON_SIZE (1 << 20)
+#define NB_READS 200
+
+/* both counters are always equal in a consistent snapshot */
+static uint64_t counter;
+
+static int
+test_read(void *arg __rte_unused, struct rte_telemetry_value *values,
+		unsigned n)
+{
+	if (n < 2)
+		return 2;
+	counter++;
+	snprintf(values[0].name, sizeof(values[0].name), "first");
+	values[0].value = counter;
+	snprintf(values[1].name, sizeof(values[1].name), "second");
+	values[1].value = counter;
+	return 2;
+}
+
+static int
+test_read_error(void *arg __rte_unused,
+		struct rte_telemetry_value *values __rte_unused,
+		unsigned n __rte_unused)
+{
+	return -1;
+}
+
+/* source unregistering itself from its callback */
+static int
+test_read_oneshot(void *arg __rte_unused, struct rte_telemetry_value *values,
+		unsigned n)
+{
+	if (n < 1)
+		return 1;
+	rte_telemetry_unregister("oneshot_group");
+	snprintf(values[0].name, sizeof(values[0].name), "value");
+	values[0].value = 1;
+	return 1;
+}
+
+/* check that the JSON document has a consistent test group */
+static int
+check_json(const char *json)
+{
+	uint64_t first, second;
+	const char *p;
+
+	if (strncmp(json, "{\"version\": 1, ", 15) != 0) {
+		printf("bad JSON header: %.40s\n", json);
+		return -1;
+	}
+	p = strstr(json, "\"test_group\": {");
+	if (p == NULL) {
+		printf("no test group in JSON\n");
+		return -1;
+	}
+	if (sscanf(p, "\"test_group\": {\"first\": %" SCNu64
+			", \"second\": %" SCNu64 "}", &first, &second) != 2) {
+		printf("cannot parse test group: %.80s\n", p);
+		return -1;
+	}
+	if (first != second || first == 0) {
+		printf("inconsistent snapshot: %" PRIu64 " != %" PRIu64 "\n",
+			first, second);
+		return -1;
+	}
+	if (strstr(json, "\"error_group\"") != NULL) {
+		printf("group with a read error is published\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* read the JSON document from the unix socket */
+static int
+read_socket(char *buf, size_t size)
+{
+	struct sockaddr_un addr;
+	size_t len = 0;
+	ssize_t ret;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", TELEMETRY_PATH);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	while (len < size - 1) {
+		ret = read(fd, buf + len, size - 1 - len);
+		if (ret <= 0)
+			break;
+		len += ret;
+	}
+	buf[len] = '\0';
+	close(fd);
+	return len;
+}
+
+static int
+test_telemetry(void)
+{
+#ifdef RTE_LIBRTE_JOBSTATS
+	struct rte_jobstats_context job_ctx;
+#endif
+	struct rte_mempool *mp;
+	char small_buf[16];
+	char *json;
+	int i, ret = -1;
+
+	json = malloc(JSON_SIZE);
+	if (json == NULL)
+		return -1;
+
+	mp = rte_mempool_lookup("telemetry_mp");
+	if (mp == NULL)
+		mp = rte_mempool_create("telemetry_mp", 63, 64, 0, 0,
+			NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	if (mp == NULL) {
+		printf("cannot create mempool\n");
+		goto out;
+	}
+
+	if (rte_telemetry_register("test_group", test_read, NULL) != 0 ||
+			rte_telemetry_register("error_group", test_read_error,
+				NULL) != 0) {
+		printf("cannot register telemetry groups\n");
+		goto out;
+	}
+#ifdef RTE_LIBRTE_JOBSTATS
+	rte_jobstats_context_init(&job_ctx);
+	if (rte_telemetry_register_jobstats("job_group", &job_ctx) != 0) {
+		printf("cannot register jobstats group\n");
+		goto out;
+	}
+#endif
+	if (rte_telemetry_register("test_group", test_read, NULL) !=
+			-EEXIST ||
+			rte_telemetry_register(NULL, test_read, NULL) !=
+			-EINVAL ||
+			rte_telemetry_unregister("none") != -ENOENT) {
+		printf("bad return value for invalid registrations\n");
+		goto out;
+	}
+
+	if (rte_telemetry_init(TELEMETRY_PATH, TELEMETRY_PERIOD_MS) != 0) {
+		printf("cannot start telemetry\n");
+		goto out;
+	}
+	if (rte_telemetry_init(TELEMETRY_PATH, TELEMETRY_PERIOD_MS) !=
+			-EALREADY) {
+		printf("telemetry started twice\n");
+		goto out_uninit;
+	}
+
+	rte_telemetry_publish();
+	if (rte_telemetry_json(json, JSON_SIZE) <= 0 ||
+			check_json(json) < 0)
+		goto out_uninit;
+	if (strstr(json, "\"mempool.telemetry_mp\": {\"size\": 63") == NULL ||
+			strstr(json, "\"ring.MP_telemetry_mp\": {") == NULL) {
+		printf("missing mempool or ring group\n");
+		goto out_uninit;
+	}
+#ifdef RTE_LIBRTE_JOBSTATS
+	if (strstr(json, "\"job_group\": {\"exec_time\": ") == NULL) {
+		printf("missing jobstats group\n");
+		goto out_uninit;
+	}
+#endif
+	/* sources are read without holding the registration lock */
+	if (rte_telemetry_register("oneshot_group", test_read_oneshot,
+			NULL) != 0) {
+		printf("cannot register oneshot group\n");
+		goto out_uninit;
+	}
+	rte_telemetry_publish();
+	if (rte_telemetry_unregister("oneshot_group") != -ENOENT ||
+			rte_telemetry_json(json, JSON_SIZE) <= 0 ||
+			check_json(json) < 0) {
+		printf("source not unregistered from its callback\n");
+		goto out_uninit;
+	}
+
+	if (rte_telemetry_json(small_buf, sizeof(small_buf)) != -ENOBUFS) {
+		printf("small buffer not detected\n");
+		goto out_uninit;
+	}
+
+	/* read while the control thread publishes */
+	for (i = 0; i < NB_READS; i++) {
+		if (rte_telemetry_json(json, JSON_SIZE) <= 0 ||
+				check_json(json) < 0)
+			goto out_uninit;
+	}
+
+	if (read_socket(json, JSON_SIZE) <= 0 || check_json(json) < 0) {
+		printf("cannot read telemetry from the socket\n");
+		goto out_uninit;
+	}
+
+	ret = 0;
+out_uninit:
+	rte_telemetry_uninit();
+	if (ret == 0 && access(TELEMETRY_PATH, F_OK) == 0) {
+		printf("socket not removed\n");
+		ret = -1;
+	}
+out:
+	rte_telemetry_unregister("test_group");
+	rte_telemetry_unregister("error_group");
+	rte_telemetry_unregister("job_group");
+	free(json);
+	return ret;
+}
+
+static struct test_command telemetry_cmd = {
+	.command = "telemetry_autotest",
+	.callback = test_telemetry,
+};
+REGISTER_TEST_COMMAND(telemetry_cmd);
@@ -0,0 +1,127 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_malloc.h>
+#include <rte_virtio_net.h>
+
+#include "test_vhost_common.h"
+
+uint8_t *
+vhost_test_mem_alloc(struct virtio_net *dev, size_t size)
+{
+	struct virtio_memory_regions *region;
+	uint8_t *mem;
+
+	mem = rte_zmalloc("vhost_test", size, 0);
+	dev->mem = rte_zmalloc("vhost_test", sizeof(*dev->mem) +
+		sizeof(*region), 0);
+	if (mem == NULL || dev->mem == NULL) {
+		vhost_test_mem_free(dev, mem);
+		return NULL;
+	}
+
+	dev->mem->nregions = 1;
+	region = &dev->mem->regions[0];
+	region->memory_size = size;
+	region->guest_phys_address_end = size;
+	region->address_offset = (uint64_t)(uintptr_t)mem;
+	return mem;
+}
+
+void
+vhost_test_mem_free(struct virtio_net *dev, uint8_t *mem)
+{
+	rte_free(dev->mem);
+	dev->mem = NULL;
+	rte_free(mem);
+}
+
+static void
+setup_vq(struct vhost_virtqueue *vq, struct vhost_test_ring *ring)
+{
+	vq->desc = ring->desc;
+	vq->avail = &ring->avail.avail;
+	vq->used = &ring->used.used;
+	vq->size = VHOST_TEST_RING_SIZE;
+	vq->enabled = 1;
+	vq->vhost_hlen = sizeof(struct virtio_net_hdr);
+	vq->callfd = (eventfd_t)-1;
+	ring->avail.avail.flags = VRING_AVAIL_F_NO_INTERRUPT;
+}
+
+int
+vhost_test_guest_init(struct vhost_test_guest *guest)
+{
+	struct virtio_net *dev = &guest->dev;
+
+	memset(guest, 0, sizeof(*guest));
+	guest->mem = vhost_test_mem_alloc(dev, VHOST_TEST_MEM_SIZE);
+	if (guest->mem == NULL)
+		return -1;
+
+	dev->virt_qp_nb = 1;
+	dev->virtqueue[VIRTIO_RXQ] = &guest->rxvq;
+	dev->virtqueue[VIRTIO_TXQ] = &guest->txvq;
+	setup_vq(&guest->rxvq, &guest->rx_ring);
+	setup_vq(&guest->txvq, &guest->tx_ring);
+	return 0;
+}
+
+static void
+reset_vq(struct vhost_virtqueue *vq, struct vhost_test_ring *ring)
+{
+	memset(ring->desc, 0, sizeof(ring->desc));
+	ring->avail.avail.idx = 0;
+	ring->used.used.idx = 0;
+	vq->last_used_idx = 0;
+	vq->last_used_idx_res = 0;
+	vq->nr_zmbufs = 0;
+}
+
+void
+vhost_test_guest_reset(struct vhost_test_guest *guest, uint64_t features)
+{
+	reset_vq(&guest->rxvq, &guest->rx_ring);
+	reset_vq(&guest->txvq, &guest->tx_ring);
+	guest->dev.features = features;
+	guest->dev.dequeue_zero_copy = 0;
+}
+
+void
+vhost_test_guest_free(struct vhost_test_guest *guest)
+{
+	vhost_test_mem_free(&guest->dev, guest->mem);
+	guest->mem = NULL;
+}
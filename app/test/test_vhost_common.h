@@ -0,0 +1,98 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TEST_VHOST_COMMON_H_
+#define _TEST_VHOST_COMMON_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <rte_virtio_net.h>
+
+/*
+ * A fake guest for the vhost tests: one queue pair whose vrings, and the
+ * buffers they point to, are in local memory.
+ */
+
+#define VHOST_TEST_RING_SIZE 16
+#define VHOST_TEST_MEM_SIZE (1 << 20)
+#define VHOST_TEST_BUF_SIZE 2048
+
+/* A vring, the buffers it points to are at mem + desc.addr */
+struct vhost_test_ring {
+	struct vring_desc desc[VHOST_TEST_RING_SIZE];
+	struct {
+		struct vring_avail avail;
+		uint16_t ring[VHOST_TEST_RING_SIZE];
+	} avail;
+	struct {
+		struct vring_used used;
+		struct vring_used_elem ring[VHOST_TEST_RING_SIZE];
+	} used;
+};
+
+struct vhost_test_guest {
+	struct virtio_net dev;
+	struct vhost_virtqueue rxvq;
+	struct vhost_virtqueue txvq;
+	struct vhost_test_ring rx_ring;
+	struct vhost_test_ring tx_ring;
+	uint8_t *mem; /* guest physical address 0 */
+};
+
+/*
+ * Allocate size bytes of zeroed guest memory, and a memory table of dev
+ * mapping guest physical address 0 to them.
+ */
+uint8_t *vhost_test_mem_alloc(struct virtio_net *dev, size_t size);
+
+void vhost_test_mem_free(struct virtio_net *dev, uint8_t *mem);
+
+/* Allocate the guest memory and set up the device and its vrings */
+int vhost_test_guest_init(struct vhost_test_guest *guest);
+
+/* Empty the vrings and set the features negotiated by the guest */
+void vhost_test_guest_reset(struct vhost_test_guest *guest,
+		uint64_t features);
+
+void vhost_test_guest_free(struct vhost_test_guest *guest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TEST_VHOST_COMMON_H_ */
@@ -0,0 +1,423 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_malloc.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_virtio_net.h>
+
+#include "test.h"
+#include "test_vhost_common.h"
+
+/*
+ * Vhost checksum and TSO offload
+ * ==============================
+ *
+ * Runs packets through vrings laid out in local memory, as a guest would
+ * see them, and checks that:
+ *  * rte_vhost_enqueue_burst() turns the TX offload requests of an mbuf
+ *    into the virtio-net header: csum_start/csum_offset for TCP and UDP,
+ *    gso_type/gso_size/hdr_len for TSO, and only when the guest
+ *    negotiated the matching feature
+ *  * the TCP checksum reaching the guest is seeded with the full
+ *    pseudo-header, and the IPv4 header checksum is computed
+ *  * rte_vhost_dequeue_burst() turns the virtio-net header of the guest
+ *    into ol_flags, l2/l3/l4_len and tso_segsz, and reseeds the TCP
+ *    checksum without the length, for DPDK TSO
+ */
+
+#define NB_MBUF 63
+
+#define PAYLOAD_LEN 1000
+#define SEG_SIZE 500
+#define HDRS_LEN_V4 (sizeof(struct ether_hdr) + sizeof(struct ipv4_hdr) + \
+		     sizeof(struct tcp_hdr))
+
+static struct vhost_test_guest guest;
+static struct vhost_test_ring *rx_ring = &guest.rx_ring;
+static struct vhost_test_ring *tx_ring = &guest.tx_ring;
+static struct rte_mempool *pool;
+
+/*
+ * Write an Ethernet/IP/TCP or UDP frame with PAYLOAD_LEN bytes of data
+ * at buf, returns its length.
+ */
+static uint32_t
+build_frame(uint8_t *buf, int ipv6, uint8_t proto)
+{
+	struct ether_hdr *eth_hdr = (struct ether_hdr *)buf;
+	uint32_t l4_len = proto == IPPROTO_TCP ?
+		sizeof(struct tcp_hdr) : sizeof(struct udp_hdr);
+	uint8_t *l4_hdr;
+
+	memset(eth_hdr, 0, sizeof(*eth_hdr));
+	if (ipv6) {
+		struct ipv6_hdr *ipv6_hdr = (struct ipv6_hdr *)(eth_hdr + 1);
+
+		eth_hdr->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv6);
+		memset(ipv6_hdr, 0, sizeof(*ipv6_hdr));
+		ipv6_hdr->vtc_flow = rte_cpu_to_be_32(0x60000000);
+		ipv6_hdr->payload_len = rte_cpu_to_be_16(l4_len + PAYLOAD_LEN);
+		ipv6_hdr->proto = proto;
+		ipv6_hdr->hop_limits = 64;
+		ipv6_hdr->src_addr[15] = 1;
+		ipv6_hdr->dst_addr[15] = 2;
+		l4_hdr = (uint8_t *)(ipv6_hdr + 1);
+	} else {
+		struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
+
+		eth_hdr->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		memset(ipv4_hdr, 0, sizeof(*ipv4_hdr));
+		ipv4_hdr->version_ihl = 0x45;
+		ipv4_hdr->total_length = rte_cpu_to_be_16(
+			sizeof(*ipv4_hdr) + l4_len + PAYLOAD_LEN);
+		ipv4_hdr->time_to_live = 64;
+		ipv4_hdr->next_proto_id = proto;
+		ipv4_hdr->src_addr = rte_cpu_to_be_32(0x0a000001);
+		ipv4_hdr->dst_addr = rte_cpu_to_be_32(0x0a000002);
+		l4_hdr = (uint8_t *)(ipv4_hdr + 1);
+	}
+
+	memset(l4_hdr, 0, l4_len);
+	if (proto == IPPROTO_TCP)
+		((struct tcp_hdr *)l4_hdr)->data_off = 0x50;
+	else
+		((struct udp_hdr *)l4_hdr)->dgram_len =
+			rte_cpu_to_be_16(l4_len + PAYLOAD_LEN);
+	memset(l4_hdr + l4_len, 0xab, PAYLOAD_LEN);
+
+	return (l4_hdr - buf) + l4_len + PAYLOAD_LEN;
+}
+
+/* Make an mbuf of a frame, with the offload fields of a TX request */
+static struct rte_mbuf *
+build_mbuf(int ipv6, uint8_t proto, uint64_t ol_flags)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+	uint32_t len;
+
+	if (m == NULL)
+		return NULL;
+	len = build_frame(rte_pktmbuf_mtod(m, uint8_t *), ipv6, proto);
+	m->data_len = len;
+	m->pkt_len = len;
+	m->ol_flags = ol_flags | (ipv6 ? PKT_TX_IPV6 : PKT_TX_IPV4);
+	m->l2_len = sizeof(struct ether_hdr);
+	m->l3_len = ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr);
+	m->l4_len = proto == IPPROTO_TCP ?
+		sizeof(struct tcp_hdr) : sizeof(struct udp_hdr);
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		m->tso_segsz = SEG_SIZE;
+		/* what an application sets up for DPDK TSO */
+		rte_tcp_phdr_cksum_set(m, PKT_TX_TCP_SEG);
+	}
+	return m;
+}
+
+/*
+ * Enqueue one mbuf into a single guest RX buffer, holding the virtio-net
+ * header then the frame. Returns the header, or NULL on failure.
+ */
+static struct virtio_net_hdr *
+enqueue_one(struct rte_mbuf *m)
+{
+	uint16_t slot = rx_ring->avail.avail.idx % VHOST_TEST_RING_SIZE;
+
+	rx_ring->desc[slot].addr = (uint64_t)slot * VHOST_TEST_BUF_SIZE;
+	rx_ring->desc[slot].len = VHOST_TEST_BUF_SIZE;
+	rx_ring->desc[slot].flags = 0;
+	rx_ring->avail.ring[slot] = slot;
+	rx_ring->avail.avail.idx++;
+
+	if (rte_vhost_enqueue_burst(&guest.dev, VIRTIO_RXQ, &m, 1) != 1) {
+		printf("packet not enqueued\n");
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	rte_pktmbuf_free(m);
+	return (struct virtio_net_hdr *)(guest.mem +
+		rx_ring->desc[slot].addr);
+}
+
+static int
+check_hdr(const struct virtio_net_hdr *hdr, uint8_t flags,
+	  uint16_t csum_start, uint16_t csum_offset, uint8_t gso_type,
+	  uint16_t gso_size, uint16_t hdr_len)
+{
+	if (hdr->flags != flags || hdr->csum_start != csum_start ||
+			hdr->csum_offset != csum_offset ||
+			hdr->gso_type != gso_type ||
+			hdr->gso_size != gso_size || hdr->hdr_len != hdr_len) {
+		printf("wrong virtio-net header: flags %u csum_start %u "
+			"csum_offset %u gso_type %u gso_size %u hdr_len %u\n",
+			hdr->flags, hdr->csum_start, hdr->csum_offset,
+			hdr->gso_type, hdr->gso_size, hdr->hdr_len);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_enqueue_tso(void)
+{
+	struct virtio_net_hdr *hdr;
+	struct ipv4_hdr *ipv4_hdr;
+	struct tcp_hdr *tcp_hdr;
+	struct rte_mbuf *m;
+	uint16_t ip_cksum;
+
+	vhost_test_guest_reset(&guest, 1ULL << VIRTIO_NET_F_GUEST_CSUM |
+		1ULL << VIRTIO_NET_F_GUEST_TSO4 |
+		1ULL << VIRTIO_NET_F_GUEST_TSO6);
+	m = build_mbuf(0, IPPROTO_TCP, PKT_TX_TCP_SEG | PKT_TX_IP_CKSUM);
+	if (m == NULL)
+		return -1;
+	hdr = enqueue_one(m);
+	if (hdr == NULL)
+		return -1;
+
+	if (check_hdr(hdr, VIRTIO_NET_HDR_F_NEEDS_CSUM, 34,
+			offsetof(struct tcp_hdr, cksum),
+			VIRTIO_NET_HDR_GSO_TCPV4, SEG_SIZE, HDRS_LEN_V4) < 0)
+		return -1;
+
+	/* the guest sees the full pseudo-header and a valid IP header */
+	ipv4_hdr = (struct ipv4_hdr *)((uint8_t *)(hdr + 1) +
+		sizeof(struct ether_hdr));
+	tcp_hdr = (struct tcp_hdr *)(ipv4_hdr + 1);
+	if (tcp_hdr->cksum != rte_ipv4_phdr_cksum(ipv4_hdr, 0)) {
+		printf("TCP checksum not seeded with the frame length\n");
+		return -1;
+	}
+	ip_cksum = ipv4_hdr->hdr_checksum;
+	ipv4_hdr->hdr_checksum = 0;
+	if (ip_cksum == 0 || ip_cksum != rte_ipv4_cksum(ipv4_hdr)) {
+		printf("IPv4 header checksum not computed\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_enqueue_cksum(void)
+{
+	struct virtio_net_hdr *hdr;
+	struct rte_mbuf *m;
+
+	/* UDP checksum, no segmentation */
+	vhost_test_guest_reset(&guest, 1ULL << VIRTIO_NET_F_GUEST_CSUM);
+	m = build_mbuf(0, IPPROTO_UDP, PKT_TX_UDP_CKSUM);
+	if (m == NULL)
+		return -1;
+	hdr = enqueue_one(m);
+	if (hdr == NULL || check_hdr(hdr, VIRTIO_NET_HDR_F_NEEDS_CSUM, 34,
+			offsetof(struct udp_hdr, dgram_cksum),
+			VIRTIO_NET_HDR_GSO_NONE, 0, 0) < 0)
+		return -1;
+
+	/* TSO is only passed on if the guest can take it */
+	m = build_mbuf(1, IPPROTO_TCP, PKT_TX_TCP_SEG);
+	if (m == NULL)
+		return -1;
+	hdr = enqueue_one(m);
+	if (hdr == NULL || check_hdr(hdr, VIRTIO_NET_HDR_F_NEEDS_CSUM, 54,
+			offsetof(struct tcp_hdr, cksum),
+			VIRTIO_NET_HDR_GSO_NONE, 0, 0) < 0)
+		return -1;
+
+	/* and nothing at all without GUEST_CSUM */
+	vhost_test_guest_reset(&guest, 0);
+	m = build_mbuf(0, IPPROTO_TCP, PKT_TX_TCP_SEG);
+	if (m == NULL)
+		return -1;
+	hdr = enqueue_one(m);
+	if (hdr == NULL || check_hdr(hdr, 0, 0, 0,
+			VIRTIO_NET_HDR_GSO_NONE, 0, 0) < 0)
+		return -1;
+	return 0;
+}
+
+/*
+ * Post a frame on the TX vring, behind a virtio-net header asking for
+ * TCP segmentation, and dequeue it.
+ */
+static struct rte_mbuf *
+dequeue_tso(int ipv6)
+{
+	uint16_t slot = tx_ring->avail.avail.idx % VHOST_TEST_RING_SIZE;
+	uint16_t head = slot * 2, data = head + 1;
+	struct virtio_net_hdr *hdr;
+	struct rte_mbuf *m, *frame;
+	uint8_t *buf;
+
+	/* the guest seeds the checksum with the full pseudo-header */
+	frame = build_mbuf(ipv6, IPPROTO_TCP, 0);
+	if (frame == NULL)
+		return NULL;
+	rte_tcp_phdr_cksum_set(frame, 0);
+
+	tx_ring->desc[head].addr = (uint64_t)head * VHOST_TEST_BUF_SIZE;
+	tx_ring->desc[head].len = sizeof(struct virtio_net_hdr);
+	tx_ring->desc[head].flags = VRING_DESC_F_NEXT;
+	tx_ring->desc[head].next = data;
+	tx_ring->desc[data].addr = (uint64_t)data * VHOST_TEST_BUF_SIZE;
+	tx_ring->desc[data].len = frame->data_len;
+	tx_ring->desc[data].flags = 0;
+
+	hdr = (struct virtio_net_hdr *)(guest.mem +
+		tx_ring->desc[head].addr);
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	hdr->csum_start = frame->l2_len + frame->l3_len;
+	hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
+	hdr->gso_type = ipv6 ? VIRTIO_NET_HDR_GSO_TCPV6 :
+		VIRTIO_NET_HDR_GSO_TCPV4;
+	hdr->gso_size = SEG_SIZE;
+	hdr->hdr_len = frame->l2_len + frame->l3_len + frame->l4_len;
+
+	buf = guest.mem + tx_ring->desc[data].addr;
+	memcpy(buf, rte_pktmbuf_mtod(frame, void *), frame->data_len);
+	rte_pktmbuf_free(frame);
+
+	tx_ring->avail.ring[slot] = head;
+	tx_ring->avail.avail.idx++;
+
+	if (rte_vhost_dequeue_burst(&guest.dev, VIRTIO_TXQ, pool, &m, 1) != 1) {
+		printf("packet not dequeued\n");
+		return NULL;
+	}
+	return m;
+}
+
+static int
+test_dequeue_tso(void)
+{
+	static const uint64_t v4_flags = PKT_TX_IPV4 | PKT_TX_IP_CKSUM |
+		PKT_TX_TCP_CKSUM | PKT_TX_TCP_SEG;
+	static const uint64_t v6_flags = PKT_TX_IPV6 |
+		PKT_TX_TCP_CKSUM | PKT_TX_TCP_SEG;
+	struct ipv4_hdr *ipv4_hdr;
+	struct ipv6_hdr *ipv6_hdr;
+	struct tcp_hdr *tcp_hdr;
+	struct rte_mbuf *m;
+	int ret = -1;
+
+	vhost_test_guest_reset(&guest, 1ULL << VIRTIO_NET_F_CSUM |
+		1ULL << VIRTIO_NET_F_HOST_TSO4 |
+		1ULL << VIRTIO_NET_F_HOST_TSO6);
+
+	m = dequeue_tso(0);
+	if (m == NULL)
+		return -1;
+	ipv4_hdr = rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+		sizeof(struct ether_hdr));
+	tcp_hdr = (struct tcp_hdr *)(ipv4_hdr + 1);
+	if (m->ol_flags != v4_flags ||
+			m->l2_len != sizeof(struct ether_hdr) ||
+			m->l3_len != sizeof(struct ipv4_hdr) ||
+			m->l4_len != sizeof(struct tcp_hdr) ||
+			m->tso_segsz != SEG_SIZE) {
+		printf("wrong IPv4 offload: ol_flags %" PRIx64 " l2_len %u "
+			"l3_len %u l4_len %u tso_segsz %u\n", m->ol_flags,
+			m->l2_len, m->l3_len, m->l4_len, m->tso_segsz);
+		goto out;
+	}
+	if (ipv4_hdr->hdr_checksum != 0 ||
+			tcp_hdr->cksum != rte_ipv4_phdr_cksum(ipv4_hdr,
+				PKT_TX_TCP_SEG)) {
+		printf("IPv4 checksums not set up for TSO\n");
+		goto out;
+	}
+	rte_pktmbuf_free(m);
+
+	m = dequeue_tso(1);
+	if (m == NULL)
+		return -1;
+	ipv6_hdr = rte_pktmbuf_mtod_offset(m, struct ipv6_hdr *,
+		sizeof(struct ether_hdr));
+	tcp_hdr = (struct tcp_hdr *)(ipv6_hdr + 1);
+	if (m->ol_flags != v6_flags ||
+			m->l3_len != sizeof(struct ipv6_hdr) ||
+			m->l4_len != sizeof(struct tcp_hdr) ||
+			m->tso_segsz != SEG_SIZE) {
+		printf("wrong IPv6 offload: ol_flags %" PRIx64 " l3_len %u "
+			"l4_len %u tso_segsz %u\n", m->ol_flags, m->l3_len,
+			m->l4_len, m->tso_segsz);
+		goto out;
+	}
+	if (tcp_hdr->cksum != rte_ipv6_phdr_cksum(ipv6_hdr, PKT_TX_TCP_SEG)) {
+		printf("IPv6 TCP checksum not set up for TSO\n");
+		goto out;
+	}
+	ret = 0;
+out:
+	rte_pktmbuf_free(m);
+	return ret;
+}
+
+static int
+test_vhost_offload(void)
+{
+	int ret = -1;
+
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create("vhost_offload_pool", NB_MBUF,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (pool == NULL || vhost_test_guest_init(&guest) < 0) {
+		printf("cannot allocate test resources\n");
+		goto out;
+	}
+
+	if (test_enqueue_tso() < 0 || test_enqueue_cksum() < 0 ||
+			test_dequeue_tso() < 0)
+		goto out;
+	ret = 0;
+out:
+	vhost_test_guest_free(&guest);
+	return ret;
+}
+
+static struct test_command vhost_offload_cmd = {
+	.command = "vhost_offload_autotest",
+	.callback = test_vhost_offload,
+};
+REGISTER_TEST_COMMAND(vhost_offload_cmd);
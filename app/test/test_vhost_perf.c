@@ -0,0 +1,493 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_virtio_net.h>
+
+#include "test.h"
+#include "test_vhost_common.h"
+
+/*
+ * Vhost address translation
+ * =========================
+ *
+ * Measures the cycles to convert a guest physical address to a vhost
+ * virtual address, as done for every descriptor by the vhost data path:
+ *  * with the former linear scan of the memory regions
+ *  * with the binary search of gpa_to_vva()
+ *  * with the per virtqueue cache of vq_gpa_to_vva()
+ * for 1 and 8 memory regions, and for buffers in one region (one mempool in
+ * the guest) or spread over all of them.
+ *
+ * Vring layouts
+ * =============
+ *
+ * Measures the cycles per packet of a guest posting 64B packets on a TX
+ * vring, rte_vhost_dequeue_burst() taking them and the guest reclaiming the
+ * descriptors, with:
+ *  * the split ring, the guest reading back the id of each used entry
+ *  * the split ring with VIRTIO_F_IN_ORDER, vhost writing one used entry
+ *    per burst and the guest only reading the used index
+ *  * the packed ring, where descriptors are made available and used in
+ *    place
+ * Guest and vhost run on the same core here, so this only shows the cost
+ * of the memory accesses, not of the cache lines going back and forth
+ * between cores, which the in-order and packed layouts save the most.
+ */
+
+#define NB_ADDR 1024
+#define NB_ITER 1000
+#define REGION_SIZE (512ULL << 20)
+#define REGION_OFFSET 0x7f0000000000ULL
+
+#define RING_NUM 256
+#define RING_BURST 32
+#define RING_ROUNDS 100000
+#define RING_BUF_SIZE 2048
+#define RING_PKT_LEN 64
+#define NB_RING_MBUF 511
+
+static struct virtio_net dev;
+static struct vhost_virtqueue vq;
+static uint64_t addrs[NB_ADDR];
+
+enum ring_layout {
+	RING_SPLIT,
+	RING_IN_ORDER,
+	RING_PACKED,
+};
+
+static const char * const ring_layout_names[] = {
+	[RING_SPLIT] = "split",
+	[RING_IN_ORDER] = "split, in order",
+	[RING_PACKED] = "packed",
+};
+
+static struct vring_desc split_desc[RING_NUM];
+static struct {
+	struct vring_avail avail;
+	uint16_t ring[RING_NUM];
+} split_avail;
+static struct {
+	struct vring_used used;
+	struct vring_used_elem ring[RING_NUM];
+} split_used;
+static struct vring_packed_desc packed_desc[RING_NUM];
+static struct vring_packed_desc_event driver_event, device_event;
+
+/* guest side of the ring */
+static struct {
+	uint8_t *mem;
+	uint16_t avail_idx;
+	uint16_t used_idx;
+	uint16_t avail_wrap;
+	uint16_t used_wrap;
+} guest;
+
+/* previous implementation of gpa_to_vva(), for reference */
+static inline uint64_t __attribute__((always_inline))
+linear_gpa_to_vva(struct virtio_net *d, uint64_t guest_pa)
+{
+	struct virtio_memory_regions *region;
+	uint32_t regionidx;
+	uint64_t vhost_va = 0;
+
+	for (regionidx = 0; regionidx < d->mem->nregions; regionidx++) {
+		region = &d->mem->regions[regionidx];
+		if ((guest_pa >= region->guest_phys_address) &&
+			(guest_pa < region->guest_phys_address_end)) {
+			vhost_va = region->address_offset + guest_pa;
+			break;
+		}
+	}
+	return vhost_va;
+}
+
+/*
+ * Lay out the regions like a guest with hotplugged memory: a hole
+ * below 4G, then one region per DIMM.
+ */
+static struct virtio_memory *
+create_mem(uint32_t nregions)
+{
+	struct virtio_memory *mem;
+	struct virtio_memory_regions *region;
+	uint32_t i;
+
+	mem = calloc(1, sizeof(*mem) + nregions * sizeof(*region));
+	if (mem == NULL)
+		return NULL;
+	mem->nregions = nregions;
+	for (i = 0; i < nregions; i++) {
+		region = &mem->regions[i];
+		region->guest_phys_address = i == 0 ? 0 :
+			(4ULL << 30) + (i - 1) * (1ULL << 30);
+		region->memory_size = REGION_SIZE;
+		region->guest_phys_address_end =
+			region->guest_phys_address + REGION_SIZE;
+		region->address_offset = REGION_OFFSET + i * REGION_SIZE -
+			region->guest_phys_address;
+	}
+	return mem;
+}
+
+/* buffers of 2KB in the last region, or in a random one */
+static void
+fill_addrs(struct virtio_memory *mem, int spread)
+{
+	struct virtio_memory_regions *region;
+	uint32_t i;
+
+	for (i = 0; i < NB_ADDR; i++) {
+		if (spread)
+			region = &mem->regions[rte_rand() % mem->nregions];
+		else
+			region = &mem->regions[mem->nregions - 1];
+		addrs[i] = region->guest_phys_address +
+			(rte_rand() % (REGION_SIZE / 2048)) * 2048;
+	}
+}
+
+static int
+check_translations(void)
+{
+	uint64_t va;
+	uint32_t i;
+
+	for (i = 0; i < NB_ADDR; i++) {
+		va = linear_gpa_to_vva(&dev, addrs[i]);
+		if (va == 0 || gpa_to_vva(&dev, addrs[i]) != va ||
+				vq_gpa_to_vva(&dev, &vq, addrs[i]) != va) {
+			printf("wrong translation of 0x%"PRIx64"\n", addrs[i]);
+			return -1;
+		}
+	}
+	/* in the hole below 4G, and past the end of the last region */
+	if (gpa_to_vva(&dev, 3ULL << 30) != 0 ||
+			vq_gpa_to_vva(&dev, &vq, 3ULL << 30) != 0 ||
+			gpa_to_vva(&dev, dev.mem->regions[
+				dev.mem->nregions - 1].guest_phys_address_end)
+				!= 0) {
+		printf("address out of the regions translated\n");
+		return -1;
+	}
+	return 0;
+}
+
+#define TIME_TRANSLATION(expr) do { \
+	uint64_t start, sum = 0; \
+	uint32_t i, iter; \
+	start = rte_rdtsc(); \
+	for (iter = 0; iter < NB_ITER; iter++) \
+		for (i = 0; i < NB_ADDR; i++) \
+			sum += (expr); \
+	cycles = rte_rdtsc() - start; \
+	result += sum; \
+} while (0)
+
+static int
+test_translation_perf(uint32_t nregions, int spread)
+{
+	static volatile uint64_t result;
+	uint64_t cycles;
+	const uint64_t n = (uint64_t)NB_ITER * NB_ADDR;
+
+	dev.mem = create_mem(nregions);
+	if (dev.mem == NULL)
+		return -1;
+	vq.last_region = 0;
+	fill_addrs(dev.mem, spread);
+	if (check_translations() < 0) {
+		free(dev.mem);
+		return -1;
+	}
+
+	printf("%u region(s), buffers in %s:\n", nregions,
+		spread ? "all regions" : "one region");
+	TIME_TRANSLATION(linear_gpa_to_vva(&dev, addrs[i]));
+	printf("  linear scan:   %.2f cycles\n", (double)cycles / n);
+	TIME_TRANSLATION(gpa_to_vva(&dev, addrs[i]));
+	printf("  binary search: %.2f cycles\n", (double)cycles / n);
+	TIME_TRANSLATION(vq_gpa_to_vva(&dev, &vq, addrs[i]));
+	printf("  cached region: %.2f cycles\n", (double)cycles / n);
+
+	free(dev.mem);
+	dev.mem = NULL;
+	return 0;
+}
+
+static void
+guest_post_split(uint16_t n)
+{
+	uint16_t i, idx;
+
+	for (i = 0; i < n; i++) {
+		idx = (guest.avail_idx + i) & (RING_NUM - 1);
+		split_desc[idx].addr = (uint64_t)idx * RING_BUF_SIZE;
+		split_desc[idx].len = sizeof(struct virtio_net_hdr) +
+			RING_PKT_LEN;
+		split_avail.ring[idx] = idx;
+	}
+	rte_compiler_barrier();
+	guest.avail_idx += n;
+	*(volatile uint16_t *)&split_avail.avail.idx = guest.avail_idx;
+}
+
+static int
+guest_reclaim_split(int in_order)
+{
+	uint16_t used_idx = *(volatile uint16_t *)&split_used.used.idx;
+
+	if (in_order) {
+		guest.used_idx = used_idx;
+		return 0;
+	}
+	for (; guest.used_idx != used_idx; guest.used_idx++)
+		if (split_used.ring[guest.used_idx & (RING_NUM - 1)].id !=
+				(guest.used_idx & (RING_NUM - 1u)))
+			return -1;
+	return 0;
+}
+
+static void
+guest_post_packed(uint16_t n)
+{
+	struct vring_packed_desc *desc;
+	uint16_t i;
+
+	for (i = 0; i < n; i++) {
+		desc = &packed_desc[guest.avail_idx];
+		desc->addr = (uint64_t)guest.avail_idx * RING_BUF_SIZE;
+		desc->len = sizeof(struct virtio_net_hdr) + RING_PKT_LEN;
+		desc->id = guest.avail_idx;
+		rte_compiler_barrier();
+		desc->flags = guest.avail_wrap ?
+			1 << VRING_PACKED_DESC_F_AVAIL :
+			1 << VRING_PACKED_DESC_F_USED;
+		if (++guest.avail_idx == RING_NUM) {
+			guest.avail_idx = 0;
+			guest.avail_wrap ^= 1;
+		}
+	}
+}
+
+static int
+guest_reclaim_packed(void)
+{
+	const uint16_t avail_used = (1 << VRING_PACKED_DESC_F_AVAIL) |
+		(1 << VRING_PACKED_DESC_F_USED);
+	uint16_t flags;
+
+	for (;;) {
+		flags = *(volatile uint16_t *)&packed_desc[guest.used_idx].flags;
+		if ((flags & avail_used) != (guest.used_wrap ? avail_used : 0))
+			return 0;
+		if (packed_desc[guest.used_idx].id != guest.used_idx)
+			return -1;
+		if (++guest.used_idx == RING_NUM) {
+			guest.used_idx = 0;
+			guest.used_wrap ^= 1;
+		}
+	}
+}
+
+static void
+setup_ring(enum ring_layout layout)
+{
+	memset(&vq, 0, sizeof(vq));
+	memset(&guest.avail_idx, 0, sizeof(guest) - sizeof(guest.mem));
+	memset(split_desc, 0, sizeof(split_desc));
+	memset(&split_avail, 0, sizeof(split_avail));
+	memset(&split_used, 0, sizeof(split_used));
+	memset(packed_desc, 0, sizeof(packed_desc));
+
+	dev.features = 0;
+	if (layout == RING_IN_ORDER)
+		dev.features = 1ULL << VIRTIO_F_IN_ORDER;
+	else if (layout == RING_PACKED)
+		dev.features = 1ULL << VIRTIO_F_RING_PACKED;
+	dev.dequeue_zero_copy = 0;
+	dev.virt_qp_nb = 1;
+	dev.virtqueue[VIRTIO_TXQ] = &vq;
+
+	vq.size = RING_NUM;
+	vq.enabled = 1;
+	vq.vhost_hlen = sizeof(struct virtio_net_hdr);
+	vq.callfd = (eventfd_t)-1;
+	if (layout == RING_PACKED) {
+		vq.desc_packed = packed_desc;
+		vq.driver_event = &driver_event;
+		vq.device_event = &device_event;
+		vq.avail_wrap_counter = 1;
+		driver_event.flags = VRING_PACKED_EVENT_FLAG_DISABLE;
+		guest.avail_wrap = 1;
+		guest.used_wrap = 1;
+	} else {
+		vq.desc = split_desc;
+		vq.avail = &split_avail.avail;
+		vq.used = &split_used.used;
+		split_avail.avail.flags = VRING_AVAIL_F_NO_INTERRUPT;
+	}
+}
+
+static void
+guest_post(enum ring_layout layout, uint16_t n)
+{
+	if (layout == RING_PACKED)
+		guest_post_packed(n);
+	else
+		guest_post_split(n);
+}
+
+static int
+guest_reclaim(enum ring_layout layout)
+{
+	if (layout == RING_PACKED)
+		return guest_reclaim_packed();
+	return guest_reclaim_split(layout == RING_IN_ORDER);
+}
+
+static int
+test_ring_layout_perf(struct rte_mempool *pool, enum ring_layout layout)
+{
+	struct rte_mbuf *pkts[RING_BURST];
+	uint64_t start, cycles;
+	uint32_t round;
+	uint16_t n, i;
+
+	setup_ring(layout);
+
+	/* check the first burst goes through, with the right content */
+	guest_post(layout, RING_BURST);
+	n = rte_vhost_dequeue_burst(&dev, VIRTIO_TXQ, pool, pkts, RING_BURST);
+	for (i = 0; i < n; i++) {
+		if (pkts[i]->pkt_len != RING_PKT_LEN ||
+				*rte_pktmbuf_mtod(pkts[i], uint8_t *) !=
+				(uint8_t)i) {
+			printf("%s: wrong packet %u\n",
+				ring_layout_names[layout], i);
+			n = 0;
+		}
+		rte_pktmbuf_free(pkts[i]);
+	}
+	if (n != RING_BURST || guest_reclaim(layout) < 0 ||
+			guest.used_idx != RING_BURST) {
+		printf("%s: burst not dequeued\n", ring_layout_names[layout]);
+		return -1;
+	}
+
+	start = rte_rdtsc();
+	for (round = 0; round < RING_ROUNDS; round++) {
+		guest_post(layout, RING_BURST);
+		n = rte_vhost_dequeue_burst(&dev, VIRTIO_TXQ, pool, pkts,
+			RING_BURST);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(pkts[i]);
+		if (n != RING_BURST || guest_reclaim(layout) < 0) {
+			printf("%s: burst not dequeued\n",
+				ring_layout_names[layout]);
+			return -1;
+		}
+	}
+	cycles = rte_rdtsc() - start;
+
+	printf("%s ring: %.2f cycles per packet\n", ring_layout_names[layout],
+		(double)cycles / ((uint64_t)RING_ROUNDS * RING_BURST));
+	return 0;
+}
+
+static int
+test_ring_perf(void)
+{
+	static struct rte_mempool *pool;
+	int layout, ret = 0;
+	uint32_t i;
+
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create("vhost_perf_pool",
+			NB_RING_MBUF, 32, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			SOCKET_ID_ANY);
+	guest.mem = vhost_test_mem_alloc(&dev, RING_NUM * RING_BUF_SIZE);
+	if (pool == NULL || guest.mem == NULL) {
+		printf("cannot allocate test resources\n");
+		ret = -1;
+		goto out;
+	}
+
+	/* packet i of a burst starts with byte i, past the header */
+	for (i = 0; i < RING_NUM; i++)
+		memset(guest.mem + i * RING_BUF_SIZE +
+			sizeof(struct virtio_net_hdr), i % RING_BURST,
+			RING_PKT_LEN);
+
+	for (layout = RING_SPLIT; layout <= RING_PACKED; layout++)
+		if (test_ring_layout_perf(pool, layout) < 0) {
+			ret = -1;
+			break;
+		}
+out:
+	memset(&vq, 0, sizeof(vq));
+	vhost_test_mem_free(&dev, guest.mem);
+	guest.mem = NULL;
+	return ret;
+}
+
+static int
+test_vhost_perf(void)
+{
+	static const uint32_t nregions[] = { 1, VHOST_MEMORY_MAX_NREGIONS };
+	unsigned i;
+
+	for (i = 0; i < RTE_DIM(nregions); i++) {
+		if (test_translation_perf(nregions[i], 0) < 0)
+			return -1;
+		if (nregions[i] > 1 &&
+				test_translation_perf(nregions[i], 1) < 0)
+			return -1;
+	}
+	return test_ring_perf();
+}
+
+static struct test_command vhost_perf_cmd = {
+	.command = "vhost_perf_autotest",
+	.callback = test_vhost_perf,
+};
+REGISTER_TEST_COMMAND(vhost_perf_cmd);
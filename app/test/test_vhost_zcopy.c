@@ -0,0 +1,321 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_malloc.h>
+#include <rte_virtio_net.h>
+
+#include "test.h"
+#include "test_vhost_common.h"
+
+/*
+ * Vhost zero-copy dequeue
+ * =======================
+ *
+ * Posts packets on a TX vring laid out in local memory, as a guest would,
+ * and checks that rte_vhost_dequeue_burst():
+ *  * returns mbufs pointing to the guest buffers for large packets, and
+ *    copies small ones
+ *  * gives the descriptors of a zero-copy mbuf back to the guest only once
+ *    the application has freed it, and restores the mbuf then
+ *  * falls back to copying once as many zero-copy mbufs as the ring has
+ *    entries are held, even if the guest keeps posting buffers
+ *  * copies everything when zero copy is off
+ */
+
+#define FAKE_HPA 0x100000000ULL
+#define NB_MBUF 63
+
+static struct vhost_test_guest guest;
+static struct virtio_net *dev = &guest.dev;
+static struct vhost_virtqueue *vq = &guest.txvq;
+static struct vhost_test_ring *ring = &guest.tx_ring;
+static struct zcopy_mbuf zmbufs[VHOST_TEST_RING_SIZE];
+static struct guest_page page;
+static struct rte_mempool *pool;
+static uint16_t next_desc;
+
+/* the guest memory is at FAKE_HPA, and the TX queue can do zero copy */
+static int
+setup_dev(void)
+{
+	if (vhost_test_guest_init(&guest) < 0)
+		return -1;
+
+	page.guest_phys_addr = 0;
+	page.host_phys_addr = FAKE_HPA;
+	page.size = VHOST_TEST_MEM_SIZE;
+	dev->guest_pages = &page;
+	dev->nr_guest_pages = 1;
+	vq->zmbufs = zmbufs;
+	return 0;
+}
+
+static void
+reset_ring(int zero_copy)
+{
+	vhost_test_guest_reset(&guest, 0);
+	dev->dequeue_zero_copy = zero_copy;
+	next_desc = 0;
+}
+
+/* make the descriptor chain at head available to vhost */
+static void
+post_head(uint16_t head)
+{
+	ring->avail.ring[ring->avail.avail.idx % VHOST_TEST_RING_SIZE] = head;
+	ring->avail.avail.idx++;
+}
+
+/*
+ * Post a packet made of a header descriptor and one data descriptor per
+ * length in seg_len, each in its own 2KB guest buffer. Returns the head.
+ */
+static uint16_t
+post_pkt(const uint32_t *seg_len, unsigned nb_segs)
+{
+	uint16_t head = next_desc, idx = next_desc;
+	unsigned i;
+
+	ring->desc[idx].addr = (uint64_t)idx * VHOST_TEST_BUF_SIZE;
+	ring->desc[idx].len = sizeof(struct virtio_net_hdr);
+	for (i = 0; i < nb_segs; i++) {
+		ring->desc[idx].flags = VRING_DESC_F_NEXT;
+		ring->desc[idx].next = idx + 1;
+		idx++;
+		ring->desc[idx].addr = (uint64_t)idx * VHOST_TEST_BUF_SIZE;
+		ring->desc[idx].len = seg_len[i];
+		memset(guest.mem + ring->desc[idx].addr, head + i, seg_len[i]);
+	}
+	ring->desc[idx].flags = 0;
+	next_desc = idx + 1;
+
+	post_head(head);
+	return head;
+}
+
+/* the mbuf data is at the guest buffer of desc_idx, or a copy of it */
+static int
+check_seg(struct rte_mbuf *m, uint16_t desc_idx, int zero_copy)
+{
+	uint8_t *buf = guest.mem + ring->desc[desc_idx].addr;
+
+	if (m->data_len != ring->desc[desc_idx].len ||
+			memcmp(rte_pktmbuf_mtod(m, void *), buf,
+				m->data_len) != 0) {
+		printf("wrong data for descriptor %u\n", desc_idx);
+		return -1;
+	}
+	if (zero_copy != (rte_pktmbuf_mtod(m, uint8_t *) == buf)) {
+		printf("descriptor %u %s\n", desc_idx, zero_copy ?
+			"copied" : "not copied");
+		return -1;
+	}
+	if (zero_copy && m->buf_physaddr + m->data_off !=
+			FAKE_HPA + ring->desc[desc_idx].addr) {
+		printf("wrong physical address for descriptor %u\n",
+			desc_idx);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_zero_copy(void)
+{
+	static const uint32_t big[] = { 1500 };
+	static const uint32_t small[] = { 64 };
+	static const uint32_t chained[] = { 700, 800 };
+	struct rte_mbuf *pkts[4];
+	uint16_t head_big, head_small, head_chained;
+	unsigned n;
+
+	reset_ring(1);
+	head_big = post_pkt(big, 1);
+	head_small = post_pkt(small, 1);
+	head_chained = post_pkt(chained, 2);
+
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, 4);
+	if (n != 3) {
+		printf("%u packets dequeued instead of 3\n", n);
+		return -1;
+	}
+	if (check_seg(pkts[0], head_big + 1, 1) < 0 ||
+			check_seg(pkts[1], head_small + 1, 0) < 0 ||
+			pkts[2]->nb_segs != 2 || pkts[2]->pkt_len != 1500 ||
+			check_seg(pkts[2], head_chained + 1, 1) < 0 ||
+			check_seg(pkts[2]->next, head_chained + 2, 1) < 0)
+		return -1;
+
+	/* only the copied packet is back to the guest */
+	if (ring->used.used.idx != 1 ||
+			ring->used.ring[0].id != head_small ||
+			vq->nr_zmbufs != 2) {
+		printf("used ring not updated for the copy only\n");
+		return -1;
+	}
+
+	rte_pktmbuf_free(pkts[1]);
+	rte_pktmbuf_free(pkts[2]);
+	if (rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, 4) != 0 ||
+			ring->used.used.idx != 2 ||
+			ring->used.ring[1].id != head_chained ||
+			vq->nr_zmbufs != 1) {
+		printf("freed packet not given back to the guest\n");
+		return -1;
+	}
+
+	rte_pktmbuf_free(pkts[0]);
+	if (rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, 4) != 0 ||
+			ring->used.used.idx != 3 ||
+			ring->used.ring[2].id != head_big ||
+			vq->nr_zmbufs != 0) {
+		printf("freed packet not given back to the guest\n");
+		return -1;
+	}
+
+	/* the mbufs are back in the pool, pointing to their own buffer */
+	if (rte_mempool_count(pool) != NB_MBUF) {
+		printf("%u mbufs back in the pool instead of %u\n",
+			rte_mempool_count(pool), NB_MBUF);
+		return -1;
+	}
+	n = rte_mempool_get_bulk(pool, (void **)pkts, 1);
+	if (n != 0 || pkts[0]->buf_addr != (char *)pkts[0] +
+			sizeof(struct rte_mbuf) + rte_pktmbuf_priv_size(pool)) {
+		printf("mbuf buffer not restored\n");
+		return -1;
+	}
+	rte_mempool_put(pool, pkts[0]);
+	return 0;
+}
+
+/*
+ * A guest reposting the same buffer over and over while the application
+ * holds all the packets must not get more zero-copy mbufs than the ring
+ * size out of vhost.
+ */
+static int
+test_zero_copy_full(void)
+{
+	static const uint32_t big[] = { 1500 };
+	struct rte_mbuf *pkts[VHOST_TEST_RING_SIZE + 4];
+	uint16_t head;
+	unsigned i, n = 0;
+
+	reset_ring(1);
+	head = post_pkt(big, 1);
+	for (i = 0; i < RTE_DIM(pkts); i++) {
+		if (i != 0)
+			post_head(head);
+		if (rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool,
+				&pkts[n], 1) != 1) {
+			printf("packet %u not dequeued\n", i);
+			goto error;
+		}
+		n++;
+		if (check_seg(pkts[i], head + 1,
+					i < VHOST_TEST_RING_SIZE) < 0 ||
+				vq->nr_zmbufs > VHOST_TEST_RING_SIZE)
+			goto error;
+	}
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+	if (rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, 1) != 0 ||
+			vq->nr_zmbufs != 0 ||
+			rte_mempool_count(pool) != NB_MBUF) {
+		printf("held packets not given back\n");
+		return -1;
+	}
+	return 0;
+
+error:
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return -1;
+}
+
+static int
+test_copy(void)
+{
+	static const uint32_t big[] = { 1500 };
+	struct rte_mbuf *pkt;
+	uint16_t head;
+
+	reset_ring(0);
+	head = post_pkt(big, 1);
+	if (rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, &pkt, 1) != 1)
+		return -1;
+	if (check_seg(pkt, head + 1, 0) < 0)
+		return -1;
+	rte_pktmbuf_free(pkt);
+	if (ring->used.used.idx != 1 || vq->nr_zmbufs != 0) {
+		printf("copied packet not given back to the guest\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_vhost_zcopy(void)
+{
+	int ret = -1;
+
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create("vhost_zcopy_pool", NB_MBUF, 0,
+			0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (pool == NULL || setup_dev() < 0) {
+		printf("cannot allocate test resources\n");
+		goto out;
+	}
+
+	if (test_zero_copy() < 0 || test_zero_copy_full() < 0 ||
+			test_copy() < 0)
+		goto out;
+	ret = 0;
+out:
+	vhost_test_guest_free(&guest);
+	return ret;
+}
+
+static struct test_command vhost_zcopy_cmd = {
+	.command = "vhost_zcopy_autotest",
+	.callback = test_vhost_zcopy,
+};
+REGISTER_TEST_COMMAND(vhost_zcopy_cmd);
@@ -52,6 +52,8 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <poll.h>
+#include <errno.h>
+#include <stdlib.h>
 
 #include "rte_eth_af_packet.h"
 
@@ -60,23 +62,54 @@
 #define ETH_AF_PACKET_BLOCKSIZE_ARG	"blocksz"
 #define ETH_AF_PACKET_FRAMESIZE_ARG	"framesz"
 #define ETH_AF_PACKET_FRAMECOUNT_ARG	"framecnt"
+#define ETH_AF_PACKET_BLOCKTMO_ARG	"blocktmo"
+#define ETH_AF_PACKET_ZEROCOPY_ARG	"zerocopy"
+#define ETH_AF_PACKET_RXVER_ARG		"rxver"
 
-#define DFLT_BLOCK_SIZE		(1 << 12)
+#define DFLT_BLOCK_SIZE		(1 << 16)
 #define DFLT_FRAME_SIZE		(1 << 11)
 #define DFLT_FRAME_COUNT	(1 << 9)
+#define DFLT_BLOCK_TMO		1
+#define DFLT_RX_VERSION		3
+
+struct zcopy_mbuf {
+	struct rte_mbuf *mbuf;
+	unsigned int blocknum;
+	/* own buffer of the mbuf, put back once the frame is released */
+	void *buf_addr;
+	phys_addr_t buf_physaddr;
+	uint16_t buf_len;
+};
 
 struct pkt_rx_queue {
 	int sockfd;
 
 	struct iovec *rd;
 	uint8_t *map;
+	unsigned int blockcount;
+	unsigned int blocknum;
+
+	/* frame ring instead of blocks, with rxver=2 */
 	unsigned int framecount;
 	unsigned int framenum;
 
+	/* read position in the block being consumed */
+	struct tpacket3_hdr *ppd;
+	unsigned int pkts_left;
+	/* users of each block, it goes back to the kernel when none is left */
+	unsigned int *blk_refs;
+
+	/* mbufs attached to ring frames in zero-copy mode, oldest first */
+	struct zcopy_mbuf *zmbufs;
+	unsigned int zmbuf_head;
+	unsigned int nr_zmbufs;
+	unsigned int max_zmbufs;
+
 	struct rte_mempool *mb_pool;
 
 	volatile unsigned long rx_pkts;
 	volatile unsigned long err_pkts;
+	unsigned long missed_pkts;
 };
 
 struct pkt_tx_queue {
@@ -97,7 +130,7 @@ struct pmd_internals {
 	int if_index;
 	struct ether_addr eth_addr;
 
-	struct tpacket_req req;
+	struct tpacket_req3 req;
 
 	struct pkt_rx_queue rx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
 	struct pkt_tx_queue tx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
@@ -109,6 +142,9 @@ static const char *valid_arguments[] = {
 	ETH_AF_PACKET_BLOCKSIZE_ARG,
 	ETH_AF_PACKET_FRAMESIZE_ARG,
 	ETH_AF_PACKET_FRAMECOUNT_ARG,
+	ETH_AF_PACKET_BLOCKTMO_ARG,
+	ETH_AF_PACKET_ZEROCOPY_ARG,
+	ETH_AF_PACKET_RXVER_ARG,
 	NULL
 };
 
@@ -120,8 +156,58 @@ static struct rte_eth_link pmd_link = {
 	.link_status = 0
 };
 
+/*
+ * Drops a reference to a ring block, the last one hands the block back to
+ * the kernel.
+ */
+static inline void
+af_packet_block_put(struct pkt_rx_queue *pkt_q, unsigned int blocknum)
+{
+	struct tpacket_block_desc *pbd;
+
+	if (--pkt_q->blk_refs[blocknum] != 0)
+		return;
+
+	pbd = (struct tpacket_block_desc *) pkt_q->rd[blocknum].iov_base;
+	/* all reads of the block must be done before the kernel refills it */
+	rte_mb();
+	pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+}
+
+/*
+ * Gives back the ring frames of the zero-copy mbufs the application has
+ * freed, i.e. of which the PMD holds the last reference. They are checked
+ * in reception order and the walk stops at the first one still in use:
+ * the kernel fills the blocks in ring order, so a block released ahead of
+ * an older one held by the application would not be reused any sooner.
+ */
+static inline void
+af_packet_reclaim_zmbufs(struct pkt_rx_queue *pkt_q)
+{
+	struct zcopy_mbuf *zmbuf;
+
+	while (pkt_q->nr_zmbufs != 0) {
+		zmbuf = &pkt_q->zmbufs[pkt_q->zmbuf_head];
+		if (rte_mbuf_refcnt_read(zmbuf->mbuf) != 1)
+			break;
+
+		af_packet_block_put(pkt_q, zmbuf->blocknum);
+		zmbuf->mbuf->buf_addr = zmbuf->buf_addr;
+		zmbuf->mbuf->buf_physaddr = zmbuf->buf_physaddr;
+		zmbuf->mbuf->buf_len = zmbuf->buf_len;
+		rte_pktmbuf_free(zmbuf->mbuf);
+		if (++pkt_q->zmbuf_head == pkt_q->max_zmbufs)
+			pkt_q->zmbuf_head = 0;
+		pkt_q->nr_zmbufs--;
+	}
+}
+
+/*
+ * Receives from a TPACKET_V2 frame ring: every packet is copied into a
+ * newly allocated mbuf and its frame handed back to the kernel at once.
+ */
 static uint16_t
-eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+eth_af_packet_rx_v2(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	unsigned i;
 	struct tpacket2_hdr *ppd;
@@ -129,15 +215,12 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	uint8_t *pbuf;
 	struct pkt_rx_queue *pkt_q = queue;
 	uint16_t num_rx = 0;
+	unsigned long num_err = 0;
 	unsigned int framecount, framenum;
 
 	if (unlikely(nb_pkts == 0))
 		return 0;
 
-	/*
-	 * Reads the given number of packets from the AF_PACKET socket one by
-	 * one and copies the packet data into a newly allocated mbuf.
-	 */
 	framecount = pkt_q->framecount;
 	framenum = pkt_q->framenum;
 	for (i = 0; i < nb_pkts; i++) {
@@ -151,22 +234,144 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		if (unlikely(mbuf == NULL))
 			break;
 
-		/* packet will fit in the mbuf, go ahead and receive it */
-		rte_pktmbuf_pkt_len(mbuf) = rte_pktmbuf_data_len(mbuf) = ppd->tp_snaplen;
 		pbuf = (uint8_t *) ppd + ppd->tp_mac;
-		memcpy(rte_pktmbuf_mtod(mbuf, void *), pbuf, rte_pktmbuf_data_len(mbuf));
+		if (likely(ppd->tp_snaplen <= rte_pktmbuf_tailroom(mbuf))) {
+			rte_pktmbuf_pkt_len(mbuf) = ppd->tp_snaplen;
+			rte_pktmbuf_data_len(mbuf) = (uint16_t)ppd->tp_snaplen;
+			memcpy(rte_pktmbuf_mtod(mbuf, void *), pbuf,
+			       rte_pktmbuf_data_len(mbuf));
+			bufs[num_rx++] = mbuf;
+		} else {
+			/* packet does not fit in a single mbuf, drop it */
+			rte_pktmbuf_free(mbuf);
+			num_err++;
+		}
 
 		/* release incoming frame and advance ring buffer */
 		ppd->tp_status = TP_STATUS_KERNEL;
 		if (++framenum >= framecount)
 			framenum = 0;
+	}
+	pkt_q->framenum = framenum;
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->err_pkts += num_err;
+	return num_rx;
+}
+
+static uint16_t
+eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct tpacket_block_desc *pbd;
+	struct tpacket3_hdr *ppd;
+	struct zcopy_mbuf *zmbuf;
+	struct rte_mbuf *mbuf;
+	uint8_t *pbuf;
+	struct pkt_rx_queue *pkt_q = queue;
+	uint16_t num_rx = 0;
+	unsigned long num_err = 0;
+	unsigned int blocknum, pkts_left, snaplen, i;
+
+	if (unlikely(nb_pkts == 0))
+		return 0;
+
+	if (pkt_q->nr_zmbufs != 0)
+		af_packet_reclaim_zmbufs(pkt_q);
+
+	/*
+	 * Walks the packets of the block retired by the kernel, either
+	 * copying them into newly allocated mbufs or attaching the mbufs to
+	 * the ring frames. The block is handed back as a whole once all its
+	 * packets have been read and no zero-copy mbuf refers to it.
+	 */
+	blocknum = pkt_q->blocknum;
+	pkts_left = pkt_q->pkts_left;
+	ppd = pkt_q->ppd;
+	while (num_rx < nb_pkts) {
+		if (pkts_left == 0) {
+			/*
+			 * Point at the next retired block, unless the ring
+			 * wrapped onto a block still referenced by mbufs of
+			 * the application.
+			 */
+			pbd = (struct tpacket_block_desc *)
+				pkt_q->rd[blocknum].iov_base;
+			if ((pbd->hdr.bh1.block_status & TP_STATUS_USER) == 0 ||
+			    pkt_q->blk_refs[blocknum] != 0)
+				break;
+			rte_rmb();
+
+			pkt_q->blk_refs[blocknum] = 1;
+			pkts_left = pbd->hdr.bh1.num_pkts;
+			ppd = (struct tpacket3_hdr *) ((uint8_t *) pbd +
+				pbd->hdr.bh1.offset_to_first_pkt);
+			if (unlikely(pkts_left == 0)) {
+				af_packet_block_put(pkt_q, blocknum);
+				if (++blocknum >= pkt_q->blockcount)
+					blocknum = 0;
+				continue;
+			}
+		}
+
+		/* allocate the next mbuf */
+		mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
+		if (unlikely(mbuf == NULL))
+			break;
+
+		snaplen = ppd->tp_snaplen;
+		pbuf = (uint8_t *) ppd + ppd->tp_mac;
+		if (pkt_q->nr_zmbufs < pkt_q->max_zmbufs &&
+		    ppd->tp_mac + snaplen <= UINT16_MAX) {
+			/*
+			 * Attach the mbuf to the frame, its headroom overlays
+			 * the frame header which is not needed anymore. The
+			 * extra reference tells when the application is done.
+			 */
+			i = pkt_q->zmbuf_head + pkt_q->nr_zmbufs++;
+			if (i >= pkt_q->max_zmbufs)
+				i -= pkt_q->max_zmbufs;
+			zmbuf = &pkt_q->zmbufs[i];
+			zmbuf->mbuf = mbuf;
+			zmbuf->blocknum = blocknum;
+			zmbuf->buf_addr = mbuf->buf_addr;
+			zmbuf->buf_physaddr = mbuf->buf_physaddr;
+			zmbuf->buf_len = mbuf->buf_len;
+			pkt_q->blk_refs[blocknum]++;
+
+			mbuf->buf_addr = ppd;
+			mbuf->buf_physaddr = 0;
+			mbuf->buf_len = (uint16_t)(ppd->tp_mac + snaplen);
+			mbuf->data_off = ppd->tp_mac;
+			rte_mbuf_refcnt_update(mbuf, 1);
+		} else if (likely(snaplen <= rte_pktmbuf_tailroom(mbuf))) {
+			memcpy(rte_pktmbuf_mtod(mbuf, void *), pbuf, snaplen);
+		} else {
+			/* packet does not fit in a single mbuf, drop it */
+			rte_pktmbuf_free(mbuf);
+			mbuf = NULL;
+			num_err++;
+		}
 
 		/* account for the receive frame */
-		bufs[i] = mbuf;
-		num_rx++;
+		if (mbuf != NULL) {
+			rte_pktmbuf_pkt_len(mbuf) = snaplen;
+			rte_pktmbuf_data_len(mbuf) = (uint16_t)snaplen;
+			bufs[num_rx++] = mbuf;
+		}
+
+		/* advance in the block, release it after its last packet */
+		ppd = (struct tpacket3_hdr *) ((uint8_t *) ppd +
+			ppd->tp_next_offset);
+		if (--pkts_left == 0) {
+			af_packet_block_put(pkt_q, blocknum);
+			if (++blocknum >= pkt_q->blockcount)
+				blocknum = 0;
+		}
 	}
-	pkt_q->framenum = framenum;
+	pkt_q->blocknum = blocknum;
+	pkt_q->pkts_left = pkts_left;
+	pkt_q->ppd = ppd;
 	pkt_q->rx_pkts += num_rx;
+	pkt_q->err_pkts += num_err;
 	return num_rx;
 }
 
@@ -249,9 +454,18 @@ eth_dev_stop(struct rte_eth_dev *dev)
 		sockfd = internals->rx_queue[i].sockfd;
 		if (sockfd != -1)
 			close(sockfd);
+		internals->rx_queue[i].sockfd = -1;
 		sockfd = internals->tx_queue[i].sockfd;
 		if (sockfd != -1)
 			close(sockfd);
+		internals->tx_queue[i].sockfd = -1;
+
+		/*
+		 * The rings stay mapped, zero-copy mbufs the application
+		 * still holds remain valid.
+		 */
+		if (internals->rx_queue[i].nr_zmbufs != 0)
+			af_packet_reclaim_zmbufs(&internals->rx_queue[i]);
 	}
 
 	dev->data->dev_link.link_status = 0;
@@ -282,14 +496,30 @@ static void
 eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 {
 	unsigned i, imax;
-	unsigned long rx_total = 0, tx_total = 0, tx_err_total = 0;
-	const struct pmd_internals *internal = dev->data->dev_private;
+	unsigned long rx_total = 0, rx_err_total = 0, rx_missed_total = 0;
+	unsigned long tx_total = 0, tx_err_total = 0;
+	struct pmd_internals *internal = dev->data->dev_private;
+	struct pkt_rx_queue *rxq;
+	struct tpacket_stats_v3 kstats;
+	socklen_t len;
 
 	imax = (internal->nb_queues < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
 	        internal->nb_queues : RTE_ETHDEV_QUEUE_STAT_CNTRS);
 	for (i = 0; i < imax; i++) {
 		igb_stats->q_ipackets[i] = internal->rx_queue[i].rx_pkts;
 		rx_total += igb_stats->q_ipackets[i];
+		rx_err_total += internal->rx_queue[i].err_pkts;
+	}
+
+	/* packets the kernel dropped for lack of a free block */
+	for (i = 0; i < internal->nb_queues; i++) {
+		rxq = &internal->rx_queue[i];
+		len = sizeof(kstats);
+		if (rxq->sockfd != -1 &&
+		    getsockopt(rxq->sockfd, SOL_PACKET, PACKET_STATISTICS,
+			       &kstats, &len) == 0)
+			rxq->missed_pkts += kstats.tp_drops;
+		rx_missed_total += rxq->missed_pkts;
 	}
 
 	imax = (internal->nb_queues < RTE_ETHDEV_QUEUE_STAT_CNTRS ?
@@ -302,6 +532,8 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 	}
 
 	igb_stats->ipackets = rx_total;
+	igb_stats->ierrors = rx_err_total;
+	igb_stats->imissed = rx_missed_total;
 	igb_stats->opackets = tx_total;
 	igb_stats->oerrors = tx_err_total;
 }
@@ -311,9 +543,19 @@ eth_stats_reset(struct rte_eth_dev *dev)
 {
 	unsigned i;
 	struct pmd_internals *internal = dev->data->dev_private;
+	struct tpacket_stats_v3 kstats;
+	socklen_t len;
 
-	for (i = 0; i < internal->nb_queues; i++)
+	for (i = 0; i < internal->nb_queues; i++) {
+		/* reading the kernel counters clears them */
+		len = sizeof(kstats);
+		if (internal->rx_queue[i].sockfd != -1)
+			getsockopt(internal->rx_queue[i].sockfd, SOL_PACKET,
+				   PACKET_STATISTICS, &kstats, &len);
 		internal->rx_queue[i].rx_pkts = 0;
+		internal->rx_queue[i].err_pkts = 0;
+		internal->rx_queue[i].missed_pkts = 0;
+	}
 
 	for (i = 0; i < internal->nb_queues; i++) {
 		internal->tx_queue[i].tx_pkts = 0;
@@ -425,6 +667,9 @@ rte_pmd_init_internals(const char *name,
                        unsigned int blockcnt,
                        unsigned int framesize,
                        unsigned int framecnt,
+                       unsigned int blocktmo,
+                       unsigned int zerocopy,
+                       unsigned int rxver,
                        const unsigned numa_node,
                        struct pmd_internals **internals,
                        struct rte_eth_dev **eth_dev,
@@ -437,11 +682,12 @@ rte_pmd_init_internals(const char *name,
 	size_t ifnamelen;
 	unsigned k_idx;
 	struct sockaddr_ll sockaddr;
-	struct tpacket_req *req;
+	struct tpacket_req3 *req;
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
 	int rc, tpver, discard;
-	int qsockfd = -1;
+	int qsockfd;
+	size_t ringsize = 0;
 	unsigned int i, q, rdsize;
 	int fanout_arg __rte_unused, bypass __rte_unused;
 
@@ -479,7 +725,9 @@ rte_pmd_init_internals(const char *name,
 		goto error;
 
 	for (q = 0; q < nb_queues; q++) {
+		(*internals)->rx_queue[q].sockfd = -1;
 		(*internals)->rx_queue[q].map = MAP_FAILED;
+		(*internals)->tx_queue[q].sockfd = -1;
 		(*internals)->tx_queue[q].map = MAP_FAILED;
 	}
 
@@ -489,6 +737,8 @@ rte_pmd_init_internals(const char *name,
 	req->tp_block_nr = blockcnt;
 	req->tp_frame_size = framesize;
 	req->tp_frame_nr = framecnt;
+	req->tp_retire_blk_tov = blocktmo;
+	ringsize = (size_t)blocksize * blockcnt;
 
 	ifnamelen = strlen(pair->value);
 	if (ifnamelen < sizeof(ifr.ifr_name)) {
@@ -529,16 +779,130 @@ rte_pmd_init_internals(const char *name,
 #endif
 #endif
 
+	/*
+	 * Each queue pair gets its own pair of sockets: received packets are
+	 * read from TPACKET_V3 blocks, which the kernel hands over once full
+	 * or after blocktmo ms, unless rxver=2 asks for a frame ring, while
+	 * transmit keeps the TPACKET_V2 frame ring. The transmit socket is
+	 * bound to no protocol so it does not receive anything and, with the
+	 * qdisc bypassed, what it sends does not show up on the receive
+	 * socket either.
+	 */
 	for (q = 0; q < nb_queues; q++) {
-		/* Open an AF_PACKET socket for this queue... */
-		qsockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+		rx_queue = &((*internals)->rx_queue[q]);
+		tx_queue = &((*internals)->tx_queue[q]);
+
+		/* Open the receive socket for this queue... */
+		qsockfd = socket(AF_PACKET, SOCK_RAW, 0);
 		if (qsockfd == -1) {
 			RTE_LOG(ERR, PMD,
 			        "%s: could not open AF_PACKET socket\n",
 			        name);
-			return -1;
+			goto error;
+		}
+		rx_queue->sockfd = qsockfd;
+
+		tpver = rxver == 2 ? TPACKET_V2 : TPACKET_V3;
+		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
+				&tpver, sizeof(tpver));
+		if (rc == -1) {
+			RTE_LOG(ERR, PMD,
+				"%s: could not set PACKET_VERSION on AF_PACKET "
+				"socket for %s\n", name, pair->value);
+			goto error;
+		}
+
+		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
+		if (rc == -1) {
+			RTE_LOG(ERR, PMD,
+				"%s: could not set PACKET_RX_RING on AF_PACKET "
+				"socket for %s\n", name, pair->value);
+			goto error;
 		}
 
+		rx_queue->blockcount = req->tp_block_nr;
+		rx_queue->framecount = req->tp_frame_nr;
+
+		rx_queue->map = mmap(NULL, ringsize,
+				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
+				    qsockfd, 0);
+		if (rx_queue->map == MAP_FAILED) {
+			RTE_LOG(ERR, PMD,
+				"%s: call to mmap failed on AF_PACKET socket for %s\n",
+				name, pair->value);
+			goto error;
+		}
+
+		if (rxver == 2) {
+			rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req->tp_frame_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * framesize);
+				rx_queue->rd[i].iov_len = req->tp_frame_size;
+			}
+		} else {
+			rdsize = req->tp_block_nr * sizeof(*(rx_queue->rd));
+			rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0,
+							  numa_node);
+			if (rx_queue->rd == NULL)
+				goto error;
+			for (i = 0; i < req->tp_block_nr; ++i) {
+				rx_queue->rd[i].iov_base = rx_queue->map +
+					(i * blocksize);
+				rx_queue->rd[i].iov_len = req->tp_block_size;
+			}
+
+			rx_queue->blk_refs = rte_zmalloc_socket(name,
+				req->tp_block_nr *
+				sizeof(*(rx_queue->blk_refs)), 0, numa_node);
+			if (rx_queue->blk_refs == NULL)
+				goto error;
+		}
+
+		if (zerocopy) {
+			/* enough for a ring full of minimum sized packets */
+			rx_queue->max_zmbufs = ringsize /
+				(TPACKET3_HDRLEN + ETHER_MIN_LEN);
+			rx_queue->zmbufs = rte_zmalloc_socket(name,
+				rx_queue->max_zmbufs *
+				sizeof(*(rx_queue->zmbufs)), 0, numa_node);
+			if (rx_queue->zmbufs == NULL)
+				goto error;
+		}
+
+		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
+		if (rc == -1) {
+			RTE_LOG(ERR, PMD,
+				"%s: could not bind AF_PACKET socket to %s\n",
+			        name, pair->value);
+			goto error;
+		}
+
+#if defined(PACKET_FANOUT)
+		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_FANOUT,
+				&fanout_arg, sizeof(fanout_arg));
+		if (rc == -1) {
+			RTE_LOG(ERR, PMD,
+				"%s: could not set PACKET_FANOUT on AF_PACKET socket "
+				"for %s\n", name, pair->value);
+			goto error;
+		}
+#endif
+
+		/* ...and the transmit one */
+		qsockfd = socket(AF_PACKET, SOCK_RAW, 0);
+		if (qsockfd == -1) {
+			RTE_LOG(ERR, PMD,
+			        "%s: could not open AF_PACKET socket\n",
+			        name);
+			goto error;
+		}
+		tx_queue->sockfd = qsockfd;
+
 		tpver = TPACKET_V2;
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
 				&tpver, sizeof(tpver));
@@ -572,14 +936,7 @@ rte_pmd_init_internals(const char *name,
 		}
 #endif
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
-		if (rc == -1) {
-			RTE_LOG(ERR, PMD,
-				"%s: could not set PACKET_RX_RING on AF_PACKET "
-				"socket for %s\n", name, pair->value);
-			goto error;
-		}
-
+		/* only the tpacket_req part is used for TPACKET_V2 */
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
@@ -588,35 +945,19 @@ rte_pmd_init_internals(const char *name,
 			goto error;
 		}
 
-		rx_queue = &((*internals)->rx_queue[q]);
-		rx_queue->framecount = req->tp_frame_nr;
+		tx_queue->framecount = req->tp_frame_nr;
 
-		rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
+		tx_queue->map = mmap(NULL, ringsize,
 				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
 				    qsockfd, 0);
-		if (rx_queue->map == MAP_FAILED) {
+		if (tx_queue->map == MAP_FAILED) {
 			RTE_LOG(ERR, PMD,
 				"%s: call to mmap failed on AF_PACKET socket for %s\n",
 				name, pair->value);
 			goto error;
 		}
 
-		/* rdsize is same for both Tx and Rx */
-		rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
-
-		rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
-		if (rx_queue->rd == NULL)
-			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			rx_queue->rd[i].iov_base = rx_queue->map + (i * framesize);
-			rx_queue->rd[i].iov_len = req->tp_frame_size;
-		}
-		rx_queue->sockfd = qsockfd;
-
-		tx_queue = &((*internals)->tx_queue[q]);
-		tx_queue->framecount = req->tp_frame_nr;
-
-		tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
+		rdsize = req->tp_frame_nr * sizeof(*(tx_queue->rd));
 
 		tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
 		if (tx_queue->rd == NULL)
@@ -625,26 +966,16 @@ rte_pmd_init_internals(const char *name,
 			tx_queue->rd[i].iov_base = tx_queue->map + (i * framesize);
 			tx_queue->rd[i].iov_len = req->tp_frame_size;
 		}
-		tx_queue->sockfd = qsockfd;
 
+		sockaddr.sll_protocol = 0;
 		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
+		sockaddr.sll_protocol = htons(ETH_P_ALL);
 		if (rc == -1) {
 			RTE_LOG(ERR, PMD,
 				"%s: could not bind AF_PACKET socket to %s\n",
 			        name, pair->value);
 			goto error;
 		}
-
-#if defined(PACKET_FANOUT)
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_FANOUT,
-				&fanout_arg, sizeof(fanout_arg));
-		if (rc == -1) {
-			RTE_LOG(ERR, PMD,
-				"%s: could not set PACKET_FANOUT on AF_PACKET socket "
-				"for %s\n", name, pair->value);
-			goto error;
-		}
-#endif
 	}
 
 	/* reserve an ethdev entry */
@@ -683,19 +1014,25 @@ error:
 
 	if (*internals) {
 		for (q = 0; q < nb_queues; q++) {
-			munmap((*internals)->rx_queue[q].map,
-			       2 * req->tp_block_size * req->tp_block_nr);
-
-			rte_free((*internals)->rx_queue[q].rd);
-			rte_free((*internals)->tx_queue[q].rd);
-			if (((*internals)->rx_queue[q].sockfd != 0) &&
-				((*internals)->rx_queue[q].sockfd != qsockfd))
-				close((*internals)->rx_queue[q].sockfd);
+			rx_queue = &((*internals)->rx_queue[q]);
+			tx_queue = &((*internals)->tx_queue[q]);
+
+			if (rx_queue->map != MAP_FAILED)
+				munmap(rx_queue->map, ringsize);
+			if (tx_queue->map != MAP_FAILED)
+				munmap(tx_queue->map, ringsize);
+
+			rte_free(rx_queue->rd);
+			rte_free(rx_queue->blk_refs);
+			rte_free(rx_queue->zmbufs);
+			rte_free(tx_queue->rd);
+			if (rx_queue->sockfd != -1)
+				close(rx_queue->sockfd);
+			if (tx_queue->sockfd != -1)
+				close(tx_queue->sockfd);
 		}
 		rte_free(*internals);
 	}
-	if (qsockfd != -1)
-		close(qsockfd);
 	return -1;
 }
 
@@ -713,7 +1050,12 @@ rte_eth_from_packet(const char *name,
 	unsigned int blocksize = DFLT_BLOCK_SIZE;
 	unsigned int framesize = DFLT_FRAME_SIZE;
 	unsigned int framecount = DFLT_FRAME_COUNT;
+	unsigned int blocktmo = DFLT_BLOCK_TMO;
+	unsigned int zerocopy = 0;
 	unsigned int qpairs = 1;
+	unsigned int rxver = DFLT_RX_VERSION;
+	char *end;
+	long tmo;
 
 	/* do some parameter checking */
 	if (*sockfd < 0)
@@ -765,6 +1107,44 @@ rte_eth_from_packet(const char *name,
 			}
 			continue;
 		}
+		if (strstr(pair->key, ETH_AF_PACKET_BLOCKTMO_ARG) != NULL) {
+			/*
+			 * 0 lets the kernel derive it from the link speed,
+			 * which keeps it in 16 bits.
+			 */
+			errno = 0;
+			tmo = strtol(pair->value, &end, 10);
+			if (errno != 0 || end == pair->value || *end != '\0' ||
+			    tmo < 0 || tmo > UINT16_MAX) {
+				RTE_LOG(ERR, PMD,
+					"%s: invalid blocktmo value\n",
+				        name);
+				return -1;
+			}
+			blocktmo = (unsigned int)tmo;
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_ZEROCOPY_ARG) != NULL) {
+			zerocopy = atoi(pair->value) != 0;
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_RXVER_ARG) != NULL) {
+			rxver = atoi(pair->value);
+			if (rxver != 2 && rxver != 3) {
+				RTE_LOG(ERR, PMD,
+					"%s: invalid rxver value\n",
+				        name);
+				return -1;
+			}
+			continue;
+		}
+	}
+
+	if (zerocopy && rxver != 3) {
+		RTE_LOG(ERR, PMD,
+			"%s: zero-copy needs the TPACKET_V3 receive ring\n",
+		        name);
+		return -1;
 	}
 
 	if (framesize > blocksize) {
@@ -786,15 +1166,23 @@ rte_eth_from_packet(const char *name,
 	RTE_LOG(INFO, PMD, "%s:\tblock count %d\n", name, blockcount);
 	RTE_LOG(INFO, PMD, "%s:\tframe size %d\n", name, framesize);
 	RTE_LOG(INFO, PMD, "%s:\tframe count %d\n", name, framecount);
+	RTE_LOG(INFO, PMD, "%s:\treceive ring TPACKET_V%u\n", name, rxver);
+	RTE_LOG(INFO, PMD, "%s:\tblock timeout %d ms\n", name, blocktmo);
+	RTE_LOG(INFO, PMD, "%s:\tzero-copy %s\n", name,
+		zerocopy ? "on" : "off");
 
 	if (rte_pmd_init_internals(name, *sockfd, qpairs,
 	                           blocksize, blockcount,
 	                           framesize, framecount,
+	                           blocktmo, zerocopy, rxver,
 	                           numa_node, &internals, &eth_dev,
 	                           kvlist) < 0)
 		return -1;
 
-	eth_dev->rx_pkt_burst = eth_af_packet_rx;
+	if (rxver == 2)
+		eth_dev->rx_pkt_burst = eth_af_packet_rx_v2;
+	else
+		eth_dev->rx_pkt_burst = eth_af_packet_rx;
 	eth_dev->tx_pkt_burst = eth_af_packet_tx;
 
 	return 0;
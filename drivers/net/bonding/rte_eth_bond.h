@@ -116,6 +116,23 @@ extern "C" {
 /**< Layer 2+3 (Ethernet MAC + IP Addresses) transmit load balancing */
 #define BALANCE_XMIT_POLICY_LAYER34		(2)
 /**< Layer 3+4 (IP Addresses + UDP Ports) transmit load balancing */
+#define BALANCE_XMIT_POLICY_USER		(3)
+/**< User-defined, set with rte_eth_bond_xmit_policy_hook_set() */
+
+/**
+ * Transmit policy hook, selecting the output slave of each packet of a burst
+ * in balance and 802.3ad modes.
+ *
+ * @param pkts			Packets to transmit.
+ * @param nb_pkts		Number of packets in pkts.
+ * @param slave_count	Number of slaves to spread the packets over: the active
+ *				slaves in balance mode, the distributing ones in 802.3ad mode.
+ * @param slaves		Set to the output slave of each packet, as a position
+ *				in [0, slave_count). Packets given another value are
+ *				freed and counted in the oerrors of the bonded device.
+ */
+typedef void (*rte_eth_bond_xmit_hash_t)(struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint8_t slave_count, uint16_t *slaves);
 
 /**
  * Create a bonded rte_eth_dev device
@@ -292,6 +309,23 @@ rte_eth_bond_xmit_policy_set(uint8_t bonded_port_id, uint8_t policy);
 int
 rte_eth_bond_xmit_policy_get(uint8_t bonded_port_id);
 
+/**
+ * Set a user-defined transmit policy for bonded device to use when it is
+ * operating in balance or 802.3ad mode. The policy is then reported as
+ * BALANCE_XMIT_POLICY_USER, until another one is set with
+ * rte_eth_bond_xmit_policy_set().
+ *
+ * @param bonded_port_id	Port ID of bonded device.
+ * @param hash				Transmit policy hook, called from the transmit burst
+ *							function of the bonded device.
+ *
+ * @return
+ *	0 on success, negative value otherwise.
+ */
+int
+rte_eth_bond_xmit_policy_hook_set(uint8_t bonded_port_id,
+		rte_eth_bond_xmit_hash_t hash);
+
 /**
  * Set the link monitoring frequency (in ms) for monitoring the link status of
  * slave devices
@@ -737,6 +737,52 @@ link_speed_key(uint16_t speed) {
 	return key_speed;
 }
 
+/**
+ * Reads slow protocol frames steered to control RX queue of given slave and
+ * passes them to state machines.
+ */
+static void
+rx_ctrl_queue_poll(struct bond_dev_private *internals, uint8_t slave_id)
+{
+	struct rte_mbuf *pkts[BOND_MODE_8023AX_SLAVE_CTRL_RX_BURST];
+	struct ether_hdr *hdr;
+	uint16_t nb_rx, i;
+
+	nb_rx = rte_eth_rx_burst(slave_id, internals->mode4.dedicated_queues.rx_qid,
+			pkts, RTE_DIM(pkts));
+
+	for (i = 0; i < nb_rx; i++) {
+		hdr = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+		if (likely(hdr->ether_type == rte_cpu_to_be_16(ETHER_TYPE_SLOW)))
+			bond_mode_8023ad_handle_slow_pkt(internals, slave_id, pkts[i]);
+		else
+			rte_pktmbuf_free(pkts[i]);
+	}
+}
+
+/**
+ * Sends slow protocol frames queued by state machines through control TX
+ * queue of given slave. Frames that could not be sent are dropped, state
+ * machines will retransmit LACPDUs anyway.
+ */
+static void
+tx_ctrl_queue_flush(struct bond_dev_private *internals, uint8_t slave_id)
+{
+	struct port *port = &mode_8023ad_ports[slave_id];
+	void *pkts[BOND_MODE_8023AX_SLAVE_TX_PKTS + 1];
+	uint16_t nb_pkts, nb_tx;
+
+	nb_pkts = rte_ring_dequeue_burst(port->tx_ring, pkts, RTE_DIM(pkts));
+	if (nb_pkts == 0)
+		return;
+
+	nb_tx = rte_eth_tx_burst(slave_id, internals->mode4.dedicated_queues.tx_qid,
+			(struct rte_mbuf **)pkts, nb_pkts);
+
+	for ( ; nb_tx < nb_pkts; nb_tx++)
+		rte_pktmbuf_free(pkts[nb_tx]);
+}
+
 static void
 bond_mode_8023ad_periodic_cb(void *arg)
 {
@@ -806,6 +852,9 @@ bond_mode_8023ad_periodic_cb(void *arg)
 
 		SM_FLAG_SET(port, LACP_ENABLED);
 
+		if (internals->mode4.dedicated_queues.enabled)
+			rx_ctrl_queue_poll(internals, slave_id);
+
 		/* Find LACP packet to this port. Do not check subtype, it is done in
 		 * function that queued packet */
 		if (rte_ring_dequeue(port->rx_ring, &pkt) == 0) {
@@ -826,6 +875,9 @@ bond_mode_8023ad_periodic_cb(void *arg)
 		tx_machine(internals, slave_id);
 		selection_logic(internals, slave_id);
 
+		if (internals->mode4.dedicated_queues.enabled)
+			tx_ctrl_queue_flush(internals, slave_id);
+
 		SM_FLAG_CLR(port, BEGIN);
 		show_warnings(slave_id);
 	}
@@ -923,6 +975,94 @@ bond_mode_8023ad_activate_slave(struct rte_eth_dev *bond_dev, uint8_t slave_id)
 	}
 }
 
+int
+bond_mode_8023ad_ctrl_queues_setup(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id)
+{
+	struct bond_dev_private *internals = bond_dev->data->dev_private;
+	struct port *port = &mode_8023ad_ports[slave_id];
+	struct bond_rx_queue *bd_rx_q;
+	struct rte_eth_ethertype_filter filter;
+	uint16_t rx_qid, tx_qid;
+	int errval;
+
+	if (internals->mode != BONDING_MODE_8023AD ||
+			!internals->mode4.dedicated_queues.enabled)
+		return 0;
+
+	/* Control queues follow data queues of the bonded device. Their mbufs
+	 * are taken from the pool of the first bonded RX queue. */
+	rx_qid = bond_dev->data->nb_rx_queues;
+	tx_qid = bond_dev->data->nb_tx_queues;
+	internals->mode4.dedicated_queues.rx_qid = rx_qid;
+	internals->mode4.dedicated_queues.tx_qid = tx_qid;
+
+	bd_rx_q = (struct bond_rx_queue *)bond_dev->data->rx_queues[0];
+	if (bd_rx_q == NULL)
+		return -EINVAL;
+
+	errval = rte_eth_rx_queue_setup(slave_id, rx_qid,
+			BOND_MODE_8023AX_SLAVE_CTRL_RX_DESC,
+			rte_eth_dev_socket_id(slave_id), NULL, bd_rx_q->mb_pool);
+	if (errval != 0) {
+		RTE_LOG(ERR, PMD, "Slave %u: failed to setup control RX queue %u "
+				"(%d)\n", slave_id, rx_qid, errval);
+		return errval;
+	}
+
+	errval = rte_eth_tx_queue_setup(slave_id, tx_qid,
+			BOND_MODE_8023AX_SLAVE_CTRL_TX_DESC,
+			rte_eth_dev_socket_id(slave_id), NULL);
+	if (errval != 0) {
+		RTE_LOG(ERR, PMD, "Slave %u: failed to setup control TX queue %u "
+				"(%d)\n", slave_id, tx_qid, errval);
+		return errval;
+	}
+
+	/* Without an ethertype filter slow frames keep arriving on data queues
+	 * and RX burst diverts them to state machines in software. */
+	if (rte_eth_dev_filter_supported(slave_id, RTE_ETH_FILTER_ETHERTYPE) != 0) {
+		RTE_LOG(INFO, PMD, "Slave %u: no ethertype filter, slow frames are "
+				"filtered in software\n", slave_id);
+		return 0;
+	}
+
+	memset(&filter, 0, sizeof(filter));
+	filter.ether_type = ETHER_TYPE_SLOW;
+	filter.queue = rx_qid;
+
+	errval = rte_eth_dev_filter_ctrl(slave_id, RTE_ETH_FILTER_ETHERTYPE,
+			RTE_ETH_FILTER_ADD, &filter);
+	if (errval != 0) {
+		RTE_LOG(INFO, PMD, "Slave %u: failed to add ethertype filter (%d), "
+				"slow frames are filtered in software\n", slave_id, errval);
+		return 0;
+	}
+
+	port->slow_rx_filtered = 1;
+	port->slow_rx_qid = rx_qid;
+	return 0;
+}
+
+void
+bond_mode_8023ad_ctrl_filter_remove(uint8_t slave_id)
+{
+	struct port *port = &mode_8023ad_ports[slave_id];
+	struct rte_eth_ethertype_filter filter;
+
+	if (!port->slow_rx_filtered)
+		return;
+
+	port->slow_rx_filtered = 0;
+
+	memset(&filter, 0, sizeof(filter));
+	filter.ether_type = ETHER_TYPE_SLOW;
+	filter.queue = port->slow_rx_qid;
+
+	rte_eth_dev_filter_ctrl(slave_id, RTE_ETH_FILTER_ETHERTYPE,
+			RTE_ETH_FILTER_DELETE, &filter);
+}
+
 int
 bond_mode_8023ad_deactivate_slave(struct rte_eth_dev *bond_dev,
 		uint8_t slave_id)
@@ -1214,3 +1354,37 @@ rte_eth_bond_8023ad_slave_info(uint8_t port_id, uint8_t slave_id,
 	info->agg_port_id = port->aggregator_port_id;
 	return 0;
 }
+
+static int
+bond_8023ad_dedicated_queues_set(uint8_t port_id, uint8_t enabled)
+{
+	struct rte_eth_dev *bond_dev;
+	struct bond_dev_private *internals;
+
+	if (valid_bonded_port_id(port_id) != 0 ||
+			rte_eth_bond_mode_get(port_id) != BONDING_MODE_8023AD)
+		return -EINVAL;
+
+	bond_dev = &rte_eth_devices[port_id];
+	if (bond_dev->data->dev_started) {
+		RTE_LOG(ERR, PMD, "bonded port %u must be stopped to change mode 4 "
+				"dedicated queues\n", port_id);
+		return -EINVAL;
+	}
+
+	internals = bond_dev->data->dev_private;
+	internals->mode4.dedicated_queues.enabled = enabled;
+	return 0;
+}
+
+int
+rte_eth_bond_8023ad_dedicated_queues_enable(uint8_t port_id)
+{
+	return bond_8023ad_dedicated_queues_set(port_id, 1);
+}
+
+int
+rte_eth_bond_8023ad_dedicated_queues_disable(uint8_t port_id)
+{
+	return bond_8023ad_dedicated_queues_set(port_id, 0);
+}
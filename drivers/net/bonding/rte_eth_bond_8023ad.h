@@ -215,6 +215,42 @@ int
 rte_eth_bond_8023ad_slave_info(uint8_t port_id, uint8_t slave_id,
 		struct rte_eth_bond_8023ad_slave_info *conf);
 
+/**
+ * Reserve one extra RX and TX queue on every slave for slow protocol frames.
+ *
+ * Control queues get the ids following the data queues of the bonded device.
+ * Where the slave supports an ethertype filter LACP and marker frames are
+ * steered to the control RX queue and RX burst no longer inspects the
+ * ethertype of received packets; other slaves fall back to software
+ * filtering on their data queues. LACPDUs and marker responses are always
+ * sent through the control TX queue, so TX burst does not carry them. Both
+ * control queues are served from the mode 4 periodic callback.
+ *
+ * @pre Bonded device must be in mode 4 and stopped. Slaves must support
+ * one RX and TX queue more than the bonded device is configured with.
+ *
+ * @param port_id	Bonding device id
+ *
+ * @return
+ *   0 on success, -EINVAL if device is not a stopped mode 4 bonded device.
+ */
+int
+rte_eth_bond_8023ad_dedicated_queues_enable(uint8_t port_id);
+
+/**
+ * Stop using dedicated control queues, slow protocol frames are passed
+ * through data queues again.
+ *
+ * @pre Bonded device must be in mode 4 and stopped.
+ *
+ * @param port_id	Bonding device id
+ *
+ * @return
+ *   0 on success, -EINVAL if device is not a stopped mode 4 bonded device.
+ */
+int
+rte_eth_bond_8023ad_dedicated_queues_disable(uint8_t port_id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,12 @@
 #define BOND_MODE_8023AX_SLAVE_RX_PKTS        3
 /** Maximum number of LACP packets from one slave queued in TX ring. */
 #define BOND_MODE_8023AX_SLAVE_TX_PKTS        1
+/** Number of descriptors of the per-slave control RX queue. */
+#define BOND_MODE_8023AX_SLAVE_CTRL_RX_DESC   128
+/** Number of descriptors of the per-slave control TX queue. */
+#define BOND_MODE_8023AX_SLAVE_CTRL_TX_DESC   128
+/** Maximum number of slow packets read from control RX queue per update. */
+#define BOND_MODE_8023AX_SLAVE_CTRL_RX_BURST  8
 /**
  * Timeouts deffinitions (5.4.4 in 802.1AX documentation).
  */
@@ -162,6 +168,12 @@ struct port {
 
 	uint64_t warning_timer;
 	volatile uint16_t warnings_to_show;
+
+	/** Slow protocol frames of this port are steered by hardware to its
+	 * control RX queue, so RX burst does not need to look for them. */
+	uint8_t slow_rx_filtered;
+	/** Control RX queue the filter steers slow protocol frames to */
+	uint16_t slow_rx_qid;
 };
 
 struct mode8023ad_private {
@@ -173,6 +185,13 @@ struct mode8023ad_private {
 	uint64_t tx_period_timeout;
 	uint64_t rx_marker_timeout;
 	uint64_t update_timeout_us;
+
+	/** Per-slave queues reserved for slow protocol frames */
+	struct {
+		uint8_t enabled;
+		uint16_t rx_qid;	/**< Control RX queue id on each slave */
+		uint16_t tx_qid;	/**< Control TX queue id on each slave */
+	} dedicated_queues;
 };
 
 /**
@@ -298,6 +317,33 @@ bond_mode_8023ad_activate_slave(struct rte_eth_dev *dev, uint8_t port_id);
 int
 bond_mode_8023ad_deactivate_slave(struct rte_eth_dev *dev, uint8_t slave_pos);
 
+/**
+ * @internal
+ *
+ * Sets up control RX/TX queues of given slave and steers slow protocol frames
+ * to the RX one. Must be called after data queues of the slave are set up and
+ * before it is started.
+ *
+ * @param bond_dev  Bonded interface.
+ * @param slave_id  Slave port ID.
+ *
+ * @return
+ *  0 on success, negative value otherwise.
+ */
+int
+bond_mode_8023ad_ctrl_queues_setup(struct rte_eth_dev *bond_dev,
+		uint8_t slave_id);
+
+/**
+ * @internal
+ *
+ * Removes slow protocol filter from given slave if one was installed.
+ *
+ * @param slave_id  Slave port ID.
+ */
+void
+bond_mode_8023ad_ctrl_filter_remove(uint8_t slave_id);
+
 /**
  * Updates state when MAC was changed on bonded device or one of its slaves.
  * @param bond_dev Bonded device
@@ -136,8 +136,10 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	uint16_t num_rx_total = 0;	/* Total number of received packets */
 	uint8_t slaves[RTE_MAX_ETHPORTS];
 	uint8_t slave_count;
+	struct port *port;
 
 	uint8_t collecting;  /* current slave collecting status */
+	uint8_t slow_filtered;  /* slow packets steered away by hardware */
 	const uint8_t promisc = internals->promiscuous_en;
 	uint8_t i, j, k;
 
@@ -150,12 +152,18 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 
 	for (i = 0; i < slave_count && num_rx_total < nb_pkts; i++) {
 		j = num_rx_total;
-		collecting = ACTOR_STATE(&mode_8023ad_ports[slaves[i]], COLLECTING);
+		port = &mode_8023ad_ports[slaves[i]];
+		collecting = ACTOR_STATE(port, COLLECTING);
+		slow_filtered = port->slow_rx_filtered;
 
 		/* Read packets from this slave */
 		num_rx_total += rte_eth_rx_burst(slaves[i], bd_rx_q->queue_id,
 				&bufs[num_rx_total], nb_pkts - num_rx_total);
 
+		/* Nothing to drop if slow packets go to the control queue */
+		if (slow_filtered && collecting && promisc)
+			continue;
+
 		for (k = j; k < 2 && k < num_rx_total; k++)
 			rte_prefetch0(rte_pktmbuf_mtod(bufs[k], void *));
 
@@ -168,11 +176,13 @@ bond_ethdev_rx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 			/* Remove packet from array if it is slow packet or slave is not
 			 * in collecting state or bondign interface is not in promiscus
 			 * mode and packet address does not match. */
-			if (unlikely(hdr->ether_type == ether_type_slow_be ||
+			if (unlikely((!slow_filtered &&
+					hdr->ether_type == ether_type_slow_be) ||
 				!collecting || (!promisc &&
 					!is_same_ether_addr(&bond_mac, &hdr->d_addr)))) {
 
-				if (hdr->ether_type == ether_type_slow_be) {
+				if (!slow_filtered &&
+						hdr->ether_type == ether_type_slow_be) {
 					bond_mode_8023ad_handle_slow_pkt(internals, slaves[i],
 						bufs[j]);
 				} else
@@ -496,18 +506,24 @@ ipv6_hash(struct ipv6_hdr *ipv6_hdr)
 			(word_src_addr[3] ^ word_dst_addr[3]);
 }
 
-uint16_t
-xmit_l2_hash(const struct rte_mbuf *buf, uint8_t slave_count)
+/*
+ * Packets ahead in the burst whose headers are prefetched while the hash of
+ * the current one is computed.
+ */
+#define BOND_XMIT_HASH_PREFETCH_OFFSET 3
+
+static inline uint32_t
+l2_hash(const struct rte_mbuf *buf)
 {
 	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
 
 	uint32_t hash = ether_hash(eth_hdr);
 
-	return (hash ^= hash >> 8) % slave_count;
+	return hash ^= hash >> 8;
 }
 
-uint16_t
-xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count)
+static inline uint32_t
+l23_hash(const struct rte_mbuf *buf)
 {
 	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
 	uint16_t proto = eth_hdr->ether_type;
@@ -531,11 +547,11 @@ xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count)
 	hash ^= hash >> 16;
 	hash ^= hash >> 8;
 
-	return hash % slave_count;
+	return hash;
 }
 
-uint16_t
-xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count)
+static inline uint32_t
+l34_hash(const struct rte_mbuf *buf)
 {
 	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(buf, struct ether_hdr *);
 	uint16_t proto = eth_hdr->ether_type;
@@ -582,7 +598,66 @@ xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count)
 	hash ^= hash >> 16;
 	hash ^= hash >> 8;
 
-	return hash % slave_count;
+	return hash;
+}
+
+/*
+ * Compute the output slave of each packet of a burst with the hash function
+ * of a policy, prefetching the headers of the next packets, and without a
+ * division per packet.
+ */
+static inline void __attribute__((always_inline))
+burst_xmit_hash(struct rte_mbuf **buf, uint16_t nb_pkts, uint8_t slave_count,
+		uint16_t *slaves, uint32_t (*hash)(const struct rte_mbuf *))
+{
+	struct bond_reciprocal r = bond_reciprocal_value(slave_count);
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (i + BOND_XMIT_HASH_PREFETCH_OFFSET < nb_pkts)
+			rte_prefetch0(rte_pktmbuf_mtod(
+				buf[i + BOND_XMIT_HASH_PREFETCH_OFFSET], void *));
+		slaves[i] = bond_reciprocal_mod(hash(buf[i]), &r);
+	}
+}
+
+void
+burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	burst_xmit_hash(buf, nb_pkts, slave_count, slaves, l2_hash);
+}
+
+void
+burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	burst_xmit_hash(buf, nb_pkts, slave_count, slaves, l23_hash);
+}
+
+/*
+ * The RSS hash of a received packet, when there is one, is already a hash
+ * of its IP addresses and L4 ports.
+ */
+static inline uint32_t
+l34_or_rss_hash(const struct rte_mbuf *buf)
+{
+	uint32_t hash;
+
+	if (!(buf->ol_flags & PKT_RX_RSS_HASH))
+		return l34_hash(buf);
+
+	hash = buf->hash.rss;
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+	return hash;
+}
+
+void
+burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves)
+{
+	burst_xmit_hash(buf, nb_pkts, slave_count, slaves, l34_or_rss_hash);
 }
 
 struct bwg_slave {
@@ -905,6 +980,7 @@ bond_ethdev_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
 
 	struct rte_mbuf *slave_bufs[RTE_MAX_ETHPORTS][nb_pkts];
 	uint16_t slave_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
+	uint16_t bufs_slave[nb_pkts];
 
 	bd_tx_q = (struct bond_tx_queue *)queue;
 	internals = bd_tx_q->dev_private;
@@ -918,10 +994,21 @@ bond_ethdev_tx_burst_balance(void *queue, struct rte_mbuf **bufs,
 	if (num_of_slaves < 1)
 		return num_tx_total;
 
+	/* Select output slaves using hash based on xmit policy */
+	internals->xmit_hash(bufs, nb_pkts, num_of_slaves, bufs_slave);
+
 	/* Populate slaves mbuf with the packets which are to be sent on it  */
 	for (i = 0; i < nb_pkts; i++) {
-		/* Select output slave using hash based on xmit policy */
-		op_slave_id = internals->xmit_hash(bufs[i], num_of_slaves);
+		op_slave_id = bufs_slave[i];
+
+		/* A user-defined policy may return any value, drop the packet
+		 * rather than index past the active slaves */
+		if (unlikely(op_slave_id >= num_of_slaves)) {
+			rte_pktmbuf_free(bufs[i]);
+			bd_tx_q->xmit_hash_drops++;
+			num_tx_total++;
+			continue;
+		}
 
 		/* Populate slave mbuf arrays with mbufs for that slave */
 		slave_bufs[op_slave_id][slave_nb_pkts[op_slave_id]++] = bufs[i];
@@ -975,9 +1062,12 @@ bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	uint16_t slave_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
 	/* Slow packets placed in each slave */
 	uint8_t slave_slow_nb_pkts[RTE_MAX_ETHPORTS] = { 0 };
+	uint16_t bufs_slave[nb_pkts];
+	uint8_t dedicated_txq;
 
 	bd_tx_q = (struct bond_tx_queue *)queue;
 	internals = bd_tx_q->dev_private;
+	dedicated_txq = internals->mode4.dedicated_queues.enabled;
 
 	/* Copy slave list to protect against slave up/down changes during tx
 	 * bursting */
@@ -991,22 +1081,37 @@ bond_ethdev_tx_burst_8023ad(void *queue, struct rte_mbuf **bufs,
 	for (i = 0; i < num_of_slaves; i++) {
 		struct port *port = &mode_8023ad_ports[slaves[i]];
 
-		slave_slow_nb_pkts[i] = rte_ring_dequeue_burst(port->tx_ring,
-				slow_pkts, BOND_MODE_8023AX_SLAVE_TX_PKTS);
-		slave_nb_pkts[i] = slave_slow_nb_pkts[i];
+		/* Slow packets are sent through control queue by mode 4 callback */
+		if (!dedicated_txq) {
+			slave_slow_nb_pkts[i] = rte_ring_dequeue_burst(port->tx_ring,
+					slow_pkts, BOND_MODE_8023AX_SLAVE_TX_PKTS);
+			slave_nb_pkts[i] = slave_slow_nb_pkts[i];
 
-		for (j = 0; j < slave_slow_nb_pkts[i]; j++)
-			slave_bufs[i][j] = slow_pkts[j];
+			for (j = 0; j < slave_slow_nb_pkts[i]; j++)
+				slave_bufs[i][j] = slow_pkts[j];
+		}
 
 		if (ACTOR_STATE(port, DISTRIBUTING))
 			distributing_offsets[distributing_count++] = i;
 	}
 
 	if (likely(distributing_count > 0)) {
+		/* Select output slaves using hash based on xmit policy */
+		internals->xmit_hash(bufs, nb_pkts, distributing_count,
+				bufs_slave);
+
 		/* Populate slaves mbuf with the packets which are to be sent on it */
 		for (i = 0; i < nb_pkts; i++) {
-			/* Select output slave using hash based on xmit policy */
-			op_slave_idx = internals->xmit_hash(bufs[i], distributing_count);
+			op_slave_idx = bufs_slave[i];
+
+			/* A user-defined policy may return any value, drop the
+			 * packet rather than index past the distributing slaves */
+			if (unlikely(op_slave_idx >= distributing_count)) {
+				rte_pktmbuf_free(bufs[i]);
+				bd_tx_q->xmit_hash_drops++;
+				num_tx_total++;
+				continue;
+			}
 
 			/* Populate slave mbuf arrays with mbufs for that slave. Use only
 			 * slaves that are currently distributing. */
@@ -1297,8 +1402,10 @@ int
 slave_configure(struct rte_eth_dev *bonded_eth_dev,
 		struct rte_eth_dev *slave_eth_dev)
 {
+	struct bond_dev_private *internals = bonded_eth_dev->data->dev_private;
 	struct bond_rx_queue *bd_rx_q;
 	struct bond_tx_queue *bd_tx_q;
+	uint16_t nb_rx_queues, nb_tx_queues;
 
 	int errval;
 	uint16_t q_id;
@@ -1306,14 +1413,26 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 	/* Stop slave */
 	rte_eth_dev_stop(slave_eth_dev->data->port_id);
 
+	/* Drop slow protocol steering left from previous configuration */
+	bond_mode_8023ad_ctrl_filter_remove(slave_eth_dev->data->port_id);
+
+	nb_rx_queues = bonded_eth_dev->data->nb_rx_queues;
+	nb_tx_queues = bonded_eth_dev->data->nb_tx_queues;
+
+	/* Reserve control queues for slow protocol frames */
+	if (internals->mode == BONDING_MODE_8023AD &&
+			internals->mode4.dedicated_queues.enabled) {
+		nb_rx_queues++;
+		nb_tx_queues++;
+	}
+
 	/* Enable interrupts on slave device if supported */
 	if (slave_eth_dev->driver->pci_drv.drv_flags & RTE_PCI_DRV_INTR_LSC)
 		slave_eth_dev->data->dev_conf.intr_conf.lsc = 1;
 
 	/* Configure device */
 	errval = rte_eth_dev_configure(slave_eth_dev->data->port_id,
-			bonded_eth_dev->data->nb_rx_queues,
-			bonded_eth_dev->data->nb_tx_queues,
+			nb_rx_queues, nb_tx_queues,
 			&(slave_eth_dev->data->dev_conf));
 	if (errval != 0) {
 		RTE_BOND_LOG(ERR, "Cannot configure slave device: port %u , err (%d)",
@@ -1353,6 +1472,11 @@ slave_configure(struct rte_eth_dev *bonded_eth_dev,
 		}
 	}
 
+	errval = bond_mode_8023ad_ctrl_queues_setup(bonded_eth_dev,
+			slave_eth_dev->data->port_id);
+	if (errval != 0)
+		return errval;
+
 	/* Start device */
 	errval = rte_eth_dev_start(slave_eth_dev->data->port_id);
 	if (errval != 0) {
@@ -1375,6 +1499,8 @@ slave_remove(struct bond_dev_private *internals,
 {
 	uint8_t i;
 
+	bond_mode_8023ad_ctrl_filter_remove(slave_eth_dev->data->port_id);
+
 	for (i = 0; i < internals->slave_count; i++)
 		if (internals->slaves[i].port_id ==
 				slave_eth_dev->data->port_id)
@@ -1777,6 +1903,13 @@ bond_ethdev_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 		stats->tx_pause_xoff += slave_stats.tx_pause_xoff;
 		stats->rx_pause_xoff += slave_stats.rx_pause_xoff;
 	}
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct bond_tx_queue *bd_tx_q = dev->data->tx_queues[i];
+
+		if (bd_tx_q != NULL)
+			stats->oerrors += bd_tx_q->xmit_hash_drops;
+	}
 }
 
 static void
@@ -1787,6 +1920,13 @@ bond_ethdev_stats_reset(struct rte_eth_dev *dev)
 
 	for (i = 0; i < internals->slave_count; i++)
 		rte_eth_stats_reset(internals->slaves[i].port_id);
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct bond_tx_queue *bd_tx_q = dev->data->tx_queues[i];
+
+		if (bd_tx_q != NULL)
+			bd_tx_q->xmit_hash_drops = 0;
+	}
 }
 
 static void
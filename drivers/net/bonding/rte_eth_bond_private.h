@@ -87,6 +87,8 @@ struct bond_tx_queue {
 	/**< Number of TX descriptors available for the queue */
 	struct rte_eth_txconf tx_conf;
 	/**< Copy of TX configuration structure for queue */
+	uint64_t xmit_hash_drops;
+	/**< Packets dropped because the xmit policy returned an invalid slave */
 };
 
 /** Bonded slave devices structure */
@@ -106,7 +108,39 @@ struct bond_slave_details {
 };
 
 
-typedef uint16_t (*xmit_hash_t)(const struct rte_mbuf *buf, uint8_t slave_count);
+/**
+ * Reciprocal of a slave count, to compute hash % slave_count with a
+ * multiplication and shifts (see Granlund and Montgomery, "Division by
+ * Invariant Integers using Multiplication").
+ */
+struct bond_reciprocal {
+	uint32_t m;
+	uint8_t sh1;
+	uint8_t sh2;
+	uint8_t d;
+};
+
+static inline struct bond_reciprocal
+bond_reciprocal_value(uint8_t d)
+{
+	struct bond_reciprocal r;
+	uint8_t l = d > 1 ? 32 - __builtin_clz(d - 1) : 0;
+
+	r.m = (uint32_t)((((1ULL << l) - d) << 32) / d + 1);
+	r.sh1 = RTE_MIN(l, 1);
+	r.sh2 = l > 1 ? l - 1 : 0;
+	r.d = d;
+	return r;
+}
+
+static inline uint16_t
+bond_reciprocal_mod(uint32_t a, const struct bond_reciprocal *r)
+{
+	uint32_t t = (uint32_t)(((uint64_t)a * r->m) >> 32);
+	uint32_t q = (t + ((a - t) >> r->sh1)) >> r->sh2;
+
+	return a - q * r->d;
+}
 
 /** Link Bonding PMD device private configuration Structure */
 struct bond_dev_private {
@@ -122,7 +156,7 @@ struct bond_dev_private {
 
 	uint8_t balance_xmit_policy;
 	/**< Transmit policy - l2 / l23 / l34 for operation in balance mode */
-	xmit_hash_t xmit_hash;
+	rte_eth_bond_xmit_hash_t xmit_hash;
 	/**< Transmit policy hash function */
 
 	uint8_t user_defined_mac;
@@ -230,14 +264,17 @@ void
 slave_add(struct bond_dev_private *internals,
 		struct rte_eth_dev *slave_eth_dev);
 
-uint16_t
-xmit_l2_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l2_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
-uint16_t
-xmit_l23_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l23_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
-uint16_t
-xmit_l34_hash(const struct rte_mbuf *buf, uint8_t slave_count);
+void
+burst_xmit_l34_hash(struct rte_mbuf **buf, uint16_t nb_pkts,
+		uint8_t slave_count, uint16_t *slaves);
 
 void
 bond_ethdev_primary_set(struct bond_dev_private *internals,
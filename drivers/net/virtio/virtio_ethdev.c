@@ -63,8 +63,6 @@
 #include "virtqueue.h"
 
 
-static int eth_virtio_dev_init(struct rte_eth_dev *eth_dev);
-static int eth_virtio_dev_uninit(struct rte_eth_dev *eth_dev);
 static int  virtio_dev_configure(struct rte_eth_dev *dev);
 static int  virtio_dev_start(struct rte_eth_dev *dev);
 static void virtio_dev_stop(struct rte_eth_dev *dev);
@@ -145,14 +143,14 @@ virtio_send_command(struct virtqueue *vq, struct virtio_pmd_ctrl *ctrl,
 	 * One RX packet for ACK.
 	 */
 	vq->vq_ring.desc[head].flags = VRING_DESC_F_NEXT;
-	vq->vq_ring.desc[head].addr = vq->virtio_net_hdr_mz->phys_addr;
+	vq->vq_ring.desc[head].addr = vq->virtio_net_hdr_mem;
 	vq->vq_ring.desc[head].len = sizeof(struct virtio_net_ctrl_hdr);
 	vq->vq_free_cnt--;
 	i = vq->vq_ring.desc[head].next;
 
 	for (k = 0; k < pkt_num; k++) {
 		vq->vq_ring.desc[i].flags = VRING_DESC_F_NEXT;
-		vq->vq_ring.desc[i].addr = vq->virtio_net_hdr_mz->phys_addr
+		vq->vq_ring.desc[i].addr = vq->virtio_net_hdr_mem
 			+ sizeof(struct virtio_net_ctrl_hdr)
 			+ sizeof(ctrl->status) + sizeof(uint8_t)*sum;
 		vq->vq_ring.desc[i].len = dlen[k];
@@ -162,7 +160,7 @@ virtio_send_command(struct virtqueue *vq, struct virtio_pmd_ctrl *ctrl,
 	}
 
 	vq->vq_ring.desc[i].flags = VRING_DESC_F_WRITE;
-	vq->vq_ring.desc[i].addr = vq->virtio_net_hdr_mz->phys_addr
+	vq->vq_ring.desc[i].addr = vq->virtio_net_hdr_mem
 			+ sizeof(struct virtio_net_ctrl_hdr);
 	vq->vq_ring.desc[i].len = sizeof(ctrl->status);
 	vq->vq_free_cnt--;
@@ -237,14 +235,22 @@ virtio_set_multiple_queues(struct rte_eth_dev *dev, uint16_t nb_queues)
 	return 0;
 }
 
+/*
+ * Address under which the device sees a memzone: physical for a PCI
+ * device, virtual for a virtio-user one.
+ */
+static phys_addr_t
+virtio_memzone_addr(struct virtio_hw *hw, const struct rte_memzone *mz)
+{
+	if (hw->virtio_user_dev != NULL)
+		return (phys_addr_t)(uintptr_t)mz->addr;
+	return mz->phys_addr;
+}
+
 void
 virtio_dev_queue_release(struct virtqueue *vq) {
-	struct virtio_hw *hw = vq->hw;
-
 	if (vq) {
-		/* Select and deactivate the queue */
-		VIRTIO_WRITE_REG_2(hw, VIRTIO_PCI_QUEUE_SEL, vq->queue_id);
-		VIRTIO_WRITE_REG_4(hw, VIRTIO_PCI_QUEUE_PFN, 0);
+		vq->hw->vtpci_ops->del_queue(vq->hw, vq);
 
 		rte_free(vq);
 		vq = NULL;
@@ -266,15 +272,13 @@ int virtio_dev_queue_setup(struct rte_eth_dev *dev,
 	struct virtio_hw *hw = dev->data->dev_private;
 	struct virtqueue *vq = NULL;
 
-	/* Write the virtqueue index to the Queue Select Field */
-	VIRTIO_WRITE_REG_2(hw, VIRTIO_PCI_QUEUE_SEL, vtpci_queue_idx);
 	PMD_INIT_LOG(DEBUG, "selecting queue: %d", vtpci_queue_idx);
 
 	/*
 	 * Read the virtqueue size from the Queue Size field
 	 * Always power of 2 and if 0 virtqueue does not exist
 	 */
-	vq_size = VIRTIO_READ_REG_2(hw, VIRTIO_PCI_QUEUE_NUM);
+	vq_size = hw->vtpci_ops->get_queue_num(hw, vtpci_queue_idx);
 	PMD_INIT_LOG(DEBUG, "vq_size: %d nb_desc:%d", vq_size, nb_desc);
 	if (vq_size == 0) {
 		PMD_INIT_LOG(ERR, "%s: virtqueue does not exist", __func__);
@@ -341,7 +345,8 @@ int virtio_dev_queue_setup(struct rte_eth_dev *dev,
 	 * and only accepts 32 bit page frame number.
 	 * Check if the allocated physical memory exceeds 16TB.
 	 */
-	if ((mz->phys_addr + vq->vq_ring_size - 1) >> (VIRTIO_PCI_QUEUE_ADDR_SHIFT + 32)) {
+	if (hw->virtio_user_dev == NULL &&
+	    (mz->phys_addr + vq->vq_ring_size - 1) >> (VIRTIO_PCI_QUEUE_ADDR_SHIFT + 32)) {
 		PMD_INIT_LOG(ERR, "vring address shouldn't be above 16TB!");
 		rte_free(vq);
 		return -ENOMEM;
@@ -349,9 +354,9 @@ int virtio_dev_queue_setup(struct rte_eth_dev *dev,
 
 	memset(mz->addr, 0, sizeof(mz->len));
 	vq->mz = mz;
-	vq->vq_ring_mem = mz->phys_addr;
+	vq->vq_ring_mem = virtio_memzone_addr(hw, mz);
 	vq->vq_ring_virt_mem = mz->addr;
-	PMD_INIT_LOG(DEBUG, "vq->vq_ring_mem:      0x%"PRIx64, (uint64_t)mz->phys_addr);
+	PMD_INIT_LOG(DEBUG, "vq->vq_ring_mem:      0x%"PRIx64, (uint64_t)vq->vq_ring_mem);
 	PMD_INIT_LOG(DEBUG, "vq->vq_ring_virt_mem: 0x%"PRIx64, (uint64_t)(uintptr_t)mz->addr);
 	vq->virtio_net_hdr_mz  = NULL;
 	vq->virtio_net_hdr_mem = 0;
@@ -375,7 +380,7 @@ int virtio_dev_queue_setup(struct rte_eth_dev *dev,
 			}
 		}
 		vq->virtio_net_hdr_mem =
-			vq->virtio_net_hdr_mz->phys_addr;
+			virtio_memzone_addr(hw, vq->virtio_net_hdr_mz);
 		memset(vq->virtio_net_hdr_mz->addr, 0,
 			vq_size * hw->vtnet_hdr_size);
 	} else if (queue_type == VTNET_CQ) {
@@ -394,16 +399,11 @@ int virtio_dev_queue_setup(struct rte_eth_dev *dev,
 			}
 		}
 		vq->virtio_net_hdr_mem =
-			vq->virtio_net_hdr_mz->phys_addr;
+			virtio_memzone_addr(hw, vq->virtio_net_hdr_mz);
 		memset(vq->virtio_net_hdr_mz->addr, 0, PAGE_SIZE);
 	}
 
-	/*
-	 * Set guest physical address of the virtqueue
-	 * in VIRTIO_PCI_QUEUE_PFN config register of device
-	 */
-	VIRTIO_WRITE_REG_4(hw, VIRTIO_PCI_QUEUE_PFN,
-			mz->phys_addr >> VIRTIO_PCI_QUEUE_ADDR_SHIFT);
+	hw->vtpci_ops->setup_queue(hw, vq);
 	*pvq = vq;
 	return 0;
 }
@@ -838,27 +838,79 @@ virtio_vlan_filter_set(struct rte_eth_dev *dev, uint16_t vlan_id, int on)
 }
 
 static void
-virtio_negotiate_features(struct virtio_hw *hw)
+virtio_negotiate_features(struct virtio_hw *hw, uint64_t req_features)
 {
-	uint32_t host_features;
+	uint64_t host_features;
 
 	/* Prepare guest_features: feature that driver wants to support */
-	hw->guest_features = VIRTIO_PMD_GUEST_FEATURES;
-	PMD_INIT_LOG(DEBUG, "guest_features before negotiate = %x",
+	hw->req_guest_features = req_features;
+	hw->guest_features = req_features;
+	PMD_INIT_LOG(DEBUG, "guest_features before negotiate = %" PRIx64,
 		hw->guest_features);
 
 	/* Read device(host) feature bits */
-	host_features = VIRTIO_READ_REG_4(hw, VIRTIO_PCI_HOST_FEATURES);
-	PMD_INIT_LOG(DEBUG, "host_features before negotiate = %x",
+	host_features = hw->vtpci_ops->get_features(hw);
+	hw->host_features = host_features;
+	PMD_INIT_LOG(DEBUG, "host_features before negotiate = %" PRIx64,
 		host_features);
 
+	/*
+	 * Segmentation offloads depend on checksum offload, and large
+	 * received frames need mergeable RX buffers to fit in our mbufs.
+	 */
+	if (!(host_features & (1u << VIRTIO_NET_F_CSUM)))
+		hw->guest_features &= ~(1ULL << VIRTIO_NET_F_HOST_TSO4 |
+					1ULL << VIRTIO_NET_F_HOST_TSO6);
+	if (!(host_features & (1u << VIRTIO_NET_F_GUEST_CSUM)) ||
+	    !(host_features & (1u << VIRTIO_NET_F_MRG_RXBUF)))
+		hw->guest_features &= ~VTNET_LRO_FEATURES;
+
+	/*
+	 * The control queue only knows the split layout, and in-order use
+	 * of the buffers is implied by the packed one, which already
+	 * returns them in ring order.
+	 */
+	if (host_features & (1u << VIRTIO_NET_F_CTRL_VQ))
+		hw->guest_features &= ~(1ULL << VIRTIO_F_RING_PACKED);
+	if (host_features & hw->guest_features &
+	    (1ULL << VIRTIO_F_RING_PACKED))
+		hw->guest_features &= ~(1ULL << VIRTIO_F_IN_ORDER);
+
 	/*
 	 * Negotiate features: Subset of device feature bits are written back
 	 * guest feature bits.
 	 */
 	hw->guest_features = vtpci_negotiate_features(hw, host_features);
-	PMD_INIT_LOG(DEBUG, "features after negotiate = %x",
+	PMD_INIT_LOG(DEBUG, "features after negotiate = %" PRIx64,
 		hw->guest_features);
+
+	hw->has_tx_offload = !!(hw->guest_features &
+		(1u << VIRTIO_NET_F_CSUM | 1u << VIRTIO_NET_F_HOST_TSO4 |
+		 1u << VIRTIO_NET_F_HOST_TSO6));
+	hw->has_rx_offload = !!(hw->guest_features &
+		(1u << VIRTIO_NET_F_GUEST_CSUM | VTNET_LRO_FEATURES));
+}
+
+/*
+ * Negotiate a new set of features. A legacy device only takes them after
+ * a reset, which also makes it forget the queues: the mbufs they hold are
+ * dropped and the next start sets them up again.
+ */
+static void
+virtio_renegotiate_features(struct rte_eth_dev *dev, uint64_t req_features)
+{
+	struct virtio_hw *hw = dev->data->dev_private;
+
+	if (hw->started) {
+		virtio_dev_free_mbufs(dev);
+		hw->started = 0;
+	}
+
+	vtpci_reset(hw);
+	vtpci_set_status(hw, VIRTIO_CONFIG_STATUS_ACK);
+	vtpci_set_status(hw, VIRTIO_CONFIG_STATUS_DRIVER);
+	virtio_negotiate_features(hw, req_features);
+	virtio_dev_cq_start(dev);
 }
 
 #ifdef RTE_EXEC_ENV_LINUXAPP
@@ -1146,17 +1198,45 @@ static void
 rx_func_get(struct rte_eth_dev *eth_dev)
 {
 	struct virtio_hw *hw = eth_dev->data->dev_private;
-	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF))
+#ifdef RTE_VIRTIO_INC_VECTOR
+	if (hw->use_simple_rx)
+		eth_dev->rx_pkt_burst = &virtio_recv_pkts_vec;
+	else
+#endif
+	if (vtpci_packed_queue(hw)) {
+		if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF))
+			eth_dev->rx_pkt_burst =
+				&virtio_recv_mergeable_pkts_packed;
+		else
+			eth_dev->rx_pkt_burst = &virtio_recv_pkts_packed;
+	} else if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF))
 		eth_dev->rx_pkt_burst = &virtio_recv_mergeable_pkts;
 	else
 		eth_dev->rx_pkt_burst = &virtio_recv_pkts;
 }
 
+static void
+tx_func_get(struct rte_eth_dev *eth_dev)
+{
+	struct virtio_hw *hw = eth_dev->data->dev_private;
+
+#ifdef RTE_VIRTIO_INC_VECTOR
+	if (hw->use_simple_tx) {
+		eth_dev->tx_pkt_burst = &virtio_xmit_pkts_simple;
+		return;
+	}
+#endif
+	if (vtpci_packed_queue(hw))
+		eth_dev->tx_pkt_burst = &virtio_xmit_pkts_packed;
+	else
+		eth_dev->tx_pkt_burst = &virtio_xmit_pkts;
+}
+
 /*
  * This function is based on probe() function in virtio_pci.c
  * It returns 0 on success.
  */
-static int
+int
 eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 {
 	struct virtio_hw *hw = eth_dev->data->dev_private;
@@ -1168,7 +1248,7 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 	RTE_BUILD_BUG_ON(RTE_PKTMBUF_HEADROOM < sizeof(struct virtio_net_hdr));
 
 	eth_dev->dev_ops = &virtio_eth_dev_ops;
-	eth_dev->tx_pkt_burst = &virtio_xmit_pkts;
+	tx_func_get(eth_dev);
 
 	if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
 		rx_func_get(eth_dev);
@@ -1185,11 +1265,15 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 	}
 
 	pci_dev = eth_dev->pci_dev;
-	if (virtio_resource_init(pci_dev) < 0)
-		return -1;
+	/* A virtio-user port comes with its transport already set up */
+	if (hw->virtio_user_dev == NULL) {
+		if (virtio_resource_init(pci_dev) < 0)
+			return -1;
 
-	hw->use_msix = virtio_has_msix(&pci_dev->addr);
-	hw->io_base = (uint32_t)(uintptr_t)pci_dev->mem_resource[0].addr;
+		hw->use_msix = virtio_has_msix(&pci_dev->addr);
+		hw->io_base = (uint32_t)(uintptr_t)pci_dev->mem_resource[0].addr;
+		hw->vtpci_ops = &legacy_ops;
+	}
 
 	/* Reset the device although not necessary at startup */
 	vtpci_reset(hw);
@@ -1199,7 +1283,7 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 
 	/* Tell the host we've known how to drive the device. */
 	vtpci_set_status(hw, VIRTIO_CONFIG_STATUS_DRIVER);
-	virtio_negotiate_features(hw);
+	virtio_negotiate_features(hw, VIRTIO_PMD_GUEST_FEATURES);
 
 	rx_func_get(eth_dev);
 
@@ -1282,7 +1366,7 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 	return 0;
 }
 
-static int
+int
 eth_virtio_dev_uninit(struct rte_eth_dev *eth_dev)
 {
 	struct rte_pci_device *pci_dev;
@@ -1359,16 +1443,50 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 	const struct rte_eth_rxmode *rxmode = &dev->data->dev_conf.rxmode;
 	struct virtio_hw *hw = dev->data->dev_private;
 	struct rte_pci_device *pci_dev = dev->pci_dev;
+	uint64_t req_features = VIRTIO_PMD_GUEST_FEATURES;
 
 	PMD_INIT_LOG(DEBUG, "configure");
 
-	if (rxmode->hw_ip_checksum) {
-		PMD_DRV_LOG(ERR, "HW IP checksum not supported");
-		return (-EINVAL);
+	/*
+	 * Only let the host send partial checksums and TSO frames if the
+	 * application asked for them, the RX path then has more to do.
+	 */
+	if (rxmode->hw_ip_checksum || rxmode->enable_lro)
+		req_features |= 1ULL << VIRTIO_NET_F_GUEST_CSUM;
+	if (rxmode->enable_lro)
+		req_features |= VTNET_LRO_FEATURES;
+	if (req_features != hw->req_guest_features)
+		virtio_renegotiate_features(dev, req_features);
+
+	if (rxmode->hw_ip_checksum &&
+	    !vtpci_with_feature(hw, VIRTIO_NET_F_GUEST_CSUM)) {
+		PMD_DRV_LOG(NOTICE,
+			    "RX checksum offload not available on this host");
+		return -ENOTSUP;
 	}
 
 	hw->vlan_strip = rxmode->hw_vlan_strip;
 
+	/*
+	 * The simple RX path hands buffers over untouched: no merged
+	 * buffers, no checksum to complete and no tag to strip. Go by what
+	 * the application asked for, the guest offloads follow from it.
+	 * TX queue setup turns the simple TX path back off if a queue needs
+	 * it. Both only know the split ring layout.
+	 */
+#ifdef RTE_VIRTIO_INC_VECTOR
+	hw->use_simple_rx = !vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF) &&
+		!rxmode->hw_ip_checksum && !rxmode->enable_lro &&
+		!hw->vlan_strip && !vtpci_packed_queue(hw);
+	hw->use_simple_tx = !vtpci_packed_queue(hw);
+#endif
+
+	if (rxmode->enable_lro &&
+	    (hw->guest_features & VTNET_LRO_FEATURES) == 0) {
+		PMD_DRV_LOG(NOTICE, "LRO not available on this host");
+		return -ENOTSUP;
+	}
+
 	if (rxmode->hw_vlan_filter
 	    && !vtpci_with_feature(hw, VIRTIO_NET_F_CTRL_VLAN)) {
 		PMD_DRV_LOG(NOTICE,
@@ -1415,8 +1533,17 @@ virtio_dev_start(struct rte_eth_dev *dev)
 		return 0;
 
 	/* Do final configuration before rx/tx engine starts */
+	rx_func_get(dev);
+	tx_func_get(dev);
+	PMD_INIT_LOG(DEBUG, "simple rx path %s, simple tx path %s",
+		     hw->use_simple_rx ? "on" : "off",
+		     hw->use_simple_tx ? "on" : "off");
 	virtio_dev_rxtx_start(dev);
 	vtpci_reinit_complete(hw);
+	if (hw->vtpci_ops->get_status(hw) & VIRTIO_CONFIG_STATUS_FAILED) {
+		PMD_DRV_LOG(ERR, "device failed to start");
+		return -EIO;
+	}
 
 	hw->started = 1;
 
@@ -1554,8 +1681,24 @@ virtio_dev_info_get(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 	dev_info->max_rx_pktlen = VIRTIO_MAX_RX_PKTLEN;
 	dev_info->max_mac_addrs = VIRTIO_MAX_MAC_ADDRS;
 	dev_info->default_txconf = (struct rte_eth_txconf) {
-		.txq_flags = ETH_TXQ_FLAGS_NOOFFLOADS
+		.txq_flags = ETH_TXQ_FLAGS_NOMULTSEGS |
+			ETH_TXQ_FLAGS_NOOFFLOADS
 	};
+
+	dev_info->tx_offload_capa = 0;
+	if (vtpci_with_feature(hw, VIRTIO_NET_F_CSUM))
+		dev_info->tx_offload_capa |= DEV_TX_OFFLOAD_TCP_CKSUM |
+			DEV_TX_OFFLOAD_UDP_CKSUM;
+	if (vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO4) ||
+	    vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO6))
+		dev_info->tx_offload_capa |= DEV_TX_OFFLOAD_TCP_TSO;
+
+	/* Negotiated at configure time, so look at what the host offers */
+	dev_info->rx_offload_capa = 0;
+	if ((hw->host_features & (1ULL << VIRTIO_NET_F_GUEST_CSUM)) &&
+	    (hw->host_features & (1ULL << VIRTIO_NET_F_MRG_RXBUF)) &&
+	    (hw->host_features & VTNET_LRO_FEATURES))
+		dev_info->rx_offload_capa |= DEV_RX_OFFLOAD_TCP_LRO;
 }
 
 /*
@@ -64,7 +64,26 @@
 	 1u << VIRTIO_NET_F_CTRL_VQ	  |	\
 	 1u << VIRTIO_NET_F_CTRL_RX	  |	\
 	 1u << VIRTIO_NET_F_CTRL_VLAN	  |	\
-	 1u << VIRTIO_NET_F_MRG_RXBUF)
+	 1u << VIRTIO_NET_F_MRG_RXBUF	  |	\
+	 1ULL << VIRTIO_F_RING_PACKED	  |	\
+	 1ULL << VIRTIO_F_IN_ORDER	  |	\
+	 VIRTIO_PMD_OFFLOAD_FEATURES)
+
+/*
+ * Checksum and segmentation offloads on transmit. Their receive side
+ * counterparts are only asked for when the RX mode needs them.
+ */
+#define VIRTIO_PMD_OFFLOAD_FEATURES			\
+	(1u << VIRTIO_NET_F_CSUM		|	\
+	 1u << VIRTIO_NET_F_HOST_TSO4		|	\
+	 1u << VIRTIO_NET_F_HOST_TSO6)
+
+/*
+ * Device init/uninit, shared by the PCI driver and virtio-user
+ */
+int eth_virtio_dev_init(struct rte_eth_dev *eth_dev);
+
+int eth_virtio_dev_uninit(struct rte_eth_dev *eth_dev);
 
 /*
  * CQ function prototype
@@ -108,14 +127,41 @@ uint16_t virtio_recv_mergeable_pkts(void *rx_queue, struct rte_mbuf **rx_pkts,
 uint16_t virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts,
 		uint16_t nb_pkts);
 
+uint16_t virtio_recv_pkts_packed(void *rx_queue, struct rte_mbuf **rx_pkts,
+		uint16_t nb_pkts);
+
+uint16_t virtio_recv_mergeable_pkts_packed(void *rx_queue,
+		struct rte_mbuf **rx_pkts, uint16_t nb_pkts);
+
+uint16_t virtio_xmit_pkts_packed(void *tx_queue, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts);
+
+#ifdef RTE_VIRTIO_INC_VECTOR
+/*
+ * Simple RX/TX path, used when neither mergeable RX buffers, offloads
+ * nor multi-segment packets are in play. The descriptor table keeps a
+ * fixed layout and only the avail ring is written per packet.
+ */
+void virtio_rxq_vec_setup(struct virtqueue *rxq);
+
+void virtio_txq_vec_setup(struct virtqueue *txq);
+
+uint16_t virtio_recv_pkts_vec(void *rx_queue, struct rte_mbuf **rx_pkts,
+		uint16_t nb_pkts);
+
+uint16_t virtio_xmit_pkts_simple(void *tx_queue, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts);
+#endif
+
 
 /*
  * The VIRTIO_NET_F_GUEST_TSO[46] features permit the host to send us
- * frames larger than 1514 bytes. We do not yet support software LRO
- * via tcp_lro_rx().
+ * frames larger than 1514 bytes. They are only negotiated along with
+ * mergeable RX buffers, and turned off through the control queue unless
+ * the application enables LRO.
  */
-#define VTNET_LRO_FEATURES (VIRTIO_NET_F_GUEST_TSO4 | \
-			    VIRTIO_NET_F_GUEST_TSO6 | VIRTIO_NET_F_GUEST_ECN)
+#define VTNET_LRO_FEATURES (1ULL << VIRTIO_NET_F_GUEST_TSO4 | \
+			    1ULL << VIRTIO_NET_F_GUEST_TSO6)
 
 
 #endif /* _VIRTIO_ETHDEV_H_ */
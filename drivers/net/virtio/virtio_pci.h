@@ -110,6 +110,8 @@ struct virtqueue;
 /* The feature bitmap for virtio net */
 #define VIRTIO_NET_F_CSUM	0	/* Host handles pkts w/ partial csum */
 #define VIRTIO_NET_F_GUEST_CSUM	1	/* Guest handles pkts w/ partial csum */
+#define VIRTIO_NET_F_CTRL_GUEST_OFFLOADS 2 /* Control channel offloads
+					 * reconfiguration support */
 #define VIRTIO_NET_F_MAC	5	/* Host has given MAC address. */
 #define VIRTIO_NET_F_GUEST_TSO4	7	/* Guest can handle TSOv4 in. */
 #define VIRTIO_NET_F_GUEST_TSO6	8	/* Guest can handle TSOv6 in. */
@@ -155,6 +157,11 @@ struct virtqueue;
  * at the end of the used ring. Guest should ignore the used->flags field. */
 #define VIRTIO_RING_F_EVENT_IDX		29
 
+/* The descriptor table, avail and used rings are a single packed ring */
+#define VIRTIO_F_RING_PACKED		34
+/* The device uses buffers in the order in which they were made available */
+#define VIRTIO_F_IN_ORDER		35
+
 #define VIRTIO_NET_S_LINK_UP	1	/* Link is up */
 #define VIRTIO_NET_S_ANNOUNCE	2	/* Announcement is needed */
 
@@ -163,16 +170,47 @@ struct virtqueue;
  */
 #define VIRTIO_MAX_VIRTQUEUES 8
 
+struct virtio_hw;
+
+/*
+ * Transport operations, so that the same driver can run over the legacy
+ * PCI I/O port interface or over a vhost-user socket (virtio-user).
+ */
+struct virtio_pci_ops {
+	void (*read_dev_cfg)(struct virtio_hw *hw, uint64_t offset,
+			     void *dst, int len);
+	void (*write_dev_cfg)(struct virtio_hw *hw, uint64_t offset,
+			      void *src, int len);
+	uint8_t (*get_status)(struct virtio_hw *hw);
+	void (*set_status)(struct virtio_hw *hw, uint8_t status);
+	uint64_t (*get_features)(struct virtio_hw *hw);
+	void (*set_features)(struct virtio_hw *hw, uint64_t features);
+	uint8_t (*get_isr)(struct virtio_hw *hw);
+	uint16_t (*set_config_irq)(struct virtio_hw *hw, uint16_t vec);
+	uint16_t (*get_queue_num)(struct virtio_hw *hw, uint16_t queue_id);
+	void (*setup_queue)(struct virtio_hw *hw, struct virtqueue *vq);
+	void (*del_queue)(struct virtio_hw *hw, struct virtqueue *vq);
+	void (*notify_queue)(struct virtio_hw *hw, struct virtqueue *vq);
+};
+
 struct virtio_hw {
 	struct virtqueue *cvq;
+	const struct virtio_pci_ops *vtpci_ops;
+	void        *virtio_user_dev; /* non-NULL for a virtio-user port */
 	uint32_t    io_base;
-	uint32_t    guest_features;
+	uint64_t    guest_features;
+	uint64_t    req_guest_features; /* what guest_features came from */
+	uint64_t    host_features;
 	uint32_t    max_tx_queues;
 	uint32_t    max_rx_queues;
 	uint16_t    vtnet_hdr_size;
 	uint8_t	    vlan_strip;
+	uint8_t	    has_tx_offload; /* host handles partial csum or TSO */
+	uint8_t	    has_rx_offload; /* host may send partial csum or TSO */
 	uint8_t	    use_msix;
 	uint8_t     started;
+	uint8_t     use_simple_rx; /* fixed-layout vector RX path */
+	uint8_t     use_simple_tx; /* fixed-layout TX path with batched free */
 	uint8_t     mac_addr[ETHER_ADDR_LEN];
 };
 
@@ -247,7 +285,13 @@ outl_p(unsigned int data, unsigned int port)
 static inline int
 vtpci_with_feature(struct virtio_hw *hw, uint32_t bit)
 {
-	return (hw->guest_features & (1u << bit)) != 0;
+	return (hw->guest_features & (1ULL << bit)) != 0;
+}
+
+static inline int
+vtpci_packed_queue(struct virtio_hw *hw)
+{
+	return vtpci_with_feature(hw, VIRTIO_F_RING_PACKED);
 }
 
 /*
@@ -259,7 +303,7 @@ void vtpci_reinit_complete(struct virtio_hw *);
 
 void vtpci_set_status(struct virtio_hw *, uint8_t);
 
-uint32_t vtpci_negotiate_features(struct virtio_hw *, uint32_t);
+uint64_t vtpci_negotiate_features(struct virtio_hw *, uint64_t);
 
 void vtpci_write_dev_config(struct virtio_hw *, uint64_t, void *, int);
 
@@ -269,4 +313,6 @@ uint8_t vtpci_isr(struct virtio_hw *);
 
 uint16_t vtpci_irq_config(struct virtio_hw *, uint16_t);
 
+extern const struct virtio_pci_ops legacy_ops;
+
 #endif /* _VIRTIO_PCI_H_ */
@@ -54,6 +54,21 @@
  * simply an optimization.  */
 #define VRING_AVAIL_F_NO_INTERRUPT  1
 
+/*
+ * In a packed ring, a descriptor is available when its AVAIL flag matches
+ * the driver wrap counter and its USED flag does not; the device marks it
+ * used by setting both flags to its own wrap counter.
+ */
+#define VRING_PACKED_DESC_F_AVAIL	(1 << 7)
+#define VRING_PACKED_DESC_F_USED	(1 << 15)
+#define VRING_PACKED_DESC_F_AVAIL_USED	(VRING_PACKED_DESC_F_AVAIL | \
+					 VRING_PACKED_DESC_F_USED)
+
+/* Event suppression flags of a packed ring */
+#define VRING_PACKED_EVENT_F_ENABLE	0x0
+#define VRING_PACKED_EVENT_F_DISABLE	0x1
+#define VRING_PACKED_EVENT_F_DESC	0x2
+
 /* VirtIO ring descriptors: 16 bytes.
  * These can chain together via "next". */
 struct vring_desc {
@@ -90,6 +105,26 @@ struct vring {
 	struct vring_used  *used;
 };
 
+/* Packed ring descriptors: 16 bytes, written back in place when used. */
+struct vring_packed_desc {
+	uint64_t addr;  /* Buffer address. */
+	uint32_t len;   /* Buffer length, or length written when used. */
+	uint16_t id;    /* Buffer id, returned by the device. */
+	uint16_t flags; /* VRING_DESC_F_* and the AVAIL/USED wrap flags. */
+};
+
+struct vring_packed_desc_event {
+	uint16_t desc_event_off_wrap;
+	uint16_t desc_event_flags;
+};
+
+struct vring_packed {
+	unsigned int num;
+	struct vring_packed_desc *desc;
+	struct vring_packed_desc_event *driver; /* written by the driver */
+	struct vring_packed_desc_event *device; /* written by the device */
+};
+
 /* The standard layout for the ring is a continuous chunk of memory which
  * looks like this.  We assume num is a power of 2.
  *
@@ -148,6 +183,23 @@ vring_init(struct vring *vr, unsigned int num, uint8_t *p,
 		RTE_ALIGN_CEIL((uintptr_t)(&vr->avail->ring[num]), align);
 }
 
+/*
+ * The packed layout fits in the memory sized for a split ring: the
+ * descriptors come first, the event suppression areas take the place of
+ * the avail and used rings.
+ */
+static inline void
+vring_packed_init(struct vring_packed *vr, unsigned int num, uint8_t *p,
+	unsigned long align)
+{
+	vr->num = num;
+	vr->desc = (struct vring_packed_desc *)p;
+	vr->driver = (struct vring_packed_desc_event *)(p +
+		num * sizeof(struct vring_packed_desc));
+	vr->device = (void *)
+		RTE_ALIGN_CEIL((uintptr_t)(vr->driver + 1), align);
+}
+
 /*
  * The following is used with VIRTIO_RING_F_EVENT_IDX.
  * Assuming a given event_idx value from the other size, if we have
@@ -50,6 +50,9 @@
 #include <rte_string_fns.h>
 #include <rte_errno.h>
 #include <rte_byteorder.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
 
 #include "virtio_logs.h"
 #include "virtio_ethdev.h"
@@ -133,10 +136,20 @@ virtqueue_dequeue_burst_rx(struct virtqueue *vq, struct rte_mbuf **rx_pkts,
 #define DEFAULT_TX_FREE_THRESH 32
 #endif
 
-/* Cleanup from completed transmits. */
+#ifndef VIRTIO_SIMPLE_FLAGS
+#define VIRTIO_SIMPLE_FLAGS ((uint32_t)ETH_TXQ_FLAGS_NOMULTSEGS | \
+			     ETH_TXQ_FLAGS_NOOFFLOADS)
+#endif
+
+/*
+ * Cleanup from completed transmits. With VIRTIO_F_IN_ORDER the host may
+ * only write the used element of the last chain of a batch, but the
+ * chains come back in the order of the avail ring, where we find them.
+ */
 static void
 virtio_xmit_cleanup(struct virtqueue *vq, uint16_t num)
 {
+	int in_order = vtpci_with_feature(vq->hw, VIRTIO_F_IN_ORDER);
 	uint16_t i, used_idx, desc_idx;
 	for (i = 0; i < num; i++) {
 		struct vring_used_elem *uep;
@@ -145,7 +158,10 @@ virtio_xmit_cleanup(struct virtqueue *vq, uint16_t num)
 		used_idx = (uint16_t)(vq->vq_used_cons_idx & (vq->vq_nentries - 1));
 		uep = &vq->vq_ring.used->ring[used_idx];
 
-		desc_idx = (uint16_t) uep->id;
+		if (in_order)
+			desc_idx = vq->vq_ring.avail->ring[used_idx];
+		else
+			desc_idx = (uint16_t) uep->id;
 		dxp = &vq->vq_descx[desc_idx];
 		vq->vq_used_cons_idx++;
 		vq_ring_free_chain(vq, desc_idx);
@@ -183,8 +199,8 @@ virtqueue_enqueue_recv_refill(struct virtqueue *vq, struct rte_mbuf *cookie)
 
 	start_dp = vq->vq_ring.desc;
 	start_dp[idx].addr =
-		(uint64_t)(cookie->buf_physaddr + RTE_PKTMBUF_HEADROOM
-		- hw->vtnet_hdr_size);
+		VIRTIO_MBUF_ADDR(cookie, vq) + RTE_PKTMBUF_HEADROOM
+		- hw->vtnet_hdr_size;
 	start_dp[idx].len =
 		cookie->buf_len - RTE_PKTMBUF_HEADROOM + hw->vtnet_hdr_size;
 	start_dp[idx].flags =  VRING_DESC_F_WRITE;
@@ -198,6 +214,112 @@ virtqueue_enqueue_recv_refill(struct virtqueue *vq, struct rte_mbuf *cookie)
 	return 0;
 }
 
+/* Fill the virtio-net header of a TX packet from its offload requests */
+static inline void
+virtio_tx_offload(struct virtio_hw *hw, struct virtio_net_hdr *hdr,
+		  struct rte_mbuf *m)
+{
+	uint64_t ol_flags = m->ol_flags;
+
+	hdr->flags = 0;
+	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
+	hdr->hdr_len = 0;
+	hdr->gso_size = 0;
+	hdr->csum_start = 0;
+	hdr->csum_offset = 0;
+
+	/* TSO implies TCP checksum offload */
+	if (ol_flags & PKT_TX_TCP_SEG)
+		ol_flags |= PKT_TX_TCP_CKSUM;
+
+	switch (ol_flags & PKT_TX_L4_MASK) {
+	case PKT_TX_TCP_CKSUM:
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = m->l2_len + m->l3_len;
+		hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
+		break;
+	case PKT_TX_UDP_CKSUM:
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = m->l2_len + m->l3_len;
+		hdr->csum_offset = offsetof(struct udp_hdr, dgram_cksum);
+		break;
+	default:
+		break;
+	}
+
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		if (ol_flags & PKT_TX_IPV4) {
+			if (!vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO4))
+				return;
+			hdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		} else {
+			if (!vtpci_with_feature(hw, VIRTIO_NET_F_HOST_TSO6))
+				return;
+			hdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+		}
+		hdr->gso_size = m->tso_segsz;
+		hdr->hdr_len = m->l2_len + m->l3_len + m->l4_len;
+		/* The host wants the frame length in the pseudo-header */
+		rte_tcp_phdr_cksum_set(m, 0);
+	}
+}
+
+/*
+ * The host handed us a packet with only the pseudo-header checksum in
+ * place: fold the rest of the packet, from csum_start, into it.
+ */
+static void
+virtio_rx_cksum_complete(struct rte_mbuf *m, uint16_t csum_start,
+			 uint16_t csum_offset)
+{
+	struct rte_mbuf *seg;
+	uint32_t off = csum_start, done = 0, sum = 0;
+	uint16_t *cksum;
+
+	if (unlikely((uint32_t)csum_start + csum_offset + sizeof(*cksum) >
+		     m->data_len))
+		return;
+
+	for (seg = m; seg != NULL; seg = seg->next) {
+		uint32_t len;
+		uint16_t seg_sum;
+
+		if (off >= seg->data_len) {
+			off -= seg->data_len;
+			continue;
+		}
+		len = seg->data_len - off;
+		seg_sum = __rte_raw_cksum_reduce(__rte_raw_cksum(
+			rte_pktmbuf_mtod_offset(seg, const void *, off),
+			len, 0));
+		/* a segment starting at an odd offset sums swapped bytes */
+		if (done & 1)
+			seg_sum = rte_bswap16(seg_sum);
+		sum += seg_sum;
+		done += len;
+		off = 0;
+	}
+
+	cksum = rte_pktmbuf_mtod_offset(m, uint16_t *,
+		csum_start + csum_offset);
+	*cksum = (uint16_t)~__rte_raw_cksum_reduce(sum);
+	if (*cksum == 0)
+		*cksum = 0xffff;
+}
+
+/* Apply the virtio-net header of a received packet to the mbuf */
+static inline void
+virtio_rx_offload(struct rte_mbuf *m, struct virtio_net_hdr *hdr)
+{
+	if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM)
+		virtio_rx_cksum_complete(m, hdr->csum_start,
+					 hdr->csum_offset);
+
+	/* Keep the segment size of an LRO frame for forwarding with TSO */
+	if (hdr->gso_type != VIRTIO_NET_HDR_GSO_NONE)
+		m->tso_segsz = hdr->gso_size;
+}
+
 static int
 virtqueue_enqueue_xmit(struct virtqueue *txvq, struct rte_mbuf *cookie)
 {
@@ -221,6 +343,11 @@ virtqueue_enqueue_xmit(struct virtqueue *txvq, struct rte_mbuf *cookie)
 	dxp->cookie = (void *)cookie;
 	dxp->ndescs = needed;
 
+	if (txvq->hw->has_tx_offload)
+		virtio_tx_offload(txvq->hw, (struct virtio_net_hdr *)
+			((char *)txvq->virtio_net_hdr_mz->addr +
+			 idx * head_size), cookie);
+
 	start_dp = txvq->vq_ring.desc;
 	start_dp[idx].addr =
 		txvq->virtio_net_hdr_mem + idx * head_size;
@@ -229,7 +356,7 @@ virtqueue_enqueue_xmit(struct virtqueue *txvq, struct rte_mbuf *cookie)
 
 	for (; ((seg_num > 0) && (cookie != NULL)); seg_num--) {
 		idx = start_dp[idx].next;
-		start_dp[idx].addr  = RTE_MBUF_DATA_DMA_ADDR(cookie);
+		start_dp[idx].addr  = VIRTIO_MBUF_DATA_DMA_ADDR(cookie, txvq);
 		start_dp[idx].len   = cookie->data_len;
 		start_dp[idx].flags = VRING_DESC_F_NEXT;
 		cookie = cookie->next;
@@ -246,6 +373,189 @@ virtqueue_enqueue_xmit(struct virtqueue *txvq, struct rte_mbuf *cookie)
 	return 0;
 }
 
+/*
+ * Packed ring: buffers are identified by an id taken from a free list
+ * threaded through vq_descx, and the descriptors are written in ring
+ * order at vq_avail_idx and read back in ring order at vq_used_cons_idx,
+ * flipping the wrap flags each time the end of the ring is crossed.
+ */
+static inline uint16_t
+vq_packed_get_id(struct virtqueue *vq)
+{
+	uint16_t id = vq->vq_desc_head_idx;
+
+	vq->vq_desc_head_idx = vq->vq_descx[id].next;
+	return id;
+}
+
+static inline void
+vq_packed_put_id(struct virtqueue *vq, uint16_t id)
+{
+	vq->vq_descx[id].next = vq->vq_desc_head_idx;
+	vq->vq_desc_head_idx = id;
+}
+
+static inline void
+vq_packed_avail_next(struct virtqueue *vq)
+{
+	if (++vq->vq_avail_idx >= vq->vq_nentries) {
+		vq->vq_avail_idx = 0;
+		vq->vq_packed_flags ^= VRING_PACKED_DESC_F_AVAIL_USED;
+	}
+}
+
+static inline void
+vq_packed_used_next(struct virtqueue *vq, uint16_t ndescs)
+{
+	vq->vq_used_cons_idx += ndescs;
+	if (vq->vq_used_cons_idx >= vq->vq_nentries) {
+		vq->vq_used_cons_idx -= vq->vq_nentries;
+		vq->vq_used_wrap ^= 1;
+	}
+}
+
+static inline int
+virtqueue_enqueue_recv_refill_packed(struct virtqueue *vq,
+				     struct rte_mbuf *cookie)
+{
+	struct virtio_hw *hw = vq->hw;
+	struct vring_packed_desc *desc;
+	uint16_t id;
+
+	if (unlikely(vq->vq_free_cnt == 0))
+		return -ENOSPC;
+
+	id = vq_packed_get_id(vq);
+	vq->vq_descx[id].cookie = cookie;
+	vq->vq_descx[id].ndescs = 1;
+
+	desc = &vq->vq_ring_packed.desc[vq->vq_avail_idx];
+	desc->addr = VIRTIO_MBUF_ADDR(cookie, vq) + RTE_PKTMBUF_HEADROOM -
+		hw->vtnet_hdr_size;
+	desc->len = cookie->buf_len - RTE_PKTMBUF_HEADROOM +
+		hw->vtnet_hdr_size;
+	desc->id = id;
+	virtio_wmb();
+	desc->flags = VRING_DESC_F_WRITE | vq->vq_packed_flags;
+
+	vq->vq_free_cnt--;
+	vq_packed_avail_next(vq);
+
+	return 0;
+}
+
+static uint16_t
+virtqueue_dequeue_burst_rx_packed(struct virtqueue *vq,
+				  struct rte_mbuf **rx_pkts,
+				  uint32_t *len, uint16_t num)
+{
+	struct vring_packed_desc *desc = vq->vq_ring_packed.desc;
+	struct rte_mbuf *cookie;
+	uint16_t i, id;
+
+	for (i = 0; i < num; i++) {
+		if (!desc_is_used(&desc[vq->vq_used_cons_idx], vq->vq_used_wrap))
+			break;
+		virtio_rmb();
+
+		id = desc[vq->vq_used_cons_idx].id;
+		len[i] = desc[vq->vq_used_cons_idx].len;
+		cookie = (struct rte_mbuf *)vq->vq_descx[id].cookie;
+
+		if (unlikely(cookie == NULL)) {
+			PMD_DRV_LOG(ERR, "vring descriptor with no mbuf cookie at %u\n",
+				vq->vq_used_cons_idx);
+			break;
+		}
+
+		rte_prefetch0(cookie);
+		rte_packet_prefetch(rte_pktmbuf_mtod(cookie, void *));
+		rx_pkts[i] = cookie;
+		vq->vq_descx[id].cookie = NULL;
+		vq->vq_free_cnt += vq->vq_descx[id].ndescs;
+		vq_packed_used_next(vq, vq->vq_descx[id].ndescs);
+		vq_packed_put_id(vq, id);
+	}
+
+	return i;
+}
+
+/* Cleanup from completed transmits, in the order the host used them. */
+static void
+virtio_xmit_cleanup_packed(struct virtqueue *vq)
+{
+	struct vring_packed_desc *desc = vq->vq_ring_packed.desc;
+	struct vq_desc_extra *dxp;
+	uint16_t id;
+
+	while (desc_is_used(&desc[vq->vq_used_cons_idx], vq->vq_used_wrap)) {
+		virtio_rmb();
+
+		id = desc[vq->vq_used_cons_idx].id;
+		dxp = &vq->vq_descx[id];
+		vq->vq_free_cnt += dxp->ndescs;
+		vq_packed_used_next(vq, dxp->ndescs);
+		vq_packed_put_id(vq, id);
+
+		if (dxp->cookie != NULL) {
+			rte_pktmbuf_free(dxp->cookie);
+			dxp->cookie = NULL;
+		}
+	}
+}
+
+/*
+ * The flags of the head descriptor are written last, so that the host
+ * never sees a partial chain. Every descriptor carries the wrap flags of
+ * its own lap, as a chain may cross the end of the ring.
+ */
+static int
+virtqueue_enqueue_xmit_packed(struct virtqueue *txvq, struct rte_mbuf *cookie)
+{
+	struct vring_packed_desc *desc = txvq->vq_ring_packed.desc;
+	uint16_t needed = 1 + cookie->nb_segs;
+	uint16_t head_size = txvq->hw->vtnet_hdr_size;
+	uint16_t id, head_idx, head_flags;
+
+	if (unlikely(txvq->vq_free_cnt == 0))
+		return -ENOSPC;
+	if (unlikely(txvq->vq_free_cnt < needed))
+		return -EMSGSIZE;
+
+	id = vq_packed_get_id(txvq);
+	txvq->vq_descx[id].cookie = cookie;
+	txvq->vq_descx[id].ndescs = needed;
+
+	if (txvq->hw->has_tx_offload)
+		virtio_tx_offload(txvq->hw, (struct virtio_net_hdr *)
+			((char *)txvq->virtio_net_hdr_mz->addr +
+			 id * head_size), cookie);
+
+	head_idx = txvq->vq_avail_idx;
+	head_flags = VRING_DESC_F_NEXT | txvq->vq_packed_flags;
+	desc[head_idx].addr = txvq->virtio_net_hdr_mem + id * head_size;
+	desc[head_idx].len = head_size;
+	desc[head_idx].id = id;
+	vq_packed_avail_next(txvq);
+
+	for (; cookie != NULL; cookie = cookie->next) {
+		struct vring_packed_desc *dp = &desc[txvq->vq_avail_idx];
+
+		dp->addr = VIRTIO_MBUF_DATA_DMA_ADDR(cookie, txvq);
+		dp->len = cookie->data_len;
+		dp->id = id;
+		dp->flags = (cookie->next != NULL ? VRING_DESC_F_NEXT : 0) |
+			txvq->vq_packed_flags;
+		vq_packed_avail_next(txvq);
+	}
+
+	virtio_wmb();
+	desc[head_idx].flags = head_flags;
+	txvq->vq_free_cnt = (uint16_t)(txvq->vq_free_cnt - needed);
+
+	return 0;
+}
+
 static inline struct rte_mbuf *
 rte_rxmbuf_alloc(struct rte_mempool *mp)
 {
@@ -279,10 +589,21 @@ virtio_dev_vring_start(struct virtqueue *vq, int queue_type)
 	vq->vq_free_cnt = vq->vq_nentries;
 	memset(vq->vq_descx, 0, sizeof(struct vq_desc_extra) * vq->vq_nentries);
 
-	/* Chain all the descriptors in the ring with an END */
-	for (i = 0; i < size - 1; i++)
-		vr->desc[i].next = (uint16_t)(i + 1);
-	vr->desc[i].next = VQ_RING_DESC_CHAIN_END;
+	if (vtpci_packed_queue(vq->hw)) {
+		/* Same memory, seen as packed: chain the free buffer ids */
+		vring_packed_init(&vq->vq_ring_packed, size, ring_mem,
+				  VIRTIO_PCI_VRING_ALIGN);
+		vq->vq_packed_flags = VRING_PACKED_DESC_F_AVAIL;
+		vq->vq_used_wrap = 1;
+		for (i = 0; i < size - 1; i++)
+			vq->vq_descx[i].next = (uint16_t)(i + 1);
+		vq->vq_descx[i].next = VQ_RING_DESC_CHAIN_END;
+	} else {
+		/* Chain all the descriptors in the ring with an END */
+		for (i = 0; i < size - 1; i++)
+			vr->desc[i].next = (uint16_t)(i + 1);
+		vr->desc[i].next = VQ_RING_DESC_CHAIN_END;
+	}
 
 	/*
 	 * Disable device(host) interrupting guest
@@ -295,6 +616,14 @@ virtio_dev_vring_start(struct virtqueue *vq, int queue_type)
 			rte_exit(EXIT_FAILURE,
 			"Cannot allocate initial mbufs for rx virtqueue");
 
+#ifdef RTE_VIRTIO_INC_VECTOR
+		if (vq->hw->use_simple_rx) {
+			virtio_rxq_vec_setup(vq);
+			vq->hw->vtpci_ops->setup_queue(vq->hw, vq);
+			return;
+		}
+#endif
+
 		/* Allocate blank mbufs for the each rx descriptor */
 		nbufs = 0;
 		error = ENOSPC;
@@ -306,7 +635,11 @@ virtio_dev_vring_start(struct virtqueue *vq, int queue_type)
 			/******************************************
 			*         Enqueue allocated buffers        *
 			*******************************************/
-			error = virtqueue_enqueue_recv_refill(vq, m);
+			if (vtpci_packed_queue(vq->hw))
+				error = virtqueue_enqueue_recv_refill_packed(
+					vq, m);
+			else
+				error = virtqueue_enqueue_recv_refill(vq, m);
 
 			if (error) {
 				rte_pktmbuf_free(m);
@@ -315,25 +648,18 @@ virtio_dev_vring_start(struct virtqueue *vq, int queue_type)
 			nbufs++;
 		}
 
-		vq_update_avail_idx(vq);
+		if (!vtpci_packed_queue(vq->hw))
+			vq_update_avail_idx(vq);
 
 		PMD_INIT_LOG(DEBUG, "Allocated %d bufs", nbufs);
-
-		VIRTIO_WRITE_REG_2(vq->hw, VIRTIO_PCI_QUEUE_SEL,
-			vq->vq_queue_index);
-		VIRTIO_WRITE_REG_4(vq->hw, VIRTIO_PCI_QUEUE_PFN,
-			vq->mz->phys_addr >> VIRTIO_PCI_QUEUE_ADDR_SHIFT);
-	} else if (queue_type == VTNET_TQ) {
-		VIRTIO_WRITE_REG_2(vq->hw, VIRTIO_PCI_QUEUE_SEL,
-			vq->vq_queue_index);
-		VIRTIO_WRITE_REG_4(vq->hw, VIRTIO_PCI_QUEUE_PFN,
-			vq->mz->phys_addr >> VIRTIO_PCI_QUEUE_ADDR_SHIFT);
-	} else {
-		VIRTIO_WRITE_REG_2(vq->hw, VIRTIO_PCI_QUEUE_SEL,
-			vq->vq_queue_index);
-		VIRTIO_WRITE_REG_4(vq->hw, VIRTIO_PCI_QUEUE_PFN,
-			vq->mz->phys_addr >> VIRTIO_PCI_QUEUE_ADDR_SHIFT);
 	}
+
+#ifdef RTE_VIRTIO_INC_VECTOR
+	if (queue_type == VTNET_TQ && vq->hw->use_simple_tx)
+		virtio_txq_vec_setup(vq);
+#endif
+
+	vq->hw->vtpci_ops->setup_queue(vq->hw, vq);
 }
 
 void
@@ -423,17 +749,27 @@ virtio_dev_tx_queue_setup(struct rte_eth_dev *dev,
 {
 	uint8_t vtpci_queue_idx = 2 * queue_idx + VTNET_SQ_TQ_QUEUE_IDX;
 	struct virtqueue *vq;
+	struct virtio_hw *hw = dev->data->dev_private;
 	uint16_t tx_free_thresh;
+	uint32_t no_xsums = ETH_TXQ_FLAGS_NOXSUMS;
 	int ret;
 
 	PMD_INIT_FUNC_TRACE();
 
-	if ((tx_conf->txq_flags & ETH_TXQ_FLAGS_NOXSUMS)
-	    != ETH_TXQ_FLAGS_NOXSUMS) {
+	/* The host may complete TCP and UDP checksums, never SCTP ones */
+	if (vtpci_with_feature(hw, VIRTIO_NET_F_CSUM))
+		no_xsums = ETH_TXQ_FLAGS_NOXSUMSCTP;
+
+	if ((tx_conf->txq_flags & no_xsums) != no_xsums) {
 		PMD_INIT_LOG(ERR, "TX checksum offload not supported\n");
 		return -EINVAL;
 	}
 
+	/* One queue asking for offloads or chains keeps the whole port off
+	 * the simple TX path, as the burst function is per port. */
+	if ((tx_conf->txq_flags & VIRTIO_SIMPLE_FLAGS) != VIRTIO_SIMPLE_FLAGS)
+		hw->use_simple_tx = 0;
+
 	ret = virtio_dev_queue_setup(dev, VTNET_TQ, queue_idx, vtpci_queue_idx,
 			nb_desc, socket_id, &vq);
 	if (ret < 0) {
@@ -475,7 +811,10 @@ virtio_discard_rxbuf(struct virtqueue *vq, struct rte_mbuf *m)
 	 * Requeue the discarded mbuf. This should always be
 	 * successful since it was just dequeued.
 	 */
-	error = virtqueue_enqueue_recv_refill(vq, m);
+	if (vtpci_packed_queue(vq->hw))
+		error = virtqueue_enqueue_recv_refill_packed(vq, m);
+	else
+		error = virtqueue_enqueue_recv_refill(vq, m);
 	if (unlikely(error)) {
 		RTE_LOG(ERR, PMD, "cannot requeue discarded mbuf");
 		rte_pktmbuf_free(m);
@@ -537,6 +876,11 @@ virtio_recv_pkts(void *rx_queue, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
 		rxm->pkt_len = (uint32_t)(len[i] - hdr_size);
 		rxm->data_len = (uint16_t)(len[i] - hdr_size);
 
+		if (hw->has_rx_offload)
+			virtio_rx_offload(rxm, (struct virtio_net_hdr *)
+				((char *)rxm->buf_addr +
+				 RTE_PKTMBUF_HEADROOM - hdr_size));
+
 		if (hw->vlan_strip)
 			rte_vlan_strip(rxm);
 
@@ -699,6 +1043,9 @@ virtio_recv_mergeable_pkts(void *rx_queue,
 			seg_res -= rcv_cnt;
 		}
 
+		if (hw->has_rx_offload)
+			virtio_rx_offload(rx_pkts[nb_rx], &header->hdr);
+
 		if (hw->vlan_strip)
 			rte_vlan_strip(rx_pkts[nb_rx]);
 
@@ -825,3 +1172,290 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 
 	return nb_tx;
 }
+
+/*
+ * Has the host used the nb_bufs buffers from the consumer position? The
+ * buffers of a merged packet are then all there, even across a wrap.
+ */
+static inline int
+virtio_rx_packed_complete(struct virtqueue *vq, uint16_t nb_bufs)
+{
+	uint16_t idx = vq->vq_used_cons_idx + nb_bufs - 1;
+	uint8_t wrap = vq->vq_used_wrap;
+
+	if (idx >= vq->vq_nentries) {
+		idx -= vq->vq_nentries;
+		wrap ^= 1;
+	}
+	return desc_is_used(&vq->vq_ring_packed.desc[idx], wrap);
+}
+
+static inline uint16_t
+virtio_rx_refill_packed(struct virtqueue *rxvq)
+{
+	struct rte_mbuf *new_mbuf;
+	uint16_t nb_enqueued = 0;
+
+	while (likely(!virtqueue_full(rxvq))) {
+		new_mbuf = rte_rxmbuf_alloc(rxvq->mpool);
+		if (unlikely(new_mbuf == NULL)) {
+			struct rte_eth_dev *dev
+				= &rte_eth_devices[rxvq->port_id];
+			dev->data->rx_mbuf_alloc_failed++;
+			break;
+		}
+		if (unlikely(virtqueue_enqueue_recv_refill_packed(rxvq,
+								  new_mbuf))) {
+			rte_pktmbuf_free(new_mbuf);
+			break;
+		}
+		nb_enqueued++;
+	}
+
+	return nb_enqueued;
+}
+
+uint16_t
+virtio_recv_pkts_packed(void *rx_queue, struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtqueue *rxvq = rx_queue;
+	struct virtio_hw *hw = rxvq->hw;
+	struct rte_mbuf *rxm;
+	uint16_t num, nb_rx;
+	uint32_t len[VIRTIO_MBUF_BURST_SZ];
+	struct rte_mbuf *rcv_pkts[VIRTIO_MBUF_BURST_SZ];
+	uint32_t i, nb_enqueued;
+	const uint32_t hdr_size = sizeof(struct virtio_net_hdr);
+
+	num = RTE_MIN(nb_pkts, VIRTIO_MBUF_BURST_SZ);
+	num = virtqueue_dequeue_burst_rx_packed(rxvq, rcv_pkts, len, num);
+	if (num == 0)
+		return 0;
+
+	PMD_RX_LOG(DEBUG, "dequeue:%d", num);
+
+	nb_rx = 0;
+	nb_enqueued = 0;
+
+	for (i = 0; i < num; i++) {
+		rxm = rcv_pkts[i];
+
+		PMD_RX_LOG(DEBUG, "packet len:%d", len[i]);
+
+		if (unlikely(len[i] < hdr_size + ETHER_HDR_LEN)) {
+			PMD_RX_LOG(ERR, "Packet drop");
+			nb_enqueued++;
+			virtio_discard_rxbuf(rxvq, rxm);
+			rxvq->errors++;
+			continue;
+		}
+
+		rxm->port = rxvq->port_id;
+		rxm->data_off = RTE_PKTMBUF_HEADROOM;
+
+		rxm->nb_segs = 1;
+		rxm->next = NULL;
+		rxm->pkt_len = (uint32_t)(len[i] - hdr_size);
+		rxm->data_len = (uint16_t)(len[i] - hdr_size);
+
+		if (hw->has_rx_offload)
+			virtio_rx_offload(rxm, (struct virtio_net_hdr *)
+				((char *)rxm->buf_addr +
+				 RTE_PKTMBUF_HEADROOM - hdr_size));
+
+		if (hw->vlan_strip)
+			rte_vlan_strip(rxm);
+
+		VIRTIO_DUMP_PACKET(rxm, rxm->data_len);
+
+		rx_pkts[nb_rx++] = rxm;
+		rxvq->bytes += rxm->pkt_len;
+	}
+
+	rxvq->packets += nb_rx;
+
+	nb_enqueued += virtio_rx_refill_packed(rxvq);
+	if (likely(nb_enqueued) &&
+	    unlikely(virtqueue_kick_prepare_packed(rxvq))) {
+		virtqueue_notify(rxvq);
+		PMD_RX_LOG(DEBUG, "Notified");
+	}
+
+	return nb_rx;
+}
+
+uint16_t
+virtio_recv_mergeable_pkts_packed(void *rx_queue,
+			struct rte_mbuf **rx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtqueue *rxvq = rx_queue;
+	struct virtio_hw *hw = rxvq->hw;
+	struct vring_packed_desc *desc = rxvq->vq_ring_packed.desc;
+	struct rte_mbuf *rxm, *prev;
+	uint32_t len[VIRTIO_MBUF_BURST_SZ];
+	struct rte_mbuf *rcv_pkts[VIRTIO_MBUF_BURST_SZ];
+	uint16_t nb_rx, seg_num, seg_res, rcv_cnt, extra_idx, id;
+	uint32_t nb_enqueued;
+	const uint32_t hdr_size = sizeof(struct virtio_net_hdr_mrg_rxbuf);
+
+	nb_rx = 0;
+	nb_enqueued = 0;
+
+	while (nb_rx < nb_pkts) {
+		struct virtio_net_hdr_mrg_rxbuf *header;
+
+		if (!desc_is_used(&desc[rxvq->vq_used_cons_idx],
+				  rxvq->vq_used_wrap))
+			break;
+		virtio_rmb();
+
+		/*
+		 * Look at the header before taking the first buffer: a
+		 * packet is only picked up once all its buffers are used.
+		 */
+		id = desc[rxvq->vq_used_cons_idx].id;
+		rxm = rxvq->vq_descx[id].cookie;
+		if (unlikely(rxm == NULL)) {
+			PMD_DRV_LOG(ERR, "vring descriptor with no mbuf cookie at %u\n",
+				rxvq->vq_used_cons_idx);
+			break;
+		}
+		header = (struct virtio_net_hdr_mrg_rxbuf *)((char *)rxm->buf_addr +
+			RTE_PKTMBUF_HEADROOM - hdr_size);
+		seg_num = header->num_buffers;
+		if (seg_num == 0 || seg_num > rxvq->vq_nentries)
+			seg_num = 1;
+		if (seg_num > 1 && !virtio_rx_packed_complete(rxvq, seg_num))
+			break;
+
+		virtqueue_dequeue_burst_rx_packed(rxvq, rcv_pkts, len, 1);
+		PMD_RX_LOG(DEBUG, "packet len:%d\n", len[0]);
+
+		if (unlikely(len[0] < hdr_size + ETHER_HDR_LEN)) {
+			PMD_RX_LOG(ERR, "Packet drop\n");
+			nb_enqueued++;
+			virtio_discard_rxbuf(rxvq, rxm);
+			rxvq->errors++;
+			continue;
+		}
+
+		rxm->data_off = RTE_PKTMBUF_HEADROOM;
+		rxm->nb_segs = seg_num;
+		rxm->next = NULL;
+		rxm->pkt_len = (uint32_t)(len[0] - hdr_size);
+		rxm->data_len = (uint16_t)(len[0] - hdr_size);
+
+		rxm->port = rxvq->port_id;
+		rx_pkts[nb_rx] = rxm;
+		prev = rxm;
+
+		seg_res = seg_num - 1;
+		while (seg_res != 0) {
+			rcv_cnt = RTE_MIN(seg_res, RTE_DIM(rcv_pkts));
+			rcv_cnt = virtqueue_dequeue_burst_rx_packed(rxvq,
+				rcv_pkts, len, rcv_cnt);
+			if (unlikely(rcv_cnt == 0)) {
+				PMD_RX_LOG(ERR,
+					"No enough segments for packet.\n");
+				rx_pkts[nb_rx]->nb_segs -= seg_res;
+				break;
+			}
+
+			for (extra_idx = 0; extra_idx < rcv_cnt; extra_idx++) {
+				rxm = rcv_pkts[extra_idx];
+
+				rxm->data_off = RTE_PKTMBUF_HEADROOM - hdr_size;
+				rxm->next = NULL;
+				rxm->pkt_len = (uint32_t)(len[extra_idx]);
+				rxm->data_len = (uint16_t)(len[extra_idx]);
+
+				prev->next = rxm;
+				prev = rxm;
+				rx_pkts[nb_rx]->pkt_len += rxm->pkt_len;
+			}
+			seg_res -= rcv_cnt;
+		}
+
+		if (hw->has_rx_offload)
+			virtio_rx_offload(rx_pkts[nb_rx], &header->hdr);
+
+		if (hw->vlan_strip)
+			rte_vlan_strip(rx_pkts[nb_rx]);
+
+		VIRTIO_DUMP_PACKET(rx_pkts[nb_rx],
+			rx_pkts[nb_rx]->data_len);
+
+		rxvq->bytes += rx_pkts[nb_rx]->pkt_len;
+		nb_rx++;
+	}
+
+	rxvq->packets += nb_rx;
+
+	nb_enqueued += virtio_rx_refill_packed(rxvq);
+	if (likely(nb_enqueued) &&
+	    unlikely(virtqueue_kick_prepare_packed(rxvq))) {
+		virtqueue_notify(rxvq);
+		PMD_RX_LOG(DEBUG, "Notified");
+	}
+
+	return nb_rx;
+}
+
+uint16_t
+virtio_xmit_pkts_packed(void *tx_queue, struct rte_mbuf **tx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtqueue *txvq = tx_queue;
+	struct rte_mbuf *txm;
+	uint16_t nb_tx;
+	int error;
+
+	if (unlikely(nb_pkts < 1))
+		return nb_pkts;
+
+	PMD_TX_LOG(DEBUG, "%d packets to xmit", nb_pkts);
+
+	/* There is no used index to look at: reclaim when running low */
+	if (txvq->vq_free_cnt < txvq->vq_free_thresh)
+		virtio_xmit_cleanup_packed(txvq);
+
+	for (nb_tx = 0; nb_tx < nb_pkts; nb_tx++) {
+		txm = tx_pkts[nb_tx];
+
+		/* Need one more descriptor for virtio header. */
+		if (unlikely(txm->nb_segs + 1 > txvq->vq_free_cnt)) {
+			virtio_xmit_cleanup_packed(txvq);
+			if (txm->nb_segs + 1 > txvq->vq_free_cnt) {
+				PMD_TX_LOG(ERR, "No free tx descriptors to transmit");
+				break;
+			}
+		}
+
+		/* Do VLAN tag insertion */
+		if (unlikely(txm->ol_flags & PKT_TX_VLAN_PKT)) {
+			error = rte_vlan_insert(&txm);
+			if (unlikely(error)) {
+				rte_pktmbuf_free(txm);
+				continue;
+			}
+		}
+
+		error = virtqueue_enqueue_xmit_packed(txvq, txm);
+		if (unlikely(error)) {
+			PMD_TX_LOG(ERR, "virtqueue_enqueue error: %d", error);
+			break;
+		}
+		txvq->bytes += txm->pkt_len;
+	}
+
+	txvq->packets += nb_tx;
+
+	if (likely(nb_tx) && unlikely(virtqueue_kick_prepare_packed(txvq))) {
+		virtqueue_notify(txvq);
+		PMD_TX_LOG(DEBUG, "Notified backend after xmit");
+	}
+
+	return nb_tx;
+}
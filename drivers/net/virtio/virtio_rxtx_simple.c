@@ -0,0 +1,345 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_prefetch.h>
+
+#include "virtio_logs.h"
+#include "virtio_ethdev.h"
+#include "virtqueue.h"
+
+#include <tmmintrin.h>
+
+/*
+ * The simple path keeps the descriptor table in a fixed layout set up
+ * once at start:
+ *  - RX: descriptor i is a single device-writable buffer, so only its
+ *    address and length change when a new mbuf is attached to it;
+ *  - TX: the upper half of the table holds the virtio-net headers, each
+ *    one chained to the data descriptor of the same slot in the lower
+ *    half, so only the data address and length are written per packet.
+ *
+ * The host may return buffers out of order (vhost zero-copy dequeue does),
+ * so the avail ring entries past the published index double as the list
+ * of free descriptors: a used id is written there as soon as it has been
+ * consumed and picked up again when the slot is refilled. A host using
+ * buffers in order (VIRTIO_F_IN_ORDER) may only write the used element of
+ * the last buffer of a batch: TX completions are then read back from the
+ * avail ring, whose in-flight entries are never the ones being staged.
+ */
+
+#define VIRTIO_RX_REARM_THRESH    32
+#define VIRTIO_TX_MAX_FREE_BUF_SZ 64
+
+/* Attach fresh mbufs to up to VIRTIO_RX_REARM_THRESH free RX slots */
+static inline int
+virtio_rxq_rearm_vec(struct virtqueue *rxvq)
+{
+	struct rte_mbuf *mbufs[VIRTIO_RX_REARM_THRESH];
+	struct vring_desc *start_dp = rxvq->vq_ring.desc;
+	uint16_t mask = rxvq->vq_nentries - 1;
+	uint16_t hdr_size = rxvq->hw->vtnet_hdr_size;
+	uint16_t i, id, nb;
+
+	nb = RTE_MIN(rxvq->vq_free_cnt, VIRTIO_RX_REARM_THRESH);
+	if (rte_mempool_get_bulk(rxvq->mpool, (void **)mbufs, nb) < 0) {
+		rte_eth_devices[rxvq->port_id].data->rx_mbuf_alloc_failed +=
+			nb;
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < nb; i++) {
+		struct rte_mbuf *m = mbufs[i];
+		uintptr_t p = (uintptr_t)&m->rearm_data;
+
+		/* data_off, refcnt, nb_segs and port in a single store */
+		*(uint64_t *)p = rxvq->mbuf_initializer;
+		m->ol_flags = 0;
+
+		id = rxvq->vq_ring.avail->ring[(rxvq->vq_avail_idx + i) &
+					       mask];
+		rxvq->vq_descx[id].cookie = m;
+		start_dp[id].addr = VIRTIO_MBUF_ADDR(m, rxvq) +
+			RTE_PKTMBUF_HEADROOM - hdr_size;
+		start_dp[id].len = m->buf_len - RTE_PKTMBUF_HEADROOM +
+			hdr_size;
+	}
+
+	rxvq->vq_avail_idx += nb;
+	rxvq->vq_free_cnt -= nb;
+	vq_update_avail_idx(rxvq);
+
+	return 0;
+}
+
+void
+virtio_rxq_vec_setup(struct virtqueue *rxvq)
+{
+	struct vring *vr = &rxvq->vq_ring;
+	struct rte_mbuf mb_def = { .buf_addr = 0 }; /* zeroed mbuf */
+	uintptr_t p;
+	uint16_t i;
+
+	mb_def.nb_segs = 1;
+	mb_def.data_off = RTE_PKTMBUF_HEADROOM;
+	mb_def.port = rxvq->port_id;
+	rte_mbuf_refcnt_set(&mb_def, 1);
+
+	/* prevent compiler reordering: rearm_data covers previous fields */
+	rte_compiler_barrier();
+	p = (uintptr_t)&mb_def.rearm_data;
+	rxvq->mbuf_initializer = *(uint64_t *)p;
+
+	/* Every slot starts free, staged in the avail ring in order */
+	for (i = 0; i < rxvq->vq_nentries; i++) {
+		vr->desc[i].flags = VRING_DESC_F_WRITE;
+		vr->avail->ring[i] = i;
+	}
+	rxvq->vq_free_cnt = rxvq->vq_nentries;
+
+	while (rxvq->vq_free_cnt > 0)
+		if (virtio_rxq_rearm_vec(rxvq) < 0)
+			break;
+
+	PMD_INIT_LOG(DEBUG, "Allocated %d bufs",
+		     rxvq->vq_nentries - rxvq->vq_free_cnt);
+}
+
+void
+virtio_txq_vec_setup(struct virtqueue *txvq)
+{
+	struct vring *vr = &txvq->vq_ring;
+	uint16_t hdr_size = txvq->hw->vtnet_hdr_size;
+	uint16_t mid = txvq->vq_nentries >> 1;
+	uint16_t i;
+
+	/* No offload is requested on this path: the headers stay zeroed */
+	memset(txvq->virtio_net_hdr_mz->addr, 0,
+	       txvq->vq_nentries * hdr_size);
+
+	for (i = 0; i < mid; i++) {
+		vr->avail->ring[i] = i + mid;
+
+		vr->desc[i + mid].addr = txvq->virtio_net_hdr_mem +
+			(i + mid) * hdr_size;
+		vr->desc[i + mid].len = hdr_size;
+		vr->desc[i + mid].flags = VRING_DESC_F_NEXT;
+		vr->desc[i + mid].next = i;
+
+		vr->desc[i].flags = 0;
+	}
+	txvq->vq_free_cnt = mid;
+}
+
+uint16_t
+virtio_recv_pkts_vec(void *rx_queue, struct rte_mbuf **rx_pkts,
+		     uint16_t nb_pkts)
+{
+	struct virtqueue *rxvq = rx_queue;
+	struct vring_used_elem *uep;
+	struct rte_mbuf *m;
+	uint16_t mask = rxvq->vq_nentries - 1;
+	uint16_t hdr_size = rxvq->hw->vtnet_hdr_size;
+	uint16_t nb_used, id, i;
+	uint64_t bytes = 0;
+	__m128i used, pkt_mb;
+
+	/*
+	 * Shuffle the len of a used element, seen as { id, len }, into
+	 * pkt_len and data_len; packet_type, vlan_tci and hash are zeroed.
+	 */
+#ifdef RTE_NEXT_ABI
+	const __m128i shuf_msk = _mm_set_epi8(
+		0xFF, 0xFF, 0xFF, 0xFF, /* hash */
+		0xFF, 0xFF,             /* vlan_tci */
+		5, 4,                   /* data_len */
+		0xFF, 0xFF, 5, 4,       /* pkt_len */
+		0xFF, 0xFF, 0xFF, 0xFF  /* packet_type */
+		);
+	const __m128i len_adjust = _mm_set_epi16(
+		0, 0, 0,
+		hdr_size,               /* data_len */
+		0,
+		hdr_size,               /* pkt_len */
+		0, 0);
+#else
+	const __m128i shuf_msk = _mm_set_epi8(
+		0xFF, 0xFF, 0xFF, 0xFF, /* hash */
+		0xFF, 0xFF, 0xFF, 0xFF, /* vlan_tci, vlan_tci_outer */
+		0xFF, 0xFF, 5, 4,       /* pkt_len */
+		5, 4,                   /* data_len */
+		0xFF, 0xFF              /* packet_type */
+		);
+	const __m128i len_adjust = _mm_set_epi16(
+		0, 0, 0, 0, 0,
+		hdr_size,               /* pkt_len */
+		hdr_size,               /* data_len */
+		0);
+#endif
+
+	nb_used = VIRTQUEUE_NUSED(rxvq);
+
+	virtio_rmb();
+
+	nb_pkts = RTE_MIN(nb_pkts, nb_used);
+
+	for (i = 0; i < nb_pkts; i++) {
+		uep = &rxvq->vq_ring.used->ring[(rxvq->vq_used_cons_idx + i) &
+						mask];
+		id = (uint16_t)uep->id;
+		m = rxvq->vq_descx[id].cookie;
+		rxvq->vq_descx[id].cookie = NULL;
+
+		used = _mm_loadl_epi64((const __m128i *)uep);
+		pkt_mb = _mm_shuffle_epi8(used, shuf_msk);
+		pkt_mb = _mm_sub_epi16(pkt_mb, len_adjust);
+		_mm_storeu_si128((__m128i *)&m->rx_descriptor_fields1, pkt_mb);
+
+		/* Stage the slot for the next rearm */
+		rxvq->vq_ring.avail->ring[(rxvq->vq_avail_idx +
+					   rxvq->vq_free_cnt) & mask] = id;
+		rxvq->vq_free_cnt++;
+
+		rte_packet_prefetch(rte_pktmbuf_mtod(m, void *));
+		rx_pkts[i] = m;
+		bytes += m->pkt_len;
+	}
+
+	rxvq->vq_used_cons_idx += nb_pkts;
+	rxvq->packets += nb_pkts;
+	rxvq->bytes += bytes;
+
+	if (rxvq->vq_free_cnt >= VIRTIO_RX_REARM_THRESH) {
+		while (rxvq->vq_free_cnt >= VIRTIO_RX_REARM_THRESH)
+			if (virtio_rxq_rearm_vec(rxvq) < 0)
+				break;
+
+		if (unlikely(virtqueue_kick_prepare(rxvq)))
+			virtqueue_notify(rxvq);
+	}
+
+	return nb_pkts;
+}
+
+/* Free the mbufs of completed transmits, returning them in bulk */
+static inline void
+virtio_xmit_cleanup_simple(struct virtqueue *txvq, uint16_t num)
+{
+	struct rte_mbuf *m, *free[VIRTIO_TX_MAX_FREE_BUF_SZ];
+	uint16_t mask = txvq->vq_nentries - 1;
+	uint16_t mid = txvq->vq_nentries >> 1;
+	int in_order = vtpci_with_feature(txvq->hw, VIRTIO_F_IN_ORDER);
+	uint16_t i, id, nb_free = 0;
+
+	for (i = 0; i < num; i++) {
+		if (in_order)
+			id = txvq->vq_ring.avail->ring[
+				(txvq->vq_used_cons_idx + i) & mask];
+		else
+			id = (uint16_t)txvq->vq_ring.used->ring[
+				(txvq->vq_used_cons_idx + i) & mask].id;
+		m = txvq->vq_descx[id - mid].cookie;
+		txvq->vq_descx[id - mid].cookie = NULL;
+
+		txvq->vq_ring.avail->ring[(txvq->vq_avail_idx +
+					   txvq->vq_free_cnt) & mask] = id;
+		txvq->vq_free_cnt++;
+
+		m = __rte_pktmbuf_prefree_seg(m);
+		if (unlikely(m == NULL))
+			continue;
+
+		if (nb_free == VIRTIO_TX_MAX_FREE_BUF_SZ ||
+		    (nb_free > 0 && m->pool != free[0]->pool)) {
+			rte_mempool_put_bulk(free[0]->pool, (void **)free,
+					     nb_free);
+			nb_free = 0;
+		}
+		free[nb_free++] = m;
+	}
+
+	if (nb_free > 0)
+		rte_mempool_put_bulk(free[0]->pool, (void **)free, nb_free);
+
+	txvq->vq_used_cons_idx += num;
+}
+
+uint16_t
+virtio_xmit_pkts_simple(void *tx_queue, struct rte_mbuf **tx_pkts,
+			uint16_t nb_pkts)
+{
+	struct virtqueue *txvq = tx_queue;
+	struct vring_desc *start_dp = txvq->vq_ring.desc;
+	uint16_t mask = txvq->vq_nentries - 1;
+	uint16_t mid = txvq->vq_nentries >> 1;
+	uint16_t nb_used, nb_commit, id, i;
+	uint64_t bytes = 0;
+
+	nb_used = VIRTQUEUE_NUSED(txvq);
+
+	virtio_rmb();
+	if (nb_used >= txvq->vq_free_thresh || txvq->vq_free_cnt < nb_pkts)
+		virtio_xmit_cleanup_simple(txvq, nb_used);
+
+	nb_commit = RTE_MIN(txvq->vq_free_cnt, nb_pkts);
+	if (unlikely(nb_commit == 0))
+		return 0;
+
+	for (i = 0; i < nb_commit; i++) {
+		struct rte_mbuf *m = tx_pkts[i];
+
+		id = txvq->vq_ring.avail->ring[(txvq->vq_avail_idx + i) & mask];
+		txvq->vq_descx[id - mid].cookie = m;
+		start_dp[id - mid].addr = VIRTIO_MBUF_DATA_DMA_ADDR(m, txvq);
+		start_dp[id - mid].len = m->data_len;
+		bytes += m->pkt_len;
+	}
+
+	txvq->vq_avail_idx += nb_commit;
+	txvq->vq_free_cnt -= nb_commit;
+	txvq->packets += nb_commit;
+	txvq->bytes += bytes;
+
+	vq_update_avail_idx(txvq);
+
+	if (unlikely(virtqueue_kick_prepare(txvq)))
+		virtqueue_notify(txvq);
+
+	return nb_commit;
+}
@@ -0,0 +1,361 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_memory.h>
+#include <rte_log.h>
+
+#include "vhost_user.h"
+#include "../virtio_logs.h"
+
+static const char * const vhost_msg_strings[VHOST_USER_MAX] = {
+	[VHOST_USER_GET_FEATURES] = "VHOST_USER_GET_FEATURES",
+	[VHOST_USER_SET_FEATURES] = "VHOST_USER_SET_FEATURES",
+	[VHOST_USER_SET_OWNER] = "VHOST_USER_SET_OWNER",
+	[VHOST_USER_RESET_OWNER] = "VHOST_USER_RESET_OWNER",
+	[VHOST_USER_SET_MEM_TABLE] = "VHOST_USER_SET_MEM_TABLE",
+	[VHOST_USER_SET_VRING_NUM] = "VHOST_USER_SET_VRING_NUM",
+	[VHOST_USER_SET_VRING_ADDR] = "VHOST_USER_SET_VRING_ADDR",
+	[VHOST_USER_SET_VRING_BASE] = "VHOST_USER_SET_VRING_BASE",
+	[VHOST_USER_GET_VRING_BASE] = "VHOST_USER_GET_VRING_BASE",
+	[VHOST_USER_SET_VRING_KICK] = "VHOST_USER_SET_VRING_KICK",
+	[VHOST_USER_SET_VRING_CALL] = "VHOST_USER_SET_VRING_CALL",
+};
+
+static int
+vhost_user_write(int fd, struct vhost_user_msg *msg, int *fds, int fd_num)
+{
+	struct iovec iov;
+	struct msghdr msgh;
+	size_t fdsize = fd_num * sizeof(int);
+	char control[CMSG_SPACE(VHOST_USER_MAX_REGIONS * sizeof(int))];
+	struct cmsghdr *cmsg;
+	int ret;
+
+	memset(&msgh, 0, sizeof(msgh));
+	iov.iov_base = msg;
+	iov.iov_len = VHOST_USER_HDR_SIZE + msg->size;
+
+	msgh.msg_iov = &iov;
+	msgh.msg_iovlen = 1;
+
+	if (fd_num > 0) {
+		msgh.msg_control = control;
+		msgh.msg_controllen = CMSG_SPACE(fdsize);
+		cmsg = CMSG_FIRSTHDR(&msgh);
+		cmsg->cmsg_len = CMSG_LEN(fdsize);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		memcpy(CMSG_DATA(cmsg), fds, fdsize);
+	}
+
+	do {
+		ret = sendmsg(fd, &msgh, 0);
+	} while (ret < 0 && errno == EINTR);
+
+	return ret;
+}
+
+static int
+vhost_user_read(int fd, struct vhost_user_msg *msg)
+{
+	uint32_t valid_flags = VHOST_USER_REPLY_MASK | VHOST_USER_VERSION;
+	int ret;
+
+	ret = read(fd, msg, VHOST_USER_HDR_SIZE);
+	if (ret != (int)VHOST_USER_HDR_SIZE) {
+		RTE_LOG(ERR, PMD, "failed to read vhost-user reply header\n");
+		return -1;
+	}
+
+	if (msg->flags != valid_flags) {
+		RTE_LOG(ERR, PMD, "unexpected vhost-user reply flags 0x%x\n",
+			    msg->flags);
+		return -1;
+	}
+
+	if (msg->size > sizeof(msg->payload)) {
+		RTE_LOG(ERR, PMD, "invalid vhost-user reply size %u\n",
+			msg->size);
+		return -1;
+	}
+
+	if (msg->size > 0) {
+		ret = read(fd, &msg->payload, msg->size);
+		if (ret != (int)msg->size) {
+			RTE_LOG(ERR, PMD, "failed to read vhost-user reply\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Does the address range [start, end) lie within one EAL memory segment? */
+static int
+in_memseg(const struct rte_memseg *ms, uint64_t start, uint64_t end)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG && ms[i].addr != NULL; i++) {
+		uint64_t seg_start = (uint64_t)(uintptr_t)ms[i].addr;
+
+		if (start >= seg_start && end <= seg_start + ms[i].len)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * Describe the hugepage memory of the process to the backend. The EAL
+ * memory segments are made of hugepage files mapped MAP_SHARED; find them
+ * in /proc/self/maps and pass their file descriptors, with our virtual
+ * addresses standing for the guest physical addresses.
+ */
+static int
+prepare_mem_table(struct vhost_user_memory *mem, int *fds)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	struct vhost_user_memory_region *reg = NULL;
+	uint64_t start, end, offset, inode, last_inode = 0;
+	char buf[BUFSIZ], path[PATH_MAX];
+	unsigned n = 0;
+	FILE *f;
+
+	f = fopen("/proc/self/maps", "r");
+	if (f == NULL) {
+		RTE_LOG(ERR, PMD, "cannot open /proc/self/maps\n");
+		return -1;
+	}
+
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+		if (sscanf(buf, "%" SCNx64 "-%" SCNx64 " %*s %" SCNx64
+			   " %*s %" SCNu64 " %s",
+			   &start, &end, &offset, &inode, path) != 5)
+			continue;
+
+		if (!in_memseg(ms, start, end))
+			continue;
+
+		/* Extend the previous region if it maps the same file */
+		if (reg != NULL && inode == last_inode &&
+		    reg->userspace_addr + reg->memory_size == start &&
+		    reg->mmap_offset + reg->memory_size == offset) {
+			reg->memory_size += end - start;
+			continue;
+		}
+
+		if (n == VHOST_USER_MAX_REGIONS) {
+			RTE_LOG(ERR, PMD,
+				"more than %d hugepage files, use larger pages\n",
+				VHOST_USER_MAX_REGIONS);
+			goto error;
+		}
+
+		fds[n] = open(path, O_RDWR);
+		if (fds[n] < 0) {
+			RTE_LOG(ERR, PMD, "cannot open %s: %s\n",
+				    path, strerror(errno));
+			goto error;
+		}
+
+		reg = &mem->regions[n++];
+		reg->guest_phys_addr = start;
+		reg->userspace_addr = start;
+		reg->memory_size = end - start;
+		reg->mmap_offset = offset;
+		last_inode = inode;
+	}
+	fclose(f);
+
+	if (n == 0) {
+		RTE_LOG(ERR, PMD, "no hugepage backed memory to share\n");
+		return -1;
+	}
+
+	mem->nregions = n;
+	mem->padding = 0;
+	return 0;
+
+error:
+	while (n > 0)
+		close(fds[--n]);
+	fclose(f);
+	return -1;
+}
+
+int
+vhost_user_call(int vhostfd, enum vhost_user_request req, void *arg)
+{
+	struct vhost_user_msg msg;
+	struct vhost_user_memory mem;
+	struct vhost_vring_file *file;
+	int fds[VHOST_USER_MAX_REGIONS];
+	int fd_num = 0;
+	int need_reply = 0;
+	int i, ret;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.request = req;
+	msg.flags = VHOST_USER_VERSION;
+
+	switch (req) {
+	case VHOST_USER_GET_FEATURES:
+		need_reply = 1;
+		break;
+
+	case VHOST_USER_SET_FEATURES:
+		msg.payload.u64 = *(uint64_t *)arg;
+		msg.size = sizeof(msg.payload.u64);
+		break;
+
+	case VHOST_USER_SET_OWNER:
+	case VHOST_USER_RESET_OWNER:
+		break;
+
+	case VHOST_USER_SET_MEM_TABLE:
+		/* Filled aside, the message is packed */
+		memset(&mem, 0, sizeof(mem));
+		if (prepare_mem_table(&mem, fds) < 0)
+			return -1;
+		memcpy(&msg.payload.memory, &mem, sizeof(mem));
+		fd_num = mem.nregions;
+		msg.size = sizeof(msg.payload.memory.nregions) +
+			sizeof(msg.payload.memory.padding) +
+			fd_num * sizeof(struct vhost_user_memory_region);
+		break;
+
+	case VHOST_USER_GET_VRING_BASE:
+		need_reply = 1;
+		/* fallthrough */
+	case VHOST_USER_SET_VRING_NUM:
+	case VHOST_USER_SET_VRING_BASE:
+		memcpy(&msg.payload.state, arg, sizeof(msg.payload.state));
+		msg.size = sizeof(msg.payload.state);
+		break;
+
+	case VHOST_USER_SET_VRING_ADDR:
+		memcpy(&msg.payload.addr, arg, sizeof(msg.payload.addr));
+		msg.size = sizeof(msg.payload.addr);
+		break;
+
+	case VHOST_USER_SET_VRING_KICK:
+	case VHOST_USER_SET_VRING_CALL:
+		file = arg;
+		msg.payload.u64 = file->index & VHOST_USER_VRING_IDX_MASK;
+		msg.size = sizeof(msg.payload.u64);
+		if (file->fd >= 0)
+			fds[fd_num++] = file->fd;
+		else
+			msg.payload.u64 |= VHOST_USER_VRING_NOFD_MASK;
+		break;
+
+	default:
+		RTE_LOG(ERR, PMD, "unsupported vhost-user request %d\n", req);
+		return -1;
+	}
+
+	PMD_INIT_LOG(DEBUG, "sending %s", vhost_msg_strings[req]);
+	ret = vhost_user_write(vhostfd, &msg, fds, fd_num);
+
+	/* The backend holds its own references to the hugepage files */
+	if (req == VHOST_USER_SET_MEM_TABLE)
+		for (i = 0; i < fd_num; i++)
+			close(fds[i]);
+
+	if (ret < 0) {
+		RTE_LOG(ERR, PMD, "%s failed: %s\n",
+			    vhost_msg_strings[req], strerror(errno));
+		return -1;
+	}
+
+	if (!need_reply)
+		return 0;
+
+	if (vhost_user_read(vhostfd, &msg) < 0)
+		return -1;
+
+	if (msg.request != req) {
+		RTE_LOG(ERR, PMD, "reply to %d received for %s\n",
+			    msg.request, vhost_msg_strings[req]);
+		return -1;
+	}
+
+	if (req == VHOST_USER_GET_FEATURES) {
+		if (msg.size != sizeof(msg.payload.u64))
+			return -1;
+		*(uint64_t *)arg = msg.payload.u64;
+	} else {
+		if (msg.size != sizeof(msg.payload.state))
+			return -1;
+		memcpy(arg, &msg.payload.state, sizeof(msg.payload.state));
+	}
+
+	return 0;
+}
+
+int
+vhost_user_connect(const char *path)
+{
+	struct sockaddr_un un;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		RTE_LOG(ERR, PMD, "socket(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&un, 0, sizeof(un));
+	un.sun_family = AF_UNIX;
+	snprintf(un.sun_path, sizeof(un.sun_path), "%s", path);
+	if (connect(fd, (struct sockaddr *)&un, sizeof(un)) < 0) {
+		RTE_LOG(ERR, PMD, "cannot connect to %s: %s\n",
+			    path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
@@ -0,0 +1,209 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <rte_log.h>
+
+#include "vhost_user.h"
+#include "virtio_user_dev.h"
+#include "../virtio_pci.h"
+
+/*
+ * Hand one vring over to the backend. The call fd goes first, as the
+ * backend considers the device ready once every vring has its kick fd.
+ */
+static int
+virtio_user_kick_queue(struct virtio_user_dev *dev, uint32_t queue_sel)
+{
+	struct vring *vring = &dev->vrings[queue_sel];
+	struct vhost_vring_file file;
+	struct vhost_vring_state state;
+	struct vhost_vring_addr addr = {
+		.index = queue_sel,
+		.desc_user_addr = (uint64_t)(uintptr_t)vring->desc,
+		.avail_user_addr = (uint64_t)(uintptr_t)vring->avail,
+		.used_user_addr = (uint64_t)(uintptr_t)vring->used,
+		.log_guest_addr = 0,
+		.flags = 0,
+	};
+
+	file.index = queue_sel;
+	file.fd = dev->callfds[queue_sel];
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_VRING_CALL, &file) < 0)
+		return -1;
+
+	state.index = queue_sel;
+	state.num = vring->num;
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_VRING_NUM, &state) < 0)
+		return -1;
+
+	/*
+	 * The rings are always started from scratch; a packed ring also
+	 * passes its wrap counter, set, in the top bit.
+	 */
+	state.num = 0;
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		state.num = 1 << 15;
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_VRING_BASE, &state) < 0)
+		return -1;
+
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_VRING_ADDR, &addr) < 0)
+		return -1;
+
+	file.fd = dev->kickfds[queue_sel];
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_VRING_KICK, &file) < 0)
+		return -1;
+
+	return 0;
+}
+
+int
+virtio_user_start_device(struct virtio_user_dev *dev)
+{
+	uint64_t features;
+	uint32_t i;
+
+	/* MAC and STATUS are emulated here, only pass what the backend has */
+	features = dev->features & dev->device_features;
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_FEATURES,
+			    &features) < 0)
+		goto error;
+
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_MEM_TABLE, NULL) < 0)
+		goto error;
+
+	for (i = 0; i < VIRTIO_USER_MAX_VQ; i++)
+		if (virtio_user_kick_queue(dev, i) < 0)
+			goto error;
+
+	dev->started = 1;
+	return 0;
+
+error:
+	RTE_LOG(ERR, PMD, "%s: cannot start vhost-user device\n", dev->path);
+	return -1;
+}
+
+int
+virtio_user_stop_device(struct virtio_user_dev *dev)
+{
+	struct vhost_vring_state state;
+	uint32_t i;
+
+	/* Getting the vring base makes the backend stop using the vring */
+	for (i = 0; i < VIRTIO_USER_MAX_VQ; i++) {
+		state.index = i;
+		if (vhost_user_call(dev->vhostfd, VHOST_USER_GET_VRING_BASE,
+				    &state) < 0) {
+			RTE_LOG(ERR, PMD, "%s: cannot stop vring %u\n",
+				dev->path, i);
+			return -1;
+		}
+	}
+
+	dev->started = 0;
+	return 0;
+}
+
+int
+virtio_user_dev_init(struct virtio_user_dev *dev, const char *path,
+		     uint32_t queue_size)
+{
+	uint32_t i;
+
+	snprintf(dev->path, sizeof(dev->path), "%s", path);
+	dev->queue_size = queue_size;
+	dev->status = 0;
+	dev->started = 0;
+	for (i = 0; i < VIRTIO_USER_MAX_VQ; i++) {
+		dev->callfds[i] = -1;
+		dev->kickfds[i] = -1;
+	}
+
+	dev->vhostfd = vhost_user_connect(path);
+	if (dev->vhostfd < 0)
+		return -1;
+
+	if (vhost_user_call(dev->vhostfd, VHOST_USER_SET_OWNER, NULL) < 0 ||
+	    vhost_user_call(dev->vhostfd, VHOST_USER_GET_FEATURES,
+			    &dev->device_features) < 0) {
+		RTE_LOG(ERR, PMD, "%s: vhost-user handshake failed\n", path);
+		goto error;
+	}
+
+	/*
+	 * The backend polls the rings and we poll the used rings, but the
+	 * protocol wants an eventfd in each direction.
+	 */
+	for (i = 0; i < VIRTIO_USER_MAX_VQ; i++) {
+		dev->callfds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		dev->kickfds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (dev->callfds[i] < 0 || dev->kickfds[i] < 0) {
+			RTE_LOG(ERR, PMD, "cannot create eventfd\n");
+			goto error;
+		}
+	}
+
+	return 0;
+
+error:
+	virtio_user_dev_uninit(dev);
+	return -1;
+}
+
+void
+virtio_user_dev_uninit(struct virtio_user_dev *dev)
+{
+	uint32_t i;
+
+	if (dev->started)
+		virtio_user_stop_device(dev);
+
+	for (i = 0; i < VIRTIO_USER_MAX_VQ; i++) {
+		if (dev->callfds[i] >= 0)
+			close(dev->callfds[i]);
+		if (dev->kickfds[i] >= 0)
+			close(dev->kickfds[i]);
+		dev->callfds[i] = -1;
+		dev->kickfds[i] = -1;
+	}
+
+	if (dev->vhostfd >= 0)
+		close(dev->vhostfd);
+	dev->vhostfd = -1;
+}
@@ -0,0 +1,471 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_dev.h>
+#include <rte_ethdev.h>
+#include <rte_kvargs.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+
+#include "virtio_ethdev.h"
+#include "virtio_logs.h"
+#include "virtio_pci.h"
+#include "virtqueue.h"
+#include "virtio_user/virtio_user_dev.h"
+
+/*
+ * virtio-user: the virtio PMD driving a vhost-user backend through its
+ * unix socket instead of a PCI device, e.g. to exchange packets with a
+ * vhost application on the same host without a VM in between. The device
+ * registers are emulated here on top of the vhost-user requests.
+ */
+
+#define VIRTIO_USER_ARG_PATH		"path"
+#define VIRTIO_USER_ARG_MAC		"mac"
+#define VIRTIO_USER_ARG_QUEUE_SIZE	"queue_size"
+#define VIRTIO_USER_ARG_PACKED_VQ	"packed_vq"
+#define VIRTIO_USER_ARG_IN_ORDER	"in_order"
+
+#define VIRTIO_USER_DEF_QUEUE_SIZE	256
+#define VIRTIO_USER_MAX_QUEUE_SIZE	32768
+
+/* Features which need a control queue, which virtio-user does not have */
+#define VIRTIO_USER_CTRL_FEATURES			\
+	(1ULL << VIRTIO_NET_F_CTRL_VQ |			\
+	 1ULL << VIRTIO_NET_F_CTRL_RX |			\
+	 1ULL << VIRTIO_NET_F_CTRL_VLAN |		\
+	 1ULL << VIRTIO_NET_F_CTRL_RX_EXTRA |		\
+	 1ULL << VIRTIO_NET_F_CTRL_MAC_ADDR |		\
+	 1ULL << VIRTIO_NET_F_CTRL_GUEST_OFFLOADS |	\
+	 1ULL << VIRTIO_NET_F_GUEST_ANNOUNCE |		\
+	 1ULL << VIRTIO_NET_F_MQ)
+
+static const char *valid_args[] = {
+	VIRTIO_USER_ARG_PATH,
+	VIRTIO_USER_ARG_MAC,
+	VIRTIO_USER_ARG_QUEUE_SIZE,
+	VIRTIO_USER_ARG_PACKED_VQ,
+	VIRTIO_USER_ARG_IN_ORDER,
+	NULL
+};
+
+static struct eth_driver virtio_user_pmd = {
+	.pci_drv = {
+		.name = "rte_virtio_user_pmd",
+		.drv_flags = RTE_PCI_DRV_DETACHABLE,
+	},
+	.dev_private_size = sizeof(struct virtio_hw),
+};
+
+#define virtio_user_get_dev(hw) \
+	((struct virtio_user_dev *)(hw)->virtio_user_dev)
+
+static void
+virtio_user_read_dev_config(struct virtio_hw *hw, uint64_t offset,
+			    void *dst, int length)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+	struct virtio_net_config config;
+
+	memcpy(config.mac, dev->mac_addr, ETHER_ADDR_LEN);
+	config.status = VIRTIO_NET_S_LINK_UP;
+	config.max_virtqueue_pairs = 1;
+
+	if (offset + length > sizeof(config)) {
+		RTE_LOG(ERR, PMD, "%s: invalid config read at %"PRIu64"\n",
+			dev->path, offset);
+		return;
+	}
+	memcpy(dst, (uint8_t *)&config + offset, length);
+}
+
+static void
+virtio_user_write_dev_config(struct virtio_hw *hw, uint64_t offset,
+			     void *src, int length)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+
+	/* Only the MAC address is writable */
+	if (offset + length > ETHER_ADDR_LEN) {
+		RTE_LOG(ERR, PMD, "%s: invalid config write at %"PRIu64"\n",
+			dev->path, offset);
+		return;
+	}
+	memcpy(dev->mac_addr + offset, src, length);
+}
+
+static uint8_t
+virtio_user_get_status(struct virtio_hw *hw)
+{
+	return virtio_user_get_dev(hw)->status;
+}
+
+static void
+virtio_user_set_status(struct virtio_hw *hw, uint8_t status)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+
+	if ((status & VIRTIO_CONFIG_STATUS_DRIVER_OK) && !dev->started) {
+		if (virtio_user_start_device(dev) < 0)
+			status |= VIRTIO_CONFIG_STATUS_FAILED;
+	} else if (status == VIRTIO_CONFIG_STATUS_RESET && dev->started) {
+		virtio_user_stop_device(dev);
+	}
+
+	dev->status = status;
+}
+
+static uint64_t
+virtio_user_get_features(struct virtio_hw *hw)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+
+	/* The MAC address and the link status are emulated */
+	return (dev->device_features & ~VIRTIO_USER_CTRL_FEATURES) |
+		1ULL << VIRTIO_NET_F_MAC | 1ULL << VIRTIO_NET_F_STATUS;
+}
+
+static void
+virtio_user_set_features(struct virtio_hw *hw, uint64_t features)
+{
+	virtio_user_get_dev(hw)->features = features;
+}
+
+static uint8_t
+virtio_user_get_isr(struct virtio_hw *hw __rte_unused)
+{
+	/* No interrupt, the link is up as long as the backend is there */
+	return 0;
+}
+
+static uint16_t
+virtio_user_set_config_irq(struct virtio_hw *hw __rte_unused,
+			   uint16_t vec __rte_unused)
+{
+	return VIRTIO_MSI_NO_VECTOR;
+}
+
+static uint16_t
+virtio_user_get_queue_num(struct virtio_hw *hw, uint16_t queue_id)
+{
+	if (queue_id >= VIRTIO_USER_MAX_VQ)
+		return 0;
+	return virtio_user_get_dev(hw)->queue_size;
+}
+
+static void
+virtio_user_setup_queue(struct virtio_hw *hw, struct virtqueue *vq)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+	struct vring *vr = &dev->vrings[vq->vq_queue_index];
+	struct vring_packed vr_packed;
+
+	/*
+	 * The rings are handed to the backend when the driver is OK. The
+	 * event suppression areas of a packed ring go in place of the avail
+	 * and used rings.
+	 */
+	if (vtpci_packed_queue(hw)) {
+		vring_packed_init(&vr_packed, vq->vq_nentries,
+				  vq->vq_ring_virt_mem, VIRTIO_PCI_VRING_ALIGN);
+		vr->num = vr_packed.num;
+		vr->desc = (void *)vr_packed.desc;
+		vr->avail = (void *)vr_packed.driver;
+		vr->used = (void *)vr_packed.device;
+	} else {
+		vring_init(vr, vq->vq_nentries, vq->vq_ring_virt_mem,
+			   VIRTIO_PCI_VRING_ALIGN);
+	}
+}
+
+static void
+virtio_user_del_queue(struct virtio_hw *hw __rte_unused,
+		      struct virtqueue *vq __rte_unused)
+{
+	/* The backend let go of the rings when the device was reset */
+}
+
+static void
+virtio_user_notify_queue(struct virtio_hw *hw, struct virtqueue *vq)
+{
+	struct virtio_user_dev *dev = virtio_user_get_dev(hw);
+	uint64_t buf = 1;
+
+	if (write(dev->kickfds[vq->vq_queue_index], &buf, sizeof(buf)) < 0)
+		PMD_DRV_LOG(ERR, "failed to kick backend: %s\n",
+			    strerror(errno));
+}
+
+static const struct virtio_pci_ops virtio_user_ops = {
+	.read_dev_cfg	= virtio_user_read_dev_config,
+	.write_dev_cfg	= virtio_user_write_dev_config,
+	.get_status	= virtio_user_get_status,
+	.set_status	= virtio_user_set_status,
+	.get_features	= virtio_user_get_features,
+	.set_features	= virtio_user_set_features,
+	.get_isr	= virtio_user_get_isr,
+	.set_config_irq	= virtio_user_set_config_irq,
+	.get_queue_num	= virtio_user_get_queue_num,
+	.setup_queue	= virtio_user_setup_queue,
+	.del_queue	= virtio_user_del_queue,
+	.notify_queue	= virtio_user_notify_queue,
+};
+
+static int
+get_string_arg(const char *key __rte_unused,
+	       const char *value, void *extra_args)
+{
+	*(const char **)extra_args = value;
+	return 0;
+}
+
+static int
+get_integer_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	char *end;
+
+	errno = 0;
+	*(uint64_t *)extra_args = strtoull(value, &end, 0);
+	if (errno != 0 || *value == '\0' || *end != '\0')
+		return -1;
+	return 0;
+}
+
+static int
+parse_mac(const char *value, uint8_t *mac)
+{
+	char c;
+
+	if (sscanf(value, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx%c",
+		   &mac[0], &mac[1], &mac[2],
+		   &mac[3], &mac[4], &mac[5], &c) != ETHER_ADDR_LEN)
+		return -1;
+	return 0;
+}
+
+static void
+virtio_user_eth_dev_free(struct rte_eth_dev *eth_dev)
+{
+	struct virtio_hw *hw = eth_dev->data->dev_private;
+
+	rte_free(hw->virtio_user_dev);
+	rte_free(hw);
+	rte_free(eth_dev->pci_dev);
+	rte_eth_dev_release_port(eth_dev);
+}
+
+static struct rte_eth_dev *
+virtio_user_eth_dev_alloc(const char *name)
+{
+	struct rte_eth_dev *eth_dev;
+	struct rte_pci_device *pci_dev;
+	struct virtio_user_dev *dev;
+	struct virtio_hw *hw;
+	int socket_id = rte_socket_id();
+
+	pci_dev = rte_zmalloc_socket(name, sizeof(*pci_dev), 0, socket_id);
+	hw = rte_zmalloc_socket(name, sizeof(*hw), 0, socket_id);
+	dev = rte_zmalloc_socket(name, sizeof(*dev), 0, socket_id);
+	if (pci_dev == NULL || hw == NULL || dev == NULL)
+		goto error;
+
+	eth_dev = rte_eth_dev_allocate(name, RTE_ETH_DEV_VIRTUAL);
+	if (eth_dev == NULL)
+		goto error;
+
+	/*
+	 * Like other virtual PMDs, use a dummy PCI device for the NUMA
+	 * node. Its driver has no RTE_PCI_DRV_INTR_LSC, so the PCI
+	 * interrupt paths of the driver are left alone.
+	 */
+	pci_dev->numa_node = socket_id;
+	pci_dev->driver = &virtio_user_pmd.pci_drv;
+
+	hw->vtpci_ops = &virtio_user_ops;
+	hw->virtio_user_dev = dev;
+
+	eth_dev->data->dev_private = hw;
+	eth_dev->pci_dev = pci_dev;
+	eth_dev->driver = &virtio_user_pmd;
+
+	return eth_dev;
+
+error:
+	rte_free(dev);
+	rte_free(hw);
+	rte_free(pci_dev);
+	return NULL;
+}
+
+static int
+virtio_user_pmd_devinit(const char *name, const char *params)
+{
+	struct rte_kvargs *kvlist;
+	struct rte_eth_dev *eth_dev;
+	struct virtio_hw *hw;
+	const char *path = NULL;
+	const char *mac = NULL;
+	uint64_t queue_size = VIRTIO_USER_DEF_QUEUE_SIZE;
+	uint64_t packed_vq = 1, in_order = 1;
+	uint8_t mac_addr[ETHER_ADDR_LEN];
+	int ret = -1;
+
+	RTE_LOG(INFO, PMD, "Initializing virtio-user for %s\n", name);
+
+	kvlist = rte_kvargs_parse(params, valid_args);
+	if (kvlist == NULL) {
+		RTE_LOG(ERR, PMD, "%s: invalid parameters\n", name);
+		return -1;
+	}
+
+	if (rte_kvargs_count(kvlist, VIRTIO_USER_ARG_PATH) != 1) {
+		RTE_LOG(ERR, PMD, "%s: one %s=<vhost-user socket> is needed\n",
+			name, VIRTIO_USER_ARG_PATH);
+		goto end;
+	}
+	rte_kvargs_process(kvlist, VIRTIO_USER_ARG_PATH,
+			   &get_string_arg, &path);
+
+	if (rte_kvargs_count(kvlist, VIRTIO_USER_ARG_MAC) == 1) {
+		rte_kvargs_process(kvlist, VIRTIO_USER_ARG_MAC,
+				   &get_string_arg, &mac);
+		if (parse_mac(mac, mac_addr) < 0) {
+			RTE_LOG(ERR, PMD, "%s: invalid MAC address %s\n",
+				name, mac);
+			goto end;
+		}
+	} else {
+		eth_random_addr(mac_addr);
+	}
+
+	if (rte_kvargs_count(kvlist, VIRTIO_USER_ARG_QUEUE_SIZE) == 1) {
+		if (rte_kvargs_process(kvlist, VIRTIO_USER_ARG_QUEUE_SIZE,
+				       &get_integer_arg, &queue_size) < 0 ||
+		    !rte_is_power_of_2(queue_size) ||
+		    queue_size > VIRTIO_USER_MAX_QUEUE_SIZE) {
+			RTE_LOG(ERR, PMD, "%s: invalid queue size\n", name);
+			goto end;
+		}
+	}
+
+	/*
+	 * The ring layouts are used when the backend offers them, unless
+	 * turned off here, e.g. to compare them.
+	 */
+	if ((rte_kvargs_count(kvlist, VIRTIO_USER_ARG_PACKED_VQ) == 1 &&
+	     rte_kvargs_process(kvlist, VIRTIO_USER_ARG_PACKED_VQ,
+				&get_integer_arg, &packed_vq) < 0) ||
+	    (rte_kvargs_count(kvlist, VIRTIO_USER_ARG_IN_ORDER) == 1 &&
+	     rte_kvargs_process(kvlist, VIRTIO_USER_ARG_IN_ORDER,
+				&get_integer_arg, &in_order) < 0)) {
+		RTE_LOG(ERR, PMD, "%s: invalid %s or %s\n", name,
+			VIRTIO_USER_ARG_PACKED_VQ, VIRTIO_USER_ARG_IN_ORDER);
+		goto end;
+	}
+
+	eth_dev = virtio_user_eth_dev_alloc(name);
+	if (eth_dev == NULL) {
+		RTE_LOG(ERR, PMD, "%s: cannot allocate device\n", name);
+		goto end;
+	}
+
+	hw = eth_dev->data->dev_private;
+	memcpy(virtio_user_get_dev(hw)->mac_addr, mac_addr, ETHER_ADDR_LEN);
+
+	if (virtio_user_dev_init(hw->virtio_user_dev, path,
+				 (uint32_t)queue_size) < 0) {
+		virtio_user_eth_dev_free(eth_dev);
+		goto end;
+	}
+	if (!packed_vq)
+		virtio_user_get_dev(hw)->device_features &=
+			~(1ULL << VIRTIO_F_RING_PACKED);
+	if (!in_order)
+		virtio_user_get_dev(hw)->device_features &=
+			~(1ULL << VIRTIO_F_IN_ORDER);
+
+	if (eth_virtio_dev_init(eth_dev) < 0) {
+		RTE_LOG(ERR, PMD, "%s: virtio device init failed\n", name);
+		virtio_user_dev_uninit(hw->virtio_user_dev);
+		virtio_user_eth_dev_free(eth_dev);
+		goto end;
+	}
+
+	ret = 0;
+
+end:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int
+virtio_user_pmd_devuninit(const char *name)
+{
+	struct rte_eth_dev *eth_dev;
+	struct virtio_hw *hw;
+
+	if (name == NULL)
+		return -EINVAL;
+
+	RTE_LOG(INFO, PMD, "Un-Initializing virtio-user for %s\n", name);
+
+	eth_dev = rte_eth_dev_allocated(name);
+	if (eth_dev == NULL)
+		return -ENODEV;
+
+	hw = eth_dev->data->dev_private;
+	eth_virtio_dev_uninit(eth_dev);
+	virtio_user_dev_uninit(hw->virtio_user_dev);
+	virtio_user_eth_dev_free(eth_dev);
+
+	return 0;
+}
+
+static struct rte_driver virtio_user_driver = {
+	.name = "eth_virtio_user",
+	.type = PMD_VDEV,
+	.init = virtio_user_pmd_devinit,
+	.uninit = virtio_user_pmd_devuninit,
+};
+
+PMD_REGISTER_DRIVER(virtio_user_driver);
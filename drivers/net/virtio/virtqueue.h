@@ -68,8 +68,16 @@ struct rte_mbuf;
 
 #define VIRTQUEUE_MAX_NAME_SZ 32
 
-#define RTE_MBUF_DATA_DMA_ADDR(mb) \
-	(uint64_t) ((mb)->buf_physaddr + (mb)->data_off)
+/*
+ * A virtio-user device shares our address space with the vhost backend,
+ * so buffers are handed over by virtual rather than physical address.
+ */
+#define VIRTIO_MBUF_ADDR(mb, vq) \
+	((vq)->hw->virtio_user_dev ? \
+	 (uint64_t)(uintptr_t)(mb)->buf_addr : (uint64_t)(mb)->buf_physaddr)
+
+#define VIRTIO_MBUF_DATA_DMA_ADDR(mb, vq) \
+	(VIRTIO_MBUF_ADDR(mb, vq) + (mb)->data_off)
 
 #define VTNET_SQ_RQ_QUEUE_IDX 0
 #define VTNET_SQ_TQ_QUEUE_IDX 1
@@ -172,6 +180,13 @@ struct virtqueue {
 	phys_addr_t vq_ring_mem;          /**< physical address of vring */
 
 	struct vring vq_ring;    /**< vring keeping desc, used and avail */
+	struct vring_packed vq_ring_packed; /**< same memory, packed layout */
+	/**
+	 * Packed ring only: AVAIL/USED flags marking a descriptor available
+	 * in the current lap of the driver, and the lap of the device.
+	 */
+	uint16_t    vq_packed_flags;
+	uint8_t     vq_used_wrap;
 	uint16_t    vq_free_cnt; /**< num of desc available */
 	uint16_t    vq_nentries; /**< vring desc numbers */
 	uint16_t    vq_free_thresh; /**< free threshold */
@@ -189,6 +204,7 @@ struct virtqueue {
 	uint16_t vq_used_cons_idx;
 	uint16_t vq_avail_idx;
 	phys_addr_t virtio_net_hdr_mem; /**< hdr for each xmit packet */
+	uint64_t    mbuf_initializer; /**< value to init mbufs on vector RX */
 
 	/* Statistics */
 	uint64_t	packets;
@@ -198,6 +214,7 @@ struct virtqueue {
 	struct vq_desc_extra {
 		void              *cookie;
 		uint16_t          ndescs;
+		uint16_t          next; /**< free buffer ids, packed ring */
 	} vq_descx[0];
 };
 
@@ -209,6 +226,13 @@ struct virtqueue {
 
 #define VIRTIO_NET_CTRL_MAC_ADDR_SET         1
 
+/*
+ * Control guest offloads: the host is told which of the negotiated
+ * VIRTIO_NET_F_GUEST_* offloads to actually use, as a 64-bit feature mask.
+ */
+#define VIRTIO_NET_CTRL_GUEST_OFFLOADS       5
+#define VIRTIO_NET_CTRL_GUEST_OFFLOADS_SET   0
+
 /**
  * This is the first element of the scatter-gather list.  If you don't
  * specify GSO or CSUM features, you can simply ignore the header.
@@ -287,6 +311,23 @@ virtqueue_kick_prepare(struct virtqueue *vq)
 	return !(vq->vq_ring.used->flags & VRING_USED_F_NO_NOTIFY);
 }
 
+static inline int
+virtqueue_kick_prepare_packed(struct virtqueue *vq)
+{
+	return vq->vq_ring_packed.device->desc_event_flags !=
+		VRING_PACKED_EVENT_F_DISABLE;
+}
+
+/* Has the device marked the descriptor used in the lap of wrap counter? */
+static inline int
+desc_is_used(const struct vring_packed_desc *desc, uint8_t wrap)
+{
+	uint16_t flags = *(const volatile uint16_t *)&desc->flags;
+
+	return !!(flags & VRING_PACKED_DESC_F_AVAIL) == wrap &&
+		!!(flags & VRING_PACKED_DESC_F_USED) == wrap;
+}
+
 static inline void
 virtqueue_notify(struct virtqueue *vq)
 {
@@ -295,7 +336,7 @@ virtqueue_notify(struct virtqueue *vq)
 	 * For virtio on IA, the notificaiton is through io port operation
 	 * which is a serialization instruction itself.
 	 */
-	VIRTIO_WRITE_REG_2(vq->hw, VIRTIO_PCI_QUEUE_NOTIFY, vq->vq_queue_index);
+	vq->hw->vtpci_ops->notify_queue(vq->hw, vq);
 }
 
 #ifdef RTE_LIBRTE_VIRTIO_DEBUG_DUMP
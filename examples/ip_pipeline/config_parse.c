@@ -169,10 +169,14 @@ struct app_pktq_source_params default_source_params = {
 	.parsed = 0,
 	.mempool_id = 0,
 	.burst = 32,
+	.file_name = NULL,
+	.n_bytes_per_pkt = 0,
 };
 
 struct app_pktq_sink_params default_sink_params = {
 	.parsed = 0,
+	.file_name = NULL,
+	.n_pkts_to_dump = 0,
 };
 
 struct app_msgq_params default_msgq_params = {
@@ -1556,6 +1560,61 @@ parse_source(struct app_params *app,
 			ret = 0;
 		} else if (strcmp(ent->name, "burst") == 0)
 			ret = parser_read_uint32(&param->burst, ent->value);
+		else if (strcmp(ent->name, "pcap_file_rd") == 0) {
+			param->file_name = strdup(ent->value);
+			ret = (param->file_name == NULL) ? -ENOMEM : 0;
+		} else if (strcmp(ent->name, "pcap_bytes_rd_per_pkt") == 0)
+			ret = parser_read_uint32(&param->n_bytes_per_pkt,
+				ent->value);
+
+		APP_CHECK(ret != -ESRCH,
+			"CFG: [%s] entry '%s': unknown entry\n",
+			section_name,
+			ent->name);
+		APP_CHECK(ret == 0,
+			"CFG: [%s] entry '%s': Invalid value '%s'\n",
+			section_name,
+			ent->name,
+			ent->value);
+	}
+
+	free(entries);
+}
+
+static void
+parse_sink(struct app_params *app,
+	const char *section_name,
+	struct rte_cfgfile *cfg)
+{
+	struct app_pktq_sink_params *param;
+	struct rte_cfgfile_entry *entries;
+	int n_entries, ret, i;
+	ssize_t param_idx;
+
+	n_entries = rte_cfgfile_section_num_entries(cfg, section_name);
+	PARSE_ERROR_SECTION_NO_ENTRIES((n_entries > 0), section_name);
+
+	entries = malloc(n_entries * sizeof(struct rte_cfgfile_entry));
+	PARSE_ERROR_MALLOC(entries != NULL);
+
+	rte_cfgfile_section_entries(cfg, section_name, entries, n_entries);
+
+	param_idx = APP_PARAM_ADD(app->sink_params, section_name);
+	PARSER_PARAM_ADD_CHECK(param_idx, app->sink_params, section_name);
+
+	param = &app->sink_params[param_idx];
+	param->parsed = 1;
+
+	for (i = 0; i < n_entries; i++) {
+		struct rte_cfgfile_entry *ent = &entries[i];
+
+		ret = -ESRCH;
+		if (strcmp(ent->name, "pcap_file_wr") == 0) {
+			param->file_name = strdup(ent->value);
+			ret = (param->file_name == NULL) ? -ENOMEM : 0;
+		} else if (strcmp(ent->name, "pcap_n_pkt_wr") == 0)
+			ret = parser_read_uint32(&param->n_pkts_to_dump,
+				ent->value);
 
 		APP_CHECK(ret != -ESRCH,
 			"CFG: [%s] entry '%s': unknown entry\n",
@@ -1730,6 +1789,7 @@ static const struct config_section cfg_file_scheme[] = {
 	{"SWQ", 1, parse_swq},
 	{"TM", 1, parse_tm},
 	{"SOURCE", 1, parse_source},
+	{"SINK", 1, parse_sink},
 	{"MSGQ-REQ-PIPELINE", 1, parse_msgq_req_pipeline},
 	{"MSGQ-RSP-PIPELINE", 1, parse_msgq_rsp_pipeline},
 	{"MSGQ", 1, parse_msgq},
@@ -2112,6 +2172,36 @@ save_source_params(struct app_params *app, FILE *f)
 			"mempool",
 			app->mempool_params[p->mempool_id].name);
 		fprintf(f, "%s = %" PRIu32 "\n", "burst", p->burst);
+
+		if (p->file_name) {
+			fprintf(f, "%s = %s\n", "pcap_file_rd", p->file_name);
+			fprintf(f, "%s = %" PRIu32 "\n", "pcap_bytes_rd_per_pkt",
+				p->n_bytes_per_pkt);
+		}
+
+		fputc('\n', f);
+	}
+}
+
+static void
+save_sink_params(struct app_params *app, FILE *f)
+{
+	struct app_pktq_sink_params *p;
+	size_t i, count;
+
+	count = RTE_DIM(app->sink_params);
+	for (i = 0; i < count; i++) {
+		p = &app->sink_params[i];
+		if (!APP_PARAM_VALID(p))
+			continue;
+
+		fprintf(f, "[%s]\n", p->name);
+		if (p->file_name) {
+			fprintf(f, "%s = %s\n", "pcap_file_wr", p->file_name);
+			fprintf(f, "%s = %" PRIu32 "\n", "pcap_n_pkt_wr",
+				p->n_pkts_to_dump);
+		}
+
 		fputc('\n', f);
 	}
 }
@@ -2294,6 +2384,7 @@ app_config_save(struct app_params *app, const char *file_name)
 	save_swq_params(app, file);
 	save_tm_params(app, file);
 	save_source_params(app, file);
+	save_sink_params(app, file);
 	save_msgq_params(app, file);
 
 	fclose(file);
@@ -917,12 +917,22 @@ app_init_swq(struct app_params *app)
 	for (i = 0; i < app->n_pktq_swq; i++) {
 		struct app_pktq_swq_params *p = &app->swq_params[i];
 
+		uint32_t n_readers = app_swq_get_readers(app, p);
+		uint32_t n_writers = app_swq_get_writers(app, p);
+		unsigned flags = 0;
+
+		/* Shared SWQs use the multi-producer/consumer ring mode */
+		if (n_writers == 1)
+			flags |= RING_F_SP_ENQ;
+		if (n_readers == 1)
+			flags |= RING_F_SC_DEQ;
+
 		APP_LOG(app, HIGH, "Initializing %s...", p->name);
 		app->swq[i] = rte_ring_create(
 				p->name,
 				p->size,
 				p->cpu_socket_id,
-				RING_F_SP_ENQ | RING_F_SC_DEQ);
+				flags);
 
 		if (app->swq[i] == NULL)
 			rte_panic("%s init error\n", p->name);
@@ -1059,7 +1069,10 @@ static void app_pipeline_params_get(struct app_params *app,
 			break;
 		}
 		case APP_PKTQ_IN_SWQ:
-			out->type = PIPELINE_PORT_IN_RING_READER;
+			out->type = (app_swq_get_readers(app,
+				&app->swq_params[in->id]) > 1) ?
+				PIPELINE_PORT_IN_RING_MULTI_READER :
+				PIPELINE_PORT_IN_RING_READER;
 			out->params.ring.ring = app->swq[in->id];
 			out->burst_size = app->swq_params[in->id].burst_read;
 			/* What about frag and ras ports? */
@@ -1073,6 +1086,10 @@ static void app_pipeline_params_get(struct app_params *app,
 			out->type = PIPELINE_PORT_IN_SOURCE;
 			out->params.source.mempool = app->mempool[in->id];
 			out->burst_size = app->source_params[in->id].burst;
+			out->params.source.file_name =
+				app->source_params[in->id].file_name;
+			out->params.source.n_bytes_per_pkt =
+				app->source_params[in->id].n_bytes_per_pkt;
 			break;
 		default:
 			break;
@@ -1122,28 +1139,35 @@ static void app_pipeline_params_get(struct app_params *app,
 			break;
 		}
 		case APP_PKTQ_OUT_SWQ:
-			if (app->swq_params[in->id].dropless == 0) {
+		{
+			struct app_pktq_swq_params *p_swq =
+				&app->swq_params[in->id];
+			uint32_t is_multi =
+				(app_swq_get_writers(app, p_swq) > 1);
+
+			if (p_swq->dropless == 0) {
 				struct rte_port_ring_writer_params *params =
 					&out->params.ring;
 
-				out->type = PIPELINE_PORT_OUT_RING_WRITER;
+				out->type = (is_multi) ?
+					PIPELINE_PORT_OUT_RING_MULTI_WRITER :
+					PIPELINE_PORT_OUT_RING_WRITER;
 				params->ring = app->swq[in->id];
-				params->tx_burst_sz =
-					app->swq_params[in->id].burst_write;
+				params->tx_burst_sz = p_swq->burst_write;
 			} else {
 				struct rte_port_ring_writer_nodrop_params
 					*params = &out->params.ring_nodrop;
 
-				out->type =
+				out->type = (is_multi) ?
+					PIPELINE_PORT_OUT_RING_MULTI_WRITER_NODROP :
 					PIPELINE_PORT_OUT_RING_WRITER_NODROP;
 				params->ring = app->swq[in->id];
-				params->tx_burst_sz =
-					app->swq_params[in->id].burst_write;
-				params->n_retries =
-					app->swq_params[in->id].n_retries;
+				params->tx_burst_sz = p_swq->burst_write;
+				params->n_retries = p_swq->n_retries;
 			}
 			/* What about frag and ras ports? */
 			break;
+		}
 		case APP_PKTQ_OUT_TM: {
 			struct rte_port_sched_writer_params *params =
 				&out->params.sched;
@@ -1156,6 +1180,10 @@ static void app_pipeline_params_get(struct app_params *app,
 		}
 		case APP_PKTQ_OUT_SINK:
 			out->type = PIPELINE_PORT_OUT_SINK;
+			out->params.sink.file_name =
+				app->sink_params[in->id].file_name;
+			out->params.sink.max_n_pkts =
+				app->sink_params[in->id].n_pkts_to_dump;
 			break;
 		default:
 			break;
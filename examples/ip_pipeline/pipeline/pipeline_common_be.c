@@ -164,6 +164,78 @@ pipeline_msg_req_port_in_disable_handler(struct pipeline *p,
 	return rsp;
 }
 
+void *
+pipeline_msg_req_profile_port_in_handler(struct pipeline *p,
+	void *msg)
+{
+	struct pipeline_stats_msg_req *req = msg;
+	struct pipeline_profile_port_in_msg_rsp *rsp = msg;
+	uint32_t port_id;
+
+	/* Check request */
+	if (req->id >= p->n_ports_in) {
+		rsp->status = -1;
+		return rsp;
+	}
+	port_id = p->port_in_id[req->id];
+
+	/* Process request */
+	rsp->status = rte_pipeline_port_in_profile_read(p->p,
+		port_id,
+		&rsp->profile,
+		1);
+
+	return rsp;
+}
+
+void *
+pipeline_msg_req_profile_port_out_handler(struct pipeline *p,
+	void *msg)
+{
+	struct pipeline_stats_msg_req *req = msg;
+	struct pipeline_profile_port_out_msg_rsp *rsp = msg;
+	uint32_t port_id;
+
+	/* Check request */
+	if (req->id >= p->n_ports_out) {
+		rsp->status = -1;
+		return rsp;
+	}
+	port_id = p->port_out_id[req->id];
+
+	/* Process request */
+	rsp->status = rte_pipeline_port_out_profile_read(p->p,
+		port_id,
+		&rsp->profile,
+		1);
+
+	return rsp;
+}
+
+void *
+pipeline_msg_req_profile_table_handler(struct pipeline *p,
+	void *msg)
+{
+	struct pipeline_stats_msg_req *req = msg;
+	struct pipeline_profile_table_msg_rsp *rsp = msg;
+	uint32_t table_id;
+
+	/* Check request */
+	if (req->id >= p->n_tables) {
+		rsp->status = -1;
+		return rsp;
+	}
+	table_id = p->table_id[req->id];
+
+	/* Process request */
+	rsp->status = rte_pipeline_table_profile_read(p->p,
+		table_id,
+		&rsp->profile,
+		1);
+
+	return rsp;
+}
+
 void *
 pipeline_msg_req_invalid_handler(__rte_unused struct pipeline *p,
 	void *msg)
@@ -49,6 +49,9 @@ enum pipeline_msg_req_type {
 	PIPELINE_MSG_REQ_STATS_TABLE,
 	PIPELINE_MSG_REQ_PORT_IN_ENABLE,
 	PIPELINE_MSG_REQ_PORT_IN_DISABLE,
+	PIPELINE_MSG_REQ_PROFILE_PORT_IN,
+	PIPELINE_MSG_REQ_PROFILE_PORT_OUT,
+	PIPELINE_MSG_REQ_PROFILE_TABLE,
 	PIPELINE_MSG_REQ_CUSTOM,
 	PIPELINE_MSG_REQS
 };
@@ -150,12 +153,30 @@ struct pipeline_stats_table_msg_rsp {
 	struct rte_pipeline_table_stats stats;
 };
 
+struct pipeline_profile_port_in_msg_rsp {
+	int status;
+	struct rte_pipeline_port_in_profile profile;
+};
+
+struct pipeline_profile_port_out_msg_rsp {
+	int status;
+	struct rte_pipeline_port_out_profile profile;
+};
+
+struct pipeline_profile_table_msg_rsp {
+	int status;
+	struct rte_pipeline_table_profile profile;
+};
+
 void *pipeline_msg_req_ping_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_stats_port_in_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_stats_port_out_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_stats_table_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_port_in_enable_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_port_in_disable_handler(struct pipeline *p, void *msg);
+void *pipeline_msg_req_profile_port_in_handler(struct pipeline *p, void *msg);
+void *pipeline_msg_req_profile_port_out_handler(struct pipeline *p, void *msg);
+void *pipeline_msg_req_profile_table_handler(struct pipeline *p, void *msg);
 void *pipeline_msg_req_invalid_handler(struct pipeline *p, void *msg);
 
 int pipeline_msg_req_handle(struct pipeline *p);
@@ -227,6 +227,143 @@ app_pipeline_stats_table(struct app_params *app,
 	return status;
 }
 
+int
+app_pipeline_profile_port_in(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t port_id,
+	struct rte_pipeline_port_in_profile *profile)
+{
+	struct app_pipeline_params *p;
+	struct pipeline_stats_msg_req *req;
+	struct pipeline_profile_port_in_msg_rsp *rsp;
+	int status = 0;
+
+	/* Check input arguments */
+	if ((app == NULL) ||
+		(profile == NULL))
+		return -1;
+
+	APP_PARAM_FIND_BY_ID(app->pipeline_params, "PIPELINE", pipeline_id, p);
+	if ((p == NULL) ||
+		(port_id >= p->n_pktq_in))
+		return -1;
+
+	/* Message buffer allocation */
+	req = app_msg_alloc(app);
+	if (req == NULL)
+		return -1;
+
+	/* Fill in request */
+	req->type = PIPELINE_MSG_REQ_PROFILE_PORT_IN;
+	req->id = port_id;
+
+	/* Send request and wait for response */
+	rsp = app_msg_send_recv(app, pipeline_id, req, MSG_TIMEOUT_DEFAULT);
+	if (rsp == NULL)
+		return -1;
+
+	/* Check response */
+	status = rsp->status;
+	if (status == 0)
+		memcpy(profile, &rsp->profile, sizeof(rsp->profile));
+
+	/* Message buffer free */
+	app_msg_free(app, rsp);
+
+	return status;
+}
+
+int
+app_pipeline_profile_port_out(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t port_id,
+	struct rte_pipeline_port_out_profile *profile)
+{
+	struct app_pipeline_params *p;
+	struct pipeline_stats_msg_req *req;
+	struct pipeline_profile_port_out_msg_rsp *rsp;
+	int status = 0;
+
+	/* Check input arguments */
+	if ((app == NULL) ||
+		(profile == NULL))
+		return -1;
+
+	APP_PARAM_FIND_BY_ID(app->pipeline_params, "PIPELINE", pipeline_id, p);
+	if ((p == NULL) ||
+		(port_id >= p->n_pktq_out))
+		return -1;
+
+	/* Message buffer allocation */
+	req = app_msg_alloc(app);
+	if (req == NULL)
+		return -1;
+
+	/* Fill in request */
+	req->type = PIPELINE_MSG_REQ_PROFILE_PORT_OUT;
+	req->id = port_id;
+
+	/* Send request and wait for response */
+	rsp = app_msg_send_recv(app, pipeline_id, req, MSG_TIMEOUT_DEFAULT);
+	if (rsp == NULL)
+		return -1;
+
+	/* Check response */
+	status = rsp->status;
+	if (status == 0)
+		memcpy(profile, &rsp->profile, sizeof(rsp->profile));
+
+	/* Message buffer free */
+	app_msg_free(app, rsp);
+
+	return status;
+}
+
+int
+app_pipeline_profile_table(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t table_id,
+	struct rte_pipeline_table_profile *profile)
+{
+	struct app_pipeline_params *p;
+	struct pipeline_stats_msg_req *req;
+	struct pipeline_profile_table_msg_rsp *rsp;
+	int status = 0;
+
+	/* Check input arguments */
+	if ((app == NULL) ||
+		(profile == NULL))
+		return -1;
+
+	APP_PARAM_FIND_BY_ID(app->pipeline_params, "PIPELINE", pipeline_id, p);
+	if (p == NULL)
+		return -1;
+
+	/* Message buffer allocation */
+	req = app_msg_alloc(app);
+	if (req == NULL)
+		return -1;
+
+	/* Fill in request */
+	req->type = PIPELINE_MSG_REQ_PROFILE_TABLE;
+	req->id = table_id;
+
+	/* Send request and wait for response */
+	rsp = app_msg_send_recv(app, pipeline_id, req, MSG_TIMEOUT_DEFAULT);
+	if (rsp == NULL)
+		return -1;
+
+	/* Check response */
+	status = rsp->status;
+	if (status == 0)
+		memcpy(profile, &rsp->profile, sizeof(rsp->profile));
+
+	/* Message buffer free */
+	app_msg_free(app, rsp);
+
+	return status;
+}
+
 int
 app_pipeline_port_in_enable(struct app_params *app,
 	uint32_t pipeline_id,
@@ -740,6 +877,280 @@ cmdline_parse_inst_t cmd_stats_table = {
 	},
 };
 
+/*
+ * profile port in
+ */
+
+struct cmd_profile_port_in_result {
+	cmdline_fixed_string_t p_string;
+	uint32_t pipeline_id;
+	cmdline_fixed_string_t profile_string;
+	cmdline_fixed_string_t port_string;
+	cmdline_fixed_string_t in_string;
+	uint32_t port_in_id;
+};
+
+static void
+cmd_profile_port_in_parsed(
+	void *parsed_result,
+	__rte_unused struct cmdline *cl,
+	void *data)
+{
+	struct cmd_profile_port_in_result *params = parsed_result;
+	struct app_params *app = data;
+	struct rte_pipeline_port_in_profile profile;
+	uint32_t i;
+	int status;
+
+	status = app_pipeline_profile_port_in(app,
+			params->pipeline_id,
+			params->port_in_id,
+			&profile);
+
+	if (status != 0) {
+		printf("Command failed\n");
+		return;
+	}
+
+	/* Display profile */
+	printf("Pipeline %" PRIu32 " - profile for input port %" PRIu32 ":\n"
+		"\tEmpty polls: %" PRIu64 "\n",
+		params->pipeline_id,
+		params->port_in_id,
+		profile.n_bursts[0]);
+
+	for (i = 1; i < RTE_PIPELINE_PORT_IN_BURST_HIST_SIZE; i++)
+		printf("\tBursts of %" PRIu32 " .. %" PRIu32 " pkts: %" PRIu64
+			"\n",
+			1U << (i - 1),
+			(i == RTE_PIPELINE_PORT_IN_BURST_HIST_SIZE - 1) ?
+				RTE_PORT_IN_BURST_SIZE_MAX : (1U << i) - 1,
+			profile.n_bursts[i]);
+
+	printf("\tAH calls: %" PRIu64 "\n"
+		"\tAH cycles per call: %" PRIu64 "\n",
+		profile.n_calls_ah,
+		(profile.n_calls_ah) ?
+			profile.n_cycles_ah / profile.n_calls_ah : 0);
+}
+
+cmdline_parse_token_string_t cmd_profile_port_in_p_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_in_result, p_string,
+		"p");
+
+cmdline_parse_token_num_t cmd_profile_port_in_pipeline_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_port_in_result, pipeline_id,
+		UINT32);
+
+cmdline_parse_token_string_t cmd_profile_port_in_profile_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_in_result,
+		profile_string, "profile");
+
+cmdline_parse_token_string_t cmd_profile_port_in_port_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_in_result, port_string,
+		"port");
+
+cmdline_parse_token_string_t cmd_profile_port_in_in_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_in_result, in_string,
+		"in");
+
+cmdline_parse_token_num_t cmd_profile_port_in_port_in_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_port_in_result, port_in_id,
+		UINT32);
+
+cmdline_parse_inst_t cmd_profile_port_in = {
+	.f = cmd_profile_port_in_parsed,
+	.data = NULL,
+	.help_str = "Pipeline input port profile",
+	.tokens = {
+		(void *) &cmd_profile_port_in_p_string,
+		(void *) &cmd_profile_port_in_pipeline_id,
+		(void *) &cmd_profile_port_in_profile_string,
+		(void *) &cmd_profile_port_in_port_string,
+		(void *) &cmd_profile_port_in_in_string,
+		(void *) &cmd_profile_port_in_port_in_id,
+		NULL,
+	},
+};
+
+/*
+ * profile port out
+ */
+
+struct cmd_profile_port_out_result {
+	cmdline_fixed_string_t p_string;
+	uint32_t pipeline_id;
+	cmdline_fixed_string_t profile_string;
+	cmdline_fixed_string_t port_string;
+	cmdline_fixed_string_t out_string;
+	uint32_t port_out_id;
+};
+
+static void
+cmd_profile_port_out_parsed(
+	void *parsed_result,
+	__rte_unused struct cmdline *cl,
+	void *data)
+{
+	struct cmd_profile_port_out_result *params = parsed_result;
+	struct app_params *app = data;
+	struct rte_pipeline_port_out_profile profile;
+	int status;
+
+	status = app_pipeline_profile_port_out(app,
+			params->pipeline_id,
+			params->port_out_id,
+			&profile);
+
+	if (status != 0) {
+		printf("Command failed\n");
+		return;
+	}
+
+	/* Display profile */
+	printf("Pipeline %" PRIu32 " - profile for output port %" PRIu32 ":\n"
+		"\tAH calls: %" PRIu64 "\n"
+		"\tAH cycles per call: %" PRIu64 "\n",
+		params->pipeline_id,
+		params->port_out_id,
+		profile.n_calls_ah,
+		(profile.n_calls_ah) ?
+			profile.n_cycles_ah / profile.n_calls_ah : 0);
+}
+
+cmdline_parse_token_string_t cmd_profile_port_out_p_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_out_result, p_string,
+		"p");
+
+cmdline_parse_token_num_t cmd_profile_port_out_pipeline_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_port_out_result, pipeline_id,
+		UINT32);
+
+cmdline_parse_token_string_t cmd_profile_port_out_profile_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_out_result,
+		profile_string, "profile");
+
+cmdline_parse_token_string_t cmd_profile_port_out_port_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_out_result,
+		port_string, "port");
+
+cmdline_parse_token_string_t cmd_profile_port_out_out_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_port_out_result, out_string,
+		"out");
+
+cmdline_parse_token_num_t cmd_profile_port_out_port_out_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_port_out_result, port_out_id,
+		UINT32);
+
+cmdline_parse_inst_t cmd_profile_port_out = {
+	.f = cmd_profile_port_out_parsed,
+	.data = NULL,
+	.help_str = "Pipeline output port profile",
+	.tokens = {
+		(void *) &cmd_profile_port_out_p_string,
+		(void *) &cmd_profile_port_out_pipeline_id,
+		(void *) &cmd_profile_port_out_profile_string,
+		(void *) &cmd_profile_port_out_port_string,
+		(void *) &cmd_profile_port_out_out_string,
+		(void *) &cmd_profile_port_out_port_out_id,
+		NULL,
+	},
+};
+
+/*
+ * profile table
+ */
+
+struct cmd_profile_table_result {
+	cmdline_fixed_string_t p_string;
+	uint32_t pipeline_id;
+	cmdline_fixed_string_t profile_string;
+	cmdline_fixed_string_t table_string;
+	uint32_t table_id;
+};
+
+static void
+cmd_profile_table_parsed(
+	void *parsed_result,
+	__rte_unused struct cmdline *cl,
+	void *data)
+{
+	struct cmd_profile_table_result *params = parsed_result;
+	struct app_params *app = data;
+	struct rte_pipeline_table_profile profile;
+	uint64_t n_pkts;
+	int status;
+
+	status = app_pipeline_profile_table(app,
+			params->pipeline_id,
+			params->table_id,
+			&profile);
+
+	if (status != 0) {
+		printf("Command failed\n");
+		return;
+	}
+
+	n_pkts = profile.n_pkts_lookup_hit + profile.n_pkts_lookup_miss;
+
+	/* Display profile */
+	printf("Pipeline %" PRIu32 " - profile for table %" PRIu32 ":\n"
+		"\tLookups: %" PRIu64 "\n"
+		"\tLookup cycles per pkt: %" PRIu64 "\n"
+		"\tPkts with lookup hit: %" PRIu64 "\n"
+		"\tPkts with lookup miss: %" PRIu64 "\n"
+		"\tLookup hit AH calls: %" PRIu64 "\n"
+		"\tLookup hit AH cycles per call: %" PRIu64 "\n"
+		"\tLookup miss AH calls: %" PRIu64 "\n"
+		"\tLookup miss AH cycles per call: %" PRIu64 "\n",
+		params->pipeline_id,
+		params->table_id,
+		profile.n_lookups,
+		(n_pkts) ? profile.n_cycles_lookup / n_pkts : 0,
+		profile.n_pkts_lookup_hit,
+		profile.n_pkts_lookup_miss,
+		profile.n_calls_ah_hit,
+		(profile.n_calls_ah_hit) ?
+			profile.n_cycles_ah_hit / profile.n_calls_ah_hit : 0,
+		profile.n_calls_ah_miss,
+		(profile.n_calls_ah_miss) ?
+			profile.n_cycles_ah_miss / profile.n_calls_ah_miss : 0);
+}
+
+cmdline_parse_token_string_t cmd_profile_table_p_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_table_result, p_string,
+		"p");
+
+cmdline_parse_token_num_t cmd_profile_table_pipeline_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_table_result, pipeline_id,
+		UINT32);
+
+cmdline_parse_token_string_t cmd_profile_table_profile_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_table_result,
+		profile_string, "profile");
+
+cmdline_parse_token_string_t cmd_profile_table_table_string =
+	TOKEN_STRING_INITIALIZER(struct cmd_profile_table_result, table_string,
+		"table");
+
+cmdline_parse_token_num_t cmd_profile_table_table_id =
+	TOKEN_NUM_INITIALIZER(struct cmd_profile_table_result, table_id,
+		UINT32);
+
+cmdline_parse_inst_t cmd_profile_table = {
+	.f = cmd_profile_table_parsed,
+	.data = NULL,
+	.help_str = "Pipeline table profile",
+	.tokens = {
+		(void *) &cmd_profile_table_p_string,
+		(void *) &cmd_profile_table_pipeline_id,
+		(void *) &cmd_profile_table_profile_string,
+		(void *) &cmd_profile_table_table_string,
+		(void *) &cmd_profile_table_table_id,
+		NULL,
+	},
+};
+
 /*
  * port in enable
  */
@@ -1303,6 +1714,9 @@ static cmdline_parse_ctx_t pipeline_common_cmds[] = {
 	(cmdline_parse_inst_t *) &cmd_stats_port_in,
 	(cmdline_parse_inst_t *) &cmd_stats_port_out,
 	(cmdline_parse_inst_t *) &cmd_stats_table,
+	(cmdline_parse_inst_t *) &cmd_profile_port_in,
+	(cmdline_parse_inst_t *) &cmd_profile_port_out,
+	(cmdline_parse_inst_t *) &cmd_profile_table,
 	(cmdline_parse_inst_t *) &cmd_port_in_enable,
 	(cmdline_parse_inst_t *) &cmd_port_in_disable,
 	NULL,
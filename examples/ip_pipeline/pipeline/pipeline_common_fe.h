@@ -198,6 +198,24 @@ app_pipeline_stats_table(struct app_params *app,
 	uint32_t table_id,
 	struct rte_pipeline_table_stats *stats);
 
+int
+app_pipeline_profile_port_in(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t port_id,
+	struct rte_pipeline_port_in_profile *profile);
+
+int
+app_pipeline_profile_port_out(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t port_id,
+	struct rte_pipeline_port_out_profile *profile);
+
+int
+app_pipeline_profile_table(struct app_params *app,
+	uint32_t pipeline_id,
+	uint32_t table_id,
+	struct rte_pipeline_table_profile *profile);
+
 int
 app_pipeline_port_in_enable(struct app_params *app,
 	uint32_t pipeline_id,
@@ -75,6 +75,12 @@ static pipeline_msg_req_handler handlers[] = {
 		pipeline_msg_req_port_in_enable_handler,
 	[PIPELINE_MSG_REQ_PORT_IN_DISABLE] =
 		pipeline_msg_req_port_in_disable_handler,
+	[PIPELINE_MSG_REQ_PROFILE_PORT_IN] =
+		pipeline_msg_req_profile_port_in_handler,
+	[PIPELINE_MSG_REQ_PROFILE_PORT_OUT] =
+		pipeline_msg_req_profile_port_out_handler,
+	[PIPELINE_MSG_REQ_PROFILE_TABLE] =
+		pipeline_msg_req_profile_table_handler,
 	[PIPELINE_MSG_REQ_CUSTOM] =
 		pipeline_routing_msg_req_custom_handler,
 };
@@ -63,6 +63,7 @@ eal_short_options[] =
 	"m:" /* memory size */
 	"n:" /* memory channels */
 	"r:" /* memory ranks */
+	"s:" /* service coremask */
 	"v"  /* version */
 	"w:" /* pci-whitelist */
 	;
@@ -84,6 +85,7 @@ eal_long_options[] = {
 	{OPT_PCI_BLACKLIST,     1, NULL, OPT_PCI_BLACKLIST_NUM    },
 	{OPT_PCI_WHITELIST,     1, NULL, OPT_PCI_WHITELIST_NUM    },
 	{OPT_PROC_TYPE,         1, NULL, OPT_PROC_TYPE_NUM        },
+	{OPT_SERVICE_COREMASK,  1, NULL, OPT_SERVICE_COREMASK_NUM },
 	{OPT_SOCKET_MEM,        1, NULL, OPT_SOCKET_MEM_NUM       },
 	{OPT_SYSLOG,            1, NULL, OPT_SYSLOG_NUM           },
 	{OPT_VDEV,              1, NULL, OPT_VDEV_NUM             },
@@ -114,6 +116,9 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	/* zero out hugedir descriptors */
 	for (i = 0; i < MAX_HUGEPAGE_SIZES; i++)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
+	/* no service lcore */
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		internal_cfg->service_lcore[i] = 0;
 	internal_cfg->base_virtaddr = 0;
 
 	internal_cfg->syslog_facility = LOG_DAEMON;
@@ -134,11 +139,6 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	internal_cfg->create_uio_dev = 0;
 }
 
-/*
- * Parse the coremask given as argument (hexadecimal string) and fill
- * the global configuration (core role and core count) with the parsed
- * value.
- */
 static int xdigit2val(unsigned char c)
 {
 	int val;
@@ -152,12 +152,16 @@ static int xdigit2val(unsigned char c)
 	return val;
 }
 
+/*
+ * Parse a hexadecimal lcore mask: set lcores[idx] to 1 for each bit set in
+ * the mask and to 0 otherwise. Return the number of bits set, or -1 if the
+ * mask is invalid.
+ */
 static int
-eal_parse_coremask(const char *coremask)
+eal_parse_hexmask(const char *coremask, uint8_t lcores[RTE_MAX_LCORE])
 {
-	struct rte_config *cfg = rte_eal_get_configuration();
 	int i, j, idx = 0;
-	unsigned count = 0;
+	int count = 0;
 	char c;
 	int val;
 
@@ -177,6 +181,8 @@ eal_parse_coremask(const char *coremask)
 	if (i == 0)
 		return -1;
 
+	memset(lcores, 0, RTE_MAX_LCORE);
+
 	for (i = i - 1; i >= 0 && idx < RTE_MAX_LCORE; i--) {
 		c = coremask[i];
 		if (isxdigit(c) == 0) {
@@ -187,35 +193,71 @@ eal_parse_coremask(const char *coremask)
 		for (j = 0; j < BITS_PER_HEX && idx < RTE_MAX_LCORE; j++, idx++)
 		{
 			if ((1 << j) & val) {
-				if (!lcore_config[idx].detected) {
-					RTE_LOG(ERR, EAL, "lcore %u "
-					        "unavailable\n", idx);
-					return -1;
-				}
-				cfg->lcore_role[idx] = ROLE_RTE;
-				lcore_config[idx].core_index = count;
+				lcores[idx] = 1;
 				count++;
-			} else {
-				cfg->lcore_role[idx] = ROLE_OFF;
-				lcore_config[idx].core_index = -1;
 			}
 		}
 	}
 	for (; i >= 0; i--)
 		if (coremask[i] != '0')
 			return -1;
-	for (; idx < RTE_MAX_LCORE; idx++) {
-		cfg->lcore_role[idx] = ROLE_OFF;
-		lcore_config[idx].core_index = -1;
-	}
-	if (count == 0)
+	return count;
+}
+
+/*
+ * Parse the coremask given as argument (hexadecimal string) and fill
+ * the global configuration (core role and core count) with the parsed
+ * value.
+ */
+static int
+eal_parse_coremask(const char *coremask)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	uint8_t lcores[RTE_MAX_LCORE];
+	unsigned count = 0;
+	int idx;
+
+	if (eal_parse_hexmask(coremask, lcores) <= 0)
 		return -1;
+
+	for (idx = 0; idx < RTE_MAX_LCORE; idx++) {
+		if (lcores[idx]) {
+			if (!lcore_config[idx].detected) {
+				RTE_LOG(ERR, EAL, "lcore %u "
+				        "unavailable\n", idx);
+				return -1;
+			}
+			cfg->lcore_role[idx] = ROLE_RTE;
+			lcore_config[idx].core_index = count;
+			count++;
+		} else {
+			cfg->lcore_role[idx] = ROLE_OFF;
+			lcore_config[idx].core_index = -1;
+		}
+	}
 	/* Update the count of enabled logical cores of the EAL configuration */
 	cfg->lcore_count = count;
 	lcores_parsed = 1;
 	return 0;
 }
 
+/*
+ * Parse the service coremask given as argument (hexadecimal string).
+ * The lcores must also be enabled with -c, -l or --lcores; this is
+ * checked once all options are parsed.
+ */
+static int
+eal_parse_service_coremask(const char *coremask, struct internal_config *conf)
+{
+	uint8_t lcores[RTE_MAX_LCORE];
+
+	if (eal_parse_hexmask(coremask, lcores) <= 0)
+		return -1;
+
+	memcpy(conf->service_lcore, lcores, sizeof(conf->service_lcore));
+	return 0;
+}
+
 static int
 eal_parse_corelist(const char *corelist)
 {
@@ -684,6 +726,13 @@ eal_parse_common_option(int opt, const char *optarg,
 			return -1;
 		}
 		break;
+	/* service coremask */
+	case 's':
+		if (eal_parse_service_coremask(optarg, conf) < 0) {
+			RTE_LOG(ERR, EAL, "invalid service coremask\n");
+			return -1;
+		}
+		break;
 	/* size of memory */
 	case 'm':
 		conf->memory = atoi(optarg);
@@ -819,6 +868,7 @@ int
 eal_check_common_options(struct internal_config *internal_cfg)
 {
 	struct rte_config *cfg = rte_eal_get_configuration();
+	unsigned i;
 
 	if (!lcores_parsed) {
 		RTE_LOG(ERR, EAL, "CPU cores must be enabled with options "
@@ -829,6 +879,20 @@ eal_check_common_options(struct internal_config *internal_cfg)
 		RTE_LOG(ERR, EAL, "Master lcore is not enabled for DPDK\n");
 		return -1;
 	}
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!internal_cfg->service_lcore[i])
+			continue;
+		if (cfg->lcore_role[i] != ROLE_RTE) {
+			RTE_LOG(ERR, EAL, "Service lcore %u is not enabled for "
+				"DPDK\n", i);
+			return -1;
+		}
+		if (i == cfg->master_lcore) {
+			RTE_LOG(ERR, EAL, "Master lcore cannot be a service "
+				"lcore\n");
+			return -1;
+		}
+	}
 
 	if (internal_cfg->process_type == RTE_PROC_INVALID) {
 		RTE_LOG(ERR, EAL, "Invalid process type specified\n");
@@ -887,6 +951,10 @@ eal_common_usage(void)
 	       "  -n CHANNELS         Number of memory channels\n"
 	       "  -m MB               Memory to allocate (see also --"OPT_SOCKET_MEM")\n"
 	       "  -r RANKS            Force number of memory ranks (don't detect)\n"
+	       "  -s, --"OPT_SERVICE_COREMASK" SERVICE COREMASK\n"
+	       "                      Hexadecimal bitmask of the lcores to use as service\n"
+	       "                      lcores. They must also be enabled with -c, -l or\n"
+	       "                      --"OPT_LCORES".\n"
 	       "  -b, --"OPT_PCI_BLACKLIST" Add a PCI device in black list.\n"
 	       "                      Prevent EAL from using this PCI device. The argument\n"
 	       "                      format is <domain:bus:devid.func>.\n"
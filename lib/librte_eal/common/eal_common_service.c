@@ -0,0 +1,543 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_memory.h>
+#include <rte_service.h>
+
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
+
+#define SERVICE_STOPPED 0
+#define SERVICE_RUNNING 1
+
+/* a registered service */
+struct rte_service {
+	struct rte_service_spec spec;
+	volatile uint8_t registered;
+	volatile uint8_t runstate;
+	volatile uint8_t stats_enabled;
+	/* taken by the lcore running an MT-unsafe service mapped to several
+	 * service lcores */
+	rte_atomic32_t execute_lock;
+	rte_atomic32_t num_mapped_lcores;
+} __rte_cache_aligned;
+
+/* state of a service lcore; the counters are only written by the lcore
+ * itself, so they need no atomic operation */
+struct service_lcore {
+	volatile uint64_t service_mask; /* services mapped to this lcore */
+	volatile uint8_t runstate;
+	uint8_t is_service_lcore;
+	/* incremented by a locked operation after each round */
+	rte_atomic64_t loops;
+	uint64_t calls[RTE_SERVICE_NUM_MAX];
+	uint64_t idle_calls[RTE_SERVICE_NUM_MAX];
+	uint64_t cycles[RTE_SERVICE_NUM_MAX];
+} __rte_cache_aligned;
+
+static struct rte_service rte_services[RTE_SERVICE_NUM_MAX];
+static struct service_lcore service_lcores[RTE_MAX_LCORE];
+static uint32_t service_count;
+
+static inline struct rte_service *
+service_get(uint32_t id)
+{
+	if (id >= RTE_SERVICE_NUM_MAX || !rte_services[id].registered)
+		return NULL;
+	return &rte_services[id];
+}
+
+static inline struct service_lcore *
+service_lcore_get(unsigned lcore_id)
+{
+	if (lcore_id >= RTE_MAX_LCORE ||
+			!service_lcores[lcore_id].is_service_lcore)
+		return NULL;
+	return &service_lcores[lcore_id];
+}
+
+/* run one service once on the calling service lcore */
+static inline void
+service_run(uint32_t i, struct service_lcore *cs)
+{
+	struct rte_service *s = &rte_services[i];
+	uint64_t start;
+	int mt_unsafe;
+	int32_t ret;
+
+	if (s->runstate != SERVICE_RUNNING)
+		return;
+
+	mt_unsafe = !(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE) &&
+		rte_atomic32_read(&s->num_mapped_lcores) > 1;
+	if (mt_unsafe && !rte_atomic32_test_and_set(&s->execute_lock))
+		return;
+
+	if (s->stats_enabled) {
+		start = rte_rdtsc();
+		ret = s->spec.callback(s->spec.callback_userdata);
+		cs->cycles[i] += rte_rdtsc() - start;
+	} else
+		ret = s->spec.callback(s->spec.callback_userdata);
+
+	cs->calls[i]++;
+	if (ret == -EAGAIN)
+		cs->idle_calls[i]++;
+
+	if (mt_unsafe)
+		rte_atomic32_clear(&s->execute_lock);
+}
+
+/* main loop of a service lcore: run the mapped services round-robin */
+static int
+service_runner_func(__attribute__((unused)) void *arg)
+{
+	struct service_lcore *cs = &service_lcores[rte_lcore_id()];
+	uint64_t mask;
+	uint32_t i;
+
+	while (cs->runstate == SERVICE_RUNNING) {
+		mask = cs->service_mask;
+		while (mask != 0) {
+			i = __builtin_ctzll(mask);
+			mask &= mask - 1;
+			service_run(i, cs);
+		}
+		rte_atomic64_inc(&cs->loops);
+	}
+
+	return 0;
+}
+
+/*
+ * Wait until no running service lcore can still be in a round that
+ * started before the service was unmapped. The round counter is
+ * incremented with a locked operation, which orders it with the read of
+ * the service mask of the next round: once it moved by two, the lcore
+ * has seen the new mask.
+ */
+static void
+service_quiesce(void)
+{
+	int64_t loops[RTE_MAX_LCORE];
+	unsigned lcore_id;
+
+	rte_mb();
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		loops[lcore_id] = rte_atomic64_read(&service_lcores[lcore_id].loops);
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!service_lcores[lcore_id].is_service_lcore)
+			continue;
+		while (rte_eal_get_lcore_state(lcore_id) == RUNNING &&
+				rte_atomic64_read(&service_lcores[lcore_id].loops) <
+				loops[lcore_id] + 2)
+			rte_pause();
+	}
+}
+
+int
+rte_service_register(const struct rte_service_spec *spec,
+		uint32_t *service_id)
+{
+	struct rte_service *s;
+	uint32_t i, free_id = RTE_SERVICE_NUM_MAX;
+
+	if (spec == NULL || spec->callback == NULL ||
+			spec->name[0] == '\0' ||
+			strnlen(spec->name, RTE_SERVICE_NAME_MAX) ==
+			RTE_SERVICE_NAME_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!rte_services[i].registered) {
+			if (free_id == RTE_SERVICE_NUM_MAX)
+				free_id = i;
+			continue;
+		}
+		if (strcmp(rte_services[i].spec.name, spec->name) == 0)
+			return -EEXIST;
+	}
+	if (free_id == RTE_SERVICE_NUM_MAX)
+		return -ENOSPC;
+
+	s = &rte_services[free_id];
+	memset(s, 0, sizeof(*s));
+	s->spec = *spec;
+	rte_atomic32_init(&s->execute_lock);
+	rte_atomic32_init(&s->num_mapped_lcores);
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		service_lcores[i].calls[free_id] = 0;
+		service_lcores[i].idle_calls[free_id] = 0;
+		service_lcores[i].cycles[free_id] = 0;
+	}
+	rte_wmb();
+	s->registered = 1;
+	service_count++;
+
+	if (service_id != NULL)
+		*service_id = free_id;
+
+	RTE_LOG(DEBUG, EAL, "Registered service %s with id %u\n",
+		spec->name, free_id);
+	return 0;
+}
+
+int
+rte_service_unregister(uint32_t id)
+{
+	struct rte_service *s = service_get(id);
+	unsigned lcore_id;
+
+	if (s == NULL)
+		return -EINVAL;
+
+	s->runstate = SERVICE_STOPPED;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		service_lcores[lcore_id].service_mask &= ~(UINT64_C(1) << id);
+	rte_atomic32_set(&s->num_mapped_lcores, 0);
+
+	service_quiesce();
+
+	s->registered = 0;
+	service_count--;
+	return 0;
+}
+
+uint32_t
+rte_service_count(void)
+{
+	return service_count;
+}
+
+int
+rte_service_get_by_name(const char *name, uint32_t *service_id)
+{
+	uint32_t i;
+
+	if (name == NULL || service_id == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (rte_services[i].registered &&
+				strcmp(rte_services[i].spec.name, name) == 0) {
+			*service_id = i;
+			return 0;
+		}
+	}
+	return -ENOENT;
+}
+
+const char *
+rte_service_get_name(uint32_t id)
+{
+	struct rte_service *s = service_get(id);
+
+	if (s == NULL)
+		return NULL;
+	return s->spec.name;
+}
+
+int
+rte_service_runstate_set(uint32_t id, int runstate)
+{
+	struct rte_service *s = service_get(id);
+
+	if (s == NULL)
+		return -EINVAL;
+
+	s->runstate = runstate ? SERVICE_RUNNING : SERVICE_STOPPED;
+	return 0;
+}
+
+int
+rte_service_runstate_get(uint32_t id)
+{
+	struct rte_service *s = service_get(id);
+
+	if (s == NULL)
+		return -EINVAL;
+	return s->runstate == SERVICE_RUNNING;
+}
+
+int
+rte_service_set_stats_enable(uint32_t id, int enable)
+{
+	struct rte_service *s = service_get(id);
+
+	if (s == NULL)
+		return -EINVAL;
+
+	s->stats_enabled = !!enable;
+	return 0;
+}
+
+int
+rte_service_stats_get(uint32_t id, struct rte_service_stats *stats)
+{
+	struct service_lcore *cs;
+	unsigned lcore_id;
+
+	if (service_get(id) == NULL || stats == NULL)
+		return -EINVAL;
+
+	memset(stats, 0, sizeof(*stats));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cs = &service_lcores[lcore_id];
+		stats->calls += cs->calls[id];
+		stats->idle_calls += cs->idle_calls[id];
+		stats->cycles += cs->cycles[id];
+	}
+	return 0;
+}
+
+int
+rte_service_map_lcore_set(uint32_t id, unsigned lcore_id, int enable)
+{
+	struct rte_service *s = service_get(id);
+	struct service_lcore *cs = service_lcore_get(lcore_id);
+	uint64_t bit = UINT64_C(1) << id;
+
+	if (s == NULL || cs == NULL)
+		return -EINVAL;
+
+	if (enable && !(cs->service_mask & bit)) {
+		rte_atomic32_inc(&s->num_mapped_lcores);
+		/* the lcore count must be seen before the lcore runs it */
+		rte_wmb();
+		cs->service_mask |= bit;
+	} else if (!enable && (cs->service_mask & bit)) {
+		cs->service_mask &= ~bit;
+		rte_atomic32_dec(&s->num_mapped_lcores);
+	}
+	return 0;
+}
+
+int
+rte_service_map_lcore_get(uint32_t id, unsigned lcore_id)
+{
+	struct service_lcore *cs = service_lcore_get(lcore_id);
+
+	if (service_get(id) == NULL || cs == NULL)
+		return -EINVAL;
+	return !!(cs->service_mask & (UINT64_C(1) << id));
+}
+
+int
+rte_service_lcore_add(unsigned lcore_id)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	struct service_lcore *cs;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+	cs = &service_lcores[lcore_id];
+	if (cs->is_service_lcore)
+		return -EALREADY;
+	if (cfg->lcore_role[lcore_id] != ROLE_RTE ||
+			lcore_id == rte_get_master_lcore())
+		return -EINVAL;
+	if (rte_eal_get_lcore_state(lcore_id) != WAIT)
+		return -EBUSY;
+
+	cs->service_mask = 0;
+	cs->runstate = SERVICE_STOPPED;
+	cs->is_service_lcore = 1;
+	cfg->lcore_role[lcore_id] = ROLE_SERVICE;
+	cfg->lcore_count--;
+	return 0;
+}
+
+int
+rte_service_lcore_del(unsigned lcore_id)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	struct service_lcore *cs = service_lcore_get(lcore_id);
+	uint32_t i;
+
+	if (cs == NULL)
+		return -EINVAL;
+	if (cs->runstate != SERVICE_STOPPED)
+		return -EBUSY;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
+		rte_service_map_lcore_set(i, lcore_id, 0);
+	cs->is_service_lcore = 0;
+	cfg->lcore_role[lcore_id] = ROLE_RTE;
+	cfg->lcore_count++;
+	return 0;
+}
+
+int
+rte_service_lcore_start(unsigned lcore_id)
+{
+	struct service_lcore *cs = service_lcore_get(lcore_id);
+	int ret;
+
+	if (cs == NULL)
+		return -EINVAL;
+	if (cs->runstate == SERVICE_RUNNING)
+		return -EALREADY;
+
+	cs->runstate = SERVICE_RUNNING;
+	ret = rte_eal_remote_launch(service_runner_func, NULL, lcore_id);
+	if (ret < 0)
+		cs->runstate = SERVICE_STOPPED;
+	return ret;
+}
+
+int
+rte_service_lcore_stop(unsigned lcore_id)
+{
+	struct service_lcore *cs = service_lcore_get(lcore_id);
+
+	if (cs == NULL)
+		return -EINVAL;
+	if (cs->runstate == SERVICE_STOPPED)
+		return -EALREADY;
+
+	cs->runstate = SERVICE_STOPPED;
+	rte_eal_wait_lcore(lcore_id);
+	return 0;
+}
+
+unsigned
+rte_service_lcore_count(void)
+{
+	unsigned lcore_id, count = 0;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		count += service_lcores[lcore_id].is_service_lcore;
+	return count;
+}
+
+unsigned
+rte_service_lcore_list(unsigned array[], unsigned n)
+{
+	unsigned lcore_id, count = 0;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!service_lcores[lcore_id].is_service_lcore)
+			continue;
+		if (array != NULL && count < n)
+			array[count] = lcore_id;
+		count++;
+	}
+	return count;
+}
+
+void
+rte_service_lcore_reset_all(void)
+{
+	unsigned lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!service_lcores[lcore_id].is_service_lcore)
+			continue;
+		if (service_lcores[lcore_id].runstate == SERVICE_RUNNING)
+			rte_service_lcore_stop(lcore_id);
+		rte_service_lcore_del(lcore_id);
+	}
+}
+
+void
+rte_service_dump(FILE *f)
+{
+	struct rte_service_stats stats;
+	struct service_lcore *cs;
+	unsigned lcore_id;
+	uint32_t i;
+
+	fprintf(f, "Services: %u\n", service_count);
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (rte_service_stats_get(i, &stats) < 0)
+			continue;
+		fprintf(f, "  %u: %s\n", i, rte_services[i].spec.name);
+		fprintf(f, "    runstate=%s lcores=%d calls=%"PRIu64
+			" idle_calls=%"PRIu64" cycles=%"PRIu64"\n",
+			rte_services[i].runstate == SERVICE_RUNNING ?
+			"running" : "stopped",
+			rte_atomic32_read(&rte_services[i].num_mapped_lcores),
+			stats.calls, stats.idle_calls, stats.cycles);
+		if (stats.calls != 0 && rte_services[i].stats_enabled)
+			fprintf(f, "    cycles/call=%"PRIu64"\n",
+				stats.cycles / stats.calls);
+	}
+
+	fprintf(f, "Service lcores: %u\n", rte_service_lcore_count());
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cs = &service_lcores[lcore_id];
+		if (!cs->is_service_lcore)
+			continue;
+		fprintf(f, "  lcore %u: %s mask=0x%"PRIx64" loops=%"PRIu64"\n",
+			lcore_id,
+			cs->runstate == SERVICE_RUNNING ? "running" : "stopped",
+			cs->service_mask, rte_atomic64_read(&cs->loops));
+	}
+}
+
+/* turn the lcores given with -s into service lcores and start them */
+int
+rte_eal_service_init(void)
+{
+	unsigned lcore_id;
+	int ret;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!internal_config.service_lcore[lcore_id])
+			continue;
+		ret = rte_service_lcore_add(lcore_id);
+		if (ret == 0)
+			ret = rte_service_lcore_start(lcore_id);
+		if (ret < 0) {
+			RTE_LOG(ERR, EAL, "Cannot start service lcore %u\n",
+				lcore_id);
+			return -1;
+		}
+		RTE_LOG(DEBUG, EAL, "lcore %u is a service lcore\n", lcore_id);
+	}
+	return 0;
+}
@@ -286,6 +286,17 @@ int rte_eal_alarm_init(void);
  */
 int rte_eal_dev_init(void);
 
+/**
+ * Turn the lcores given with the -s option into service lcores and
+ * start them.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success, negative on error
+ */
+int rte_eal_service_init(void);
+
 /**
  * Function is to check if the kernel module(like, vfio, vfio_iommu_type1,
  * etc.) loaded.
@@ -188,4 +188,56 @@ static inline void rte_atomic64_clear(rte_atomic64_t *v)
 }
 #endif
 
+/*------------------------- 128 bit atomic operations -------------------------*/
+
+/**
+ * 128-bit integer, aligned as required by cmpxchg16b.
+ */
+typedef struct {
+	uint64_t val[2];
+} __attribute__((aligned(16))) rte_int128_t;
+
+/**
+ * Atomic compare and set on 128 bits.
+ *
+ * (atomic) equivalent to:
+ *   if (*dst == *exp)
+ *     *dst = *src
+ *   else
+ *     *exp = *dst
+ *
+ * @param dst
+ *   The destination location, 16-byte aligned.
+ * @param exp
+ *   The expected value; on failure it is updated with the value read
+ *   from dst.
+ * @param src
+ *   The new value.
+ * @return
+ *   Non-zero on success; 0 on failure.
+ */
+static inline int
+rte_atomic128_cmpset(volatile rte_int128_t *dst, rte_int128_t *exp,
+		const rte_int128_t *src)
+{
+	uint8_t res;
+
+	asm volatile(
+			MPLOCKED
+			"cmpxchg16b %[dst];"
+			"sete %[res];"
+			: [dst] "=m" (dst->val[0]),
+			  "=a" (exp->val[0]),
+			  "=d" (exp->val[1]),
+			  [res] "=r" (res)
+			: "b" (src->val[0]),
+			  "c" (src->val[1]),
+			  "a" (exp->val[0]),
+			  "d" (exp->val[1]),
+			  "m" (dst->val[0])
+			: "memory");
+
+	return res;
+}
+
 #endif /* _RTE_ATOMIC_X86_64_H_ */
@@ -78,6 +78,9 @@ extern struct rte_logs rte_logs;
 #define RTE_LOGTYPE_TABLE   0x00004000 /**< Log related to table. */
 #define RTE_LOGTYPE_PIPELINE 0x00008000 /**< Log related to pipeline. */
 #define RTE_LOGTYPE_MBUF    0x00010000 /**< Log related to mbuf. */
+#define RTE_LOGTYPE_STACK   0x00020000 /**< Log related to stack. */
+#define RTE_LOGTYPE_TELEMETRY 0x00040000 /**< Log related to telemetry. */
+#define RTE_LOGTYPE_LATENCY_STATS 0x00080000 /**< Log related to latency stats. */
 
 /* these log types can be used in an application */
 #define RTE_LOGTYPE_USER1   0x01000000 /**< User-defined log type 1. */
@@ -0,0 +1,361 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_H_
+#define _RTE_SERVICE_H_
+
+/**
+ * @file
+ *
+ * Service cores
+ *
+ * The service core framework lets components (PMDs, libraries or the
+ * application) register pieces of background work, called services,
+ * that are run by a set of dedicated lcores, called service lcores,
+ * instead of each component occupying a whole lcore of its own.
+ *
+ * A service lcore runs the services mapped to it in a round-robin
+ * loop; each service can be mapped to and unmapped from any service
+ * lcore at runtime. Service lcores are given either with the EAL -s
+ * option, in which case they are started by rte_eal_init(), or at
+ * runtime with rte_service_lcore_add() and rte_service_lcore_start().
+ * Service lcores are not reported by rte_lcore_is_enabled(), so
+ * they are skipped by RTE_LCORE_FOREACH() and rte_eal_mp_remote_launch().
+ *
+ * The control functions of this API are not thread-safe and must be
+ * called from a single control thread.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+/** Maximum length of a service name, including the trailing '\\0'. */
+#define RTE_SERVICE_NAME_MAX 32
+
+/** Maximum number of services that can be registered. */
+#define RTE_SERVICE_NUM_MAX 64
+
+/**
+ * The service callback can safely be called on several lcores at the
+ * same time. Without this capability, a service mapped to several
+ * service lcores is only run by one of them at a time.
+ */
+#define RTE_SERVICE_CAP_MT_SAFE (1 << 0)
+
+/**
+ * Definition of a service callback.
+ *
+ * The callback must do a bounded amount of work and return, so that the
+ * other services mapped to the same lcore get their turn. It returns 0
+ * when it did some work, or -EAGAIN when it found nothing to do; the
+ * latter is only used for statistics.
+ */
+typedef int32_t (*rte_service_func)(void *arg);
+
+/**
+ * Specification of a service, given at registration time.
+ */
+struct rte_service_spec {
+	char name[RTE_SERVICE_NAME_MAX]; /**< Unique name of the service. */
+	rte_service_func callback;       /**< Function run by service lcores. */
+	void *callback_userdata;         /**< Argument given to callback. */
+	uint32_t capabilities;           /**< RTE_SERVICE_CAP_* flags. */
+	int socket_id;                   /**< Preferred socket, or SOCKET_ID_ANY. */
+};
+
+/**
+ * Statistics of a service, summed over all service lcores.
+ */
+struct rte_service_stats {
+	uint64_t calls;      /**< Number of times the callback was run. */
+	uint64_t idle_calls; /**< Calls that returned -EAGAIN. */
+	uint64_t cycles;     /**< TSC cycles spent in the callback. */
+};
+
+/**
+ * Register a new service.
+ *
+ * The service is created stopped and mapped to no lcore.
+ *
+ * @param spec
+ *   The specification of the service. It is copied.
+ * @param service_id
+ *   If not NULL, the identifier of the new service is stored there.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid specification.
+ *   - -EEXIST: A service with the same name is already registered.
+ *   - -ENOSPC: No more room for a new service.
+ */
+int rte_service_register(const struct rte_service_spec *spec,
+		uint32_t *service_id);
+
+/**
+ * Unregister a service.
+ *
+ * The service is stopped and unmapped from all lcores, and this
+ * function waits until no service lcore is still running its callback,
+ * so the resources used by the callback can be freed on return.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service identifier.
+ */
+int rte_service_unregister(uint32_t id);
+
+/**
+ * Get the number of registered services.
+ *
+ * @return
+ *   The number of registered services.
+ */
+uint32_t rte_service_count(void);
+
+/**
+ * Look up a service by name.
+ *
+ * @param name
+ *   The name of the service.
+ * @param service_id
+ *   The identifier of the service is stored there on success.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOENT: No service with that name.
+ */
+int rte_service_get_by_name(const char *name, uint32_t *service_id);
+
+/**
+ * Get the name of a service.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @return
+ *   The name of the service, or NULL if the identifier is invalid.
+ */
+const char *rte_service_get_name(uint32_t id);
+
+/**
+ * Start or stop a service.
+ *
+ * A stopped service is skipped by the service lcores it is mapped to.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @param runstate
+ *   Non-zero to start the service, zero to stop it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service identifier.
+ */
+int rte_service_runstate_set(uint32_t id, int runstate);
+
+/**
+ * Get the run state of a service.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @return
+ *   - 1: The service is started.
+ *   - 0: The service is stopped.
+ *   - -EINVAL: Invalid service identifier.
+ */
+int rte_service_runstate_get(uint32_t id);
+
+/**
+ * Enable or disable cycle accounting for a service.
+ *
+ * Calls are always counted; measuring the cycles spent in the callback
+ * costs two TSC reads per call and is disabled by default.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @param enable
+ *   Non-zero to enable cycle accounting, zero to disable it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service identifier.
+ */
+int rte_service_set_stats_enable(uint32_t id, int enable);
+
+/**
+ * Get the statistics of a service.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @param stats
+ *   The statistics, summed over all service lcores, are stored there.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ */
+int rte_service_stats_get(uint32_t id, struct rte_service_stats *stats);
+
+/**
+ * Map a service to a service lcore, or unmap it.
+ *
+ * This can be done while the service lcore is running; the change is
+ * taken into account at its next round over the mapped services.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @param lcore_id
+ *   The identifier of a service lcore.
+ * @param enable
+ *   Non-zero to map the service to the lcore, zero to unmap it.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid service identifier or not a service lcore.
+ */
+int rte_service_map_lcore_set(uint32_t id, unsigned lcore_id, int enable);
+
+/**
+ * Check whether a service is mapped to a service lcore.
+ *
+ * @param id
+ *   The identifier of the service.
+ * @param lcore_id
+ *   The identifier of a service lcore.
+ * @return
+ *   - 1: The service is mapped to the lcore.
+ *   - 0: The service is not mapped to the lcore.
+ *   - -EINVAL: Invalid service identifier or not a service lcore.
+ */
+int rte_service_map_lcore_get(uint32_t id, unsigned lcore_id);
+
+/**
+ * Turn an lcore into a service lcore.
+ *
+ * The lcore must be an enabled slave lcore in the WAIT state. It is no
+ * longer reported by rte_lcore_is_enabled() nor counted by
+ * rte_lcore_count().
+ *
+ * @param lcore_id
+ *   The identifier of the lcore.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The lcore is not an enabled slave lcore.
+ *   - -EBUSY: The lcore is running a function.
+ *   - -EALREADY: The lcore is already a service lcore.
+ */
+int rte_service_lcore_add(unsigned lcore_id);
+
+/**
+ * Give a stopped service lcore back to the application.
+ *
+ * All services are unmapped from the lcore.
+ *
+ * @param lcore_id
+ *   The identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Not a service lcore.
+ *   - -EBUSY: The service lcore is running.
+ */
+int rte_service_lcore_del(unsigned lcore_id);
+
+/**
+ * Start a service lcore.
+ *
+ * The lcore then runs the services mapped to it until
+ * rte_service_lcore_stop() is called.
+ *
+ * @param lcore_id
+ *   The identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Not a service lcore.
+ *   - -EALREADY: The service lcore is already running.
+ *   - -EBUSY: The lcore is busy running another function.
+ */
+int rte_service_lcore_start(unsigned lcore_id);
+
+/**
+ * Stop a service lcore and wait until it is back in the WAIT state.
+ *
+ * The services mapped to the lcore stay mapped.
+ *
+ * @param lcore_id
+ *   The identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Not a service lcore.
+ *   - -EALREADY: The service lcore is already stopped.
+ */
+int rte_service_lcore_stop(unsigned lcore_id);
+
+/**
+ * Get the number of service lcores.
+ *
+ * @return
+ *   The number of service lcores.
+ */
+unsigned rte_service_lcore_count(void);
+
+/**
+ * Get the list of service lcores.
+ *
+ * @param array
+ *   Array filled with the identifiers of the service lcores.
+ * @param n
+ *   Size of the array.
+ * @return
+ *   The number of service lcores, which may be larger than n (in that
+ *   case only the first n identifiers are stored).
+ */
+unsigned rte_service_lcore_list(unsigned array[], unsigned n);
+
+/**
+ * Stop all service lcores and give them back to the application.
+ */
+void rte_service_lcore_reset_all(void);
+
+/**
+ * Dump the services, their statistics and the service lcores.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ */
+void rte_service_dump(FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_H_ */
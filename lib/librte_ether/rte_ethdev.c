@@ -162,6 +162,25 @@ static const struct rte_eth_xstats_name_off rte_txq_stats_strings[] = {
 #define RTE_NB_TXQ_STATS (sizeof(rte_txq_stats_strings) /	\
 		sizeof(rte_txq_stats_strings[0]))
 
+#ifdef RTE_ETHDEV_BURST_STATS
+/* names are prefixed with the queue, their total length fits in the
+ * RTE_ETH_XSTATS_NAME_SIZE bytes of an xstats name */
+struct rte_eth_burst_stats_name_off {
+	const char *name;
+	unsigned offset;
+};
+
+static const struct rte_eth_burst_stats_name_off rte_burst_stats_strings[] = {
+	{"polls", offsetof(struct rte_eth_burst_stats, polls)},
+	{"empty_polls", offsetof(struct rte_eth_burst_stats, empty_polls)},
+	{"burst_packets", offsetof(struct rte_eth_burst_stats, pkts)},
+	{"burst_cycles", offsetof(struct rte_eth_burst_stats, cycles)},
+};
+#define RTE_NB_BURST_STATS (sizeof(rte_burst_stats_strings) /	\
+		sizeof(rte_burst_stats_strings[0]) +		\
+		RTE_ETH_BURST_STATS_NB_BINS)
+#endif
+
 
 /**
  * The user application callback description.
@@ -708,6 +727,25 @@ rte_eth_dev_detach(uint8_t port_id, char *name)
 		return rte_eth_dev_detach_vdev(port_id, name);
 }
 
+#ifdef RTE_ETHDEV_BURST_STATS
+/* (re)allocate the burst statistics of nb_queues queues, zeroed */
+static int
+rte_eth_burst_stats_alloc(struct rte_eth_burst_stats **stats,
+		uint16_t nb_queues)
+{
+	rte_free(*stats);
+	*stats = NULL;
+	if (nb_queues == 0)
+		return 0;
+
+	*stats = rte_zmalloc("ethdev->burst_stats",
+			sizeof(**stats) * nb_queues, RTE_CACHE_LINE_SIZE);
+	if (*stats == NULL)
+		return -(ENOMEM);
+	return 0;
+}
+#endif
+
 static int
 rte_eth_dev_rx_queue_config(struct rte_eth_dev *dev, uint16_t nb_queues)
 {
@@ -744,6 +782,11 @@ rte_eth_dev_rx_queue_config(struct rte_eth_dev *dev, uint16_t nb_queues)
 		dev->data->rx_queues = rxq;
 
 	}
+#ifdef RTE_ETHDEV_BURST_STATS
+	if (rte_eth_burst_stats_alloc(&dev->data->rx_burst_stats,
+			nb_queues) < 0)
+		return -(ENOMEM);
+#endif
 	dev->data->nb_rx_queues = nb_queues;
 	return 0;
 }
@@ -876,6 +919,11 @@ rte_eth_dev_tx_queue_config(struct rte_eth_dev *dev, uint16_t nb_queues)
 		dev->data->tx_queues = txq;
 
 	}
+#ifdef RTE_ETHDEV_BURST_STATS
+	if (rte_eth_burst_stats_alloc(&dev->data->tx_burst_stats,
+			nb_queues) < 0)
+		return -(ENOMEM);
+#endif
 	dev->data->nb_tx_queues = nb_queues;
 	return 0;
 }
@@ -1386,6 +1434,10 @@ rte_eth_dev_close(uint8_t port_id)
 	dev->data->rx_queues = NULL;
 	rte_free(dev->data->tx_queues);
 	dev->data->tx_queues = NULL;
+#ifdef RTE_ETHDEV_BURST_STATS
+	rte_eth_burst_stats_alloc(&dev->data->rx_burst_stats, 0);
+	rte_eth_burst_stats_alloc(&dev->data->tx_burst_stats, 0);
+#endif
 }
 
 int
@@ -1649,6 +1701,38 @@ rte_eth_stats_reset(uint8_t port_id)
 	(*dev->dev_ops->stats_reset)(dev);
 }
 
+#ifdef RTE_ETHDEV_BURST_STATS
+/* fill the RTE_NB_BURST_STATS xstats of one queue */
+static unsigned
+rte_eth_burst_stats_fill(struct rte_eth_xstats *xstats,
+	const struct rte_eth_burst_stats *stats, const char *dir, unsigned q)
+{
+	const uint64_t *stats_ptr;
+	unsigned count = 0, i;
+
+	for (i = 0; i < RTE_DIM(rte_burst_stats_strings); i++) {
+		stats_ptr = RTE_PTR_ADD(stats,
+				rte_burst_stats_strings[i].offset);
+		snprintf(xstats[count].name, sizeof(xstats[count].name),
+			"%s_queue_%u_%s", dir, q,
+			rte_burst_stats_strings[i].name);
+		xstats[count++].value = *stats_ptr;
+	}
+
+	for (i = 0; i < RTE_ETH_BURST_STATS_NB_BINS - 1; i++) {
+		snprintf(xstats[count].name, sizeof(xstats[count].name),
+			"%s_queue_%u_burst_size_%u_%u", dir, q,
+			1U << i, (2U << i) - 1);
+		xstats[count++].value = stats->size_hist[i];
+	}
+	snprintf(xstats[count].name, sizeof(xstats[count].name),
+		"%s_queue_%u_burst_size_%u_plus", dir, q, 1U << i);
+	xstats[count++].value = stats->size_hist[i];
+
+	return count;
+}
+#endif
+
 /* retrieve ethdev extended statistics */
 int
 rte_eth_xstats_get(uint8_t port_id, struct rte_eth_xstats *xstats,
@@ -1668,6 +1752,13 @@ rte_eth_xstats_get(uint8_t port_id, struct rte_eth_xstats *xstats,
 	count = RTE_NB_STATS;
 	count += dev->data->nb_rx_queues * RTE_NB_RXQ_STATS;
 	count += dev->data->nb_tx_queues * RTE_NB_TXQ_STATS;
+#ifdef RTE_ETHDEV_BURST_STATS
+	/* no burst statistics before the queues are configured */
+	if (dev->data->rx_burst_stats != NULL)
+		count += dev->data->nb_rx_queues * RTE_NB_BURST_STATS;
+	if (dev->data->tx_burst_stats != NULL)
+		count += dev->data->nb_tx_queues * RTE_NB_BURST_STATS;
+#endif
 
 	/* implemented by the driver */
 	if (dev->dev_ops->xstats_get != NULL) {
@@ -1726,6 +1817,18 @@ rte_eth_xstats_get(uint8_t port_id, struct rte_eth_xstats *xstats,
 		}
 	}
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	/* per-queue burst stats */
+	for (q = 0; dev->data->rx_burst_stats != NULL &&
+			q < dev->data->nb_rx_queues; q++)
+		count += rte_eth_burst_stats_fill(&xstats[count],
+			&dev->data->rx_burst_stats[q], "rx", q);
+	for (q = 0; dev->data->tx_burst_stats != NULL &&
+			q < dev->data->nb_tx_queues; q++)
+		count += rte_eth_burst_stats_fill(&xstats[count],
+			&dev->data->tx_burst_stats[q], "tx", q);
+#endif
+
 	return count + xcount;
 }
 
@@ -1738,6 +1841,17 @@ rte_eth_xstats_reset(uint8_t port_id)
 	VALID_PORTID_OR_RET(port_id);
 	dev = &rte_eth_devices[port_id];
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	if (dev->data->rx_burst_stats != NULL)
+		memset(dev->data->rx_burst_stats, 0,
+			sizeof(struct rte_eth_burst_stats) *
+			dev->data->nb_rx_queues);
+	if (dev->data->tx_burst_stats != NULL)
+		memset(dev->data->tx_burst_stats, 0,
+			sizeof(struct rte_eth_burst_stats) *
+			dev->data->nb_tx_queues);
+#endif
+
 	/* implemented by the driver */
 	if (dev->dev_ops->xstats_reset != NULL) {
 		(*dev->dev_ops->xstats_reset)(dev);
@@ -2880,8 +2994,20 @@ rte_eth_rx_burst(uint8_t port_id, uint16_t queue_id,
 		PMD_DEBUG_TRACE("Invalid RX queue_id=%d\n", queue_id);
 		return 0;
 	}
+#ifdef RTE_ETHDEV_BURST_STATS
+	uint64_t start = rte_rdtsc();
+	uint16_t nb_rx = (*dev->rx_pkt_burst)(dev->data->rx_queues[queue_id],
+						rx_pkts, nb_pkts);
+
+	if (dev->data->rx_burst_stats != NULL)
+		__rte_eth_burst_stats_update(
+			&dev->data->rx_burst_stats[queue_id],
+			nb_rx, rte_rdtsc() - start);
+	return nb_rx;
+#else
 	return (*dev->rx_pkt_burst)(dev->data->rx_queues[queue_id],
 						rx_pkts, nb_pkts);
+#endif
 }
 
 uint16_t
@@ -2899,8 +3025,20 @@ rte_eth_tx_burst(uint8_t port_id, uint16_t queue_id,
 		PMD_DEBUG_TRACE("Invalid TX queue_id=%d\n", queue_id);
 		return 0;
 	}
+#ifdef RTE_ETHDEV_BURST_STATS
+	uint64_t start = rte_rdtsc();
+	uint16_t nb_tx = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
+						tx_pkts, nb_pkts);
+
+	if (dev->data->tx_burst_stats != NULL)
+		__rte_eth_burst_stats_update(
+			&dev->data->tx_burst_stats[queue_id],
+			nb_tx, rte_rdtsc() - start);
+	return nb_tx;
+#else
 	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
 						tx_pkts, nb_pkts);
+#endif
 }
 
 uint32_t
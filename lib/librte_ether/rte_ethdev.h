@@ -180,6 +180,9 @@ extern "C" {
 #include <rte_pci.h>
 #include <rte_dev.h>
 #include <rte_devargs.h>
+#ifdef RTE_ETHDEV_BURST_STATS
+#include <rte_cycles.h>
+#endif
 #include "rte_ether.h"
 #include "rte_eth_ctrl.h"
 #include "rte_dev_info.h"
@@ -964,6 +967,31 @@ struct rte_eth_xstats {
 	uint64_t value;
 };
 
+#ifdef RTE_ETHDEV_BURST_STATS
+/** Number of bins of the burst size histograms. */
+#define RTE_ETH_BURST_STATS_NB_BINS 8
+
+/**
+ * Instrumentation of the bursts of one RX or TX queue.
+ *
+ * It is updated by rte_eth_rx_burst() and rte_eth_tx_burst() when
+ * CONFIG_RTE_ETHDEV_BURST_STATS is enabled, and is reported per queue by
+ * rte_eth_xstats_get(). Like the PMD statistics, the counters of a queue
+ * must only be updated by the lcore polling that queue.
+ */
+struct rte_eth_burst_stats {
+	uint64_t polls;       /**< Number of bursts. */
+	uint64_t empty_polls; /**< Bursts that received or sent nothing. */
+	uint64_t pkts;        /**< Packets received or sent. */
+	uint64_t cycles;      /**< TSC cycles spent in the PMD burst function. */
+	/**
+	 * Bin i counts the bursts of 2^i to 2^(i+1) - 1 packets; the last
+	 * bin also counts the bigger bursts.
+	 */
+	uint64_t size_hist[RTE_ETH_BURST_STATS_NB_BINS];
+} __rte_cache_aligned;
+#endif
+
 struct rte_eth_dev;
 
 struct rte_eth_dev_callback;
@@ -1639,6 +1667,12 @@ struct rte_eth_dev_data {
 		all_multicast : 1, /**< RX all multicast mode ON(1) / OFF(0). */
 		dev_started : 1,   /**< Device state: STARTED(1) / STOPPED(0). */
 		lro         : 1;   /**< RX LRO is ON(1) / OFF(0) */
+#ifdef RTE_ETHDEV_BURST_STATS
+	struct rte_eth_burst_stats *rx_burst_stats;
+	/**< Array of RX burst statistics, one per RX queue. */
+	struct rte_eth_burst_stats *tx_burst_stats;
+	/**< Array of TX burst statistics, one per TX queue. */
+#endif
 };
 
 /**
@@ -2434,6 +2468,31 @@ extern int rte_eth_dev_get_vlan_offload(uint8_t port_id);
  */
 extern int rte_eth_dev_set_vlan_pvid(uint8_t port_id, uint16_t pvid, int on);
 
+#ifdef RTE_ETHDEV_BURST_STATS
+/**
+ * @internal
+ * Account a burst of *nb_pkts* packets that took *cycles* in the PMD.
+ */
+static inline void
+__rte_eth_burst_stats_update(struct rte_eth_burst_stats *stats,
+		uint16_t nb_pkts, uint64_t cycles)
+{
+	unsigned bin;
+
+	stats->polls++;
+	stats->cycles += cycles;
+	if (nb_pkts == 0) {
+		stats->empty_polls++;
+		return;
+	}
+	stats->pkts += nb_pkts;
+	bin = 31 - __builtin_clz(nb_pkts);
+	if (bin >= RTE_ETH_BURST_STATS_NB_BINS)
+		bin = RTE_ETH_BURST_STATS_NB_BINS - 1;
+	stats->size_hist[bin]++;
+}
+#endif
+
 /**
  *
  * Retrieve a burst of input packets from a receive queue of an Ethernet
@@ -2528,9 +2587,21 @@ rte_eth_rx_burst(uint8_t port_id, uint16_t queue_id,
 
 	dev = &rte_eth_devices[port_id];
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	uint64_t start = rte_rdtsc();
+#endif
+
 	int16_t nb_rx = (*dev->rx_pkt_burst)(dev->data->rx_queues[queue_id],
 			rx_pkts, nb_pkts);
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	/* no statistics before the queues are configured */
+	if (likely(dev->data->rx_burst_stats != NULL))
+		__rte_eth_burst_stats_update(
+			&dev->data->rx_burst_stats[queue_id],
+			(uint16_t)nb_rx, rte_rdtsc() - start);
+#endif
+
 #ifdef RTE_ETHDEV_RXTX_CALLBACKS
 	struct rte_eth_rxtx_callback *cb = dev->post_rx_burst_cbs[queue_id];
 
@@ -2682,7 +2753,19 @@ rte_eth_tx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
+#ifdef RTE_ETHDEV_BURST_STATS
+	uint64_t start = rte_rdtsc();
+	uint16_t nb_tx = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
+			tx_pkts, nb_pkts);
+
+	if (likely(dev->data->tx_burst_stats != NULL))
+		__rte_eth_burst_stats_update(
+			&dev->data->tx_burst_stats[queue_id],
+			nb_tx, rte_rdtsc() - start);
+	return nb_tx;
+#else
 	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts, nb_pkts);
+#endif
 }
 #endif
 
@@ -34,6 +34,15 @@
 #ifndef _IP_FRAG_COMMON_H_
 #define _IP_FRAG_COMMON_H_
 
+#include <errno.h>
+
+#include <rte_prefetch.h>
+#include <rte_mbuf.h>
+#include <rte_jhash.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
+#include <rte_hash_crc.h>
+#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+
 #include "rte_ip_frag.h"
 
 /* logging macros. */
@@ -54,9 +63,27 @@ if (!(exp))	{							\
 #define IPV4_KEYLEN 1
 #define IPV6_KEYLEN 4
 
+#define	PRIME_VALUE	0xeaad8405
+
+/* number of packets looked up together by the burst functions */
+#define	IP_FRAG_BURST_WINDOW	8
+
+/* max number of fragments built by the burst fragmentation fast path */
+#define	IP_FRAG_FAST_MAX_FRAGS	64
+
+/* number of mbufs to prefetch when flushing the death row */
+#define	IP_FRAG_DR_PREFETCH	3
+
 /* helper macros */
 #define	IP_FRAG_MBUF2DR(dr, mb)	((dr)->row[(dr)->cnt++] = (mb))
 
+#define	IP_FRAG_TBL_ENTRY(tbl, idx)	\
+	((struct ip_frag_pkt *)((uintptr_t)(tbl)->pkt + \
+	(size_t)(idx) * (tbl)->entry_size))
+
+#define	IP_FRAG_TBL_POS(tbl, sig)	\
+	IP_FRAG_TBL_ENTRY(tbl, (sig) & (tbl)->entry_mask)
+
 #define IPv6_KEY_BYTES(key) \
 	(key)[0], (key)[1], (key)[2], (key)[3]
 #define IPv6_KEY_BYTES_FMT \
@@ -65,16 +92,26 @@ if (!(exp))	{							\
 /* internal functions declarations */
 struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
 		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
-		uint16_t ofs, uint16_t len, uint16_t more_frags);
+		uint16_t ofs, uint16_t len, uint16_t more_frags,
+		uint32_t max_frags);
 
 struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		const struct ip_frag_key *key, uint64_t tms);
 
+struct ip_frag_pkt * ip_frag_find_sig(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr,
+		const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+		uint64_t tms);
+
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	const struct ip_frag_key *key, uint64_t tms,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
 
+struct ip_frag_pkt * ip_frag_lookup_sig(struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf * ipv4_frag_reassemble(const struct ip_frag_pkt *fp);
 struct rte_mbuf * ipv6_frag_reassemble(const struct ip_frag_pkt *fp);
@@ -85,6 +122,56 @@ struct rte_mbuf * ipv6_frag_reassemble(const struct ip_frag_pkt *fp);
  * misc frag key functions
  */
 
+static inline void
+ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+{
+	uint32_t v;
+	const uint32_t *p;
+
+	p = (const uint32_t *)&key->src_dst;
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
+	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
+	v = rte_hash_crc_4byte(p[1], v);
+	v = rte_hash_crc_4byte(key->id, v);
+#else
+
+	v = rte_jhash_3words(p[0], p[1], key->id, PRIME_VALUE);
+#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+
+	*v1 =  v;
+	*v2 = (v << 7) + (v >> 14);
+}
+
+static inline void
+ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+{
+	uint32_t v;
+	const uint32_t *p;
+
+	p = (const uint32_t *) &key->src_dst;
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
+	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
+	v = rte_hash_crc_4byte(p[1], v);
+	v = rte_hash_crc_4byte(p[2], v);
+	v = rte_hash_crc_4byte(p[3], v);
+	v = rte_hash_crc_4byte(p[4], v);
+	v = rte_hash_crc_4byte(p[5], v);
+	v = rte_hash_crc_4byte(p[6], v);
+	v = rte_hash_crc_4byte(p[7], v);
+	v = rte_hash_crc_4byte(key->id, v);
+#else
+
+	v = rte_jhash_3words(p[0], p[1], p[2], PRIME_VALUE);
+	v = rte_jhash_3words(p[3], p[4], p[5], v);
+	v = rte_jhash_3words(p[6], p[7], key->id, v);
+#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+
+	*v1 =  v;
+	*v2 = (v << 7) + (v >> 14);
+}
+
 /* check if key is empty */
 static inline int
 ip_frag_key_is_empty(const struct ip_frag_key * key)
@@ -148,6 +235,52 @@ ip_frag_inuse(struct rte_ip_frag_tbl *tbl, const struct  ip_frag_pkt *fp)
 	}
 }
 
+/* prefetch the keys of both buckets the signatures point to */
+static inline void
+ip_frag_tbl_prefetch(const struct rte_ip_frag_tbl *tbl, uint32_t sig1,
+	uint32_t sig2)
+{
+	const struct ip_frag_pkt *p1, *p2;
+	uint32_t i;
+
+	p1 = IP_FRAG_TBL_POS(tbl, sig1);
+	p2 = IP_FRAG_TBL_POS(tbl, sig2);
+
+	for (i = 0; i != tbl->bucket_entries; i++) {
+		rte_prefetch0((const void *)((uintptr_t)p1 +
+			i * tbl->entry_size));
+		rte_prefetch0((const void *)((uintptr_t)p2 +
+			i * tbl->entry_size));
+	}
+}
+
+/* serialize access to shared tables */
+static inline void
+ip_frag_tbl_lock(struct rte_ip_frag_tbl *tbl)
+{
+	if (tbl->flags & RTE_IP_FRAG_TBL_F_SHARED)
+		rte_spinlock_lock(&tbl->lock);
+}
+
+static inline void
+ip_frag_tbl_unlock(struct rte_ip_frag_tbl *tbl)
+{
+	if (tbl->flags & RTE_IP_FRAG_TBL_F_SHARED)
+		rte_spinlock_unlock(&tbl->lock);
+}
+
+/*
+ * make sure the death row can take all mbufs released while processing
+ * one more fragment: the fragments of one table entry plus the fragment itself.
+ */
+static inline void
+ip_frag_dr_reserve(const struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr)
+{
+	if (unlikely(dr->cnt + tbl->max_frags + 1 > RTE_DIM(dr->row)))
+		rte_ip_frag_free_death_row(dr, IP_FRAG_DR_PREFETCH);
+}
+
 /* reset the fragment */
 static inline void
 ip_frag_reset(struct ip_frag_pkt *fp, uint64_t tms)
@@ -166,6 +299,34 @@ ip_frag_reset(struct ip_frag_pkt *fp, uint64_t tms)
 	fp->frags[IP_FIRST_FRAG_IDX] = zero_frag;
 }
 
+/* allocate and reset n mbufs with a single mempool operation */
+static inline int
+ip_frag_mbuf_alloc_bulk(struct rte_mempool *mp, struct rte_mbuf **mbufs,
+	uint32_t n)
+{
+	uint32_t i;
+
+	if (rte_mempool_get_bulk(mp, (void **)mbufs, n) != 0)
+		return -ENOMEM;
+
+	for (i = 0; i != n; i++) {
+		RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(mbufs[i]) == 0);
+		rte_mbuf_refcnt_set(mbufs[i], 1);
+		rte_pktmbuf_reset(mbufs[i]);
+	}
+
+	return 0;
+}
+
+/* check if a packet can be fragmented in place by the burst functions */
+static inline int
+ip_frag_mbuf_is_fast(const struct rte_mbuf *m, uint32_t nb_frags)
+{
+	return m->nb_segs == 1 && RTE_MBUF_DIRECT(m) &&
+		rte_mbuf_refcnt_read(m) == 1 &&
+		nb_frags <= IP_FRAG_FAST_MAX_FRAGS;
+}
+
 /* chain two mbufs */
 static inline void
 ip_frag_chain(struct rte_mbuf *mn, struct rte_mbuf *mp)
@@ -33,18 +33,8 @@
 
 #include <stddef.h>
 
-#include <rte_jhash.h>
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
-#include <rte_hash_crc.h>
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
-
 #include "ip_frag_common.h"
 
-#define	PRIME_VALUE	0xeaad8405
-
-#define	IP_FRAG_TBL_POS(tbl, sig)	\
-	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
-
 #ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
 #else
@@ -86,59 +76,10 @@ ip_frag_tbl_reuse(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 }
 
 
-static inline void
-ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
-{
-	uint32_t v;
-	const uint32_t *p;
-
-	p = (const uint32_t *)&key->src_dst;
-
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
-	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
-	v = rte_hash_crc_4byte(p[1], v);
-	v = rte_hash_crc_4byte(key->id, v);
-#else
-
-	v = rte_jhash_3words(p[0], p[1], key->id, PRIME_VALUE);
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
-
-	*v1 =  v;
-	*v2 = (v << 7) + (v >> 14);
-}
-
-static inline void
-ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
-{
-	uint32_t v;
-	const uint32_t *p;
-
-	p = (const uint32_t *) &key->src_dst;
-
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
-	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
-	v = rte_hash_crc_4byte(p[1], v);
-	v = rte_hash_crc_4byte(p[2], v);
-	v = rte_hash_crc_4byte(p[3], v);
-	v = rte_hash_crc_4byte(p[4], v);
-	v = rte_hash_crc_4byte(p[5], v);
-	v = rte_hash_crc_4byte(p[6], v);
-	v = rte_hash_crc_4byte(p[7], v);
-	v = rte_hash_crc_4byte(key->id, v);
-#else
-
-	v = rte_jhash_3words(p[0], p[1], p[2], PRIME_VALUE);
-	v = rte_jhash_3words(p[3], p[4], p[5], v);
-	v = rte_jhash_3words(p[6], p[7], key->id, v);
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
-
-	*v1 =  v;
-	*v2 = (v << 7) + (v >> 14);
-}
-
 struct rte_mbuf *
 ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
-	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
+	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags,
+	uint32_t max_frags)
 {
 	uint32_t idx;
 
@@ -156,8 +97,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 				IP_LAST_FRAG_IDX : UINT32_MAX;
 
 	/* this is the intermediate fragment. */
-	} else if ((idx = fp->last_idx) <
-		sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	} else if ((idx = fp->last_idx) < max_frags) {
 		fp->last_idx++;
 	}
 
@@ -165,7 +105,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	 * errorneous packet: either exceeed max allowed number of fragments,
 	 * or duplicate first/last fragment encountered.
 	 */
-	if (idx >= sizeof (fp->frags) / sizeof (fp->frags[0])) {
+	if (idx >= max_frags) {
 
 		/* report an error. */
 		if (fp->key.key_len == IPV4_KEYLEN)
@@ -264,28 +204,20 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 
 
 /*
- * Find an entry in the table for the corresponding fragment.
- * If such entry is not present, then allocate a new one.
- * If the entry is stale, then free and reuse it.
+ * Allocate or reuse a table entry according to the lookup results.
  */
-struct ip_frag_pkt *
-ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
-	const struct ip_frag_key *key, uint64_t tms)
+static inline struct ip_frag_pkt *
+ip_frag_find_entry(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, const struct ip_frag_key *key,
+	uint64_t tms, struct ip_frag_pkt *pkt, struct ip_frag_pkt *free,
+	struct ip_frag_pkt *stale)
 {
-	struct ip_frag_pkt *pkt, *free, *stale, *lru;
+	struct ip_frag_pkt *lru;
 	uint64_t max_cycles;
 
-	/*
-	 * Actually the two line below are totally redundant.
-	 * they are here, just to make gcc 4.6 happy.
-	 */
-	free = NULL;
-	stale = NULL;
 	max_cycles = tbl->max_cycles;
 
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
-
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
+	if (pkt == NULL) {
 
 		/*timed-out entry, free and invalidate it*/
 		if (stale != NULL) {
@@ -330,21 +262,59 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	return pkt;
 }
 
+/*
+ * Find an entry in the table for the corresponding fragment.
+ * If such entry is not present, then allocate a new one.
+ * If the entry is stale, then free and reuse it.
+ */
+struct ip_frag_pkt *
+ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	const struct ip_frag_key *key, uint64_t tms)
+{
+	struct ip_frag_pkt *pkt, *free, *stale;
+
+	/*
+	 * Actually the two line below are totally redundant.
+	 * they are here, just to make gcc 4.6 happy.
+	 */
+	free = NULL;
+	stale = NULL;
+
+	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
+
+	pkt = ip_frag_lookup(tbl, key, tms, &free, &stale);
+	return ip_frag_find_entry(tbl, dr, key, tms, pkt, free, stale);
+}
+
+/*
+ * Same as ip_frag_find(), with the key hash values already computed.
+ */
+struct ip_frag_pkt *
+ip_frag_find_sig(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms)
+{
+	struct ip_frag_pkt *pkt, *free, *stale;
+
+	free = NULL;
+	stale = NULL;
+
+	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
+
+	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
+		pkt = tbl->last;
+	else
+		pkt = ip_frag_lookup_sig(tbl, key, sig1, sig2, tms,
+			&free, &stale);
+	return ip_frag_find_entry(tbl, dr, key, tms, pkt, free, stale);
+}
+
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	const struct ip_frag_key *key, uint64_t tms,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
-	struct ip_frag_pkt *p1, *p2;
-	struct ip_frag_pkt *empty, *old;
-	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
-
-	empty = NULL;
-	old = NULL;
-
-	max_cycles = tbl->max_cycles;
-	assoc = tbl->bucket_entries;
+	uint32_t sig1, sig2;
 
 	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
 		return tbl->last;
@@ -355,10 +325,32 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	else
 		ipv6_frag_hash(key, &sig1, &sig2);
 
+	return ip_frag_lookup_sig(tbl, key, sig1, sig2, tms, free, stale);
+}
+
+struct ip_frag_pkt *
+ip_frag_lookup_sig(struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+{
+	struct ip_frag_pkt *p1, *p2, *e1, *e2;
+	struct ip_frag_pkt *empty, *old;
+	uint64_t max_cycles;
+	uint32_t i, assoc;
+
+	empty = NULL;
+	old = NULL;
+
+	max_cycles = tbl->max_cycles;
+	assoc = tbl->bucket_entries;
+
 	p1 = IP_FRAG_TBL_POS(tbl, sig1);
 	p2 = IP_FRAG_TBL_POS(tbl, sig2);
 
 	for (i = 0; i != assoc; i++) {
+		e1 = (struct ip_frag_pkt *)((uintptr_t)p1 + i * tbl->entry_size);
+		e2 = (struct ip_frag_pkt *)((uintptr_t)p2 + i * tbl->entry_size);
+
 		if (p1->key.key_len == IPV4_KEYLEN)
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -367,7 +359,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			p1[i].key.src_dst[0], p1[i].key.id, p1[i].start);
+			e1->key.src_dst[0], e1->key.id, e1->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -376,14 +368,14 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p1, i, assoc,
-			IPv6_KEY_BYTES(p1[i].key.src_dst), p1[i].key.id, p1[i].start);
+			IPv6_KEY_BYTES(e1->key.src_dst), e1->key.id, e1->start);
 
-		if (ip_frag_key_cmp(key, &p1[i].key) == 0)
-			return (p1 + i);
-		else if (ip_frag_key_is_empty(&p1[i].key))
-			empty = (empty == NULL) ? (p1 + i) : empty;
-		else if (max_cycles + p1[i].start < tms)
-			old = (old == NULL) ? (p1 + i) : old;
+		if (ip_frag_key_cmp(key, &e1->key) == 0)
+			return e1;
+		else if (ip_frag_key_is_empty(&e1->key))
+			empty = (empty == NULL) ? e1 : empty;
+		else if (max_cycles + e1->start < tms)
+			old = (old == NULL) ? e1 : old;
 
 		if (p2->key.key_len == IPV4_KEYLEN)
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -393,7 +385,7 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			p2[i].key.src_dst[0], p2[i].key.id, p2[i].start);
+			e2->key.src_dst[0], e2->key.id, e2->start);
 		else
 			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 					"tbl: %p, max_entries: %u, use_entries: %u\n"
@@ -402,14 +394,14 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 					__func__, __LINE__,
 					tbl, tbl->max_entries, tbl->use_entries,
 					p2, i, assoc,
-			IPv6_KEY_BYTES(p2[i].key.src_dst), p2[i].key.id, p2[i].start);
-
-		if (ip_frag_key_cmp(key, &p2[i].key) == 0)
-			return (p2 + i);
-		else if (ip_frag_key_is_empty(&p2[i].key))
-			empty = (empty == NULL) ?( p2 + i) : empty;
-		else if (max_cycles + p2[i].start < tms)
-			old = (old == NULL) ? (p2 + i) : old;
+			IPv6_KEY_BYTES(e2->key.src_dst), e2->key.id, e2->start);
+
+		if (ip_frag_key_cmp(key, &e2->key) == 0)
+			return e2;
+		else if (ip_frag_key_is_empty(&e2->key))
+			empty = (empty == NULL) ? e2 : empty;
+		else if (max_cycles + e2->start < tms)
+			old = (old == NULL) ? e2 : old;
 	}
 
 	*free = empty;
@@ -50,6 +50,7 @@ extern "C" {
 
 #include <rte_malloc.h>
 #include <rte_memory.h>
+#include <rte_spinlock.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
 
@@ -80,6 +81,8 @@ struct ip_frag_key {
 /*
  * @internal Fragmented packet to reassemble.
  * First two entries in the frags[] array are for the last and first fragments.
+ * The size of frags[] is set per table at creation time (see max_frags in
+ * struct rte_ip_frag_tbl_params), so entries are of variable size.
  */
 struct ip_frag_pkt {
 	TAILQ_ENTRY(ip_frag_pkt) lru;   /**< LRU list */
@@ -88,11 +91,17 @@ struct ip_frag_pkt {
 	uint32_t             total_size;  /**< expected reassembled size */
 	uint32_t             frag_size;   /**< size of fragments received */
 	uint32_t             last_idx;    /**< index of next entry to fill */
-	struct ip_frag       frags[IP_MAX_FRAG_NUM]; /**< fragments */
+	struct ip_frag       frags[0];    /**< fragments */
 } __rte_cache_aligned;
 
 #define IP_FRAG_DEATH_ROW_LEN 32 /**< death row size (in packets) */
 
+/** maximum value allowed for rte_ip_frag_tbl_params.max_frags */
+#define IP_FRAG_TBL_MAX_FRAGS 64
+
+/** table flag: table is shared between multiple lcores */
+#define RTE_IP_FRAG_TBL_F_SHARED 0x1
+
 /** mbuf death row (packets to be freed) */
 struct rte_ip_frag_death_row {
 	uint32_t cnt;          /**< number of mbufs currently on death row */
@@ -121,10 +130,26 @@ struct rte_ip_frag_tbl {
 	uint32_t             bucket_entries;  /**< hash assocaitivity. */
 	uint32_t             nb_entries;      /**< total size of the table. */
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
+	uint32_t             max_frags;       /**< max fragments per packet. */
+	uint32_t             entry_size;      /**< size of one table entry. */
+	uint32_t             flags;           /**< RTE_IP_FRAG_TBL_F_* flags. */
+	rte_spinlock_t       lock;            /**< lock for shared tables. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
 	struct ip_pkt_list lru;           /**< LRU list for table entries. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
-	struct ip_frag_pkt pkt[0];        /**< hash table. */
+	struct ip_frag_pkt pkt[0];        /**< hash table (entry_size stride). */
+};
+
+/** fragmentation table creation parameters */
+struct rte_ip_frag_tbl_params {
+	uint32_t bucket_num;     /**< number of buckets in the hash table. */
+	uint32_t bucket_entries; /**< entries per bucket, power of two. */
+	uint32_t max_entries;    /**< max entries stored in the table. */
+	uint32_t max_frags;
+	/**< max fragments per packet, IP_MAX_FRAG_NUM when set to 0. */
+	uint64_t max_cycles;     /**< TTL in cycles for each fragmented packet. */
+	int socket_id;           /**< NUMA socket to allocate the table on. */
+	uint32_t flags;          /**< RTE_IP_FRAG_TBL_F_* flags. */
 };
 
 /** IPv6 fragment extension header */
@@ -169,6 +194,23 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/*
+ * Create a new IP fragmentation table with extended parameters.
+ *
+ * Unlike rte_ip_frag_table_create(), this allows setting the maximum
+ * number of fragments per packet at run time (up to IP_FRAG_TBL_MAX_FRAGS)
+ * and creating a table shared by several lcores (RTE_IP_FRAG_TBL_F_SHARED).
+ * Access to a shared table is serialized with a spinlock that the burst
+ * reassembly functions take once per burst.
+ *
+ * @param params
+ *   Table creation parameters.
+ * @return
+ *   The pointer to the new allocated fragmentation table, on success. NULL on error.
+ */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(const struct rte_ip_frag_tbl_params *params);
+
 /*
  * Free allocated IP fragmentation table.
  *
@@ -210,6 +252,50 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 		struct rte_mempool *pool_direct,
 		struct rte_mempool *pool_indirect);
 
+/**
+ * IPv6 burst fragmentation.
+ *
+ * Fragment a burst of IPv6 packets. Packets not larger than mtu_size are
+ * moved to pkts_out unchanged, larger packets are replaced by their
+ * fragments. A single segment packet that is not shared (reference count
+ * of 1) and has at least 8 bytes of headroom is fragmented in place: the
+ * packet mbuf is reused as the first fragment, every other fragment is a
+ * direct mbuf holding only the IPv6 and fragment headers, built from a
+ * template computed once per packet, chained to an indirect mbuf attached
+ * to the packet data. The mbufs of all fragments of a packet are taken
+ * from the pools with one bulk operation per pool. Other packets are
+ * fragmented by rte_ipv6_fragment_packet() and freed.
+ * Like rte_ipv6_fragment_packet(), packets are expected to start with
+ * the IPv6 header and not to have extension headers.
+ *
+ * @param pkts_in
+ *   The input packets.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output packets.
+ * @param nb_pkts_out
+ *   Size of the pkts_out array on input, number of output packets placed
+ *   in the pkts_out array on output.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv6
+ *   datagrams. This value includes the size of the IPv6 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @return
+ *   Number of input packets consumed. Processing stops at the first packet
+ *   whose fragments do not fit in pkts_out or when mbuf allocation fails;
+ *   this packet and the following ones are left to the caller.
+ */
+uint16_t
+rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size,
+		struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect);
+
 /*
  * This function implements reassembly of fragmented IPv6 packets.
  * Incoming mbuf should have its l2_len/l3_len fields setup correctly.
@@ -236,6 +322,34 @@ struct rte_mbuf *rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_mbuf *mb, uint64_t tms, struct ipv6_hdr *ip_hdr,
 		struct ipv6_extension_fragment *frag_hdr);
 
+/*
+ * Reassemble a burst of IPv6 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ *
+ * Packets without a fragment header are passed through unchanged. Fragments
+ * are added to the table and replaced by the reassembled packet once the
+ * last missing fragment is received. The pkts array is compacted in place,
+ * preserving the relative order of the packets. Table buckets are
+ * prefetched ahead of the lookups.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to. It is flushed by the function when needed
+ *   to make room for the buffers of the whole burst.
+ * @param pkts
+ *   Array of incoming mbufs, overwritten with the output packets.
+ * @param nb_pkts
+ *   Number of mbufs in the pkts array.
+ * @param tms
+ *   Arrival timestamp of the burst.
+ * @return
+ *   Number of packets left in the pkts array.
+ */
+uint16_t rte_ipv6_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint64_t tms);
+
 /*
  * Return a pointer to the packet's fragment header, if found.
  * It only looks at the extension header that's right after the fixed IPv6
@@ -286,6 +400,52 @@ int32_t rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 			struct rte_mempool *pool_direct,
 			struct rte_mempool *pool_indirect);
 
+/**
+ * IPv4 burst fragmentation.
+ *
+ * Fragment a burst of IPv4 packets. Packets not larger than mtu_size are
+ * moved to pkts_out unchanged, larger packets are replaced by their
+ * fragments and packets with the Don't Fragment flag set are freed.
+ * A single segment packet that is not shared (reference count of 1) is
+ * fragmented in place: the packet mbuf is reused as the first fragment,
+ * every other fragment is a direct mbuf holding only the IPv4 header,
+ * built from a template computed once per packet, chained to an indirect
+ * mbuf attached to the packet data. The mbufs of all fragments of a packet
+ * are taken from the pools with one bulk operation per pool. Other packets
+ * are fragmented by rte_ipv4_fragment_packet() and freed.
+ * Like rte_ipv4_fragment_packet(), packets are expected to start with
+ * the IPv4 header. Whichever function builds them, the header checksum of
+ * the fragments is set to zero and their offload flags are set to
+ * PKT_TX_IP_CKSUM only.
+ *
+ * @param pkts_in
+ *   The input packets.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output packets.
+ * @param nb_pkts_out
+ *   Size of the pkts_out array on input, number of output packets placed
+ *   in the pkts_out array on output.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv4
+ *   datagrams. This value includes the size of the IPv4 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @return
+ *   Number of input packets consumed. Processing stops at the first packet
+ *   whose fragments do not fit in pkts_out or when mbuf allocation fails;
+ *   this packet and the following ones are left to the caller.
+ */
+uint16_t
+rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size,
+		struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect);
+
 /*
  * This function implements reassembly of fragmented IPv4 packets.
  * Incoming mbufs should have its l2_len/l3_len fields setup correclty.
@@ -309,6 +469,34 @@ struct rte_mbuf * rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		struct rte_mbuf *mb, uint64_t tms, struct ipv4_hdr *ip_hdr);
 
+/*
+ * Reassemble a burst of IPv4 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ *
+ * Non-fragmented packets are passed through unchanged. Fragments are added
+ * to the table and replaced by the reassembled packet once the last missing
+ * fragment is received. The pkts array is compacted in place, preserving
+ * the relative order of the packets. Table buckets are prefetched ahead of
+ * the lookups.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to. It is flushed by the function when needed
+ *   to make room for the buffers of the whole burst.
+ * @param pkts
+ *   Array of incoming mbufs, overwritten with the output packets.
+ * @param nb_pkts
+ *   Number of mbufs in the pkts array.
+ * @param tms
+ *   Arrival timestamp of the burst.
+ * @return
+ *   Number of packets left in the pkts array.
+ */
+uint16_t rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint64_t tms);
+
 /*
  * Check if the IPv4 packet is fragmented
  *
@@ -69,41 +69,77 @@ rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 struct rte_ip_frag_tbl *
 rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+{
+	struct rte_ip_frag_tbl_params params = {
+		.bucket_num = bucket_num,
+		.bucket_entries = bucket_entries,
+		.max_entries = max_entries,
+		.max_frags = IP_MAX_FRAG_NUM,
+		.max_cycles = max_cycles,
+		.socket_id = socket_id,
+		.flags = 0,
+	};
+
+	return rte_ip_frag_table_create_ext(&params);
+}
+
+/* create fragmentation table with extended parameters */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(const struct rte_ip_frag_tbl_params *params)
 {
 	struct rte_ip_frag_tbl *tbl;
-	size_t sz;
+	size_t sz, entry_size;
 	uint64_t nb_entries;
+	uint32_t max_frags;
+
+	if (params == NULL) {
+		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
+		return NULL;
+	}
 
-	nb_entries = rte_align32pow2(bucket_num);
-	nb_entries *= bucket_entries;
+	max_frags = (params->max_frags == 0) ?
+		IP_MAX_FRAG_NUM : params->max_frags;
+
+	nb_entries = rte_align32pow2(params->bucket_num);
+	nb_entries *= params->bucket_entries;
 	nb_entries *= IP_FRAG_HASH_FNUM;
 
 	/* check input parameters. */
-	if (rte_is_power_of_2(bucket_entries) == 0 ||
+	if (rte_is_power_of_2(params->bucket_entries) == 0 ||
 			nb_entries > UINT32_MAX || nb_entries == 0 ||
-			nb_entries < max_entries) {
+			nb_entries < params->max_entries ||
+			max_frags < IP_MIN_FRAG_NUM ||
+			max_frags > IP_FRAG_TBL_MAX_FRAGS ||
+			(params->flags & ~RTE_IP_FRAG_TBL_F_SHARED) != 0) {
 		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
 		return NULL;
 	}
 
-	sz = sizeof (*tbl) + nb_entries * sizeof (tbl->pkt[0]);
+	entry_size = RTE_ALIGN_CEIL(offsetof(struct ip_frag_pkt, frags) +
+		max_frags * sizeof(struct ip_frag), RTE_CACHE_LINE_SIZE);
+
+	sz = sizeof (*tbl) + nb_entries * entry_size;
 	if ((tbl = rte_zmalloc_socket(__func__, sz, RTE_CACHE_LINE_SIZE,
-			socket_id)) == NULL) {
+			params->socket_id)) == NULL) {
 		RTE_LOG(ERR, USER1,
 			"%s: allocation of %zu bytes at socket %d failed do\n",
-			__func__, sz, socket_id);
+			__func__, sz, params->socket_id);
 		return NULL;
 	}
 
 	RTE_LOG(INFO, USER1, "%s: allocated of %zu bytes at socket %d\n",
-		__func__, sz, socket_id);
+		__func__, sz, params->socket_id);
 
-	tbl->max_cycles = max_cycles;
-	tbl->max_entries = max_entries;
+	tbl->max_cycles = params->max_cycles;
+	tbl->max_entries = params->max_entries;
 	tbl->nb_entries = (uint32_t)nb_entries;
-	tbl->nb_buckets = bucket_num;
-	tbl->bucket_entries = bucket_entries;
+	tbl->nb_buckets = params->bucket_num;
+	tbl->bucket_entries = params->bucket_entries;
 	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->max_frags = max_frags;
+	tbl->entry_size = (uint32_t)entry_size;
+	tbl->flags = params->flags;
+	rte_spinlock_init(&tbl->lock);
 
 	TAILQ_INIT(&(tbl->lru));
 	return tbl;
@@ -119,6 +155,7 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 	fail_nospace = tbl->stat.fail_nospace;
 
 	fprintf(f, "max entries:\t%u;\n"
+		"max fragments per packet:\t%u;\n"
 		"entries in use:\t%u;\n"
 		"finds/inserts:\t%" PRIu64 ";\n"
 		"entries added:\t%" PRIu64 ";\n"
@@ -128,6 +165,7 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		"add no-space failures:\t%" PRIu64 ";\n"
 		"add hash-collisions failures:\t%" PRIu64 ";\n",
 		tbl->max_entries,
+		tbl->max_frags,
 		tbl->use_entries,
 		tbl->stat.find_num,
 		tbl->stat.add_num,
@@ -207,3 +207,159 @@ rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+/*
+ * Fragment a single segment packet in place: the packet mbuf becomes the
+ * first fragment, each other fragment is a direct mbuf holding only the
+ * IPv4 header, chained with an indirect mbuf attached to the packet.
+ */
+static inline int32_t
+ipv4_fragment_fast(struct rte_mbuf *m, struct rte_mbuf **pkts_out,
+	uint32_t nb_frags, uint16_t frag_size, uint16_t flag_offset,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *ind[IP_FRAG_FAST_MAX_FRAGS - 1];
+	struct rte_mbuf *out_pkt, *out_seg;
+	struct ipv4_hdr tmpl, *in_hdr, *out_hdr;
+	uint32_t i, ofs, len, payload_len;
+	uint16_t fofs, data_off;
+
+	/* two mempool operations per packet instead of two per fragment. */
+	if (ip_frag_mbuf_alloc_bulk(pool_direct, &pkts_out[1],
+			nb_frags - 1) != 0)
+		return -ENOMEM;
+	if (ip_frag_mbuf_alloc_bulk(pool_indirect, ind, nb_frags - 1) != 0) {
+		__free_fragments(&pkts_out[1], nb_frags - 1);
+		return -ENOMEM;
+	}
+
+	in_hdr = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+	payload_len = m->pkt_len - sizeof(struct ipv4_hdr);
+	data_off = m->data_off;
+
+	/* header template, only length and offset differ between fragments. */
+	tmpl = *in_hdr;
+	tmpl.hdr_checksum = 0;
+
+	for (i = 1; i != nb_frags; i++) {
+		ofs = i * frag_size;
+		len = RTE_MIN((uint32_t)frag_size, payload_len - ofs);
+
+		fofs = (uint16_t)(flag_offset + (ofs >> IPV4_HDR_FO_SHIFT));
+		if (i != nb_frags - 1)
+			fofs |= IPV4_HDR_MF_MASK;
+
+		out_pkt = pkts_out[i];
+		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv4_hdr *);
+		*out_hdr = tmpl;
+		out_hdr->total_length = rte_cpu_to_be_16(
+			(uint16_t)(sizeof(struct ipv4_hdr) + len));
+		out_hdr->fragment_offset = rte_cpu_to_be_16(fofs);
+
+		out_seg = ind[i - 1];
+		rte_pktmbuf_attach(out_seg, m);
+		out_seg->data_off = (uint16_t)(data_off +
+			sizeof(struct ipv4_hdr) + ofs);
+		out_seg->data_len = (uint16_t)len;
+		out_seg->pkt_len = len;
+
+		out_pkt->next = out_seg;
+		out_pkt->nb_segs = 2;
+		out_pkt->data_len = sizeof(struct ipv4_hdr);
+		out_pkt->pkt_len = sizeof(struct ipv4_hdr) + len;
+		out_pkt->ol_flags |= PKT_TX_IP_CKSUM;
+		out_pkt->l3_len = sizeof(struct ipv4_hdr);
+	}
+
+	/* the packet itself is the first fragment. */
+	in_hdr->total_length = rte_cpu_to_be_16(
+		(uint16_t)(sizeof(struct ipv4_hdr) + frag_size));
+	in_hdr->fragment_offset = rte_cpu_to_be_16(
+		(uint16_t)(flag_offset | IPV4_HDR_MF_MASK));
+	in_hdr->hdr_checksum = 0;
+
+	m->data_len = (uint16_t)(sizeof(struct ipv4_hdr) + frag_size);
+	m->pkt_len = m->data_len;
+	/* same flags as the fragments built by rte_ipv4_fragment_packet(). */
+	m->ol_flags = PKT_TX_IP_CKSUM;
+	m->l3_len = sizeof(struct ipv4_hdr);
+	pkts_out[0] = m;
+
+	return nb_frags;
+}
+
+/**
+ * IPv4 burst fragmentation.
+ *
+ * @see rte_ipv4_fragment_burst() in rte_ip_frag.h.
+ */
+uint16_t
+rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *in_hdr;
+	uint32_t i, n, nb_out, nb_frags;
+	uint16_t frag_size, flag_offset;
+	int32_t ret;
+
+	/* Fragment size should be a multiply of 8. */
+	frag_size = (uint16_t)((mtu_size - sizeof(struct ipv4_hdr)) &
+		~IPV4_HDR_FO_MASK);
+
+	n = *nb_pkts_out;
+	nb_out = 0;
+
+	if (unlikely(mtu_size <= sizeof(struct ipv4_hdr) || frag_size == 0)) {
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	for (i = 0; i != nb_pkts_in; i++) {
+		m = pkts_in[i];
+
+		/* no need to fragment. */
+		if (m->pkt_len <= mtu_size) {
+			if (nb_out == n)
+				break;
+			pkts_out[nb_out++] = m;
+			continue;
+		}
+
+		in_hdr = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+		flag_offset = rte_be_to_cpu_16(in_hdr->fragment_offset);
+
+		/* Don't Fragment flag is set, drop the packet. */
+		if (unlikely((flag_offset & IPV4_HDR_DF_MASK) != 0)) {
+			rte_pktmbuf_free(m);
+			continue;
+		}
+
+		nb_frags = (m->pkt_len - sizeof(struct ipv4_hdr) +
+			frag_size - 1) / frag_size;
+		if (nb_frags > n - nb_out)
+			break;
+
+		if (ip_frag_mbuf_is_fast(m, nb_frags)) {
+			ret = ipv4_fragment_fast(m, &pkts_out[nb_out], nb_frags,
+				frag_size, flag_offset, pool_direct,
+				pool_indirect);
+		} else {
+			ret = rte_ipv4_fragment_packet(m, &pkts_out[nb_out],
+				(uint16_t)(n - nb_out),
+				(uint16_t)(sizeof(struct ipv4_hdr) + frag_size),
+				pool_direct, pool_indirect);
+			if (ret > 0)
+				rte_pktmbuf_free(m);
+		}
+
+		if (unlikely(ret < 0))
+			break;
+
+		nb_out += ret;
+	}
+
+	*nb_pkts_out = (uint16_t)nb_out;
+	return (uint16_t)i;
+}
@@ -96,6 +96,31 @@ ipv4_frag_reassemble(const struct ip_frag_pkt *fp)
 	return m;
 }
 
+/*
+ * Extract the fragment key, offset, length and MF flag from IPv4 header.
+ */
+static inline void
+ipv4_frag_parse(const struct rte_mbuf *mb, const struct ipv4_hdr *ip_hdr,
+	struct ip_frag_key *key, uint16_t *ofs, uint16_t *len, uint16_t *flag)
+{
+	const unaligned_uint64_t *psd;
+	uint16_t flag_offset;
+
+	flag_offset = rte_be_to_cpu_16(ip_hdr->fragment_offset);
+	*ofs = (uint16_t)((flag_offset & IPV4_HDR_OFFSET_MASK) *
+		IPV4_HDR_OFFSET_UNITS);
+	*flag = (uint16_t)(flag_offset & IPV4_HDR_MF_FLAG);
+
+	psd = (const unaligned_uint64_t *)&ip_hdr->src_addr;
+	/* use first 8 bytes only */
+	key->src_dst[0] = psd[0];
+	key->id = ip_hdr->packet_id;
+	key->key_len = IPV4_KEYLEN;
+
+	*len = (uint16_t)(rte_be_to_cpu_16(ip_hdr->total_length) -
+		mb->l3_len);
+}
+
 /*
  * Process new mbuf with fragment of IPV4 packet.
  * Incoming mbuf should have it's l2_len/l3_len fields setuped correclty.
@@ -119,23 +144,9 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 {
 	struct ip_frag_pkt *fp;
 	struct ip_frag_key key;
-	const unaligned_uint64_t *psd;
-	uint16_t ip_len;
-	uint16_t flag_offset, ip_ofs, ip_flag;
-
-	flag_offset = rte_be_to_cpu_16(ip_hdr->fragment_offset);
-	ip_ofs = (uint16_t)(flag_offset & IPV4_HDR_OFFSET_MASK);
-	ip_flag = (uint16_t)(flag_offset & IPV4_HDR_MF_FLAG);
+	uint16_t ip_len, ip_ofs, ip_flag;
 
-	psd = (unaligned_uint64_t *)&ip_hdr->src_addr;
-	/* use first 8 bytes only */
-	key.src_dst[0] = psd[0];
-	key.id = ip_hdr->packet_id;
-	key.key_len = IPV4_KEYLEN;
-
-	ip_ofs *= IPV4_HDR_OFFSET_UNITS;
-	ip_len = (uint16_t)(rte_be_to_cpu_16(ip_hdr->total_length) -
-		mb->l3_len);
+	ipv4_frag_parse(mb, ip_hdr, &key, &ip_ofs, &ip_len, &ip_flag);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 		"mbuf: %p, tms: %" PRIu64
@@ -147,8 +158,12 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	ip_frag_dr_reserve(tbl, dr);
+	ip_frag_tbl_lock(tbl);
+
 	/* try to find/add entry into the fragment's table. */
 	if ((fp = ip_frag_find(tbl, dr, &key, tms)) == NULL) {
+		ip_frag_tbl_unlock(tbl);
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
 	}
@@ -164,7 +179,8 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len, ip_flag);
+	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len, ip_flag,
+		tbl->max_frags);
 	ip_frag_inuse(tbl, fp);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -177,5 +193,81 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		fp, fp->key.src_dst[0], fp->key.id, fp->start,
 		fp->total_size, fp->frag_size, fp->last_idx);
 
+	ip_frag_tbl_unlock(tbl);
+
 	return mb;
 }
+
+/*
+ * Process a burst of IPV4 packets.
+ * Keys of up to IP_FRAG_BURST_WINDOW fragments are hashed and their table
+ * buckets prefetched before any of them is looked up.
+ */
+uint16_t
+rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint64_t tms)
+{
+	struct ip_frag_key key[IP_FRAG_BURST_WINDOW];
+	uint32_t sig1[IP_FRAG_BURST_WINDOW], sig2[IP_FRAG_BURST_WINDOW];
+	uint16_t ip_ofs[IP_FRAG_BURST_WINDOW], ip_len[IP_FRAG_BURST_WINDOW];
+	uint16_t ip_flag[IP_FRAG_BURST_WINDOW];
+	uint8_t is_frag[IP_FRAG_BURST_WINDOW];
+	struct ip_frag_pkt *fp;
+	struct ipv4_hdr *ip_hdr;
+	struct rte_mbuf *mb;
+	uint32_t i, j, k, n;
+
+	n = 0;
+	ip_frag_tbl_lock(tbl);
+
+	for (i = 0; i < nb_pkts; i += k) {
+		k = RTE_MIN(nb_pkts - i, (uint32_t)IP_FRAG_BURST_WINDOW);
+
+		/* hash the keys and prefetch the buckets. */
+		for (j = 0; j != k; j++) {
+			mb = pkts[i + j];
+			ip_hdr = rte_pktmbuf_mtod_offset(mb, struct ipv4_hdr *,
+				mb->l2_len);
+
+			is_frag[j] = (uint8_t)rte_ipv4_frag_pkt_is_fragmented(ip_hdr);
+			if (is_frag[j] == 0)
+				continue;
+
+			ipv4_frag_parse(mb, ip_hdr, &key[j], &ip_ofs[j],
+				&ip_len[j], &ip_flag[j]);
+			ipv4_frag_hash(&key[j], &sig1[j], &sig2[j]);
+			ip_frag_tbl_prefetch(tbl, sig1[j], sig2[j]);
+		}
+
+		/* find/add the entries and process the fragments. */
+		for (j = 0; j != k; j++) {
+			mb = pkts[i + j];
+
+			if (is_frag[j] == 0) {
+				pkts[n++] = mb;
+				continue;
+			}
+
+			ip_frag_dr_reserve(tbl, dr);
+
+			fp = ip_frag_find_sig(tbl, dr, &key[j], sig1[j], sig2[j],
+				tms);
+			if (fp == NULL) {
+				IP_FRAG_MBUF2DR(dr, mb);
+				continue;
+			}
+
+			mb = ip_frag_process(fp, dr, mb, ip_ofs[j], ip_len[j],
+				ip_flag[j], tbl->max_frags);
+			ip_frag_inuse(tbl, fp);
+
+			if (mb != NULL)
+				pkts[n++] = mb;
+		}
+	}
+
+	ip_frag_tbl_unlock(tbl);
+
+	return (uint16_t)n;
+}
@@ -35,6 +35,8 @@
 #include <errno.h>
 
 #include <rte_memcpy.h>
+#include <rte_lcore.h>
+#include <rte_per_lcore.h>
 
 #include "ip_frag_common.h"
 
@@ -52,10 +54,22 @@
 #define	IPV6_HDR_MF_MASK			(1 << IPV6_HDR_MF_SHIFT)
 #define	IPV6_HDR_FO_MASK			((1 << IPV6_HDR_FO_SHIFT) - 1)
 
+/* Identification of the fragmented datagrams sent by this lcore */
+static RTE_DEFINE_PER_LCORE(uint32_t, ipv6_frag_id);
+
+static inline uint32_t
+__next_ipv6_frag_id(void)
+{
+	uint32_t id;
+
+	id = RTE_PER_LCORE(ipv6_frag_id)++ & 0xffffff;
+	return rte_cpu_to_be_32((rte_lcore_id() << 24) | id);
+}
+
 static inline void
 __fill_ipv6hdr_frag(struct ipv6_hdr *dst,
 		const struct ipv6_hdr *src, uint16_t len, uint16_t fofs,
-		uint32_t mf)
+		uint32_t mf, uint32_t id)
 {
 	struct ipv6_extension_fragment *fh;
 
@@ -66,10 +80,9 @@ __fill_ipv6hdr_frag(struct ipv6_hdr *dst,
 	fh = (struct ipv6_extension_fragment *) ++dst;
 	fh->next_header = src->proto;
 	fh->reserved1   = 0;
-	fh->frag_offset = rte_cpu_to_be_16(fofs);
-	fh->reserved2   = 0;
-	fh->more_frags  = rte_cpu_to_be_16(mf);
-	fh->id = 0;
+	/* offset is in bytes and a multiple of 8, M flag is the lowest bit */
+	fh->frag_data   = rte_cpu_to_be_16((uint16_t)(fofs | mf));
+	fh->id = id;
 }
 
 static inline void
@@ -112,7 +125,7 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 	struct rte_mbuf *in_seg = NULL;
 	struct ipv6_hdr *in_hdr;
 	uint32_t out_pkt_pos, in_seg_data_pos;
-	uint32_t more_in_segs;
+	uint32_t more_in_segs, frag_id;
 	uint16_t fragment_offset, frag_size;
 
 	frag_size = (uint16_t)(mtu_size - sizeof(struct ipv6_hdr));
@@ -126,6 +139,7 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 		return -EINVAL;
 
 	in_hdr = rte_pktmbuf_mtod(pkt_in, struct ipv6_hdr *);
+	frag_id = __next_ipv6_frag_id();
 
 	in_seg = pkt_in;
 	in_seg_data_pos = sizeof(struct ipv6_hdr);
@@ -200,12 +214,15 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 
 		__fill_ipv6hdr_frag(out_hdr, in_hdr,
 		    (uint16_t) out_pkt->pkt_len - sizeof(struct ipv6_hdr),
-		    fragment_offset, more_in_segs);
+		    fragment_offset, more_in_segs, frag_id);
 
 		fragment_offset = (uint16_t)(fragment_offset +
 		    out_pkt->pkt_len - sizeof(struct ipv6_hdr)
 			- sizeof(struct ipv6_extension_fragment));
 
+		out_pkt->l3_len = sizeof(struct ipv6_hdr) +
+			sizeof(struct ipv6_extension_fragment);
+
 		/* Write the fragment to the output list */
 		pkts_out[out_pkt_pos] = out_pkt;
 		out_pkt_pos ++;
@@ -213,3 +230,166 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+/*
+ * Fragment a single segment packet in place: the packet mbuf becomes the
+ * first fragment (its IPv6 header is moved into the headroom to make room
+ * for the fragment header), each other fragment is a direct mbuf holding
+ * only the IPv6 and fragment headers, chained with an indirect mbuf
+ * attached to the packet.
+ */
+static inline int32_t
+ipv6_fragment_fast(struct rte_mbuf *m, struct rte_mbuf **pkts_out,
+	uint32_t nb_frags, uint16_t frag_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *ind[IP_FRAG_FAST_MAX_FRAGS - 1];
+	struct rte_mbuf *out_pkt, *out_seg;
+	struct ipv6_hdr tmpl, *in_hdr, *out_hdr;
+	struct ipv6_extension_fragment fh_tmpl, *fh;
+	uint32_t i, ofs, len, payload_len;
+	uint16_t data_off;
+
+	/* two mempool operations per packet instead of two per fragment. */
+	if (ip_frag_mbuf_alloc_bulk(pool_direct, &pkts_out[1],
+			nb_frags - 1) != 0)
+		return -ENOMEM;
+	if (ip_frag_mbuf_alloc_bulk(pool_indirect, ind, nb_frags - 1) != 0) {
+		__free_fragments(&pkts_out[1], nb_frags - 1);
+		return -ENOMEM;
+	}
+
+	in_hdr = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+	payload_len = m->pkt_len - sizeof(struct ipv6_hdr);
+	data_off = m->data_off;
+
+	/* header templates, only length and offset differ between fragments. */
+	tmpl = *in_hdr;
+	tmpl.proto = IPPROTO_FRAGMENT;
+
+	fh_tmpl.next_header = in_hdr->proto;
+	fh_tmpl.reserved1 = 0;
+	fh_tmpl.frag_data = 0;
+	fh_tmpl.id = __next_ipv6_frag_id();
+
+	for (i = 1; i != nb_frags; i++) {
+		ofs = i * frag_size;
+		len = RTE_MIN((uint32_t)frag_size, payload_len - ofs);
+
+		out_pkt = pkts_out[i];
+		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv6_hdr *);
+		*out_hdr = tmpl;
+		out_hdr->payload_len = rte_cpu_to_be_16(
+			(uint16_t)(sizeof(*fh) + len));
+
+		fh = (struct ipv6_extension_fragment *)(out_hdr + 1);
+		*fh = fh_tmpl;
+		fh->frag_data = rte_cpu_to_be_16((uint16_t)(ofs |
+			(i != nb_frags - 1)));
+
+		out_seg = ind[i - 1];
+		rte_pktmbuf_attach(out_seg, m);
+		out_seg->data_off = (uint16_t)(data_off +
+			sizeof(struct ipv6_hdr) + ofs);
+		out_seg->data_len = (uint16_t)len;
+		out_seg->pkt_len = len;
+
+		out_pkt->next = out_seg;
+		out_pkt->nb_segs = 2;
+		out_pkt->data_len = sizeof(*out_hdr) + sizeof(*fh);
+		out_pkt->pkt_len = out_pkt->data_len + len;
+		out_pkt->l3_len = sizeof(*out_hdr) + sizeof(*fh);
+	}
+
+	/* the packet itself is the first fragment. */
+	out_hdr = (struct ipv6_hdr *)rte_pktmbuf_prepend(m, sizeof(*fh));
+	memmove(out_hdr, in_hdr, sizeof(*out_hdr));
+	out_hdr->payload_len = rte_cpu_to_be_16(
+		(uint16_t)(sizeof(*fh) + frag_size));
+	out_hdr->proto = IPPROTO_FRAGMENT;
+
+	fh = (struct ipv6_extension_fragment *)(out_hdr + 1);
+	*fh = fh_tmpl;
+	fh->frag_data = rte_cpu_to_be_16(IPV6_HDR_MF_MASK);
+
+	m->data_len = (uint16_t)(sizeof(*out_hdr) + sizeof(*fh) + frag_size);
+	m->pkt_len = m->data_len;
+	m->l3_len = sizeof(*out_hdr) + sizeof(*fh);
+	pkts_out[0] = m;
+
+	return nb_frags;
+}
+
+/**
+ * IPv6 burst fragmentation.
+ *
+ * @see rte_ipv6_fragment_burst() in rte_ip_frag.h.
+ */
+uint16_t
+rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *m;
+	uint32_t i, n, nb_out, nb_frags;
+	uint16_t frag_size;
+	int32_t ret;
+
+	n = *nb_pkts_out;
+	nb_out = 0;
+
+	if (unlikely(mtu_size <= sizeof(struct ipv6_hdr) +
+			sizeof(struct ipv6_extension_fragment))) {
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	/* Fragment size should be a multiple of 8. */
+	frag_size = (uint16_t)((mtu_size - sizeof(struct ipv6_hdr) -
+		sizeof(struct ipv6_extension_fragment)) & ~IPV6_HDR_FO_MASK);
+	if (unlikely(frag_size == 0)) {
+		*nb_pkts_out = 0;
+		return 0;
+	}
+
+	for (i = 0; i != nb_pkts_in; i++) {
+		m = pkts_in[i];
+
+		/* no need to fragment. */
+		if (m->pkt_len <= mtu_size) {
+			if (nb_out == n)
+				break;
+			pkts_out[nb_out++] = m;
+			continue;
+		}
+
+		nb_frags = (m->pkt_len - sizeof(struct ipv6_hdr) +
+			frag_size - 1) / frag_size;
+		if (nb_frags > n - nb_out)
+			break;
+
+		if (ip_frag_mbuf_is_fast(m, nb_frags) &&
+				rte_pktmbuf_headroom(m) >=
+				sizeof(struct ipv6_extension_fragment)) {
+			ret = ipv6_fragment_fast(m, &pkts_out[nb_out], nb_frags,
+				frag_size, pool_direct, pool_indirect);
+		} else {
+			ret = rte_ipv6_fragment_packet(m, &pkts_out[nb_out],
+				(uint16_t)(n - nb_out),
+				(uint16_t)(sizeof(struct ipv6_hdr) +
+				sizeof(struct ipv6_extension_fragment) +
+				frag_size),
+				pool_direct, pool_indirect);
+			if (ret > 0)
+				rte_pktmbuf_free(m);
+		}
+
+		if (unlikely(ret < 0))
+			break;
+
+		nb_out += ret;
+	}
+
+	*nb_pkts_out = (uint16_t)nb_out;
+	return (uint16_t)i;
+}
@@ -151,29 +151,41 @@ ipv6_frag_reassemble(const struct ip_frag_pkt *fp)
  */
 #define MORE_FRAGS(x) (((x) & 0x100) >> 8)
 #define FRAG_OFFSET(x) (rte_cpu_to_be_16(x) >> 3)
-struct rte_mbuf *
-rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
-		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint64_t tms,
-		struct ipv6_hdr *ip_hdr, struct ipv6_extension_fragment *frag_hdr)
-{
-	struct ip_frag_pkt *fp;
-	struct ip_frag_key key;
-	uint16_t ip_len, ip_ofs;
 
-	rte_memcpy(&key.src_dst[0], ip_hdr->src_addr, 16);
-	rte_memcpy(&key.src_dst[2], ip_hdr->dst_addr, 16);
+/*
+ * Extract the fragment key, offset and length from IPv6 headers.
+ */
+static inline void
+ipv6_frag_parse(const struct ipv6_hdr *ip_hdr,
+	const struct ipv6_extension_fragment *frag_hdr,
+	struct ip_frag_key *key, uint16_t *ofs, uint16_t *len)
+{
+	rte_memcpy(&key->src_dst[0], ip_hdr->src_addr, 16);
+	rte_memcpy(&key->src_dst[2], ip_hdr->dst_addr, 16);
 
-	key.id = frag_hdr->id;
-	key.key_len = IPV6_KEYLEN;
+	key->id = frag_hdr->id;
+	key->key_len = IPV6_KEYLEN;
 
-	ip_ofs = FRAG_OFFSET(frag_hdr->frag_data) * 8;
+	*ofs = FRAG_OFFSET(frag_hdr->frag_data) * 8;
 
 	/*
 	 * as per RFC2460, payload length contains all extension headers as well.
 	 * since we don't support anything but frag headers, this is what we remove
 	 * from the payload len.
 	 */
-	ip_len = rte_be_to_cpu_16(ip_hdr->payload_len) - sizeof(*frag_hdr);
+	*len = rte_be_to_cpu_16(ip_hdr->payload_len) - sizeof(*frag_hdr);
+}
+
+struct rte_mbuf *
+rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint64_t tms,
+		struct ipv6_hdr *ip_hdr, struct ipv6_extension_fragment *frag_hdr)
+{
+	struct ip_frag_pkt *fp;
+	struct ip_frag_key key;
+	uint16_t ip_len, ip_ofs;
+
+	ipv6_frag_parse(ip_hdr, frag_hdr, &key, &ip_ofs, &ip_len);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 		"mbuf: %p, tms: %" PRIu64
@@ -185,9 +197,13 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	ip_frag_dr_reserve(tbl, dr);
+	ip_frag_tbl_lock(tbl);
+
 	/* try to find/add entry into the fragment's table. */
 	fp = ip_frag_find(tbl, dr, &key, tms);
 	if (fp == NULL) {
+		ip_frag_tbl_unlock(tbl);
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
 	}
@@ -204,7 +220,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	/* process the fragmented packet. */
 	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len,
-			MORE_FRAGS(frag_hdr->frag_data));
+			MORE_FRAGS(frag_hdr->frag_data), tbl->max_frags);
 	ip_frag_inuse(tbl, fp);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -217,5 +233,84 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		fp, IPv6_KEY_BYTES(fp->key.src_dst), fp->key.id, fp->start,
 		fp->total_size, fp->frag_size, fp->last_idx);
 
+	ip_frag_tbl_unlock(tbl);
+
 	return mb;
 }
+
+/*
+ * Process a burst of IPV6 packets.
+ * Keys of up to IP_FRAG_BURST_WINDOW fragments are hashed and their table
+ * buckets prefetched before any of them is looked up.
+ */
+uint16_t
+rte_ipv6_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint64_t tms)
+{
+	struct ip_frag_key key[IP_FRAG_BURST_WINDOW];
+	uint32_t sig1[IP_FRAG_BURST_WINDOW], sig2[IP_FRAG_BURST_WINDOW];
+	uint16_t ip_ofs[IP_FRAG_BURST_WINDOW], ip_len[IP_FRAG_BURST_WINDOW];
+	uint16_t more_frags[IP_FRAG_BURST_WINDOW];
+	uint8_t is_frag[IP_FRAG_BURST_WINDOW];
+	struct ipv6_extension_fragment *frag_hdr;
+	struct ip_frag_pkt *fp;
+	struct ipv6_hdr *ip_hdr;
+	struct rte_mbuf *mb;
+	uint32_t i, j, k, n;
+
+	n = 0;
+	ip_frag_tbl_lock(tbl);
+
+	for (i = 0; i < nb_pkts; i += k) {
+		k = RTE_MIN(nb_pkts - i, (uint32_t)IP_FRAG_BURST_WINDOW);
+
+		/* hash the keys and prefetch the buckets. */
+		for (j = 0; j != k; j++) {
+			mb = pkts[i + j];
+			ip_hdr = rte_pktmbuf_mtod_offset(mb, struct ipv6_hdr *,
+				mb->l2_len);
+
+			frag_hdr = rte_ipv6_frag_get_ipv6_fragment_header(ip_hdr);
+			is_frag[j] = (uint8_t)(frag_hdr != NULL);
+			if (is_frag[j] == 0)
+				continue;
+
+			ipv6_frag_parse(ip_hdr, frag_hdr, &key[j], &ip_ofs[j],
+				&ip_len[j]);
+			more_frags[j] = MORE_FRAGS(frag_hdr->frag_data);
+			ipv6_frag_hash(&key[j], &sig1[j], &sig2[j]);
+			ip_frag_tbl_prefetch(tbl, sig1[j], sig2[j]);
+		}
+
+		/* find/add the entries and process the fragments. */
+		for (j = 0; j != k; j++) {
+			mb = pkts[i + j];
+
+			if (is_frag[j] == 0) {
+				pkts[n++] = mb;
+				continue;
+			}
+
+			ip_frag_dr_reserve(tbl, dr);
+
+			fp = ip_frag_find_sig(tbl, dr, &key[j], sig1[j], sig2[j],
+				tms);
+			if (fp == NULL) {
+				IP_FRAG_MBUF2DR(dr, mb);
+				continue;
+			}
+
+			mb = ip_frag_process(fp, dr, mb, ip_ofs[j], ip_len[j],
+				more_frags[j], tbl->max_frags);
+			ip_frag_inuse(tbl, fp);
+
+			if (mb != NULL)
+				pkts[n++] = mb;
+		}
+	}
+
+	ip_frag_tbl_unlock(tbl);
+
+	return (uint16_t)n;
+}
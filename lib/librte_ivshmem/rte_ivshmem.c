@@ -550,6 +550,13 @@ add_mempool_to_metadata(const struct rte_mempool * mp,
 	struct rte_memzone * mz;
 	int ret;
 
+	/* only the ring of a ring backed mempool can be shared */
+	if (mp->flags & MEMPOOL_F_STACK) {
+		RTE_LOG(ERR, EAL, "Cannot share stack backed mempool %s!\n",
+				mp->name);
+		return -1;
+	}
+
 	mz = get_memzone_by_addr(mp);
 	ret = 0;
 
@@ -115,6 +115,9 @@ int rte_ivshmem_metadata_add_ring(const struct rte_ring * r,
 /**
  * Adds a mempool to a specific metadata file
  *
+ * Only ring backed mempools can be added: a mempool created with
+ * MEMPOOL_F_STACK is rejected.
+ *
  * @param mp
  *  Mempool to be added
  * @param md_name
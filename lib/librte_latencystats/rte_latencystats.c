@@ -0,0 +1,397 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+
+#include "rte_latencystats.h"
+
+#define LATENCY_STATS_MZ_NAME "rte_latencystats"
+
+/*
+ * The histogram has 8 bins per power of two: bin b < 8 holds a latency
+ * of b cycles, and a bigger latency goes in the bin made of its exponent
+ * and of the 3 bits following its most significant bit.
+ */
+#define HIST_SUB_BITS 3
+#define HIST_SUB_BINS (1 << HIST_SUB_BITS)
+#define HIST_NB_BINS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_BINS)
+
+/* weight of a new sample in the jitter, as in RFC 3550: 1/16 */
+#define JITTER_SHIFT 4
+
+/* statistics shared with secondary processes, in cycles */
+struct latency_stats {
+	rte_spinlock_t lock;
+	uint64_t tsc_hz;
+	uint64_t samples;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	uint64_t jitter;
+	uint64_t prev;
+	uint64_t hist[HIST_NB_BINS];
+};
+
+/* sampling state of a RX queue */
+struct rxq_sampler {
+	uint64_t next_tsc;
+} __rte_cache_aligned;
+
+/* a callback installed on a queue */
+struct queue_cb {
+	uint8_t port_id;
+	uint16_t queue_id;
+	int is_rx;
+	struct rte_eth_rxtx_callback *cb;
+};
+
+static struct latency_stats *stats;
+static struct rxq_sampler *samplers;
+static struct queue_cb *cbs;
+static unsigned nb_cbs;
+static uint64_t samp_intvl_cycles;
+static int started;
+
+static const char * const latency_stats_names[] = {
+	"samples",
+	"min_latency_ns",
+	"avg_latency_ns",
+	"max_latency_ns",
+	"jitter_ns",
+	"p50_latency_ns",
+	"p90_latency_ns",
+	"p99_latency_ns",
+	"p999_latency_ns",
+};
+#define NB_LATENCY_STATS RTE_DIM(latency_stats_names)
+
+static inline unsigned
+hist_bin(uint64_t cycles)
+{
+	unsigned e;
+
+	if (cycles < HIST_SUB_BINS)
+		return cycles;
+	e = 63 - __builtin_clzll(cycles);
+	return ((e - HIST_SUB_BITS + 1) << HIST_SUB_BITS) |
+		((cycles >> (e - HIST_SUB_BITS)) & (HIST_SUB_BINS - 1));
+}
+
+/* highest latency of a bin */
+static uint64_t
+hist_bin_max(unsigned bin)
+{
+	unsigned e, m;
+
+	if (bin < HIST_SUB_BINS)
+		return bin;
+	e = (bin >> HIST_SUB_BITS) + HIST_SUB_BITS - 1;
+	m = (bin & (HIST_SUB_BINS - 1)) | HIST_SUB_BINS;
+	/* wraps to UINT64_MAX for the last bin */
+	return (((uint64_t)m + 1) << (e - HIST_SUB_BITS)) - 1;
+}
+
+static void
+latency_update(uint64_t latency)
+{
+	uint64_t delta;
+
+	rte_spinlock_lock(&stats->lock);
+	if (stats->samples == 0 || latency < stats->min)
+		stats->min = latency;
+	if (latency > stats->max)
+		stats->max = latency;
+	if (stats->samples != 0) {
+		delta = latency > stats->prev ?
+			latency - stats->prev : stats->prev - latency;
+		stats->jitter = stats->jitter + (delta >> JITTER_SHIFT) -
+			(stats->jitter >> JITTER_SHIFT);
+	}
+	stats->prev = latency;
+	stats->sum += latency;
+	stats->samples++;
+	stats->hist[hist_bin(latency)]++;
+	rte_spinlock_unlock(&stats->lock);
+}
+
+static uint16_t
+latencystats_rx(uint8_t port_id __rte_unused, uint16_t queue_id __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *arg)
+{
+	struct rxq_sampler *sampler = arg;
+	uint64_t now;
+
+	if (nb_pkts == 0)
+		return 0;
+
+	now = rte_rdtsc();
+	if (now >= sampler->next_tsc) {
+		pkts[0]->timestamp = now;
+		pkts[0]->ol_flags |= PKT_RX_TIMESTAMP;
+		sampler->next_tsc = now + samp_intvl_cycles;
+	}
+	return nb_pkts;
+}
+
+static uint16_t
+latencystats_tx(uint8_t port_id __rte_unused, uint16_t queue_id __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		void *arg __rte_unused)
+{
+	uint64_t now = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(!(pkts[i]->ol_flags & PKT_RX_TIMESTAMP)))
+			continue;
+		if (now == 0)
+			now = rte_rdtsc();
+		latency_update(now - pkts[i]->timestamp);
+		pkts[i]->ol_flags &= ~PKT_RX_TIMESTAMP;
+	}
+	return nb_pkts;
+}
+
+/*
+ * The callbacks are freed right after their removal, which is only safe
+ * since no lcore runs the RX/TX functions anymore, as required by
+ * rte_latencystats_uninit(). rte_latencystats_init() also uses it on error,
+ * before any packet is received.
+ */
+static void
+remove_callbacks(void)
+{
+	unsigned i;
+
+	for (i = 0; i < nb_cbs; i++) {
+		if (cbs[i].is_rx)
+			rte_eth_remove_rx_callback(cbs[i].port_id,
+				cbs[i].queue_id, cbs[i].cb);
+		else
+			rte_eth_remove_tx_callback(cbs[i].port_id,
+				cbs[i].queue_id, cbs[i].cb);
+		rte_free(cbs[i].cb);
+	}
+	nb_cbs = 0;
+	rte_free(cbs);
+	rte_free(samplers);
+	cbs = NULL;
+	samplers = NULL;
+}
+
+static struct latency_stats *
+stats_lookup(void)
+{
+	const struct rte_memzone *mz;
+
+	if (stats == NULL) {
+		mz = rte_memzone_lookup(LATENCY_STATS_MZ_NAME);
+		if (mz != NULL)
+			stats = mz->addr;
+	}
+	return stats;
+}
+
+int
+rte_latencystats_init(uint64_t samp_intvl_ns)
+{
+	const struct rte_memzone *mz;
+	struct rte_eth_dev_data *data;
+	unsigned port, q, nb_rxq = 0, nb_q = 0;
+	struct rte_eth_rxtx_callback *cb;
+
+#ifndef RTE_ETHDEV_RXTX_CALLBACKS
+	return -ENOTSUP;
+#endif
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -E_RTE_SECONDARY;
+	if (started)
+		return -EALREADY;
+
+	if (stats_lookup() == NULL) {
+		mz = rte_memzone_reserve(LATENCY_STATS_MZ_NAME,
+			sizeof(*stats), SOCKET_ID_ANY, 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, LATENCY_STATS,
+				"Cannot reserve the latency statistics\n");
+			return -ENOMEM;
+		}
+		stats = mz->addr;
+	}
+	memset(stats, 0, sizeof(*stats));
+	rte_spinlock_init(&stats->lock);
+	stats->tsc_hz = rte_get_tsc_hz();
+	samp_intvl_cycles = samp_intvl_ns * stats->tsc_hz / 1000000000;
+
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		if (!rte_eth_dev_is_valid_port(port))
+			continue;
+		data = rte_eth_devices[port].data;
+		nb_rxq += data->nb_rx_queues;
+		nb_q += data->nb_rx_queues + data->nb_tx_queues;
+	}
+
+	samplers = rte_zmalloc("latencystats", sizeof(*samplers) * nb_rxq,
+		RTE_CACHE_LINE_SIZE);
+	cbs = rte_zmalloc("latencystats", sizeof(*cbs) * nb_q, 0);
+	if ((nb_rxq != 0 && samplers == NULL) || (nb_q != 0 && cbs == NULL))
+		goto fail;
+
+	nb_rxq = 0;
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		if (!rte_eth_dev_is_valid_port(port))
+			continue;
+		data = rte_eth_devices[port].data;
+		for (q = 0; q < data->nb_rx_queues; q++) {
+			cb = rte_eth_add_rx_callback(port, q, latencystats_rx,
+				&samplers[nb_rxq++]);
+			if (cb == NULL)
+				goto fail;
+			cbs[nb_cbs].port_id = port;
+			cbs[nb_cbs].queue_id = q;
+			cbs[nb_cbs].is_rx = 1;
+			cbs[nb_cbs++].cb = cb;
+		}
+		for (q = 0; q < data->nb_tx_queues; q++) {
+			cb = rte_eth_add_tx_callback(port, q, latencystats_tx,
+				NULL);
+			if (cb == NULL)
+				goto fail;
+			cbs[nb_cbs].port_id = port;
+			cbs[nb_cbs].queue_id = q;
+			cbs[nb_cbs].is_rx = 0;
+			cbs[nb_cbs++].cb = cb;
+		}
+	}
+
+	started = 1;
+	return 0;
+
+fail:
+	RTE_LOG(ERR, LATENCY_STATS, "Cannot install the latency callbacks\n");
+	remove_callbacks();
+	return -ENOMEM;
+}
+
+int
+rte_latencystats_uninit(void)
+{
+	if (!started)
+		return -ENODEV;
+
+	remove_callbacks();
+	started = 0;
+	return 0;
+}
+
+/* return the lowest latency greater than per_mille of the samples */
+static uint64_t
+percentile(const struct latency_stats *s, unsigned per_mille)
+{
+	uint64_t target, count = 0;
+	unsigned bin;
+
+	target = (s->samples * per_mille + 999) / 1000;
+	for (bin = 0; bin < HIST_NB_BINS; bin++) {
+		count += s->hist[bin];
+		if (count >= target && count != 0)
+			return RTE_MIN(hist_bin_max(bin), s->max);
+	}
+	return s->max;
+}
+
+int
+rte_latencystats_get(struct rte_eth_xstats *xstats, unsigned n)
+{
+	struct latency_stats s;
+	uint64_t values[NB_LATENCY_STATS];
+	unsigned i;
+
+	if (stats_lookup() == NULL)
+		return -ENODEV;
+	if (xstats == NULL || n < NB_LATENCY_STATS)
+		return NB_LATENCY_STATS;
+
+	rte_spinlock_lock(&stats->lock);
+	s = *stats;
+	rte_spinlock_unlock(&stats->lock);
+
+	values[0] = s.samples;
+	values[1] = s.min;
+	values[2] = s.samples != 0 ? s.sum / s.samples : 0;
+	values[3] = s.max;
+	values[4] = s.jitter;
+	values[5] = percentile(&s, 500);
+	values[6] = percentile(&s, 900);
+	values[7] = percentile(&s, 990);
+	values[8] = percentile(&s, 999);
+
+	for (i = 0; i < NB_LATENCY_STATS; i++) {
+		snprintf(xstats[i].name, sizeof(xstats[i].name), "%s",
+			latency_stats_names[i]);
+		/* convert the latencies to nanoseconds */
+		if (i == 0 || s.tsc_hz == 0)
+			xstats[i].value = values[i];
+		else
+			xstats[i].value = (double)values[i] * 1E9 / s.tsc_hz;
+	}
+	return NB_LATENCY_STATS;
+}
+
+void
+rte_latencystats_reset(void)
+{
+	if (stats_lookup() == NULL)
+		return;
+
+	rte_spinlock_lock(&stats->lock);
+	memset(&stats->samples, 0,
+		sizeof(*stats) - offsetof(struct latency_stats, samples));
+	rte_spinlock_unlock(&stats->lock);
+}
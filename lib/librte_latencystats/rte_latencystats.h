@@ -0,0 +1,131 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LATENCYSTATS_H_
+#define _RTE_LATENCYSTATS_H_
+
+/**
+ * @file
+ * RTE Latency Statistics
+ *
+ * The latency statistics library measures the time spent by packets in
+ * the application, from their reception to their transmission.
+ *
+ * An RX callback stamps a packet with the TSC (rte_mbuf timestamp field
+ * and PKT_RX_TIMESTAMP flag) at most once per sampling interval and per
+ * RX queue. A TX callback computes the latency of the stamped packets and
+ * updates the global minimum, average, maximum, jitter and a histogram
+ * from which percentiles are derived. The results are read as extended
+ * statistics with rte_latencystats_get().
+ *
+ * The callbacks require CONFIG_RTE_ETHDEV_RXTX_CALLBACKS. The statistics
+ * are kept in a memzone and can be read by a secondary process.
+ */
+
+#include <stdint.h>
+
+#include <rte_ethdev.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default sampling interval, in nanoseconds. */
+#define RTE_LATENCYSTATS_DEFAULT_SAMP_INTVL_NS 1000
+
+/**
+ * Start measuring the latency on all the RX and TX queues of all the
+ * configured ports.
+ *
+ * The ports must be configured, and must not be reconfigured before
+ * rte_latencystats_uninit() is called.
+ *
+ * @param samp_intvl_ns
+ *   Minimum time between two samples on a RX queue, in nanoseconds.
+ *   0 stamps one packet of every non-empty burst.
+ * @return
+ *   - 0: Success.
+ *   - -EALREADY: the measurement is already started.
+ *   - -E_RTE_SECONDARY: called from a secondary process.
+ *   - -ENOMEM: not enough memory.
+ *   - -ENOTSUP: the RX/TX callbacks are not enabled.
+ */
+int rte_latencystats_init(uint64_t samp_intvl_ns);
+
+/**
+ * Stop measuring the latency, removing the RX and TX callbacks.
+ *
+ * The callbacks and their state are freed, so no lcore may be calling
+ * rte_eth_rx_burst() or rte_eth_tx_burst() on any port when this function
+ * is called: the forwarding must be stopped on all the ports first.
+ *
+ * The statistics are kept until the next rte_latencystats_init() or
+ * rte_latencystats_reset().
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENODEV: the measurement is not started.
+ */
+int rte_latencystats_uninit(void);
+
+/**
+ * Retrieve the latency statistics as extended statistics: number of
+ * samples, minimum, average and maximum latency, jitter, and the 50th,
+ * 90th, 99th and 99.9th percentiles, in nanoseconds. The percentiles are
+ * given with a precision of 12.5%.
+ *
+ * @param xstats
+ *   A table of structure of type *rte_eth_xstats*, or NULL.
+ * @param n
+ *   The size of the table.
+ * @return
+ *   - positive value lower or equal to n: success. The return value
+ *     is the number of entries filled in the table.
+ *   - positive value higher than n: error, the given table is too small.
+ *     The return value corresponds to the size that should be given to
+ *     succeed. The entries in the table are not valid and shall not be
+ *     used by the caller.
+ *   - -ENODEV: no statistics are available.
+ */
+int rte_latencystats_get(struct rte_eth_xstats *xstats, unsigned n);
+
+/**
+ * Reset the latency statistics.
+ */
+void rte_latencystats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LATENCYSTATS_H_ */
@@ -108,6 +108,7 @@ extern "C" {
 #define PKT_RX_FDIR_ID       (1ULL << 13) /**< FD id reported if FDIR match. */
 #define PKT_RX_FDIR_FLX      (1ULL << 14) /**< Flexible bytes reported if FDIR match. */
 #define PKT_RX_QINQ_PKT      (1ULL << 15)  /**< RX packet with double VLAN stripped. */
+#define PKT_RX_TIMESTAMP     (1ULL << 16)  /**< RX packet with a valid timestamp field. */
 /* add new RX flags here */
 
 /* add new TX flags here */
@@ -867,6 +868,9 @@ struct rte_mbuf {
 
 	/** Timesync flags for use with IEEE1588. */
 	uint16_t timesync;
+
+	/** Software timestamp (TSC) taken on RX, valid if PKT_RX_TIMESTAMP. */
+	uint64_t timestamp;
 } __rte_cache_aligned;
 
 static inline uint16_t rte_pktmbuf_priv_size(struct rte_mempool *mp);
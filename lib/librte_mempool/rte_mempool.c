@@ -148,8 +148,19 @@ mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	if (obj_init)
 		obj_init(mp, obj_init_arg, obj, obj_idx);
 
-	/* enqueue in ring */
-	rte_ring_sp_enqueue(mp->ring, obj);
+	/* enqueue in the common pool */
+	__mempool_common_enqueue(mp, &obj, 1, 0);
+}
+
+/* Return the number of objects in the common pool (ring or stack) */
+static unsigned
+mempool_common_count(const struct rte_mempool *mp)
+{
+#ifdef RTE_LIBRTE_STACK
+	if (mp->flags & MEMPOOL_F_STACK)
+		return rte_stack_count(mp->stack);
+#endif
+	return rte_ring_count(mp->ring);
 }
 
 uint32_t
@@ -419,7 +430,8 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	struct rte_mempool_list *mempool_list;
 	struct rte_mempool *mp = NULL;
 	struct rte_tailq_entry *te;
-	struct rte_ring *r;
+	struct rte_ring *r = NULL;
+	struct rte_stack *s = NULL;
 	const struct rte_memzone *mz;
 	size_t mempool_size;
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
@@ -470,6 +482,16 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	if (flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		flags |= MEMPOOL_F_NO_SPREAD;
 
+	/* a lock-free stack is a stack */
+	if (flags & MEMPOOL_F_STACK_LF)
+		flags |= MEMPOOL_F_STACK;
+#ifndef RTE_LIBRTE_STACK
+	if (flags & MEMPOOL_F_STACK) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+#endif
+
 	/* ring flags */
 	if (flags & MEMPOOL_F_SP_PUT)
 		rg_flags |= RING_F_SP_ENQ;
@@ -489,9 +511,22 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	 * running as a secondary process etc., so no checks made
 	 * in this function for that condition */
 	snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT, name);
-	r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id, rg_flags);
-	if (r == NULL)
-		goto exit;
+#ifdef RTE_LIBRTE_STACK
+	if (flags & MEMPOOL_F_STACK) {
+		/* a stack keeps the most recently freed (cache-hot)
+		 * objects on top */
+		s = rte_stack_create(rg_name, n, socket_id,
+			(flags & MEMPOOL_F_STACK_LF) ? RTE_STACK_F_LF : 0);
+		if (s == NULL)
+			goto exit;
+	} else
+#endif
+	{
+		r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id,
+			rg_flags);
+		if (r == NULL)
+			goto exit;
+	}
 
 	/*
 	 * reserve a memory zone for this mempool: private data is
@@ -568,7 +603,10 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	memset(mp, 0, sizeof(*mp));
 	snprintf(mp->name, sizeof(mp->name), "%s", name);
 	mp->phys_addr = mz->phys_addr;
-	mp->ring = r;
+	if (s != NULL)
+		mp->stack = s;
+	else
+		mp->ring = r;
 	mp->size = n;
 	mp->flags = flags;
 	mp->elt_size = objsz.elt_size;
@@ -626,7 +664,7 @@ rte_mempool_count(const struct rte_mempool *mp)
 {
 	unsigned count;
 
-	count = rte_ring_count(mp->ring);
+	count = mempool_common_count(mp);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	{
@@ -782,7 +820,12 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "mempool <%s>@%p\n", mp->name, mp);
 	fprintf(f, "  flags=%x\n", mp->flags);
-	fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
+#ifdef RTE_LIBRTE_STACK
+	if (mp->flags & MEMPOOL_F_STACK)
+		fprintf(f, "  stack=<%s>@%p\n", mp->stack->name, mp->stack);
+	else
+#endif
+		fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
 	fprintf(f, "  phys_addr=0x%" PRIx64 "\n", mp->phys_addr);
 	fprintf(f, "  size=%"PRIu32"\n", mp->size);
 	fprintf(f, "  header_size=%"PRIu32"\n", mp->header_size);
@@ -805,7 +848,7 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 			mp->size);
 
 	cache_count = rte_mempool_dump_cache(f, mp);
-	common_count = rte_ring_count(mp->ring);
+	common_count = mempool_common_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
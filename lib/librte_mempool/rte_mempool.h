@@ -72,6 +72,9 @@
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
 #include <rte_ring.h>
+#ifdef RTE_LIBRTE_STACK
+#include <rte_stack.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -180,7 +183,10 @@ struct rte_mempool_objtlr {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	union {
+		struct rte_ring *ring;   /**< Ring to store objects. */
+		struct rte_stack *stack; /**< Stack, if MEMPOOL_F_STACK. */
+	};
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
 	uint32_t size;                   /**< Size of the mempool. */
@@ -223,6 +229,8 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_CACHE_ALIGN 0x0002 /**< Do not align objs on cache lines.*/
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
+#define MEMPOOL_F_STACK          0x0010 /**< Store objects in a stack. */
+#define MEMPOOL_F_STACK_LF       0x0020 /**< Use a lock-free stack. */
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -522,6 +530,12 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_STACK: If this flag is set, the objects of the common
+ *     pool are stored in a spinlock protected stack instead of a ring, so
+ *     that the most recently freed (cache-hot) objects are reused first.
+ *   - MEMPOOL_F_STACK_LF: Same as MEMPOOL_F_STACK, but the stack is
+ *     lock-free (only supported on x86_64). MEMPOOL_F_SP_PUT and
+ *     MEMPOOL_F_SC_GET have no effect on stack backed mempools.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -612,6 +626,12 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_STACK: If this flag is set, the objects of the common
+ *     pool are stored in a spinlock protected stack instead of a ring, so
+ *     that the most recently freed (cache-hot) objects are reused first.
+ *   - MEMPOOL_F_STACK_LF: Same as MEMPOOL_F_STACK, but the stack is
+ *     lock-free (only supported on x86_64). MEMPOOL_F_SP_PUT and
+ *     MEMPOOL_F_SC_GET have no effect on stack backed mempools.
  * @param vaddr
  *   Virtual address of the externally allocated memory buffer.
  *   Will be used to store mempool objects.
@@ -712,6 +732,12 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_STACK: If this flag is set, the objects of the common
+ *     pool are stored in a spinlock protected stack instead of a ring, so
+ *     that the most recently freed (cache-hot) objects are reused first.
+ *   - MEMPOOL_F_STACK_LF: Same as MEMPOOL_F_STACK, but the stack is
+ *     lock-free (only supported on x86_64). MEMPOOL_F_SP_PUT and
+ *     MEMPOOL_F_SC_GET have no effect on stack backed mempools.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -740,6 +766,49 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * @internal Put several objects in the common pool of the mempool, which
+ * is a ring, or a stack with MEMPOOL_F_STACK.
+ *
+ * @return
+ *   0 or -EDQUOT on success, -ENOBUFS if there is not enough room.
+ */
+static inline int __attribute__((always_inline))
+__mempool_common_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n, int is_mp)
+{
+#ifdef RTE_LIBRTE_STACK
+	if (mp->flags & MEMPOOL_F_STACK)
+		return rte_stack_push(mp->stack, obj_table, n) == n ?
+			0 : -ENOBUFS;
+#endif
+	if (is_mp)
+		return rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
+	else
+		return rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+}
+
+/**
+ * @internal Get several objects from the common pool of the mempool.
+ *
+ * @return
+ *   0 on success, -ENOENT if there are not enough objects.
+ */
+static inline int __attribute__((always_inline))
+__mempool_common_dequeue(struct rte_mempool *mp, void **obj_table,
+		unsigned n, int is_mc)
+{
+#ifdef RTE_LIBRTE_STACK
+	if (mp->flags & MEMPOOL_F_STACK)
+		return rte_stack_pop(mp->stack, obj_table, n) == n ?
+			0 : -ENOENT;
+#endif
+	if (is_mc)
+		return rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
+	else
+		return rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -795,8 +864,8 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 	cache->len += n;
 
 	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
+		__mempool_common_enqueue(mp, &cache->objs[cache_size],
+				cache->len - cache_size, 1);
 		cache->len = cache_size;
 	}
 
@@ -807,19 +876,10 @@ ring_enqueue:
 
 	/* push remaining objects in ring */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
+	if (__mempool_common_enqueue(mp, obj_table, n, is_mp) < 0)
+		rte_panic("cannot put objects in mempool\n");
 #else
-	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
-	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+	__mempool_common_enqueue(mp, obj_table, n, is_mp);
 #endif
 }
 
@@ -968,7 +1028,8 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 		uint32_t req = n + (cache_size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = __mempool_common_dequeue(mp, &cache->objs[cache->len],
+			req, 1);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
@@ -996,10 +1057,7 @@ ring_dequeue:
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* get remaining objects from ring */
-	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
-	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+	ret = __mempool_common_dequeue(mp, obj_table, n, is_mc);
 
 	if (ret < 0)
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
@@ -82,6 +82,7 @@
 
 #include <rte_byteorder.h>
 #include <rte_mbuf.h>
+#include <rte_tcp.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -405,6 +406,34 @@ rte_ipv6_udptcp_cksum(const struct ipv6_hdr *ipv6_hdr, const void *l4_hdr)
 	return cksum;
 }
 
+/**
+ * Seed the TCP checksum of a packet with its pseudo-header checksum.
+ *
+ * This is what a device completing the checksum, or segmenting the
+ * packet, expects to find in the TCP header. The IP version is taken
+ * from the PKT_TX_IPV4 flag of the mbuf, and the headers are located
+ * with its l2_len and l3_len.
+ *
+ * @param m
+ *   The packet mbuf, with contiguous IP and TCP headers.
+ * @param ol_flags
+ *   PKT_TX_TCP_SEG to leave the length out of the pseudo-header, as DPDK
+ *   TSO does, or 0 to include it.
+ */
+static inline void
+rte_tcp_phdr_cksum_set(struct rte_mbuf *m, uint64_t ol_flags)
+{
+	struct tcp_hdr *tcp_hdr = rte_pktmbuf_mtod_offset(m, struct tcp_hdr *,
+		m->l2_len + m->l3_len);
+
+	if (m->ol_flags & PKT_TX_IPV4)
+		tcp_hdr->cksum = rte_ipv4_phdr_cksum(rte_pktmbuf_mtod_offset(m,
+			struct ipv4_hdr *, m->l2_len), ol_flags);
+	else
+		tcp_hdr->cksum = rte_ipv6_phdr_cksum(rte_pktmbuf_mtod_offset(m,
+			struct ipv6_hdr *, m->l2_len), ol_flags);
+}
+
 #ifdef __cplusplus
 }
 #endif
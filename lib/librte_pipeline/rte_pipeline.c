@@ -59,6 +59,26 @@
 #define RTE_PIPELINE_STATS_ADD_M(counter, mask)
 #endif
 
+#ifdef RTE_PIPELINE_PROFILE
+#define RTE_PIPELINE_PROFILE_TSC(tsc) \
+	({ (tsc) = rte_rdtsc(); })
+
+#define RTE_PIPELINE_PROFILE_ADD(n_calls, n_cycles, tsc) \
+	({ (n_calls)++; (n_cycles) += rte_rdtsc() - (tsc); })
+
+#define RTE_PIPELINE_PROFILE_ADD_M(counter, mask) \
+	({ (counter) += __builtin_popcountll(mask); })
+
+#define RTE_PIPELINE_PROFILE_BURST(hist, n_pkts) \
+	({ (hist)[((n_pkts) == 0) ? 0 : \
+		(64 - __builtin_clzll((uint64_t) (n_pkts)))]++; })
+#else
+#define RTE_PIPELINE_PROFILE_TSC(tsc)
+#define RTE_PIPELINE_PROFILE_ADD(n_calls, n_cycles, tsc)
+#define RTE_PIPELINE_PROFILE_ADD_M(counter, mask)
+#define RTE_PIPELINE_PROFILE_BURST(hist, n_pkts)
+#endif
+
 struct rte_port_in {
 	/* Input parameters */
 	struct rte_port_in_ops ops;
@@ -76,6 +96,10 @@ struct rte_port_in {
 	struct rte_port_in *next;
 
 	uint64_t n_pkts_dropped_by_ah;
+
+#ifdef RTE_PIPELINE_PROFILE
+	struct rte_pipeline_port_in_profile profile;
+#endif
 };
 
 struct rte_port_out {
@@ -89,6 +113,10 @@ struct rte_port_out {
 	void *h_port;
 
 	uint64_t n_pkts_dropped_by_ah;
+
+#ifdef RTE_PIPELINE_PROFILE
+	struct rte_pipeline_port_out_profile profile;
+#endif
 };
 
 struct rte_table {
@@ -111,6 +139,10 @@ struct rte_table {
 	uint64_t n_pkts_dropped_by_lkp_miss_ah;
 	uint64_t n_pkts_dropped_lkp_hit;
 	uint64_t n_pkts_dropped_lkp_miss;
+
+#ifdef RTE_PIPELINE_PROFILE
+	struct rte_pipeline_table_profile profile;
+#endif
 };
 
 #define RTE_PIPELINE_MAX_NAME_SZ                           124
@@ -587,6 +619,172 @@ rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 	return (table->ops.f_delete)(table->h_table, key, key_found, entry);
 }
 
+int
+rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+		uint32_t table_id,
+		void **keys,
+		struct rte_pipeline_table_entry **entries,
+		uint32_t n_keys,
+		int *key_found,
+		struct rte_pipeline_table_entry **entries_ptr)
+{
+	struct rte_table *table;
+	uint32_t table_next_id, table_next_id_valid, i;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (keys == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: keys parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (entries == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: entries parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if ((key_found == NULL) || (entries_ptr == NULL)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: key_found or entries_ptr parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if ((table->ops.f_add_bulk == NULL) && (table->ops.f_add == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: f_add function pointer NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	table_next_id = table->table_next_id;
+	table_next_id_valid = table->table_next_id_valid;
+	for (i = 0; i < n_keys; i++) {
+		struct rte_pipeline_table_entry *entry = entries[i];
+
+		if ((keys[i] == NULL) || (entry == NULL)) {
+			RTE_LOG(ERR, PIPELINE,
+				"%s: key or entry %u is NULL\n", __func__, i);
+			return -EINVAL;
+		}
+
+		if (entry->action != RTE_PIPELINE_ACTION_TABLE)
+			continue;
+
+		if (table_next_id_valid &&
+			(entry->table_id != table_next_id)) {
+			RTE_LOG(ERR, PIPELINE,
+				"%s: Tree-like topologies not allowed\n",
+				__func__);
+			return -EINVAL;
+		}
+
+		table_next_id = entry->table_id;
+		table_next_id_valid = 1;
+	}
+
+	/* Add entries */
+	table->table_next_id = table_next_id;
+	table->table_next_id_valid = table_next_id_valid;
+
+	if (table->ops.f_add_bulk != NULL)
+		return (table->ops.f_add_bulk)(table->h_table, keys,
+			(void **) entries, n_keys, key_found,
+			(void **) entries_ptr);
+
+	for (i = 0; i < n_keys; i++) {
+		int status = (table->ops.f_add)(table->h_table, keys[i],
+			(void *) entries[i], &key_found[i],
+			(void **) &entries_ptr[i]);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
+int
+rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
+		uint32_t table_id,
+		void **keys,
+		uint32_t n_keys,
+		int *key_found,
+		struct rte_pipeline_table_entry **entries)
+{
+	struct rte_table *table;
+	uint32_t i;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (keys == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: keys parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (key_found == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if ((table->ops.f_delete_bulk == NULL) &&
+		(table->ops.f_delete == NULL)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: f_delete function pointer NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if (keys[i] == NULL) {
+			RTE_LOG(ERR, PIPELINE, "%s: key %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	if (table->ops.f_delete_bulk != NULL)
+		return (table->ops.f_delete_bulk)(table->h_table, keys, n_keys,
+			key_found, (void **) entries);
+
+	for (i = 0; i < n_keys; i++) {
+		int status = (table->ops.f_delete)(table->h_table, keys[i],
+			&key_found[i], (entries != NULL) ? entries[i] : NULL);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
 /*
  * Port
  *
@@ -1050,8 +1248,12 @@ rte_pipeline_action_handler_port_bulk(struct rte_pipeline *p,
 	/* Output port user actions */
 	if (port_out->f_action_bulk != NULL) {
 		uint64_t mask = pkts_mask;
+		__rte_unused uint64_t tsc;
 
+		RTE_PIPELINE_PROFILE_TSC(tsc);
 		port_out->f_action_bulk(p->pkts, &pkts_mask, port_out->arg_ah);
+		RTE_PIPELINE_PROFILE_ADD(port_out->profile.n_calls_ah,
+			port_out->profile.n_cycles_ah, tsc);
 		p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= pkts_mask ^  mask;
 		RTE_PIPELINE_STATS_ADD_M(port_out->n_pkts_dropped_by_ah,
 				pkts_mask ^  mask);
@@ -1080,9 +1282,13 @@ rte_pipeline_action_handler_port(struct rte_pipeline *p, uint64_t pkts_mask)
 				port_out->ops.f_tx(port_out->h_port, pkt);
 			else {
 				uint64_t pkt_mask = 1LLU;
+				__rte_unused uint64_t tsc;
 
+				RTE_PIPELINE_PROFILE_TSC(tsc);
 				port_out->f_action(pkt, &pkt_mask,
 					port_out->arg_ah);
+				RTE_PIPELINE_PROFILE_ADD(port_out->profile.n_calls_ah,
+					port_out->profile.n_cycles_ah, tsc);
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
 					(pkt_mask ^ 1LLU) << i;
 
@@ -1115,10 +1321,15 @@ rte_pipeline_action_handler_port(struct rte_pipeline *p, uint64_t pkts_mask)
 			if (port_out->f_action == NULL) /* Output port TX */
 				port_out->ops.f_tx(port_out->h_port, pkt);
 			else {
+				__rte_unused uint64_t tsc;
+
 				pkt_mask = 1LLU;
 
+				RTE_PIPELINE_PROFILE_TSC(tsc);
 				port_out->f_action(pkt, &pkt_mask,
 					port_out->arg_ah);
+				RTE_PIPELINE_PROFILE_ADD(port_out->profile.n_calls_ah,
+					port_out->profile.n_cycles_ah, tsc);
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
 					(pkt_mask ^ 1LLU) << i;
 
@@ -1155,9 +1366,13 @@ rte_pipeline_action_handler_port_meta(struct rte_pipeline *p,
 				port_out->ops.f_tx(port_out->h_port, pkt);
 			else {
 				uint64_t pkt_mask = 1LLU;
+				__rte_unused uint64_t tsc;
 
+				RTE_PIPELINE_PROFILE_TSC(tsc);
 				port_out->f_action(pkt, &pkt_mask,
 					port_out->arg_ah);
+				RTE_PIPELINE_PROFILE_ADD(port_out->profile.n_calls_ah,
+					port_out->profile.n_cycles_ah, tsc);
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
 					(pkt_mask ^ 1LLU) << i;
 
@@ -1191,10 +1406,15 @@ rte_pipeline_action_handler_port_meta(struct rte_pipeline *p,
 			if (port_out->f_action == NULL) /* Output port TX */
 				port_out->ops.f_tx(port_out->h_port, pkt);
 			else {
+				__rte_unused uint64_t tsc;
+
 				pkt_mask = 1LLU;
 
+				RTE_PIPELINE_PROFILE_TSC(tsc);
 				port_out->f_action(pkt, &pkt_mask,
 					port_out->arg_ah);
+				RTE_PIPELINE_PROFILE_ADD(port_out->profile.n_calls_ah,
+					port_out->profile.n_cycles_ah, tsc);
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
 					(pkt_mask ^ 1LLU) << i;
 
@@ -1242,10 +1462,12 @@ rte_pipeline_run(struct rte_pipeline *p)
 		port_in = port_in->next) {
 		uint64_t pkts_mask;
 		uint32_t n_pkts, table_id;
+		__rte_unused uint64_t tsc;
 
 		/* Input port RX */
 		n_pkts = port_in->ops.f_rx(port_in->h_port, p->pkts,
 			port_in->burst_size);
+		RTE_PIPELINE_PROFILE_BURST(port_in->profile.n_bursts, n_pkts);
 		if (n_pkts == 0)
 			continue;
 
@@ -1259,7 +1481,10 @@ rte_pipeline_run(struct rte_pipeline *p)
 		if (port_in->f_action != NULL) {
 			uint64_t mask = pkts_mask;
 
+			RTE_PIPELINE_PROFILE_TSC(tsc);
 			port_in->f_action(p->pkts, n_pkts, &pkts_mask, port_in->arg_ah);
+			RTE_PIPELINE_PROFILE_ADD(port_in->profile.n_calls_ah,
+				port_in->profile.n_cycles_ah, tsc);
 			mask ^= pkts_mask;
 			p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= mask;
 			RTE_PIPELINE_STATS_ADD_M(port_in->n_pkts_dropped_by_ah, mask);
@@ -1272,9 +1497,16 @@ rte_pipeline_run(struct rte_pipeline *p)
 
 			/* Lookup */
 			table = &p->tables[table_id];
+			RTE_PIPELINE_PROFILE_TSC(tsc);
 			table->ops.f_lookup(table->h_table, p->pkts, pkts_mask,
 					&lookup_hit_mask, (void **) p->entries);
+			RTE_PIPELINE_PROFILE_ADD(table->profile.n_lookups,
+				table->profile.n_cycles_lookup, tsc);
 			lookup_miss_mask = pkts_mask & (~lookup_hit_mask);
+			RTE_PIPELINE_PROFILE_ADD_M(
+				table->profile.n_pkts_lookup_hit, lookup_hit_mask);
+			RTE_PIPELINE_PROFILE_ADD_M(
+				table->profile.n_pkts_lookup_miss, lookup_miss_mask);
 
 			/* Lookup miss */
 			if (lookup_miss_mask != 0) {
@@ -1285,9 +1517,13 @@ rte_pipeline_run(struct rte_pipeline *p)
 				if (table->f_action_miss != NULL) {
 					uint64_t mask = lookup_miss_mask;
 
+					RTE_PIPELINE_PROFILE_TSC(tsc);
 					table->f_action_miss(p->pkts,
 						&lookup_miss_mask,
 						default_entry, table->arg_ah);
+					RTE_PIPELINE_PROFILE_ADD(
+						table->profile.n_calls_ah_miss,
+						table->profile.n_cycles_ah_miss, tsc);
 					mask ^= lookup_miss_mask;
 					p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= mask;
 					RTE_PIPELINE_STATS_ADD_M(
@@ -1318,9 +1554,13 @@ rte_pipeline_run(struct rte_pipeline *p)
 				if (table->f_action_hit != NULL) {
 					uint64_t mask = lookup_hit_mask;
 
+					RTE_PIPELINE_PROFILE_TSC(tsc);
 					table->f_action_hit(p->pkts,
 						&lookup_hit_mask,
 						p->entries, table->arg_ah);
+					RTE_PIPELINE_PROFILE_ADD(
+						table->profile.n_calls_ah_hit,
+						table->profile.n_cycles_ah_hit, tsc);
 					mask ^= lookup_hit_mask;
 					p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= mask;
 					RTE_PIPELINE_STATS_ADD_M(
@@ -1531,3 +1771,114 @@ int rte_pipeline_table_stats_read(struct rte_pipeline *p, uint32_t table_id,
 	return 0;
 }
 
+int rte_pipeline_port_in_profile_read(struct rte_pipeline *p, uint32_t port_id,
+	struct rte_pipeline_port_in_profile *profile, int clear)
+{
+	struct rte_port_in *port;
+
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (port_id >= p->num_ports_in) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: port IN ID %u is out of range\n",
+			__func__, port_id);
+		return -EINVAL;
+	}
+
+	port = &p->ports_in[port_id];
+
+#ifdef RTE_PIPELINE_PROFILE
+	if (profile != NULL)
+		memcpy(profile, &port->profile, sizeof(port->profile));
+
+	if (clear != 0)
+		memset(&port->profile, 0, sizeof(port->profile));
+
+	return 0;
+#else
+	RTE_SET_USED(port);
+	RTE_SET_USED(profile);
+	RTE_SET_USED(clear);
+
+	return -ENOTSUP;
+#endif
+}
+
+int rte_pipeline_port_out_profile_read(struct rte_pipeline *p,
+	uint32_t port_id, struct rte_pipeline_port_out_profile *profile,
+	int clear)
+{
+	struct rte_port_out *port;
+
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (port_id >= p->num_ports_out) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: port OUT ID %u is out of range\n",
+			__func__, port_id);
+		return -EINVAL;
+	}
+
+	port = &p->ports_out[port_id];
+
+#ifdef RTE_PIPELINE_PROFILE
+	if (profile != NULL)
+		memcpy(profile, &port->profile, sizeof(port->profile));
+
+	if (clear != 0)
+		memset(&port->profile, 0, sizeof(port->profile));
+
+	return 0;
+#else
+	RTE_SET_USED(port);
+	RTE_SET_USED(profile);
+	RTE_SET_USED(clear);
+
+	return -ENOTSUP;
+#endif
+}
+
+int rte_pipeline_table_profile_read(struct rte_pipeline *p, uint32_t table_id,
+	struct rte_pipeline_table_profile *profile, int clear)
+{
+	struct rte_table *table;
+
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+				"%s: table %u is out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+#ifdef RTE_PIPELINE_PROFILE
+	if (profile != NULL)
+		memcpy(profile, &table->profile, sizeof(table->profile));
+
+	if (clear != 0)
+		memset(&table->profile, 0, sizeof(table->profile));
+
+	return 0;
+#else
+	RTE_SET_USED(table);
+	RTE_SET_USED(profile);
+	RTE_SET_USED(clear);
+
+	return -ENOTSUP;
+#endif
+}
+
@@ -151,6 +151,67 @@ struct rte_pipeline_table_stats {
 	uint64_t n_pkts_dropped_lkp_miss;
 };
 
+/** Number of bins of the input port burst size histogram */
+#define RTE_PIPELINE_PORT_IN_BURST_HIST_SIZE                        8
+
+/**
+ * Pipeline port in profile. Only collected when the pipeline library is built
+ * with RTE_PIPELINE_PROFILE, cycles are measured with the TSC.
+ */
+struct rte_pipeline_port_in_profile {
+	/** Number of RX bursts per burst size: bin 0 counts the empty polls,
+	bin n (n > 0) counts the bursts of 2^(n-1) to 2^n - 1 packets. */
+	uint64_t n_bursts[RTE_PIPELINE_PORT_IN_BURST_HIST_SIZE];
+
+	/** Number of action handler invocations. */
+	uint64_t n_calls_ah;
+
+	/** Number of cycles spent in the action handler. */
+	uint64_t n_cycles_ah;
+};
+
+/**
+ * Pipeline port out profile. Only collected when the pipeline library is
+ * built with RTE_PIPELINE_PROFILE, cycles are measured with the TSC.
+ */
+struct rte_pipeline_port_out_profile {
+	/** Number of action handler invocations (single packet or bulk). */
+	uint64_t n_calls_ah;
+
+	/** Number of cycles spent in the action handler. */
+	uint64_t n_cycles_ah;
+};
+
+/**
+ * Pipeline table profile. Only collected when the pipeline library is built
+ * with RTE_PIPELINE_PROFILE, cycles are measured with the TSC.
+ */
+struct rte_pipeline_table_profile {
+	/** Number of lookup operations (one per burst of packets). */
+	uint64_t n_lookups;
+
+	/** Number of cycles spent in the lookup operation. */
+	uint64_t n_cycles_lookup;
+
+	/** Number of packets with lookup hit. */
+	uint64_t n_pkts_lookup_hit;
+
+	/** Number of packets with lookup miss. */
+	uint64_t n_pkts_lookup_miss;
+
+	/** Number of lookup hit action handler invocations. */
+	uint64_t n_calls_ah_hit;
+
+	/** Number of cycles spent in the lookup hit action handler. */
+	uint64_t n_cycles_ah_hit;
+
+	/** Number of lookup miss action handler invocations. */
+	uint64_t n_calls_ah_miss;
+
+	/** Number of cycles spent in the lookup miss action handler. */
+	uint64_t n_cycles_ah_miss;
+};
+
 /**
  * Pipeline create
  *
@@ -465,6 +526,72 @@ int rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 	int *key_found,
 	struct rte_pipeline_table_entry *entry);
 
+/**
+ * Pipeline table entry add bulk
+ *
+ * Equivalent to invoking the pipeline table entry add operation for each of
+ * the n_keys keys, but uses the bulk add operation of the table when provided,
+ * which lets the table amortize its update cost (e.g. a single ACL rebuild for
+ * the whole set of rules).
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array of n_keys table entry keys
+ * @param entries
+ *   Array of n_keys new contents, entries[i] is associated with keys[i]
+ * @param n_keys
+ *   Number of keys to add
+ * @param key_found
+ *   Array of n_keys elements. On successful invocation, key_found[i] is set to
+ *   TRUE (value different than 0) if keys[i] was already present in the table
+ *   before the add operation and to FALSE (value 0) if not
+ * @param entries_ptr
+ *   Array of n_keys elements. On successful invocation, entries_ptr[i] points
+ *   to the table entry associated with keys[i]
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr);
+
+/**
+ * Pipeline table entry delete bulk
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array of n_keys table entry keys
+ * @param n_keys
+ *   Number of keys to delete
+ * @param key_found
+ *   Array of n_keys elements. On successful invocation, key_found[i] is set to
+ *   TRUE (value different than 0) if keys[i] was found in the table before the
+ *   delete operation and to FALSE (value 0) if not
+ * @param entries
+ *   When not NULL, array of n_keys buffers. On successful invocation, when
+ *   keys[i] is found in the table and entries[i] points to a valid buffer, the
+ *   table entry contents (as it was before the delete was performed) is copied
+ *   to this buffer
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries);
+
 /**
  * Read pipeline table stats.
  *
@@ -485,6 +612,24 @@ int rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 int rte_pipeline_table_stats_read(struct rte_pipeline *p, uint32_t table_id,
 	struct rte_pipeline_table_stats *stats, int clear);
 
+/**
+ * Read pipeline table profile.
+ *
+ * @param p
+ *   Handle to pipeline instance.
+ * @param table_id
+ *   Table ID what profile will be returned.
+ * @param profile
+ *   Profile buffer, can be NULL to only clear the profile.
+ * @param clear
+ *   If not 0 clear profile after reading.
+ * @return
+ *   0 on success, -ENOTSUP when the library is built without
+ *   RTE_PIPELINE_PROFILE, error code otherwise
+ */
+int rte_pipeline_table_profile_read(struct rte_pipeline *p, uint32_t table_id,
+	struct rte_pipeline_table_profile *profile, int clear);
+
 /*
  * Port IN
  *
@@ -619,6 +764,24 @@ int rte_pipeline_port_in_disable(struct rte_pipeline *p,
 int rte_pipeline_port_in_stats_read(struct rte_pipeline *p, uint32_t port_id,
 	struct rte_pipeline_port_in_stats *stats, int clear);
 
+/**
+ * Read pipeline port in profile.
+ *
+ * @param p
+ *   Handle to pipeline instance.
+ * @param port_id
+ *   Port ID what profile will be returned.
+ * @param profile
+ *   Profile buffer, can be NULL to only clear the profile.
+ * @param clear
+ *   If not 0 clear profile after reading.
+ * @return
+ *   0 on success, -ENOTSUP when the library is built without
+ *   RTE_PIPELINE_PROFILE, error code otherwise
+ */
+int rte_pipeline_port_in_profile_read(struct rte_pipeline *p, uint32_t port_id,
+	struct rte_pipeline_port_in_profile *profile, int clear);
+
 /*
  * Port OUT
  *
@@ -756,6 +919,24 @@ int rte_pipeline_port_out_packet_insert(struct rte_pipeline *p,
  */
 int rte_pipeline_port_out_stats_read(struct rte_pipeline *p, uint32_t port_id,
 	struct rte_pipeline_port_out_stats *stats, int clear);
+
+/**
+ * Read pipeline port out profile.
+ *
+ * @param p
+ *   Handle to pipeline instance.
+ * @param port_id
+ *   Port ID what profile will be returned.
+ * @param profile
+ *   Profile buffer, can be NULL to only clear the profile.
+ * @param clear
+ *   If not 0 clear profile after reading.
+ * @return
+ *   0 on success, -ENOTSUP when the library is built without
+ *   RTE_PIPELINE_PROFILE, error code otherwise
+ */
+int rte_pipeline_port_out_profile_read(struct rte_pipeline *p, uint32_t port_id,
+	struct rte_pipeline_port_out_profile *profile, int clear);
 #ifdef __cplusplus
 }
 #endif
@@ -63,7 +63,8 @@ struct rte_port_ring_reader {
 };
 
 static void *
-rte_port_ring_reader_create(void *params, int socket_id)
+rte_port_ring_reader_create_internal(void *params, int socket_id,
+	uint32_t is_multi)
 {
 	struct rte_port_ring_reader_params *conf =
 			(struct rte_port_ring_reader_params *) params;
@@ -75,6 +76,13 @@ rte_port_ring_reader_create(void *params, int socket_id)
 		return NULL;
 	}
 
+	/* A ring shared by several readers must be multi-consumer */
+	if (is_multi && (conf->ring != NULL) && conf->ring->cons.sc_dequeue) {
+		RTE_LOG(ERR, PORT, "%s: Ring %s is not multi-consumer\n",
+			__func__, conf->ring->name);
+		return NULL;
+	}
+
 	/* Memory allocation */
 	port = rte_zmalloc_socket("PORT", sizeof(*port),
 			RTE_CACHE_LINE_SIZE, socket_id);
@@ -89,6 +97,18 @@ rte_port_ring_reader_create(void *params, int socket_id)
 	return port;
 }
 
+static void *
+rte_port_ring_reader_create(void *params, int socket_id)
+{
+	return rte_port_ring_reader_create_internal(params, socket_id, 0);
+}
+
+static void *
+rte_port_ring_multi_reader_create(void *params, int socket_id)
+{
+	return rte_port_ring_reader_create_internal(params, socket_id, 1);
+}
+
 static int
 rte_port_ring_reader_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 {
@@ -101,6 +121,19 @@ rte_port_ring_reader_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 	return nb_rx;
 }
 
+static int
+rte_port_ring_multi_reader_rx(void *port, struct rte_mbuf **pkts,
+	uint32_t n_pkts)
+{
+	struct rte_port_ring_reader *p = (struct rte_port_ring_reader *) port;
+	uint32_t nb_rx;
+
+	nb_rx = rte_ring_mc_dequeue_burst(p->ring, (void **) pkts, n_pkts);
+	RTE_PORT_RING_READER_STATS_PKTS_IN_ADD(p, nb_rx);
+
+	return nb_rx;
+}
+
 static int
 rte_port_ring_reader_free(void *port)
 {
@@ -155,10 +188,12 @@ struct rte_port_ring_writer {
 	uint32_t tx_burst_sz;
 	uint32_t tx_buf_count;
 	uint64_t bsz_mask;
+	uint32_t is_multi;
 };
 
 static void *
-rte_port_ring_writer_create(void *params, int socket_id)
+rte_port_ring_writer_create_internal(void *params, int socket_id,
+	uint32_t is_multi)
 {
 	struct rte_port_ring_writer_params *conf =
 			(struct rte_port_ring_writer_params *) params;
@@ -167,6 +202,7 @@ rte_port_ring_writer_create(void *params, int socket_id)
 	/* Check input parameters */
 	if ((conf == NULL) ||
 	    (conf->ring == NULL) ||
+		(is_multi && conf->ring->prod.sp_enqueue) ||
 		(conf->tx_burst_sz > RTE_PORT_IN_BURST_SIZE_MAX)) {
 		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
 		return NULL;
@@ -185,17 +221,40 @@ rte_port_ring_writer_create(void *params, int socket_id)
 	port->tx_burst_sz = conf->tx_burst_sz;
 	port->tx_buf_count = 0;
 	port->bsz_mask = 1LLU << (conf->tx_burst_sz - 1);
+	port->is_multi = is_multi;
 
 	return port;
 }
 
+static void *
+rte_port_ring_writer_create(void *params, int socket_id)
+{
+	return rte_port_ring_writer_create_internal(params, socket_id, 0);
+}
+
+static void *
+rte_port_ring_multi_writer_create(void *params, int socket_id)
+{
+	return rte_port_ring_writer_create_internal(params, socket_id, 1);
+}
+
+static inline uint32_t
+ring_enqueue_burst(struct rte_ring *r, void **objs, uint32_t n,
+	uint32_t is_multi)
+{
+	if (is_multi)
+		return rte_ring_mp_enqueue_burst(r, objs, n);
+
+	return rte_ring_sp_enqueue_burst(r, objs, n);
+}
+
 static inline void
-send_burst(struct rte_port_ring_writer *p)
+send_burst_internal(struct rte_port_ring_writer *p, uint32_t is_multi)
 {
 	uint32_t nb_tx;
 
-	nb_tx = rte_ring_sp_enqueue_burst(p->ring, (void **)p->tx_buf,
-			p->tx_buf_count);
+	nb_tx = ring_enqueue_burst(p->ring, (void **)p->tx_buf,
+			p->tx_buf_count, is_multi);
 
 	RTE_PORT_RING_WRITER_STATS_PKTS_DROP_ADD(p, p->tx_buf_count - nb_tx);
 	for ( ; nb_tx < p->tx_buf_count; nb_tx++)
@@ -204,23 +263,37 @@ send_burst(struct rte_port_ring_writer *p)
 	p->tx_buf_count = 0;
 }
 
-static int
-rte_port_ring_writer_tx(void *port, struct rte_mbuf *pkt)
+static inline int
+rte_port_ring_writer_tx_internal(void *port, struct rte_mbuf *pkt,
+	uint32_t is_multi)
 {
 	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
 
 	p->tx_buf[p->tx_buf_count++] = pkt;
 	RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(p, 1);
 	if (p->tx_buf_count >= p->tx_burst_sz)
-		send_burst(p);
+		send_burst_internal(p, is_multi);
 
 	return 0;
 }
 
 static int
-rte_port_ring_writer_tx_bulk(void *port,
+rte_port_ring_writer_tx(void *port, struct rte_mbuf *pkt)
+{
+	return rte_port_ring_writer_tx_internal(port, pkt, 0);
+}
+
+static int
+rte_port_ring_multi_writer_tx(void *port, struct rte_mbuf *pkt)
+{
+	return rte_port_ring_writer_tx_internal(port, pkt, 1);
+}
+
+static inline int
+rte_port_ring_writer_tx_bulk_internal(void *port,
 		struct rte_mbuf **pkts,
-		uint64_t pkts_mask)
+		uint64_t pkts_mask,
+		uint32_t is_multi)
 {
 	struct rte_port_ring_writer *p =
 		(struct rte_port_ring_writer *) port;
@@ -235,10 +308,11 @@ rte_port_ring_writer_tx_bulk(void *port,
 		uint32_t n_pkts_ok;
 
 		if (tx_buf_count)
-			send_burst(p);
+			send_burst_internal(p, is_multi);
 
 		RTE_PORT_RING_WRITER_STATS_PKTS_IN_ADD(p, n_pkts);
-		n_pkts_ok = rte_ring_sp_enqueue_burst(p->ring, (void **)pkts, n_pkts);
+		n_pkts_ok = ring_enqueue_burst(p->ring, (void **)pkts, n_pkts,
+			is_multi);
 
 		RTE_PORT_RING_WRITER_STATS_PKTS_DROP_ADD(p, n_pkts - n_pkts_ok);
 		for ( ; n_pkts_ok < n_pkts; n_pkts_ok++) {
@@ -259,19 +333,35 @@ rte_port_ring_writer_tx_bulk(void *port,
 
 		p->tx_buf_count = tx_buf_count;
 		if (tx_buf_count >= p->tx_burst_sz)
-			send_burst(p);
+			send_burst_internal(p, is_multi);
 	}
 
 	return 0;
 }
 
+static int
+rte_port_ring_writer_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	return rte_port_ring_writer_tx_bulk_internal(port, pkts, pkts_mask, 0);
+}
+
+static int
+rte_port_ring_multi_writer_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	return rte_port_ring_writer_tx_bulk_internal(port, pkts, pkts_mask, 1);
+}
+
 static int
 rte_port_ring_writer_flush(void *port)
 {
 	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
 
 	if (p->tx_buf_count > 0)
-		send_burst(p);
+		send_burst_internal(p, p->is_multi);
 
 	return 0;
 }
@@ -332,10 +422,12 @@ struct rte_port_ring_writer_nodrop {
 	uint32_t tx_buf_count;
 	uint64_t bsz_mask;
 	uint64_t n_retries;
+	uint32_t is_multi;
 };
 
 static void *
-rte_port_ring_writer_nodrop_create(void *params, int socket_id)
+rte_port_ring_writer_nodrop_create_internal(void *params, int socket_id,
+	uint32_t is_multi)
 {
 	struct rte_port_ring_writer_nodrop_params *conf =
 			(struct rte_port_ring_writer_nodrop_params *) params;
@@ -344,6 +436,7 @@ rte_port_ring_writer_nodrop_create(void *params, int socket_id)
 	/* Check input parameters */
 	if ((conf == NULL) ||
 	    (conf->ring == NULL) ||
+		(is_multi && conf->ring->prod.sp_enqueue) ||
 		(conf->tx_burst_sz > RTE_PORT_IN_BURST_SIZE_MAX)) {
 		RTE_LOG(ERR, PORT, "%s: Invalid Parameters\n", __func__);
 		return NULL;
@@ -369,29 +462,51 @@ rte_port_ring_writer_nodrop_create(void *params, int socket_id)
 	 * branches in fast path, we use UINT64_MAX instead of branching.
 	 */
 	port->n_retries = (conf->n_retries == 0) ? UINT64_MAX : conf->n_retries;
+	port->is_multi = is_multi;
 
 	return port;
 }
 
+static void *
+rte_port_ring_writer_nodrop_create(void *params, int socket_id)
+{
+	return rte_port_ring_writer_nodrop_create_internal(params, socket_id,
+		0);
+}
+
+static void *
+rte_port_ring_multi_writer_nodrop_create(void *params, int socket_id)
+{
+	return rte_port_ring_writer_nodrop_create_internal(params, socket_id,
+		1);
+}
+
 static inline void
-send_burst_nodrop(struct rte_port_ring_writer_nodrop *p)
+send_burst_nodrop_internal(struct rte_port_ring_writer_nodrop *p,
+	uint32_t is_multi)
 {
-	uint32_t nb_tx = 0, i;
+	uint64_t i;
+	uint32_t nb_tx;
 
-	nb_tx = rte_ring_sp_enqueue_burst(p->ring, (void **)p->tx_buf,
-				p->tx_buf_count);
+	nb_tx = ring_enqueue_burst(p->ring, (void **)p->tx_buf,
+				p->tx_buf_count, is_multi);
 
 	/* We sent all the packets in a first try */
-	if (nb_tx >= p->tx_buf_count)
+	if (nb_tx >= p->tx_buf_count) {
+		p->tx_buf_count = 0;
 		return;
+	}
 
 	for (i = 0; i < p->n_retries; i++) {
-		nb_tx += rte_ring_sp_enqueue_burst(p->ring,
-				(void **) (p->tx_buf + nb_tx), p->tx_buf_count - nb_tx);
+		nb_tx += ring_enqueue_burst(p->ring,
+				(void **) (p->tx_buf + nb_tx),
+				p->tx_buf_count - nb_tx, is_multi);
 
 		/* We sent all the packets in more than one try */
-		if (nb_tx >= p->tx_buf_count)
+		if (nb_tx >= p->tx_buf_count) {
+			p->tx_buf_count = 0;
 			return;
+		}
 	}
 
 	/* We didn't send the packets in maximum allowed attempts */
@@ -402,8 +517,9 @@ send_burst_nodrop(struct rte_port_ring_writer_nodrop *p)
 	p->tx_buf_count = 0;
 }
 
-static int
-rte_port_ring_writer_nodrop_tx(void *port, struct rte_mbuf *pkt)
+static inline int
+rte_port_ring_writer_nodrop_tx_internal(void *port, struct rte_mbuf *pkt,
+	uint32_t is_multi)
 {
 	struct rte_port_ring_writer_nodrop *p =
 			(struct rte_port_ring_writer_nodrop *) port;
@@ -411,15 +527,28 @@ rte_port_ring_writer_nodrop_tx(void *port, struct rte_mbuf *pkt)
 	p->tx_buf[p->tx_buf_count++] = pkt;
 	RTE_PORT_RING_WRITER_NODROP_STATS_PKTS_IN_ADD(p, 1);
 	if (p->tx_buf_count >= p->tx_burst_sz)
-		send_burst_nodrop(p);
+		send_burst_nodrop_internal(p, is_multi);
 
 	return 0;
 }
 
 static int
-rte_port_ring_writer_nodrop_tx_bulk(void *port,
+rte_port_ring_writer_nodrop_tx(void *port, struct rte_mbuf *pkt)
+{
+	return rte_port_ring_writer_nodrop_tx_internal(port, pkt, 0);
+}
+
+static int
+rte_port_ring_multi_writer_nodrop_tx(void *port, struct rte_mbuf *pkt)
+{
+	return rte_port_ring_writer_nodrop_tx_internal(port, pkt, 1);
+}
+
+static inline int
+rte_port_ring_writer_nodrop_tx_bulk_internal(void *port,
 		struct rte_mbuf **pkts,
-		uint64_t pkts_mask)
+		uint64_t pkts_mask,
+		uint32_t is_multi)
 {
 	struct rte_port_ring_writer_nodrop *p =
 		(struct rte_port_ring_writer_nodrop *) port;
@@ -434,10 +563,11 @@ rte_port_ring_writer_nodrop_tx_bulk(void *port,
 		uint32_t n_pkts_ok;
 
 		if (tx_buf_count)
-			send_burst_nodrop(p);
+			send_burst_nodrop_internal(p, is_multi);
 
 		RTE_PORT_RING_WRITER_NODROP_STATS_PKTS_IN_ADD(p, n_pkts);
-		n_pkts_ok = rte_ring_sp_enqueue_burst(p->ring, (void **)pkts, n_pkts);
+		n_pkts_ok = ring_enqueue_burst(p->ring, (void **)pkts, n_pkts,
+			is_multi);
 
 		if (n_pkts_ok >= n_pkts)
 			return 0;
@@ -450,7 +580,7 @@ rte_port_ring_writer_nodrop_tx_bulk(void *port,
 			struct rte_mbuf *pkt = pkts[n_pkts_ok];
 			p->tx_buf[p->tx_buf_count++] = pkt;
 		}
-		send_burst_nodrop(p);
+		send_burst_nodrop_internal(p, is_multi);
 	} else {
 		for ( ; pkts_mask; ) {
 			uint32_t pkt_index = __builtin_ctzll(pkts_mask);
@@ -464,12 +594,30 @@ rte_port_ring_writer_nodrop_tx_bulk(void *port,
 
 		p->tx_buf_count = tx_buf_count;
 		if (tx_buf_count >= p->tx_burst_sz)
-			send_burst_nodrop(p);
+			send_burst_nodrop_internal(p, is_multi);
 	}
 
 	return 0;
 }
 
+static int
+rte_port_ring_writer_nodrop_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	return rte_port_ring_writer_nodrop_tx_bulk_internal(port, pkts,
+		pkts_mask, 0);
+}
+
+static int
+rte_port_ring_multi_writer_nodrop_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	return rte_port_ring_writer_nodrop_tx_bulk_internal(port, pkts,
+		pkts_mask, 1);
+}
+
 static int
 rte_port_ring_writer_nodrop_flush(void *port)
 {
@@ -477,7 +625,7 @@ rte_port_ring_writer_nodrop_flush(void *port)
 			(struct rte_port_ring_writer_nodrop *) port;
 
 	if (p->tx_buf_count > 0)
-		send_burst_nodrop(p);
+		send_burst_nodrop_internal(p, p->is_multi);
 
 	return 0;
 }
@@ -539,3 +687,28 @@ struct rte_port_out_ops rte_port_ring_writer_nodrop_ops = {
 	.f_flush = rte_port_ring_writer_nodrop_flush,
 	.f_stats = rte_port_ring_writer_nodrop_stats_read,
 };
+
+struct rte_port_in_ops rte_port_ring_multi_reader_ops = {
+	.f_create = rte_port_ring_multi_reader_create,
+	.f_free = rte_port_ring_reader_free,
+	.f_rx = rte_port_ring_multi_reader_rx,
+	.f_stats = rte_port_ring_reader_stats_read,
+};
+
+struct rte_port_out_ops rte_port_ring_multi_writer_ops = {
+	.f_create = rte_port_ring_multi_writer_create,
+	.f_free = rte_port_ring_writer_free,
+	.f_tx = rte_port_ring_multi_writer_tx,
+	.f_tx_bulk = rte_port_ring_multi_writer_tx_bulk,
+	.f_flush = rte_port_ring_writer_flush,
+	.f_stats = rte_port_ring_writer_stats_read,
+};
+
+struct rte_port_out_ops rte_port_ring_multi_writer_nodrop_ops = {
+	.f_create = rte_port_ring_multi_writer_nodrop_create,
+	.f_free = rte_port_ring_writer_nodrop_free,
+	.f_tx = rte_port_ring_multi_writer_nodrop_tx,
+	.f_tx_bulk = rte_port_ring_multi_writer_nodrop_tx_bulk,
+	.f_flush = rte_port_ring_writer_nodrop_flush,
+	.f_stats = rte_port_ring_writer_nodrop_stats_read,
+};
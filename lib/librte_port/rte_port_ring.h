@@ -44,6 +44,10 @@ extern "C" {
  *
  * ring_reader: input port built on top of pre-initialized single consumer ring
  * ring_writer: output port built on top of pre-initialized single producer ring
+ * ring_multi_reader: input port built on top of pre-initialized multi consumers
+ * ring
+ * ring_multi_writer: output port built on top of pre-initialized multi
+ * producers ring
  *
  ***/
 
@@ -91,6 +95,27 @@ struct rte_port_ring_writer_nodrop_params {
 /** ring_writer_nodrop port operations */
 extern struct rte_port_out_ops rte_port_ring_writer_nodrop_ops;
 
+/** ring_multi_reader port parameters */
+#define rte_port_ring_multi_reader_params rte_port_ring_reader_params
+
+/** ring_multi_reader port operations: several instances (e.g. one per
+ * pipeline) can safely read from the same multi-consumer ring */
+extern struct rte_port_in_ops rte_port_ring_multi_reader_ops;
+
+/** ring_multi_writer port parameters */
+#define rte_port_ring_multi_writer_params rte_port_ring_writer_params
+
+/** ring_multi_writer port operations: several instances (e.g. one per
+ * pipeline) can safely write to the same multi-producer ring */
+extern struct rte_port_out_ops rte_port_ring_multi_writer_ops;
+
+/** ring_multi_writer_nodrop port parameters */
+#define rte_port_ring_multi_writer_nodrop_params \
+	rte_port_ring_writer_nodrop_params
+
+/** ring_multi_writer_nodrop port operations */
+extern struct rte_port_out_ops rte_port_ring_multi_writer_nodrop_ops;
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,13 @@
 #include <rte_mbuf.h>
 #include <rte_mempool.h>
 #include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_ether.h>
+
+#ifdef RTE_PORT_PCAP
+#include <pcap.h>
+#include <sys/time.h>
+#endif
 
 #include "rte_port_source_sink.h"
 
@@ -60,8 +67,158 @@ struct rte_port_source {
 	struct rte_port_in_stats stats;
 
 	struct rte_mempool *mempool;
+
+	/* PCAP buffers and indexes */
+	uint8_t **pkts;
+	uint8_t *pkt_buff;
+	uint32_t *pkt_len;
+	uint32_t n_pkts;
+	uint32_t pkt_index;
 };
 
+#ifdef RTE_PORT_PCAP
+
+static int
+pcap_source_load(struct rte_port_source *port,
+		const char *file_name,
+		uint32_t n_bytes_per_pkt,
+		int socket_id)
+{
+	uint32_t n_pkts = 0;
+	uint32_t i;
+	uint32_t max_len;
+	uint64_t total_buff_len = 0;
+	uint8_t *buff;
+	pcap_t *pcap_handle;
+	char pcap_errbuf[PCAP_ERRBUF_SIZE];
+	struct pcap_pkthdr pcap_hdr;
+	const uint8_t *pkt;
+	int status;
+
+	max_len = rte_pktmbuf_data_room_size(port->mempool) -
+		RTE_PKTMBUF_HEADROOM;
+	if ((n_bytes_per_pkt != 0) && (n_bytes_per_pkt < max_len))
+		max_len = n_bytes_per_pkt;
+
+	/* First pass: count the packets and the buffer size */
+	pcap_handle = pcap_open_offline(file_name, pcap_errbuf);
+	if (pcap_handle == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to open pcap file "
+			"'%s' for reading (%s)\n",
+			__func__, file_name, pcap_errbuf);
+		return -EIO;
+	}
+
+	while ((pkt = pcap_next(pcap_handle, &pcap_hdr)) != NULL) {
+		uint32_t len = RTE_MIN(pcap_hdr.caplen, max_len);
+
+		total_buff_len += RTE_CACHE_LINE_ROUNDUP(len);
+		n_pkts++;
+	}
+
+	pcap_close(pcap_handle);
+
+	if (n_pkts == 0) {
+		RTE_LOG(ERR, PORT, "%s: No packets in pcap file '%s'\n",
+			__func__, file_name);
+		return -EINVAL;
+	}
+
+	/* Memory allocation */
+	port->pkt_len = rte_zmalloc_socket("PCAP",
+		sizeof(*port->pkt_len) * n_pkts, 0, socket_id);
+	port->pkts = rte_zmalloc_socket("PCAP",
+		sizeof(*port->pkts) * n_pkts, 0, socket_id);
+	port->pkt_buff = rte_zmalloc_socket("PCAP",
+		total_buff_len, RTE_CACHE_LINE_SIZE, socket_id);
+	if ((port->pkt_len == NULL) ||
+		(port->pkts == NULL) ||
+		(port->pkt_buff == NULL)) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate %" PRIu64
+			" bytes for pcap file '%s'\n",
+			__func__, total_buff_len, file_name);
+		status = -ENOMEM;
+		goto error_exit;
+	}
+
+	/* Second pass: copy the packets */
+	pcap_handle = pcap_open_offline(file_name, pcap_errbuf);
+	if (pcap_handle == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to open pcap file "
+			"'%s' for reading (%s)\n",
+			__func__, file_name, pcap_errbuf);
+		status = -EIO;
+		goto error_exit;
+	}
+
+	buff = port->pkt_buff;
+	for (i = 0; i < n_pkts; i++) {
+		uint32_t len;
+
+		pkt = pcap_next(pcap_handle, &pcap_hdr);
+		if (pkt == NULL)
+			break;
+
+		len = RTE_MIN(pcap_hdr.caplen, max_len);
+		rte_memcpy(buff, pkt, len);
+		port->pkts[i] = buff;
+		port->pkt_len[i] = len;
+		buff += RTE_CACHE_LINE_ROUNDUP(len);
+	}
+
+	pcap_close(pcap_handle);
+
+	/* The file may have shrunk between the two passes */
+	port->n_pkts = i;
+	port->pkt_index = 0;
+
+	if (port->n_pkts == 0) {
+		RTE_LOG(ERR, PORT, "%s: No packets in pcap file '%s'\n",
+			__func__, file_name);
+		status = -EINVAL;
+		goto error_exit;
+	}
+
+	RTE_LOG(INFO, PORT, "Successfully load pcap file "
+		"'%s' with %" PRIu32 " pkts\n",
+		file_name, port->n_pkts);
+
+	return 0;
+
+error_exit:
+	rte_free(port->pkt_buff);
+	rte_free(port->pkts);
+	rte_free(port->pkt_len);
+	port->pkt_buff = NULL;
+	port->pkts = NULL;
+	port->pkt_len = NULL;
+	port->n_pkts = 0;
+
+	return status;
+}
+
+#define PCAP_SOURCE_LOAD(port, file_name, n_bytes, socket_id)	\
+	pcap_source_load(port, file_name, n_bytes, socket_id)
+
+#else /* RTE_PORT_PCAP */
+
+#define PCAP_SOURCE_LOAD(port, file_name, n_bytes, socket_id)	\
+({								\
+	int _ret = 0;						\
+								\
+	if (file_name) {					\
+		RTE_LOG(ERR, PORT, "Source port field "		\
+			"\"file_name\" is not NULL, but pcap "	\
+			"support is not compiled in "		\
+			"(CONFIG_RTE_PORT_PCAP)\n");		\
+		_ret = -ENOTSUP;				\
+	}							\
+								\
+	_ret;							\
+})
+
+#endif /* RTE_PORT_PCAP */
+
 static void *
 rte_port_source_create(void *params, int socket_id)
 {
@@ -86,17 +243,34 @@ rte_port_source_create(void *params, int socket_id)
 	/* Initialization */
 	port->mempool = (struct rte_mempool *) p->mempool;
 
+	if (p->file_name) {
+		int status = PCAP_SOURCE_LOAD(port, p->file_name,
+			p->n_bytes_per_pkt, socket_id);
+
+		if (status < 0) {
+			rte_free(port);
+			return NULL;
+		}
+	}
+
 	return port;
 }
 
 static int
 rte_port_source_free(void *port)
 {
+	struct rte_port_source *p =
+			(struct rte_port_source *)port;
+
 	/* Check input parameters */
-	if (port == NULL)
+	if (p == NULL)
 		return 0;
 
-	rte_free(port);
+	rte_free(p->pkt_len);
+	rte_free(p->pkts);
+	rte_free(p->pkt_buff);
+
+	rte_free(p);
 
 	return 0;
 }
@@ -105,10 +279,36 @@ static int
 rte_port_source_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
 {
 	struct rte_port_source *p = (struct rte_port_source *) port;
+	uint32_t i;
 
 	if (rte_mempool_get_bulk(p->mempool, (void **) pkts, n_pkts) != 0)
 		return 0;
 
+	for (i = 0; i < n_pkts; i++) {
+		rte_mbuf_refcnt_set(pkts[i], 1);
+		rte_pktmbuf_reset(pkts[i]);
+	}
+
+	if (p->pkt_buff != NULL) {
+		uint32_t pkt_index = p->pkt_index;
+
+		for (i = 0; i < n_pkts; i++) {
+			struct rte_mbuf *pkt = pkts[i];
+			uint32_t len = p->pkt_len[pkt_index];
+
+			rte_memcpy(rte_pktmbuf_mtod(pkt, void *),
+				p->pkts[pkt_index], len);
+			pkt->data_len = len;
+			pkt->pkt_len = len;
+
+			pkt_index++;
+			if (pkt_index == p->n_pkts)
+				pkt_index = 0;
+		}
+
+		p->pkt_index = pkt_index;
+	}
+
 	RTE_PORT_SOURCE_STATS_PKTS_IN_ADD(p, n_pkts);
 
 	return n_pkts;
@@ -133,40 +333,266 @@ rte_port_source_stats_read(void *port,
 /*
  * Port SINK
  */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_SINK_STATS_PKTS_IN_ADD(port, val) \
+	(port->stats.n_pkts_in += val)
+#define RTE_PORT_SINK_STATS_PKTS_DROP_ADD(port, val) \
+	(port->stats.n_pkts_drop += val)
+
+#else
+
+#define RTE_PORT_SINK_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_SINK_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_sink {
+	struct rte_port_out_stats stats;
+
+	/* PCAP dumper handle and pkts number */
+	void *dumper;
+	uint32_t max_pkts;
+	uint32_t pkt_index;
+	uint32_t dump_finish;
+
+	/* Packets waiting to be written to the pcap file */
+	struct rte_mbuf *dump_buf[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t dump_buf_count;
+};
+
+#ifdef RTE_PORT_PCAP
+
+static int
+pcap_sink_open(struct rte_port_sink *port,
+	const char *file_name,
+	uint32_t max_n_pkts)
+{
+	pcap_t *tx_pcap;
+	pcap_dumper_t *pcap_dumper;
+
+	/** Open a dead pcap handler for opening dumper file */
+	tx_pcap = pcap_open_dead(DLT_EN10MB, 65535);
+	if (tx_pcap == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to open pcap handle\n",
+			__func__);
+		return -ENOMEM;
+	}
+
+	/* The dumper is created using the previous pcap_t reference, which
+	 * is not needed any more once the file header is written */
+	pcap_dumper = pcap_dump_open(tx_pcap, file_name);
+	if (pcap_dumper == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to open pcap file "
+			"'%s' for writing (%s)\n", __func__, file_name,
+			pcap_geterr(tx_pcap));
+		pcap_close(tx_pcap);
+		return -EIO;
+	}
+
+	pcap_close(tx_pcap);
+
+	port->dumper = pcap_dumper;
+	port->max_pkts = max_n_pkts;
+	port->pkt_index = 0;
+	port->dump_finish = 0;
+
+	RTE_LOG(INFO, PORT, "Ready to dump packets to file '%s'\n",
+		file_name);
+
+	return 0;
+}
+
+static void
+pcap_sink_close(struct rte_port_sink *port)
+{
+	pcap_dump_close(port->dumper);
+	port->dumper = NULL;
+	port->dump_finish = 1;
+}
+
+static void
+pcap_sink_write_pkt(struct rte_port_sink *port, struct rte_mbuf *mbuf)
+{
+	uint8_t jumbo_pkt_buf[ETHER_MAX_JUMBO_FRAME_LEN];
+	uint8_t *pcap_dumper = (uint8_t *) port->dumper;
+	struct pcap_pkthdr pcap_hdr;
+	uint8_t *pkt;
+
+	/* Maximum num packets already reached */
+	if (port->dump_finish)
+		return;
+
+	pkt = rte_pktmbuf_mtod(mbuf, uint8_t *);
+
+	pcap_hdr.len = mbuf->pkt_len;
+	pcap_hdr.caplen = pcap_hdr.len;
+	gettimeofday(&(pcap_hdr.ts), NULL);
+
+	if (mbuf->nb_segs > 1) {
+		struct rte_mbuf *jumbo_mbuf;
+		uint32_t pkt_index = 0;
+
+		/* if packet size longer than ETHER_MAX_JUMBO_FRAME_LEN,
+		 * ignore it.
+		 */
+		if (mbuf->pkt_len > ETHER_MAX_JUMBO_FRAME_LEN)
+			return;
+
+		for (jumbo_mbuf = mbuf; jumbo_mbuf != NULL;
+				jumbo_mbuf = jumbo_mbuf->next) {
+			rte_memcpy(&jumbo_pkt_buf[pkt_index],
+				rte_pktmbuf_mtod(jumbo_mbuf, uint8_t *),
+				jumbo_mbuf->data_len);
+			pkt_index += jumbo_mbuf->data_len;
+		}
+
+		pkt = jumbo_pkt_buf;
+	}
+
+	pcap_dump(pcap_dumper, &pcap_hdr, pkt);
+
+	port->pkt_index++;
+
+	if ((port->max_pkts != 0) && (port->pkt_index >= port->max_pkts)) {
+		pcap_dump_flush((pcap_dumper_t *)port->dumper);
+		pcap_sink_close(port);
+		RTE_LOG(INFO, PORT, "Dumped %u packets to file\n",
+			port->pkt_index);
+	}
+}
+
+static void
+pcap_sink_dump_buf(struct rte_port_sink *port)
+{
+	uint32_t i;
+
+	for (i = 0; i < port->dump_buf_count; i++)
+		pcap_sink_write_pkt(port, port->dump_buf[i]);
+
+	if (port->dumper != NULL)
+		pcap_dump_flush((pcap_dumper_t *)port->dumper);
+
+	for (i = 0; i < port->dump_buf_count; i++)
+		rte_pktmbuf_free(port->dump_buf[i]);
+
+	port->dump_buf_count = 0;
+}
+
+#define PCAP_SINK_OPEN(port, file_name, max_n_pkts)		\
+	pcap_sink_open(port, file_name, max_n_pkts)
+
+#define PCAP_SINK_CLOSE(port)					\
+	pcap_sink_close(port)
+
+#define PCAP_SINK_DUMP_BUF(port)				\
+	pcap_sink_dump_buf(port)
+
+#else /* RTE_PORT_PCAP */
+
+#define PCAP_SINK_OPEN(port, file_name, max_n_pkts)		\
+({								\
+	int _ret = 0;						\
+								\
+	if (file_name) {					\
+		RTE_LOG(ERR, PORT, "Sink port field "		\
+			"\"file_name\" is not NULL, but pcap "	\
+			"support is not compiled in "		\
+			"(CONFIG_RTE_PORT_PCAP)\n");		\
+		_ret = -ENOTSUP;				\
+	}							\
+								\
+	_ret;							\
+})
+
+#define PCAP_SINK_CLOSE(port)					\
+	do {} while (0)
+
+#define PCAP_SINK_DUMP_BUF(port)				\
+	do {} while (0)
+
+#endif /* RTE_PORT_PCAP */
+
 static void *
-rte_port_sink_create(__rte_unused void *params, __rte_unused int socket_id)
+rte_port_sink_create(void *params, int socket_id)
 {
-	return (void *) 1;
+	struct rte_port_sink *port;
+	struct rte_port_sink_params *p = params;
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* No parameters: drop all packets */
+	if ((p == NULL) || (p->file_name == NULL))
+		return port;
+
+	if (PCAP_SINK_OPEN(port, p->file_name, p->max_n_pkts) != 0) {
+		rte_free(port);
+		return NULL;
+	}
+
+	return port;
+}
+
+static inline void
+rte_port_sink_drop(struct rte_port_sink *p, struct rte_mbuf *pkt)
+{
+	if (p->dumper != NULL) {
+		p->dump_buf[p->dump_buf_count++] = pkt;
+		if (p->dump_buf_count == RTE_DIM(p->dump_buf))
+			PCAP_SINK_DUMP_BUF(p);
+	} else
+		rte_pktmbuf_free(pkt);
 }
 
 static int
-rte_port_sink_tx(__rte_unused void *port, struct rte_mbuf *pkt)
+rte_port_sink_tx(void *port, struct rte_mbuf *pkt)
 {
-	rte_pktmbuf_free(pkt);
+	struct rte_port_sink *p = (struct rte_port_sink *) port;
+
+	RTE_PORT_SINK_STATS_PKTS_IN_ADD(p, 1);
+	rte_port_sink_drop(p, pkt);
+	RTE_PORT_SINK_STATS_PKTS_DROP_ADD(p, 1);
 
 	return 0;
 }
 
 static int
-rte_port_sink_tx_bulk(__rte_unused void *port, struct rte_mbuf **pkts,
+rte_port_sink_tx_bulk(void *port, struct rte_mbuf **pkts,
 	uint64_t pkts_mask)
 {
+	struct rte_port_sink *p = (struct rte_port_sink *) port;
+
 	if ((pkts_mask & (pkts_mask + 1)) == 0) {
 		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
 		uint32_t i;
 
-		for (i = 0; i < n_pkts; i++) {
-			struct rte_mbuf *pkt = pkts[i];
+		RTE_PORT_SINK_STATS_PKTS_IN_ADD(p, n_pkts);
+		RTE_PORT_SINK_STATS_PKTS_DROP_ADD(p, n_pkts);
 
-			rte_pktmbuf_free(pkt);
-		}
+		if (p->dumper == NULL) {
+			for (i = 0; i < n_pkts; i++) {
+				struct rte_mbuf *pkt = pkts[i];
+
+				rte_pktmbuf_free(pkt);
+			}
+		} else
+			for (i = 0; i < n_pkts; i++)
+				rte_port_sink_drop(p, pkts[i]);
 	} else {
 		for ( ; pkts_mask; ) {
 			uint32_t pkt_index = __builtin_ctzll(pkts_mask);
 			uint64_t pkt_mask = 1LLU << pkt_index;
 			struct rte_mbuf *pkt = pkts[pkt_index];
 
-			rte_pktmbuf_free(pkt);
+			RTE_PORT_SINK_STATS_PKTS_IN_ADD(p, 1);
+			RTE_PORT_SINK_STATS_PKTS_DROP_ADD(p, 1);
+			rte_port_sink_drop(p, pkt);
 			pkts_mask &= ~pkt_mask;
 		}
 	}
@@ -174,6 +600,54 @@ rte_port_sink_tx_bulk(__rte_unused void *port, struct rte_mbuf **pkts,
 	return 0;
 }
 
+static int
+rte_port_sink_flush(void *port)
+{
+	struct rte_port_sink *p = (struct rte_port_sink *) port;
+
+	if (p == NULL)
+		return 0;
+
+	if (p->dump_buf_count)
+		PCAP_SINK_DUMP_BUF(p);
+
+	return 0;
+}
+
+static int
+rte_port_sink_free(void *port)
+{
+	struct rte_port_sink *p = (struct rte_port_sink *) port;
+
+	/* Check input parameters */
+	if (p == NULL)
+		return 0;
+
+	rte_port_sink_flush(p);
+	if (p->dumper != NULL)
+		PCAP_SINK_CLOSE(p);
+
+	rte_free(p);
+
+	return 0;
+}
+
+static int
+rte_port_sink_stats_read(void *port, struct rte_port_out_stats *stats,
+		int clear)
+{
+	struct rte_port_sink *p =
+		(struct rte_port_sink *) port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
 /*
  * Summary of port operations
  */
@@ -186,8 +660,9 @@ struct rte_port_in_ops rte_port_source_ops = {
 
 struct rte_port_out_ops rte_port_sink_ops = {
 	.f_create = rte_port_sink_create,
-	.f_free = NULL,
+	.f_free = rte_port_sink_free,
 	.f_tx = rte_port_sink_tx,
 	.f_tx_bulk = rte_port_sink_tx_bulk,
-	.f_flush = NULL,
+	.f_flush = rte_port_sink_flush,
+	.f_stats = rte_port_sink_stats_read,
 };
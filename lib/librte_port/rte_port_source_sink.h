@@ -42,8 +42,10 @@ extern "C" {
  * @file
  * RTE Port Source/Sink
  *
- * source: input port that can be used to generate packets
- * sink: output port that drops all packets written to it
+ * source: input port that can be used to generate packets, optionally
+ * replayed from a pcap file
+ * sink: output port that drops all packets written to it, optionally
+ * recording them to a pcap file
  *
  ***/
 
@@ -53,12 +55,34 @@ extern "C" {
 struct rte_port_source_params {
 	/** Pre-initialized buffer pool */
 	struct rte_mempool *mempool;
+
+	/** The full path of the pcap file to read packets from. When NULL,
+	 * the port generates empty packets. Only supported when built with
+	 * CONFIG_RTE_PORT_PCAP. The whole file is loaded into memory at port
+	 * creation and replayed in a loop, so no file I/O takes place on the
+	 * RX path. */
+	const char *file_name;
+
+	/** The number of bytes to be read from each packet in the pcap file.
+	 * When 0, the whole packet is read (up to the mbuf data room size). */
+	uint32_t n_bytes_per_pkt;
 };
 
 /** source port operations */
 extern struct rte_port_in_ops rte_port_source_ops;
 
-/** sink port parameters: NONE */
+/** sink port parameters */
+struct rte_port_sink_params {
+	/** The full path of the pcap file to write the packets to. When NULL,
+	 * the packets are dropped without being recorded. Only supported when
+	 * built with CONFIG_RTE_PORT_PCAP. */
+	const char *file_name;
+
+	/** The maximum number of packets to write to the pcap file. When 0,
+	 * all packets are written. Once the limit is reached, the file is
+	 * closed and the remaining packets are dropped. */
+	uint32_t max_n_pkts;
+};
 
 /** sink port operations */
 extern struct rte_port_out_ops rte_port_sink_ops;
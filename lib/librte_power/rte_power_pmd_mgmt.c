@@ -0,0 +1,429 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_interrupts.h>
+#include <rte_ethdev.h>
+
+#include "rte_power.h"
+#include "rte_power_pmd_mgmt.h"
+
+/* shortest PAUSE backoff, doubled at each sleep up to max_sleep_us */
+#define PAUSE_BACKOFF_MIN_US 1
+
+struct pmd_lcore_cfg;
+
+/* a managed RX queue */
+struct pmd_queue_cfg {
+	struct pmd_lcore_cfg *lcore;
+	void *cb;                 /* RX callback handle, NULL if unused */
+	uint32_t empty_polls;     /* consecutive, saturated at the threshold */
+	int epfd;                 /* epoll instance the interrupt is in, or -1 */
+	unsigned lcore_id;        /* lcore polling the queue */
+	uint8_t port_id;
+	uint16_t queue_id;
+};
+
+/* power management state of an lcore; only its own thread updates it
+ * while it polls */
+struct pmd_lcore_cfg {
+	struct pmd_queue_cfg queues[RTE_POWER_PMD_MGMT_MAX_QUEUES];
+	struct pmd_queue_cfg *sleep_queue; /* queue whose callback sleeps */
+	enum rte_power_pmd_mgmt_type type;
+	uint32_t threshold;
+	uint32_t max_sleep_us;
+	unsigned nb_queues;
+	unsigned nb_idle;
+	uint64_t backoff;          /* current PAUSE backoff in TSC cycles */
+	uint64_t backoff_max;
+	uint64_t backoff_min;
+	int scaled_down;
+	struct rte_power_pmd_mgmt_stats stats;
+} __rte_cache_aligned;
+
+static struct pmd_lcore_cfg lcore_cfgs[RTE_MAX_LCORE];
+
+static void
+pmd_mgmt_pause(struct pmd_lcore_cfg *lc)
+{
+	uint64_t start = rte_rdtsc();
+	uint64_t end = start + lc->backoff;
+	uint64_t now;
+
+	do {
+		rte_pause();
+		now = rte_rdtsc();
+	} while (now < end);
+
+	lc->stats.sleeps++;
+	lc->stats.sleep_cycles += now - start;
+	if (lc->backoff < lc->backoff_max)
+		lc->backoff = RTE_MIN(lc->backoff * 2, lc->backoff_max);
+}
+
+/* add the queues of the lcore to the epoll instance of its thread */
+static int
+pmd_mgmt_intr_register(struct pmd_lcore_cfg *lc)
+{
+	struct pmd_queue_cfg *q;
+	unsigned i;
+
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		q = &lc->queues[i];
+		if (q->cb == NULL || q->epfd >= 0)
+			continue;
+		if (rte_eth_dev_rx_intr_ctl_q(q->port_id, q->queue_id,
+				RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_ADD,
+				NULL) < 0)
+			return -1;
+		q->epfd = rte_intr_tls_epfd();
+	}
+	return 0;
+}
+
+static void
+pmd_mgmt_intr_wait(struct pmd_lcore_cfg *lc, unsigned lcore_id)
+{
+	struct rte_epoll_event ev[RTE_POWER_PMD_MGMT_MAX_QUEUES];
+	struct pmd_queue_cfg *q;
+	uint64_t start;
+	unsigned i;
+	int n;
+
+	if (pmd_mgmt_intr_register(lc) < 0) {
+		RTE_LOG(ERR, POWER, "Cannot wait for RX interrupts on lcore %u,"
+			" falling back to pause mode\n", lcore_id);
+		lc->type = RTE_POWER_MGMT_TYPE_PAUSE;
+		return;
+	}
+
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		q = &lc->queues[i];
+		if (q->cb != NULL)
+			rte_eth_dev_rx_intr_enable(q->port_id, q->queue_id);
+	}
+
+	start = rte_rdtsc();
+	n = rte_epoll_wait(RTE_EPOLL_PER_THREAD, ev, lc->nb_queues,
+		(lc->max_sleep_us + 999) / 1000);
+	lc->stats.sleeps++;
+	lc->stats.sleep_cycles += rte_rdtsc() - start;
+	if (n > 0)
+		lc->stats.intr_wakeups++;
+
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		q = &lc->queues[i];
+		if (q->cb != NULL)
+			rte_eth_dev_rx_intr_disable(q->port_id, q->queue_id);
+	}
+}
+
+/* all the queues of the lcore just became idle */
+static void
+pmd_mgmt_idle_enter(struct pmd_lcore_cfg *lc, unsigned lcore_id)
+{
+	lc->stats.idle_entries++;
+	lc->backoff = lc->backoff_min;
+	if (lc->type == RTE_POWER_MGMT_TYPE_SCALE && !lc->scaled_down) {
+		rte_power_freq_min(lcore_id);
+		lc->scaled_down = 1;
+	}
+}
+
+/* traffic came back on one of the queues of the lcore */
+static void
+pmd_mgmt_idle_exit(struct pmd_lcore_cfg *lc, unsigned lcore_id)
+{
+	if (lc->scaled_down) {
+		rte_power_freq_max(lcore_id);
+		lc->scaled_down = 0;
+	}
+}
+
+static uint16_t
+pmd_mgmt_rx_callback(__rte_unused uint8_t port_id,
+		__rte_unused uint16_t queue_id,
+		__rte_unused struct rte_mbuf **pkts, uint16_t nb_rx,
+		__rte_unused uint16_t max_pkts, void *arg)
+{
+	struct pmd_queue_cfg *q = arg;
+	struct pmd_lcore_cfg *lc = q->lcore;
+
+	if (likely(nb_rx != 0)) {
+		if (unlikely(q->empty_polls >= lc->threshold)) {
+			if (lc->nb_idle-- == lc->nb_queues)
+				pmd_mgmt_idle_exit(lc, q->lcore_id);
+		}
+		q->empty_polls = 0;
+		return nb_rx;
+	}
+
+	if (q->empty_polls < lc->threshold) {
+		if (++q->empty_polls < lc->threshold)
+			return 0;
+		if (++lc->nb_idle == lc->nb_queues)
+			pmd_mgmt_idle_enter(lc, q->lcore_id);
+	}
+
+	/* sleep once per round over the queues of the lcore */
+	if (lc->nb_idle != lc->nb_queues || q != lc->sleep_queue)
+		return 0;
+
+	switch (lc->type) {
+	case RTE_POWER_MGMT_TYPE_PAUSE:
+		pmd_mgmt_pause(lc);
+		break;
+	case RTE_POWER_MGMT_TYPE_INTR:
+		pmd_mgmt_intr_wait(lc, q->lcore_id);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+static void
+pmd_mgmt_sleep_queue_update(struct pmd_lcore_cfg *lc)
+{
+	unsigned i;
+
+	lc->sleep_queue = NULL;
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		if (lc->queues[i].cb != NULL) {
+			lc->sleep_queue = &lc->queues[i];
+			break;
+		}
+	}
+}
+
+static struct pmd_queue_cfg *
+pmd_mgmt_queue_find(struct pmd_lcore_cfg *lc, uint8_t port_id,
+		uint16_t queue_id)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		if (lc->queues[i].cb != NULL &&
+				lc->queues[i].port_id == port_id &&
+				lc->queues[i].queue_id == queue_id)
+			return &lc->queues[i];
+	}
+	return NULL;
+}
+
+int
+rte_power_pmd_mgmt_queue_enable(unsigned lcore_id, uint8_t port_id,
+		uint16_t queue_id, const struct rte_power_pmd_mgmt_conf *conf)
+{
+	struct pmd_lcore_cfg *lc;
+	struct pmd_queue_cfg *q = NULL;
+	uint32_t threshold, max_sleep_us;
+	unsigned i;
+	int ret;
+
+	if (lcore_id >= RTE_MAX_LCORE || conf == NULL ||
+			!rte_eth_dev_is_valid_port(port_id) ||
+			queue_id >= rte_eth_devices[port_id].data->nb_rx_queues)
+		return -EINVAL;
+	if (conf->type != RTE_POWER_MGMT_TYPE_PAUSE &&
+			conf->type != RTE_POWER_MGMT_TYPE_SCALE &&
+			conf->type != RTE_POWER_MGMT_TYPE_INTR)
+		return -EINVAL;
+
+	threshold = conf->empty_poll_threshold != 0 ?
+		conf->empty_poll_threshold :
+		RTE_POWER_PMD_MGMT_EMPTY_POLLS_DEFAULT;
+	max_sleep_us = conf->max_sleep_us != 0 ? conf->max_sleep_us :
+		RTE_POWER_PMD_MGMT_SLEEP_US_DEFAULT;
+
+	lc = &lcore_cfgs[lcore_id];
+	for (i = 0; i < RTE_DIM(lcore_cfgs); i++) {
+		if (i != lcore_id &&
+				pmd_mgmt_queue_find(&lcore_cfgs[i], port_id,
+					queue_id) != NULL)
+			return -EEXIST;
+	}
+	if (pmd_mgmt_queue_find(lc, port_id, queue_id) != NULL)
+		return -EEXIST;
+	if (lc->nb_queues != 0 && (lc->type != conf->type ||
+			lc->threshold != threshold ||
+			lc->max_sleep_us != max_sleep_us)) {
+		RTE_LOG(ERR, POWER, "All the queues of lcore %u must use the "
+			"same power management configuration\n", lcore_id);
+		return -EINVAL;
+	}
+	for (i = 0; i < RTE_POWER_PMD_MGMT_MAX_QUEUES; i++) {
+		if (lc->queues[i].cb == NULL) {
+			q = &lc->queues[i];
+			break;
+		}
+	}
+	if (q == NULL)
+		return -ENOSPC;
+
+	switch (conf->type) {
+	case RTE_POWER_MGMT_TYPE_SCALE:
+		if (rte_power_get_env() == PM_ENV_NOT_SET) {
+			RTE_LOG(ERR, POWER, "rte_power is not initialised "
+				"for lcore %u\n", lcore_id);
+			return -ENOTSUP;
+		}
+		break;
+	case RTE_POWER_MGMT_TYPE_INTR:
+		ret = rte_eth_dev_rx_intr_disable(port_id, queue_id);
+		if (ret < 0) {
+			RTE_LOG(ERR, POWER, "Port %u queue %u does not "
+				"support RX interrupts\n", port_id, queue_id);
+			return -ENOTSUP;
+		}
+		break;
+	default:
+		break;
+	}
+
+	memset(q, 0, sizeof(*q));
+	q->lcore = lc;
+	q->lcore_id = lcore_id;
+	q->port_id = port_id;
+	q->queue_id = queue_id;
+	q->epfd = -1;
+
+	if (lc->nb_queues == 0) {
+		lc->type = conf->type;
+		lc->threshold = threshold;
+		lc->max_sleep_us = max_sleep_us;
+		lc->backoff_min = rte_get_tsc_hz() / 1000000 *
+			PAUSE_BACKOFF_MIN_US;
+		lc->backoff_max = rte_get_tsc_hz() / 1000000 * max_sleep_us;
+		lc->backoff = lc->backoff_min;
+		lc->nb_idle = 0;
+		lc->scaled_down = 0;
+	}
+
+	q->cb = rte_eth_add_rx_callback(port_id, queue_id,
+		pmd_mgmt_rx_callback, q);
+	if (q->cb == NULL) {
+		RTE_LOG(ERR, POWER, "Cannot add RX callback to port %u "
+			"queue %u\n", port_id, queue_id);
+		return -ENOTSUP;
+	}
+	lc->nb_queues++;
+	pmd_mgmt_sleep_queue_update(lc);
+	return 0;
+}
+
+/*
+ * Whether the RX callback of a queue may be running: ethdev does not wait
+ * for callbacks in flight when removing one, so it can only be freed when
+ * the port is stopped or the polling lcore is known not to be in an RX
+ * burst, i.e. it is the calling one or it has no function to run.
+ */
+static int
+pmd_mgmt_cb_in_flight(unsigned lcore_id, uint8_t port_id)
+{
+	if (!rte_eth_devices[port_id].data->dev_started)
+		return 0;
+	if (lcore_id == rte_lcore_id())
+		return 0;
+	if (lcore_id != rte_get_master_lcore() &&
+			rte_lcore_is_enabled(lcore_id) &&
+			rte_eal_get_lcore_state(lcore_id) != RUNNING)
+		return 0;
+	return 1;
+}
+
+int
+rte_power_pmd_mgmt_queue_disable(unsigned lcore_id, uint8_t port_id,
+		uint16_t queue_id)
+{
+	struct pmd_lcore_cfg *lc;
+	struct pmd_queue_cfg *q;
+	int idle;
+
+	if (lcore_id >= RTE_MAX_LCORE || !rte_eth_dev_is_valid_port(port_id))
+		return -EINVAL;
+
+	lc = &lcore_cfgs[lcore_id];
+	q = pmd_mgmt_queue_find(lc, port_id, queue_id);
+	if (q == NULL)
+		return -ENOENT;
+	if (pmd_mgmt_cb_in_flight(lcore_id, port_id)) {
+		RTE_LOG(ERR, POWER, "Lcore %u may be polling port %u queue %u\n",
+			lcore_id, port_id, queue_id);
+		return -EBUSY;
+	}
+
+	rte_eth_remove_rx_callback(port_id, queue_id, q->cb);
+	rte_free(q->cb);
+	if (q->epfd >= 0)
+		rte_eth_dev_rx_intr_ctl_q(port_id, queue_id, q->epfd,
+			RTE_INTR_EVENT_DEL, NULL);
+
+	if (q->empty_polls >= lc->threshold)
+		lc->nb_idle--;
+	q->cb = NULL;
+	lc->nb_queues--;
+	pmd_mgmt_sleep_queue_update(lc);
+
+	/* the remaining queues may all be idle now, or there may be none */
+	if (lc->type == RTE_POWER_MGMT_TYPE_SCALE) {
+		idle = lc->nb_queues != 0 && lc->nb_idle == lc->nb_queues;
+		if (idle && !lc->scaled_down)
+			rte_power_freq_min(lcore_id);
+		else if (!idle && lc->scaled_down)
+			rte_power_freq_max(lcore_id);
+		lc->scaled_down = idle;
+	}
+	return 0;
+}
+
+int
+rte_power_pmd_mgmt_stats_get(unsigned lcore_id,
+		struct rte_power_pmd_mgmt_stats *stats)
+{
+	if (lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+
+	*stats = lcore_cfgs[lcore_id].stats;
+	return 0;
+}
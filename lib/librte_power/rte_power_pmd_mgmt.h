@@ -0,0 +1,166 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_POWER_PMD_MGMT_H
+#define _RTE_POWER_PMD_MGMT_H
+
+/**
+ * @file
+ * RTE PMD Power Management
+ *
+ * Power management of the lcores polling ethdev RX queues, driven by the
+ * RX path itself. A callback attached with rte_eth_add_rx_callback()
+ * counts the consecutive empty polls of each managed queue. Once all
+ * the managed queues of an lcore are idle, the lcore backs off with
+ * rte_pause(), scales its frequency down with rte_power, or sleeps on
+ * the RX queue interrupts, until traffic comes back. The time spent
+ * asleep is bounded, which bounds the wake-up latency.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of managed RX queues per lcore. */
+#define RTE_POWER_PMD_MGMT_MAX_QUEUES 8
+
+/** Default number of empty polls after which a queue is idle. */
+#define RTE_POWER_PMD_MGMT_EMPTY_POLLS_DEFAULT 512
+
+/** Default bound of a single sleep, in microseconds. */
+#define RTE_POWER_PMD_MGMT_SLEEP_US_DEFAULT 100
+
+/** What an lcore does while all its managed queues are idle. */
+enum rte_power_pmd_mgmt_type {
+	/** Busy-wait with rte_pause(), with an exponential backoff. */
+	RTE_POWER_MGMT_TYPE_PAUSE = 1,
+	/** Run at the minimum frequency, see rte_power_freq_min(). */
+	RTE_POWER_MGMT_TYPE_SCALE,
+	/** Sleep until an RX queue interrupt or a timeout. */
+	RTE_POWER_MGMT_TYPE_INTR,
+};
+
+/** Configuration of a managed RX queue. */
+struct rte_power_pmd_mgmt_conf {
+	enum rte_power_pmd_mgmt_type type; /**< Power management mode. */
+	/** Consecutive empty polls after which the queue is idle, or 0 for
+	 *  RTE_POWER_PMD_MGMT_EMPTY_POLLS_DEFAULT. */
+	uint32_t empty_poll_threshold;
+	/** Upper bound of a single sleep in microseconds, or 0 for
+	 *  RTE_POWER_PMD_MGMT_SLEEP_US_DEFAULT. It bounds the wake-up
+	 *  latency of the PAUSE mode, and of the INTR mode when an interrupt
+	 *  is missed; the INTR mode rounds it up to milliseconds. */
+	uint32_t max_sleep_us;
+};
+
+/** Statistics of the power management of an lcore. */
+struct rte_power_pmd_mgmt_stats {
+	uint64_t idle_entries;  /**< Times all the queues became idle. */
+	uint64_t sleeps;        /**< Backoffs (PAUSE) or interrupt waits (INTR). */
+	uint64_t sleep_cycles;  /**< TSC cycles spent in backoffs and waits. */
+	uint64_t intr_wakeups;  /**< Waits ended by an interrupt (INTR). */
+};
+
+/**
+ * Enable power management of an RX queue polled by an lcore.
+ *
+ * All the managed queues of an lcore must use the same configuration.
+ * The SCALE mode needs rte_power_init() to have been called for the
+ * lcore; the INTR mode needs a device supporting RX queue interrupts,
+ * configured with intr_conf.rxq set. The queue must not be polled while
+ * this function is called.
+ *
+ * @param lcore_id
+ *   The lcore polling the queue.
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX queue identifier.
+ * @param conf
+ *   The power management configuration.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL: Invalid parameters, or configuration different from the
+ *     other queues of the lcore.
+ *   - -EEXIST: The queue is already managed.
+ *   - -ENOSPC: Too many queues managed on the lcore.
+ *   - -ENOTSUP: The mode is not supported by the lcore or the device.
+ */
+int rte_power_pmd_mgmt_queue_enable(unsigned lcore_id, uint8_t port_id,
+		uint16_t queue_id, const struct rte_power_pmd_mgmt_conf *conf);
+
+/**
+ * Disable power management of an RX queue.
+ *
+ * If the lcore was running at the minimum frequency, it is set back to
+ * the maximum. The RX callback is freed, so the queue must not be polled
+ * while this function is called: the port must be stopped, or the function
+ * must be called either by the polling lcore or while that lcore does not
+ * run any function.
+ *
+ * @param lcore_id
+ *   The lcore polling the queue.
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX queue identifier.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOENT: The queue is not managed on this lcore.
+ *   - -EBUSY: The lcore may be polling the queue.
+ */
+int rte_power_pmd_mgmt_queue_disable(unsigned lcore_id, uint8_t port_id,
+		uint16_t queue_id);
+
+/**
+ * Get the power management statistics of an lcore.
+ *
+ * @param lcore_id
+ *   The lcore identifier.
+ * @param stats
+ *   The statistics are stored there.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL: Invalid parameters.
+ */
+int rte_power_pmd_mgmt_stats_get(unsigned lcore_id,
+		struct rte_power_pmd_mgmt_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_POWER_PMD_MGMT_H */
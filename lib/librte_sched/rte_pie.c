@@ -0,0 +1,112 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rte_pie.h"
+#include <rte_random.h>
+#include <rte_common.h>
+
+static int rte_pie_init_done = 0;     /**< Flag to indicate that global initialisation is done */
+uint32_t rte_pie_rand_seed = 0;       /**< Seed for random number generation */
+
+int
+rte_pie_rt_data_init(const struct rte_pie_config *pie_cfg, struct rte_pie *pie)
+{
+	if ((pie_cfg == NULL) || (pie == NULL))
+		return -1;
+
+	pie->avg_dq_time = 0;
+	pie->dq_start = 0;
+	pie->qdelay_old = 0;
+	pie->last_update = 0;
+	pie->burst_allowance = pie_cfg->max_burst;
+	pie->drop_prob = 0;
+	pie->dq_count = 0;
+	pie->in_measurement = 0;
+	return 0;
+}
+
+static inline uint64_t
+__rte_pie_ms_to_time(uint16_t time_ms, uint64_t time_hz)
+{
+	return (time_ms * time_hz) / 1000;
+}
+
+int
+rte_pie_config_init(struct rte_pie_config *pie_cfg,
+	const uint16_t qdelay_ref,
+	const uint16_t dp_update_interval,
+	const uint16_t max_burst,
+	const uint16_t tailq_th,
+	const uint64_t time_hz)
+{
+	if (pie_cfg == NULL) {
+		return -1;
+	}
+	if ((qdelay_ref == 0) || (qdelay_ref > RTE_PIE_QDELAY_REF_MAX)) {
+		return -2;
+	}
+	if ((dp_update_interval == 0) ||
+	    (dp_update_interval > RTE_PIE_DP_UPDATE_INTERVAL_MAX)) {
+		return -3;
+	}
+	if (tailq_th == 0) {
+		return -4;
+	}
+	if (time_hz == 0) {
+		return -5;
+	}
+
+	/**
+	 *  Initialize the PIE module if not already done
+	 */
+	if (!rte_pie_init_done) {
+		rte_pie_rand_seed = rte_rand();
+		rte_pie_init_done = 1;
+	}
+
+	pie_cfg->qdelay_ref = __rte_pie_ms_to_time(qdelay_ref, time_hz);
+	pie_cfg->dp_update_interval = __rte_pie_ms_to_time(dp_update_interval, time_hz);
+	pie_cfg->max_burst = __rte_pie_ms_to_time(max_burst, time_hz);
+	pie_cfg->qdelay_max = __rte_pie_ms_to_time(250, time_hz);
+	pie_cfg->tailq_th = tailq_th;
+
+	/**
+	 * Controller gains (RFC 8033): alpha = 0.125 Hz, beta = 1.25 Hz. The
+	 * queue delay is measured in time stamp units, so both gains are
+	 * divided by time_hz, then scaled in fixed-point format.
+	 */
+	pie_cfg->alpha = (int64_t) (((uint64_t) RTE_PIE_PROB_ONE << RTE_PIE_SCALING) / (8 * time_hz));
+	pie_cfg->beta = (int64_t) ((((uint64_t) RTE_PIE_PROB_ONE << RTE_PIE_SCALING) * 5) / (4 * time_hz));
+
+	return 0;
+}
@@ -0,0 +1,334 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTE_PIE_H_INCLUDED__
+#define __RTE_PIE_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Proportional Integral controller Enhanced (PIE)
+ *
+ * Active queue management algorithm that controls the queueing delay
+ * (RFC 8033). The queueing delay of each queue is estimated from the
+ * current queue length and the measured departure rate of the queue,
+ * and the drop probability is periodically adjusted so that the delay
+ * converges to a configured reference value.
+ *
+ * All time stamps passed to this module have to use the same time base,
+ * whose frequency is provided at configuration time. The hierarchical
+ * scheduler uses the port time, measured in bytes.
+ *
+ ***/
+
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_branch_prediction.h>
+
+#define RTE_PIE_SCALING                     20         /**< Fraction size for fixed-point controller gains */
+#define RTE_PIE_PROB_ONE                    (1 << 22)  /**< Drop probability of 1 in fixed point format */
+#define RTE_PIE_DQ_THRESHOLD                16         /**< Min queue length (packets) to start a departure rate measurement */
+#define RTE_PIE_DQ_WEIGHT_LOG2              3          /**< Negated log2 of the departure time EWMA filter weight */
+#define RTE_PIE_QDELAY_REF_MAX              1000       /**< Max reference queue delay (ms) */
+#define RTE_PIE_DP_UPDATE_INTERVAL_MAX      1000       /**< Max drop probability update interval (ms) */
+
+#ifdef RTE_PIE_DEBUG
+
+#define RTE_PIE_ASSERT(exp)                                      \
+if (!(exp)) {                                                    \
+	rte_panic("line%d\tassert \"" #exp "\" failed\n", __LINE__); \
+}
+
+#else
+
+#define RTE_PIE_ASSERT(exp)                 do { } while(0)
+
+#endif /* RTE_PIE_DEBUG */
+
+/**
+ * Externs
+ *
+ */
+extern uint32_t rte_pie_rand_seed;
+
+/**
+ * PIE configuration parameters passed by user
+ *
+ */
+struct rte_pie_params {
+	uint16_t qdelay_ref;         /**< Reference (target) queue delay (ms). Zero disables PIE. */
+	uint16_t dp_update_interval; /**< Drop probability update interval (ms) */
+	uint16_t max_burst;          /**< Burst allowance, during which no packet is dropped (ms) */
+	uint16_t tailq_th;           /**< Tail drop threshold (packets) */
+};
+
+/**
+ * PIE configuration parameters
+ */
+struct rte_pie_config {
+	uint64_t qdelay_ref;         /**< qdelay_ref in time stamp units */
+	uint64_t dp_update_interval; /**< dp_update_interval in time stamp units */
+	uint64_t max_burst;          /**< max_burst in time stamp units */
+	uint64_t qdelay_max;         /**< Queue delay above which the drop probability is raised fast */
+	int64_t alpha;               /**< Integral gain, scaled in fixed-point format */
+	int64_t beta;                /**< Proportional gain, scaled in fixed-point format */
+	uint16_t tailq_th;           /**< tailq_th */
+};
+
+/**
+ * PIE run-time data
+ */
+struct rte_pie {
+	uint64_t avg_dq_time;        /**< Average time between two departures (avg_dq_time) */
+	uint64_t dq_start;           /**< Start of the current departure rate measurement */
+	uint64_t qdelay_old;         /**< Queue delay estimated at the previous update */
+	uint64_t last_update;        /**< Time of the last drop probability update */
+	uint64_t burst_allowance;    /**< Remaining burst allowance (burst_allowance) */
+	uint32_t drop_prob;          /**< Drop probability, scaled in fixed-point format */
+	uint16_t dq_count;           /**< Packets departed since dq_start */
+	uint8_t in_measurement;      /**< Departure rate measurement in progress */
+	uint8_t reserved;
+};
+
+/**
+ * @brief Initialises run-time data
+ *
+ * @param pie_cfg [in] config pointer to a PIE configuration parameter structure
+ * @param pie [in,out] data pointer to PIE runtime data
+ *
+ * @return Operation status
+ * @retval 0 success
+ * @retval !0 error
+ */
+int
+rte_pie_rt_data_init(const struct rte_pie_config *pie_cfg, struct rte_pie *pie);
+
+/**
+ * @brief Configures a single PIE configuration parameter structure.
+ *
+ * @param pie_cfg [in,out] config pointer to a PIE configuration parameter structure
+ * @param qdelay_ref [in] reference queue delay (ms)
+ * @param dp_update_interval [in] drop probability update interval (ms)
+ * @param max_burst [in] burst allowance (ms)
+ * @param tailq_th [in] tail drop threshold (packets)
+ * @param time_hz [in] frequency of the time stamps provided to the run-time
+ *             functions, e.g. the port rate in bytes per second for the
+ *             hierarchical scheduler
+ *
+ * @return Operation status
+ * @retval 0 success
+ * @retval !0 error
+ */
+int
+rte_pie_config_init(struct rte_pie_config *pie_cfg,
+	const uint16_t qdelay_ref,
+	const uint16_t dp_update_interval,
+	const uint16_t max_burst,
+	const uint16_t tailq_th,
+	const uint64_t time_hz);
+
+/**
+ * @brief Generate random number for PIE
+ *
+ * Same linear congruential generator as the one used by RED.
+ *
+ * @return Random number between 0 and (2^22 - 1)
+ */
+static inline uint32_t
+rte_pie_fast_rand(void)
+{
+	rte_pie_rand_seed = (214013 * rte_pie_rand_seed) + 2531011;
+	return (rte_pie_rand_seed >> 10);
+}
+
+/**
+ * @brief Periodic drop probability update (RFC 8033, section 4.2)
+ *
+ * @param pie_cfg [in] config pointer to a PIE configuration parameter structure
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param q [in] current queue size (measured in packets)
+ * @param time [in] current time stamp
+ */
+static inline void
+__rte_pie_drop_prob_update(const struct rte_pie_config *pie_cfg,
+	struct rte_pie *pie,
+	const unsigned q,
+	const uint64_t time)
+{
+	uint64_t qdelay = q * pie->avg_dq_time;
+	uint32_t p = pie->drop_prob;
+	int64_t p_delta;
+
+	p_delta = (pie_cfg->alpha * ((int64_t) qdelay - (int64_t) pie_cfg->qdelay_ref) +
+		pie_cfg->beta * ((int64_t) qdelay - (int64_t) pie->qdelay_old)) >> RTE_PIE_SCALING;
+
+	/* Auto-tuning: smaller steps while the drop probability is low */
+	if (p < RTE_PIE_PROB_ONE / 1000000)
+		p_delta /= 2048;
+	else if (p < RTE_PIE_PROB_ONE / 100000)
+		p_delta /= 512;
+	else if (p < RTE_PIE_PROB_ONE / 10000)
+		p_delta /= 128;
+	else if (p < RTE_PIE_PROB_ONE / 1000)
+		p_delta /= 32;
+	else if (p < RTE_PIE_PROB_ONE / 100)
+		p_delta /= 8;
+	else if (p < RTE_PIE_PROB_ONE / 10)
+		p_delta /= 2;
+	else if (p_delta > RTE_PIE_PROB_ONE / 50)
+		p_delta = RTE_PIE_PROB_ONE / 50;
+
+	/* Raise the drop probability fast when the delay is way too high */
+	if (qdelay > pie_cfg->qdelay_max)
+		p_delta += RTE_PIE_PROB_ONE / 50;
+
+	p_delta += p;
+	if (p_delta < 0)
+		p_delta = 0;
+	if (p_delta > RTE_PIE_PROB_ONE)
+		p_delta = RTE_PIE_PROB_ONE;
+	p = (uint32_t) p_delta;
+
+	/* Exponential decay when the queue stays empty */
+	if ((qdelay == 0) && (pie->qdelay_old == 0))
+		p -= p >> 6;
+
+	/* Burst allowance is restored once the queue has settled down */
+	if ((p == 0) &&
+		(qdelay < (pie_cfg->qdelay_ref >> 1)) &&
+		(pie->qdelay_old < (pie_cfg->qdelay_ref >> 1)))
+		pie->burst_allowance = pie_cfg->max_burst;
+	else if (pie->burst_allowance > pie_cfg->dp_update_interval)
+		pie->burst_allowance -= pie_cfg->dp_update_interval;
+	else
+		pie->burst_allowance = 0;
+
+	pie->drop_prob = p;
+	pie->qdelay_old = qdelay;
+	pie->last_update = time;
+}
+
+/**
+ * @brief Decides if new packet should be enqueued or dropped
+ * Updates the drop probability when the update interval has elapsed and
+ * gives verdict whether to enqueue or drop the packet.
+ *
+ * @param pie_cfg [in] config pointer to a PIE configuration parameter structure
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param q [in] current queue size (measured in packets)
+ * @param time [in] current time stamp
+ *
+ * @return Operation status
+ * @retval 0 enqueue the packet
+ * @retval 1 drop the packet based on tail drop threshold criterion
+ * @retval 2 drop the packet based on drop probability criterion
+ */
+static inline int
+rte_pie_enqueue(const struct rte_pie_config *pie_cfg,
+	struct rte_pie *pie,
+	const unsigned q,
+	const uint64_t time)
+{
+	RTE_PIE_ASSERT(pie_cfg != NULL);
+	RTE_PIE_ASSERT(pie != NULL);
+
+	if (q >= pie_cfg->tailq_th)
+		return 1;
+
+	if (time - pie->last_update >= pie_cfg->dp_update_interval)
+		__rte_pie_drop_prob_update(pie_cfg, pie, q, time);
+
+	/* No drop while in burst allowance or with a short queue */
+	if ((pie->burst_allowance != 0) || (q <= 2))
+		return 0;
+
+	/* No drop while the delay is low and the probability is moderate */
+	if ((pie->qdelay_old < (pie_cfg->qdelay_ref >> 1)) &&
+		(pie->drop_prob < RTE_PIE_PROB_ONE / 5))
+		return 0;
+
+	if (unlikely(rte_pie_fast_rand() < pie->drop_prob))
+		return 2;
+
+	return 0;
+}
+
+/**
+ * @brief Departure rate estimation, called for each packet leaving the queue
+ *
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param q [in] queue size before the departure (measured in packets)
+ * @param time [in] current time stamp
+ */
+static inline void
+rte_pie_dequeue(struct rte_pie *pie,
+	const unsigned q,
+	const uint64_t time)
+{
+	RTE_PIE_ASSERT(pie != NULL);
+
+	if (!pie->in_measurement) {
+		if (q < RTE_PIE_DQ_THRESHOLD)
+			return;
+
+		pie->in_measurement = 1;
+		pie->dq_start = time;
+		pie->dq_count = 0;
+	}
+
+	pie->dq_count++;
+	if (pie->dq_count >= RTE_PIE_DQ_THRESHOLD) {
+		uint64_t dq_time = (time - pie->dq_start) / pie->dq_count;
+
+		if (pie->avg_dq_time == 0)
+			pie->avg_dq_time = dq_time;
+		else
+			pie->avg_dq_time += (dq_time >> RTE_PIE_DQ_WEIGHT_LOG2) -
+				(pie->avg_dq_time >> RTE_PIE_DQ_WEIGHT_LOG2);
+
+		/* Start a new cycle right away while the queue stays long */
+		pie->in_measurement = (q - 1 >= RTE_PIE_DQ_THRESHOLD);
+		pie->dq_start = time;
+		pie->dq_count = 0;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTE_PIE_H_INCLUDED__ */
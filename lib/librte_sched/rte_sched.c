@@ -162,7 +162,10 @@ struct rte_sched_pipe {
 	/* TC oversubscription */
 	uint32_t tc_ov_credits;
 	uint8_t tc_ov_period_id;
-	uint8_t reserved[3];
+
+	/* Pipe has a valid configuration (tb_time can legitimately be 0) */
+	uint8_t configured;
+	uint8_t reserved[2];
 } __rte_cache_aligned;
 
 struct rte_sched_queue {
@@ -175,6 +178,9 @@ struct rte_sched_queue_extra {
 #ifdef RTE_SCHED_RED
 	struct rte_red red;
 #endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie pie;
+#endif
 };
 
 enum grinder_state {
@@ -249,6 +255,9 @@ struct rte_sched_port {
 #ifdef RTE_SCHED_RED
 	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
 #endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie_config pie_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+#endif
 
 	/* Timing */
 	uint64_t time_cpu_cycles;     /* Current CPU time measured in CPU cyles */
@@ -312,10 +321,54 @@ rte_sched_port_queues_per_port(struct rte_sched_port *port)
 	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
 }
 
+static int
+rte_sched_pipe_profile_check(struct rte_sched_pipe_params *p, uint32_t rate)
+{
+	uint32_t j;
+
+	/* TB rate: non-zero, not greater than port rate */
+	if ((p->tb_rate == 0) || (p->tb_rate > rate)) {
+		return -10;
+	}
+
+	/* TB size: non-zero */
+	if (p->tb_size == 0) {
+		return -11;
+	}
+
+	/* TC rate: non-zero, less than pipe rate */
+	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
+		if ((p->tc_rate[j] == 0) || (p->tc_rate[j] > p->tb_rate)) {
+			return -12;
+		}
+	}
+
+	/* TC period: non-zero */
+	if (p->tc_period == 0) {
+		return -13;
+	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	/* TC3 oversubscription weight: non-zero */
+	if (p->tc_ov_weight == 0) {
+		return -14;
+	}
+#endif
+
+	/* Queue WRR weights: non-zero */
+	for (j = 0; j < RTE_SCHED_QUEUES_PER_PIPE; j ++) {
+		if (p->wrr_weights[j] == 0) {
+			return -15;
+		}
+	}
+
+	return 0;
+}
+
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
-	uint32_t i, j;
+	uint32_t i;
 
 	if (params == NULL) {
 		return -1;
@@ -364,41 +417,11 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 
 	for (i = 0; i < params->n_pipe_profiles; i ++) {
 		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
+		int status;
 
-		/* TB rate: non-zero, not greater than port rate */
-		if ((p->tb_rate == 0) || (p->tb_rate > params->rate)) {
-			return -10;
-		}
-
-		/* TB size: non-zero */
-		if (p->tb_size == 0) {
-			return -11;
-		}
-
-		/* TC rate: non-zero, less than pipe rate */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			if ((p->tc_rate[j] == 0) || (p->tc_rate[j] > p->tb_rate)) {
-				return -12;
-			}
-		}
-
-		/* TC period: non-zero */
-		if (p->tc_period == 0) {
-			return -13;
-		}
-
-#ifdef RTE_SCHED_SUBPORT_TC_OV
-		/* TC3 oversubscription weight: non-zero */
-		if (p->tc_ov_weight == 0) {
-			return -14;
-		}
-#endif
-
-		/* Queue WRR weights: non-zero */
-		for (j = 0; j < RTE_SCHED_QUEUES_PER_PIPE; j ++) {
-			if (p->wrr_weights[j] == 0) {
-				return -15;
-			}
+		status = rte_sched_pipe_profile_check(p, params->rate);
+		if (status != 0) {
+			return status;
 		}
 	}
 
@@ -549,63 +572,72 @@ rte_sched_time_ms_to_bytes(uint32_t time_ms, uint32_t rate)
 }
 
 static void
-rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte_sched_port_params *params)
+rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
+	struct rte_sched_pipe_profile *dst,
+	uint32_t rate)
 {
-	uint32_t i, j;
+	uint32_t j;
 
-	for (i = 0; i < port->n_pipe_profiles; i ++) {
-		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		struct rte_sched_pipe_profile *dst = port->pipe_profiles + i;
-
-		/* Token Bucket */
-		if (src->tb_rate == params->rate) {
-			dst->tb_credits_per_period = 1;
-			dst->tb_period = 1;
-		} else {
-			double tb_rate = ((double) src->tb_rate) / ((double) params->rate);
-			double d = RTE_SCHED_TB_RATE_CONFIG_ERR;
+	/* Token Bucket */
+	if (src->tb_rate == rate) {
+		dst->tb_credits_per_period = 1;
+		dst->tb_period = 1;
+	} else {
+		double tb_rate = ((double) src->tb_rate) / ((double) rate);
+		double d = RTE_SCHED_TB_RATE_CONFIG_ERR;
 
-			rte_approx(tb_rate, d, &dst->tb_credits_per_period, &dst->tb_period);
-		}
-		dst->tb_size = src->tb_size;
+		rte_approx(tb_rate, d, &dst->tb_credits_per_period, &dst->tb_period);
+	}
+	dst->tb_size = src->tb_size;
 
-		/* Traffic Classes */
-		dst->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, params->rate);
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			dst->tc_credits_per_period[j] = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, src->tc_rate[j]);
-		}
+	/* Traffic Classes */
+	dst->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, rate);
+	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
+		dst->tc_credits_per_period[j] = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, src->tc_rate[j]);
+	}
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		dst->tc_ov_weight = src->tc_ov_weight;
+	dst->tc_ov_weight = src->tc_ov_weight;
 #endif
 
-		/* WRR */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-			uint32_t lcd, lcd1, lcd2;
-			uint32_t qindex;
-
-			qindex = j * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-			wrr_cost[0] = src->wrr_weights[qindex];
-			wrr_cost[1] = src->wrr_weights[qindex + 1];
-			wrr_cost[2] = src->wrr_weights[qindex + 2];
-			wrr_cost[3] = src->wrr_weights[qindex + 3];
-
-			lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-			lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-			lcd = rte_get_lcd(lcd1, lcd2);
-
-			wrr_cost[0] = lcd / wrr_cost[0];
-			wrr_cost[1] = lcd / wrr_cost[1];
-			wrr_cost[2] = lcd / wrr_cost[2];
-			wrr_cost[3] = lcd / wrr_cost[3];
-
-			dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-			dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-			dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-			dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
-		}
+	/* WRR */
+	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
+		uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+		uint32_t lcd, lcd1, lcd2;
+		uint32_t qindex;
+
+		qindex = j * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+
+		wrr_cost[0] = src->wrr_weights[qindex];
+		wrr_cost[1] = src->wrr_weights[qindex + 1];
+		wrr_cost[2] = src->wrr_weights[qindex + 2];
+		wrr_cost[3] = src->wrr_weights[qindex + 3];
+
+		lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
+		lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
+		lcd = rte_get_lcd(lcd1, lcd2);
+
+		wrr_cost[0] = lcd / wrr_cost[0];
+		wrr_cost[1] = lcd / wrr_cost[1];
+		wrr_cost[2] = lcd / wrr_cost[2];
+		wrr_cost[3] = lcd / wrr_cost[3];
+
+		dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
+		dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
+		dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
+		dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+	}
+}
+
+static void
+rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte_sched_port_params *params)
+{
+	uint32_t i;
+
+	for (i = 0; i < port->n_pipe_profiles; i ++) {
+		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
+		struct rte_sched_pipe_profile *dst = port->pipe_profiles + i;
 
+		rte_sched_pipe_profile_convert(src, dst, params->rate);
 		rte_sched_port_log_pipe_profile(port, i);
 	}
 
@@ -669,6 +701,42 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	}
 #endif
 
+#ifdef RTE_SCHED_PIE
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+		struct rte_pie_params *pp = &params->pie_params[i];
+
+		/* if qdelay_ref is zero, then PIE is disabled */
+		if (pp->qdelay_ref == 0) {
+			continue;
+		}
+
+#ifdef RTE_SCHED_RED
+		{
+			uint32_t j;
+
+			/* RED and PIE are mutually exclusive per traffic class */
+			for (j = 0; j < e_RTE_METER_COLORS; j++) {
+				if ((params->red_params[i][j].min_th |
+				     params->red_params[i][j].max_th) != 0) {
+					RTE_LOG(ERR, SCHED,
+						"Both RED and PIE set for traffic class %u\n", i);
+					return NULL;
+				}
+			}
+		}
+#endif
+
+		if (rte_pie_config_init(&port->pie_config[i],
+			pp->qdelay_ref,
+			pp->dp_update_interval,
+			pp->max_burst,
+			pp->tailq_th,
+			params->rate) != 0) {
+			return NULL;
+		}
+	}
+#endif
+
 	/* Timing */
 	port->time_cpu_cycles = rte_get_tsc_cycles();
 	port->time_cpu_bytes = 0;
@@ -699,6 +767,18 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	/* Pipe profile table */
 	rte_sched_port_config_pipe_profile_table(port, params);
 
+#ifdef RTE_SCHED_PIE
+	/* PIE run-time data */
+	n_queues_per_port = rte_sched_port_queues_per_port(port);
+	for (i = 0; i < n_queues_per_port; i ++) {
+		uint32_t tc = (i >> 2) & 0x3;
+
+		if (port->pie_config[tc].tailq_th != 0) {
+			rte_pie_rt_data_init(&port->pie_config[tc], &port->queue_extra[i].pie);
+		}
+	}
+#endif
+
 	/* Bitmap */
 	n_queues_per_port = rte_sched_port_queues_per_port(port);
 	bmp_mem_size = rte_bitmap_get_memory_footprint(n_queues_per_port);
@@ -754,21 +834,12 @@ rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 		s->tc_ov_wm_max);
 }
 
-int
-rte_sched_subport_config(struct rte_sched_port *port,
-	uint32_t subport_id,
+static int
+rte_sched_subport_check_params(struct rte_sched_port *port,
 	struct rte_sched_subport_params *params)
 {
-	struct rte_sched_subport *s;
 	uint32_t i;
 
-	/* Check user parameters */
-	if ((port == NULL) ||
-	    (subport_id >= port->n_subports_per_port) ||
-		(params == NULL)) {
-		return -1;
-	}
-
 	if ((params->tb_rate == 0) || (params->tb_rate > port->rate)) {
 		return -2;
 	}
@@ -787,7 +858,15 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		return -5;
 	}
 
-	s = port->subport + subport_id;
+	return 0;
+}
+
+static void
+rte_sched_subport_config_rates(struct rte_sched_port *port,
+	struct rte_sched_subport *s,
+	struct rte_sched_subport_params *params)
+{
+	uint32_t i;
 
 	/* Token Bucket (TB) */
 	if (params->tb_rate == port->rate) {
@@ -800,14 +879,50 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		rte_approx(tb_rate, d, &s->tb_credits_per_period, &s->tb_period);
 	}
 	s->tb_size = params->tb_size;
-	s->tb_time = port->time;
-	s->tb_credits = s->tb_size / 2;
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
 		s->tc_credits_per_period[i] = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, params->tc_rate[i]);
 	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	/* TC oversubscription watermark limits */
+	s->tc_ov_wm_min = port->mtu;
+	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc3_rate_max);
+#endif
+}
+
+int
+rte_sched_subport_config(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_subport_params *params)
+{
+	struct rte_sched_subport *s;
+	uint32_t i;
+	int status;
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (subport_id >= port->n_subports_per_port) ||
+		(params == NULL)) {
+		return -1;
+	}
+
+	status = rte_sched_subport_check_params(port, params);
+	if (status != 0) {
+		return status;
+	}
+
+	s = port->subport + subport_id;
+
+	rte_sched_subport_config_rates(port, s, params);
+
+	/* Token Bucket (TB) */
+	s->tb_time = port->time;
+	s->tb_credits = s->tb_size / 2;
+
+	/* Traffic Classes (TCs) */
 	s->tc_time = port->time + s->tc_period;
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
 		s->tc_credits[i] = s->tc_credits_per_period[i];
@@ -815,8 +930,6 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
-	s->tc_ov_wm_min = port->mtu;
-	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc3_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
 	s->tc_ov = 0;
@@ -829,6 +942,116 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	return 0;
 }
 
+int
+rte_sched_subport_update(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_subport_params *params)
+{
+	struct rte_sched_subport *s;
+	uint32_t i;
+	int status;
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (subport_id >= port->n_subports_per_port) ||
+		(params == NULL)) {
+		return -1;
+	}
+
+	status = rte_sched_subport_check_params(port, params);
+	if (status != 0) {
+		return status;
+	}
+
+	/* Check that subport configuration is valid */
+	s = port->subport + subport_id;
+	if (s->tb_period == 0) {
+		return -6;
+	}
+
+	rte_sched_subport_config_rates(port, s, params);
+
+	/* Token Bucket (TB): keep the accumulated credits and the time of the
+	 * last update, only trim the credits to the new bucket size */
+	if (s->tb_credits > s->tb_size) {
+		s->tb_credits = s->tb_size;
+	}
+
+	/* Traffic Classes (TCs): keep the current enforcement period running,
+	 * but do not let it extend past the new period length */
+	if (s->tc_time > port->time + s->tc_period) {
+		s->tc_time = port->time + s->tc_period;
+	}
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+		if (s->tc_credits[i] > s->tc_credits_per_period[i]) {
+			s->tc_credits[i] = s->tc_credits_per_period[i];
+		}
+	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	{
+		/* TC oversubscription: the member pipes stay plugged in */
+		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
+
+		if (s->tc_ov_wm > s->tc_ov_wm_max) {
+			s->tc_ov_wm = s->tc_ov_wm_max;
+		}
+		if (s->tc_ov_wm < s->tc_ov_wm_min) {
+			s->tc_ov_wm = s->tc_ov_wm_min;
+		}
+		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+	}
+#endif
+
+	rte_sched_port_log_subport_config(port, subport_id);
+
+	return 0;
+}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+
+static void
+rte_sched_pipe_tc_ov_unplug(struct rte_sched_subport *s,
+	uint32_t subport_id,
+	struct rte_sched_pipe_profile *params)
+{
+	double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
+	double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
+	uint32_t tc3_ov = s->tc_ov;
+
+	s->tc_ov_n -= params->tc_ov_weight;
+	s->tc_ov_rate -= pipe_tc3_rate;
+	s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+
+	if (s->tc_ov != tc3_ov) {
+		RTE_LOG(DEBUG, SCHED,
+			"Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
+			subport_id, subport_tc3_rate, s->tc_ov_rate);
+	}
+}
+
+static void
+rte_sched_pipe_tc_ov_plug(struct rte_sched_subport *s,
+	uint32_t subport_id,
+	struct rte_sched_pipe_profile *params)
+{
+	double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
+	double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
+	uint32_t tc3_ov = s->tc_ov;
+
+	s->tc_ov_n += params->tc_ov_weight;
+	s->tc_ov_rate += pipe_tc3_rate;
+	s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+
+	if (s->tc_ov != tc3_ov) {
+		RTE_LOG(DEBUG, SCHED,
+			"Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
+			subport_id, subport_tc3_rate, s->tc_ov_rate);
+	}
+}
+
+#endif /* RTE_SCHED_SUBPORT_TC_OV */
+
 int
 rte_sched_pipe_config(struct rte_sched_port *port,
 	uint32_t subport_id,
@@ -859,24 +1082,12 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	p = port->pipe + (subport_id * port->n_pipes_per_subport + pipe_id);
 
 	/* Handle the case when pipe already has a valid configuration */
-	if (p->tb_time) {
+	if (p->configured) {
 		params = port->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
-
 		/* Unplug pipe from its subport */
-		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
-
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
-		}
+		rte_sched_pipe_tc_ov_unplug(s, subport_id, params);
 #endif
 
 		/* Reset the pipe */
@@ -902,29 +1113,126 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
+	/* Subport TC3 oversubscription */
+	rte_sched_pipe_tc_ov_plug(s, subport_id, params);
+	p->tc_ov_period_id = s->tc_ov_period_id;
+	p->tc_ov_credits = s->tc_ov_wm;
+#endif
 
-		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+	p->configured = 1;
+
+	return 0;
+}
+
+int
+rte_sched_pipe_update(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_id,
+	int32_t pipe_profile)
+{
+	struct rte_sched_subport *s;
+	struct rte_sched_pipe *p;
+	struct rte_sched_pipe_profile *params;
+	uint32_t profile, i;
 
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+	/* Check user parameters */
+	profile = (uint32_t) pipe_profile;
+	if ((port == NULL) ||
+	    (subport_id >= port->n_subports_per_port) ||
+		(pipe_id >= port->n_pipes_per_subport) ||
+		(pipe_profile < 0) ||
+		(profile >= port->n_pipe_profiles)) {
+		return -1;
+	}
+
+	/* Check that subport configuration is valid */
+	s = port->subport + subport_id;
+	if (s->tb_period == 0) {
+		return -2;
+	}
+
+	/* A pipe without a valid configuration has no state to preserve */
+	p = port->pipe + (subport_id * port->n_pipes_per_subport + pipe_id);
+	if (!p->configured) {
+		return rte_sched_pipe_config(port, subport_id, pipe_id, pipe_profile);
+	}
+
+	if (p->profile == profile) {
+		return 0;
+	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	rte_sched_pipe_tc_ov_unplug(s, subport_id, port->pipe_profiles + p->profile);
+#endif
+
+	/* Switch the profile in place. The queues, the WRR state and the
+	 * accumulated credits are kept; a grinder currently serving this pipe
+	 * keeps using the old profile until it moves on to another pipe. */
+	p->profile = profile;
+	params = port->pipe_profiles + p->profile;
+
+	/* Token Bucket (TB) */
+	if (p->tb_credits > params->tb_size) {
+		p->tb_credits = params->tb_size;
+	}
+
+	/* Traffic Classes (TCs) */
+	if (p->tc_time > port->time + params->tc_period) {
+		p->tc_time = port->time + params->tc_period;
+	}
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+		if (p->tc_credits[i] > params->tc_credits_per_period[i]) {
+			p->tc_credits[i] = params->tc_credits_per_period[i];
 		}
-		p->tc_ov_period_id = s->tc_ov_period_id;
-		p->tc_ov_credits = s->tc_ov_wm;
 	}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	rte_sched_pipe_tc_ov_plug(s, subport_id, params);
 #endif
 
 	return 0;
 }
 
+int
+rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *params,
+	uint32_t *pipe_profile_id)
+{
+	struct rte_sched_pipe_profile *pp;
+	int status;
+
+	/* Check user parameters */
+	if ((port == NULL) ||
+	    (params == NULL) ||
+	    (pipe_profile_id == NULL)) {
+		return -1;
+	}
+
+	/* Pipe profile table must not be full */
+	if (port->n_pipe_profiles >= RTE_SCHED_PIPE_PROFILES_PER_PORT) {
+		return -2;
+	}
+
+	status = rte_sched_pipe_profile_check(params, port->rate);
+	if (status != 0) {
+		return status;
+	}
+
+	pp = port->pipe_profiles + port->n_pipe_profiles;
+	rte_sched_pipe_profile_convert(params, pp, port->rate);
+
+	*pipe_profile_id = port->n_pipe_profiles;
+	port->n_pipe_profiles++;
+
+	if (port->pipe_tc3_rate_max < params->tc_rate[3]) {
+		port->pipe_tc3_rate_max = params->tc_rate[3];
+	}
+
+	rte_sched_port_log_pipe_profile(port, *pipe_profile_id);
+
+	return 0;
+}
+
 void
 rte_sched_port_pkt_write(struct rte_mbuf *pkt,
 			 uint32_t subport, uint32_t pipe, uint32_t traffic_class,
@@ -1095,24 +1403,44 @@ rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port, uint32_
 	s->stats.n_bytes_tc_dropped[tc_index] += pkt_len;
 }
 
+static inline uint32_t
+rte_sched_port_qlen_hist_bin(uint16_t qlen)
+{
+	uint32_t bin;
+
+	if (qlen == 0) {
+		return 0;
+	}
+
+	bin = 32 - __builtin_clz(qlen);
+
+	return (bin < RTE_SCHED_QUEUE_HIST_BINS) ? bin : (RTE_SCHED_QUEUE_HIST_BINS - 1);
+}
+
 static inline void
-rte_sched_port_update_queue_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
+rte_sched_port_update_queue_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt, uint16_t qlen)
 {
 	struct rte_sched_queue_extra *qe = port->queue_extra + qindex;
 	uint32_t pkt_len = pkt->pkt_len;
 
 	qe->stats.n_pkts += 1;
 	qe->stats.n_bytes += pkt_len;
+	qe->stats.n_pkts_qlen_hist[rte_sched_port_qlen_hist_bin(qlen)] += 1;
 }
 
 static inline void
-rte_sched_port_update_queue_stats_on_drop(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
+rte_sched_port_update_queue_stats_on_drop(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt,
+	uint16_t qlen, int aqm_drop)
 {
 	struct rte_sched_queue_extra *qe = port->queue_extra + qindex;
 	uint32_t pkt_len = pkt->pkt_len;
+	uint32_t bin = rte_sched_port_qlen_hist_bin(qlen);
 
 	qe->stats.n_pkts_dropped += 1;
 	qe->stats.n_bytes_dropped += pkt_len;
+	qe->stats.n_pkts_aqm_dropped += (aqm_drop != 0);
+	qe->stats.n_pkts_qlen_hist[bin] += 1;
+	qe->stats.n_pkts_dropped_qlen_hist[bin] += 1;
 }
 
 #endif /* RTE_SCHED_COLLECT_STATS */
@@ -1161,6 +1489,55 @@ rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port, uint32_t q
 
 #endif /* RTE_SCHED_RED */
 
+#ifdef RTE_SCHED_PIE
+
+static inline int
+rte_sched_port_pie_enabled(struct rte_sched_port *port, uint32_t qindex)
+{
+	uint32_t tc_index = (qindex >> 2) & 0x3;
+
+	return (port->pie_config[tc_index].tailq_th != 0);
+}
+
+static inline int
+rte_sched_port_aqm_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint32_t qindex, uint16_t qlen)
+{
+	struct rte_sched_queue_extra *qe;
+	uint32_t tc_index;
+
+	RTE_SET_USED(pkt);
+
+	if (!rte_sched_port_pie_enabled(port, qindex))
+		return rte_sched_port_red_drop(port, pkt, qindex, qlen);
+
+	tc_index = (qindex >> 2) & 0x3;
+	qe = port->queue_extra + qindex;
+
+	return rte_pie_enqueue(&port->pie_config[tc_index], &qe->pie, qlen, port->time);
+}
+
+static inline void
+rte_sched_port_pie_dequeue(struct rte_sched_port *port, uint32_t qindex, uint16_t qlen)
+{
+	struct rte_sched_queue_extra *qe;
+
+	if (!rte_sched_port_pie_enabled(port, qindex))
+		return;
+
+	qe = port->queue_extra + qindex;
+
+	rte_pie_dequeue(&qe->pie, qlen, port->time);
+}
+
+#else
+
+#define rte_sched_port_aqm_drop(port, pkt, qindex, qlen)             \
+	rte_sched_port_red_drop(port, pkt, qindex, qlen)
+
+#define rte_sched_port_pie_dequeue(port, qindex, qlen)
+
+#endif /* RTE_SCHED_PIE */
+
 #if RTE_SCHED_DEBUG
 
 static inline int
@@ -1257,18 +1634,20 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex, struct
 	struct rte_sched_queue *q;
 	uint16_t qsize;
 	uint16_t qlen;
+	int aqm_drop;
 
 	q = port->queue + qindex;
 	qsize = rte_sched_port_qsize(port, qindex);
 	qlen = q->qw - q->qr;
 
-	/* Drop the packet (and update drop stats) when queue is full */
-	if (unlikely(rte_sched_port_red_drop(port, pkt, qindex, qlen) || (qlen >= qsize))) {
-		rte_pktmbuf_free(pkt);
+	/* Drop the packet (and update drop stats) when queue is full or congested */
+	aqm_drop = rte_sched_port_aqm_drop(port, pkt, qindex, qlen);
+	if (unlikely(aqm_drop || (qlen >= qsize))) {
 #ifdef RTE_SCHED_COLLECT_STATS
 		rte_sched_port_update_subport_stats_on_drop(port, qindex, pkt);
-		rte_sched_port_update_queue_stats_on_drop(port, qindex, pkt);
+		rte_sched_port_update_queue_stats_on_drop(port, qindex, pkt, qlen, aqm_drop);
 #endif
+		rte_pktmbuf_free(pkt);
 		return 0;
 	}
 
@@ -1282,7 +1661,7 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex, struct
 	/* Statistics */
 #ifdef RTE_SCHED_COLLECT_STATS
 	rte_sched_port_update_subport_stats(port, qindex, pkt);
-	rte_sched_port_update_queue_stats(port, qindex, pkt);
+	rte_sched_port_update_queue_stats(port, qindex, pkt, qlen);
 #endif
 
 	return 1;
@@ -1717,6 +2096,10 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 	/* Advance port time */
 	port->time += pkt_len;
 
+	/* Departure rate estimation */
+	rte_sched_port_pie_dequeue(port, grinder->qindex[grinder->qpos],
+		(uint16_t) (queue->qw - queue->qr));
+
 	/* Send packet */
 	port->pkts_out[port->n_pkts_out ++] = pkt;
 	queue->qr ++;
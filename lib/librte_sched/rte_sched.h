@@ -85,6 +85,11 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
+/** Proportional Integral controller Enhanced (PIE) */
+#ifdef RTE_SCHED_PIE
+#include "rte_pie.h"
+#endif
+
 /** Number of traffic classes per pipe (as well as subport). Cannot be changed. */
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
 
@@ -163,6 +168,11 @@ struct rte_sched_pipe_params {
 	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights for the queues of the current pipe */
 };
 
+/** Number of bins of the queue occupancy histograms. Bin 0 counts the packets that found
+the queue empty, bin i (i > 0) the packets that found between 2^(i-1) and 2^i - 1 packets in the
+queue, with the last bin also counting all longer queues. */
+#define RTE_SCHED_QUEUE_HIST_BINS             16
+
 /** Queue statistics */
 struct rte_sched_queue_stats {
 	/* Packets */
@@ -172,6 +182,18 @@ struct rte_sched_queue_stats {
 	/* Bytes */
 	uint32_t n_bytes;                /**< Number of bytes successfully written to current queue */
 	uint32_t n_bytes_dropped;        /**< Number of bytes dropped due to current queue being full or congested */
+
+#ifdef RTE_SCHED_COLLECT_STATS
+	/* Congestion management */
+	uint32_t n_pkts_aqm_dropped;     /**< Number of packets dropped by the active queue management
+	                                      algorithm (RED or PIE) of the current queue, included in n_pkts_dropped */
+
+	/* Occupancy histograms */
+	uint32_t n_pkts_qlen_hist[RTE_SCHED_QUEUE_HIST_BINS]; /**< Queue length found by each packet
+	                                      written to or dropped by the current queue */
+	uint32_t n_pkts_dropped_qlen_hist[RTE_SCHED_QUEUE_HIST_BINS]; /**< Queue length found by each
+	                                      packet dropped by the current queue */
+#endif
 };
 
 /** Port configuration parameters. */
@@ -193,6 +215,10 @@ struct rte_sched_port_params {
 #ifdef RTE_SCHED_RED
 	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie_params pie_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< PIE parameters. PIE is used
+	                                      instead of RED by the traffic classes with non-zero qdelay_ref. */
+#endif
 };
 
 /*
@@ -271,6 +297,81 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	uint32_t pipe_id,
 	int32_t pipe_profile);
 
+/**
+ * Hierarchical scheduler subport run-time update
+ *
+ * Changes the rates of a subport that is already configured without
+ * resetting its state: the accumulated token bucket and traffic class
+ * credits are preserved (trimmed to the new limits) and the packets
+ * currently queued by the subport pipes are not affected. The new rates
+ * take effect from the next credit update performed by the scheduler
+ * dequeue operation. Must not run concurrently with enqueue or dequeue
+ * on the same port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param params
+ *   Subport configuration parameters
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_subport_update(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_subport_params *params);
+
+/**
+ * Hierarchical scheduler pipe run-time update
+ *
+ * Moves a pipe to a different pipe profile without resetting its state:
+ * the accumulated token bucket and traffic class credits are preserved
+ * (trimmed to the limits of the new profile), as are the WRR state and the
+ * packets currently queued by the pipe. When the pipe is not configured yet,
+ * this is equivalent to rte_sched_pipe_config(). A grinder that is currently
+ * serving the pipe completes its pass using the old profile. Must not run
+ * concurrently with enqueue or dequeue on the same port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param pipe_id
+ *   Pipe ID within subport
+ * @param pipe_profile
+ *   ID of port-level pre-configured pipe profile
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_pipe_update(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_id,
+	int32_t pipe_profile);
+
+/**
+ * Hierarchical scheduler pipe profile add
+ *
+ * Appends a new profile to the port pipe profile table, so that it can be
+ * used by rte_sched_pipe_config() and rte_sched_pipe_update(). Subports pick
+ * up a higher traffic class 3 rate for their oversubscription watermark on
+ * their next configuration or update.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param params
+ *   Pipe profile parameters
+ * @param pipe_profile_id
+ *   Pointer to pre-allocated variable where the ID of the new profile is stored
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *params,
+	uint32_t *pipe_profile_id);
+
 /**
  * Hierarchical scheduler memory footprint size per port
  *
@@ -0,0 +1,256 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_STACK_H_
+#define _RTE_STACK_H_
+
+/**
+ * @file
+ * RTE Stack
+ *
+ * A stack of object pointers with LIFO semantics: the object popped is
+ * the last one pushed, which is usually still hot in the cache. This is
+ * the usual order for free-lists, where rte_ring gives FIFO order.
+ *
+ * Two variants are provided:
+ *
+ * - The default variant stores the pointers in an array protected by a
+ *   spinlock. It is the fastest one without contention.
+ * - The lock-free variant (RTE_STACK_F_LF) is a linked list of
+ *   preallocated elements whose head is updated with a 128-bit compare
+ *   and set, tagged with a modification counter against ABA. A thread
+ *   preempted in the middle of an operation does not block the others.
+ *   It is only available on x86_64.
+ *
+ * Push and pop operations are bulk: all the objects are pushed (or
+ * popped), or none. All the operations are multi-thread safe.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_memzone.h>
+#include <rte_prefetch.h>
+#include <rte_spinlock.h>
+
+#define RTE_TAILQ_STACK_NAME "RTE_STACK"
+#define RTE_STACK_MZ_PREFIX "STK_"
+/** The maximum length of a stack name. */
+#define RTE_STACK_NAMESIZE (RTE_MEMZONE_NAMESIZE - \
+			   sizeof(RTE_STACK_MZ_PREFIX) + 1)
+
+#define RTE_STACK_F_LF 0x0001 /**< Use the lock-free variant. */
+
+/** @internal An element of the lock-free stack. */
+struct rte_stack_lf_elem {
+	void *data;                      /**< Stored object pointer. */
+	struct rte_stack_lf_elem *next;  /**< Next element in the list. */
+};
+
+/** @internal Head of a lock-free list, updated with a 128-bit CAS. */
+struct rte_stack_lf_head {
+	struct rte_stack_lf_elem *top;   /**< First element of the list. */
+	uint64_t cnt;                    /**< Modification counter (ABA). */
+} __attribute__((aligned(16)));
+
+/** @internal A lock-free list. */
+struct rte_stack_lf_list {
+	struct rte_stack_lf_head head;   /**< List head. */
+	rte_atomic64_t len;              /**< Number of elements. */
+};
+
+/** @internal The lock-free stack: a list of used and a list of free
+ *  elements, both taken from the element array. */
+struct rte_stack_lf {
+	struct rte_stack_lf_list used __rte_cache_aligned;
+	struct rte_stack_lf_list free __rte_cache_aligned;
+	struct rte_stack_lf_elem elems[0] __rte_cache_aligned;
+};
+
+/** @internal The spinlock-protected stack. */
+struct rte_stack_std {
+	rte_spinlock_t lock;             /**< Protects len and objs. */
+	uint32_t len;                    /**< Number of objects. */
+	void *objs[0];                   /**< Object pointers. */
+};
+
+/**
+ * The RTE stack structure.
+ */
+struct rte_stack {
+	char name[RTE_STACK_NAMESIZE] __rte_cache_aligned; /**< Name. */
+	const struct rte_memzone *memzone; /**< Memzone of the stack. */
+	uint32_t capacity;                 /**< Maximum number of objects. */
+	uint32_t flags;                    /**< Flags given at creation. */
+	union {
+		struct rte_stack_lf stack_lf;   /**< Lock-free variant. */
+		struct rte_stack_std stack_std; /**< Spinlock variant. */
+	};
+} __rte_cache_aligned;
+
+#include "rte_stack_std.h"
+#include "rte_stack_lf.h"
+
+/**
+ * Push several objects on the stack.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of n object pointers; obj_table[n - 1] ends up
+ *   on top of the stack.
+ * @param n
+ *   The number of objects to push.
+ * @return
+ *   n if all the objects were pushed, 0 if there was not enough room.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_stack_push(struct rte_stack *s, void * const *obj_table, unsigned n)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_push(s, obj_table, n);
+	else
+		return __rte_stack_std_push(s, obj_table, n);
+}
+
+/**
+ * Pop several objects from the stack.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of at least n object pointers, filled from the
+ *   top of the stack: obj_table[0] is the last object pushed.
+ * @param n
+ *   The number of objects to pop.
+ * @return
+ *   n if all the objects were popped, 0 if there were not enough
+ *   objects in the stack.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_stack_pop(struct rte_stack *s, void **obj_table, unsigned n)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_pop(s, obj_table, n);
+	else
+		return __rte_stack_std_pop(s, obj_table, n);
+}
+
+/**
+ * Return the number of objects in the stack.
+ *
+ * With concurrent accesses, the value may be outdated when returned.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @return
+ *   The number of objects in the stack.
+ */
+static inline unsigned
+rte_stack_count(struct rte_stack *s)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_count(s);
+	else
+		return __rte_stack_std_count(s);
+}
+
+/**
+ * Return the number of free entries in the stack.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @return
+ *   The number of objects that can still be pushed.
+ */
+static inline unsigned
+rte_stack_free_count(struct rte_stack *s)
+{
+	return s->capacity - rte_stack_count(s);
+}
+
+/**
+ * Create a new stack in memory.
+ *
+ * @param name
+ *   The name of the stack.
+ * @param count
+ *   The maximum number of objects in the stack.
+ * @param socket_id
+ *   The socket identifier where the memory should be allocated, or
+ *   SOCKET_ID_ANY.
+ * @param flags
+ *   RTE_STACK_F_LF for the lock-free variant, 0 for the spinlock one.
+ * @return
+ *   On success, the pointer to the new stack. NULL on error, with
+ *   rte_errno set appropriately. Possible errno values include:
+ *    - EINVAL - invalid count or flags
+ *    - ENOTSUP - the lock-free variant is not supported on this platform
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_stack *
+rte_stack_create(const char *name, unsigned count, int socket_id,
+		uint32_t flags);
+
+/**
+ * Free all the memory used by a stack.
+ *
+ * @param s
+ *   Stack to free; NULL is ignored.
+ */
+void rte_stack_free(struct rte_stack *s);
+
+/**
+ * Search a stack from its name.
+ *
+ * @param name
+ *   The name of the stack.
+ * @return
+ *   The pointer to the stack matching the name, or NULL if not found,
+ *   with rte_errno set appropriately. Possible errno values include:
+ *    - ENOENT - required entry not available to return.
+ */
+struct rte_stack *rte_stack_lookup(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_STACK_H_ */
@@ -0,0 +1,221 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_STACK_LF_H_
+#define _RTE_STACK_LF_H_
+
+/**
+ * @file
+ * RTE Stack, lock-free variant (internal, included by rte_stack.h)
+ *
+ * The objects are stored in a list of used elements; the unused
+ * elements are kept in a second list. Pushing n objects pops n elements
+ * from the free list, fills them and pushes them as a chain on the used
+ * list; popping does the reverse. The length of each list is reserved
+ * with an atomic operation before the list is walked, so that a pop
+ * never runs past the end of the list. The list heads carry a
+ * modification counter that is incremented by every update, so that a
+ * head read before a pop and a push of the same element is rejected by
+ * the 128-bit compare and set.
+ */
+
+#ifdef RTE_ARCH_X86_64
+
+/**
+ * @internal Reserve num elements of a list and pop them. The popped
+ * elements stay linked: the first one is returned and the last one is
+ * stored in *last. If obj_table is not NULL, the object pointers of the
+ * elements are stored there, top first.
+ */
+static inline struct rte_stack_lf_elem *
+__rte_stack_lf_pop_elems(struct rte_stack_lf_list *list, unsigned num,
+		void **obj_table, struct rte_stack_lf_elem **last)
+{
+	struct rte_stack_lf_head old_head, new_head;
+	struct rte_stack_lf_elem *tmp;
+	int64_t len;
+	unsigned i;
+
+	/* reserve num elements, if available */
+	do {
+		len = rte_atomic64_read(&list->len);
+		if (unlikely(len < (int64_t)num))
+			return NULL;
+	} while (rte_atomic64_cmpset((volatile uint64_t *)&list->len.cnt,
+			len, len - num) == 0);
+
+	old_head = list->head;
+
+	do {
+		/* Walk num elements from the top to find the new head. If an
+		 * element is popped concurrently, a NULL next pointer may be
+		 * found, or the compare and set below fails. */
+		tmp = old_head.top;
+		for (i = 0; i < num && tmp != NULL; i++) {
+			rte_prefetch0(tmp->next);
+			if (obj_table != NULL)
+				obj_table[i] = tmp->data;
+			*last = tmp;
+			tmp = tmp->next;
+		}
+
+		if (unlikely(i != num)) {
+			old_head = list->head;
+			continue;
+		}
+
+		new_head.top = tmp;
+		new_head.cnt = old_head.cnt + 1;
+		if (rte_atomic128_cmpset((volatile rte_int128_t *)&list->head,
+				(rte_int128_t *)&old_head,
+				(rte_int128_t *)&new_head))
+			break;
+	} while (1);
+
+	return old_head.top;
+}
+
+/**
+ * @internal Push a chain of num linked elements, from first to last, on
+ * a list.
+ */
+static inline void
+__rte_stack_lf_push_elems(struct rte_stack_lf_list *list,
+		struct rte_stack_lf_elem *first, struct rte_stack_lf_elem *last,
+		unsigned num)
+{
+	struct rte_stack_lf_head old_head, new_head;
+
+	old_head = list->head;
+
+	do {
+		new_head.top = first;
+		new_head.cnt = old_head.cnt + 1;
+		last->next = old_head.top;
+	} while (rte_atomic128_cmpset((volatile rte_int128_t *)&list->head,
+			(rte_int128_t *)&old_head,
+			(rte_int128_t *)&new_head) == 0);
+
+	rte_atomic64_add(&list->len, num);
+}
+
+/**
+ * @internal Push several objects on a lock-free stack.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_stack_lf_push(struct rte_stack *s, void * const *obj_table,
+		unsigned n)
+{
+	struct rte_stack_lf_elem *tmp, *first, *last = NULL;
+	unsigned i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* pop n free elements */
+	first = __rte_stack_lf_pop_elems(&s->stack_lf.free, n, NULL, &last);
+	if (unlikely(first == NULL))
+		return 0;
+
+	/* construct the linked list, obj_table[n - 1] on top */
+	for (tmp = first, i = 0; i < n; i++, tmp = tmp->next)
+		tmp->data = obj_table[n - i - 1];
+
+	/* push them on the used list */
+	__rte_stack_lf_push_elems(&s->stack_lf.used, first, last, n);
+
+	return n;
+}
+
+/**
+ * @internal Pop several objects from a lock-free stack.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_stack_lf_pop(struct rte_stack *s, void **obj_table, unsigned n)
+{
+	struct rte_stack_lf_elem *first, *last = NULL;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* pop n used elements */
+	first = __rte_stack_lf_pop_elems(&s->stack_lf.used, n, obj_table,
+		&last);
+	if (unlikely(first == NULL))
+		return 0;
+
+	/* push them on the free list */
+	__rte_stack_lf_push_elems(&s->stack_lf.free, first, last, n);
+
+	return n;
+}
+
+/**
+ * @internal Number of objects in a lock-free stack.
+ */
+static inline unsigned
+__rte_stack_lf_count(struct rte_stack *s)
+{
+	/* elements are only counted once pushed, but a popped element is
+	 * reserved first: the value is a lower bound under concurrency */
+	return (unsigned)rte_atomic64_read(&s->stack_lf.used.len);
+}
+
+#else /* RTE_ARCH_X86_64 */
+
+/* the lock-free variant needs a 128-bit compare and set; creating such a
+ * stack fails on other platforms, so these are never called */
+
+static inline unsigned
+__rte_stack_lf_push(__rte_unused struct rte_stack *s,
+		__rte_unused void * const *obj_table, __rte_unused unsigned n)
+{
+	return 0;
+}
+
+static inline unsigned
+__rte_stack_lf_pop(__rte_unused struct rte_stack *s,
+		__rte_unused void **obj_table, __rte_unused unsigned n)
+{
+	return 0;
+}
+
+static inline unsigned
+__rte_stack_lf_count(__rte_unused struct rte_stack *s)
+{
+	return 0;
+}
+
+#endif /* RTE_ARCH_X86_64 */
+
+#endif /* _RTE_STACK_LF_H_ */
@@ -153,6 +153,73 @@ typedef int (*rte_table_op_entry_delete)(
 	int *key_found,
 	void *entry);
 
+/**
+ * Lookup table bulk entry add
+ *
+ * Equivalent to invoking the entry add operation for each of the n_keys keys,
+ * but allows the table to amortize its per-update cost (e.g. hash computation,
+ * bucket prefetch or classifier rebuild) across the whole set of keys.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @param keys
+ *   Array of n_keys lookup keys
+ * @param entries
+ *   Array of n_keys data buffers; entries[i] is associated with keys[i], with
+ *   the same semantics as the entry parameter of the entry add operation
+ * @param n_keys
+ *   Number of keys to add
+ * @param key_found
+ *   Array of n_keys elements. After successful invocation, key_found[i] is set
+ *   as described for the entry add operation for keys[i].
+ * @param entries_ptr
+ *   Array of n_keys elements. After successful invocation, entries_ptr[i]
+ *   stores the handle to the table entry associated with keys[i], as described
+ *   for the entry add operation.
+ * @return
+ *   0 on success, error code otherwise. On error, the table is left in an
+ *   implementation specific state: either none of the keys is added, or the
+ *   keys preceding the failing one are added.
+ */
+typedef int (*rte_table_op_entry_add_bulk)(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr);
+
+/**
+ * Lookup table bulk entry delete
+ *
+ * Equivalent to invoking the entry delete operation for each of the n_keys
+ * keys.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @param keys
+ *   Array of n_keys lookup keys
+ * @param n_keys
+ *   Number of keys to delete
+ * @param key_found
+ *   Array of n_keys elements. After successful invocation, key_found[i] is set
+ *   as described for the entry delete operation for keys[i].
+ * @param entries
+ *   When not NULL, array of n_keys buffers; entries[i] (when not NULL) receives
+ *   a copy of the table entry associated with keys[i] before its deletion, as
+ *   described for the entry delete operation.
+ * @return
+ *   0 on success, error code otherwise. On error, the table is left in an
+ *   implementation specific state: either none of the keys is deleted, or the
+ *   keys preceding the failing one are deleted.
+ */
+typedef int (*rte_table_op_entry_delete_bulk)(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries);
+
 /**
  * Lookup table lookup
  *
@@ -219,6 +286,8 @@ struct rte_table_ops {
 	rte_table_op_entry_delete f_delete; /**< Entry delete */
 	rte_table_op_lookup f_lookup;       /**< Lookup */
 	rte_table_op_stats_read f_stats;	/**< Stats */
+	rte_table_op_entry_add_bulk f_add_bulk;       /**< Entry add bulk */
+	rte_table_op_entry_delete_bulk f_delete_bulk; /**< Entry delete bulk */
 };
 
 #ifdef __cplusplus
@@ -443,6 +443,281 @@ rte_table_acl_entry_delete(
 	return 0;
 }
 
+static int
+rte_table_acl_entry_add_bulk(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	struct rte_table_acl *acl = (struct rte_table_acl *) table;
+	struct rte_acl_ctx *ctx;
+	uint32_t free_pos, n_rules_added, i;
+	int status;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (keys == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: keys parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (entries == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entries parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+	if (entries_ptr == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entries_ptr parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		struct rte_table_acl_rule_add_params *rule =
+			(struct rte_table_acl_rule_add_params *) keys[i];
+
+		if (rule == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: key %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+		if (entries[i] == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: entry %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+		if (rule->priority > RTE_ACL_MAX_PRIORITY) {
+			RTE_LOG(ERR, TABLE, "%s: Priority is too high\n",
+				__func__);
+			return -EINVAL;
+		}
+	}
+
+	/* Add all the new rules to the rule set */
+	free_pos = 1;
+	n_rules_added = 0;
+	for (i = 0; i < n_keys; i++) {
+		struct rte_table_acl_rule_add_params *rule =
+			(struct rte_table_acl_rule_add_params *) keys[i];
+		struct rte_pipeline_acl_rule acl_rule;
+		struct rte_acl_rule *rule_location;
+		uint32_t j;
+
+		/* Look to see if the rule exists already in the table */
+		key_found[i] = 0;
+		for (j = 1; j < acl->n_rules; j++) {
+			if (acl->acl_rule_list[j] == NULL)
+				continue;
+
+			if (memcmp(&acl->acl_rule_list[j]->field[0],
+				&rule->field_value[0],
+				acl->cfg.num_fields *
+				sizeof(struct rte_acl_field)) == 0)
+				break;
+		}
+
+		if (j < acl->n_rules) {
+			uint32_t k;
+
+			entries_ptr[i] = &acl->memory[j * acl->entry_size];
+
+			/*
+			 * A key repeated within the batch matches the rule
+			 * added for its first occurrence, which was not in
+			 * the table before this operation.
+			 */
+			key_found[i] = 1;
+			for (k = 0; k < i; k++)
+				if ((key_found[k] == 0) &&
+					(entries_ptr[k] == entries_ptr[i])) {
+					key_found[i] = 0;
+					break;
+				}
+			continue;
+		}
+
+		/* Free positions are consumed in increasing order */
+		while ((free_pos < acl->n_rules) &&
+			(acl->acl_rule_list[free_pos] != NULL))
+			free_pos++;
+
+		if (free_pos == acl->n_rules) {
+			RTE_LOG(ERR, TABLE, "%s: Max number of rules reached\n",
+				__func__);
+			status = -ENOSPC;
+			goto rollback;
+		}
+
+		memset(&acl_rule, 0, sizeof(acl_rule));
+		acl_rule.data.category_mask = 1;
+		acl_rule.data.priority = RTE_ACL_MAX_PRIORITY - rule->priority;
+		acl_rule.data.userdata = free_pos;
+		memcpy(&acl_rule.field[0],
+			&rule->field_value[0],
+			acl->cfg.num_fields * sizeof(struct rte_acl_field));
+
+		rule_location = (struct rte_acl_rule *)
+			&acl->acl_rule_memory[free_pos *
+			acl->acl_params.rule_size];
+		memcpy(rule_location, &acl_rule, acl->acl_params.rule_size);
+		acl->acl_rule_list[free_pos] = rule_location;
+		entries_ptr[i] = &acl->memory[free_pos * acl->entry_size];
+		n_rules_added++;
+	}
+
+	/* Build low level ACL table once for the whole set of rules */
+	if (n_rules_added) {
+		acl->name_id ^= 1;
+		acl->acl_params.name = acl->name[acl->name_id];
+		status = rte_table_acl_build(acl, &ctx);
+		if (status != 0) {
+			acl->name_id ^= 1;
+			status = -EINVAL;
+			goto rollback;
+		}
+
+		/* Commit changes */
+		if (acl->ctx != NULL)
+			rte_acl_free(acl->ctx);
+		acl->ctx = ctx;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		memcpy(entries_ptr[i], entries[i], acl->entry_size);
+
+	return 0;
+
+rollback:
+	/* Remove the rules added by this operation (keys [0 .. i - 1]) */
+	while (i-- > 0)
+		if (key_found[i] == 0) {
+			uint32_t pos = ((uint8_t *) entries_ptr[i] -
+				acl->memory) / acl->entry_size;
+
+			acl->acl_rule_list[pos] = NULL;
+		}
+
+	return status;
+}
+
+static int
+rte_table_acl_entry_delete_bulk(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	struct rte_table_acl *acl = (struct rte_table_acl *) table;
+	struct rte_acl_ctx *ctx;
+	uint32_t n_rules_deleted, i;
+	int status;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (keys == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: keys parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if (keys[i] == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: key %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	/*
+	 * Remove all the rules from the rule set. Until the operation is
+	 * committed, key_found[i] stores the position of the rule deleted for
+	 * keys[i] (positions start from 1) or 0 when the rule was not found.
+	 */
+	n_rules_deleted = 0;
+	for (i = 0; i < n_keys; i++) {
+		struct rte_table_acl_rule_delete_params *rule =
+			(struct rte_table_acl_rule_delete_params *) keys[i];
+		uint32_t j;
+
+		key_found[i] = 0;
+		for (j = 1; j < acl->n_rules; j++) {
+			if (acl->acl_rule_list[j] == NULL)
+				continue;
+
+			if (memcmp(&acl->acl_rule_list[j]->field[0],
+				&rule->field_value[0],
+				acl->cfg.num_fields *
+				sizeof(struct rte_acl_field)) == 0) {
+				acl->acl_rule_list[j] = NULL;
+				key_found[i] = j;
+				n_rules_deleted++;
+				break;
+			}
+		}
+	}
+
+	if (n_rules_deleted == 0)
+		return 0;
+
+	/* Build low level ACL table once for the whole set of rules */
+	acl->name_id ^= 1;
+	acl->acl_params.name = acl->name[acl->name_id];
+	status = rte_table_acl_build(acl, &ctx);
+	if (status != 0) {
+		/* Roll back changes */
+		for (i = 0; i < n_keys; i++) {
+			uint32_t pos = key_found[i];
+
+			if (pos == 0)
+				continue;
+
+			acl->acl_rule_list[pos] = (struct rte_acl_rule *)
+				&acl->acl_rule_memory[pos *
+				acl->acl_params.rule_size];
+			key_found[i] = 1;
+		}
+		acl->name_id ^= 1;
+
+		return -EINVAL;
+	}
+
+	/* Commit changes */
+	if (acl->ctx != NULL)
+		rte_acl_free(acl->ctx);
+
+	acl->ctx = ctx;
+	for (i = 0; i < n_keys; i++) {
+		uint32_t pos = key_found[i];
+
+		if (pos == 0)
+			continue;
+
+		if ((entries != NULL) && (entries[i] != NULL))
+			memcpy(entries[i], &acl->memory[pos * acl->entry_size],
+				acl->entry_size);
+		key_found[i] = 1;
+	}
+
+	return 0;
+}
+
 static int
 rte_table_acl_lookup(
 	void *table,
@@ -523,4 +798,6 @@ struct rte_table_ops rte_table_acl_ops = {
 	.f_delete = rte_table_acl_entry_delete,
 	.f_lookup = rte_table_acl_lookup,
 	.f_stats = rte_table_acl_stats_read,
+	.f_add_bulk = rte_table_acl_entry_add_bulk,
+	.f_delete_bulk = rte_table_acl_entry_delete_bulk,
 };
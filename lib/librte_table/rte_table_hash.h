@@ -90,9 +90,15 @@ extern "C" {
  *     a. Configurable key size
  *     b. Single key size (8-byte, 16-byte or 32-byte key size)
  *
+ * The cuckoo hash table is built on top of the librte_hash cuckoo hash. It
+ * supports any key size up to RTE_HASH_KEY_LENGTH_MAX bytes, never evicts
+ * keys and always computes the key signature on lookup.
+ *
  ***/
 #include <stdint.h>
 
+#include <rte_hash.h>
+
 #include "rte_table.h"
 
 /** Hash function */
@@ -343,6 +349,36 @@ struct rte_table_hash_key32_ext_params {
 /** Extendible bucket hash table operations */
 extern struct rte_table_ops rte_table_hash_key32_ext_ops;
 
+/**
+ * Cuckoo hash table (configurable key size)
+ *
+ */
+/** Cuckoo hash table parameters */
+struct rte_table_hash_cuckoo_params {
+	/** Name of the underlying librte_hash table, has to be unique */
+	const char *name;
+
+	/** Key size (number of bytes), up to RTE_HASH_KEY_LENGTH_MAX */
+	uint32_t key_size;
+
+	/** Maximum number of keys in the table. Key add may fail with -ENOSPC
+	before the table is full when too many keys collide, so some headroom
+	is recommended. */
+	uint32_t n_keys;
+
+	/** Hash function, e.g. rte_hash_crc or rte_jhash */
+	rte_hash_function f_hash;
+
+	/** Seed for the hash function */
+	uint32_t seed;
+
+	/** Byte offset within packet meta-data where the key is located */
+	uint32_t key_offset;
+};
+
+/** Cuckoo hash table operations */
+extern struct rte_table_ops rte_table_hash_cuckoo_ops;
+
 #ifdef __cplusplus
 }
 #endif
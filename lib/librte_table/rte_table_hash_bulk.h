@@ -0,0 +1,129 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_RTE_TABLE_HASH_BULK_H__
+#define __INCLUDE_RTE_TABLE_HASH_BULK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * Bulk entry add/delete helpers shared by the hash tables (internal)
+ *
+ * The signatures of a window of keys are computed and their buckets are
+ * prefetched before any of these buckets is updated, so the bucket cache
+ * misses within the window overlap instead of being serialized.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#define RTE_TABLE_HASH_BULK_WINDOW					16
+
+/** Computes the signature of a key and prefetches its bucket */
+typedef uint64_t (*rte_table_hash_op_signature)(void *table, void *key);
+
+/** Adds a key whose signature is already known */
+typedef int (*rte_table_hash_op_entry_add_sig)(void *table, void *key,
+	uint64_t signature, void *entry, int *key_found, void **entry_ptr);
+
+/** Deletes a key whose signature is already known */
+typedef int (*rte_table_hash_op_entry_delete_sig)(void *table, void *key,
+	uint64_t signature, int *key_found, void *entry);
+
+static inline int
+rte_table_hash_entry_add_bulk(void *table, void **keys, void **entries,
+	uint32_t n_keys, int *key_found, void **entries_ptr,
+	rte_table_hash_op_signature f_signature,
+	rte_table_hash_op_entry_add_sig f_add)
+{
+	uint64_t signatures[RTE_TABLE_HASH_BULK_WINDOW];
+	uint32_t i, j;
+
+	for (i = 0; i < n_keys; i += RTE_TABLE_HASH_BULK_WINDOW) {
+		uint32_t n = RTE_MIN(n_keys - i,
+			(uint32_t) RTE_TABLE_HASH_BULK_WINDOW);
+
+		for (j = 0; j < n; j++)
+			signatures[j] = f_signature(table, keys[i + j]);
+
+		for (j = 0; j < n; j++) {
+			int status = f_add(table, keys[i + j], signatures[j],
+				entries[i + j], &key_found[i + j],
+				&entries_ptr[i + j]);
+
+			if (status != 0)
+				return status;
+		}
+	}
+
+	return 0;
+}
+
+static inline int
+rte_table_hash_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries,
+	rte_table_hash_op_signature f_signature,
+	rte_table_hash_op_entry_delete_sig f_delete)
+{
+	uint64_t signatures[RTE_TABLE_HASH_BULK_WINDOW];
+	uint32_t i, j;
+
+	for (i = 0; i < n_keys; i += RTE_TABLE_HASH_BULK_WINDOW) {
+		uint32_t n = RTE_MIN(n_keys - i,
+			(uint32_t) RTE_TABLE_HASH_BULK_WINDOW);
+
+		for (j = 0; j < n; j++)
+			signatures[j] = f_signature(table, keys[i + j]);
+
+		for (j = 0; j < n; j++) {
+			int status = f_delete(table, keys[i + j],
+				signatures[j], &key_found[i + j],
+				(entries != NULL) ? entries[i + j] : NULL);
+
+			if (status != 0)
+				return status;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
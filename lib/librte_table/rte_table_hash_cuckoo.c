@@ -0,0 +1,358 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+#include <rte_hash.h>
+
+#include "rte_table_hash.h"
+
+#ifdef RTE_TABLE_STATS_COLLECT
+
+#define RTE_TABLE_HASH_CUCKOO_STATS_PKTS_IN_ADD(table, val) \
+	table->stats.n_pkts_in += val
+#define RTE_TABLE_HASH_CUCKOO_STATS_PKTS_LOOKUP_MISS(table, val) \
+	table->stats.n_pkts_lookup_miss += val
+
+#else
+
+#define RTE_TABLE_HASH_CUCKOO_STATS_PKTS_IN_ADD(table, val)
+#define RTE_TABLE_HASH_CUCKOO_STATS_PKTS_LOOKUP_MISS(table, val)
+
+#endif
+
+struct rte_table_hash {
+	struct rte_table_stats stats;
+
+	/* Input parameters */
+	uint32_t key_size;
+	uint32_t entry_size;
+	uint32_t n_keys;
+	uint32_t key_offset;
+
+	/* Low-level cuckoo hash table, keys and their positions */
+	struct rte_hash *h_table;
+
+	/* Table entries, indexed by the key position in h_table */
+	uint8_t memory[0] __rte_cache_aligned;
+};
+
+static int
+check_params_create(struct rte_table_hash_cuckoo_params *params)
+{
+	if (params == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: params is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	/* name */
+	if (params->name == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: name is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	/* key_size */
+	if ((params->key_size == 0) ||
+		(params->key_size > RTE_HASH_KEY_LENGTH_MAX)) {
+		RTE_LOG(ERR, TABLE, "%s: key_size invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_keys */
+	if (params->n_keys == 0) {
+		RTE_LOG(ERR, TABLE, "%s: n_keys is zero\n", __func__);
+		return -EINVAL;
+	}
+
+	/* f_hash */
+	if (params->f_hash == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: f_hash function pointer is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void *
+rte_table_hash_cuckoo_create(void *params, int socket_id, uint32_t entry_size)
+{
+	struct rte_table_hash_cuckoo_params *p =
+		(struct rte_table_hash_cuckoo_params *) params;
+	struct rte_hash_parameters hash_params;
+	struct rte_table_hash *t;
+	struct rte_hash *h_table;
+	uint64_t total_size;
+
+	/* Check input parameters */
+	if (check_params_create(p) != 0)
+		return NULL;
+
+	/* Memory allocation */
+	total_size = sizeof(struct rte_table_hash) +
+		(uint64_t) p->n_keys * entry_size;
+	if (total_size > SIZE_MAX) {
+		RTE_LOG(ERR, TABLE, "%s: Cannot allocate %" PRIu64 " bytes "
+			"for hash table\n", __func__, total_size);
+		return NULL;
+	}
+
+	t = rte_zmalloc_socket("TABLE", total_size, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: Cannot allocate %" PRIu64 " bytes "
+			"for hash table\n", __func__, total_size);
+		return NULL;
+	}
+
+	/* Low-level cuckoo hash table */
+	memset(&hash_params, 0, sizeof(hash_params));
+	hash_params.name = p->name;
+	hash_params.entries = p->n_keys;
+	hash_params.key_len = p->key_size;
+	hash_params.hash_func = p->f_hash;
+	hash_params.hash_func_init_val = p->seed;
+	hash_params.socket_id = socket_id;
+
+	h_table = rte_hash_create(&hash_params);
+	if (h_table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: Cannot create low-level hash table\n",
+			__func__);
+		rte_free(t);
+		return NULL;
+	}
+
+	/* Memory initialization */
+	t->key_size = p->key_size;
+	t->entry_size = entry_size;
+	t->n_keys = p->n_keys;
+	t->key_offset = p->key_offset;
+	t->h_table = h_table;
+
+	RTE_LOG(INFO, TABLE, "%s: Cuckoo hash table %s memory footprint is "
+		"%" PRIu64 " bytes\n", __func__, p->name, total_size);
+	return t;
+}
+
+static int
+rte_table_hash_cuckoo_free(void *table)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+
+	/* Check input parameters */
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_hash_free(t->h_table);
+	rte_free(t);
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_add(void *table, void *key, void *entry,
+	int *key_found, void **entry_ptr)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	hash_sig_t sig;
+	int32_t pos;
+
+	sig = rte_hash_hash(t->h_table, key);
+
+	/* Key is present in the table: update its data */
+	pos = rte_hash_lookup_with_hash(t->h_table, key, sig);
+	if (pos >= 0) {
+		uint8_t *data = &t->memory[pos * t->entry_size];
+
+		memcpy(data, entry, t->entry_size);
+		*key_found = 1;
+		*entry_ptr = (void *) data;
+		return 0;
+	}
+
+	if (pos != -ENOENT)
+		return pos;
+
+	/* Key is not present in the table */
+	pos = rte_hash_add_key_with_hash(t->h_table, key, sig);
+	if (pos < 0)
+		return pos;
+
+	*key_found = 0;
+	*entry_ptr = (void *) &t->memory[pos * t->entry_size];
+	memcpy(*entry_ptr, entry, t->entry_size);
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_delete(void *table, void *key, int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	int32_t pos;
+
+	pos = rte_hash_del_key(t->h_table, key);
+	if (pos == -ENOENT) {
+		*key_found = 0;
+		return 0;
+	}
+
+	if (pos < 0)
+		return pos;
+
+	/* The entry memory is only reused by a later key add */
+	*key_found = 1;
+	if (entry)
+		memcpy(entry, &t->memory[pos * t->entry_size], t->entry_size);
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_add_bulk(void *table, void **keys, void **entries,
+	uint32_t n_keys, int *key_found, void **entries_ptr)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_keys; i++) {
+		int status = rte_table_hash_cuckoo_entry_add(table, keys[i],
+			entries[i], &key_found[i], &entries_ptr[i]);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_keys; i++) {
+		int status = rte_table_hash_cuckoo_entry_delete(table, keys[i],
+			&key_found[i], (entries != NULL) ? entries[i] : NULL);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	const void *keys[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint8_t pkt_index[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t pkts_mask_out = 0;
+	uint32_t n_keys, i;
+
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_HASH_CUCKOO_STATS_PKTS_IN_ADD(t, n_pkts_in);
+
+	/* Gather the keys of the valid packets into a contiguous array, so that
+	 * sparse bursts still go through the pipelined bulk lookup.
+	 */
+	for (n_keys = 0; pkts_mask != 0; n_keys++) {
+		uint32_t pkt = __builtin_ctzll(pkts_mask);
+
+		pkts_mask &= ~(1LLU << pkt);
+		keys[n_keys] = RTE_MBUF_METADATA_UINT8_PTR(pkts[pkt],
+			t->key_offset);
+		pkt_index[n_keys] = (uint8_t) pkt;
+	}
+
+	if (n_keys != 0)
+		rte_hash_lookup_bulk(t->h_table, keys, n_keys, positions);
+
+	for (i = 0; i < n_keys; i++) {
+		int32_t pos = positions[i];
+		uint32_t pkt = pkt_index[i];
+
+		if (pos < 0)
+			continue;
+
+		pkts_mask_out |= 1LLU << pkt;
+		entries[pkt] = (void *) &t->memory[pos * t->entry_size];
+	}
+
+	*lookup_hit_mask = pkts_mask_out;
+	RTE_TABLE_HASH_CUCKOO_STATS_PKTS_LOOKUP_MISS(t,
+		n_pkts_in - __builtin_popcountll(pkts_mask_out));
+
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_stats_read(void *table, struct rte_table_stats *stats,
+	int clear)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+
+	if (stats != NULL)
+		memcpy(stats, &t->stats, sizeof(t->stats));
+
+	if (clear)
+		memset(&t->stats, 0, sizeof(t->stats));
+
+	return 0;
+}
+
+struct rte_table_ops rte_table_hash_cuckoo_ops = {
+	.f_create = rte_table_hash_cuckoo_create,
+	.f_free = rte_table_hash_cuckoo_free,
+	.f_add = rte_table_hash_cuckoo_entry_add,
+	.f_delete = rte_table_hash_cuckoo_entry_delete,
+	.f_lookup = rte_table_hash_cuckoo_lookup,
+	.f_stats = rte_table_hash_cuckoo_stats_read,
+	.f_add_bulk = rte_table_hash_cuckoo_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_cuckoo_entry_delete_bulk,
+};
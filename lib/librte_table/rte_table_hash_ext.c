@@ -41,6 +41,7 @@
 #include <rte_log.h>
 
 #include "rte_table_hash.h"
+#include "rte_table_hash_bulk.h"
 
 #define KEYS_PER_BUCKET	4
 
@@ -268,16 +269,14 @@ rte_table_hash_ext_free(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
-	int *key_found, void **entry_ptr)
+static inline int
+__rte_table_hash_ext_entry_add(void *table, void *key,
+	uint64_t sig, void *entry, int *key_found, void **entry_ptr)
 {
 	struct rte_table_hash *t = (struct rte_table_hash *) table;
 	struct bucket *bkt0, *bkt, *bkt_prev;
-	uint64_t sig;
 	uint32_t bkt_index, i;
 
-	sig = t->f_hash(key, t->key_size, t->seed);
 	bkt_index = sig & t->bucket_mask;
 	bkt0 = &t->buckets[bkt_index];
 	sig = (sig >> 16) | 1LLU;
@@ -370,15 +369,24 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 }
 
 static int
-rte_table_hash_ext_entry_delete(void *table, void *key, int *key_found,
-void *entry)
+rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
+	int *key_found, void **entry_ptr)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig = t->f_hash(key, t->key_size, t->seed);
+
+	return __rte_table_hash_ext_entry_add(t, key, sig, entry, key_found,
+		entry_ptr);
+}
+
+static inline int
+__rte_table_hash_ext_entry_delete(void *table, void *key,
+	uint64_t sig, int *key_found, void *entry)
 {
 	struct rte_table_hash *t = (struct rte_table_hash *) table;
 	struct bucket *bkt0, *bkt, *bkt_prev;
-	uint64_t sig;
 	uint32_t bkt_index, i;
 
-	sig = t->f_hash(key, t->key_size, t->seed);
 	bkt_index = sig & t->bucket_mask;
 	bkt0 = &t->buckets[bkt_index];
 	sig = (sig >> 16) | 1LLU;
@@ -432,6 +440,44 @@ void *entry)
 	return 0;
 }
 
+static int
+rte_table_hash_ext_entry_delete(void *table, void *key, int *key_found,
+void *entry)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig = t->f_hash(key, t->key_size, t->seed);
+
+	return __rte_table_hash_ext_entry_delete(t, key, sig, key_found, entry);
+}
+
+static uint64_t
+rte_table_hash_ext_signature(void *table, void *key)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig = t->f_hash(key, t->key_size, t->seed);
+
+	rte_prefetch0(&t->buckets[sig & t->bucket_mask]);
+	return sig;
+}
+
+static int
+rte_table_hash_ext_entry_add_bulk(void *table, void **keys, void **entries,
+	uint32_t n_keys, int *key_found, void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_ext_signature,
+		__rte_table_hash_ext_entry_add);
+}
+
+static int
+rte_table_hash_ext_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_ext_signature,
+		__rte_table_hash_ext_entry_delete);
+}
+
 static int rte_table_hash_ext_lookup_unoptimized(
 	void *table,
 	struct rte_mbuf **pkts,
@@ -1141,6 +1187,8 @@ struct rte_table_ops rte_table_hash_ext_ops	 = {
 	.f_delete = rte_table_hash_ext_entry_delete,
 	.f_lookup = rte_table_hash_ext_lookup,
 	.f_stats = rte_table_hash_ext_stats_read,
+	.f_add_bulk = rte_table_hash_ext_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_ext_entry_delete_bulk,
 };
 
 struct rte_table_ops rte_table_hash_ext_dosig_ops  = {
@@ -1150,4 +1198,6 @@ struct rte_table_ops rte_table_hash_ext_dosig_ops  = {
 	.f_delete = rte_table_hash_ext_entry_delete,
 	.f_lookup = rte_table_hash_ext_lookup_dosig,
 	.f_stats = rte_table_hash_ext_stats_read,
+	.f_add_bulk = rte_table_hash_ext_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_ext_entry_delete_bulk,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "rte_table_hash_bulk.h"
 
 #define RTE_TABLE_HASH_KEY_SIZE						16
 
@@ -97,6 +98,17 @@ struct rte_table_hash {
 	uint8_t memory[0] __rte_cache_aligned;
 };
 
+static uint64_t
+rte_table_hash_signature_key16(void *table, void *key)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+	uint32_t bucket_index = signature & (f->n_buckets - 1);
+
+	rte_prefetch0(&f->memory[bucket_index * f->bucket_size]);
+	return signature;
+}
+
 static int
 check_params_create_lru(struct rte_table_hash_key16_lru_params *params) {
 	/* n_entries */
@@ -190,20 +202,20 @@ rte_table_hash_free_key16_lru(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key16_lru(
+static inline int
+__rte_table_hash_entry_add_key16_lru(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_16 *bucket;
-	uint64_t signature, pos;
+	uint64_t pos;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_16 *)
 			&f->memory[bucket_index * f->bucket_size];
@@ -258,18 +270,32 @@ rte_table_hash_entry_add_key16_lru(
 }
 
 static int
-rte_table_hash_entry_delete_key16_lru(
+rte_table_hash_entry_add_key16_lru(
 	void *table,
 	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key16_lru(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key16_lru(
+	void *table,
+	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_16 *bucket;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_16 *)
 			&f->memory[bucket_index * f->bucket_size];
@@ -297,6 +323,47 @@ rte_table_hash_entry_delete_key16_lru(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key16_lru(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key16_lru(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key16_lru(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key16,
+		__rte_table_hash_entry_add_key16_lru);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key16_lru(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key16,
+		__rte_table_hash_entry_delete_key16_lru);
+}
+
 static int
 check_params_create_ext(struct rte_table_hash_key16_ext_params *params) {
 	/* n_entries */
@@ -402,20 +469,19 @@ rte_table_hash_free_key16_ext(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key16_ext(
+static inline int
+__rte_table_hash_entry_add_key16_ext(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_16 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_16 *)
 			&f->memory[bucket_index * f->bucket_size];
@@ -481,18 +547,32 @@ rte_table_hash_entry_add_key16_ext(
 }
 
 static int
-rte_table_hash_entry_delete_key16_ext(
+rte_table_hash_entry_add_key16_ext(
+	void *table,
+	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key16_ext(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key16_ext(
 	void *table,
 	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_16 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_16 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -541,6 +621,47 @@ rte_table_hash_entry_delete_key16_ext(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key16_ext(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key16_ext(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key16_ext(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key16,
+		__rte_table_hash_entry_add_key16_ext);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key16_ext(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key16,
+		__rte_table_hash_entry_delete_key16_ext);
+}
+
 #define lookup_key16_cmp(key_in, bucket, pos)			\
 {								\
 	uint64_t xor[4][2], or[4], signature[4];		\
@@ -1105,6 +1226,8 @@ struct rte_table_ops rte_table_hash_key16_lru_ops = {
 	.f_delete = rte_table_hash_entry_delete_key16_lru,
 	.f_lookup = rte_table_hash_lookup_key16_lru,
 	.f_stats = rte_table_hash_key16_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key16_lru,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key16_lru,
 };
 
 struct rte_table_ops rte_table_hash_key16_ext_ops = {
@@ -1114,4 +1237,6 @@ struct rte_table_ops rte_table_hash_key16_ext_ops = {
 	.f_delete = rte_table_hash_entry_delete_key16_ext,
 	.f_lookup = rte_table_hash_lookup_key16_ext,
 	.f_stats = rte_table_hash_key16_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key16_ext,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key16_ext,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "rte_table_hash_bulk.h"
 
 #define RTE_TABLE_HASH_KEY_SIZE						32
 
@@ -97,6 +98,17 @@ struct rte_table_hash {
 	uint8_t memory[0] __rte_cache_aligned;
 };
 
+static uint64_t
+rte_table_hash_signature_key32(void *table, void *key)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+	uint32_t bucket_index = signature & (f->n_buckets - 1);
+
+	rte_prefetch0(&f->memory[bucket_index * f->bucket_size]);
+	return signature;
+}
+
 static int
 check_params_create_lru(struct rte_table_hash_key32_lru_params *params) {
 	/* n_entries */
@@ -191,20 +203,20 @@ rte_table_hash_free_key32_lru(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key32_lru(
+static inline int
+__rte_table_hash_entry_add_key32_lru(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_32 *bucket;
-	uint64_t signature, pos;
+	uint64_t pos;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_32 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -259,18 +271,32 @@ rte_table_hash_entry_add_key32_lru(
 }
 
 static int
-rte_table_hash_entry_delete_key32_lru(
+rte_table_hash_entry_add_key32_lru(
 	void *table,
 	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key32_lru(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key32_lru(
+	void *table,
+	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_32 *bucket;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_32 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -299,6 +325,47 @@ rte_table_hash_entry_delete_key32_lru(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key32_lru(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key32_lru(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key32_lru(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key32,
+		__rte_table_hash_entry_add_key32_lru);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key32_lru(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key32,
+		__rte_table_hash_entry_delete_key32_lru);
+}
+
 static int
 check_params_create_ext(struct rte_table_hash_key32_ext_params *params) {
 	/* n_entries */
@@ -404,20 +471,19 @@ rte_table_hash_free_key32_ext(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key32_ext(
+static inline int
+__rte_table_hash_entry_add_key32_ext(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_32 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_32 *)
 			&f->memory[bucket_index * f->bucket_size];
@@ -486,18 +552,32 @@ rte_table_hash_entry_add_key32_ext(
 }
 
 static int
-rte_table_hash_entry_delete_key32_ext(
+rte_table_hash_entry_add_key32_ext(
+	void *table,
+	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key32_ext(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key32_ext(
 	void *table,
 	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_32 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_32 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -546,6 +626,47 @@ rte_table_hash_entry_delete_key32_ext(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key32_ext(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key32_ext(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key32_ext(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key32,
+		__rte_table_hash_entry_add_key32_ext);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key32_ext(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key32,
+		__rte_table_hash_entry_delete_key32_ext);
+}
+
 #define lookup_key32_cmp(key_in, bucket, pos)			\
 {								\
 	uint64_t xor[4][4], or[4], signature[4];		\
@@ -1125,6 +1246,8 @@ struct rte_table_ops rte_table_hash_key32_lru_ops = {
 	.f_delete = rte_table_hash_entry_delete_key32_lru,
 	.f_lookup = rte_table_hash_lookup_key32_lru,
 	.f_stats = rte_table_hash_key32_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key32_lru,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key32_lru,
 };
 
 struct rte_table_ops rte_table_hash_key32_ext_ops = {
@@ -1134,4 +1257,6 @@ struct rte_table_ops rte_table_hash_key32_ext_ops = {
 	.f_delete = rte_table_hash_entry_delete_key32_ext,
 	.f_lookup = rte_table_hash_lookup_key32_ext,
 	.f_stats = rte_table_hash_key32_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key32_ext,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key32_ext,
 };
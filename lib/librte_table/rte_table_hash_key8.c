@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "rte_table_hash_bulk.h"
 
 #define RTE_TABLE_HASH_KEY_SIZE						8
 
@@ -94,6 +95,17 @@ struct rte_table_hash {
 	uint8_t memory[0] __rte_cache_aligned;
 };
 
+static uint64_t
+rte_table_hash_signature_key8(void *table, void *key)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+	uint32_t bucket_index = signature & (f->n_buckets - 1);
+
+	rte_prefetch0(&f->memory[bucket_index * f->bucket_size]);
+	return signature;
+}
+
 static int
 check_params_create_lru(struct rte_table_hash_key8_lru_params *params) {
 	/* n_entries */
@@ -186,20 +198,20 @@ rte_table_hash_free_key8_lru(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key8_lru(
+static inline int
+__rte_table_hash_entry_add_key8_lru(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_8 *bucket;
-	uint64_t signature, mask, pos;
+	uint64_t mask, pos;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_8 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -251,18 +263,33 @@ rte_table_hash_entry_add_key8_lru(
 }
 
 static int
-rte_table_hash_entry_delete_key8_lru(
+rte_table_hash_entry_add_key8_lru(
 	void *table,
 	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key8_lru(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key8_lru(
+	void *table,
+	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_8 *bucket;
-	uint64_t signature, mask;
+	uint64_t mask;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket = (struct rte_bucket_4_8 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -290,6 +317,47 @@ rte_table_hash_entry_delete_key8_lru(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key8_lru(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key8_lru(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key8_lru(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key8,
+		__rte_table_hash_entry_add_key8_lru);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key8_lru(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key8,
+		__rte_table_hash_entry_delete_key8_lru);
+}
+
 static int
 check_params_create_ext(struct rte_table_hash_key8_ext_params *params) {
 	/* n_entries */
@@ -393,20 +461,19 @@ rte_table_hash_free_key8_ext(void *table)
 	return 0;
 }
 
-static int
-rte_table_hash_entry_add_key8_ext(
+static inline int
+__rte_table_hash_entry_add_key8_ext(
 	void *table,
 	void *key,
+	uint64_t signature,
 	void *entry,
 	int *key_found,
 	void **entry_ptr)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_8 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_8 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -476,18 +543,32 @@ rte_table_hash_entry_add_key8_ext(
 }
 
 static int
-rte_table_hash_entry_delete_key8_ext(
+rte_table_hash_entry_add_key8_ext(
 	void *table,
 	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_add_key8_ext(f, key, signature, entry,
+		key_found, entry_ptr);
+}
+
+static inline int
+__rte_table_hash_entry_delete_key8_ext(
+	void *table,
+	void *key,
+	uint64_t signature,
 	int *key_found,
 	void *entry)
 {
 	struct rte_table_hash *f = (struct rte_table_hash *) table;
 	struct rte_bucket_4_8 *bucket0, *bucket, *bucket_prev;
-	uint64_t signature;
 	uint32_t bucket_index, i;
 
-	signature = f->f_hash(key, f->key_size, f->seed);
 	bucket_index = signature & (f->n_buckets - 1);
 	bucket0 = (struct rte_bucket_4_8 *)
 		&f->memory[bucket_index * f->bucket_size];
@@ -535,6 +616,47 @@ rte_table_hash_entry_delete_key8_ext(
 	return 0;
 }
 
+static int
+rte_table_hash_entry_delete_key8_ext(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint64_t signature = f->f_hash(key, f->key_size, f->seed);
+
+	return __rte_table_hash_entry_delete_key8_ext(f, key, signature,
+		key_found, entry);
+}
+
+static int
+rte_table_hash_entry_add_bulk_key8_ext(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	return rte_table_hash_entry_add_bulk(table, keys, entries, n_keys,
+		key_found, entries_ptr, rte_table_hash_signature_key8,
+		__rte_table_hash_entry_add_key8_ext);
+}
+
+static int
+rte_table_hash_entry_delete_bulk_key8_ext(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	return rte_table_hash_entry_delete_bulk(table, keys, n_keys,
+		key_found, entries, rte_table_hash_signature_key8,
+		__rte_table_hash_entry_delete_key8_ext);
+}
+
 #define lookup_key8_cmp(key_in, bucket, pos)			\
 {								\
 	uint64_t xor[4], signature;				\
@@ -1396,6 +1518,8 @@ struct rte_table_ops rte_table_hash_key8_lru_ops = {
 	.f_delete = rte_table_hash_entry_delete_key8_lru,
 	.f_lookup = rte_table_hash_lookup_key8_lru,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key8_lru,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key8_lru,
 };
 
 struct rte_table_ops rte_table_hash_key8_lru_dosig_ops = {
@@ -1405,6 +1529,8 @@ struct rte_table_ops rte_table_hash_key8_lru_dosig_ops = {
 	.f_delete = rte_table_hash_entry_delete_key8_lru,
 	.f_lookup = rte_table_hash_lookup_key8_lru_dosig,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key8_lru,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key8_lru,
 };
 
 struct rte_table_ops rte_table_hash_key8_ext_ops = {
@@ -1414,6 +1540,8 @@ struct rte_table_ops rte_table_hash_key8_ext_ops = {
 	.f_delete = rte_table_hash_entry_delete_key8_ext,
 	.f_lookup = rte_table_hash_lookup_key8_ext,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key8_ext,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key8_ext,
 };
 
 struct rte_table_ops rte_table_hash_key8_ext_dosig_ops = {
@@ -1423,4 +1551,6 @@ struct rte_table_ops rte_table_hash_key8_ext_dosig_ops = {
 	.f_delete = rte_table_hash_entry_delete_key8_ext,
 	.f_lookup = rte_table_hash_lookup_key8_ext_dosig,
 	.f_stats = rte_table_hash_key8_stats_read,
+	.f_add_bulk = rte_table_hash_entry_add_bulk_key8_ext,
+	.f_delete_bulk = rte_table_hash_entry_delete_bulk_key8_ext,
 };
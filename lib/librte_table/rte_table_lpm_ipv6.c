@@ -266,6 +266,35 @@ rte_table_lpm_ipv6_entry_add(
 	return 0;
 }
 
+static int
+rte_table_lpm_ipv6_entry_add_bulk(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((keys == NULL) || (entries == NULL) || (key_found == NULL) ||
+		(entries_ptr == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: array parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		int status = rte_table_lpm_ipv6_entry_add(table, keys[i],
+			entries[i], &key_found[i], &entries_ptr[i]);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
 static int
 rte_table_lpm_ipv6_entry_delete(
 	void *table,
@@ -327,6 +356,33 @@ rte_table_lpm_ipv6_entry_delete(
 	return 0;
 }
 
+static int
+rte_table_lpm_ipv6_entry_delete_bulk(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((keys == NULL) || (key_found == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: array parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		int status = rte_table_lpm_ipv6_entry_delete(table, keys[i],
+			&key_found[i], (entries != NULL) ? entries[i] : NULL);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
 static int
 rte_table_lpm_ipv6_lookup(
 	void *table,
@@ -389,4 +445,6 @@ struct rte_table_ops rte_table_lpm_ipv6_ops = {
 	.f_delete = rte_table_lpm_ipv6_entry_delete,
 	.f_lookup = rte_table_lpm_ipv6_lookup,
 	.f_stats = rte_table_lpm_ipv6_stats_read,
+	.f_add_bulk = rte_table_lpm_ipv6_entry_add_bulk,
+	.f_delete_bulk = rte_table_lpm_ipv6_entry_delete_bulk,
 };
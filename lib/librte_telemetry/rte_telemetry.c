@@ -0,0 +1,734 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <sys/queue.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_memzone.h>
+#include <rte_tailq.h>
+#include <rte_rwlock.h>
+#include <rte_eal_memconfig.h>
+#include <rte_spinlock.h>
+#include <rte_ethdev.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#ifdef RTE_LIBRTE_JOBSTATS
+#include <rte_jobstats.h>
+#endif
+
+#include "rte_telemetry.h"
+
+#define TELEMETRY_MZ_NAME "rte_telemetry"
+#define TELEMETRY_MAGIC 0x54454c45 /* "TELE" */
+#define TELEMETRY_MAX_SOURCES 64
+#define TELEMETRY_MAX_GROUPS RTE_TELEMETRY_MAX_GROUPS
+#define TELEMETRY_MAX_VALUES RTE_TELEMETRY_MAX_VALUES
+/* send timeout, so that a stuck client cannot stall the collection */
+#define TELEMETRY_SEND_TIMEOUT_MS 100
+
+/* a group of consecutive values of the snapshot */
+struct telemetry_group {
+	char name[RTE_TELEMETRY_NAMESIZE];
+	uint32_t first;
+	uint32_t count;
+};
+
+struct telemetry_snapshot {
+	uint64_t timestamp_us;  /* wall clock time of the collection */
+	uint32_t nb_groups;
+	uint32_t nb_values;
+	struct telemetry_group groups[TELEMETRY_MAX_GROUPS];
+	struct rte_telemetry_value values[TELEMETRY_MAX_VALUES];
+};
+
+/*
+ * The shared snapshot region. It is written by the publisher only, with a
+ * sequence lock: seq is odd while the snapshot is being updated, and a
+ * reader retries its copy if seq was odd or changed meanwhile.
+ */
+struct telemetry_region {
+	uint32_t magic;
+	uint32_t version;
+	volatile uint32_t seq;
+	struct telemetry_snapshot snap;
+} __rte_cache_aligned;
+
+struct telemetry_source {
+	char name[RTE_TELEMETRY_NAMESIZE];
+	rte_telemetry_read_t read;
+	void *arg;
+};
+
+/*
+ * Registered sources. The lock is not held while a source is read, so that
+ * its callback can take its time or (un)register sources; instead the
+ * source being read is recorded so that unregistering it waits for the end
+ * of the read.
+ */
+static struct telemetry_source sources[TELEMETRY_MAX_SOURCES];
+static unsigned nb_sources;
+static rte_spinlock_t sources_lock = RTE_SPINLOCK_INITIALIZER;
+static char reading_name[RTE_TELEMETRY_NAMESIZE]; /* "" when not reading */
+static pthread_t reading_thread;
+
+/* serializes the collections, and protects the staging buffers */
+static rte_spinlock_t publish_lock = RTE_SPINLOCK_INITIALIZER;
+
+static struct telemetry_region *region;
+static struct telemetry_snapshot *staging;  /* collection buffer */
+static struct rte_eth_xstats *xstats;       /* ethdev read buffer */
+
+static int listen_fd = -1;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static char *json_buf;
+static size_t json_size;
+static pthread_t thread_id;
+static volatile int thread_stop;
+static int started;
+static uint64_t period_cycles;
+
+/* start a new group, named prefix + name, in the staging snapshot */
+static struct telemetry_group *
+group_add(const char *prefix, const char *name)
+{
+	struct telemetry_group *g;
+	int len;
+
+	if (staging->nb_groups == TELEMETRY_MAX_GROUPS)
+		return NULL;
+	g = &staging->groups[staging->nb_groups];
+	len = snprintf(g->name, sizeof(g->name), "%s%s", prefix, name);
+	if (len < 0 || len >= (int)sizeof(g->name)) {
+		RTE_LOG(DEBUG, TELEMETRY, "Telemetry group name %s%s is too "
+			"long\n", prefix, name);
+		return NULL;
+	}
+	staging->nb_groups++;
+	g->first = staging->nb_values;
+	g->count = 0;
+	return g;
+}
+
+static void
+group_cancel(void)
+{
+	staging->nb_groups--;
+}
+
+static void
+value_add(struct telemetry_group *g, const char *name, uint64_t value)
+{
+	struct rte_telemetry_value *v;
+
+	if (staging->nb_values == TELEMETRY_MAX_VALUES)
+		return;
+	v = &staging->values[staging->nb_values++];
+	snprintf(v->name, sizeof(v->name), "%s", name);
+	v->value = value;
+	g->count++;
+}
+
+static void
+collect_ethdev(void)
+{
+	struct telemetry_group *g;
+	char port_name[8];
+	unsigned port;
+	int i, n;
+
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		if (!rte_eth_dev_is_valid_port(port))
+			continue;
+		n = rte_eth_xstats_get(port, xstats, TELEMETRY_MAX_VALUES);
+		if (n < 0 || n > TELEMETRY_MAX_VALUES)
+			continue;
+		snprintf(port_name, sizeof(port_name), "%u", port);
+		g = group_add("ethdev.", port_name);
+		if (g == NULL)
+			continue;
+		for (i = 0; i < n; i++)
+			value_add(g, xstats[i].name, xstats[i].value);
+	}
+}
+
+static void
+collect_mempool(const struct rte_mempool *mp, void *arg __rte_unused)
+{
+	struct telemetry_group *g;
+	unsigned count;
+
+	g = group_add("mempool.", mp->name);
+	if (g == NULL)
+		return;
+	count = rte_mempool_count(mp);
+	value_add(g, "size", mp->size);
+	value_add(g, "avail_count", count);
+	value_add(g, "in_use_count", mp->size - count);
+	value_add(g, "cache_size", mp->cache_size);
+	value_add(g, "elt_size", mp->elt_size);
+}
+
+TAILQ_HEAD(telemetry_ring_list, rte_tailq_entry);
+
+static void
+collect_ring(void)
+{
+	struct telemetry_ring_list *ring_list;
+	struct telemetry_group *g;
+	struct rte_tailq_entry *te;
+	struct rte_ring *r;
+
+	ring_list = RTE_TAILQ_LOOKUP(RTE_TAILQ_RING_NAME,
+		telemetry_ring_list);
+	if (ring_list == NULL)
+		return;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, ring_list, next) {
+		r = te->data;
+		g = group_add("ring.", r->name);
+		if (g == NULL)
+			continue;
+		value_add(g, "size", r->prod.size);
+		value_add(g, "count", rte_ring_count(r));
+		value_add(g, "free_count", rte_ring_free_count(r));
+		value_add(g, "watermark", r->prod.watermark);
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+}
+
+static void
+collect_sources(void)
+{
+	struct telemetry_source src;
+	struct telemetry_group *g;
+	unsigned i, room;
+	int n;
+
+	for (i = 0; ; i++) {
+		/* sources may come and go while a callback runs */
+		rte_spinlock_lock(&sources_lock);
+		if (i >= nb_sources) {
+			rte_spinlock_unlock(&sources_lock);
+			return;
+		}
+		src = sources[i];
+		memcpy(reading_name, src.name, sizeof(reading_name));
+		reading_thread = pthread_self();
+		rte_spinlock_unlock(&sources_lock);
+
+		g = group_add("", src.name);
+		if (g != NULL) {
+			room = TELEMETRY_MAX_VALUES - staging->nb_values;
+			n = src.read(src.arg,
+				&staging->values[staging->nb_values], room);
+			if (n < 0 || (unsigned)n > room) {
+				RTE_LOG(DEBUG, TELEMETRY,
+					"Cannot read telemetry group %s\n",
+					src.name);
+				group_cancel();
+			} else {
+				g->count = n;
+				staging->nb_values += n;
+			}
+		}
+
+		rte_spinlock_lock(&sources_lock);
+		reading_name[0] = '\0';
+		/* the source may have been unregistered by its callback */
+		if (i < nb_sources && strcmp(sources[i].name, src.name) != 0)
+			i--;
+		rte_spinlock_unlock(&sources_lock);
+	}
+}
+
+/* copy the used part of a snapshot */
+static void
+snapshot_copy(struct telemetry_snapshot *dst,
+	const struct telemetry_snapshot *src)
+{
+	uint32_t nb_groups = RTE_MIN(src->nb_groups,
+		(uint32_t)TELEMETRY_MAX_GROUPS);
+	uint32_t nb_values = RTE_MIN(src->nb_values,
+		(uint32_t)TELEMETRY_MAX_VALUES);
+
+	dst->timestamp_us = src->timestamp_us;
+	dst->nb_groups = nb_groups;
+	dst->nb_values = nb_values;
+	memcpy(dst->groups, src->groups, sizeof(dst->groups[0]) * nb_groups);
+	memcpy(dst->values, src->values, sizeof(dst->values[0]) * nb_values);
+}
+
+int
+rte_telemetry_publish(void)
+{
+	struct timeval tv;
+
+	rte_spinlock_lock(&publish_lock);
+	if (staging == NULL) {
+		rte_spinlock_unlock(&publish_lock);
+		return -ENODEV;
+	}
+
+	staging->nb_groups = 0;
+	staging->nb_values = 0;
+	gettimeofday(&tv, NULL);
+	staging->timestamp_us = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+
+	collect_ethdev();
+	rte_mempool_walk(collect_mempool, NULL);
+	collect_ring();
+	collect_sources();
+
+	/* seqlock write */
+	region->seq++;
+	rte_wmb();
+	snapshot_copy(&region->snap, staging);
+	rte_wmb();
+	region->seq++;
+
+	rte_spinlock_unlock(&publish_lock);
+	return 0;
+}
+
+static struct telemetry_region *
+region_lookup(void)
+{
+	const struct rte_memzone *mz;
+
+	if (region != NULL)
+		return region;
+
+	mz = rte_memzone_lookup(TELEMETRY_MZ_NAME);
+	if (mz == NULL)
+		return NULL;
+	if (((struct telemetry_region *)mz->addr)->magic != TELEMETRY_MAGIC ||
+			((struct telemetry_region *)mz->addr)->version !=
+			RTE_TELEMETRY_VERSION)
+		return NULL;
+	region = mz->addr;
+	return region;
+}
+
+/* append a JSON string, escaped */
+static int
+json_string(char *buf, size_t size, const char *s)
+{
+	size_t len = 0;
+
+	if (len < size)
+		buf[len] = '"';
+	len++;
+	for (; *s != '\0'; s++) {
+		if ((unsigned char)*s < 0x20)
+			continue;
+		if (*s == '"' || *s == '\\') {
+			if (len < size)
+				buf[len] = '\\';
+			len++;
+		}
+		if (len < size)
+			buf[len] = *s;
+		len++;
+	}
+	if (len < size)
+		buf[len] = '"';
+	len++;
+	return len;
+}
+
+#define JSON_APPEND(...) do {						\
+	int __n = snprintf(buf + len, len < size ? size - len : 0,	\
+		__VA_ARGS__);						\
+	len += __n;							\
+} while (0)
+
+#define JSON_STRING(s) do {						\
+	len += json_string(buf + len, len < size ? size - len : 0, s);	\
+} while (0)
+
+int
+rte_telemetry_json(char *buf, size_t size)
+{
+	struct telemetry_snapshot *snap;
+	const struct telemetry_group *g;
+	uint32_t seq, i, j;
+	size_t len = 0;
+
+	if (region_lookup() == NULL)
+		return -ENODEV;
+
+	snap = malloc(sizeof(*snap));
+	if (snap == NULL)
+		return -ENOMEM;
+
+	/* seqlock read */
+	do {
+		seq = region->seq;
+		rte_rmb();
+		if (seq & 1) {
+			rte_pause();
+			continue;
+		}
+		snapshot_copy(snap, &region->snap);
+		rte_rmb();
+	} while ((seq & 1) || region->seq != seq);
+
+	JSON_APPEND("{\"version\": %u, \"seq\": %u, \"timestamp_us\": %"
+		PRIu64 ", \"groups\": {", RTE_TELEMETRY_VERSION, seq / 2,
+		snap->timestamp_us);
+	for (i = 0; i < snap->nb_groups; i++) {
+		g = &snap->groups[i];
+		if (i != 0)
+			JSON_APPEND(", ");
+		JSON_STRING(g->name);
+		JSON_APPEND(": {");
+		for (j = g->first;
+				j < g->first + g->count && j < snap->nb_values;
+				j++) {
+			if (j != g->first)
+				JSON_APPEND(", ");
+			JSON_STRING(snap->values[j].name);
+			JSON_APPEND(": %" PRIu64, snap->values[j].value);
+		}
+		JSON_APPEND("}");
+	}
+	JSON_APPEND("}}\n");
+
+	free(snap);
+	if (len >= size)
+		return -ENOBUFS;
+	return len;
+}
+
+/* send the JSON snapshot to a new client */
+static void
+telemetry_serve(void)
+{
+	struct timeval tv = {
+		.tv_sec = 0,
+		.tv_usec = TELEMETRY_SEND_TIMEOUT_MS * 1000,
+	};
+	ssize_t ret;
+	size_t off = 0;
+	int fd, len;
+
+	fd = accept(listen_fd, NULL, NULL);
+	if (fd < 0)
+		return;
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	len = rte_telemetry_json(json_buf, json_size);
+	while (len > 0 && off < (size_t)len) {
+		ret = send(fd, json_buf + off, len - off, MSG_NOSIGNAL);
+		if (ret <= 0)
+			break;
+		off += ret;
+	}
+	close(fd);
+}
+
+static void *
+telemetry_thread(__rte_unused void *arg)
+{
+	struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+	uint64_t now, next = 0;
+	int timeout_ms;
+
+	while (!thread_stop) {
+		now = rte_get_timer_cycles();
+		if (now >= next) {
+			rte_telemetry_publish();
+			next = now + period_cycles;
+		}
+		timeout_ms = (next - now) * 1000 / rte_get_timer_hz() + 1;
+		if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN))
+			telemetry_serve();
+	}
+	return NULL;
+}
+
+static int
+telemetry_socket_create(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return -ENAMETOOLONG;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -errno;
+	unlink(path);
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			listen(fd, 8) < 0) {
+		int err = errno;
+
+		RTE_LOG(ERR, TELEMETRY, "Cannot listen on %s: %s\n",
+			path, strerror(err));
+		close(fd);
+		return -err;
+	}
+	snprintf(socket_path, sizeof(socket_path), "%s", path);
+	return fd;
+}
+
+int
+rte_telemetry_init(const char *path, unsigned period_ms)
+{
+	const struct rte_memzone *mz;
+	int ret;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -E_RTE_SECONDARY;
+	if (started)
+		return -EALREADY;
+
+	if (path == NULL)
+		path = RTE_TELEMETRY_DEFAULT_PATH;
+	if (period_ms == 0)
+		period_ms = RTE_TELEMETRY_DEFAULT_PERIOD_MS;
+	period_cycles = rte_get_timer_hz() * period_ms / 1000;
+
+	if (region == NULL) {
+		mz = rte_memzone_reserve(TELEMETRY_MZ_NAME, sizeof(*region),
+			SOCKET_ID_ANY, 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, TELEMETRY,
+				"Cannot reserve the telemetry region\n");
+			return -ENOMEM;
+		}
+		region = mz->addr;
+		region->seq = 0;
+		region->snap.nb_groups = 0;
+		region->snap.nb_values = 0;
+		region->version = RTE_TELEMETRY_VERSION;
+		rte_wmb();
+		region->magic = TELEMETRY_MAGIC;
+	}
+
+	/* every name may be escaped, plus the separators */
+	json_size = 128 + (TELEMETRY_MAX_GROUPS + TELEMETRY_MAX_VALUES) *
+		(2 * RTE_TELEMETRY_NAMESIZE + 32);
+	staging = malloc(sizeof(*staging));
+	xstats = malloc(sizeof(*xstats) * TELEMETRY_MAX_VALUES);
+	json_buf = malloc(json_size);
+	if (staging == NULL || xstats == NULL || json_buf == NULL) {
+		ret = -ENOMEM;
+		goto fail;
+	}
+
+	listen_fd = telemetry_socket_create(path);
+	if (listen_fd < 0) {
+		ret = listen_fd;
+		goto fail;
+	}
+
+	/* publish a first snapshot before accepting clients */
+	rte_telemetry_publish();
+
+	thread_stop = 0;
+	ret = -pthread_create(&thread_id, NULL, telemetry_thread, NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, TELEMETRY, "Cannot create telemetry thread\n");
+		close(listen_fd);
+		unlink(socket_path);
+		goto fail;
+	}
+
+	started = 1;
+	RTE_LOG(INFO, TELEMETRY, "Telemetry published on %s every %u ms\n",
+		path, period_ms);
+	return 0;
+
+fail:
+	listen_fd = -1;
+	free(staging);
+	free(xstats);
+	free(json_buf);
+	staging = NULL;
+	xstats = NULL;
+	json_buf = NULL;
+	return ret;
+}
+
+void
+rte_telemetry_uninit(void)
+{
+	if (!started)
+		return;
+
+	thread_stop = 1;
+	pthread_join(thread_id, NULL);
+	close(listen_fd);
+	listen_fd = -1;
+	unlink(socket_path);
+
+	rte_spinlock_lock(&publish_lock);
+	free(staging);
+	free(xstats);
+	staging = NULL;
+	xstats = NULL;
+	rte_spinlock_unlock(&publish_lock);
+	free(json_buf);
+	json_buf = NULL;
+	started = 0;
+}
+
+int
+rte_telemetry_register(const char *group, rte_telemetry_read_t read,
+		void *arg)
+{
+	unsigned i;
+	int ret = 0;
+
+	if (group == NULL || read == NULL ||
+			strlen(group) >= RTE_TELEMETRY_NAMESIZE)
+		return -EINVAL;
+
+	rte_spinlock_lock(&sources_lock);
+	for (i = 0; i < nb_sources; i++) {
+		if (strcmp(sources[i].name, group) == 0) {
+			ret = -EEXIST;
+			goto out;
+		}
+	}
+	if (nb_sources == TELEMETRY_MAX_SOURCES) {
+		ret = -ENOSPC;
+		goto out;
+	}
+	snprintf(sources[nb_sources].name, sizeof(sources[0].name), "%s",
+		group);
+	sources[nb_sources].read = read;
+	sources[nb_sources].arg = arg;
+	nb_sources++;
+out:
+	rte_spinlock_unlock(&sources_lock);
+	return ret;
+}
+
+int
+rte_telemetry_unregister(const char *group)
+{
+	unsigned i;
+	int ret = -ENOENT;
+
+	if (group == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&sources_lock);
+	for (i = 0; i < nb_sources; i++) {
+		if (strcmp(sources[i].name, group) == 0) {
+			nb_sources--;
+			memmove(&sources[i], &sources[i + 1],
+				sizeof(sources[0]) * (nb_sources - i));
+			ret = 0;
+			break;
+		}
+	}
+	/* wait for the end of a read of the source, unless called from it */
+	while (ret == 0 && strcmp(reading_name, group) == 0 &&
+			!pthread_equal(reading_thread, pthread_self())) {
+		rte_spinlock_unlock(&sources_lock);
+		rte_pause();
+		rte_spinlock_lock(&sources_lock);
+	}
+	rte_spinlock_unlock(&sources_lock);
+	return ret;
+}
+
+#ifdef RTE_LIBRTE_JOBSTATS
+static int
+jobstats_read(void *arg, struct rte_telemetry_value *values, unsigned n)
+{
+	const struct rte_jobstats_context *ctx = arg;
+	const struct {
+		const char *name;
+		uint64_t value;
+	} stats[] = {
+		{ "exec_time", ctx->exec_time },
+		{ "min_exec_time", ctx->min_exec_time },
+		{ "max_exec_time", ctx->max_exec_time },
+		{ "management_time", ctx->management_time },
+		{ "min_management_time", ctx->min_management_time },
+		{ "max_management_time", ctx->max_management_time },
+		{ "job_exec_cnt", ctx->job_exec_cnt },
+		{ "loop_cnt", ctx->loop_cnt },
+	};
+	unsigned i;
+
+	if (n < RTE_DIM(stats))
+		return RTE_DIM(stats);
+	for (i = 0; i < RTE_DIM(stats); i++) {
+		snprintf(values[i].name, sizeof(values[i].name), "%s",
+			stats[i].name);
+		values[i].value = stats[i].value;
+	}
+	return RTE_DIM(stats);
+}
+#endif
+
+int
+rte_telemetry_register_jobstats(const char *group, void *ctx)
+{
+#ifdef RTE_LIBRTE_JOBSTATS
+	if (ctx == NULL)
+		return -EINVAL;
+	return rte_telemetry_register(group, jobstats_read, ctx);
+#else
+	RTE_SET_USED(group);
+	RTE_SET_USED(ctx);
+	return -ENOTSUP;
+#endif
+}
@@ -0,0 +1,211 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_TELEMETRY_H_
+#define _RTE_TELEMETRY_H_
+
+/**
+ * @file
+ * RTE Telemetry
+ *
+ * The telemetry library periodically collects the statistics of the
+ * ethdev ports, mempools and rings, and of any source registered by the
+ * application (job statistics, QoS scheduler, pipelines...), from a
+ * control thread. Each collection is published as a snapshot in a shared
+ * memory region protected by a sequence lock, so that a reader never
+ * blocks the publisher and the datapath lcores are never involved.
+ *
+ * The snapshot is served in JSON on a unix socket: a client connecting to
+ * the socket receives the last snapshot, then the connection is closed.
+ * Secondary processes can also read it with rte_telemetry_json().
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of the snapshot layout and of the JSON document. */
+#define RTE_TELEMETRY_VERSION 1
+
+/** Maximum length of a group or value name. */
+#define RTE_TELEMETRY_NAMESIZE 64
+
+/** Default path of the unix socket. */
+#define RTE_TELEMETRY_DEFAULT_PATH "/var/run/.rte_telemetry"
+
+/** Default collection period, in milliseconds. */
+#define RTE_TELEMETRY_DEFAULT_PERIOD_MS 100
+
+/**
+ * A named counter, filled by a telemetry source.
+ */
+struct rte_telemetry_value {
+	char name[RTE_TELEMETRY_NAMESIZE]; /**< Name of the counter. */
+	uint64_t value;                    /**< Value of the counter. */
+};
+
+/**
+ * Callback reading the counters of a telemetry source.
+ *
+ * It is called from the telemetry control thread at each collection, or
+ * from rte_telemetry_publish(). It may register or unregister sources,
+ * including its own, but must not call rte_telemetry_publish().
+ *
+ * @param arg
+ *   The argument given at registration.
+ * @param values
+ *   The table to fill.
+ * @param n
+ *   The size of the table.
+ * @return
+ *   The number of counters of the source; if it is greater than n, the
+ *   table is too small and nothing is published for this source.
+ *   A negative value on error.
+ */
+typedef int (*rte_telemetry_read_t)(void *arg,
+		struct rte_telemetry_value *values, unsigned n);
+
+/**
+ * Start the telemetry: reserve the snapshot region, create the unix
+ * socket and the control thread collecting the statistics.
+ *
+ * The control thread inherits the CPU affinity of the caller, normally
+ * the master lcore.
+ *
+ * @param path
+ *   Path of the unix socket, or NULL for RTE_TELEMETRY_DEFAULT_PATH.
+ * @param period_ms
+ *   The collection period in milliseconds, or 0 for
+ *   RTE_TELEMETRY_DEFAULT_PERIOD_MS.
+ * @return
+ *   - 0: Success.
+ *   - -EALREADY: the telemetry is already started.
+ *   - -E_RTE_SECONDARY: called from a secondary process.
+ *   - -ENOMEM: the snapshot region cannot be allocated.
+ *   - other negative errno: the socket or the thread cannot be created.
+ */
+int rte_telemetry_init(const char *path, unsigned period_ms);
+
+/**
+ * Stop the control thread and remove the unix socket.
+ *
+ * The snapshot region is kept, with the last published statistics.
+ */
+void rte_telemetry_uninit(void);
+
+/**
+ * Register a source of statistics, published as a group of counters.
+ *
+ * For instance, the statistics of a QoS scheduler port or of a pipeline
+ * can be exported with a callback calling rte_sched_subport_read_stats() or
+ * rte_pipeline_port_in_stats_read().
+ *
+ * @param group
+ *   The unique name of the group.
+ * @param read
+ *   The callback reading the counters.
+ * @param arg
+ *   The argument of the callback.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: invalid parameters.
+ *   - -EEXIST: a group with the same name is already registered.
+ *   - -ENOSPC: too many groups.
+ */
+int rte_telemetry_register(const char *group, rte_telemetry_read_t read,
+		void *arg);
+
+/**
+ * Unregister a source of statistics.
+ *
+ * When this function returns, the callback of the source is not running
+ * and will not be called anymore.
+ *
+ * @param group
+ *   The name given at registration.
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: no group with this name.
+ */
+int rte_telemetry_unregister(const char *group);
+
+/**
+ * Register the statistics of a job statistics context.
+ *
+ * @param group
+ *   The unique name of the group.
+ * @param ctx
+ *   A struct rte_jobstats_context, which must be valid until unregistered.
+ * @return
+ *   Same as rte_telemetry_register(), or -ENOTSUP if the jobstats library
+ *   is not enabled.
+ */
+int rte_telemetry_register_jobstats(const char *group, void *ctx);
+
+/**
+ * Collect the statistics of all the sources and publish them now.
+ *
+ * This is done periodically by the control thread, but can be called to
+ * force an update.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENODEV: the telemetry is not initialised.
+ */
+int rte_telemetry_publish(void);
+
+/**
+ * Format the last published snapshot in JSON.
+ *
+ * It can be called from a primary or a secondary process and does not
+ * block the publisher.
+ *
+ * @param buf
+ *   The output buffer.
+ * @param size
+ *   The size of the buffer.
+ * @return
+ *   The length of the document, without the terminating '\0'.
+ *   -ENODEV if no snapshot region exists, -ENOBUFS if the buffer is too
+ *   small.
+ */
+int rte_telemetry_json(char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TELEMETRY_H_ */
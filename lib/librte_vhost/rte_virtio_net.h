@@ -48,11 +48,43 @@
 
 #include <rte_memory.h>
 #include <rte_mempool.h>
+#include <rte_branch_prediction.h>
 
 struct rte_mbuf;
 
+#ifndef VIRTIO_F_RING_PACKED
+#define VIRTIO_F_RING_PACKED 34
+#endif
+#ifndef VIRTIO_F_IN_ORDER
+#define VIRTIO_F_IN_ORDER 35
+#endif
+
+#ifndef VRING_PACKED_DESC_F_AVAIL
+/* The packed ring layout, for kernel headers older than it. */
+#define VRING_PACKED_DESC_F_AVAIL	7
+#define VRING_PACKED_DESC_F_USED	15
+#define VRING_PACKED_EVENT_FLAG_ENABLE	0x0
+#define VRING_PACKED_EVENT_FLAG_DISABLE	0x1
+#define VRING_PACKED_EVENT_FLAG_DESC	0x2
+
+struct vring_packed_desc_event {
+	uint16_t off_wrap;
+	uint16_t flags;
+};
+
+struct vring_packed_desc {
+	uint64_t addr;
+	uint32_t len;
+	uint16_t id;
+	uint16_t flags;
+};
+#endif
+
 #define VHOST_MEMORY_MAX_NREGIONS 8
 
+/* Maximum number of RX/TX virtqueue pairs of a device. */
+#define VHOST_MAX_QUEUE_PAIRS 0x80
+
 /* Used to indicate that the device is running on a data core */
 #define VIRTIO_DEV_RUNNING 1
 
@@ -60,7 +92,10 @@ struct rte_mbuf;
 #define VIRTIO_DEV_STOPPED -1
 
 
-/* Enum for virtqueue management. */
+/*
+ * Enum for virtqueue management. The virtqueues of queue pair n have the
+ * indexes n * VIRTIO_QNUM + VIRTIO_RXQ and n * VIRTIO_QNUM + VIRTIO_TXQ.
+ */
 enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 
 #define BUF_VECTOR_MAX 256
@@ -75,6 +110,26 @@ struct buf_vector {
 	uint32_t desc_idx;
 };
 
+/**
+ * A zero-copy dequeued mbuf, and the head of the descriptor chain it
+ * points into. The chain is given back to the guest once the application
+ * has dropped its reference to the mbuf.
+ */
+struct zcopy_mbuf {
+	struct rte_mbuf *mbuf;
+	uint16_t desc_idx;
+};
+
+/**
+ * Host physical address of a run of guest memory, for the NIC to DMA
+ * zero-copy dequeued packets. The runs are sorted by guest address.
+ */
+struct guest_page {
+	uint64_t guest_phys_addr;
+	uint64_t host_phys_addr;
+	uint64_t size;
+};
+
 /**
  * Structure contains variables relevant to RX/TX virtqueues.
  */
@@ -82,28 +137,41 @@ struct vhost_virtqueue {
 	struct vring_desc	*desc;			/**< Virtqueue descriptor ring. */
 	struct vring_avail	*avail;			/**< Virtqueue available ring. */
 	struct vring_used	*used;			/**< Virtqueue used ring. */
+	struct vring_packed_desc	*desc_packed;	/**< Descriptor ring, when VIRTIO_F_RING_PACKED is negotiated. */
+	struct vring_packed_desc_event	*driver_event;	/**< Packed ring notification suppression, written by the guest. */
+	struct vring_packed_desc_event	*device_event;	/**< Packed ring notification suppression, written by vhost. */
+	uint16_t		avail_wrap_counter;	/**< Wrap counter of last_used_idx in a packed ring. */
 	uint32_t		size;			/**< Size of descriptor ring. */
 	uint32_t		backend;		/**< Backend value to determine if device should started/stopped. */
 	uint16_t		vhost_hlen;		/**< Vhost header length (varies depending on RX merge buffers. */
 	volatile uint16_t	last_used_idx;		/**< Last index used on the available ring */
 	volatile uint16_t	last_used_idx_res;	/**< Used for multiple devices reserving buffers. */
+	int			enabled;		/**< Virtqueue enabled by the guest. */
+	uint32_t		last_region;		/**< Memory region of the last translated address. */
 	eventfd_t		callfd;			/**< Used to notify the guest (trigger interrupt). */
 	eventfd_t		kickfd;			/**< Currently unused as polling mode is enabled. */
 	struct buf_vector	buf_vec[BUF_VECTOR_MAX];	/**< for scatter RX. */
+	struct zcopy_mbuf	*zmbufs;		/**< Zero-copy dequeued mbufs not yet returned to the guest. */
+	uint16_t		nr_zmbufs;		/**< Number of entries in zmbufs. */
 } __rte_cache_aligned;
 
 /**
  * Device structure contains all configuration information relating to the device.
  */
 struct virtio_net {
-	struct vhost_virtqueue	*virtqueue[VIRTIO_QNUM];	/**< Contains all virtqueue information. */
+	struct vhost_virtqueue	*virtqueue[VHOST_MAX_QUEUE_PAIRS * VIRTIO_QNUM];	/**< Contains all virtqueue information. */
 	struct virtio_memory	*mem;		/**< QEMU memory and memory region information. */
 	uint64_t		features;	/**< Negotiated feature set. */
+	uint64_t		protocol_features;	/**< Negotiated vhost-user protocol features. */
+	uint32_t		virt_qp_nb;	/**< Number of allocated queue pairs. */
 	uint64_t		device_fh;	/**< device identifier. */
 	uint32_t		flags;		/**< Device flags. Only used to check if device is running on data core. */
 #define IF_NAME_SZ (PATH_MAX > IFNAMSIZ ? PATH_MAX : IFNAMSIZ)
 	char			ifname[IF_NAME_SZ];	/**< Name of the tap device or socket path. */
 	void			*priv;		/**< private context */
+	uint32_t		dequeue_zero_copy;	/**< Dequeued mbufs point to guest memory. */
+	uint32_t		nr_guest_pages;	/**< Number of entries in guest_pages. */
+	struct guest_page	*guest_pages;	/**< Host physical address of the guest memory, for zero copy. */
 } __rte_cache_aligned;
 
 /**
@@ -120,6 +188,7 @@ struct virtio_memory_regions {
 
 /**
  * Memory structure includes region and mapping information.
+ * The regions are sorted by guest physical address.
  */
 struct virtio_memory {
 	uint64_t	base_address;	/**< Base QEMU userspace address of the memory file. */
@@ -135,17 +204,76 @@ struct virtio_memory {
  * Make sure to set VIRTIO_DEV_RUNNING to the device flags in new_device and
  * remove it in destroy_device.
  *
+ * vring_state_changed is optional. It is called when the guest enables or
+ * disables a virtqueue, so that the application can (un)assign it to a core.
  */
 struct virtio_net_device_ops {
 	int (*new_device)(struct virtio_net *);	/**< Add device. */
 	void (*destroy_device)(volatile struct virtio_net *);	/**< Remove device. */
+	int (*vring_state_changed)(struct virtio_net *dev, uint16_t queue_id, int enable);	/**< Triggered when a vring is enabled or disabled. */
 };
 
+/* Is the packed ring descriptor available in the lap of wrap counter? */
+static inline int __attribute__((always_inline))
+desc_is_avail(struct vring_packed_desc *desc, uint16_t wrap)
+{
+	uint16_t flags = *(volatile uint16_t *)&desc->flags;
+
+	return wrap == !!(flags & (1 << VRING_PACKED_DESC_F_AVAIL)) &&
+		wrap != !!(flags & (1 << VRING_PACKED_DESC_F_USED));
+}
+
 static inline uint16_t __attribute__((always_inline))
 rte_vring_available_entries(struct virtio_net *dev, uint16_t queue_id)
 {
 	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
-	return *(volatile uint16_t *)&vq->avail->idx - vq->last_used_idx_res;
+	uint16_t idx, wrap, n = 0;
+
+	if (!(dev->features & (1ULL << VIRTIO_F_RING_PACKED)))
+		return *(volatile uint16_t *)&vq->avail->idx -
+			vq->last_used_idx_res;
+
+	/* A packed ring has no index: count the available descriptors */
+	idx = vq->last_used_idx;
+	wrap = vq->avail_wrap_counter;
+	while (n < vq->size && desc_is_avail(&vq->desc_packed[idx], wrap)) {
+		n++;
+		if (++idx == vq->size) {
+			idx = 0;
+			wrap ^= 1;
+		}
+	}
+	return n;
+}
+
+/**
+ * Binary search of the memory region containing a guest physical address.
+ * Returns the index of the region, or mem->nregions if there is none.
+ * The search has no data dependent branch, as the lookups of random
+ * addresses would mispredict them.
+ */
+static inline uint32_t __attribute__((always_inline))
+gpa_to_region(struct virtio_memory *mem, uint64_t guest_pa)
+{
+	struct virtio_memory_regions *region;
+	uint32_t base = 0, half, n = mem->nregions;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* find the last region starting at or below the address */
+	while (n > 1) {
+		half = n / 2;
+		base = mem->regions[base + half].guest_phys_address <=
+			guest_pa ? base + half : base;
+		n -= half;
+	}
+
+	region = &mem->regions[base];
+	if (guest_pa >= region->guest_phys_address &&
+			guest_pa < region->guest_phys_address_end)
+		return base;
+	return mem->nregions;
 }
 
 /**
@@ -155,19 +283,43 @@ rte_vring_available_entries(struct virtio_net *dev, uint16_t queue_id)
 static inline uint64_t __attribute__((always_inline))
 gpa_to_vva(struct virtio_net *dev, uint64_t guest_pa)
 {
-	struct virtio_memory_regions *region;
+	struct virtio_memory *mem = dev->mem;
 	uint32_t regionidx;
-	uint64_t vhost_va = 0;
-
-	for (regionidx = 0; regionidx < dev->mem->nregions; regionidx++) {
-		region = &dev->mem->regions[regionidx];
-		if ((guest_pa >= region->guest_phys_address) &&
-			(guest_pa <= region->guest_phys_address_end)) {
-			vhost_va = region->address_offset + guest_pa;
-			break;
-		}
+
+	regionidx = gpa_to_region(mem, guest_pa);
+	if (unlikely(regionidx == mem->nregions))
+		return 0;
+	return mem->regions[regionidx].address_offset + guest_pa;
+}
+
+/**
+ * Same as gpa_to_vva(), caching the last region found in the virtqueue.
+ * The buffers of a virtqueue are usually in the same region, so that most
+ * translations are done with a single comparison.
+ * This is used by the data path. The cached index is always checked, so that
+ * cores enqueuing concurrently to the same virtqueue may overwrite it.
+ */
+static inline uint64_t __attribute__((always_inline))
+vq_gpa_to_vva(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	uint64_t guest_pa)
+{
+	struct virtio_memory *mem = dev->mem;
+	struct virtio_memory_regions *region;
+	uint32_t regionidx = vq->last_region;
+
+	/* The index may be stale after a memory table update. */
+	if (likely(regionidx < mem->nregions)) {
+		region = &mem->regions[regionidx];
+		if (likely(guest_pa >= region->guest_phys_address &&
+				guest_pa < region->guest_phys_address_end))
+			return region->address_offset + guest_pa;
 	}
-	return vhost_va;
+
+	regionidx = gpa_to_region(mem, guest_pa);
+	if (unlikely(regionidx == mem->nregions))
+		return 0;
+	vq->last_region = regionidx;
+	return mem->regions[regionidx].address_offset + guest_pa;
 }
 
 /**
@@ -180,6 +332,21 @@ int rte_vhost_feature_disable(uint64_t feature_mask);
  */
 int rte_vhost_feature_enable(uint64_t feature_mask);
 
+/**
+ * Make rte_vhost_dequeue_burst() return mbufs pointing to the guest TX
+ * buffers instead of copies, for vhost-user devices whose memory is backed
+ * by hugepages. The descriptors are given back to the guest once the
+ * application has freed the mbufs. Only devices set up afterwards are
+ * affected. Returns 0 on success.
+ */
+int rte_vhost_dequeue_zero_copy_enable(void);
+
+/**
+ * Go back to copying the guest TX buffers on dequeue, for devices set up
+ * afterwards. Returns 0 on success.
+ */
+int rte_vhost_dequeue_zero_copy_disable(void);
+
 /* Returns currently supported vhost features */
 uint64_t rte_vhost_feature_get(void);
 
@@ -196,6 +363,18 @@ int rte_vhost_driver_callback_register(struct virtio_net_device_ops const * cons
 /* Start vhost driver session blocking loop. */
 int rte_vhost_driver_session_start(void);
 
+/**
+ * Get the number of queue pairs of a vhost device. The RX and TX virtqueues
+ * of queue pair n are n * VIRTIO_QNUM + VIRTIO_RXQ and
+ * n * VIRTIO_QNUM + VIRTIO_TXQ.
+ *
+ * @param dev
+ *  virtio-net device
+ * @return
+ *  number of queue pairs set up by the guest
+ */
+uint16_t rte_vhost_get_queue_num(struct virtio_net *dev);
+
 /**
  * This function adds buffers to the virtio devices RX virtqueue. Buffers can
  * be received from the physical port or from another virtual device. A packet
@@ -204,7 +383,7 @@ int rte_vhost_driver_session_start(void);
  * @param dev
  *  virtio-net device
  * @param queue_id
- *  virtio queue index in mq case
+ *  index of the RX virtqueue, n * VIRTIO_QNUM + VIRTIO_RXQ for queue pair n
  * @param pkts
  *  array to contain packets to be enqueued
  * @param count
@@ -222,7 +401,7 @@ uint16_t rte_vhost_enqueue_burst(struct virtio_net *dev, uint16_t queue_id,
  * @param dev
  *  virtio-net device
  * @param queue_id
- *  virtio queue index in mq case
+ *  index of the TX virtqueue, n * VIRTIO_QNUM + VIRTIO_TXQ for queue pair n
  * @param mbuf_pool
  *  mbuf_pool where host mbuf is allocated.
  * @param pkts
@@ -40,6 +40,7 @@
 #include <linux/vhost.h>
 
 #include <rte_log.h>
+#include <rte_mbuf.h>
 
 #include "rte_virtio_net.h"
 
@@ -77,6 +78,12 @@ extern struct vhost_net_device_ops const *ops;
 #endif
 
 
+/*
+ * Feature bit announcing the vhost-user protocol feature negotiation. It is
+ * only offered on vhost-user, on top of the features of the lib.
+ */
+#define VHOST_USER_F_PROTOCOL_FEATURES 30
+
 /*
  * Structure used to identify device context.
  */
@@ -113,6 +120,25 @@ struct vhost_net_device_ops {
 	int (*reset_owner)(struct vhost_device_ctx);
 };
 
+/*
+ * Point the segments of a zero-copy mbuf back to their own buffer.
+ */
+static inline void
+restore_mbuf(struct rte_mbuf *m)
+{
+	uint32_t mbuf_size;
+
+	for (; m != NULL; m = m->next) {
+		mbuf_size = sizeof(struct rte_mbuf) +
+			rte_pktmbuf_priv_size(m->pool);
+		m->buf_addr = (char *)m + mbuf_size;
+		m->buf_physaddr = rte_mempool_virt2phy(m->pool, m) + mbuf_size;
+		m->buf_len = rte_pktmbuf_data_room_size(m->pool);
+	}
+}
+
+void release_zmbufs(struct vhost_virtqueue *vq);
+int setup_guest_pages(struct virtio_net *dev, uint64_t page_size);
 
 struct vhost_net_device_ops const *get_virtio_net_callbacks(void);
 #endif /* _VHOST_NET_CDEV_H_ */
@@ -370,6 +370,7 @@ cuse_set_mem_table(struct vhost_device_ctx ctx,
 			pregion[idx].guest_phys_address;
 	}
 	dev->mem->nregions = valid_regions;
+	sort_mem_regions(dev->mem);
 
 	return 0;
 }
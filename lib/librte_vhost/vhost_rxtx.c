@@ -36,12 +36,106 @@
 
 #include <rte_mbuf.h>
 #include <rte_memcpy.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
 #include <rte_virtio_net.h>
 
 #include "vhost-net.h"
 
 #define MAX_PKT_BURST 32
 
+/*
+ * Below this length a zero-copy dequeue costs more than it saves, the
+ * packet is copied.
+ */
+#define VHOST_ZCOPY_MIN_LEN 512
+
+/* Features that make the RX path fill in the virtio-net header. */
+#define VHOST_RX_OFFLOAD_FEATURES ((1ULL << VIRTIO_NET_F_GUEST_CSUM) | \
+				(1ULL << VIRTIO_NET_F_GUEST_TSO4) | \
+				(1ULL << VIRTIO_NET_F_GUEST_TSO6))
+
+/* Features that let the guest hand us offload requests on TX. */
+#define VHOST_TX_OFFLOAD_FEATURES ((1ULL << VIRTIO_NET_F_CSUM) | \
+				(1ULL << VIRTIO_NET_F_HOST_TSO4) | \
+				(1ULL << VIRTIO_NET_F_HOST_TSO6))
+
+/*
+ * RX virtqueues have even indexes and TX virtqueues odd ones, within the
+ * queue pairs set up by the guest.
+ */
+static inline int __attribute__((always_inline))
+is_valid_virt_queue_idx(uint32_t idx, int is_tx, uint32_t qp_nb)
+{
+	return (is_tx ^ (idx & 1)) == 0 && idx < qp_nb * VIRTIO_QNUM;
+}
+
+/*
+ * Translate the mbuf TX offload requests into the virtio-net header handed
+ * to the guest. Checksum requests are only passed on when the guest
+ * negotiated GUEST_CSUM, segmentation when it negotiated the matching
+ * GUEST_TSO feature; the IPv4 header checksum has no virtio equivalent and
+ * is computed here.
+ */
+static inline void __attribute__((always_inline))
+virtio_enqueue_offload(struct virtio_net *dev, struct rte_mbuf *m,
+	struct virtio_net_hdr *net_hdr)
+{
+	uint64_t ol_flags = m->ol_flags;
+
+	if (ol_flags & PKT_TX_IP_CKSUM) {
+		struct ipv4_hdr *ipv4_hdr = rte_pktmbuf_mtod_offset(m,
+			struct ipv4_hdr *, m->l2_len);
+
+		ipv4_hdr->hdr_checksum = 0;
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+	}
+
+	if (!(dev->features & (1ULL << VIRTIO_NET_F_GUEST_CSUM)))
+		return;
+
+	/* TSO implies TCP checksum offload. */
+	if (ol_flags & PKT_TX_TCP_SEG)
+		ol_flags |= PKT_TX_TCP_CKSUM;
+
+	if (ol_flags & PKT_TX_L4_MASK) {
+		net_hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		net_hdr->csum_start = m->l2_len + m->l3_len;
+
+		switch (ol_flags & PKT_TX_L4_MASK) {
+		case PKT_TX_TCP_CKSUM:
+			net_hdr->csum_offset = offsetof(struct tcp_hdr, cksum);
+			break;
+		case PKT_TX_UDP_CKSUM:
+			net_hdr->csum_offset = offsetof(struct udp_hdr,
+				dgram_cksum);
+			break;
+		default:
+			/* SCTP uses CRC32c, which virtio cannot offload. */
+			net_hdr->flags = 0;
+			net_hdr->csum_start = 0;
+			break;
+		}
+	}
+
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		uint8_t gso_type = (ol_flags & PKT_TX_IPV4) ?
+			VIRTIO_NET_HDR_GSO_TCPV4 : VIRTIO_NET_HDR_GSO_TCPV6;
+		uint32_t feature = (gso_type == VIRTIO_NET_HDR_GSO_TCPV4) ?
+			VIRTIO_NET_F_GUEST_TSO4 : VIRTIO_NET_F_GUEST_TSO6;
+
+		if (dev->features & (1ULL << feature)) {
+			net_hdr->gso_type = gso_type;
+			net_hdr->gso_size = m->tso_segsz;
+			net_hdr->hdr_len = m->l2_len + m->l3_len + m->l4_len;
+			/* virtio has the frame length in the pseudo-header */
+			rte_tcp_phdr_cksum_set(m, 0);
+		}
+	}
+}
+
 /**
  * This function adds buffers to the virtio devices RX virtqueue. Buffers can
  * be received from the physical port or from another virtio device. A packet
@@ -66,14 +160,19 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	uint16_t res_base_idx, res_end_idx;
 	uint16_t free_entries;
 	uint8_t success = 0;
+	const int offload = !!(dev->features & VHOST_RX_OFFLOAD_FEATURES);
 
 	LOG_DEBUG(VHOST_DATA, "(%"PRIu64") virtio_dev_rx()\n", dev->device_fh);
-	if (unlikely(queue_id != VIRTIO_RXQ)) {
-		LOG_DEBUG(VHOST_DATA, "mq isn't supported in this version.\n");
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->virt_qp_nb))) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%"PRIu64") %s: invalid virtqueue idx %d.\n",
+			dev->device_fh, __func__, queue_id);
 		return 0;
 	}
 
-	vq = dev->virtqueue[VIRTIO_RXQ];
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0))
+		return 0;
 	count = (count > MAX_PKT_BURST) ? MAX_PKT_BURST : count;
 
 	/*
@@ -123,8 +222,13 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 
 		buff = pkts[packet_success];
 
+		if (offload) {
+			memset(&virtio_hdr.hdr, 0, sizeof(virtio_hdr.hdr));
+			virtio_enqueue_offload(dev, buff, &virtio_hdr.hdr);
+		}
+
 		/* Convert from gpa to vva (guest physical addr -> vhost virtual addr) */
-		buff_addr = gpa_to_vva(dev, desc->addr);
+		buff_addr = vq_gpa_to_vva(dev, vq, desc->addr);
 		/* Prefetch buffer address. */
 		rte_prefetch0((void *)(uintptr_t)buff_addr);
 
@@ -139,7 +243,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 			(desc->len == vq->vhost_hlen)) {
 			desc = &vq->desc[desc->next];
 			/* Buffer address translation. */
-			buff_addr = gpa_to_vva(dev, desc->addr);
+			buff_addr = vq_gpa_to_vva(dev, vq, desc->addr);
 		} else {
 			vb_offset += vq->vhost_hlen;
 			hdr = 1;
@@ -176,7 +280,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 			if (vb_offset == desc->len) {
 				if (desc->flags & VRING_DESC_F_NEXT) {
 					desc = &vq->desc[desc->next];
-					buff_addr = gpa_to_vva(dev, desc->addr);
+					buff_addr = vq_gpa_to_vva(dev, vq, desc->addr);
 					vb_offset = 0;
 				} else {
 					/* Room in vring buffer is not enough */
@@ -235,8 +339,8 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 }
 
 static inline uint32_t __attribute__((always_inline))
-copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
-	uint16_t res_end_idx, struct rte_mbuf *pkt)
+copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t queue_id,
+	uint16_t res_base_idx, uint16_t res_end_idx, struct rte_mbuf *pkt)
 {
 	uint32_t vec_idx = 0;
 	uint32_t entry_success = 0;
@@ -264,14 +368,16 @@ copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
 	 * Convert from gpa to vva
 	 * (guest physical addr -> vhost virtual addr)
 	 */
-	vq = dev->virtqueue[VIRTIO_RXQ];
-	vb_addr = gpa_to_vva(dev, vq->buf_vec[vec_idx].buf_addr);
+	vq = dev->virtqueue[queue_id];
+	vb_addr = vq_gpa_to_vva(dev, vq, vq->buf_vec[vec_idx].buf_addr);
 	vb_hdr_addr = vb_addr;
 
 	/* Prefetch buffer address. */
 	rte_prefetch0((void *)(uintptr_t)vb_addr);
 
 	virtio_hdr.num_buffers = res_end_idx - res_base_idx;
+	if (dev->features & VHOST_RX_OFFLOAD_FEATURES)
+		virtio_enqueue_offload(dev, pkt, &virtio_hdr.hdr);
 
 	LOG_DEBUG(VHOST_DATA, "(%"PRIu64") RX: Num merge buffers %d\n",
 		dev->device_fh, virtio_hdr.num_buffers);
@@ -305,7 +411,7 @@ copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
 		}
 
 		vec_idx++;
-		vb_addr = gpa_to_vva(dev, vq->buf_vec[vec_idx].buf_addr);
+		vb_addr = vq_gpa_to_vva(dev, vq, vq->buf_vec[vec_idx].buf_addr);
 
 		/* Prefetch buffer address. */
 		rte_prefetch0((void *)(uintptr_t)vb_addr);
@@ -350,7 +456,7 @@ copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
 			}
 
 			vec_idx++;
-			vb_addr = gpa_to_vva(dev,
+			vb_addr = vq_gpa_to_vva(dev, vq,
 				vq->buf_vec[vec_idx].buf_addr);
 			vb_offset = 0;
 			vb_avail = vq->buf_vec[vec_idx].buf_len;
@@ -393,7 +499,7 @@ copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
 
 					/* Get next buffer from buf_vec. */
 					vec_idx++;
-					vb_addr = gpa_to_vva(dev,
+					vb_addr = vq_gpa_to_vva(dev, vq,
 						vq->buf_vec[vec_idx].buf_addr);
 					vb_avail =
 						vq->buf_vec[vec_idx].buf_len;
@@ -464,11 +570,16 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 
 	LOG_DEBUG(VHOST_DATA, "(%"PRIu64") virtio_dev_merge_rx()\n",
 		dev->device_fh);
-	if (unlikely(queue_id != VIRTIO_RXQ)) {
-		LOG_DEBUG(VHOST_DATA, "mq isn't supported in this version.\n");
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->virt_qp_nb))) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%"PRIu64") %s: invalid virtqueue idx %d.\n",
+			dev->device_fh, __func__, queue_id);
+		return 0;
 	}
 
-	vq = dev->virtqueue[VIRTIO_RXQ];
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0))
+		return 0;
 	count = RTE_MIN((uint32_t)MAX_PKT_BURST, count);
 
 	if (count == 0)
@@ -509,8 +620,8 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 							res_cur_idx);
 		} while (success == 0);
 
-		entry_success = copy_from_mbuf_to_vring(dev, res_base_idx,
-			res_cur_idx, pkts[pkt_idx]);
+		entry_success = copy_from_mbuf_to_vring(dev, queue_id,
+			res_base_idx, res_cur_idx, pkts[pkt_idx]);
 
 		rte_compiler_barrier();
 
@@ -535,16 +646,624 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	return count;
 }
 
+/*
+ * Packed vrings: the guest makes descriptor chains available in ring
+ * order, and they are marked used in place, in the same order, as the
+ * paths below complete them in the order they take them. last_used_idx
+ * and avail_wrap_counter are thus both the next descriptor to look at and
+ * the next one to mark used. There is no reservation: a packed RX vring
+ * must only be enqueued to by one core at a time.
+ */
+
+/* A descriptor chain taken from a packed vring, to be marked used. */
+struct packed_used_elem {
+	uint16_t idx;	/* position of the chain in the ring */
+	uint16_t id;	/* buffer id of the chain */
+	uint16_t wrap;	/* wrap counter at that position */
+	uint32_t len;	/* room in the chain, then bytes written to it */
+};
+
+static inline void __attribute__((always_inline))
+packed_idx_add(struct vhost_virtqueue *vq, uint16_t *idx, uint16_t *wrap,
+	uint16_t n)
+{
+	*idx += n;
+	if (*idx >= vq->size) {
+		*idx -= vq->size;
+		*wrap ^= 1;
+	}
+}
+
+static inline uint16_t __attribute__((always_inline))
+packed_used_flags(uint16_t wrap, uint16_t flags)
+{
+	return wrap ? flags | (1 << VRING_PACKED_DESC_F_AVAIL) |
+		(1 << VRING_PACKED_DESC_F_USED) : flags;
+}
+
+/*
+ * Gather the descriptor chain available at idx into buf_vec, from
+ * *vec_idx on. Returns the number of descriptors of the chain, or 0 when
+ * there is none or it does not fit in buf_vec.
+ */
+static inline uint16_t __attribute__((always_inline))
+fill_vec_buf_packed(struct vhost_virtqueue *vq, uint16_t idx, uint16_t wrap,
+	uint32_t *vec_idx, struct packed_used_elem *elem)
+{
+	struct vring_packed_desc *desc;
+	uint32_t vec_id = *vec_idx;
+	uint16_t n = 0;
+
+	if (!desc_is_avail(&vq->desc_packed[idx], wrap))
+		return 0;
+	/* Read the descriptors only once they are available. */
+	rte_compiler_barrier();
+
+	elem->idx = idx;
+	elem->wrap = wrap;
+	elem->len = 0;
+	do {
+		if (unlikely(vec_id == BUF_VECTOR_MAX || n == vq->size))
+			return 0;
+		desc = &vq->desc_packed[idx];
+		vq->buf_vec[vec_id].buf_addr = desc->addr;
+		vq->buf_vec[vec_id].buf_len = desc->len;
+		vq->buf_vec[vec_id].desc_idx = idx;
+		elem->len += desc->len;
+		elem->id = desc->id;
+		vec_id++;
+		n++;
+		if (++idx == vq->size)
+			idx = 0;
+	} while (desc->flags & VRING_DESC_F_NEXT);
+
+	*vec_idx = vec_id;
+	return n;
+}
+
+/*
+ * Copy len bytes to the guest buffers gathered in buf_vec, from buffer
+ * *vec_idx at *vb_offset on. The caller made sure they have the room.
+ */
+static inline int __attribute__((always_inline))
+copy_to_vec(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	uint32_t *vec_idx, uint32_t *vb_offset, const void *src, uint32_t len)
+{
+	struct buf_vector *buf;
+	uint64_t vb_addr;
+	uint32_t cpy_len;
+
+	while (len != 0) {
+		buf = &vq->buf_vec[*vec_idx];
+		if (*vb_offset == buf->buf_len) {
+			(*vec_idx)++;
+			*vb_offset = 0;
+			continue;
+		}
+
+		vb_addr = vq_gpa_to_vva(dev, vq, buf->buf_addr);
+		if (unlikely(vb_addr == 0))
+			return -1;
+		cpy_len = RTE_MIN(len, buf->buf_len - *vb_offset);
+		rte_memcpy((void *)(uintptr_t)(vb_addr + *vb_offset), src,
+			cpy_len);
+		PRINT_PACKET(dev, (uintptr_t)(vb_addr + *vb_offset),
+			cpy_len, 0);
+
+		src = (const char *)src + cpy_len;
+		len -= cpy_len;
+		*vb_offset += cpy_len;
+	}
+
+	return 0;
+}
+
+/*
+ * Enqueue to a packed RX vring. Without mergeable RX buffers a packet
+ * takes one descriptor chain, with them as many chains as needed, each
+ * being marked used with the number of bytes written to it. The flags of
+ * the first descriptor of the burst are written last, so that the guest
+ * sees the whole burst at once.
+ */
+static inline uint32_t __attribute__((always_inline))
+virtio_dev_rx_packed(struct virtio_net *dev, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint32_t count)
+{
+	struct vhost_virtqueue *vq;
+	struct packed_used_elem used[BUF_VECTOR_MAX];
+	struct virtio_net_hdr_mrg_rxbuf virtio_hdr;
+	const int mergeable =
+		!!(dev->features & (1ULL << VIRTIO_NET_F_MRG_RXBUF));
+	const int offload = !!(dev->features & VHOST_RX_OFFLOAD_FEATURES);
+	uint16_t head_idx, head_flags = 0;
+	uint32_t pkt_idx, i;
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->virt_qp_nb))) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%"PRIu64") %s: invalid virtqueue idx %d.\n",
+			dev->device_fh, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0))
+		return 0;
+	count = RTE_MIN((uint32_t)MAX_PKT_BURST, count);
+	head_idx = vq->last_used_idx;
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		struct rte_mbuf *m = pkts[pkt_idx];
+		uint32_t size = m->pkt_len + vq->vhost_hlen;
+		uint32_t room = 0, vec_idx = 0, vb_offset = 0, left;
+		uint16_t idx = vq->last_used_idx;
+		uint16_t wrap = vq->avail_wrap_counter;
+		uint16_t nr_used = 0, n;
+		int dropped;
+
+		do {
+			n = fill_vec_buf_packed(vq, idx, wrap, &vec_idx,
+				&used[nr_used]);
+			if (n == 0)
+				break;
+			room += used[nr_used].len;
+			nr_used++;
+			packed_idx_add(vq, &idx, &wrap, n);
+		} while (mergeable && room < size);
+
+		/* Out of buffers, the packet is left to the caller. */
+		if (nr_used == 0 || (mergeable && room < size))
+			break;
+
+		memset(&virtio_hdr, 0, sizeof(virtio_hdr));
+		virtio_hdr.num_buffers = nr_used;
+		if (offload)
+			virtio_enqueue_offload(dev, m, &virtio_hdr.hdr);
+
+		/*
+		 * Like on a split vring, a packet which does not fit in the
+		 * chain is dropped with only the header length written.
+		 */
+		dropped = room < size;
+		if (!dropped) {
+			vec_idx = 0;
+			dropped = copy_to_vec(dev, vq, &vec_idx, &vb_offset,
+				&virtio_hdr, vq->vhost_hlen) < 0;
+			for (; m != NULL && !dropped; m = m->next)
+				dropped = copy_to_vec(dev, vq, &vec_idx,
+					&vb_offset, rte_pktmbuf_mtod(m, void *),
+					m->data_len) < 0;
+		}
+
+		left = dropped ? vq->vhost_hlen : size;
+		for (i = 0; i < nr_used; i++) {
+			used[i].len = RTE_MIN(used[i].len, left);
+			left -= used[i].len;
+			vq->desc_packed[used[i].idx].id = used[i].id;
+			vq->desc_packed[used[i].idx].len = used[i].len;
+		}
+		rte_compiler_barrier();
+		for (i = 0; i < nr_used; i++) {
+			uint16_t flags = packed_used_flags(used[i].wrap,
+				VRING_DESC_F_WRITE);
+
+			if (used[i].idx == head_idx && pkt_idx == 0 && i == 0)
+				head_flags = flags;
+			else
+				vq->desc_packed[used[i].idx].flags = flags;
+		}
+
+		vq->last_used_idx = idx;
+		vq->avail_wrap_counter = wrap;
+	}
+
+	if (pkt_idx == 0)
+		return 0;
+
+	rte_compiler_barrier();
+	vq->desc_packed[head_idx].flags = head_flags;
+
+	/* flush the used descriptors before we read the event flags. */
+	rte_mb();
+
+	/* Kick the guest if necessary. */
+	if (vq->driver_event->flags != VRING_PACKED_EVENT_FLAG_DISABLE)
+		eventfd_write((int)vq->callfd, 1);
+	return pkt_idx;
+}
+
 uint16_t
 rte_vhost_enqueue_burst(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mbuf **pkts, uint16_t count)
 {
-	if (unlikely(dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)))
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		return virtio_dev_rx_packed(dev, queue_id, pkts, count);
+	else if (unlikely(dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)))
 		return virtio_dev_merge_rx(dev, queue_id, pkts, count);
 	else
 		return virtio_dev_rx(dev, queue_id, pkts, count);
 }
 
+/*
+ * Fill l2_len/l3_len and the IP version flag from the packet headers, and
+ * return the L4 protocol and header. Headers are expected in the first
+ * segment; l4_hdr is left NULL when they are not there or not IP.
+ */
+static inline void __attribute__((always_inline))
+parse_ethernet(struct rte_mbuf *m, uint16_t *l4_proto, void **l4_hdr)
+{
+	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	uint16_t ethertype = rte_be_to_cpu_16(eth_hdr->ether_type);
+	struct ipv4_hdr *ipv4_hdr;
+	struct ipv6_hdr *ipv6_hdr;
+	void *l3_hdr;
+
+	m->l2_len = sizeof(struct ether_hdr);
+	if (ethertype == ETHER_TYPE_VLAN) {
+		struct vlan_hdr *vlan_hdr = (struct vlan_hdr *)(eth_hdr + 1);
+
+		m->l2_len += sizeof(struct vlan_hdr);
+		ethertype = rte_be_to_cpu_16(vlan_hdr->eth_proto);
+	}
+
+	l3_hdr = (char *)eth_hdr + m->l2_len;
+
+	switch (ethertype) {
+	case ETHER_TYPE_IPv4:
+		ipv4_hdr = (struct ipv4_hdr *)l3_hdr;
+		*l4_proto = ipv4_hdr->next_proto_id;
+		m->l3_len = (ipv4_hdr->version_ihl & 0x0f) * 4;
+		m->ol_flags |= PKT_TX_IPV4;
+		break;
+	case ETHER_TYPE_IPv6:
+		ipv6_hdr = (struct ipv6_hdr *)l3_hdr;
+		*l4_proto = ipv6_hdr->proto;
+		m->l3_len = sizeof(struct ipv6_hdr);
+		m->ol_flags |= PKT_TX_IPV6;
+		break;
+	default:
+		m->l3_len = 0;
+		*l4_proto = 0;
+		*l4_hdr = NULL;
+		return;
+	}
+
+	if (m->l2_len + m->l3_len + sizeof(struct tcp_hdr) > m->data_len)
+		*l4_hdr = NULL;
+	else
+		*l4_hdr = (char *)l3_hdr + m->l3_len;
+}
+
+/*
+ * Translate the virtio-net header the guest put in front of a packet into
+ * mbuf TX offload requests, so that the packet can be handed to a NIC
+ * that completes the checksum or segments it.
+ */
+static inline void __attribute__((always_inline))
+vhost_dequeue_offload(struct virtio_net_hdr *hdr, struct rte_mbuf *m)
+{
+	uint16_t l4_proto = 0;
+	void *l4_hdr = NULL;
+	struct tcp_hdr *tcp_hdr;
+
+	if (hdr->flags == 0 && hdr->gso_type == VIRTIO_NET_HDR_GSO_NONE)
+		return;
+
+	parse_ethernet(m, &l4_proto, &l4_hdr);
+	if (l4_hdr == NULL)
+		return;
+
+	if (hdr->flags == VIRTIO_NET_HDR_F_NEEDS_CSUM &&
+			hdr->csum_start == m->l2_len + m->l3_len) {
+		switch (hdr->csum_offset) {
+		case (offsetof(struct tcp_hdr, cksum)):
+			if (l4_proto == IPPROTO_TCP)
+				m->ol_flags |= PKT_TX_TCP_CKSUM;
+			break;
+		case (offsetof(struct udp_hdr, dgram_cksum)):
+			if (l4_proto == IPPROTO_UDP)
+				m->ol_flags |= PKT_TX_UDP_CKSUM;
+			break;
+		}
+	}
+
+	switch (hdr->gso_type & ~VIRTIO_NET_HDR_GSO_ECN) {
+	case VIRTIO_NET_HDR_GSO_NONE:
+		break;
+	case VIRTIO_NET_HDR_GSO_TCPV4:
+	case VIRTIO_NET_HDR_GSO_TCPV6:
+		if (l4_proto != IPPROTO_TCP)
+			break;
+		tcp_hdr = (struct tcp_hdr *)l4_hdr;
+		m->ol_flags |= PKT_TX_TCP_SEG;
+		m->tso_segsz = hdr->gso_size;
+		m->l4_len = (tcp_hdr->data_off & 0xf0) >> 2;
+		if (m->ol_flags & PKT_TX_IPV4) {
+			struct ipv4_hdr *ipv4_hdr = rte_pktmbuf_mtod_offset(m,
+				struct ipv4_hdr *, m->l2_len);
+
+			/* The NIC rewrites it for every segment. */
+			ipv4_hdr->hdr_checksum = 0;
+			m->ol_flags |= PKT_TX_IP_CKSUM;
+		}
+		/* The guest seeded it with the frame length, DPDK TSO not. */
+		rte_tcp_phdr_cksum_set(m, PKT_TX_TCP_SEG);
+		break;
+	default:
+		RTE_LOG(WARNING, VHOST_DATA,
+			"unsupported gso type %u.\n", hdr->gso_type);
+		break;
+	}
+}
+
+/*
+ * Translate a guest physical buffer to a host physical address, for the
+ * NIC. Returns 0 when the buffer is not contiguous in host memory.
+ */
+static inline uint64_t __attribute__((always_inline))
+gpa_to_hpa(struct virtio_net *dev, uint64_t gpa, uint64_t size)
+{
+	struct guest_page *page;
+	uint32_t lo = 0, hi = dev->nr_guest_pages;
+
+	/* Find the last page starting at or below gpa. */
+	while (hi - lo > 1) {
+		uint32_t mid = (lo + hi) / 2;
+
+		if (dev->guest_pages[mid].guest_phys_addr <= gpa)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	if (unlikely(hi == 0))
+		return 0;
+
+	page = &dev->guest_pages[lo];
+	if (gpa < page->guest_phys_addr ||
+			gpa + size > page->guest_phys_addr + page->size)
+		return 0;
+	return page->host_phys_addr + gpa - page->guest_phys_addr;
+}
+
+/*
+ * Build an mbuf chain pointing to the guest buffers of a TX descriptor
+ * chain, one segment per descriptor. vhost keeps a reference to every
+ * segment until the descriptors go back to the guest. Returns NULL, for
+ * the packet to be copied, when it is small or not contiguous in host
+ * physical memory.
+ */
+static inline struct rte_mbuf * __attribute__((always_inline))
+dequeue_zcopy_pkt(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	struct vring_desc *desc, uint32_t vb_offset,
+	struct rte_mempool *mbuf_pool)
+{
+	struct vring_desc *d;
+	struct rte_mbuf *m = NULL, *cur, *prev = NULL;
+	uint32_t pkt_len = 0, len, offset;
+	uint64_t gpa, hpa, vva;
+	uint16_t nb_segs = 0;
+
+	for (d = desc, offset = vb_offset; ; d = &vq->desc[d->next]) {
+		pkt_len += d->len - offset;
+		offset = 0;
+		if (!(d->flags & VRING_DESC_F_NEXT))
+			break;
+	}
+	if (pkt_len < VHOST_ZCOPY_MIN_LEN)
+		return NULL;
+
+	for (d = desc, offset = vb_offset; ; d = &vq->desc[d->next]) {
+		len = d->len - offset;
+		if (len != 0) {
+			if (unlikely(len > UINT16_MAX))
+				goto fallback;
+			gpa = d->addr + offset;
+			hpa = gpa_to_hpa(dev, gpa, len);
+			vva = vq_gpa_to_vva(dev, vq, gpa);
+			if (unlikely(hpa == 0 || vva == 0))
+				goto fallback;
+
+			cur = rte_pktmbuf_alloc(mbuf_pool);
+			if (unlikely(cur == NULL))
+				goto fallback;
+			cur->buf_addr = (void *)(uintptr_t)vva;
+			cur->buf_physaddr = hpa;
+			cur->buf_len = (uint16_t)len;
+			cur->data_off = 0;
+			cur->data_len = (uint16_t)len;
+			if (prev != NULL)
+				prev->next = cur;
+			else
+				m = cur;
+			prev = cur;
+			nb_segs++;
+		}
+		offset = 0;
+		if (!(d->flags & VRING_DESC_F_NEXT))
+			break;
+	}
+
+	m->nb_segs = nb_segs;
+	m->pkt_len = pkt_len;
+	for (cur = m; cur != NULL; cur = cur->next)
+		rte_mbuf_refcnt_update(cur, 1);
+	return m;
+
+fallback:
+	if (m != NULL) {
+		restore_mbuf(m);
+		rte_pktmbuf_free(m);
+	}
+	return NULL;
+}
+
+/*
+ * Give back to the guest the descriptors of the zero-copy mbufs the
+ * application has freed, i.e. of which vhost holds the last reference.
+ */
+static inline void __attribute__((always_inline))
+update_used_zmbufs(struct vhost_virtqueue *vq)
+{
+	struct zcopy_mbuf *zmbuf;
+	uint16_t used_idx = vq->used->idx;
+	uint16_t i = 0, nr_returned = 0;
+
+	while (i < vq->nr_zmbufs) {
+		zmbuf = &vq->zmbufs[i];
+		if (rte_mbuf_refcnt_read(zmbuf->mbuf) != 1) {
+			i++;
+			continue;
+		}
+
+		vq->used->ring[used_idx & (vq->size - 1)].id = zmbuf->desc_idx;
+		vq->used->ring[used_idx & (vq->size - 1)].len = 0;
+		used_idx++;
+		nr_returned++;
+
+		restore_mbuf(zmbuf->mbuf);
+		rte_pktmbuf_free(zmbuf->mbuf);
+		*zmbuf = vq->zmbufs[--vq->nr_zmbufs];
+	}
+
+	if (nr_returned == 0)
+		return;
+
+	rte_compiler_barrier();
+	vq->used->idx = used_idx;
+	/* Kick guest if required. */
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+		eventfd_write((int)vq->callfd, 1);
+}
+
+/*
+ * Copy the packet in the guest buffers gathered in buf_vec, past the
+ * virtio-net header, to a newly allocated mbuf chain.
+ */
+static inline struct rte_mbuf * __attribute__((always_inline))
+copy_vec_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	uint32_t nr_vec, struct rte_mempool *mbuf_pool)
+{
+	struct rte_mbuf *m, *cur;
+	uint32_t vec_idx, vb_offset = vq->vhost_hlen;
+	uint32_t seg_avail, cpy_len, len;
+	uint64_t vb_addr;
+
+	m = rte_pktmbuf_alloc(mbuf_pool);
+	if (unlikely(m == NULL))
+		return NULL;
+	cur = m;
+	seg_avail = rte_pktmbuf_tailroom(cur);
+
+	for (vec_idx = 0; vec_idx < nr_vec; vec_idx++) {
+		len = vq->buf_vec[vec_idx].buf_len;
+		if (vb_offset >= len) {
+			/* The header may span more than one buffer. */
+			vb_offset -= len;
+			continue;
+		}
+
+		vb_addr = vq_gpa_to_vva(dev, vq,
+			vq->buf_vec[vec_idx].buf_addr);
+		if (unlikely(vb_addr == 0))
+			goto fail;
+		PRINT_PACKET(dev, (uintptr_t)(vb_addr + vb_offset),
+			len - vb_offset, 0);
+
+		while (vb_offset < len) {
+			if (seg_avail == 0) {
+				cur->next = rte_pktmbuf_alloc(mbuf_pool);
+				if (unlikely(cur->next == NULL))
+					goto fail;
+				cur = cur->next;
+				m->nb_segs++;
+				seg_avail = rte_pktmbuf_tailroom(cur);
+			}
+
+			cpy_len = RTE_MIN(len - vb_offset, seg_avail);
+			rte_memcpy(rte_pktmbuf_mtod_offset(cur, void *,
+					cur->data_len),
+				(void *)(uintptr_t)(vb_addr + vb_offset),
+				cpy_len);
+			cur->data_len += cpy_len;
+			m->pkt_len += cpy_len;
+			vb_offset += cpy_len;
+			seg_avail -= cpy_len;
+		}
+		vb_offset = 0;
+	}
+
+	return m;
+
+fail:
+	RTE_LOG(ERR, VHOST_DATA, "Failed to allocate memory for mbuf.\n");
+	rte_pktmbuf_free(m);
+	return NULL;
+}
+
+/*
+ * Dequeue from a packed TX vring. Packets are always copied. Like on
+ * enqueue, the flags of the first descriptor of the burst are written
+ * last.
+ */
+static inline uint16_t __attribute__((always_inline))
+virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
+{
+	struct packed_used_elem used;
+	struct virtio_net_hdr *hdr;
+	const int offload = !!(dev->features & VHOST_TX_OFFLOAD_FEATURES);
+	uint16_t head_idx = vq->last_used_idx, head_flags = 0;
+	uint16_t idx, wrap, n, pkt_idx;
+	uint32_t nr_vec;
+
+	count = RTE_MIN(count, (uint16_t)MAX_PKT_BURST);
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		idx = vq->last_used_idx;
+		wrap = vq->avail_wrap_counter;
+		nr_vec = 0;
+		n = fill_vec_buf_packed(vq, idx, wrap, &nr_vec, &used);
+		if (n == 0)
+			break;
+
+		pkts[pkt_idx] = copy_vec_to_mbuf(dev, vq, nr_vec, mbuf_pool);
+		if (unlikely(pkts[pkt_idx] == NULL))
+			break;
+
+		if (offload && vq->buf_vec[0].buf_len >= vq->vhost_hlen) {
+			hdr = (struct virtio_net_hdr *)(uintptr_t)
+				vq_gpa_to_vva(dev, vq, vq->buf_vec[0].buf_addr);
+			if (hdr != NULL)
+				vhost_dequeue_offload(hdr, pkts[pkt_idx]);
+		}
+
+		vq->desc_packed[idx].id = used.id;
+		vq->desc_packed[idx].len = 0;
+		rte_compiler_barrier();
+		if (pkt_idx == 0)
+			head_flags = packed_used_flags(wrap, 0);
+		else
+			vq->desc_packed[idx].flags = packed_used_flags(wrap, 0);
+
+		packed_idx_add(vq, &idx, &wrap, n);
+		vq->last_used_idx = idx;
+		vq->avail_wrap_counter = wrap;
+	}
+
+	if (pkt_idx == 0)
+		return 0;
+
+	rte_compiler_barrier();
+	vq->desc_packed[head_idx].flags = head_flags;
+
+	/* flush the used descriptors before we read the event flags. */
+	rte_mb();
+
+	/* Kick guest if required. */
+	if (vq->driver_event->flags != VRING_PACKED_EVENT_FLAG_DISABLE)
+		eventfd_write((int)vq->callfd, 1);
+	return pkt_idx;
+}
+
 uint16_t
 rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
@@ -557,14 +1276,32 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 	uint32_t used_idx;
 	uint32_t i;
 	uint16_t free_entries, entry_success = 0;
-	uint16_t avail_idx;
-
-	if (unlikely(queue_id != VIRTIO_TXQ)) {
-		LOG_DEBUG(VHOST_DATA, "mq isn't supported in this version.\n");
+	uint16_t avail_idx, used_base, nr_used = 0;
+	const int offload = !!(dev->features & VHOST_TX_OFFLOAD_FEATURES);
+	/* With in-order, the last used entry stands for the whole burst. */
+	const int in_order = !!(dev->features & (1ULL << VIRTIO_F_IN_ORDER));
+	int zcopy;
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 1, dev->virt_qp_nb))) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%"PRIu64") %s: invalid virtqueue idx %d.\n",
+			dev->device_fh, __func__, queue_id);
 		return 0;
 	}
 
-	vq = dev->virtqueue[VIRTIO_TXQ];
+	vq = dev->virtqueue[queue_id];
+	if (unlikely(vq->enabled == 0))
+		return 0;
+
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		return virtio_dev_tx_packed(dev, vq, mbuf_pool, pkts, count);
+
+	zcopy = dev->dequeue_zero_copy && vq->zmbufs != NULL;
+	if (zcopy && vq->nr_zmbufs != 0)
+		update_used_zmbufs(vq);
+	/* Descriptors copied from go back right away, after the above. */
+	used_base = vq->used->idx;
+
 	avail_idx =  *((volatile uint16_t *)&vq->avail->idx);
 
 	/* If there are no available buffers then return. */
@@ -592,7 +1329,7 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 
 	/* Prefetch descriptor index. */
 	rte_prefetch0(&vq->desc[head[entry_success]]);
-	rte_prefetch0(&vq->used->ring[vq->last_used_idx & (vq->size - 1)]);
+	rte_prefetch0(&vq->used->ring[used_base & (vq->size - 1)]);
 
 	while (entry_success < free_entries) {
 		uint32_t vb_avail, vb_offset;
@@ -600,9 +1337,13 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 		uint32_t cpy_len;
 		uint32_t seg_num = 0;
 		struct rte_mbuf *cur;
+		struct virtio_net_hdr *hdr = NULL;
 		uint8_t alloc_err = 0;
 
 		desc = &vq->desc[head[entry_success]];
+		if (offload)
+			hdr = (struct virtio_net_hdr *)(uintptr_t)
+				vq_gpa_to_vva(dev, vq, desc->addr);
 
 		/* Discard first buffer as it is the virtio header */
 		if (desc->flags & VRING_DESC_F_NEXT) {
@@ -614,12 +1355,38 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 			vb_avail = desc->len - vb_offset;
 		}
 
+		/*
+		 * A guest can post more buffers than the ring holds while the
+		 * application keeps the zero-copy mbufs: once all the slots
+		 * reclaimed above are in use, copy.
+		 */
+		if (zcopy && vq->nr_zmbufs < vq->size) {
+			m = dequeue_zcopy_pkt(dev, vq, desc, vb_offset,
+				mbuf_pool);
+			if (m != NULL) {
+				vq->zmbufs[vq->nr_zmbufs].mbuf = m;
+				vq->zmbufs[vq->nr_zmbufs].desc_idx =
+					head[entry_success];
+				vq->nr_zmbufs++;
+				if (offload)
+					vhost_dequeue_offload(hdr, m);
+
+				pkts[entry_success] = m;
+				vq->last_used_idx++;
+				entry_success++;
+				if (entry_success < free_entries)
+					rte_prefetch0(
+						&vq->desc[head[entry_success]]);
+				continue;
+			}
+		}
+
 		/* Buffer address translation. */
-		vb_addr = gpa_to_vva(dev, desc->addr);
+		vb_addr = vq_gpa_to_vva(dev, vq, desc->addr);
 		/* Prefetch buffer address. */
 		rte_prefetch0((void *)(uintptr_t)vb_addr);
 
-		used_idx = vq->last_used_idx & (vq->size - 1);
+		used_idx = (used_base + nr_used) & (vq->size - 1);
 
 		if (entry_success < (free_entries - 1)) {
 			/* Prefetch descriptor index. */
@@ -628,8 +1395,10 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 		}
 
 		/* Update used index buffer information. */
-		vq->used->ring[used_idx].id = head[entry_success];
-		vq->used->ring[used_idx].len = 0;
+		if (!in_order) {
+			vq->used->ring[used_idx].id = head[entry_success];
+			vq->used->ring[used_idx].len = 0;
+		}
 
 		/* Allocate an mbuf and populate the structure. */
 		m = rte_pktmbuf_alloc(mbuf_pool);
@@ -719,7 +1488,7 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 					desc = &vq->desc[desc->next];
 
 					/* Buffer address translation. */
-					vb_addr = gpa_to_vva(dev, desc->addr);
+					vb_addr = vq_gpa_to_vva(dev, vq, desc->addr);
 					/* Prefetch buffer address. */
 					rte_prefetch0((void *)(uintptr_t)vb_addr);
 					vb_offset = 0;
@@ -742,14 +1511,26 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 			break;
 
 		m->nb_segs = seg_num;
+		if (offload)
+			vhost_dequeue_offload(hdr, m);
 
 		pkts[entry_success] = m;
 		vq->last_used_idx++;
 		entry_success++;
+		nr_used++;
+	}
+
+	if (nr_used == 0)
+		return entry_success;
+
+	if (in_order) {
+		used_idx = (used_base + nr_used - 1) & (vq->size - 1);
+		vq->used->ring[used_idx].id = head[entry_success - 1];
+		vq->used->ring[used_idx].len = 0;
 	}
 
 	rte_compiler_barrier();
-	vq->used->idx += entry_success;
+	vq->used->idx = used_base + nr_used;
 	/* Kick guest if required. */
 	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
 		eventfd_write((int)vq->callfd, 1);
@@ -102,7 +102,7 @@ user_set_mem_table(struct vhost_device_ctx ctx, struct VhostUserMsg *pmsg)
 	struct virtio_net *dev;
 	unsigned int idx = 0;
 	struct orig_region_map *pregion_orig;
-	uint64_t alignment;
+	uint64_t alignment, page_size = UINT64_MAX;
 
 	/* unmap old memory regions one by one*/
 	dev = get_device(ctx);
@@ -113,6 +113,10 @@ user_set_mem_table(struct vhost_device_ctx ctx, struct VhostUserMsg *pmsg)
 	if (dev->flags & VIRTIO_DEV_RUNNING)
 		notify_ops->destroy_device(dev);
 
+	/* Zero-copy mbufs must not point to the old memory. */
+	for (idx = 0; idx < dev->virt_qp_nb * VIRTIO_QNUM; idx++)
+		release_zmbufs(dev->virtqueue[idx]);
+
 	if (dev->mem) {
 		free_mem_region(dev);
 		free(dev->mem);
@@ -168,6 +172,7 @@ user_set_mem_table(struct vhost_device_ctx ctx, struct VhostUserMsg *pmsg)
 		pregion_orig[idx].mapped_size = mapped_size;
 		pregion_orig[idx].blksz = get_blk_size(pmsg->fds[idx]);
 		pregion_orig[idx].fd = pmsg->fds[idx];
+		page_size = RTE_MIN(page_size, pregion_orig[idx].blksz);
 
 		mapped_address +=  memory.regions[idx].mmap_offset;
 
@@ -189,6 +194,12 @@ user_set_mem_table(struct vhost_device_ctx ctx, struct VhostUserMsg *pmsg)
 			 pregion->memory_size);
 	}
 
+	/* The original mappings are kept in the order of the message. */
+	sort_mem_regions(dev->mem);
+
+	/* Zero copy is only turned on if the memory can be translated. */
+	setup_guest_pages(dev, page_size);
+
 	return 0;
 
 err_mmap:
@@ -205,26 +216,32 @@ err_mmap:
 	return -1;
 }
 
+static int
+vq_is_ready(struct vhost_virtqueue *vq)
+{
+	return vq && vq->desc &&
+		(vq->kickfd != (eventfd_t)-1) &&
+		(vq->callfd != (eventfd_t)-1);
+}
+
+/* The device is ready once all the queue pairs set up by the guest are. */
 static int
 virtio_is_ready(struct virtio_net *dev)
 {
-	struct vhost_virtqueue *rvq, *tvq;
-
-	/* mq support in future.*/
-	rvq = dev->virtqueue[VIRTIO_RXQ];
-	tvq = dev->virtqueue[VIRTIO_TXQ];
-	if (rvq && tvq && rvq->desc && tvq->desc &&
-		(rvq->kickfd != (eventfd_t)-1) &&
-		(rvq->callfd != (eventfd_t)-1) &&
-		(tvq->kickfd != (eventfd_t)-1) &&
-		(tvq->callfd != (eventfd_t)-1)) {
-		RTE_LOG(INFO, VHOST_CONFIG,
-			"virtio is now ready for processing.\n");
-		return 1;
+	uint32_t i;
+
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++) {
+		if (!vq_is_ready(dev->virtqueue[i])) {
+			RTE_LOG(INFO, VHOST_CONFIG,
+				"virtio isn't ready for processing.\n");
+			return 0;
+		}
 	}
+
 	RTE_LOG(INFO, VHOST_CONFIG,
-		"virtio isn't ready for processing.\n");
-	return 0;
+		"virtio is now ready for processing with %u queue pairs.\n",
+		dev->virt_qp_nb);
+	return 1;
 }
 
 void
@@ -275,33 +292,77 @@ user_get_vring_base(struct vhost_device_ctx ctx,
 	struct vhost_vring_state *state)
 {
 	struct virtio_net *dev = get_device(ctx);
+	struct vhost_virtqueue *vq;
 
 	/* We have to stop the queue (virtio) if it is running. */
 	if (dev->flags & VIRTIO_DEV_RUNNING)
 		notify_ops->destroy_device(dev);
 
 	/* Here we are safe to get the last used index */
-	ops->get_vring_base(ctx, state->index, state);
+	if (ops->get_vring_base(ctx, state->index, state) < 0)
+		return -1;
 
 	RTE_LOG(INFO, VHOST_CONFIG,
 		"vring base idx:%d file:%d\n", state->index, state->num);
 	/*
 	 * Based on current qemu vhost-user implementation, this message is
-	 * sent and only sent in vhost_vring_stop.
+	 * sent and only sent in vhost_vring_stop, once for each vring.
 	 * TODO: cleanup the vring, it isn't usable since here.
 	 */
-	if (((int)dev->virtqueue[VIRTIO_RXQ]->kickfd) >= 0) {
-		close(dev->virtqueue[VIRTIO_RXQ]->kickfd);
-		dev->virtqueue[VIRTIO_RXQ]->kickfd = (eventfd_t)-1;
+	vq = dev->virtqueue[state->index];
+	if (((int)vq->kickfd) >= 0) {
+		close(vq->kickfd);
+		vq->kickfd = (eventfd_t)-1;
 	}
-	if (((int)dev->virtqueue[VIRTIO_TXQ]->kickfd) >= 0) {
-		close(dev->virtqueue[VIRTIO_TXQ]->kickfd);
-		dev->virtqueue[VIRTIO_TXQ]->kickfd = (eventfd_t)-1;
+	release_zmbufs(vq);
+
+	return 0;
+}
+
+/*
+ * The guest enables or disables a vring, e.g. when changing its number of
+ * queue pairs with ethtool. The application is notified so that it can
+ * (un)assign the virtqueue to a core.
+ */
+int
+user_set_vring_enable(struct vhost_device_ctx ctx,
+	struct vhost_vring_state *state)
+{
+	struct virtio_net *dev = get_device(ctx);
+	int enable = (int)state->num;
+
+	if (dev == NULL)
+		return -1;
+	if (state->index >= dev->virt_qp_nb * VIRTIO_QNUM) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%"PRIu64") Invalid vring index %u to enable.\n",
+			dev->device_fh, state->index);
+		return -1;
 	}
 
+	RTE_LOG(INFO, VHOST_CONFIG,
+		"set queue enable: %d to qp idx: %d\n",
+		enable, state->index);
+
+	if (notify_ops->vring_state_changed)
+		notify_ops->vring_state_changed(dev, state->index, enable);
+	dev->virtqueue[state->index]->enabled = enable;
+
 	return 0;
 }
 
+void
+user_set_protocol_features(struct vhost_device_ctx ctx,
+	uint64_t protocol_features)
+{
+	struct virtio_net *dev = get_device(ctx);
+
+	if (dev == NULL || (protocol_features & ~VHOST_USER_PROTOCOL_FEATURES))
+		return;
+
+	dev->protocol_features = protocol_features;
+}
+
 void
 user_destroy_device(struct vhost_device_ctx ctx)
 {
@@ -45,5 +45,9 @@ void user_set_vring_kick(struct vhost_device_ctx, struct VhostUserMsg *);
 
 int user_get_vring_base(struct vhost_device_ctx, struct vhost_vring_state *);
 
+int user_set_vring_enable(struct vhost_device_ctx, struct vhost_vring_state *);
+
+void user_set_protocol_features(struct vhost_device_ctx, uint64_t);
+
 void user_destroy_device(struct vhost_device_ctx);
 #endif
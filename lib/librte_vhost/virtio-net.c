@@ -71,8 +71,35 @@ static struct virtio_net_config_ll *ll_root;
 #define VHOST_SUPPORTED_FEATURES ((1ULL << VIRTIO_NET_F_MRG_RXBUF) | \
 				(1ULL << VIRTIO_NET_F_CTRL_VQ) | \
 				(1ULL << VIRTIO_NET_F_CTRL_RX) | \
-				(1ULL << VHOST_F_LOG_ALL))
-static uint64_t VHOST_FEATURES = VHOST_SUPPORTED_FEATURES;
+				(1ULL << VIRTIO_NET_F_MQ) | \
+				(1ULL << VHOST_F_LOG_ALL) | \
+				(1ULL << VIRTIO_F_IN_ORDER) | \
+				(1ULL << VIRTIO_F_RING_PACKED) | \
+				VHOST_OFFLOAD_FEATURES)
+
+/*
+ * Checksum and segmentation offloads are supported but not offered by
+ * default: the application must be ready to handle (or forward to a NIC
+ * configured for) ol_flags and super-frames before enabling them with
+ * rte_vhost_feature_enable().
+ */
+#define VHOST_OFFLOAD_FEATURES ((1ULL << VIRTIO_NET_F_CSUM) | \
+				(1ULL << VIRTIO_NET_F_GUEST_CSUM) | \
+				(1ULL << VIRTIO_NET_F_HOST_TSO4) | \
+				(1ULL << VIRTIO_NET_F_HOST_TSO6) | \
+				(1ULL << VIRTIO_NET_F_GUEST_TSO4) | \
+				(1ULL << VIRTIO_NET_F_GUEST_TSO6))
+/*
+ * The packed ring is not offered by default either: it has no zero-copy
+ * dequeue, and a packed RX vring must only be enqueued to by one core at
+ * a time.
+ */
+static uint64_t VHOST_FEATURES = VHOST_SUPPORTED_FEATURES &
+				~VHOST_OFFLOAD_FEATURES &
+				~(1ULL << VIRTIO_F_RING_PACKED);
+
+/* Whether rte_vhost_dequeue_burst() points mbufs to guest memory. */
+static int dequeue_zero_copy;
 
 
 /*
@@ -102,6 +129,25 @@ qva_to_vva(struct virtio_net *dev, uint64_t qemu_va)
 }
 
 
+/*
+ * Sorts the memory regions by guest physical address, as expected by
+ * gpa_to_region(). There are at most VHOST_MEMORY_MAX_NREGIONS regions.
+ */
+void
+sort_mem_regions(struct virtio_memory *mem)
+{
+	struct virtio_memory_regions region;
+	uint32_t i, j;
+
+	for (i = 1; i < mem->nregions; i++) {
+		region = mem->regions[i];
+		for (j = i; j > 0 && mem->regions[j - 1].guest_phys_address >
+				region.guest_phys_address; j--)
+			mem->regions[j] = mem->regions[j - 1];
+		mem->regions[j] = region;
+	}
+}
+
 /*
  * Retrieves an entry from the devices configuration linked list.
  */
@@ -175,6 +221,119 @@ add_config_ll_entry(struct virtio_net_config_ll *new_ll_dev)
 
 }
 
+/*
+ * Drop the zero-copy mbufs still held by a virtqueue, without giving their
+ * descriptors back: the vring is being stopped or its memory remapped.
+ * An mbuf still referenced by the application is pointed back to its own
+ * buffer, so that it never reaches the guest memory again.
+ */
+void
+release_zmbufs(struct vhost_virtqueue *vq)
+{
+	uint16_t i;
+
+	for (i = 0; i < vq->nr_zmbufs; i++) {
+		restore_mbuf(vq->zmbufs[i].mbuf);
+		rte_pktmbuf_free(vq->zmbufs[i].mbuf);
+	}
+	vq->nr_zmbufs = 0;
+}
+
+/*
+ * Record the host physical address of the guest memory, page by page, so
+ * that zero-copy dequeued mbufs can be handed to a NIC. Physically
+ * contiguous pages are merged. Zero copy is turned off for the device if
+ * the memory is not backed by hugepages or cannot be translated.
+ */
+int
+setup_guest_pages(struct virtio_net *dev, uint64_t page_size)
+{
+	struct virtio_memory_regions *reg;
+	struct guest_page *page, *pages;
+	uint32_t i, max_pages = 0;
+	uint64_t gpa, hpa, va, size;
+
+	rte_free(dev->guest_pages);
+	dev->guest_pages = NULL;
+	dev->nr_guest_pages = 0;
+	dev->dequeue_zero_copy = 0;
+
+	if (!dequeue_zero_copy || dev->mem == NULL)
+		return 0;
+
+	if (page_size < RTE_PGSIZE_2M) {
+		RTE_LOG(INFO, VHOST_CONFIG,
+			"(%"PRIu64") guest memory not on hugepages, "
+			"no zero copy\n", dev->device_fh);
+		return 0;
+	}
+
+	for (i = 0; i < dev->mem->nregions; i++) {
+		reg = &dev->mem->regions[i];
+		gpa = reg->guest_phys_address;
+
+		while (gpa < reg->guest_phys_address_end) {
+			va = reg->address_offset + gpa;
+			size = RTE_MIN(page_size - (va & (page_size - 1)),
+				reg->guest_phys_address_end - gpa);
+
+			/* Fault the page in, it has no physical address yet. */
+			(void)*(volatile uint8_t *)(uintptr_t)va;
+			hpa = rte_mem_virt2phy((void *)(uintptr_t)va);
+			if (hpa == RTE_BAD_PHYS_ADDR) {
+				RTE_LOG(ERR, VHOST_CONFIG,
+					"(%"PRIu64") cannot translate guest "
+					"memory, no zero copy\n",
+					dev->device_fh);
+				goto err;
+			}
+
+			page = dev->nr_guest_pages ?
+				&dev->guest_pages[dev->nr_guest_pages - 1] :
+				NULL;
+			if (page != NULL &&
+			    page->guest_phys_addr + page->size == gpa &&
+			    page->host_phys_addr + page->size == hpa) {
+				page->size += size;
+				gpa += size;
+				continue;
+			}
+
+			if (dev->nr_guest_pages == max_pages) {
+				max_pages = max_pages ? max_pages * 2 : 8;
+				pages = rte_realloc(dev->guest_pages,
+					max_pages * sizeof(*pages), 0);
+				if (pages == NULL) {
+					RTE_LOG(ERR, VHOST_CONFIG,
+						"(%"PRIu64") Failed to allocate "
+						"memory for guest pages.\n",
+						dev->device_fh);
+					goto err;
+				}
+				dev->guest_pages = pages;
+			}
+
+			page = &dev->guest_pages[dev->nr_guest_pages++];
+			page->guest_phys_addr = gpa;
+			page->host_phys_addr = hpa;
+			page->size = size;
+			gpa += size;
+		}
+	}
+
+	dev->dequeue_zero_copy = 1;
+	RTE_LOG(INFO, VHOST_CONFIG,
+		"(%"PRIu64") dequeue zero copy on %u guest memory runs\n",
+		dev->device_fh, dev->nr_guest_pages);
+	return 0;
+
+err:
+	rte_free(dev->guest_pages);
+	dev->guest_pages = NULL;
+	dev->nr_guest_pages = 0;
+	return -1;
+}
+
 /*
  * Unmap any memory, close any file descriptors and
  * free any memory owned by a device.
@@ -182,6 +341,9 @@ add_config_ll_entry(struct virtio_net_config_ll *new_ll_dev)
 static void
 cleanup_device(struct virtio_net *dev)
 {
+	struct vhost_virtqueue *vq;
+	uint32_t i;
+
 	/* Unmap QEMU memory file if mapped. */
 	if (dev->mem) {
 		munmap((void *)(uintptr_t)dev->mem->mapped_address,
@@ -190,14 +352,21 @@ cleanup_device(struct virtio_net *dev)
 	}
 
 	/* Close any event notifiers opened by device. */
-	if ((int)dev->virtqueue[VIRTIO_RXQ]->callfd >= 0)
-		close((int)dev->virtqueue[VIRTIO_RXQ]->callfd);
-	if ((int)dev->virtqueue[VIRTIO_RXQ]->kickfd >= 0)
-		close((int)dev->virtqueue[VIRTIO_RXQ]->kickfd);
-	if ((int)dev->virtqueue[VIRTIO_TXQ]->callfd >= 0)
-		close((int)dev->virtqueue[VIRTIO_TXQ]->callfd);
-	if ((int)dev->virtqueue[VIRTIO_TXQ]->kickfd >= 0)
-		close((int)dev->virtqueue[VIRTIO_TXQ]->kickfd);
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++) {
+		vq = dev->virtqueue[i];
+		if ((int)vq->callfd >= 0)
+			close((int)vq->callfd);
+		if ((int)vq->kickfd >= 0)
+			close((int)vq->kickfd);
+		if (vq->zmbufs) {
+			release_zmbufs(vq);
+			rte_free(vq->zmbufs);
+			vq->zmbufs = NULL;
+		}
+	}
+
+	rte_free(dev->guest_pages);
+	dev->guest_pages = NULL;
 }
 
 /*
@@ -206,9 +375,11 @@ cleanup_device(struct virtio_net *dev)
 static void
 free_device(struct virtio_net_config_ll *ll_dev)
 {
-	/* Free any malloc'd memory */
-	rte_free(ll_dev->dev.virtqueue[VIRTIO_RXQ]);
-	rte_free(ll_dev->dev.virtqueue[VIRTIO_TXQ]);
+	uint32_t i;
+
+	/* Free any malloc'd memory, a queue pair is allocated at once. */
+	for (i = 0; i < ll_dev->dev.virt_qp_nb; i++)
+		rte_free(ll_dev->dev.virtqueue[i * VIRTIO_QNUM + VIRTIO_RXQ]);
 	rte_free(ll_dev);
 }
 
@@ -241,6 +412,84 @@ rm_config_ll_entry(struct virtio_net_config_ll *ll_dev,
 	}
 }
 
+/*
+ * Initialise the variables of a virtqueue.
+ */
+static void
+init_vring_queue(struct virtio_net *dev, struct vhost_virtqueue *vq,
+	uint32_t qp_idx)
+{
+	memset(vq, 0, sizeof(struct vhost_virtqueue));
+
+	vq->kickfd = (eventfd_t)-1;
+	vq->callfd = (eventfd_t)-1;
+
+	/* Backends are set to -1 indicating an inactive device. */
+	vq->backend = VIRTIO_DEV_STOPPED;
+
+	/*
+	 * Without the vhost-user protocol features, there is no message to
+	 * enable the vrings, they are enabled when they are set up. The
+	 * first queue pair is always enabled.
+	 */
+	vq->enabled = qp_idx == 0 || !(dev->features &
+		(1ULL << VHOST_USER_F_PROTOCOL_FEATURES));
+
+	if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF))
+		vq->vhost_hlen = sizeof(struct virtio_net_hdr_mrg_rxbuf);
+	else
+		vq->vhost_hlen = sizeof(struct virtio_net_hdr);
+}
+
+/*
+ * Allocate the RX and TX virtqueues of a queue pair. All the queue pairs
+ * below qp_idx must have been allocated.
+ */
+static int
+alloc_vring_queue_pair(struct virtio_net *dev, uint32_t qp_idx)
+{
+	struct vhost_virtqueue *virtqueue;
+	uint32_t base_idx = qp_idx * VIRTIO_QNUM;
+
+	virtqueue = rte_malloc(NULL,
+		sizeof(struct vhost_virtqueue) * VIRTIO_QNUM, 0);
+	if (virtqueue == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%"PRIu64") Failed to allocate memory for queue pair %u.\n",
+			dev->device_fh, qp_idx);
+		return -1;
+	}
+
+	dev->virtqueue[base_idx + VIRTIO_RXQ] = &virtqueue[VIRTIO_RXQ];
+	dev->virtqueue[base_idx + VIRTIO_TXQ] = &virtqueue[VIRTIO_TXQ];
+	init_vring_queue(dev, dev->virtqueue[base_idx + VIRTIO_RXQ], qp_idx);
+	init_vring_queue(dev, dev->virtqueue[base_idx + VIRTIO_TXQ], qp_idx);
+	dev->virt_qp_nb = qp_idx + 1;
+
+	return 0;
+}
+
+/*
+ * Get the virtqueue of a vring index sent by the guest, allocating the
+ * queue pairs up to this index if needed.
+ */
+static struct vhost_virtqueue *
+get_vring(struct virtio_net *dev, uint32_t index)
+{
+	if (index >= VHOST_MAX_QUEUE_PAIRS * VIRTIO_QNUM) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%"PRIu64") Invalid vring index %u.\n",
+			dev->device_fh, index);
+		return NULL;
+	}
+
+	while (index >= dev->virt_qp_nb * VIRTIO_QNUM)
+		if (alloc_vring_queue_pair(dev, dev->virt_qp_nb) < 0)
+			return NULL;
+
+	return dev->virtqueue[index];
+}
+
 /*
  *  Initialise all variables in device structure.
  */
@@ -248,6 +497,7 @@ static void
 init_device(struct virtio_net *dev)
 {
 	uint64_t vq_offset;
+	uint32_t i;
 
 	/*
 	 * Virtqueues have already been malloced so
@@ -255,20 +505,14 @@ init_device(struct virtio_net *dev)
 	 */
 	vq_offset = offsetof(struct virtio_net, mem);
 
-	/* Set everything to 0. */
+	/* Set everything to 0 but the number of queue pairs. */
+	i = dev->virt_qp_nb;
 	memset((void *)(uintptr_t)((uint64_t)(uintptr_t)dev + vq_offset), 0,
 		(sizeof(struct virtio_net) - (size_t)vq_offset));
-	memset(dev->virtqueue[VIRTIO_RXQ], 0, sizeof(struct vhost_virtqueue));
-	memset(dev->virtqueue[VIRTIO_TXQ], 0, sizeof(struct vhost_virtqueue));
-
-	dev->virtqueue[VIRTIO_RXQ]->kickfd = (eventfd_t)-1;
-	dev->virtqueue[VIRTIO_RXQ]->callfd = (eventfd_t)-1;
-	dev->virtqueue[VIRTIO_TXQ]->kickfd = (eventfd_t)-1;
-	dev->virtqueue[VIRTIO_TXQ]->callfd = (eventfd_t)-1;
+	dev->virt_qp_nb = i;
 
-	/* Backends are set to -1 indicating an inactive device. */
-	dev->virtqueue[VIRTIO_RXQ]->backend = VIRTIO_DEV_STOPPED;
-	dev->virtqueue[VIRTIO_TXQ]->backend = VIRTIO_DEV_STOPPED;
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++)
+		init_vring_queue(dev, dev->virtqueue[i], i / VIRTIO_QNUM);
 }
 
 /*
@@ -280,10 +524,9 @@ static int
 new_device(struct vhost_device_ctx ctx)
 {
 	struct virtio_net_config_ll *new_ll_dev;
-	struct vhost_virtqueue *virtqueue_rx, *virtqueue_tx;
 
 	/* Setup device and virtqueues. */
-	new_ll_dev = rte_malloc(NULL, sizeof(struct virtio_net_config_ll), 0);
+	new_ll_dev = rte_zmalloc(NULL, sizeof(struct virtio_net_config_ll), 0);
 	if (new_ll_dev == NULL) {
 		RTE_LOG(ERR, VHOST_CONFIG,
 			"(%"PRIu64") Failed to allocate memory for dev.\n",
@@ -291,28 +534,12 @@ new_device(struct vhost_device_ctx ctx)
 		return -1;
 	}
 
-	virtqueue_rx = rte_malloc(NULL, sizeof(struct vhost_virtqueue), 0);
-	if (virtqueue_rx == NULL) {
-		rte_free(new_ll_dev);
-		RTE_LOG(ERR, VHOST_CONFIG,
-			"(%"PRIu64") Failed to allocate memory for rxq.\n",
-			ctx.fh);
-		return -1;
-	}
-
-	virtqueue_tx = rte_malloc(NULL, sizeof(struct vhost_virtqueue), 0);
-	if (virtqueue_tx == NULL) {
-		rte_free(virtqueue_rx);
+	/* The first queue pair always exists. */
+	if (alloc_vring_queue_pair(&new_ll_dev->dev, 0) < 0) {
 		rte_free(new_ll_dev);
-		RTE_LOG(ERR, VHOST_CONFIG,
-			"(%"PRIu64") Failed to allocate memory for txq.\n",
-			ctx.fh);
 		return -1;
 	}
 
-	new_ll_dev->dev.virtqueue[VIRTIO_RXQ] = virtqueue_rx;
-	new_ll_dev->dev.virtqueue[VIRTIO_TXQ] = virtqueue_tx;
-
 	/* Initialise device and virtqueues. */
 	init_device(&new_ll_dev->dev);
 
@@ -421,8 +648,13 @@ get_features(struct vhost_device_ctx ctx, uint64_t *pu)
 	if (dev == NULL)
 		return -1;
 
-	/* Send our supported features. */
+	/*
+	 * Send our supported features. Zero-copy dequeue gives buffers
+	 * back in the order the application frees them.
+	 */
 	*pu = VHOST_FEATURES;
+	if (dequeue_zero_copy)
+		*pu &= ~(1ULL << VIRTIO_F_IN_ORDER);
 	return 0;
 }
 
@@ -434,33 +666,33 @@ static int
 set_features(struct vhost_device_ctx ctx, uint64_t *pu)
 {
 	struct virtio_net *dev;
+	uint16_t vhost_hlen;
+	uint32_t i;
 
 	dev = get_device(ctx);
 	if (dev == NULL)
 		return -1;
-	if (*pu & ~VHOST_FEATURES)
+	/* the protocol features bit is only offered by vhost-user */
+	if (*pu & ~(VHOST_FEATURES | (1ULL << VHOST_USER_F_PROTOCOL_FEATURES)))
 		return -1;
 
 	/* Store the negotiated feature list for the device. */
 	dev->features = *pu;
+	vhost_hlen = (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)) ?
+		sizeof(struct virtio_net_hdr_mrg_rxbuf) :
+		sizeof(struct virtio_net_hdr);
 
 	/* Set the vhost_hlen depending on if VIRTIO_NET_F_MRG_RXBUF is set. */
-	if (dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)) {
-		LOG_DEBUG(VHOST_CONFIG,
-			"(%"PRIu64") Mergeable RX buffers enabled\n",
-			dev->device_fh);
-		dev->virtqueue[VIRTIO_RXQ]->vhost_hlen =
-			sizeof(struct virtio_net_hdr_mrg_rxbuf);
-		dev->virtqueue[VIRTIO_TXQ]->vhost_hlen =
-			sizeof(struct virtio_net_hdr_mrg_rxbuf);
-	} else {
-		LOG_DEBUG(VHOST_CONFIG,
-			"(%"PRIu64") Mergeable RX buffers disabled\n",
-			dev->device_fh);
-		dev->virtqueue[VIRTIO_RXQ]->vhost_hlen =
-			sizeof(struct virtio_net_hdr);
-		dev->virtqueue[VIRTIO_TXQ]->vhost_hlen =
-			sizeof(struct virtio_net_hdr);
+	LOG_DEBUG(VHOST_CONFIG,
+		"(%"PRIu64") Mergeable RX buffers %s\n", dev->device_fh,
+		(dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)) ?
+		"enabled" : "disabled");
+	for (i = 0; i < dev->virt_qp_nb * VIRTIO_QNUM; i++) {
+		dev->virtqueue[i]->vhost_hlen = vhost_hlen;
+		/* Further queue pairs now wait for VHOST_USER_SET_VRING_ENABLE. */
+		if (i >= VIRTIO_QNUM)
+			dev->virtqueue[i]->enabled = !(dev->features &
+				(1ULL << VHOST_USER_F_PROTOCOL_FEATURES));
 	}
 	return 0;
 }
@@ -473,20 +705,43 @@ static int
 set_vring_num(struct vhost_device_ctx ctx, struct vhost_vring_state *state)
 {
 	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
 
 	dev = get_device(ctx);
 	if (dev == NULL)
 		return -1;
 
-	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
-	dev->virtqueue[state->index]->size = state->num;
+	/*
+	 * State->index refers to the queue index. The txq is 1, rxq is 0
+	 * in the first queue pair, further pairs are allocated on demand.
+	 */
+	vq = get_vring(dev, state->index);
+	if (vq == NULL)
+		return -1;
+	vq->size = state->num;
+
+	/* A zero-copy TX vring can have all its descriptors in flight. */
+	if (dev->dequeue_zero_copy && (state->index & 1) == VIRTIO_TXQ) {
+		if (vq->zmbufs) {
+			release_zmbufs(vq);
+			rte_free(vq->zmbufs);
+		}
+		vq->zmbufs = rte_zmalloc(NULL,
+			vq->size * sizeof(struct zcopy_mbuf), 0);
+		if (vq->zmbufs == NULL)
+			RTE_LOG(ERR, VHOST_CONFIG,
+				"(%"PRIu64") Failed to allocate zero copy "
+				"mbufs, vring %u copies.\n",
+				dev->device_fh, state->index);
+	}
 
 	return 0;
 }
 
 /*
  * Reallocate virtio_det and vhost_virtqueue data structure to make them on the
- * same numa node as the memory of vring descriptor.
+ * same numa node as the memory of vring descriptor. The virtqueues of a queue
+ * pair are moved together.
  */
 #ifdef RTE_LIBRTE_VHOST_NUMA
 static struct virtio_net*
@@ -497,11 +752,12 @@ numa_realloc(struct virtio_net *dev, int index)
 	struct vhost_virtqueue *old_vq, *new_vq = NULL;
 	int ret;
 	int realloc_dev = 0, realloc_vq = 0;
+	uint32_t base_idx = index - index % VIRTIO_QNUM;
 
 	old_ll_dev = (struct virtio_net_config_ll *)dev;
-	old_vq = dev->virtqueue[index];
+	old_vq = dev->virtqueue[base_idx];
 
-	ret  = get_mempolicy(&newnode, NULL, 0, old_vq->desc,
+	ret  = get_mempolicy(&newnode, NULL, 0, dev->virtqueue[index]->desc,
 			MPOL_F_NODE | MPOL_F_ADDR);
 	ret = ret | get_mempolicy(&oldnode, NULL, 0, old_ll_dev,
 			MPOL_F_NODE | MPOL_F_ADDR);
@@ -531,16 +787,20 @@ numa_realloc(struct virtio_net *dev, int index)
 			sizeof(struct virtio_net_config_ll), 0, newnode);
 	if (realloc_vq)
 		new_vq = rte_malloc_socket(NULL,
-			sizeof(struct vhost_virtqueue), 0, newnode);
+			sizeof(struct vhost_virtqueue) * VIRTIO_QNUM, 0,
+			newnode);
 	if (!new_ll_dev && !new_vq)
 		return dev;
 
 	if (realloc_vq)
-		memcpy(new_vq, old_vq, sizeof(*new_vq));
+		memcpy(new_vq, old_vq, sizeof(*new_vq) * VIRTIO_QNUM);
 	if (realloc_dev)
 		memcpy(new_ll_dev, old_ll_dev, sizeof(*new_ll_dev));
-	(new_ll_dev ? new_ll_dev : old_ll_dev)->dev.virtqueue[index] =
-		new_vq ? new_vq : old_vq;
+	if (realloc_vq) {
+		dev = &(new_ll_dev ? new_ll_dev : old_ll_dev)->dev;
+		dev->virtqueue[base_idx + VIRTIO_RXQ] = &new_vq[VIRTIO_RXQ];
+		dev->virtqueue[base_idx + VIRTIO_TXQ] = &new_vq[VIRTIO_TXQ];
+	}
 	if (realloc_vq)
 		rte_free(old_vq);
 	if (realloc_dev) {
@@ -582,7 +842,9 @@ set_vring_addr(struct vhost_device_ctx ctx, struct vhost_vring_addr *addr)
 		return -1;
 
 	/* addr->index refers to the queue index. The txq 1, rxq is 0. */
-	vq = dev->virtqueue[addr->index];
+	vq = get_vring(dev, addr->index);
+	if (vq == NULL)
+		return -1;
 
 	/* The addresses are converted from QEMU virtual to Vhost virtual. */
 	vq->desc = (struct vring_desc *)(uintptr_t)qva_to_vva(dev,
@@ -615,6 +877,15 @@ set_vring_addr(struct vhost_device_ctx ctx, struct vhost_vring_addr *addr)
 		return -1;
 	}
 
+	/* A packed ring has its event suppression areas in their place. */
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED)) {
+		vq->desc_packed = (struct vring_packed_desc *)vq->desc;
+		vq->driver_event =
+			(struct vring_packed_desc_event *)vq->avail;
+		vq->device_event =
+			(struct vring_packed_desc_event *)vq->used;
+	}
+
 	LOG_DEBUG(VHOST_CONFIG, "(%"PRIu64") mapped address desc: %p\n",
 			dev->device_fh, vq->desc);
 	LOG_DEBUG(VHOST_CONFIG, "(%"PRIu64") mapped address avail: %p\n",
@@ -633,14 +904,25 @@ static int
 set_vring_base(struct vhost_device_ctx ctx, struct vhost_vring_state *state)
 {
 	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
 
 	dev = get_device(ctx);
 	if (dev == NULL)
 		return -1;
 
 	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
-	dev->virtqueue[state->index]->last_used_idx = state->num;
-	dev->virtqueue[state->index]->last_used_idx_res = state->num;
+	vq = get_vring(dev, state->index);
+	if (vq == NULL)
+		return -1;
+	/* The wrap counter of a packed ring comes in the top bit. */
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED)) {
+		vq->last_used_idx = state->num & 0x7fff;
+		vq->last_used_idx_res = vq->last_used_idx;
+		vq->avail_wrap_counter = !!(state->num & (1 << 15));
+		return 0;
+	}
+	vq->last_used_idx = state->num;
+	vq->last_used_idx_res = state->num;
 
 	return 0;
 }
@@ -659,9 +941,15 @@ get_vring_base(struct vhost_device_ctx ctx, uint32_t index,
 	if (dev == NULL)
 		return -1;
 
+	if (index >= dev->virt_qp_nb * VIRTIO_QNUM)
+		return -1;
+
 	state->index = index;
 	/* State->index refers to the queue index. The txq is 1, rxq is 0. */
 	state->num = dev->virtqueue[state->index]->last_used_idx;
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		state->num |= dev->virtqueue[state->index]->avail_wrap_counter
+			<< 15;
 
 	return 0;
 }
@@ -683,7 +971,9 @@ set_vring_call(struct vhost_device_ctx ctx, struct vhost_vring_file *file)
 		return -1;
 
 	/* file->index refers to the queue index. The txq is 1, rxq is 0. */
-	vq = dev->virtqueue[file->index];
+	vq = get_vring(dev, file->index);
+	if (vq == NULL)
+		return -1;
 
 	if ((int)vq->callfd >= 0)
 		close((int)vq->callfd);
@@ -709,7 +999,9 @@ set_vring_kick(struct vhost_device_ctx ctx, struct vhost_vring_file *file)
 		return -1;
 
 	/* file->index refers to the queue index. The txq is 1, rxq is 0. */
-	vq = dev->virtqueue[file->index];
+	vq = get_vring(dev, file->index);
+	if (vq == NULL)
+		return -1;
 
 	if ((int)vq->kickfd >= 0)
 		close((int)vq->kickfd);
@@ -737,7 +1029,12 @@ set_backend(struct vhost_device_ctx ctx, struct vhost_vring_file *file)
 	if (dev == NULL)
 		return -1;
 
-	/* file->index refers to the queue index. The txq is 1, rxq is 0. */
+	/*
+	 * file->index refers to the queue index. The txq is 1, rxq is 0.
+	 * A vhost-cuse device only has one queue pair.
+	 */
+	if (file->index >= VIRTIO_QNUM)
+		return -1;
 	dev->virtqueue[file->index]->backend = file->fd;
 
 	/*
@@ -795,17 +1092,33 @@ get_virtio_net_callbacks(void)
 int rte_vhost_enable_guest_notification(struct virtio_net *dev,
 	uint16_t queue_id, int enable)
 {
+	if (queue_id >= dev->virt_qp_nb * VIRTIO_QNUM) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%"PRIu64") Invalid virtqueue %u.\n",
+			dev->device_fh, queue_id);
+		return -1;
+	}
 	if (enable) {
 		RTE_LOG(ERR, VHOST_CONFIG,
 			"guest notification isn't supported.\n");
 		return -1;
 	}
 
-	dev->virtqueue[queue_id]->used->flags =
-		enable ? 0 : VRING_USED_F_NO_NOTIFY;
+	if (dev->features & (1ULL << VIRTIO_F_RING_PACKED))
+		dev->virtqueue[queue_id]->device_event->flags = enable ?
+			VRING_PACKED_EVENT_FLAG_ENABLE :
+			VRING_PACKED_EVENT_FLAG_DISABLE;
+	else
+		dev->virtqueue[queue_id]->used->flags =
+			enable ? 0 : VRING_USED_F_NO_NOTIFY;
 	return 0;
 }
 
+uint16_t rte_vhost_get_queue_num(struct virtio_net *dev)
+{
+	return dev->virt_qp_nb;
+}
+
 uint64_t rte_vhost_feature_get(void)
 {
 	return VHOST_FEATURES;
@@ -826,6 +1139,18 @@ int rte_vhost_feature_enable(uint64_t feature_mask)
 	return -1;
 }
 
+int rte_vhost_dequeue_zero_copy_enable(void)
+{
+	dequeue_zero_copy = 1;
+	return 0;
+}
+
+int rte_vhost_dequeue_zero_copy_disable(void)
+{
+	dequeue_zero_copy = 0;
+	return 0;
+}
+
 /*
  * Register ops so that we can add/remove device to data core.
  */